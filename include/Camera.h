@@ -154,6 +154,12 @@ JETAPI void JETCC jeCamera_TransformAndProjectAndClampLArray(	const jeCamera		*C
 																const jeLVertex	*WorldSpacePointPtr, 
 																jeTLVertex			*ProjectedSpacePointPtr,
 																int32				Count);
+// Same as jeXForm3d_Transform by XForm (into camera space), then jeCamera_ProjectAndClampLArray, 4 points at a time
+JETAPI void JETCC jeCamera_XFormProjectAndClampLArray(	const jeCamera		*Camera, 
+														const jeXForm3d		*XForm,
+														const jeLVertex		*PointPtr, 
+														jeTLVertex			*ProjectedSpacePointPtr,
+														int32				Count);
 JETAPI void JETCC jeCamera_TransformAndProjectAndClamp(	const	jeCamera *Camera,
 														const	jeVec3d *Point, 
 														jeVec3d	*ProjectedPoint);
@@ -56,6 +56,7 @@ typedef struct			jeBSPNode_Portal	jeBSPNode_Portal;	// Portal (passage from leaf
 typedef struct			jeBSPNode_Face		jeBSPNode_Face;		// Node face during construction
 typedef struct			jeBSPNode_DrawFace	jeBSPNode_DrawFace;	// Face that gets rendered on nodes
 typedef struct			jeBSPNode_Area		jeBSPNode_Area;
+typedef struct			jeBSP_VisContext	jeBSP_VisContext;	// Per view visibility marks
 
 typedef void			jeBSPNode_DrawFaceCB(const jeTLVertex *Verts, int32 NumVerts, void *Context);
 
@@ -161,8 +162,12 @@ jeBoolean		jeBSP_HasObject(jeBSP *BSP, jeObject *Object);
 //================================================================================================
 //	Render/Vis
 //================================================================================================
-jeBoolean		jeBSP_VisFrame(jeBSP *BSPTree, const jeCamera *Camera, const jeFrustum *ModelSpaceFrustum);
-jeBoolean		jeBSP_RenderFrontToBack(jeBSP *Tree, jeCamera *Camera, jeFrustum *CameraSpaceFrustum, jeFrustum *ModelSpaceFrustum, jeXForm3d *ModelToCameraXForm);
+// A context holds the visibility of one view.  Views that use different contexts never touch
+//	each other's state, so they may be flooded at the same time (split screen, mirrors, shadows).
+jeBSP_VisContext	*jeBSP_VisContextAcquire(jeBSP *BSP);
+void			jeBSP_VisContextRelease(jeBSP *BSP, jeBSP_VisContext **Vis);
+jeBoolean		jeBSP_VisFrame(jeBSP *BSPTree, jeBSP_VisContext *Vis, const jeCamera *Camera, const jeFrustum *ModelSpaceFrustum);
+jeBoolean		jeBSP_RenderFrontToBack(jeBSP *Tree, jeBSP_VisContext *Vis, jeCamera *Camera, jeFrustum *CameraSpaceFrustum, jeFrustum *ModelSpaceFrustum, jeXForm3d *ModelToCameraXForm);
 jeBoolean		jeBSP_RenderAndVis(jeBSP *Tree, jeCamera *Camera, jeFrustum *Frustum);
 jeBoolean		jeBSP_RenderAreas(jeBSP *Tree, jeCamera *Camera, jeFrustum *CameraSpaceFrustum, jeFrustum *ModelSpaceFrustum, jeXForm3d *ModelToCameraXForm);
 #ifdef AREA_DRAWFACE_TEST
@@ -118,6 +118,20 @@ JETAPI jeBoolean JETCC jeMaterialSpec_CreateRef(jeMaterialSpec* MaterialSpec);
 */
 JETAPI jeMaterialSpec* JETCC jeMaterialSpec_CreateFromFile(jeVFile *VFile, jeEngine* pEngine, jeResourceMgr *ResMgr);
 
+/*! @fn jeBoolean jeMaterialSpec_SetEngine(jeMaterialSpec* MatSpec, jeEngine* pEngine)
+*   @brief Give an engine to a jeMaterialSpec created without one
+	@param MatSpec The jeMaterialSpec instance
+	@param pEngine The engine to associate with this material
+	@return JE_TRUE if succeed, JE_FALSE otherwise
+
+	A spec read with a NULL engine (from a loader thread) can't touch the driver, so its
+	texture layers are not created and its file bitmaps are not attached.  This does both,
+	on the render thread.  Texture layers come from the resource manager the spec was created
+	with, which needs an engine by then (see jeResourceMgr_SetEngine).  Does nothing if the spec
+	already has an engine.
+*/
+JETAPI jeBoolean JETCC jeMaterialSpec_SetEngine(jeMaterialSpec* MatSpec, jeEngine* pEngine);
+
 /*! @fn void jeMaterialSpec_Destroy(jeMaterialSpec **ppMaterialSpec);
 *   @brief Destroy the jeMaterialSpec instance
 	@param ppMaterialSpec The jeMaterialSpec instance pointer address
@@ -149,6 +149,18 @@ typedef struct jeEngine	jeEngine;
 */
 JETAPI jeResourceMgr* JETCC jeResource_MgrCreate(jeEngine* pEngine);
 
+/*! @fn jeResourceMgr* jeResource_MgrCreateThreadSafe(jeEngine* pEngine)
+	@brief Create a resource manager that can be shared by several threads.
+	@param pEngine The current jeEngine instance
+	@return The jeResourceMgr instance if succeed
+
+	Lookups, adds and reference counting are serialized by a lock, so resources can
+	be loaded from worker threads.  The lock is not held while jeResource_GetResource()
+	loads a resource; if two threads load the same one, the first to finish wins and
+	the other copy is destroyed.
+*/
+JETAPI jeResourceMgr* JETCC jeResource_MgrCreateThreadSafe(jeEngine* pEngine);
+
 /*!	@fn int jeResource_MgrIncRefcount(jeResourceMgr* ResourceMgr)
 	@brief Increment a resource managers reference/usage count.
 	@param ResourceMgr Manager whose ref count will be incremented
@@ -44,7 +44,8 @@ typedef enum
 	Type_Line,
 	Type_Tri,
 	Type_Quad, 
-	Type_Sprite
+	Type_Sprite,
+	Type_SpriteArray
 } jeUserPoly_Type;
 
 //========================================================================================
@@ -66,6 +67,8 @@ JETAPI jeUserPoly	* JETCC jeUserPoly_CreateSprite(	const jeLVertex		*v1,
 													jeFloat				Scale,
 													uint32				Flags);
 JETAPI jeUserPoly	* JETCC jeUserPoly_CreateLine(const jeLVertex *v1, const jeLVertex *v2, jeFloat Scale, uint32 Flags);
+// A sprite array draws Count sprites from arrays owned by the caller (see jeUserPoly_UpdateSpriteArray)
+JETAPI jeUserPoly	* JETCC jeUserPoly_CreateSpriteArray(uint32 Flags);
 
 JETAPI jeBoolean	JETCC jeUserPoly_IsValid(const jeUserPoly *Poly);
 JETAPI jeBoolean	JETCC jeUserPoly_CreateRef(jeUserPoly *Poly);
@@ -87,6 +90,14 @@ JETAPI jeBoolean	JETCC jeUserPoly_UpdateSprite(jeUserPoly *Poly, const jeLVertex
 
 JETAPI jeBoolean	JETCC jeUserPoly_UpdateLine(jeUserPoly *Poly, const jeLVertex *v1, const jeLVertex *v2, jeFloat Scale);
 
+// The arrays are not copied.  They must stay valid until the next update (or until the poly is destroyed),
+//	so call this again whenever they are reallocated or Count changes.
+JETAPI jeBoolean	JETCC jeUserPoly_UpdateSpriteArray(	jeUserPoly *Poly, 
+												const jeLVertex *Verts, 
+												const jeMaterialSpec * const *Materials, 
+												const jeFloat *Scales, 
+												int32 Count);
+
 JETAPI jeBoolean	JETCC jeUserPoly_Render(const jeUserPoly *Poly, const jeEngine *Engine, const jeCamera *Camera, const jeFrustum *Frustum);
 
 //========================================================================================
@@ -78,6 +78,8 @@ JETAPI void				JETCC jeVertArray_RemoveVert(jeVertArray *Array, jeVertArray_Inde
 JETAPI jeBoolean		JETCC jeVertArray_RefVertByIndex(jeVertArray *Array, jeVertArray_Index Index);
 JETAPI void				JETCC jeVertArray_SetVertByIndex(jeVertArray *VArray, jeVertArray_Index Index, const jeVec3d *Vert);
 JETAPI const jeVec3d	* JETCC jeVertArray_GetVertByIndex(const jeVertArray *VArray, jeVertArray_Index Index);
+// Copies X,Y,Z of Count verts into Dest, DestStride bytes apart
+JETAPI void				JETCC jeVertArray_GatherVerts(const jeVertArray *VArray, const jeVertArray_Index *Indices, int32 Count, jeVec3d *Dest, int32 DestStride);
 JETAPI int16			JETCC jeVertArray_GetMaxIndex( const jeVertArray *VArray );
 JETAPI jeVertArray_Optimizer * JETCC jeVertArray_CreateOptimizer(jeVertArray *Array);
 JETAPI void				JETCC jeVertArray_DestroyOptimizer(jeVertArray *Array, jeVertArray_Optimizer **Optimizer);
@@ -59,6 +59,8 @@ void D3D12TextureMgr::Shutdown()
 	}
 	m_Textures.clear();
 	m_NextSRVIndex = 0;
+	m_pUploadList.Reset();
+	m_pUploadAllocator.Reset();
 	m_bInitialized = false;
 
 	D3D12Log::GetPtr()->Printf("D3D12TextureMgr shutdown");
@@ -235,6 +237,152 @@ bool D3D12TextureMgr::UnlockTexture(jeTexture* pTexture, int32 MipLevel)
 	return true;
 }
 
+bool D3D12TextureMgr::UploadTextures(const DRV_TextureUpload* pUploads, int32 NumUploads)
+{
+	if (!m_bInitialized || !g_pDevice || !g_pCommandQueue)
+		return false;
+
+	if (NumUploads <= 0)
+		return true;
+
+	// Place every mip in one upload buffer at its copyable footprint
+	std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> footprints(NumUploads);
+	UINT64 totalSize = 0;
+
+	for (int32 i = 0; i < NumUploads; i++)
+	{
+		const DRV_TextureUpload& up = pUploads[i];
+
+		if (!up.THandle || !up.THandle->pResource || !up.Bits)
+			return false;
+
+		D3D12_RESOURCE_DESC desc = up.THandle->pResource->GetDesc();
+		if (up.MipLevel < 0 || up.MipLevel >= desc.MipLevels)
+			return false;
+
+		totalSize = (totalSize + D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1) & ~(UINT64)(D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1);
+
+		UINT numRows = 0;
+		UINT64 rowSize = 0, size = 0;
+		g_pDevice->GetCopyableFootprints(&desc, up.MipLevel, 1, totalSize, &footprints[i], &numRows, &rowSize, &size);
+
+		// The bits must already be in the texture's layout (no 24 -> 32 bit expansion here)
+		if (rowSize != (UINT64)up.RowBytes || numRows != (UINT)up.Height)
+		{
+			D3D12Log::GetPtr()->Printf("ERROR: UploadTextures: upload %d doesn't match its texture", i);
+			return false;
+		}
+
+		totalSize += size;
+	}
+
+	D3D12_HEAP_PROPERTIES heapProps = {};
+	heapProps.Type = D3D12_HEAP_TYPE_UPLOAD;
+
+	D3D12_RESOURCE_DESC bufDesc = {};
+	bufDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	bufDesc.Width = totalSize;
+	bufDesc.Height = 1;
+	bufDesc.DepthOrArraySize = 1;
+	bufDesc.MipLevels = 1;
+	bufDesc.Format = DXGI_FORMAT_UNKNOWN;
+	bufDesc.SampleDesc.Count = 1;
+	bufDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+	ComPtr<ID3D12Resource> pUpload;
+	HRESULT hr = g_pDevice->CreateCommittedResource(
+		&heapProps,
+		D3D12_HEAP_FLAG_NONE,
+		&bufDesc,
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		nullptr,
+		IID_PPV_ARGS(&pUpload));
+
+	if (FAILED(hr))
+	{
+		D3D12Log::GetPtr()->Printf("ERROR: UploadTextures: failed to create upload buffer");
+		return false;
+	}
+
+	uint8* pMapped = nullptr;
+	D3D12_RANGE readRange = { 0, 0 };
+	if (FAILED(pUpload->Map(0, &readRange, reinterpret_cast<void**>(&pMapped))))
+		return false;
+
+	for (int32 i = 0; i < NumUploads; i++)
+	{
+		const DRV_TextureUpload& up = pUploads[i];
+		const uint8* pSrc = static_cast<const uint8*>(up.Bits);
+		uint8* pDst = pMapped + footprints[i].Offset;
+
+		for (int32 y = 0; y < up.Height; y++)
+		{
+			memcpy(pDst, pSrc, up.RowBytes);
+			pSrc += up.Stride;
+			pDst += footprints[i].Footprint.RowPitch;
+		}
+	}
+
+	pUpload->Unmap(0, nullptr);
+
+	if (!m_pUploadAllocator)
+	{
+		if (FAILED(g_pDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&m_pUploadAllocator))))
+			return false;
+
+		if (FAILED(g_pDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, m_pUploadAllocator.Get(),
+			nullptr, IID_PPV_ARGS(&m_pUploadList))))
+		{
+			m_pUploadAllocator.Reset();
+			return false;
+		}
+
+		m_pUploadList->Close();
+	}
+
+	m_pUploadAllocator->Reset();
+	m_pUploadList->Reset(m_pUploadAllocator.Get(), nullptr);
+
+	for (int32 i = 0; i < NumUploads; i++)
+	{
+		jeTexture* pTex = pUploads[i].THandle;
+
+		TransitionResource(m_pUploadList.Get(), pTex->pResource.Get(), pTex->CurrentState, D3D12_RESOURCE_STATE_COPY_DEST);
+		pTex->CurrentState = D3D12_RESOURCE_STATE_COPY_DEST;
+
+		D3D12_TEXTURE_COPY_LOCATION dst = {};
+		dst.pResource = pTex->pResource.Get();
+		dst.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+		dst.SubresourceIndex = pUploads[i].MipLevel;
+
+		D3D12_TEXTURE_COPY_LOCATION src = {};
+		src.pResource = pUpload.Get();
+		src.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+		src.PlacedFootprint = footprints[i];
+
+		m_pUploadList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+	}
+
+	// Several mips of one texture share a single transition back
+	for (int32 i = 0; i < NumUploads; i++)
+	{
+		jeTexture* pTex = pUploads[i].THandle;
+
+		TransitionResource(m_pUploadList.Get(), pTex->pResource.Get(), pTex->CurrentState, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+		pTex->CurrentState = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+	}
+
+	m_pUploadList->Close();
+
+	ID3D12CommandList* ppCommandLists[] = { m_pUploadList.Get() };
+	g_pCommandQueue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
+
+	// pUpload has to live until the copies are done
+	WaitForGPU();
+
+	return true;
+}
+
 bool D3D12TextureMgr::GetTextureInfo(jeTexture* pTexture, int32 MipLevel, jeTexture_Info* pInfo)
 {
 	if (!pTexture || !pInfo)
@@ -289,6 +437,11 @@ jeBoolean DRIVERCC D3D12_THandle_Unlock(jeTexture* THandle, int32 MipLevel)
 	return D3D12TextureMgr::GetPtr()->UnlockTexture(THandle, MipLevel) ? JE_TRUE : JE_FALSE;
 }
 
+jeBoolean DRIVERCC D3D12_THandle_UploadBatch(const DRV_TextureUpload* Uploads, int32 NumUploads)
+{
+	return D3D12TextureMgr::GetPtr()->UploadTextures(Uploads, NumUploads) ? JE_TRUE : JE_FALSE;
+}
+
 jeBoolean DRIVERCC D3D12_THandle_GetInfo(jeTexture* THandle, int32 MipLevel, jeTexture_Info* Info)
 {
 	return D3D12TextureMgr::GetPtr()->GetTextureInfo(THandle, MipLevel, Info) ? JE_TRUE : JE_FALSE;
@@ -20,6 +20,10 @@ private:
 	UINT							m_NextSRVIndex;
 	bool							m_bInitialized;
 
+	// Recorded and executed by UploadTextures only
+	ComPtr<ID3D12CommandAllocator>		m_pUploadAllocator;
+	ComPtr<ID3D12GraphicsCommandList>	m_pUploadList;
+
 	D3D12TextureMgr() : m_NextSRVIndex(0), m_bInitialized(false) {}
 
 public:
@@ -40,6 +44,9 @@ public:
 	bool LockTexture(jeTexture* pTexture, int32 MipLevel, void** ppData);
 	bool UnlockTexture(jeTexture* pTexture, int32 MipLevel);
 
+	// Copies every upload through one upload heap and one command list, then waits for it
+	bool UploadTextures(const DRV_TextureUpload* pUploads, int32 NumUploads);
+
 	bool GetTextureInfo(jeTexture* pTexture, int32 MipLevel, jeTexture_Info* pInfo);
 
 	UINT GetNextSRVIndex() { return m_NextSRVIndex++; }
@@ -1208,6 +1208,8 @@ D3D12Driver g_D3D12Drv = {
 	D3D12Drv_DestroyFont,
 
 	D3D12Drv_SetRenderState,
+
+	D3D12_THandle_UploadBatch,
 };
 
 extern "C" DRIVERAPI BOOL DriverHook(DRV_Driver** Driver)
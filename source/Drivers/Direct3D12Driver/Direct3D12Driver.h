@@ -171,6 +171,7 @@ jeBoolean								DRIVERCC D3D12_THandle_Destroy(jeTexture* THandle);
 jeBoolean								DRIVERCC D3D12_THandle_Lock(jeTexture* THandle, int32 MipLevel, void** Data);
 jeBoolean								DRIVERCC D3D12_THandle_Unlock(jeTexture* THandle, int32 MipLevel);
 jeBoolean								DRIVERCC D3D12_THandle_GetInfo(jeTexture* THandle, int32 MipLevel, jeTexture_Info* Info);
+jeBoolean								DRIVERCC D3D12_THandle_UploadBatch(const DRV_TextureUpload* Uploads, int32 NumUploads);
 jeBoolean								D3D12_THandle_Startup(void);
 jeBoolean								D3D12_THandle_Shutdown(void);
 
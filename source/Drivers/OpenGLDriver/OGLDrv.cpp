@@ -1106,7 +1106,9 @@ DRV_Driver OGLDRV =
 	NULL,
 	NULL,
 
-	OGLDrv_SetRenderState
+	OGLDrv_SetRenderState,
+
+	NULL		// THandle_UploadBatch
 };
 
 DRIVERAPI BOOL DriverHook(DRV_Driver **Driver)
@@ -0,0 +1,1102 @@
+/****************************************************************************************/
+/*  SOFTDRIVER.CPP                                                                      */
+/*                                                                                      */
+/*  Author: Styx3D Modernization                                                        */
+/*  Description: Headless software rasterizer driver                                    */
+/*                                                                                      */
+/*  Renders into an in-memory framebuffer with no window or GPU, so the engine can be   */
+/*  run and timed end to end on build machines.  The framebuffer is only ever seen      */
+/*  through ScreenShot.                                                                 */
+/*                                                                                      */
+/*  The contents of this file are subject to the 0BSD License.                          */
+/*  See LICENSE file in the project root for full license information.                  */
+/*                                                                                      */
+/****************************************************************************************/
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <vector>
+#include <algorithm>
+
+#include "SoftDriver.h"
+#include "SoftTextures.h"
+#include "SoftRaster.h"
+
+#define SOFTDRV_NEAR_Z						(1.0f)		// Camera space near plane for static meshes
+
+typedef struct SoftDrv_Mode
+{
+	int32					Width;
+	int32					Height;
+} SoftDrv_Mode;
+
+typedef struct SoftDrv_StaticMesh
+{
+	std::vector<jeHWVertex>	Verts;
+	jeRDriver_Layer			Layers[2];
+	int32					NumLayers;
+	uint32					Flags;
+} SoftDrv_StaticMesh;
+
+static const SoftDrv_Mode					g_Modes[] =
+{
+	{	320,	240		},
+	{	640,	480		},
+	{	800,	600		},
+	{	1024,	768		},
+	{	1280,	720		},
+	{	1920,	1080	},
+};
+
+#define NUM_MODES	( sizeof(g_Modes) / sizeof(g_Modes[0]) )
+
+static jeRDriver_PixelFormat				g_PixelFormats[] =
+{
+	{	JE_PIXELFORMAT_32BIT_ARGB,		RDRIVER_PF_3D | RDRIVER_PF_COMBINE_LIGHTMAP		},
+	{	JE_PIXELFORMAT_32BIT_ARGB,		RDRIVER_PF_3D | RDRIVER_PF_ALPHA				},
+	{	JE_PIXELFORMAT_32BIT_ARGB,		RDRIVER_PF_2D | RDRIVER_PF_ALPHA				},
+	{	JE_PIXELFORMAT_24BIT_RGB,		RDRIVER_PF_2D | RDRIVER_PF_CAN_DO_COLORKEY		},
+	{	JE_PIXELFORMAT_24BIT_RGB,		RDRIVER_PF_LIGHTMAP								},
+	{	JE_PIXELFORMAT_32BIT_ARGB,		RDRIVER_PF_PALETTE								},
+};
+
+#define NUM_PIXEL_FORMATS	( sizeof(g_PixelFormats) / sizeof(g_PixelFormats[0]) )
+
+DRV_Window									g_ClientWindow;
+
+float										g_CurrentGamma = 1.0f;
+uint8										g_GammaLut[256];
+
+static char									g_LastErrorStr[256];
+static DRV_EngineSettings					g_EngineSettings;
+
+static jeBoolean							g_Initialized = JE_FALSE;
+static jeBoolean							g_InScene = JE_FALSE;
+
+// Render states
+static jeBoolean							g_ZEnable = JE_TRUE;
+static jeBoolean							g_ZWrites = JE_TRUE;
+static jeBoolean							g_AlphaBlend = JE_TRUE;
+static jeBoolean							g_FogEnable = JE_FALSE;
+static float								g_FogColor[3] = { 0.0f, 0.0f, 0.0f };
+static float								g_FogStart = 0.0f;
+static float								g_FogEnd = 0.0f;
+
+// Hardware T&L state, only the static meshes consume these
+static jeXForm3d							g_Matrices[3];
+
+static std::vector<SoftDrv_StaticMesh*>		g_StaticMeshes;
+
+//=====================================================================================
+//	SoftDrv_SetLastError
+//=====================================================================================
+void SoftDrv_SetLastError(int32 Error, const char *Str)
+{
+	g_SoftDrv.LastError = Error;
+
+	strncpy(g_LastErrorStr, Str ? Str : "", sizeof(g_LastErrorStr)-1);
+	g_LastErrorStr[sizeof(g_LastErrorStr)-1] = 0;
+}
+
+static void BuildGammaLut(float Gamma)
+{
+	int32		i;
+
+	for (i = 0; i < 256; i++)
+	{
+		int32	Val = (int32)(255.0 * pow(i / 255.0, 1.0 / Gamma) + 0.5);
+
+		g_GammaLut[i] = (uint8)JE_CLAMP8(Val);
+	}
+}
+
+static void ApplyFog(void)
+{
+	SoftRaster_SetFog(g_FogEnable, g_FogColor[0], g_FogColor[1], g_FogColor[2], g_FogStart, g_FogEnd);
+}
+
+//=====================================================================================
+//	Enumeration
+//=====================================================================================
+jeBoolean DRIVERCC SoftDrv_EnumSubDrivers(DRV_ENUM_DRV_CB *Cb, void *Context)
+{
+	Cb(0, (char*)SOFTDRV_NAME, Context);
+	return JE_TRUE;
+}
+
+jeBoolean DRIVERCC SoftDrv_EnumModes(S32 Driver, char *DriverName, DRV_ENUM_MODES_CB *Cb, void *Context)
+{
+	for (int32 i = 0; i < (int32)NUM_MODES; i++)
+	{
+		char		ModeName[32];
+
+		sprintf(ModeName, "%dx%dx32", (int)g_Modes[i].Width, (int)g_Modes[i].Height);
+
+		if (!Cb(i, ModeName, g_Modes[i].Width, g_Modes[i].Height, 32, Context))
+			break;
+	}
+
+	return JE_TRUE;
+}
+
+jeBoolean DRIVERCC SoftDrv_EnumPixelFormats(DRV_ENUM_PFORMAT_CB *Cb, void *Context)
+{
+	for (int32 i = 0; i < (int32)NUM_PIXEL_FORMATS; i++)
+	{
+		if (!Cb(&g_PixelFormats[i], Context))
+			return JE_TRUE;
+	}
+
+	return JE_TRUE;
+}
+
+jeBoolean DRIVERCC SoftDrv_GetDeviceCaps(jeDeviceCaps *DeviceCaps)
+{
+	DeviceCaps->SuggestedDefaultRenderFlags = 0;
+	DeviceCaps->CanChangeRenderFlags = JE_RENDER_FLAG_BILINEAR_FILTER;
+
+	return JE_TRUE;
+}
+
+//=====================================================================================
+//	SoftDrv_Init
+//=====================================================================================
+jeBoolean DRIVERCC SoftDrv_Init(DRV_DriverHook *Hook)
+{
+	int32		Width, Height, NumThreads;
+	const char	*Env;
+
+	if (g_Initialized)
+		SoftDrv_Shutdown();
+
+	Width = SOFTDRV_DEFAULT_WIDTH;
+	Height = SOFTDRV_DEFAULT_HEIGHT;
+
+	if (Hook)
+	{
+		if (Hook->Width > 0 && Hook->Height > 0)
+		{
+			Width = Hook->Width;
+			Height = Hook->Height;
+		}
+		else if (Hook->Mode >= 0 && Hook->Mode < (S32)NUM_MODES)
+		{
+			Width = g_Modes[Hook->Mode].Width;
+			Height = g_Modes[Hook->Mode].Height;
+		}
+
+		Hook->Width = Width;
+		Hook->Height = Height;
+	}
+
+	// 0 (or unset) means one worker per core
+	NumThreads = 0;
+	Env = getenv("JET_SOFTDRV_THREADS");
+	if (Env)
+		NumThreads = atoi(Env);
+
+	if (!SoftRaster_Create(Width, Height, NumThreads))
+	{
+		SoftDrv_SetLastError(DRV_ERROR_INIT_ERROR, "SoftDrv_Init:  Could not create the framebuffer.");
+		return JE_FALSE;
+	}
+
+	memset(&g_ClientWindow, 0, sizeof(g_ClientWindow));
+	g_ClientWindow.hWnd = Hook ? Hook->hWnd : NULL;
+	g_ClientWindow.Buffer = (U8*)SoftRaster_GetFrameBuffer(NULL, NULL);
+	g_ClientWindow.Width = Width;
+	g_ClientWindow.Height = Height;
+	g_ClientWindow.BytesPerPixel = 4;
+	g_ClientWindow.PixelPitch = Width*4;
+	g_ClientWindow.R_shift = 16;	g_ClientWindow.R_mask = 0x00FF0000;		g_ClientWindow.R_width = 8;
+	g_ClientWindow.G_shift = 8;		g_ClientWindow.G_mask = 0x0000FF00;		g_ClientWindow.G_width = 8;
+	g_ClientWindow.B_shift = 0;		g_ClientWindow.B_mask = 0x000000FF;		g_ClientWindow.B_width = 8;
+
+	for (int32 i = 0; i < 3; i++)
+		memset(&g_Matrices[i], 0, sizeof(jeXForm3d));
+
+	g_ZEnable = JE_TRUE;
+	g_ZWrites = JE_TRUE;
+	g_AlphaBlend = JE_TRUE;
+	g_FogEnable = JE_FALSE;
+
+	BuildGammaLut(g_CurrentGamma);
+
+	g_Initialized = JE_TRUE;
+
+	return JE_TRUE;
+}
+
+//=====================================================================================
+//	SoftDrv_Shutdown
+//=====================================================================================
+jeBoolean DRIVERCC SoftDrv_Shutdown(void)
+{
+	SoftRaster_Flush();
+
+	for (size_t i = 0; i < g_StaticMeshes.size(); i++)
+		delete g_StaticMeshes[i];
+
+	g_StaticMeshes.clear();
+
+	SoftTex_Shutdown();
+	SoftRaster_Destroy();
+
+	g_Initialized = JE_FALSE;
+	g_InScene = JE_FALSE;
+
+	return JE_TRUE;
+}
+
+jeBoolean DRIVERCC SoftDrv_UpdateWindow(void)
+{
+	return JE_TRUE;
+}
+
+jeBoolean DRIVERCC SoftDrv_SetActive(jeBoolean Active)
+{
+	return JE_TRUE;
+}
+
+//=====================================================================================
+//	Scene management
+//=====================================================================================
+jeBoolean DRIVERCC SoftDrv_BeginScene(jeBoolean Clear, jeBoolean ClearZ, RECT *WorldRect, jeBoolean Wireframe)
+{
+	if (!g_Initialized)
+	{
+		SoftDrv_SetLastError(DRV_ERROR_GENERIC, "SoftDrv_BeginScene:  Driver not initialized.");
+		return JE_FALSE;
+	}
+
+	SoftRaster_Clear(Clear, ClearZ);
+
+	g_SoftDrv.NumRenderedPolys = 0;
+	g_SoftDrv.NumWorldPixels = 0;
+	g_SoftDrv.NumWorldSpans = 0;
+	SoftRaster_TakeWorldPixelCount();
+
+	g_InScene = JE_TRUE;
+
+	return JE_TRUE;
+}
+
+jeBoolean DRIVERCC SoftDrv_EndScene(void)
+{
+	SoftRaster_Flush();
+
+	g_SoftDrv.NumWorldPixels += SoftRaster_TakeWorldPixelCount();
+	g_InScene = JE_FALSE;
+
+	return JE_TRUE;
+}
+
+jeBoolean DRIVERCC SoftDrv_BeginBatch(void)
+{
+	return JE_TRUE;
+}
+
+jeBoolean DRIVERCC SoftDrv_EndBatch(void)
+{
+	// Batches only order the engine's poly submission, tiles are resolved at EndScene
+	return JE_TRUE;
+}
+
+//=====================================================================================
+//	Render helpers
+//=====================================================================================
+static uint32 GetRasterMode(uint32 Flags)
+{
+	uint32		Mode = 0;
+
+	if (g_ZEnable && !(Flags & JE_RENDER_FLAG_NO_ZTEST))
+		Mode |= SOFTRASTER_ZTEST;
+
+	if (g_ZWrites && !(Flags & JE_RENDER_FLAG_NO_ZWRITE))
+		Mode |= SOFTRASTER_ZWRITE;
+
+	if (g_AlphaBlend && (Flags & JE_RENDER_FLAG_ALPHA))
+		Mode |= SOFTRASTER_BLEND;
+
+	if (Flags & JE_RENDER_FLAG_CLAMP_UV)
+		Mode |= SOFTRASTER_CLAMPUV;
+
+	if (Flags & JE_RENDER_FLAG_BILINEAR_FILTER)
+		Mode |= SOFTRASTER_BILINEAR;
+
+	return Mode;
+}
+
+static uint32 GetTextureMode(const jeTexture *THandle, uint32 Flags)
+{
+	uint32		Mode = 0;
+
+	if ((Flags & JE_RENDER_FLAG_COLORKEY) || (THandle->Format.Flags & RDRIVER_PF_CAN_DO_COLORKEY))
+		Mode |= SOFTRASTER_ALPHATEST;
+
+	if (THandle->AlphaHandle || (THandle->Format.Flags & RDRIVER_PF_ALPHA))
+	{
+		Mode |= SOFTRASTER_ALPHATEST;
+
+		if (g_AlphaBlend)
+			Mode |= SOFTRASTER_BLEND;
+	}
+
+	return Mode;
+}
+
+static void CopyVertex(SoftRaster_Vertex *Dst, const jeTLVertex *Src, uint32 Flags)
+{
+	Dst->x = Src->x;
+	Dst->y = Src->y;
+	Dst->z = Src->z;
+	Dst->r = Src->r;
+	Dst->g = Src->g;
+	Dst->b = Src->b;
+	Dst->a = (Flags & JE_RENDER_FLAG_ALPHA) ? Src->a : 255.0f;
+	Dst->u = 0.0f;
+	Dst->v = 0.0f;
+	Dst->lu = 0.0f;
+	Dst->lv = 0.0f;
+}
+
+//=====================================================================================
+//	SoftDrv_RenderGouraudPoly
+//=====================================================================================
+jeBoolean DRIVERCC SoftDrv_RenderGouraudPoly(jeTLVertex *Pnts, int32 NumPoints, uint32 Flags)
+{
+	std::vector<SoftRaster_Vertex>	Verts;
+
+	// Nothing to draw, and &Verts[0] needs at least one vertex
+	if (NumPoints < 3)
+		return JE_TRUE;
+
+	Verts.resize(NumPoints);
+
+	for (int32 i = 0; i < NumPoints; i++)
+		CopyVertex(&Verts[i], &Pnts[i], Flags);
+
+	SoftRaster_SubmitPoly(&Verts[0], NumPoints, NULL, NULL, GetRasterMode(Flags));
+
+	g_SoftDrv.NumRenderedPolys++;
+
+	return JE_TRUE;
+}
+
+//=====================================================================================
+//	SoftDrv_RenderWorldPoly
+//	Texture uv's are scaled and shifted as in the D3D drivers, lightmap uv's are in
+//	world units with 16 units per lumel
+//=====================================================================================
+jeBoolean DRIVERCC SoftDrv_RenderWorldPoly(jeTLVertex *Pnts, int32 NumPoints, jeRDriver_Layer *Layers, int32 NumLayers, void *LMapCBContext, uint32 Flags)
+{
+	std::vector<SoftRaster_Vertex>	Verts;
+	SoftRaster_Surface				Tex, LMap;
+	jeBoolean						HasTex, HasLMap;
+	float							ScaleU, ScaleV, TexScaleU, TexScaleV;
+	float							LShiftU = 0.0f, LShiftV = 0.0f;
+	uint32							Mode;
+
+	// Nothing to draw, and &Verts[0] needs at least one vertex
+	if (NumPoints < 3)
+		return JE_TRUE;
+
+	Verts.resize(NumPoints);
+
+	assert(Layers);
+
+	Mode = GetRasterMode(Flags) | SOFTRASTER_WORLD;
+
+	HasTex = (Layers[0].THandle && SoftTex_GetSurface(Layers[0].THandle, &Tex)) ? JE_TRUE : JE_FALSE;
+	HasLMap = JE_FALSE;
+
+	if (HasTex)
+		Mode |= GetTextureMode(Layers[0].THandle, Flags);
+
+	if (NumLayers > 1 && Layers[1].THandle && LMapCBContext)
+	{
+		jeRDriver_LMapCBInfo	LMapCBInfo;
+		jeTexture				*LHandle = Layers[1].THandle;
+
+		g_SoftDrv.SetupLightmap(&LMapCBInfo, LMapCBContext);
+
+		if (LMapCBInfo.Dynamic || !(LHandle->Flags & THANDLE_HAS_LIGHTMAP))
+		{
+			// Tris queued from the last dynamic update still sample these lumels
+			if (LHandle->Flags & THANDLE_HAS_LIGHTMAP)
+				SoftRaster_Flush();
+
+			if (SoftTex_SetLightmap(LHandle, (const uint8*)LMapCBInfo.RGBLight[0]))
+				LHandle->Flags |= THANDLE_HAS_LIGHTMAP;
+		}
+
+		if (LHandle->Flags & THANDLE_HAS_LIGHTMAP)
+		{
+			memset(&LMap, 0, sizeof(LMap));
+			LMap.Mips[0] = LHandle->Texels[0];
+			LMap.Width = LHandle->Width;
+			LMap.Height = LHandle->Height;
+			LMap.NumMips = 1;
+
+			LShiftU = -Layers[1].ShiftU + 8.0f;
+			LShiftV = -Layers[1].ShiftV + 8.0f;
+			HasLMap = JE_TRUE;
+
+			if (Layers[1].Rop == Rop_MultiplyX2 || Layers[1].Rop == Rop_MultiplyX4)
+				Mode |= SOFTRASTER_LMAP_X2;
+			else if (Layers[1].Rop == Rop_Add)
+				Mode |= SOFTRASTER_LMAP_ADD;
+		}
+	}
+
+	ScaleU = 1.0f / Layers[0].ScaleU;
+	ScaleV = 1.0f / Layers[0].ScaleV;
+	TexScaleU = TexScaleV = 0.0f;
+
+	if (HasTex)
+	{
+		float	InvScale = 1.0f / (float)(1 << Layers[0].THandle->Log);
+
+		TexScaleU = InvScale * (float)Tex.Width;
+		TexScaleV = InvScale * (float)Tex.Height;
+	}
+
+	for (int32 i = 0; i < NumPoints; i++)
+	{
+		SoftRaster_Vertex	*pVert = &Verts[i];
+
+		CopyVertex(pVert, &Pnts[i], Flags);
+
+		pVert->u = (Pnts[i].u * ScaleU + Layers[0].ShiftU) * TexScaleU;
+		pVert->v = (Pnts[i].v * ScaleV + Layers[0].ShiftV) * TexScaleV;
+
+		if (HasLMap)
+		{
+			pVert->lu = (Pnts[i].u + LShiftU) * (1.0f/16.0f);
+			pVert->lv = (Pnts[i].v + LShiftV) * (1.0f/16.0f);
+		}
+	}
+
+	SoftRaster_SubmitPoly(&Verts[0], NumPoints, HasTex ? &Tex : NULL, HasLMap ? &LMap : NULL, Mode);
+
+	g_SoftDrv.NumRenderedPolys++;
+
+	return JE_TRUE;
+}
+
+//=====================================================================================
+//	SoftDrv_RenderMiscTexturePoly
+//	uv's are normalized
+//=====================================================================================
+jeBoolean DRIVERCC SoftDrv_RenderMiscTexturePoly(jeTLVertex *Pnts, int32 NumPoints, jeRDriver_Layer *Layers, int32 NumLayers, uint32 Flags)
+{
+	std::vector<SoftRaster_Vertex>	Verts;
+	SoftRaster_Surface				Tex;
+	jeBoolean						HasTex;
+	uint32							Mode;
+
+	// Nothing to draw, and &Verts[0] needs at least one vertex
+	if (NumPoints < 3)
+		return JE_TRUE;
+
+	Verts.resize(NumPoints);
+
+	Mode = GetRasterMode(Flags);
+
+	HasTex = (Layers && Layers[0].THandle && SoftTex_GetSurface(Layers[0].THandle, &Tex)) ? JE_TRUE : JE_FALSE;
+
+	if (HasTex)
+		Mode |= GetTextureMode(Layers[0].THandle, Flags);
+
+	for (int32 i = 0; i < NumPoints; i++)
+	{
+		CopyVertex(&Verts[i], &Pnts[i], Flags);
+
+		if (HasTex)
+		{
+			Verts[i].u = Pnts[i].u * (float)Tex.Width;
+			Verts[i].v = Pnts[i].v * (float)Tex.Height;
+		}
+	}
+
+	SoftRaster_SubmitPoly(&Verts[0], NumPoints, HasTex ? &Tex : NULL, NULL, Mode);
+
+	g_SoftDrv.NumRenderedPolys++;
+
+	return JE_TRUE;
+}
+
+//=====================================================================================
+//	SoftDrv_DrawDecal
+//	Decals go straight to the framebuffer, so the queued tris are resolved first
+//=====================================================================================
+jeBoolean DRIVERCC SoftDrv_DrawDecal(jeTexture *THandle, RECT *SRect, int32 x, int32 y)
+{
+	SoftRaster_Surface		Surface;
+	uint32_t				*Frame;
+	int32					Width, Height, sx0, sy0, sx1, sy1, px, py;
+
+	if (!THandle || !SoftTex_GetSurface(THandle, &Surface))
+		return JE_FALSE;
+
+	SoftRaster_Flush();
+
+	Frame = SoftRaster_GetFrameBuffer(&Width, &Height);
+	if (!Frame)
+		return JE_FALSE;
+
+	if (SRect)
+	{
+		sx0 = SRect->left;
+		sy0 = SRect->top;
+		sx1 = SRect->right;
+		sy1 = SRect->bottom;
+	}
+	else
+	{
+		sx0 = sy0 = 0;
+		sx1 = Surface.Width;
+		sy1 = Surface.Height;
+	}
+
+	sx0 = JE_CLAMP(sx0, 0, Surface.Width);
+	sy0 = JE_CLAMP(sy0, 0, Surface.Height);
+	sx1 = JE_CLAMP(sx1, 0, Surface.Width);
+	sy1 = JE_CLAMP(sy1, 0, Surface.Height);
+
+	for (py = sy0; py < sy1; py++)
+	{
+		int32				dy = y + (py - sy0);
+		const uint32_t		*Src;
+
+		if (dy < 0 || dy >= Height)
+			continue;
+
+		Src = Surface.Mips[0] + py*Surface.Width;
+
+		for (px = sx0; px < sx1; px++)
+		{
+			int32		dx = x + (px - sx0);
+			uint32_t	Texel = Src[px];
+			uint32_t	a;
+
+			if (dx < 0 || dx >= Width)
+				continue;
+
+			a = Texel >> 24;
+
+			if (a == 0)
+				continue;
+
+			if (a < 255)
+			{
+				uint32_t	Dst = Frame[dy*Width + dx];
+				uint32_t	r, g, b;
+
+				r = (((Texel >> 16) & 0xFF)*a + ((Dst >> 16) & 0xFF)*(255-a)) / 255;
+				g = (((Texel >>  8) & 0xFF)*a + ((Dst >>  8) & 0xFF)*(255-a)) / 255;
+				b = (((Texel      ) & 0xFF)*a + ((Dst      ) & 0xFF)*(255-a)) / 255;
+
+				Texel = (r << 16) | (g << 8) | b;
+			}
+
+			Frame[dy*Width + dx] = Texel | 0xFF000000u;
+		}
+	}
+
+	return JE_TRUE;
+}
+
+//=====================================================================================
+//	SoftDrv_ScreenShot
+//	Writes a 24 bit bottom-up .bmp, with the current gamma applied
+//=====================================================================================
+static void PutLE16(uint8 *p, uint32_t v)	{ p[0] = (uint8)v; p[1] = (uint8)(v >> 8); }
+static void PutLE32(uint8 *p, uint32_t v)	{ p[0] = (uint8)v; p[1] = (uint8)(v >> 8); p[2] = (uint8)(v >> 16); p[3] = (uint8)(v >> 24); }
+
+jeBoolean DRIVERCC SoftDrv_ScreenShot(const char *Name)
+{
+	uint8				Header[54];
+	const uint32_t		*Frame;
+	int32				Width, Height, Pitch, x, y;
+	std::vector<uint8>	Row;
+	FILE				*f;
+
+	if (!Name)
+		return JE_FALSE;
+
+	SoftRaster_Flush();
+
+	Frame = SoftRaster_GetFrameBuffer(&Width, &Height);
+	if (!Frame)
+		return JE_FALSE;
+
+	Pitch = (Width*3 + 3) & ~3;
+
+	memset(Header, 0, sizeof(Header));
+	Header[0] = 'B';
+	Header[1] = 'M';
+	PutLE32(Header + 2, (uint32_t)(sizeof(Header) + Pitch*Height));
+	PutLE32(Header + 10, (uint32_t)sizeof(Header));
+	PutLE32(Header + 14, 40);
+	PutLE32(Header + 18, (uint32_t)Width);
+	PutLE32(Header + 22, (uint32_t)Height);
+	PutLE16(Header + 26, 1);
+	PutLE16(Header + 28, 24);
+	PutLE32(Header + 34, (uint32_t)(Pitch*Height));
+
+	f = fopen(Name, "wb");
+	if (!f)
+	{
+		SoftDrv_SetLastError(DRV_ERROR_GENERIC, "SoftDrv_ScreenShot:  Could not open file.");
+		return JE_FALSE;
+	}
+
+	fwrite(Header, 1, sizeof(Header), f);
+
+	Row.assign(Pitch, 0);
+
+	for (y = Height-1; y >= 0; y--)
+	{
+		const uint32_t	*Src = Frame + y*Width;
+
+		for (x = 0; x < Width; x++)
+		{
+			Row[x*3 + 0] = g_GammaLut[(Src[x]      ) & 0xFF];
+			Row[x*3 + 1] = g_GammaLut[(Src[x] >>  8) & 0xFF];
+			Row[x*3 + 2] = g_GammaLut[(Src[x] >> 16) & 0xFF];
+		}
+
+		fwrite(&Row[0], 1, Pitch, f);
+	}
+
+	fclose(f);
+
+	return JE_TRUE;
+}
+
+//=====================================================================================
+//	Gamma
+//=====================================================================================
+jeBoolean DRIVERCC SoftDrv_SetGamma(float Gamma)
+{
+	if (Gamma <= 0.0f)
+		return JE_FALSE;
+
+	g_CurrentGamma = Gamma;
+	BuildGammaLut(Gamma);
+
+	return JE_TRUE;
+}
+
+jeBoolean DRIVERCC SoftDrv_GetGamma(float *Gamma)
+{
+	*Gamma = g_CurrentGamma;
+	return JE_TRUE;
+}
+
+//=====================================================================================
+//	Hardware T&L
+//=====================================================================================
+jeBoolean DRIVERCC SoftDrv_SetMatrix(uint32 Type, jeXForm3d *Matrix)
+{
+	if (Type > JE_XFORM_TYPE_PROJECTION || !Matrix)
+		return JE_FALSE;
+
+	g_Matrices[Type] = *Matrix;
+	return JE_TRUE;
+}
+
+jeBoolean DRIVERCC SoftDrv_GetMatrix(uint32 Type, jeXForm3d *Matrix)
+{
+	if (Type > JE_XFORM_TYPE_PROJECTION || !Matrix)
+		return JE_FALSE;
+
+	*Matrix = g_Matrices[Type];
+	return JE_TRUE;
+}
+
+jeBoolean DRIVERCC SoftDrv_SetCamera(jeCamera *Camera)
+{
+	return JE_TRUE;
+}
+
+//=====================================================================================
+//	SoftDrv_SetFog
+//=====================================================================================
+jeBoolean DRIVERCC SoftDrv_SetFog(float r, float g, float b, float Start, float End, jeBoolean Enable)
+{
+	g_FogColor[0] = r;
+	g_FogColor[1] = g;
+	g_FogColor[2] = b;
+	g_FogStart = Start;
+	g_FogEnd = End;
+	g_FogEnable = Enable;
+
+	ApplyFog();
+
+	return JE_TRUE;
+}
+
+//=====================================================================================
+//	Static meshes
+//	Meshes are triangle lists in world space.  They go through the WORLD and VIEW
+//	matrices into Jet camera space (-Z forward, as in jeCamera_Project), then onto the
+//	screen with the focal length in PROJECTION.AX (in pixels, Width/2 if unset).
+//=====================================================================================
+static void TransformPoint(const jeXForm3d *M, const jeVec3d *In, jeVec3d *Out)
+{
+	jeVec3d		v = *In;
+
+	Out->X = M->AX*v.X + M->AY*v.Y + M->AZ*v.Z + M->Translation.X;
+	Out->Y = M->BX*v.X + M->BY*v.Y + M->BZ*v.Z + M->Translation.Y;
+	Out->Z = M->CX*v.X + M->CY*v.Y + M->CZ*v.Z + M->Translation.Z;
+}
+
+static jeBoolean IsIdentityUnset(const jeXForm3d *M)
+{
+	return (M->AX == 0.0f && M->BY == 0.0f && M->CZ == 0.0f) ? JE_TRUE : JE_FALSE;
+}
+
+typedef struct
+{
+	jeVec3d				Pos;			// Camera space, Z is forward distance
+	SoftRaster_Vertex	Vert;
+} SoftDrv_ClipVert;
+
+static void LerpClipVert(const SoftDrv_ClipVert *a, const SoftDrv_ClipVert *b, float t, SoftDrv_ClipVert *Out)
+{
+	Out->Pos.X = a->Pos.X + (b->Pos.X - a->Pos.X)*t;
+	Out->Pos.Y = a->Pos.Y + (b->Pos.Y - a->Pos.Y)*t;
+	Out->Pos.Z = a->Pos.Z + (b->Pos.Z - a->Pos.Z)*t;
+	Out->Vert.r = a->Vert.r + (b->Vert.r - a->Vert.r)*t;
+	Out->Vert.g = a->Vert.g + (b->Vert.g - a->Vert.g)*t;
+	Out->Vert.b = a->Vert.b + (b->Vert.b - a->Vert.b)*t;
+	Out->Vert.a = a->Vert.a + (b->Vert.a - a->Vert.a)*t;
+	Out->Vert.u = a->Vert.u + (b->Vert.u - a->Vert.u)*t;
+	Out->Vert.v = a->Vert.v + (b->Vert.v - a->Vert.v)*t;
+	Out->Vert.lu = a->Vert.lu + (b->Vert.lu - a->Vert.lu)*t;
+	Out->Vert.lv = a->Vert.lv + (b->Vert.lv - a->Vert.lv)*t;
+}
+
+uint32 DRIVERCC SoftDrv_StaticMesh_Add(jeHWVertex *Points, int32 NumPoints, jeRDriver_Layer *Layers, int32 NumLayers, uint32 Flags)
+{
+	SoftDrv_StaticMesh		*Mesh;
+
+	if (!Points || NumPoints <= 0)
+		return 0;
+
+	Mesh = new SoftDrv_StaticMesh;
+
+	Mesh->Verts.assign(Points, Points + NumPoints);
+	memset(Mesh->Layers, 0, sizeof(Mesh->Layers));
+	Mesh->NumLayers = std::min<int32>(NumLayers, 2);
+	Mesh->Flags = Flags;
+
+	if (Layers)
+	{
+		for (int32 i = 0; i < Mesh->NumLayers; i++)
+			Mesh->Layers[i] = Layers[i];
+	}
+
+	// Ids are 1 based, 0 is failure
+	for (size_t i = 0; i < g_StaticMeshes.size(); i++)
+	{
+		if (!g_StaticMeshes[i])
+		{
+			g_StaticMeshes[i] = Mesh;
+			return (uint32)i + 1;
+		}
+	}
+
+	g_StaticMeshes.push_back(Mesh);
+
+	return (uint32)g_StaticMeshes.size();
+}
+
+jeBoolean DRIVERCC SoftDrv_StaticMesh_Remove(uint32 id)
+{
+	if (id == 0 || id > g_StaticMeshes.size() || !g_StaticMeshes[id-1])
+		return JE_FALSE;
+
+	delete g_StaticMeshes[id-1];
+	g_StaticMeshes[id-1] = NULL;
+
+	return JE_TRUE;
+}
+
+jeBoolean DRIVERCC SoftDrv_StaticMesh_Render(uint32 id, int32 StartVertex, int32 NumPolys, jeXForm3d *XForm)
+{
+	SoftDrv_StaticMesh		*Mesh;
+	SoftRaster_Surface		Tex, LMap;
+	jeBoolean				HasTex, HasLMap;
+	const jeXForm3d			*View, *Proj;
+	float					Focal, XCenter, YCenter;
+	uint32					Mode;
+
+	if (id == 0 || id > g_StaticMeshes.size() || !g_StaticMeshes[id-1])
+		return JE_FALSE;
+
+	Mesh = g_StaticMeshes[id-1];
+
+	if (StartVertex < 0 || StartVertex + NumPolys*3 > (int32)Mesh->Verts.size())
+		return JE_FALSE;
+
+	View = &g_Matrices[JE_XFORM_TYPE_VIEW];
+	Proj = &g_Matrices[JE_XFORM_TYPE_PROJECTION];
+
+	XCenter = (float)g_ClientWindow.Width * 0.5f;
+	YCenter = (float)g_ClientWindow.Height * 0.5f;
+	Focal = (Proj->AX > 0.0f) ? Proj->AX : XCenter;
+
+	Mode = GetRasterMode(Mesh->Flags);
+
+	HasTex = (Mesh->NumLayers > 0 && Mesh->Layers[0].THandle && SoftTex_GetSurface(Mesh->Layers[0].THandle, &Tex)) ? JE_TRUE : JE_FALSE;
+	HasLMap = (Mesh->NumLayers > 1 && Mesh->Layers[1].THandle && SoftTex_GetSurface(Mesh->Layers[1].THandle, &LMap)) ? JE_TRUE : JE_FALSE;
+
+	if (HasTex)
+		Mode |= GetTextureMode(Mesh->Layers[0].THandle, Mesh->Flags);
+
+	for (int32 p = 0; p < NumPolys; p++)
+	{
+		SoftDrv_ClipVert	In[3], Out[4];
+		SoftRaster_Vertex	Verts[4];
+		int32				i, NumOut;
+
+		for (i = 0; i < 3; i++)
+		{
+			const jeHWVertex	*Src = &Mesh->Verts[StartVertex + p*3 + i];
+			jeVec3d				World;
+			uint32				Diffuse = Src->Diffuse;
+
+			World = Src->Pos;
+			if (XForm)
+				TransformPoint(XForm, &Src->Pos, &World);
+
+			if (IsIdentityUnset(View))
+				In[i].Pos = World;
+			else
+				TransformPoint(View, &World, &In[i].Pos);
+
+			In[i].Pos.Z = -In[i].Pos.Z;
+
+			memset(&In[i].Vert, 0, sizeof(In[i].Vert));
+			In[i].Vert.a = (float)((Diffuse >> 24) & 0xFF);
+			In[i].Vert.r = (float)((Diffuse >> 16) & 0xFF);
+			In[i].Vert.g = (float)((Diffuse >>  8) & 0xFF);
+			In[i].Vert.b = (float)((Diffuse      ) & 0xFF);
+
+			if (!(Mesh->Flags & JE_RENDER_FLAG_ALPHA))
+				In[i].Vert.a = 255.0f;
+
+			if (HasTex)
+			{
+				In[i].Vert.u = Src->u * (float)Tex.Width;
+				In[i].Vert.v = Src->v * (float)Tex.Height;
+			}
+
+			if (HasLMap)
+			{
+				In[i].Vert.lu = Src->lu * (float)LMap.Width;
+				In[i].Vert.lv = Src->lv * (float)LMap.Height;
+			}
+		}
+
+		// Clip against the near plane
+		NumOut = 0;
+		for (i = 0; i < 3; i++)
+		{
+			const SoftDrv_ClipVert	*a = &In[i];
+			const SoftDrv_ClipVert	*b = &In[(i+1)%3];
+			jeBoolean				aIn = (a->Pos.Z >= SOFTDRV_NEAR_Z) ? JE_TRUE : JE_FALSE;
+			jeBoolean				bIn = (b->Pos.Z >= SOFTDRV_NEAR_Z) ? JE_TRUE : JE_FALSE;
+
+			if (aIn)
+				Out[NumOut++] = *a;
+
+			if (aIn != bIn)
+				LerpClipVert(a, b, (SOFTDRV_NEAR_Z - a->Pos.Z) / (b->Pos.Z - a->Pos.Z), &Out[NumOut++]);
+		}
+
+		if (NumOut < 3)
+			continue;
+
+		for (i = 0; i < NumOut; i++)
+		{
+			float	Scale = Focal / Out[i].Pos.Z;
+
+			Verts[i] = Out[i].Vert;
+			Verts[i].x = XCenter + Out[i].Pos.X*Scale;
+			Verts[i].y = YCenter - Out[i].Pos.Y*Scale;
+			Verts[i].z = Out[i].Pos.Z;
+		}
+
+		SoftRaster_SubmitPoly(Verts, NumOut, HasTex ? &Tex : NULL, HasLMap ? &LMap : NULL, Mode);
+	}
+
+	g_SoftDrv.NumRenderedPolys += NumPolys;
+
+	return JE_TRUE;
+}
+
+//=====================================================================================
+//	SoftDrv_SetRenderState
+//=====================================================================================
+jeBoolean DRIVERCC SoftDrv_SetRenderState(uint32 State, uint32 Value)
+{
+	switch (State)
+	{
+		case JE_RENDERSTATE_ENABLE_ZBUFFER:
+			g_ZEnable = (Value != 0) ? JE_TRUE : JE_FALSE;
+			break;
+
+		case JE_RENDERSTATE_ENABLE_ZWRITES:
+			g_ZWrites = (Value != 0) ? JE_TRUE : JE_FALSE;
+			break;
+
+		case JE_RENDERSTATE_ENABLE_ALPHABLENDING:
+			g_AlphaBlend = (Value != 0) ? JE_TRUE : JE_FALSE;
+			break;
+
+		case JE_RENDERSTATE_ENABLE_FOG:
+			g_FogEnable = (Value != 0) ? JE_TRUE : JE_FALSE;
+			ApplyFog();
+			break;
+
+		case JE_RENDERSTATE_FOGCOLOR:
+		{
+			uint32		r, g, b;
+
+			r = (Value >> 16) & 0xFF;
+			g = (Value >> 8) & 0xFF;
+			b = Value & 0xFF;
+			g_FogColor[0] = (float)r;
+			g_FogColor[1] = (float)g;
+			g_FogColor[2] = (float)b;
+			ApplyFog();
+			break;
+		}
+
+		case JE_RENDERSTATE_FOGSTART:
+			g_FogStart = (float)Value;
+			ApplyFog();
+			break;
+
+		case JE_RENDERSTATE_FOGEND:
+			g_FogEnd = (float)Value;
+			ApplyFog();
+			break;
+
+		default:
+			// Stencil, fill and shade modes have no software equivalent
+			break;
+	}
+
+	return JE_TRUE;
+}
+
+DRV_Driver g_SoftDrv =
+{
+	(char*)"Software Driver v1.0",
+	DRV_VERSION_MAJOR,
+	DRV_VERSION_MINOR,
+
+	DRV_ERROR_NONE,
+	NULL,
+
+	SoftDrv_EnumSubDrivers,
+	SoftDrv_EnumModes,
+
+	SoftDrv_EnumPixelFormats,
+
+	SoftDrv_GetDeviceCaps,
+
+	SoftDrv_Init,
+	SoftDrv_Shutdown,
+	SoftDrv_Reset,
+	SoftDrv_UpdateWindow,
+	SoftDrv_SetActive,
+
+	SoftDrv_THandle_Create,
+	NULL,
+	SoftDrv_THandle_Destroy,
+
+	SoftDrv_THandle_Lock,
+	SoftDrv_THandle_UnLock,
+
+	SoftDrv_THandle_SetPalette,
+	SoftDrv_THandle_GetPalette,
+
+	SoftDrv_THandle_SetAlpha,
+	SoftDrv_THandle_GetAlpha,
+
+	SoftDrv_THandle_GetInfo,
+
+	SoftDrv_BeginScene,
+	SoftDrv_EndScene,
+	SoftDrv_BeginBatch,
+	SoftDrv_EndBatch,
+
+	SoftDrv_RenderGouraudPoly,
+	SoftDrv_RenderWorldPoly,
+	SoftDrv_RenderMiscTexturePoly,
+
+	SoftDrv_DrawDecal,
+
+	0, 0, 0,
+
+	NULL,
+
+	SoftDrv_ScreenShot,
+
+	SoftDrv_SetGamma,
+	SoftDrv_GetGamma,
+
+	SoftDrv_SetMatrix,
+	SoftDrv_GetMatrix,
+	SoftDrv_SetCamera,
+
+	NULL,
+	NULL,
+
+	NULL,
+	SoftDrv_SetFog,
+
+	SoftDrv_StaticMesh_Add,
+	SoftDrv_StaticMesh_Remove,
+	SoftDrv_StaticMesh_Render,
+
+	NULL,
+	NULL,
+	NULL,
+
+	SoftDrv_SetRenderState,
+
+	NULL		// THandle_UploadBatch
+};
+
+//=====================================================================================
+//	DriverHook
+//	Exported for jeEngine's driver scan, and callable directly through
+//	jeEngine_RegisterDriver when the driver is linked statically.
+//=====================================================================================
+DRIVERAPI jeBoolean DriverHook(DRV_Driver **Driver)
+{
+	g_EngineSettings.CanSupportFlags = (DRV_SUPPORT_ALPHA | DRV_SUPPORT_COLORKEY | DRV_SUPPORT_GAMMA);
+	g_EngineSettings.PreferenceFlags = DRV_PREFERENCE_NO_MIRRORS;
+
+	g_SoftDrv.EngineSettings = &g_EngineSettings;
+
+	// Make sure the error string ptr is not null, or invalid!!!
+	g_SoftDrv.LastErrorStr = g_LastErrorStr;
+	SoftDrv_SetLastError(DRV_ERROR_NONE, "No Error");
+
+	SoftTex_Startup();
+
+	*Driver = &g_SoftDrv;
+
+	return JE_TRUE;
+}
@@ -0,0 +1,87 @@
+/****************************************************************************************/
+/*  SOFTDRIVER.H                                                                        */
+/*                                                                                      */
+/*  Author: Styx3D Modernization                                                        */
+/*  Description: Headless software rasterizer driver                                    */
+/*                                                                                      */
+/*  The contents of this file are subject to the 0BSD License.                          */
+/*  See LICENSE file in the project root for full license information.                  */
+/*                                                                                      */
+/****************************************************************************************/
+#ifndef SOFTDRIVER_H
+#define SOFTDRIVER_H
+
+#ifdef WIN32
+#define DRIVERAPI	extern "C" _declspec(dllexport)
+#define NOMINMAX
+#include <windows.h>
+#else
+#define DRIVERAPI	extern "C" __attribute__((visibility("default")))
+
+// The engine headers are written against MSVC, neutralise the calling convention
+// and linkage keywords so they compile unchanged with gcc/clang
+#ifndef _fastcall
+#define _fastcall
+#define __fastcall
+#define __stdcall
+#define _declspec(x)
+#define __declspec(x)
+#define __inline	inline
+#endif
+#endif
+
+#include <stdint.h>
+
+#include "Dcommon.h"
+
+#define SOFTDRV_NAME					"Software Driver"
+#define SOFTDRV_DEFAULT_WIDTH			640
+#define SOFTDRV_DEFAULT_HEIGHT			480
+
+extern DRV_Driver						g_SoftDrv;
+extern DRV_Window						g_ClientWindow;
+
+extern float							g_CurrentGamma;
+extern uint8							g_GammaLut[256];
+
+void									SoftDrv_SetLastError(int32 Error, const char *Str);
+
+// Public Driver Functions
+jeBoolean DRIVERCC						SoftDrv_EnumSubDrivers(DRV_ENUM_DRV_CB *Cb, void *Context);
+jeBoolean DRIVERCC						SoftDrv_EnumModes(S32 Driver, char *DriverName, DRV_ENUM_MODES_CB *Cb, void *Context);
+jeBoolean DRIVERCC						SoftDrv_EnumPixelFormats(DRV_ENUM_PFORMAT_CB *Cb, void *Context);
+jeBoolean DRIVERCC						SoftDrv_GetDeviceCaps(jeDeviceCaps *DeviceCaps);
+
+jeBoolean DRIVERCC						SoftDrv_Init(DRV_DriverHook *Hook);
+jeBoolean DRIVERCC						SoftDrv_Shutdown(void);
+jeBoolean DRIVERCC						SoftDrv_UpdateWindow(void);
+jeBoolean DRIVERCC						SoftDrv_SetActive(jeBoolean Active);
+
+jeBoolean DRIVERCC						SoftDrv_BeginScene(jeBoolean Clear, jeBoolean ClearZ, RECT *WorldRect, jeBoolean Wireframe);
+jeBoolean DRIVERCC						SoftDrv_EndScene(void);
+jeBoolean DRIVERCC						SoftDrv_BeginBatch(void);
+jeBoolean DRIVERCC						SoftDrv_EndBatch(void);
+
+jeBoolean DRIVERCC						SoftDrv_RenderGouraudPoly(jeTLVertex *Pnts, int32 NumPoints, uint32 Flags);
+jeBoolean DRIVERCC						SoftDrv_RenderWorldPoly(jeTLVertex *Pnts, int32 NumPoints, jeRDriver_Layer *Layers, int32 NumLayers, void *LMapCBContext, uint32 Flags);
+jeBoolean DRIVERCC						SoftDrv_RenderMiscTexturePoly(jeTLVertex *Pnts, int32 NumPoints, jeRDriver_Layer *Layers, int32 NumLayers, uint32 Flags);
+
+jeBoolean DRIVERCC						SoftDrv_DrawDecal(jeTexture *THandle, RECT *SrcRect, int32 x, int32 y);
+jeBoolean DRIVERCC						SoftDrv_ScreenShot(const char *Name);
+
+jeBoolean DRIVERCC						SoftDrv_SetGamma(float Gamma);
+jeBoolean DRIVERCC						SoftDrv_GetGamma(float *Gamma);
+
+jeBoolean DRIVERCC						SoftDrv_SetMatrix(uint32 Type, jeXForm3d *Matrix);
+jeBoolean DRIVERCC						SoftDrv_GetMatrix(uint32 Type, jeXForm3d *Matrix);
+jeBoolean DRIVERCC						SoftDrv_SetCamera(jeCamera *Camera);
+
+jeBoolean DRIVERCC						SoftDrv_SetFog(float r, float g, float b, float Start, float End, jeBoolean Enable);
+
+uint32 DRIVERCC							SoftDrv_StaticMesh_Add(jeHWVertex *Points, int32 NumPoints, jeRDriver_Layer *Layers, int32 NumLayers, uint32 Flags);
+jeBoolean DRIVERCC						SoftDrv_StaticMesh_Remove(uint32 id);
+jeBoolean DRIVERCC						SoftDrv_StaticMesh_Render(uint32 id, int32 StartVertex, int32 NumPolys, jeXForm3d *XForm);
+
+jeBoolean DRIVERCC						SoftDrv_SetRenderState(uint32 State, uint32 Value);
+
+#endif // SOFTDRIVER_H
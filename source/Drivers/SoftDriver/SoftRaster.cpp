@@ -0,0 +1,688 @@
+/****************************************************************************************/
+/*  SOFTRASTER.CPP                                                                      */
+/*                                                                                      */
+/*  Author: Styx3D Modernization                                                        */
+/*  Description: Multithreaded tile based triangle rasterizer for the software driver   */
+/*                                                                                      */
+/*  Polys are fanned into triangles and binned into 64x64 screen tiles as they are      */
+/*  submitted.  A flush hands whole tiles to the worker threads, each tile replays its  */
+/*  triangles in submission order, so the output does not depend on the thread count.   */
+/*                                                                                      */
+/*  The contents of this file are subject to the 0BSD License.                          */
+/*  See LICENSE file in the project root for full license information.                  */
+/*                                                                                      */
+/****************************************************************************************/
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+#include "SoftRaster.h"
+
+typedef struct SoftRaster_Tri
+{
+	SoftRaster_Vertex			V[3];			// z holds 1/z, uv's are pre-multiplied by 1/z
+	uint32						Mode;
+
+	const uint32_t				*Tex;
+	int32						TexWidth, TexHeight;
+
+	const uint32_t				*LMap;
+	int32						LMapWidth, LMapHeight;
+
+	int32						MinX, MinY, MaxX, MaxY;
+} SoftRaster_Tri;
+
+typedef struct SoftRaster_Fog
+{
+	jeBoolean					Enable;
+	float						r, g, b;
+	float						Start, InvRange;
+} SoftRaster_Fog;
+
+static int32								g_Width = 0;
+static int32								g_Height = 0;
+static int32								g_TilesX = 0;
+static int32								g_TilesY = 0;
+
+static std::vector<uint32_t>				g_Color;
+static std::vector<float>					g_Depth;		// 1/z, 0 is infinitely far
+
+static std::vector<SoftRaster_Tri>			g_Tris;
+static std::vector< std::vector<uint32> >	g_Bins;
+
+static SoftRaster_Fog						g_Fog;
+static std::atomic<int32>					g_WorldPixels(0);
+
+// Worker pool
+static std::vector<std::thread>				g_Workers;
+static std::mutex							g_PoolLock;
+static std::condition_variable				g_PoolWake;
+static std::condition_variable				g_PoolDone;
+static uint32								g_PoolGeneration = 0;
+static int32								g_PoolBusy = 0;
+static jeBoolean							g_PoolQuit = JE_FALSE;
+static std::atomic<int32>					g_NextTile(0);
+
+//=====================================================================================
+//	Texel fetch
+//=====================================================================================
+static inline uint32_t FetchWrap(const uint32_t *Texels, int32 Width, int32 Height, int32 x, int32 y)
+{
+	x %= Width;
+	y %= Height;
+
+	if (x < 0)
+		x += Width;
+	if (y < 0)
+		y += Height;
+
+	return Texels[y*Width + x];
+}
+
+static inline uint32_t FetchClamp(const uint32_t *Texels, int32 Width, int32 Height, int32 x, int32 y)
+{
+	x = JE_CLAMP(x, 0, Width-1);
+	y = JE_CLAMP(y, 0, Height-1);
+
+	return Texels[y*Width + x];
+}
+
+static inline uint32_t Lerp8888(uint32_t c0, uint32_t c1, int32 f)		// f in 0..256
+{
+	uint32_t	rb, ag;
+
+	// Two channels per multiply, each lands in its own 16 bit lane
+	rb = (((c0 & 0x00FF00FF)*(uint32_t)(256-f) + (c1 & 0x00FF00FF)*(uint32_t)f) >> 8) & 0x00FF00FF;
+	ag = ((((c0 >> 8) & 0x00FF00FF)*(uint32_t)(256-f) + ((c1 >> 8) & 0x00FF00FF)*(uint32_t)f) >> 8) & 0x00FF00FF;
+
+	return rb | (ag << 8);
+}
+
+static inline uint32_t SampleBilinear(const uint32_t *Texels, int32 Width, int32 Height, float u, float v, jeBoolean Clamp)
+{
+	int32		x, y, fx, fy;
+	uint32_t	c00, c10, c01, c11;
+
+	u -= 0.5f;
+	v -= 0.5f;
+
+	x = (int32)floorf(u);
+	y = (int32)floorf(v);
+	fx = (int32)((u - (float)x) * 256.0f);
+	fy = (int32)((v - (float)y) * 256.0f);
+
+	if (Clamp)
+	{
+		c00 = FetchClamp(Texels, Width, Height, x, y);
+		c10 = FetchClamp(Texels, Width, Height, x+1, y);
+		c01 = FetchClamp(Texels, Width, Height, x, y+1);
+		c11 = FetchClamp(Texels, Width, Height, x+1, y+1);
+	}
+	else
+	{
+		c00 = FetchWrap(Texels, Width, Height, x, y);
+		c10 = FetchWrap(Texels, Width, Height, x+1, y);
+		c01 = FetchWrap(Texels, Width, Height, x, y+1);
+		c11 = FetchWrap(Texels, Width, Height, x+1, y+1);
+	}
+
+	return Lerp8888(Lerp8888(c00, c10, fx), Lerp8888(c01, c11, fx), fy);
+}
+
+static inline uint32_t SampleNearest(const uint32_t *Texels, int32 Width, int32 Height, float u, float v, jeBoolean Clamp)
+{
+	int32		x, y;
+
+	x = (int32)floorf(u);
+	y = (int32)floorf(v);
+
+	if (Clamp)
+		return FetchClamp(Texels, Width, Height, x, y);
+
+	return FetchWrap(Texels, Width, Height, x, y);
+}
+
+//=====================================================================================
+//	RasterTri
+//	Draws the part of Tri that falls inside [X0,X1)x[Y0,Y1).  Returns pixels written.
+//=====================================================================================
+static inline float Edge(const SoftRaster_Vertex *a, const SoftRaster_Vertex *b, float px, float py)
+{
+	return (b->x - a->x)*(py - a->y) - (b->y - a->y)*(px - a->x);
+}
+
+// Top-left fill convention, so pixels on a shared edge are owned by exactly one tri
+static inline float EdgeBias(const SoftRaster_Vertex *a, const SoftRaster_Vertex *b)
+{
+	float	dx = b->x - a->x;
+	float	dy = b->y - a->y;
+
+	if (dy > 0.0f || (dy == 0.0f && dx < 0.0f))
+		return 0.0f;
+
+	return -1e-6f;
+}
+
+static int32 RasterTri(const SoftRaster_Tri *Tri, int32 X0, int32 Y0, int32 X1, int32 Y1)
+{
+	const SoftRaster_Vertex	*A, *B, *C;
+	float					Area, InvArea;
+	float					Bias0, Bias1, Bias2;
+	int32					x, y, Count;
+	uint32					Mode;
+	jeBoolean				Clamp;
+
+	X0 = std::max<int32>(X0, Tri->MinX);
+	Y0 = std::max<int32>(Y0, Tri->MinY);
+	X1 = std::min<int32>(X1, Tri->MaxX+1);
+	Y1 = std::min<int32>(Y1, Tri->MaxY+1);
+
+	if (X0 >= X1 || Y0 >= Y1)
+		return 0;
+
+	A = &Tri->V[0];
+	B = &Tri->V[1];
+	C = &Tri->V[2];
+
+	Area = Edge(A, B, C->x, C->y);
+	if (Area > -1e-8f && Area < 1e-8f)
+		return 0;
+
+	if (Area < 0.0f)
+	{
+		const SoftRaster_Vertex *T = B;
+		B = C;
+		C = T;
+		Area = -Area;
+	}
+
+	InvArea = 1.0f / Area;
+
+	Bias0 = EdgeBias(B, C);
+	Bias1 = EdgeBias(C, A);
+	Bias2 = EdgeBias(A, B);
+
+	Mode = Tri->Mode;
+	Clamp = (Mode & SOFTRASTER_CLAMPUV) ? JE_TRUE : JE_FALSE;
+	Count = 0;
+
+	for (y = Y0; y < Y1; y++)
+	{
+		float		py = (float)y + 0.5f;
+		float		px = (float)X0 + 0.5f;
+		float		E0 = Edge(B, C, px, py);
+		float		E1 = Edge(C, A, px, py);
+		float		E2 = Edge(A, B, px, py);
+		float		dE0 = -(C->y - B->y);
+		float		dE1 = -(A->y - C->y);
+		float		dE2 = -(B->y - A->y);
+		uint32_t	*pColor = &g_Color[y*g_Width + X0];
+		float		*pDepth = &g_Depth[y*g_Width + X0];
+
+		for (x = X0; x < X1; x++, E0 += dE0, E1 += dE1, E2 += dE2, pColor++, pDepth++)
+		{
+			float		w0, w1, w2, W, InvW;
+			int32		r, g, b, a;
+
+			if (E0 + Bias0 < 0.0f || E1 + Bias1 < 0.0f || E2 + Bias2 < 0.0f)
+				continue;
+
+			w0 = E0 * InvArea;
+			w1 = E1 * InvArea;
+			w2 = E2 * InvArea;
+
+			W = w0*A->z + w1*B->z + w2*C->z;
+
+			if ((Mode & SOFTRASTER_ZTEST) && W < *pDepth)
+				continue;
+
+			InvW = 1.0f / W;
+
+			r = (int32)(w0*A->r + w1*B->r + w2*C->r + 0.5f);
+			g = (int32)(w0*A->g + w1*B->g + w2*C->g + 0.5f);
+			b = (int32)(w0*A->b + w1*B->b + w2*C->b + 0.5f);
+			a = (int32)(w0*A->a + w1*B->a + w2*C->a + 0.5f);
+
+			if (Tri->Tex)
+			{
+				float		u = (w0*A->u + w1*B->u + w2*C->u) * InvW;
+				float		v = (w0*A->v + w1*B->v + w2*C->v) * InvW;
+				uint32_t	Texel;
+
+				if (Mode & SOFTRASTER_BILINEAR)
+					Texel = SampleBilinear(Tri->Tex, Tri->TexWidth, Tri->TexHeight, u, v, Clamp);
+				else
+					Texel = SampleNearest(Tri->Tex, Tri->TexWidth, Tri->TexHeight, u, v, Clamp);
+
+				if ((Mode & SOFTRASTER_ALPHATEST) && (Texel >> 24) == 0)
+					continue;
+
+				r = (r * (int32)((Texel >> 16) & 0xFF)) / 255;
+				g = (g * (int32)((Texel >>  8) & 0xFF)) / 255;
+				b = (b * (int32)((Texel      ) & 0xFF)) / 255;
+				a = (a * (int32)((Texel >> 24)       )) / 255;
+			}
+
+			if (Tri->LMap)
+			{
+				float		lu = (w0*A->lu + w1*B->lu + w2*C->lu) * InvW;
+				float		lv = (w0*A->lv + w1*B->lv + w2*C->lv) * InvW;
+				uint32_t	Lumel = SampleBilinear(Tri->LMap, Tri->LMapWidth, Tri->LMapHeight, lu, lv, JE_TRUE);
+				int32		lr = (int32)((Lumel >> 16) & 0xFF);
+				int32		lg = (int32)((Lumel >>  8) & 0xFF);
+				int32		lb = (int32)((Lumel      ) & 0xFF);
+
+				if (Mode & SOFTRASTER_LMAP_ADD)
+				{
+					r += lr;
+					g += lg;
+					b += lb;
+				}
+				else if (Mode & SOFTRASTER_LMAP_X2)
+				{
+					r = (r * lr) >> 7;
+					g = (g * lg) >> 7;
+					b = (b * lb) >> 7;
+				}
+				else
+				{
+					r = (r * lr) / 255;
+					g = (g * lg) / 255;
+					b = (b * lb) / 255;
+				}
+			}
+
+			if (g_Fog.Enable)
+			{
+				float	f = (InvW - g_Fog.Start) * g_Fog.InvRange;
+
+				f = JE_CLAMP(f, 0.0f, 1.0f);
+				r = (int32)((float)r + ((g_Fog.r - (float)r) * f));
+				g = (int32)((float)g + ((g_Fog.g - (float)g) * f));
+				b = (int32)((float)b + ((g_Fog.b - (float)b) * f));
+			}
+
+			r = JE_CLAMP8(r);
+			g = JE_CLAMP8(g);
+			b = JE_CLAMP8(b);
+			a = JE_CLAMP8(a);
+
+			if ((Mode & SOFTRASTER_BLEND) && a < 255)
+			{
+				uint32_t	Dst = *pColor;
+				int32		ia = 255 - a;
+
+				r = (r*a + (int32)((Dst >> 16) & 0xFF)*ia) / 255;
+				g = (g*a + (int32)((Dst >>  8) & 0xFF)*ia) / 255;
+				b = (b*a + (int32)((Dst      ) & 0xFF)*ia) / 255;
+			}
+
+			*pColor = 0xFF000000u | ((uint32_t)r << 16) | ((uint32_t)g << 8) | (uint32_t)b;
+
+			if (Mode & SOFTRASTER_ZWRITE)
+				*pDepth = W;
+
+			Count++;
+		}
+	}
+
+	return Count;
+}
+
+//=====================================================================================
+//	Tile workers
+//=====================================================================================
+static void RasterTiles(void)
+{
+	int32		NumTiles = g_TilesX * g_TilesY;
+	int32		WorldPixels = 0;
+
+	for (;;)
+	{
+		int32					Tile, X0, Y0, X1, Y1;
+		const std::vector<uint32>	*Bin;
+
+		Tile = g_NextTile.fetch_add(1);
+		if (Tile >= NumTiles)
+			break;
+
+		Bin = &g_Bins[Tile];
+		if (Bin->empty())
+			continue;
+
+		X0 = (Tile % g_TilesX) << SOFTRASTER_TILE_SHIFT;
+		Y0 = (Tile / g_TilesX) << SOFTRASTER_TILE_SHIFT;
+		X1 = std::min<int32>(X0 + SOFTRASTER_TILE_SIZE, g_Width);
+		Y1 = std::min<int32>(Y0 + SOFTRASTER_TILE_SIZE, g_Height);
+
+		for (size_t i = 0; i < Bin->size(); i++)
+		{
+			const SoftRaster_Tri	*Tri = &g_Tris[(*Bin)[i]];
+			int32					Count;
+
+			Count = RasterTri(Tri, X0, Y0, X1, Y1);
+
+			if (Tri->Mode & SOFTRASTER_WORLD)
+				WorldPixels += Count;
+		}
+	}
+
+	g_WorldPixels.fetch_add(WorldPixels);
+}
+
+static void WorkerFunction(void)
+{
+	uint32		Generation = 0;
+
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex>	Lock(g_PoolLock);
+
+			g_PoolWake.wait(Lock, [&]{ return g_PoolQuit || g_PoolGeneration != Generation; });
+
+			if (g_PoolQuit)
+				return;
+
+			Generation = g_PoolGeneration;
+		}
+
+		RasterTiles();
+
+		{
+			std::lock_guard<std::mutex>		Lock(g_PoolLock);
+
+			if (--g_PoolBusy == 0)
+				g_PoolDone.notify_one();
+		}
+	}
+}
+
+//=====================================================================================
+//	SoftRaster_Create
+//=====================================================================================
+jeBoolean SoftRaster_Create(int32 Width, int32 Height, int32 NumThreads)
+{
+	assert(Width > 0 && Height > 0);
+
+	SoftRaster_Destroy();
+
+	g_Width = Width;
+	g_Height = Height;
+	g_TilesX = (Width + SOFTRASTER_TILE_SIZE - 1) >> SOFTRASTER_TILE_SHIFT;
+	g_TilesY = (Height + SOFTRASTER_TILE_SIZE - 1) >> SOFTRASTER_TILE_SHIFT;
+
+	g_Color.assign((size_t)Width*Height, 0xFF000000u);
+	g_Depth.assign((size_t)Width*Height, 0.0f);
+
+	g_Bins.clear();
+	g_Bins.resize((size_t)g_TilesX*g_TilesY);
+	g_Tris.clear();
+	g_Tris.reserve(4096);
+
+	memset(&g_Fog, 0, sizeof(g_Fog));
+
+	if (NumThreads <= 0)
+		NumThreads = (int32)std::thread::hardware_concurrency();
+
+	NumThreads = JE_CLAMP(NumThreads, 1, 64);
+
+	// The calling thread is worker 0
+	g_PoolQuit = JE_FALSE;
+	for (int32 i = 1; i < NumThreads; i++)
+		g_Workers.push_back(std::thread(WorkerFunction));
+
+	return JE_TRUE;
+}
+
+//=====================================================================================
+//	SoftRaster_Destroy
+//=====================================================================================
+void SoftRaster_Destroy(void)
+{
+	{
+		std::lock_guard<std::mutex>		Lock(g_PoolLock);
+		g_PoolQuit = JE_TRUE;
+	}
+	g_PoolWake.notify_all();
+
+	for (size_t i = 0; i < g_Workers.size(); i++)
+		g_Workers[i].join();
+
+	g_Workers.clear();
+
+	g_Color.clear();
+	g_Depth.clear();
+	g_Tris.clear();
+	g_Bins.clear();
+
+	g_Width = g_Height = 0;
+	g_TilesX = g_TilesY = 0;
+}
+
+//=====================================================================================
+//	SoftRaster_Clear
+//=====================================================================================
+void SoftRaster_Clear(jeBoolean ClearColor, jeBoolean ClearZ)
+{
+	// Anything still queued belongs to the previous frame
+	SoftRaster_Flush();
+
+	if (ClearColor)
+		std::fill(g_Color.begin(), g_Color.end(), 0xFF000000u);
+
+	if (ClearZ)
+		std::fill(g_Depth.begin(), g_Depth.end(), 0.0f);
+}
+
+//=====================================================================================
+//	SelectMip
+//	Picks the mip whose texel density is closest to one texel per pixel
+//=====================================================================================
+static int32 SelectMip(const SoftRaster_Vertex *Verts, int32 NumVerts, const SoftRaster_Surface *Tex)
+{
+	float		ScreenArea = 0.0f, TexArea = 0.0f;
+	int32		i, Level;
+
+	if (Tex->NumMips <= 1)
+		return 0;
+
+	for (i = 0; i < NumVerts; i++)
+	{
+		const SoftRaster_Vertex	*a = &Verts[i];
+		const SoftRaster_Vertex	*b = &Verts[(i+1) % NumVerts];
+
+		ScreenArea += a->x*b->y - b->x*a->y;
+		TexArea += a->u*b->v - b->u*a->v;
+	}
+
+	ScreenArea = fabsf(ScreenArea);
+	TexArea = fabsf(TexArea);
+
+	if (ScreenArea < 1.0f)
+		return Tex->NumMips-1;
+
+	Level = (int32)floorf(0.5f * log2f(std::max<float>(TexArea / ScreenArea, 1.0f)));
+	Level = JE_CLAMP(Level, 0, Tex->NumMips-1);
+
+	while (Level > 0 && !Tex->Mips[Level])
+		Level--;
+
+	return Level;
+}
+
+//=====================================================================================
+//	SoftRaster_SubmitPoly
+//=====================================================================================
+void SoftRaster_SubmitPoly(const SoftRaster_Vertex *Verts, int32 NumVerts, const SoftRaster_Surface *Tex, const SoftRaster_Surface *LMap, uint32 Mode)
+{
+	SoftRaster_Tri	Tri;
+	int32			i, Level;
+	float			MipScale;
+
+	assert(Verts);
+
+	if (NumVerts < 3 || g_Width <= 0)
+		return;
+
+	if (g_Tris.size() + NumVerts > SOFTRASTER_MAX_TRIS)
+		SoftRaster_Flush();
+
+	memset(&Tri, 0, sizeof(Tri));
+	Tri.Mode = Mode;
+
+	Level = 0;
+	MipScale = 1.0f;
+
+	if (Tex && Tex->Mips[0])
+	{
+		Level = SelectMip(Verts, NumVerts, Tex);
+		MipScale = 1.0f / (float)(1<<Level);
+
+		Tri.Tex = Tex->Mips[Level];
+		Tri.TexWidth = std::max<int32>(Tex->Width >> Level, 1);
+		Tri.TexHeight = std::max<int32>(Tex->Height >> Level, 1);
+	}
+
+	if (LMap && LMap->Mips[0])
+	{
+		Tri.LMap = LMap->Mips[0];
+		Tri.LMapWidth = LMap->Width;
+		Tri.LMapHeight = LMap->Height;
+	}
+
+	for (i = 1; i < NumVerts-1; i++)
+	{
+		const SoftRaster_Vertex	*Src[3] = { &Verts[0], &Verts[i], &Verts[i+1] };
+		float					MinX, MinY, MaxX, MaxY;
+		uint32					Index;
+		int32					j, tx, ty, tx0, ty0, tx1, ty1;
+
+		MinX = MinY = 1e30f;
+		MaxX = MaxY = -1e30f;
+
+		for (j = 0; j < 3; j++)
+		{
+			SoftRaster_Vertex	*Dst = &Tri.V[j];
+			float				w;
+
+			*Dst = *Src[j];
+
+			w = (Src[j]->z > 0.0001f) ? 1.0f / Src[j]->z : 10000.0f;
+
+			Dst->z = w;
+			Dst->u = Src[j]->u * MipScale * w;
+			Dst->v = Src[j]->v * MipScale * w;
+			Dst->lu = Src[j]->lu * w;
+			Dst->lv = Src[j]->lv * w;
+
+			MinX = std::min<float>(MinX, Dst->x);
+			MinY = std::min<float>(MinY, Dst->y);
+			MaxX = std::max<float>(MaxX, Dst->x);
+			MaxY = std::max<float>(MaxY, Dst->y);
+		}
+
+		Tri.MinX = std::max<int32>((int32)floorf(MinX), 0);
+		Tri.MinY = std::max<int32>((int32)floorf(MinY), 0);
+		Tri.MaxX = std::min<int32>((int32)ceilf(MaxX), g_Width-1);
+		Tri.MaxY = std::min<int32>((int32)ceilf(MaxY), g_Height-1);
+
+		if (Tri.MinX > Tri.MaxX || Tri.MinY > Tri.MaxY)
+			continue;
+
+		Index = (uint32)g_Tris.size();
+		g_Tris.push_back(Tri);
+
+		tx0 = Tri.MinX >> SOFTRASTER_TILE_SHIFT;
+		ty0 = Tri.MinY >> SOFTRASTER_TILE_SHIFT;
+		tx1 = Tri.MaxX >> SOFTRASTER_TILE_SHIFT;
+		ty1 = Tri.MaxY >> SOFTRASTER_TILE_SHIFT;
+
+		for (ty = ty0; ty <= ty1; ty++)
+			for (tx = tx0; tx <= tx1; tx++)
+				g_Bins[ty*g_TilesX + tx].push_back(Index);
+	}
+}
+
+//=====================================================================================
+//	SoftRaster_Flush
+//=====================================================================================
+void SoftRaster_Flush(void)
+{
+	if (g_Tris.empty())
+		return;
+
+	g_NextTile.store(0);
+
+	if (!g_Workers.empty())
+	{
+		std::unique_lock<std::mutex>	Lock(g_PoolLock);
+
+		g_PoolBusy = (int32)g_Workers.size();
+		g_PoolGeneration++;
+		g_PoolWake.notify_all();
+		Lock.unlock();
+
+		RasterTiles();
+
+		Lock.lock();
+		g_PoolDone.wait(Lock, []{ return g_PoolBusy == 0; });
+	}
+	else
+	{
+		RasterTiles();
+	}
+
+	g_Tris.clear();
+
+	for (size_t i = 0; i < g_Bins.size(); i++)
+		g_Bins[i].clear();
+}
+
+jeBoolean SoftRaster_HasPending(void)
+{
+	return g_Tris.empty() ? JE_FALSE : JE_TRUE;
+}
+
+//=====================================================================================
+//	SoftRaster_SetFog
+//=====================================================================================
+void SoftRaster_SetFog(jeBoolean Enable, float r, float g, float b, float Start, float End)
+{
+	// Fog is global state, it can not change under queued tris
+	SoftRaster_Flush();
+
+	g_Fog.Enable = Enable;
+	g_Fog.r = r;
+	g_Fog.g = g;
+	g_Fog.b = b;
+	g_Fog.Start = Start;
+	g_Fog.InvRange = (End > Start) ? 1.0f / (End - Start) : 0.0f;
+}
+
+uint32_t *SoftRaster_GetFrameBuffer(int32 *Width, int32 *Height)
+{
+	if (Width)
+		*Width = g_Width;
+	if (Height)
+		*Height = g_Height;
+
+	return g_Color.empty() ? NULL : &g_Color[0];
+}
+
+int32 SoftRaster_GetNumThreads(void)
+{
+	return (int32)g_Workers.size() + 1;
+}
+
+int32 SoftRaster_TakeWorldPixelCount(void)
+{
+	return g_WorldPixels.exchange(0);
+}
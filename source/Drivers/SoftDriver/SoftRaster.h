@@ -0,0 +1,69 @@
+/****************************************************************************************/
+/*  SOFTRASTER.H                                                                        */
+/*                                                                                      */
+/*  Author: Styx3D Modernization                                                        */
+/*  Description: Multithreaded tile based triangle rasterizer for the software driver   */
+/*                                                                                      */
+/*  The contents of this file are subject to the 0BSD License.                          */
+/*  See LICENSE file in the project root for full license information.                  */
+/*                                                                                      */
+/****************************************************************************************/
+#ifndef SOFTRASTER_H
+#define SOFTRASTER_H
+
+#include "SoftDriver.h"
+
+#define SOFTRASTER_TILE_SHIFT			6
+#define SOFTRASTER_TILE_SIZE			(1<<SOFTRASTER_TILE_SHIFT)
+#define SOFTRASTER_MAX_MIPS				16
+#define SOFTRASTER_MAX_TRIS				(1<<16)		// Queued tris before an early flush
+
+// Raster mode flags
+#define SOFTRASTER_ZTEST				(1<<0)
+#define SOFTRASTER_ZWRITE				(1<<1)
+#define SOFTRASTER_BLEND				(1<<2)		// Blend with the framebuffer using src alpha
+#define SOFTRASTER_ALPHATEST			(1<<3)		// Reject texels with zero alpha (color key)
+#define SOFTRASTER_CLAMPUV				(1<<4)
+#define SOFTRASTER_BILINEAR				(1<<5)
+#define SOFTRASTER_LMAP_X2				(1<<6)
+#define SOFTRASTER_LMAP_ADD				(1<<7)
+#define SOFTRASTER_WORLD				(1<<8)		// Counts toward NumWorldPixels
+
+// A texture as the rasterizer sees it, one ARGB8888 image per mip
+typedef struct SoftRaster_Surface
+{
+	const uint32_t				*Mips[SOFTRASTER_MAX_MIPS];
+	int32						Width;
+	int32						Height;
+	int32						NumMips;
+} SoftRaster_Surface;
+
+// Screen space vertex.  u/v are in texels of mip 0, lu/lv in lumels
+typedef struct SoftRaster_Vertex
+{
+	float						x, y, z;
+	float						r, g, b, a;			// 0..255
+	float						u, v;
+	float						lu, lv;
+} SoftRaster_Vertex;
+
+jeBoolean						SoftRaster_Create(int32 Width, int32 Height, int32 NumThreads);
+void							SoftRaster_Destroy(void);
+
+void							SoftRaster_Clear(jeBoolean ClearColor, jeBoolean ClearZ);
+
+// Triangulates a convex poly as a fan and bins it.  Surfaces are copied, the
+// texels they point at must stay alive until the next SoftRaster_Flush.
+void							SoftRaster_SubmitPoly(const SoftRaster_Vertex *Verts, int32 NumVerts, const SoftRaster_Surface *Tex, const SoftRaster_Surface *LMap, uint32 Mode);
+
+// Rasterizes everything queued so far, one tile per worker at a time
+void							SoftRaster_Flush(void);
+jeBoolean						SoftRaster_HasPending(void);
+
+void							SoftRaster_SetFog(jeBoolean Enable, float r, float g, float b, float Start, float End);
+
+uint32_t						*SoftRaster_GetFrameBuffer(int32 *Width, int32 *Height);
+int32							SoftRaster_GetNumThreads(void);
+int32							SoftRaster_TakeWorldPixelCount(void);
+
+#endif // SOFTRASTER_H
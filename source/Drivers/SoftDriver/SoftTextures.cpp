@@ -0,0 +1,560 @@
+/****************************************************************************************/
+/*  SOFTTEXTURES.CPP                                                                    */
+/*                                                                                      */
+/*  Author: Styx3D Modernization                                                        */
+/*  Description: Texture handle management for the software driver                     */
+/*                                                                                      */
+/*  Handles keep their bits in whatever format the engine asked for, the rasterizer     */
+/*  only ever samples ARGB8888.  Mips are expanded lazily, the first time a poly that   */
+/*  uses them is submitted after an unlock.                                             */
+/*                                                                                      */
+/*  The contents of this file are subject to the 0BSD License.                          */
+/*  See LICENSE file in the project root for full license information.                  */
+/*                                                                                      */
+/****************************************************************************************/
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "SoftTextures.h"
+#include "SoftRaster.h"
+
+#define SOFTTEX_COLORKEY						(1)		// Same key the OpenGL driver hands out
+
+static jeTexture							*g_TextureList = NULL;
+
+static uint8 GetLog(int32 Width, int32 Height)
+{
+	int32		Size = std::max<int32>(Width, Height);
+	uint8		Log = 0;
+
+	while ((1<<Log) < Size)
+		Log++;
+
+	return Log;
+}
+
+static int32 BytesPerPixel(jePixelFormat Format)
+{
+	switch (Format)
+	{
+		case JE_PIXELFORMAT_8BIT:
+		case JE_PIXELFORMAT_8BIT_GRAY:
+			return 1;
+
+		case JE_PIXELFORMAT_16BIT_555_RGB:
+		case JE_PIXELFORMAT_16BIT_555_BGR:
+		case JE_PIXELFORMAT_16BIT_565_RGB:
+		case JE_PIXELFORMAT_16BIT_565_BGR:
+		case JE_PIXELFORMAT_16BIT_4444_ARGB:
+		case JE_PIXELFORMAT_16BIT_1555_ARGB:
+			return 2;
+
+		case JE_PIXELFORMAT_24BIT_RGB:
+		case JE_PIXELFORMAT_24BIT_BGR:
+			return 3;
+
+		case JE_PIXELFORMAT_32BIT_XRGB:
+		case JE_PIXELFORMAT_32BIT_XBGR:
+		case JE_PIXELFORMAT_32BIT_ARGB:
+		case JE_PIXELFORMAT_32BIT_ABGR:
+			return 4;
+
+		default:
+			return 0;
+	}
+}
+
+static inline int32 Expand5(uint32_t c)	{ return (int32)((c << 3) | (c >> 2)); }
+static inline int32 Expand6(uint32_t c)	{ return (int32)((c << 2) | (c >> 4)); }
+static inline int32 Expand4(uint32_t c)	{ return (int32)((c << 4) | c); }
+
+//=====================================================================================
+//	ReadPixel
+//	Returns the raw pixel at Src and its ARGB8888 expansion
+//=====================================================================================
+static uint32_t ReadPixel(const jeTexture *THandle, const uint8 *Src, uint32_t *Raw)
+{
+	uint32_t	p;
+	int32		a = 255, r = 0, g = 0, b = 0;
+
+	switch (THandle->Format.PixelFormat)
+	{
+		case JE_PIXELFORMAT_8BIT:
+			p = Src[0];
+			if (THandle->PalHandle && THandle->PalHandle->Texels[0])
+			{
+				*Raw = p;
+				return THandle->PalHandle->Texels[0][p];
+			}
+			r = g = b = (int32)p;
+			break;
+
+		case JE_PIXELFORMAT_8BIT_GRAY:
+			p = Src[0];
+			r = g = b = (int32)p;
+			break;
+
+		case JE_PIXELFORMAT_16BIT_555_RGB:
+			p = (uint32_t)Src[0] | ((uint32_t)Src[1] << 8);
+			r = Expand5((p >> 10) & 31); g = Expand5((p >> 5) & 31); b = Expand5(p & 31);
+			break;
+
+		case JE_PIXELFORMAT_16BIT_555_BGR:
+			p = (uint32_t)Src[0] | ((uint32_t)Src[1] << 8);
+			b = Expand5((p >> 10) & 31); g = Expand5((p >> 5) & 31); r = Expand5(p & 31);
+			break;
+
+		case JE_PIXELFORMAT_16BIT_565_RGB:
+			p = (uint32_t)Src[0] | ((uint32_t)Src[1] << 8);
+			r = Expand5((p >> 11) & 31); g = Expand6((p >> 5) & 63); b = Expand5(p & 31);
+			break;
+
+		case JE_PIXELFORMAT_16BIT_565_BGR:
+			p = (uint32_t)Src[0] | ((uint32_t)Src[1] << 8);
+			b = Expand5((p >> 11) & 31); g = Expand6((p >> 5) & 63); r = Expand5(p & 31);
+			break;
+
+		case JE_PIXELFORMAT_16BIT_4444_ARGB:
+			p = (uint32_t)Src[0] | ((uint32_t)Src[1] << 8);
+			a = Expand4((p >> 12) & 15); r = Expand4((p >> 8) & 15); g = Expand4((p >> 4) & 15); b = Expand4(p & 15);
+			break;
+
+		case JE_PIXELFORMAT_16BIT_1555_ARGB:
+			p = (uint32_t)Src[0] | ((uint32_t)Src[1] << 8);
+			a = (p & 0x8000) ? 255 : 0; r = Expand5((p >> 10) & 31); g = Expand5((p >> 5) & 31); b = Expand5(p & 31);
+			break;
+
+		case JE_PIXELFORMAT_24BIT_RGB:
+			r = Src[0]; g = Src[1]; b = Src[2];
+			p = ((uint32_t)r << 16) | ((uint32_t)g << 8) | (uint32_t)b;
+			break;
+
+		case JE_PIXELFORMAT_24BIT_BGR:
+			b = Src[0]; g = Src[1]; r = Src[2];
+			p = ((uint32_t)r << 16) | ((uint32_t)g << 8) | (uint32_t)b;
+			break;
+
+		case JE_PIXELFORMAT_32BIT_XRGB:
+		case JE_PIXELFORMAT_32BIT_ARGB:
+			p = (uint32_t)Src[0] | ((uint32_t)Src[1] << 8) | ((uint32_t)Src[2] << 16) | ((uint32_t)Src[3] << 24);
+			*Raw = p;
+			return (THandle->Format.PixelFormat == JE_PIXELFORMAT_32BIT_XRGB) ? (p | 0xFF000000u) : p;
+
+		case JE_PIXELFORMAT_32BIT_XBGR:
+		case JE_PIXELFORMAT_32BIT_ABGR:
+			p = (uint32_t)Src[0] | ((uint32_t)Src[1] << 8) | ((uint32_t)Src[2] << 16) | ((uint32_t)Src[3] << 24);
+			a = (THandle->Format.PixelFormat == JE_PIXELFORMAT_32BIT_XBGR) ? 255 : (int32)(p >> 24);
+			b = (p >> 16) & 0xFF; g = (p >> 8) & 0xFF; r = p & 0xFF;
+			break;
+
+		default:
+			p = 0;
+			break;
+	}
+
+	*Raw = p;
+
+	return ((uint32_t)a << 24) | ((uint32_t)r << 16) | ((uint32_t)g << 8) | (uint32_t)b;
+}
+
+//=====================================================================================
+//	ExpandMip
+//=====================================================================================
+static jeBoolean ExpandMip(jeTexture *THandle, int32 MipLevel)
+{
+	int32			Width, Height, Bpp, i, Count;
+	const uint8		*Src;
+	uint32_t		*Dst;
+	jeBoolean		ColorKey;
+	const uint32_t	*Alpha;
+
+	Width = std::max<int32>(THandle->Width >> MipLevel, 1);
+	Height = std::max<int32>(THandle->Height >> MipLevel, 1);
+	Count = Width*Height;
+	Bpp = BytesPerPixel(THandle->Format.PixelFormat);
+
+	if (!THandle->Bits[MipLevel] || !Bpp)
+		return JE_FALSE;
+
+	if (!THandle->Texels[MipLevel])
+	{
+		THandle->Texels[MipLevel] = (uint32_t*)malloc(sizeof(uint32_t)*Count);
+
+		if (!THandle->Texels[MipLevel])
+			return JE_FALSE;
+	}
+
+	ColorKey = (THandle->Format.Flags & RDRIVER_PF_CAN_DO_COLORKEY) ? JE_TRUE : JE_FALSE;
+	Alpha = NULL;
+
+	if (THandle->AlphaHandle)
+	{
+		SoftRaster_Surface	Surface;
+
+		if (SoftTex_GetSurface(THandle->AlphaHandle, &Surface) && Surface.Width == THandle->Width && Surface.Height == THandle->Height)
+			Alpha = Surface.Mips[MipLevel] ? Surface.Mips[MipLevel] : NULL;
+	}
+
+	if (THandle->PalHandle)
+	{
+		SoftRaster_Surface	Surface;
+
+		SoftTex_GetSurface(THandle->PalHandle, &Surface);
+	}
+
+	Src = THandle->Bits[MipLevel];
+	Dst = THandle->Texels[MipLevel];
+
+	for (i = 0; i < Count; i++, Src += Bpp)
+	{
+		uint32_t	Raw, Color;
+
+		Color = ReadPixel(THandle, Src, &Raw);
+
+		if (ColorKey && Raw == SOFTTEX_COLORKEY)
+			Color &= 0x00FFFFFFu;
+		else if (Alpha)
+			Color = (Color & 0x00FFFFFFu) | ((Alpha[i] & 0xFF) << 24);
+
+		Dst[i] = Color;
+	}
+
+	return JE_TRUE;
+}
+
+//=====================================================================================
+//	DirtyUsers
+//	Textures expanded through THandle as their palette or alpha are stale once it changes
+//=====================================================================================
+static void DirtyUsers(jeTexture *THandle)
+{
+	jeTexture	*User;
+
+	for (User = g_TextureList; User; User = User->Next)
+	{
+		if (User->PalHandle != THandle && User->AlphaHandle != THandle)
+			continue;
+
+		// Queued tris may still sample the texels about to be re-expanded
+		if (User->Texels[0])
+			SoftRaster_Flush();
+
+		User->DirtyMips = (1<<User->NumMipLevels)-1;
+	}
+}
+
+//=====================================================================================
+//	SoftTex_Startup / SoftTex_Shutdown
+//=====================================================================================
+jeBoolean SoftTex_Startup(void)
+{
+	g_TextureList = NULL;
+	return JE_TRUE;
+}
+
+jeBoolean SoftTex_Shutdown(void)
+{
+	while (g_TextureList)
+		SoftDrv_THandle_Destroy(g_TextureList);
+
+	return JE_TRUE;
+}
+
+//=====================================================================================
+//	SoftTex_GetSurface
+//=====================================================================================
+jeBoolean SoftTex_GetSurface(jeTexture *THandle, SoftRaster_Surface *Surface)
+{
+	int32		i;
+
+	assert(THandle);
+	assert(Surface);
+
+	memset(Surface, 0, sizeof(*Surface));
+
+	for (i = 0; i < THandle->NumMipLevels; i++)
+	{
+		if (THandle->DirtyMips & (1<<i))
+		{
+			if (ExpandMip(THandle, i))
+				THandle->DirtyMips &= ~(1<<i);
+		}
+	}
+
+	if (!THandle->Texels[0])
+		return JE_FALSE;
+
+	Surface->Width = THandle->Width;
+	Surface->Height = THandle->Height;
+	Surface->NumMips = THandle->NumMipLevels;
+
+	for (i = 0; i < THandle->NumMipLevels; i++)
+		Surface->Mips[i] = THandle->Texels[i];
+
+	return JE_TRUE;
+}
+
+//=====================================================================================
+//	SoftTex_SetLightmap
+//	RGB is the 24 bit lightmap the engine hands out in jeRDriver_LMapCBInfo
+//=====================================================================================
+jeBoolean SoftTex_SetLightmap(jeTexture *THandle, const uint8 *RGB)
+{
+	int32		i, Count;
+	uint32_t	*Dst;
+
+	assert(THandle);
+
+	if (!RGB)
+		return JE_FALSE;
+
+	Count = THandle->Width*THandle->Height;
+
+	if (!THandle->Texels[0])
+	{
+		THandle->Texels[0] = (uint32_t*)malloc(sizeof(uint32_t)*Count);
+
+		if (!THandle->Texels[0])
+			return JE_FALSE;
+	}
+
+	Dst = THandle->Texels[0];
+
+	for (i = 0; i < Count; i++, RGB += 3)
+		Dst[i] = 0xFF000000u | ((uint32_t)RGB[0] << 16) | ((uint32_t)RGB[1] << 8) | (uint32_t)RGB[2];
+
+	THandle->DirtyMips &= ~1;
+
+	return JE_TRUE;
+}
+
+//=====================================================================================
+//	SoftDrv_THandle_Create
+//=====================================================================================
+jeTexture *DRIVERCC SoftDrv_THandle_Create(int32 Width, int32 Height, int32 NumMipLevels, const jeRDriver_PixelFormat *PixelFormat)
+{
+	jeTexture		*THandle;
+
+	if (!PixelFormat || Width <= 0 || Height <= 0 || NumMipLevels <= 0 || NumMipLevels > THANDLE_MAX_MIP_LEVELS)
+	{
+		SoftDrv_SetLastError(DRV_ERROR_INVALID_PARMS, "SoftDrv_THandle_Create:  Invalid parms.");
+		return NULL;
+	}
+
+	if (!BytesPerPixel(PixelFormat->PixelFormat))
+	{
+		SoftDrv_SetLastError(DRV_ERROR_INVALID_PARMS, "SoftDrv_THandle_Create:  Unsupported pixel format.");
+		return NULL;
+	}
+
+	THandle = (jeTexture*)calloc(1, sizeof(jeTexture));
+
+	if (!THandle)
+	{
+		SoftDrv_SetLastError(DRV_ERROR_NO_MEMORY, "SoftDrv_THandle_Create:  Out of memory.");
+		return NULL;
+	}
+
+	THandle->Width = Width;
+	THandle->Height = Height;
+	THandle->NumMipLevels = NumMipLevels;
+	THandle->Log = GetLog(Width, Height);
+	THandle->Format = *PixelFormat;
+
+	THandle->Next = g_TextureList;
+	if (g_TextureList)
+		g_TextureList->Prev = THandle;
+	g_TextureList = THandle;
+
+	return THandle;
+}
+
+//=====================================================================================
+//	SoftDrv_THandle_Destroy
+//=====================================================================================
+jeBoolean DRIVERCC SoftDrv_THandle_Destroy(jeTexture *THandle)
+{
+	int32		i;
+
+	if (!THandle)
+		return JE_FALSE;
+
+	// Queued tris may still point at our texels
+	SoftRaster_Flush();
+
+	if (THandle->Prev)
+		THandle->Prev->Next = THandle->Next;
+	else
+		g_TextureList = THandle->Next;
+
+	if (THandle->Next)
+		THandle->Next->Prev = THandle->Prev;
+
+	for (jeTexture *User = g_TextureList; User; User = User->Next)
+	{
+		if (User->PalHandle == THandle)
+			User->PalHandle = NULL;
+		if (User->AlphaHandle == THandle)
+			User->AlphaHandle = NULL;
+	}
+
+	for (i = 0; i < THANDLE_MAX_MIP_LEVELS; i++)
+	{
+		if (THandle->Bits[i])
+			free(THandle->Bits[i]);
+
+		if (THandle->Texels[i])
+			free(THandle->Texels[i]);
+	}
+
+	free(THandle);
+
+	return JE_TRUE;
+}
+
+//=====================================================================================
+//	SoftDrv_THandle_Lock
+//=====================================================================================
+jeBoolean DRIVERCC SoftDrv_THandle_Lock(jeTexture *THandle, int32 MipLevel, void **Data)
+{
+	assert(THandle);
+	assert(Data);
+
+	if (MipLevel < 0 || MipLevel >= THandle->NumMipLevels)
+		return JE_FALSE;
+
+	if (THandle->Flags & (THANDLE_LOCKED << MipLevel))
+		return JE_FALSE;
+
+	if (!THandle->Bits[MipLevel])
+	{
+		int32	Width = std::max<int32>(THandle->Width >> MipLevel, 1);
+		int32	Height = std::max<int32>(THandle->Height >> MipLevel, 1);
+
+		THandle->Bits[MipLevel] = (uint8*)calloc((size_t)Width*Height, BytesPerPixel(THandle->Format.PixelFormat));
+
+		if (!THandle->Bits[MipLevel])
+		{
+			SoftDrv_SetLastError(DRV_ERROR_NO_MEMORY, "SoftDrv_THandle_Lock:  Out of memory.");
+			return JE_FALSE;
+		}
+	}
+
+	THandle->Flags |= (THANDLE_LOCKED << MipLevel);
+	*Data = THandle->Bits[MipLevel];
+
+	return JE_TRUE;
+}
+
+//=====================================================================================
+//	SoftDrv_THandle_UnLock
+//=====================================================================================
+jeBoolean DRIVERCC SoftDrv_THandle_UnLock(jeTexture *THandle, int32 MipLevel)
+{
+	assert(THandle);
+
+	if (MipLevel < 0 || MipLevel >= THandle->NumMipLevels)
+		return JE_FALSE;
+
+	if (!(THandle->Flags & (THANDLE_LOCKED << MipLevel)))
+		return JE_FALSE;
+
+	// The texels are about to change under any tris that still reference them
+	if (THandle->Texels[MipLevel])
+		SoftRaster_Flush();
+
+	THandle->Flags &= ~(THANDLE_LOCKED << MipLevel);
+	THandle->DirtyMips |= (1<<MipLevel);
+
+	DirtyUsers(THandle);
+
+	return JE_TRUE;
+}
+
+//=====================================================================================
+//	Palette and alpha surfaces
+//=====================================================================================
+jeBoolean DRIVERCC SoftDrv_THandle_SetPalette(jeTexture *THandle, jeTexture *PalHandle)
+{
+	assert(THandle);
+
+	if (THandle->Texels[0])
+		SoftRaster_Flush();
+
+	THandle->PalHandle = PalHandle;
+	THandle->DirtyMips = (1<<THandle->NumMipLevels)-1;
+
+	if (PalHandle)
+		PalHandle->DirtyMips |= 1;
+
+	return JE_TRUE;
+}
+
+jeTexture *DRIVERCC SoftDrv_THandle_GetPalette(jeTexture *THandle)
+{
+	assert(THandle);
+	return THandle->PalHandle;
+}
+
+jeBoolean DRIVERCC SoftDrv_THandle_SetAlpha(jeTexture *THandle, jeTexture *AlphaHandle)
+{
+	assert(THandle);
+
+	if (THandle->Texels[0])
+		SoftRaster_Flush();
+
+	THandle->AlphaHandle = AlphaHandle;
+	THandle->DirtyMips = (1<<THandle->NumMipLevels)-1;
+
+	return JE_TRUE;
+}
+
+jeTexture *DRIVERCC SoftDrv_THandle_GetAlpha(jeTexture *THandle)
+{
+	assert(THandle);
+	return THandle->AlphaHandle;
+}
+
+//=====================================================================================
+//	SoftDrv_THandle_GetInfo
+//=====================================================================================
+jeBoolean DRIVERCC SoftDrv_THandle_GetInfo(jeTexture *THandle, int32 MipLevel, jeTexture_Info *Info)
+{
+	assert(THandle);
+	assert(Info);
+
+	if (MipLevel < 0 || MipLevel >= THandle->NumMipLevels)
+		return JE_FALSE;
+
+	Info->Width = std::max<int32>(THandle->Width >> MipLevel, 1);
+	Info->Height = std::max<int32>(THandle->Height >> MipLevel, 1);
+	Info->Stride = Info->Width;
+	Info->Log = THandle->Log;
+	Info->PixelFormat = THandle->Format;
+	Info->Direct = NULL;
+
+	if (THandle->Format.Flags & RDRIVER_PF_CAN_DO_COLORKEY)
+	{
+		Info->Flags = RDRIVER_THANDLE_HAS_COLORKEY;
+		Info->ColorKey = SOFTTEX_COLORKEY;
+	}
+	else
+	{
+		Info->Flags = 0;
+		Info->ColorKey = 0;
+	}
+
+	return JE_TRUE;
+}
+
+//=====================================================================================
+//	SoftDrv_Reset
+//=====================================================================================
+jeBoolean DRIVERCC SoftDrv_Reset(void)
+{
+	SoftRaster_Flush();
+	return SoftTex_Shutdown();
+}
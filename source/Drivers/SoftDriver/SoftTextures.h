@@ -0,0 +1,62 @@
+/****************************************************************************************/
+/*  SOFTTEXTURES.H                                                                      */
+/*                                                                                      */
+/*  Author: Styx3D Modernization                                                        */
+/*  Description: Texture handle management for the software driver                     */
+/*                                                                                      */
+/*  The contents of this file are subject to the 0BSD License.                          */
+/*  See LICENSE file in the project root for full license information.                  */
+/*                                                                                      */
+/****************************************************************************************/
+#ifndef SOFTTEXTURES_H
+#define SOFTTEXTURES_H
+
+#include "SoftDriver.h"
+#include "SoftRaster.h"
+
+#define THANDLE_LOCKED							0x00000001		// Shifted left by the mip level
+#define THANDLE_HAS_LIGHTMAP					0x00010000		// Texels[0] holds lumels from SetupLightmap
+#define THANDLE_MAX_MIP_LEVELS					SOFTRASTER_MAX_MIPS
+
+typedef struct jeTexture
+{
+	int32								Width, Height;
+	int32								NumMipLevels;
+	uint8								Log;
+
+	jeRDriver_PixelFormat				Format;
+	uint32								Flags;
+
+	uint8								*Bits[THANDLE_MAX_MIP_LEVELS];		// Lockable bits, in Format
+	uint32_t							*Texels[THANDLE_MAX_MIP_LEVELS];	// Expanded ARGB8888 the rasterizer samples
+	uint32								DirtyMips;
+
+	jeTexture							*PalHandle;
+	jeTexture							*AlphaHandle;
+
+	jeTexture							*Prev, *Next;		// Live handle list
+} jeTexture;
+
+jeBoolean								SoftTex_Startup(void);
+jeBoolean								SoftTex_Shutdown(void);
+
+// Expands any mips touched since the last call.  Must run on the submitting thread.
+jeBoolean								SoftTex_GetSurface(jeTexture *THandle, SoftRaster_Surface *Surface);
+jeBoolean								SoftTex_SetLightmap(jeTexture *THandle, const uint8 *RGB);
+
+jeBoolean DRIVERCC						SoftDrv_Reset(void);
+
+jeTexture *DRIVERCC						SoftDrv_THandle_Create(int32 Width, int32 Height, int32 NumMipLevels, const jeRDriver_PixelFormat *PixelFormat);
+jeBoolean DRIVERCC						SoftDrv_THandle_Destroy(jeTexture *THandle);
+
+jeBoolean DRIVERCC						SoftDrv_THandle_Lock(jeTexture *THandle, int32 MipLevel, void **Data);
+jeBoolean DRIVERCC						SoftDrv_THandle_UnLock(jeTexture *THandle, int32 MipLevel);
+
+jeBoolean DRIVERCC						SoftDrv_THandle_SetPalette(jeTexture *THandle, jeTexture *PalHandle);
+jeTexture *DRIVERCC						SoftDrv_THandle_GetPalette(jeTexture *THandle);
+jeBoolean DRIVERCC						SoftDrv_THandle_SetAlpha(jeTexture *THandle, jeTexture *AlphaHandle);
+jeTexture *DRIVERCC						SoftDrv_THandle_GetAlpha(jeTexture *THandle);
+
+jeBoolean DRIVERCC						SoftDrv_THandle_GetInfo(jeTexture *THandle, int32 MipLevel, jeTexture_Info *Info);
+
+#endif // SOFTTEXTURES_H
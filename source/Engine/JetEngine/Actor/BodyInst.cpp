@@ -25,6 +25,7 @@
 #include "Ram.h"
 #include "Errorlog.h"
 #include "StrBlock.h"
+#include "BodySkin.h"
 
 #include "Camera._h"
 
@@ -119,6 +120,34 @@ void JETCF jeBodyInst_Destroy( jeBodyInst **BI)
 
 #define JE_BODYINST_FACELIST_SIZE_FOR_TRIANGLE (8)
 
+// Number of vertices starting at S that share S's bone, are unblended and have a lod mask,
+// so they can go through jeBodySkin as one batch.  0 if S itself can't.
+static int JETCF jeBodyInst_SkinRunLength(const jeBody_XSkinVertex *S, int Count)
+{
+	jeBody_Index BoneIndex = S->BoneIndex;
+	int Run;
+
+	for (Run=0; Run<Count; Run++,S++)
+		{
+			if (S->BoneIndex != BoneIndex || S->nBlends != 0 || !S->LevelOfDetailMask)
+				break;
+		}
+	return Run;
+}
+
+static int JETCF jeBodyInst_NormalRunLength(const jeBody_Normal *S, int Count)
+{
+	jeBody_Index BoneIndex = S->BoneIndex;
+	int Run;
+
+	for (Run=0; Run<Count; Run++,S++)
+		{
+			if (S->BoneIndex != BoneIndex || S->nBlends != 0 || !S->LevelOfDetailMask)
+				break;
+		}
+	return Run;
+}
+
 static jeBodyInst_Geometry * JETCF jeBodyInst_GetGeometryPrep(	
 	jeBodyInst *BI, 
 	int LevelOfDetail)
@@ -237,15 +266,16 @@ const jeBodyInst_Geometry * JETCF jeBodyInst_GetGeometry(
 			// transform and project all appropriate points
 			jeBody_XSkinVertex *S;
 			jeBodyInst_SkinVertex  *D;
+			jeXForm3d ObjectToCamera;
+			int Run = 0;
 			LevelOfDetailBit = 1 << LevelOfDetail;
 			BoneIndex = -1;  // S->BoneIndex won't ever be this.
 			jeVec3d_Set(&(G->Maxs), -JE_BODY_REALLY_BIG_NUMBER, -JE_BODY_REALLY_BIG_NUMBER, -JE_BODY_REALLY_BIG_NUMBER );
 			jeVec3d_Set(&(G->Mins), JE_BODY_REALLY_BIG_NUMBER, JE_BODY_REALLY_BIG_NUMBER, JE_BODY_REALLY_BIG_NUMBER );
 			for (i=B->XSkinVertexCount,S=B->XSkinVertexArray,D=G->SkinVertexArray; 
 				 i>0; 
-				 i--,S++,D++)
+				 i--,S++,D++,Run--)
 				{
-					jeXForm3d ObjectToCamera;
 					if (S->BoneIndex!=BoneIndex)
 						{ //Keep XSkinVertexArray sorted by BoneIndex for best performance
 							BoneIndex = S->BoneIndex;
@@ -254,13 +284,20 @@ const jeBodyInst_Geometry * JETCF jeBodyInst_GetGeometry(
 													&ObjectToCamera);
 							jeBodyInst_PostScale(&ObjectToCamera,ScaleVector,&ObjectToCamera);
 						}
+					if (Run <= 0)
+						{ // transform the next run of this bone's plain vertices in one go
+							Run = jeBodyInst_SkinRunLength(S,i);
+							if (Run > 0)
+								jeBodySkin_TransformArray(&ObjectToCamera, &(S->XPoint), sizeof(*S), &(D->SVPoint), sizeof(*D), Run);
+						}
 					if ( S->LevelOfDetailMask && LevelOfDetailBit )
 						{
 							jeVec3d *VecDestPtr = &(D->SVPoint);
 // @@@
 							if (S->nBlends == 0)
 							{
-								jeXForm3d_Transform(  &(ObjectToCamera), &(S->XPoint),VecDestPtr);
+								// already done by the batch
+								assert( Run > 0 );
 							}
 
 							else // we need to do some blending
@@ -328,6 +365,8 @@ const jeBodyInst_Geometry * JETCF jeBodyInst_GetGeometry(
 			// transform all appropriate points
 			jeBody_XSkinVertex *S;
 			jeBodyInst_SkinVertex  *D;
+			jeXForm3d ObjectToWorld;
+			int Run = 0;
 			LevelOfDetailBit = 1 << LevelOfDetail;
 			BoneIndex = -1;  // S->BoneIndex won't ever be this.
 			jeVec3d_Set(&(G->Maxs), -JE_BODY_REALLY_BIG_NUMBER, -JE_BODY_REALLY_BIG_NUMBER, -JE_BODY_REALLY_BIG_NUMBER );
@@ -335,20 +374,26 @@ const jeBodyInst_Geometry * JETCF jeBodyInst_GetGeometry(
 			
 			for (i=B->XSkinVertexCount,S=B->XSkinVertexArray,D=G->SkinVertexArray; 
 				 i>0; 
-				 i--,S++,D++)
+				 i--,S++,D++,Run--)
 				{
-					jeXForm3d ObjectToWorld;
 					if (S->BoneIndex!=BoneIndex)
 						{ //Keep XSkinVertexArray sorted by BoneIndex for best performance
 							BoneIndex = S->BoneIndex;
 							jeBodyInst_PostScale(&BoneXFArray[BoneIndex],ScaleVector,&ObjectToWorld);
 
 						}
+					if (Run <= 0)
+						{ // transform the next run of this bone's vertices in one go
+							Run = jeBodyInst_SkinRunLength(S,i);
+							if (Run > 0)
+								jeBodySkin_TransformArray(&ObjectToWorld, &(S->XPoint), sizeof(*S), &(D->SVPoint), sizeof(*D), Run);
+						}
 					if ( S->LevelOfDetailMask && LevelOfDetailBit )
 						{
 							jeVec3d *VecDestPtr = &(D->SVPoint);
-							jeXForm3d_Transform(  &(ObjectToWorld),
-												&(S->XPoint),VecDestPtr);
+							if (Run <= 0)
+								jeXForm3d_Transform(  &(ObjectToWorld),
+													&(S->XPoint),VecDestPtr);
 							D->SVU = S->XU;
 							D->SVV = S->XV;
 
@@ -368,17 +413,24 @@ const jeBodyInst_Geometry * JETCF jeBodyInst_GetGeometry(
 			{
 				jeBody_Normal *S;
 				jeVec3d *D;
+				int Run = 0;
 				// rotate all appropriate normals
 				for (i=B->SkinNormalCount,S=B->SkinNormalArray,D=G->NormalArray;
 					 i>0; 
-					 i--,S++,D++)
+					 i--,S++,D++,Run--)
 				{
+					if (Run <= 0)
+					{
+						Run = jeBodyInst_NormalRunLength(S,i);
+						if (Run > 0)
+							jeBodySkin_RotateArray(&(BoneXFArray[S->BoneIndex]), &(S->Normal), sizeof(*S), D, sizeof(*D), Run);
+					}
 					if ( S->LevelOfDetailMask && LevelOfDetailBit )
 					{
 						if (S->nBlends == 0)
 						{
-							jeXForm3d_Rotate(&(BoneXFArray[S->BoneIndex]),
-								&(S->Normal),D);
+							// already done by the batch
+							assert( Run > 0 );
 						}
 						
 						else
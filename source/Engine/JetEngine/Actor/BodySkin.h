@@ -0,0 +1,50 @@
+/****************************************************************************************/
+/*  BODYSKIN.H                                                                          */
+/*                                                                                      */
+/*  Author: Styx3D Modernization                                                        */
+/*  Description: Batched bone transforms for skinning, with SSE2/AVX2 paths             */
+/*                                                                                      */
+/*  The contents of this file are subject to the 0BSD License.                          */
+/*  See LICENSE file in the project root for full license information.                  */
+/*                                                                                      */
+/****************************************************************************************/
+#ifndef JE_BODYSKIN_H
+#define JE_BODYSKIN_H
+
+#include "BaseType.h"
+#include "Xform3d.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum
+{
+	JE_BODYSKIN_PATH_SCALAR,
+	JE_BODYSKIN_PATH_SSE2,
+	JE_BODYSKIN_PATH_AVX2,
+	JE_BODYSKIN_PATH_COUNT
+} jeBodySkin_Path;
+
+//--------
+//	The path is picked from the cpu on first use (SSE2 when available, AVX2 is
+//	opt-in).  SetPath is for benchmarks and comparisons, and fails if the cpu (or
+//	the build) can't run the requested path.
+//--------
+jeBodySkin_Path		JETCF jeBodySkin_GetPath(void);
+jeBoolean			JETCF jeBodySkin_SetPath(jeBodySkin_Path Path);
+const char *		JETCF jeBodySkin_GetPathName(jeBodySkin_Path Path);
+
+//--------
+//	Dest[i] = M * Source[i], Count points, strides are in bytes.
+//	Every path adds in the same order as jeXForm3d_Transform/jeXForm3d_Rotate, so
+//	results only differ from them by what the compiler does with fp contraction.
+//--------
+void	JETCF jeBodySkin_TransformArray(const jeXForm3d *M, const jeVec3d *Source, int32 SourceStride, jeVec3d *Dest, int32 DestStride, int32 Count);
+void	JETCF jeBodySkin_RotateArray(const jeXForm3d *M, const jeVec3d *Source, int32 SourceStride, jeVec3d *Dest, int32 DestStride, int32 Count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JE_BODYSKIN_H
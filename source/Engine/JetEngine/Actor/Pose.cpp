@@ -19,8 +19,6 @@
 /*                                                                                      */
 /****************************************************************************************/
 
-#pragma message ("could optimize a name binded setPose by caching the mapping from motionpath[i] to joint[j]")
-
 #include <assert.h>
 #include <string.h>
 
@@ -30,6 +28,7 @@
 #include "StrBlock.h"
 
 #define JE_POSE_STARTING_JOINT_COUNT (1)
+#define JE_POSE_BINDING_CACHE_SIZE (4)		// motions a pose can switch between without rebinding
 
 
 /* this object maintains a hierarchy of joints.
@@ -58,6 +57,15 @@ typedef struct jePose_Joint
 	int			 Covered;			// if joint has been 100% set (no blending)
 } jePose_Joint;						// structure to bind a name and a path for a joint
 
+typedef struct jePose_Binding
+{
+	const jeMotion	*Motion;		// motion this binding was made for (NULL if unused)
+	int32			 NameChecksum;	// motion's name checksum when bound
+	jeBoolean		 HasNames;		// motion's HasNames when bound
+	int				 PathCount;		// motion's path count when bound
+	int				*PathIndex;		// motion path index for each joint, -1 if the motion has no such path
+} jePose_Binding;					// cached name lookups of joints into one (leaf) motion
+
 typedef struct jePose
 {
 	int				  JointCount;	// number of joints in the motion
@@ -75,6 +83,8 @@ typedef struct jePose
 	jeXFArray		 *TransformArray;	
 	jePose_Joint	 *JointArray;
 	int				  OnlyThisJoint;		// update only this joint (and it's parents) if this is >0
+	jePose_Binding	  BindingCache[JE_POSE_BINDING_CACHE_SIZE];
+	int				  NextBinding;			// BindingCache entry to replace next
 } jePose;
 
 
@@ -171,6 +181,94 @@ static void JETCF jePose_InitializeJoint(jePose_Joint *Joint, int ParentJointInd
 
 
 
+static void JETCF jePose_ClearBindings(jePose *P)
+{
+	int i;
+
+	assert( P != NULL );
+
+	for (i=0; i<JE_POSE_BINDING_CACHE_SIZE; i++)
+		{
+			if (P->BindingCache[i].PathIndex != NULL)
+				jeRam_Free(P->BindingCache[i].PathIndex);
+			P->BindingCache[i].PathIndex = NULL;
+			P->BindingCache[i].Motion = NULL;
+		}
+	P->NextBinding = 0;
+}
+
+// returns the joint->path index table for a motion that doesn't match the pose exactly,
+// building it on first use.  returns NULL if the motion can't be bound (compound motions,
+// or out of memory): the caller should fall back to sampling by name.
+static const int * JETCF jePose_GetBinding(jePose *P, const jeMotion *M)
+{
+	jePose_Binding *B;
+	int32 NameChecksum;
+	jeBoolean HasNames;
+	int i,j,PathCount;
+
+	assert( P != NULL );
+	assert( M != NULL );
+
+	PathCount = jeMotion_GetPathCount(M);
+	if (PathCount <= 0)
+		{	// compound motions resolve names per sub-motion.
+			return NULL;
+		}
+	NameChecksum = jeMotion_GetNameChecksum(M);
+	HasNames     = jeMotion_HasNames(M);
+
+	for (i=0, B=&(P->BindingCache[0]); i<JE_POSE_BINDING_CACHE_SIZE; i++,B++)
+		{
+			if (    (B->Motion       == M) 
+				 && (B->NameChecksum == NameChecksum) 
+				 && (B->HasNames     == HasNames) 
+				 && (B->PathCount    == PathCount) )
+				{
+					return B->PathIndex;
+				}
+		}
+
+	B = &(P->BindingCache[P->NextBinding]);
+	P->NextBinding = (P->NextBinding + 1) % JE_POSE_BINDING_CACHE_SIZE;
+
+	if (B->PathIndex != NULL)
+		{
+			jeRam_Free(B->PathIndex);
+		}
+	B->Motion = NULL;
+	B->PathIndex = JE_RAM_ALLOCATE_ARRAY(int, (P->JointCount>0)?P->JointCount:1);
+	if (B->PathIndex == NULL)
+		{
+			return NULL;
+		}
+
+	// same matching as jeMotion_GetPathNamed: first path with an identical name
+	for (i=0; i<P->JointCount; i++)
+		{
+			const char *JointName = jeStrBlock_GetString(P->JointNames,i);
+
+			B->PathIndex[i] = -1;
+			if (HasNames == JE_FALSE)
+				continue;
+			for (j=0; j<PathCount; j++)
+				{
+					const char *PathName = jeMotion_GetNameOfPath(M,j);
+					if ( (PathName != NULL) && (strcmp(JointName,PathName)==0) )
+						{
+							B->PathIndex[i] = j;
+							break;
+						}
+				}
+		}
+
+	B->Motion       = M;
+	B->NameChecksum = NameChecksum;
+	B->HasNames     = HasNames;
+	B->PathCount    = PathCount;
+	return B->PathIndex;
+}
+
 jePose *JETCF jePose_Create(void)
 {
 	jePose *P;
@@ -232,6 +330,7 @@ void JETCF jePose_Destroy(jePose **PP)
 		}
 	if ((*PP)->JointArray != NULL)
 		jeRam_Free((*PP)->JointArray);
+	jePose_ClearBindings(*PP);
 	jeRam_Free( *PP );
 
 	*PP = NULL;
@@ -587,6 +686,7 @@ jeBoolean JETCF jePose_AddJoint(
 	*JointIndex = JointCount;
 
 	P->NameChecksum = jeStrBlock_GetChecksum( P->JointNames );
+	jePose_ClearBindings(P);		// bindings are sized by joint count
 	return JE_TRUE;
 }
 
@@ -713,6 +813,7 @@ void JETCF jePose_SetMotion(jePose *P, const jeMotion *M, jeFloat Time,
 							const jeXForm3d *Transform)
 {
 	jeBoolean NameBinding;
+	const int *Binding = NULL;
 	int i;
 	jePose_Joint *J;
 	jeXForm3d RootTransform;
@@ -758,17 +859,25 @@ void JETCF jePose_SetMotion(jePose *P, const jeMotion *M, jeFloat Time,
 	if (jePose_MatchesMotionExactly(P,M)==JE_TRUE)
 		NameBinding = JE_FALSE;
 	else
+	{
 		NameBinding = JE_TRUE;
+		Binding = jePose_GetBinding(P,M);
+	}
 
 	P->Touched = JE_TRUE;
 
-#pragma message("could optimize this by looping two ways (min(jointcount,pathcount))")
 	for (i=0, J=&(P->JointArray[0]); i<P->JointCount; i++,J++)
     {
         if (NameBinding == JE_FALSE)
         {
             jeMotion_SampleChannels(M,i,Time,&(J->LocalRotation),&(J->LocalTranslation));
         }
+        else if (Binding != NULL)
+        {
+            if (Binding[i] < 0)
+                continue;
+            jeMotion_SampleChannels(M,Binding[i],Time,&(J->LocalRotation),&(J->LocalTranslation));
+        }
         else
         {
             if (jeMotion_SampleChannelsNamed(M,
@@ -785,7 +894,7 @@ void JETCF jePose_SetMotion(jePose *P, const jeMotion *M, jeFloat Time,
 }
 
 static void JETCF jePose_SetMotionForABoneRecursion(jePose *P, const jeMotion *M, jeFloat Time,
-							int BoneIndex,jeBoolean NameBinding)
+							int BoneIndex,jeBoolean NameBinding,const int *Binding)
 {
 	jePose_Joint *J;
 	jeBoolean Touched = JE_FALSE;
@@ -800,6 +909,14 @@ static void JETCF jePose_SetMotionForABoneRecursion(jePose *P, const jeMotion *M
 			jeMotion_SampleChannels(M,BoneIndex,Time,&(J->LocalRotation),&(J->LocalTranslation));
 			Touched = JE_TRUE;
 		}
+	else if (Binding != NULL)
+		{
+			if (Binding[BoneIndex] >= 0)
+				{
+					jeMotion_SampleChannels(M,Binding[BoneIndex],Time,&(J->LocalRotation),&(J->LocalTranslation));
+					Touched = JE_TRUE;
+				}
+		}
 	else
 		{
 			if (jeMotion_SampleChannelsNamed(M,
@@ -815,7 +932,7 @@ static void JETCF jePose_SetMotionForABoneRecursion(jePose *P, const jeMotion *M
 			J->LocalTranslation.Z *= P->Scale.Z;
 		}
 	if (J->ParentJoint != JE_POSE_ROOT_JOINT)
-		jePose_SetMotionForABoneRecursion(P,M,Time,J->ParentJoint,NameBinding);
+		jePose_SetMotionForABoneRecursion(P,M,Time,J->ParentJoint,NameBinding,Binding);
 	
 }
 
@@ -823,6 +940,7 @@ void JETCF jePose_SetMotionForABone(jePose *P, const jeMotion *M, jeFloat Time,
 							const jeXForm3d *Transform,int BoneIndex)
 {
 	jeBoolean NameBinding;
+	const int *Binding = NULL;
 	jeXForm3d RootTransform;
 	
 	assert( P != NULL );
@@ -870,11 +988,14 @@ void JETCF jePose_SetMotionForABone(jePose *P, const jeMotion *M, jeFloat Time,
 	if (jePose_MatchesMotionExactly(P,M)==JE_TRUE)
 		NameBinding = JE_FALSE;
 	else
-		NameBinding = JE_TRUE;
+		{
+			NameBinding = JE_TRUE;
+			Binding = jePose_GetBinding(P,M);
+		}
 
 	P->Touched = JE_TRUE;
 
-	jePose_SetMotionForABoneRecursion(P, M, Time, BoneIndex, NameBinding);
+	jePose_SetMotionForABoneRecursion(P, M, Time, BoneIndex, NameBinding, Binding);
 }
 	
 
@@ -892,6 +1013,7 @@ void JETCF jePose_BlendMotion(
 {
 	int i;
 	jeBoolean NameBinding;
+	const int *Binding = NULL;
 	jePose_Joint *J;
 	jeQuaternion R1;
 	jeVec3d      T1;
@@ -958,7 +1080,10 @@ void JETCF jePose_BlendMotion(
 	if (jePose_MatchesMotionExactly(P,M)==JE_TRUE)
 		NameBinding = JE_FALSE;
 	else
-		NameBinding = JE_TRUE;
+		{
+			NameBinding = JE_TRUE;
+			Binding = jePose_GetBinding(P,M);
+		}
 	
 	P->Touched = JE_TRUE;
 
@@ -972,6 +1097,12 @@ void JETCF jePose_BlendMotion(
 					//JointPath = jeMotion_GetPath(M,i);
 					//assert( JointPath != NULL );
 				}
+			else if (Binding != NULL)
+				{
+					if (Binding[i] < 0)
+						continue;
+					jeMotion_SampleChannels(M,Binding[i],Time,&R1,&T1);
+				}
 			else
 				{
 					//JointPath = jeMotion_GetPathNamed(M, jeStrBlock_GetString(P->JointNames,i));
@@ -1065,6 +1196,7 @@ int JETCF jePose_AccumulateCoverage(jePose *P, const jeMotion *M, jeBoolean Quer
 {
 	int i,SubMotions;
 	jeBoolean NameBinding;
+	const int *Binding = NULL;
 	int Covers=0;
 	jePose_Joint *J;
 	
@@ -1091,14 +1223,22 @@ int JETCF jePose_AccumulateCoverage(jePose *P, const jeMotion *M, jeBoolean Quer
 	if (jePose_MatchesMotionExactly(P,M)==JE_TRUE)
 		NameBinding = JE_FALSE;
 	else
-		NameBinding = JE_TRUE;
+		{
+			NameBinding = JE_TRUE;
+			Binding = jePose_GetBinding(P,M);
+		}
 
 	for (i=0, J=&(P->JointArray[0]); i<P->JointCount; i++,J++)
 		{
 			jePath *JointPath;
 			if (J->Covered == JE_FALSE)
 				{
-					if (NameBinding == JE_TRUE)
+					if (Binding != NULL)
+						{
+							if (Binding[i] < 0)
+								continue;
+						}
+					else if (NameBinding == JE_TRUE)
 						{
 							JointPath = jeMotion_GetPathNamed(M, jeStrBlock_GetString(P->JointNames,i));
 							if (JointPath == NULL)
@@ -213,6 +213,16 @@ static jeBoolean JETCF jePuppet_FetchTextures(jePuppet *P, const jeBody *B)
 			M->UseTexture = JE_TRUE;
 			assert( P->pEngine );
 
+			// A body read by a background world load hasn't attached its bitmaps yet
+			if ( ! jeMaterialSpec_SetEngine(Bitmap, P->pEngine) )
+			{
+				jeErrorLog_AddString(JE_ERR_SUBSYSTEM_FAILURE,"jePuppet_FetchTextures : jeMaterialSpec_SetEngine", NULL);
+				jeRam_Free(P->MaterialArray);
+				P->MaterialArray = NULL;
+				P->MaterialCount = 0;
+				return JE_FALSE;
+			}
+
 			M->Material = Bitmap;
 			jeMaterialSpec_CreateRef(Bitmap);
 
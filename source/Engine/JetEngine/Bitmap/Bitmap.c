@@ -86,6 +86,7 @@ see {} for notes/long-term-todos
 #include	"Bitmap.__h"
 #include	"bitmap_blitdata.h"
 #include	"bitmap_gamma.h"
+#include	"bitmap_convert.h"
 
 #include	"Wavelet.h"
 #include	"palcreate.h"
@@ -1952,8 +1953,10 @@ JETAPI	jeBoolean	JETCC	jeBitmap_HasAlpha(const jeBitmap * Bmp)
 return JE_FALSE;
 }
 
-jeBoolean	BITMAP_JET_INTERNAL jeBitmap_AttachToDriver(jeBitmap *Bmp, 
-	DRV_Driver * Driver, uint32 DriverFlags)
+static jeBoolean jeBitmap_AttachJob_Setup(jeBitmap *Bmp,jeBitmap_AttachJob *Job);
+
+static jeBoolean jeBitmap_AttachToDriver_Sub(jeBitmap *Bmp, 
+	DRV_Driver * Driver, uint32 DriverFlags, jeBitmap_AttachJob *Job)
 {
 
 	/**************
@@ -2146,6 +2149,10 @@ jeBoolean	BITMAP_JET_INTERNAL jeBitmap_AttachToDriver(jeBitmap *Bmp,
 		}
 #endif
 
+		// staged attach : the job does the system -> driver update later
+		if ( Job && jeBitmap_AttachJob_Setup(Bmp,Job) )
+			return JE_TRUE;
+
 		if ( ! jeBitmap_Update_SystemToDriver(Bmp) )
 		{
 			jeErrorLog_AddString(-1,"AttachToDriver : Update_SystemToDriver", NULL);
@@ -2161,6 +2168,349 @@ jeBoolean	BITMAP_JET_INTERNAL jeBitmap_AttachToDriver(jeBitmap *Bmp,
 return JE_TRUE;
 }
 
+jeBoolean	BITMAP_JET_INTERNAL jeBitmap_AttachToDriver(jeBitmap *Bmp, 
+	DRV_Driver * Driver, uint32 DriverFlags)
+{
+	return jeBitmap_AttachToDriver_Sub(Bmp,Driver,DriverFlags,NULL);
+}
+
+/*}{*******************************************************/
+// staged attach : see Bitmap._h
+
+jeBoolean	BITMAP_JET_INTERNAL jeBitmap_AttachToDriver_Begin(jeBitmap *Bmp, 
+	DRV_Driver * Driver, uint32 DriverFlags, jeBitmap_AttachJob *Job)
+{
+	assert(Job);
+	clear(Job);
+	return jeBitmap_AttachToDriver_Sub(Bmp,Driver,DriverFlags,Job);
+}
+
+static void jeBitmap_AttachJob_Free(jeBitmap_AttachJob *Job)
+{
+	if ( Job->SrcLock )
+		jeBitmap_UnLockArray(&(Job->SrcLock),1);
+	if ( Job->Table )
+		jeBitmap_Palette_Destroy(&(Job->Table));
+	if ( Job->MipBits[0] )
+		jeRam_Free(Job->MipBits[0]);
+	clear(Job);
+}
+
+static jeBoolean jeBitmap_AttachJob_Setup(jeBitmap *Bmp,jeBitmap_AttachJob *Job)
+{
+jeTexture * SaveDriverHandle;
+const jeBitmap_Palette * SrcPal;
+jeBoolean Ok;
+int32 mip,bpp,bytes;
+uint8 * Bits;
+
+	// returns false to have Bmp go through Update_SystemToDriver instead;
+	//	that's anything which needs more than a palette lookup & mip building
+
+	if ( Bmp->Info.Format != JE_PIXELFORMAT_8BIT || Bmp->Wavelet || Bmp->Alpha )
+		return JE_FALSE;
+
+	if ( jePixelFormat_HasPalette(Bmp->DriverInfo.Format) )
+		return JE_FALSE;
+
+	bpp = jePixelFormat_BytesPerPel(Bmp->DriverInfo.Format);
+	if ( bpp < 1 || bpp > 4 )
+		return JE_FALSE;
+
+	if ( Bmp->DriverInfo.MinimumMip != 0 || Bmp->DriverMipBase != 0 ||
+		Bmp->DriverInfo.MaximumMip >= JE_BITMAP_ATTACH_MAX_MIPS )
+		return JE_FALSE;
+
+	for(mip=Bmp->DriverInfo.MinimumMip;mip<=Bmp->DriverInfo.MaximumMip;mip++)
+	{
+		if ( Bmp->Modified[mip] && mip != Bmp->Info.MinimumMip )
+			return JE_FALSE;
+	}
+
+	assert( ! Bmp->DriverDataChanged );
+
+	Job->NumMips = Bmp->DriverInfo.MaximumMip + 1;
+
+	bytes = 0;
+	for(mip=0;mip<Job->NumMips;mip++)
+	{
+		Job->MipInfo[mip] = Bmp->DriverInfo;
+		if ( ! jeBitmap_MakeDriverLockInfo(Bmp,mip,&(Job->MipInfo[mip])) )
+		{
+			clear(Job);
+			return JE_FALSE;
+		}
+		bytes += Job->MipInfo[mip].Stride * Job->MipInfo[mip].Height * bpp;
+	}
+
+	SaveDriverHandle = Bmp->DriverHandle;
+	Bmp->DriverHandle = NULL;	// so Lock() won't use the driver data
+	Ok = jeBitmap_LockForReadNative(Bmp,&(Job->SrcLock),0,0);
+	Bmp->DriverHandle = SaveDriverHandle;
+
+	if ( ! Ok )
+	{
+		clear(Job);
+		return JE_FALSE;
+	}
+
+	Job->SrcInfo = Job->SrcLock->Info;
+	Job->SrcBits = jeBitmap_GetBits(Job->SrcLock);
+
+	SrcPal = Job->SrcInfo.Palette;
+	if ( ! SrcPal )
+		SrcPal = jeBitmap_GetPalette(Job->SrcLock);
+
+	// BlitData would only fill part of a bigger target; leave that to it
+	if ( ! Job->SrcBits || ! SrcPal || Job->SrcInfo.Format != JE_PIXELFORMAT_8BIT ||
+		Job->SrcInfo.Width != Job->MipInfo[0].Width || Job->SrcInfo.Height != Job->MipInfo[0].Height )
+	{
+		jeBitmap_AttachJob_Free(Job);
+		return JE_FALSE;
+	}
+
+	// the driver bits get gamma corrected after the blit; correcting the
+	//	lookup table instead gives the same pixels
+	Job->Table = jeBitmap_BlitData_DePalettizeTable(&(Job->SrcInfo),SrcPal,&(Job->MipInfo[0]));
+	if ( ! Job->Table || ! jeBitmap_Gamma_ApplyPalette(Bmp->DriverGamma,Job->Table) )
+	{
+		jeBitmap_AttachJob_Free(Job);
+		return JE_FALSE;
+	}
+
+	Bits = (uint8 *)jeRam_Allocate(bytes);
+	if ( ! Bits )
+	{
+		jeBitmap_AttachJob_Free(Job);
+		return JE_FALSE;
+	}
+
+	for(mip=0;mip<Job->NumMips;mip++)
+	{
+		Job->MipBits[mip] = Bits;
+		Bits += Job->MipInfo[mip].Stride * Job->MipInfo[mip].Height * bpp;
+	}
+
+	Job->Bmp = Bmp;
+
+return JE_TRUE;
+}
+
+void		BITMAP_JET_INTERNAL jeBitmap_AttachToDriver_Convert(jeBitmap_AttachJob *Job)
+{
+const uint8 * SrcPtr;
+int32 x,y,w,h,mip,SrcXtra,DstXtra;
+
+	assert(Job);
+
+	if ( ! Job->Bmp || Job->Converted )
+		return;
+
+	// the Pal -> UnPal loops of BlitData_DePalettize, working only on the job
+
+	w = Job->SrcInfo.Width;
+	h = Job->SrcInfo.Height;
+	SrcPtr = (const uint8 *)Job->SrcBits;
+	SrcXtra = Job->SrcInfo.Stride - w;
+	DstXtra = Job->MipInfo[0].Stride - w;
+
+	switch( jePixelFormat_BytesPerPel(Job->MipInfo[0].Format) )
+	{
+		default:
+			return;
+		case 1:
+		{
+		uint8 *DstPtr,*PalData;
+			PalData = (uint8 *)Job->Table->Data;
+			DstPtr  = (uint8 *)Job->MipBits[0];
+			for(y=h;y--;)
+			{
+				for(x=w;x--;)
+					*DstPtr++ = PalData[*SrcPtr++];
+				SrcPtr += SrcXtra;
+				DstPtr += DstXtra;
+			}
+			break;
+		}
+		case 2:
+		{
+		uint16 *DstPtr,*PalData;
+			PalData = (uint16 *)Job->Table->Data;
+			DstPtr  = (uint16 *)Job->MipBits[0];
+			for(y=h;y--;)
+			{
+				for(x=w;x--;)
+					*DstPtr++ = PalData[*SrcPtr++];
+				SrcPtr += SrcXtra;
+				DstPtr += DstXtra;
+			}
+			break;
+		}
+		case 3:
+		{
+		uint8 *DstPtr,*PalData,*PalPtr;
+			PalData = (uint8 *)Job->Table->Data;
+			DstPtr  = (uint8 *)Job->MipBits[0];
+			for(y=h;y--;)
+			{
+				for(x=w;x--;)
+				{
+					PalPtr = PalData + 3*(*SrcPtr++);
+					*DstPtr++ = PalPtr[0];
+					*DstPtr++ = PalPtr[1];
+					*DstPtr++ = PalPtr[2];
+				}
+				SrcPtr += SrcXtra;
+				DstPtr += DstXtra*3;
+			}
+			break;
+		}
+		case 4:
+		{
+			// staged attach : same SIMD lookup as BlitData_DePalettize
+			jeBitmap_Convert_Lookup32(	SrcPtr,Job->SrcInfo.Stride,(const uint32 *)Job->Table->Data,
+										(uint32 *)Job->MipBits[0],Job->MipInfo[0].Stride * 4,w,h);
+			break;
+		}
+	}
+
+	for(mip=1;mip<Job->NumMips;mip++)
+	{
+		if ( ! jeBitmap_UpdateMips_Data(&(Job->MipInfo[mip-1]),Job->MipBits[mip-1],
+										&(Job->MipInfo[mip]),Job->MipBits[mip]) )
+			return;
+	}
+
+	Job->Converted = JE_TRUE;
+}
+
+jeBoolean	BITMAP_JET_INTERNAL jeBitmap_AttachToDriver_Upload(DRV_Driver * Driver, 
+	jeBitmap_AttachJob *Jobs, int32 NumJobs)
+{
+jeBitmap_AttachJob * Job;
+int32 i,mip,bpp;
+jeBoolean Ret = JE_TRUE;
+
+	assert( Driver );
+	assert( Jobs || NumJobs == 0 );
+
+	if ( Driver->THandle_UploadBatch )
+	{
+	DRV_TextureUpload * Uploads,*Up;
+
+		Uploads = (DRV_TextureUpload *)jeRam_Allocate(sizeof(DRV_TextureUpload) * JE_BITMAP_ATTACH_MAX_MIPS * max(NumJobs,1));
+		if ( Uploads )
+		{
+			Up = Uploads;
+			for(i=0;i<NumJobs;i++)
+			{
+				Job = Jobs + i;
+				if ( ! Job->Bmp || ! Job->Converted || Job->Uploaded )
+					continue;
+
+				assert( Job->Bmp->Driver == Driver );
+				bpp = jePixelFormat_BytesPerPel(Job->MipInfo[0].Format);
+
+				for(mip=0;mip<Job->NumMips;mip++)
+				{
+					Up->THandle		= Job->Bmp->DriverHandle;
+					Up->MipLevel	= mip;
+					Up->Bits		= Job->MipBits[mip];
+					Up->Stride		= Job->MipInfo[mip].Stride * bpp;
+					Up->RowBytes	= Job->MipInfo[mip].Width * bpp;
+					Up->Height		= Job->MipInfo[mip].Height;
+					Up++;
+				}
+			}
+
+			if ( Up == Uploads || Driver->THandle_UploadBatch(Uploads,(int32)(Up - Uploads)) )
+			{
+				for(i=0;i<NumJobs;i++)
+				{
+					if ( Jobs[i].Bmp && Jobs[i].Converted )
+						Jobs[i].Uploaded = JE_TRUE;
+				}
+			}
+			else
+			{
+				jeErrorLog_AddString(-1,"AttachToDriver_Upload : THandle_UploadBatch failed, using THandle_Lock", NULL);
+			}
+
+			jeRam_Free(Uploads);
+		}
+	}
+
+	// anything left goes one mip at a time
+
+	for(i=0;i<NumJobs;i++)
+	{
+		Job = Jobs + i;
+		if ( ! Job->Bmp || ! Job->Converted || Job->Uploaded )
+			continue;
+
+		bpp = jePixelFormat_BytesPerPel(Job->MipInfo[0].Format);
+
+		for(mip=0;mip<Job->NumMips;mip++)
+		{
+		void * DstBits;
+
+			if ( ! Driver->THandle_Lock(Job->Bmp->DriverHandle,mip,&DstBits) )
+			{
+				jeErrorLog_AddString(-1,"AttachToDriver_Upload : THandle_Lock", NULL);
+				break;
+			}
+
+			// same layout as the lock, so this is the whole blit
+			memcpy(DstBits,Job->MipBits[mip],Job->MipInfo[mip].Stride * Job->MipInfo[mip].Height * bpp);
+
+			if ( ! Driver->THandle_UnLock(Job->Bmp->DriverHandle,mip) )
+			{
+				jeErrorLog_AddString(-1,"AttachToDriver_Upload : THandle_UnLock", NULL);
+				break;
+			}
+		}
+
+		if ( mip == Job->NumMips )
+			Job->Uploaded = JE_TRUE;
+		else
+			Ret = JE_FALSE;
+	}
+
+return Ret;
+}
+
+jeBoolean	BITMAP_JET_INTERNAL jeBitmap_AttachToDriver_End(jeBitmap_AttachJob *Job)
+{
+jeBitmap * Bmp;
+jeBoolean Ret;
+
+	assert(Job);
+
+	Bmp = Job->Bmp;
+	if ( ! Bmp )
+		return JE_TRUE;
+
+	Ret = ( Job->Converted && Job->Uploaded ) ? JE_TRUE : JE_FALSE;
+
+	jeBitmap_AttachJob_Free(Job);
+
+	// as Update_SystemToDriver leaves it
+	Bmp->DriverBitsLocked = JE_FALSE;
+	Bmp->DriverMipLock = 0;
+	Bmp->DriverDataChanged = JE_FALSE;
+
+	if ( ! Ret )
+	{
+		jeErrorLog_AddString(-1,"AttachToDriver_End : bits didn't make it to the driver", NULL);
+		Bmp->Driver->THandle_Destroy(Bmp->DriverHandle);
+		Bmp->DriverHandle = NULL;
+	}
+
+return Ret;
+}
+
+/*}{*******************************************************/
+
 jeBoolean jeBitmap_FixDriverFlags(uint32 *pFlags)
 {
 uint32 DriverFlags;
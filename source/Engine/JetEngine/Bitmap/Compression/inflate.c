@@ -0,0 +1,472 @@
+/****************************************************************************************/
+/*  INFLATE.C                                                                           */
+/*                                                                                      */
+/*  Author: Styx3D Modernization                                                        */
+/*  Description: Raw deflate (RFC 1951) decoder, for zip/pk3 archives                   */
+/*                                                                                      */
+/*  Canonical Huffman decode with a 10 bit lookup table in front of the usual           */
+/*  count/symbol walk for longer codes.  Output is decoded a block at a time straight   */
+/*  into the caller's array, which is what lets FSZip keep decoding ahead of a reader.  */
+/*                                                                                      */
+/*  The contents of this file are subject to the 0BSD License.                          */
+/*  See LICENSE file in the project root for full license information.                  */
+/*                                                                                      */
+/****************************************************************************************/
+#include <assert.h>
+#include <string.h>
+
+#include "BaseType.h"
+#include "Ram.h"
+
+#include "inflate.h"
+
+#define INFLATE_FAST_BITS		10
+#define INFLATE_FAST_MASK		((1<<INFLATE_FAST_BITS)-1)
+#define INFLATE_MAX_BITS		15
+#define INFLATE_NUM_LITLEN		288
+#define INFLATE_NUM_DIST		30
+#define INFLATE_NUM_CODELEN		19
+
+typedef struct inflateHuffman
+{
+	uint16		Fast[1<<INFLATE_FAST_BITS];		// Symbol | (Length<<9), 0 if the code is longer
+	uint16		Count[INFLATE_MAX_BITS+1];
+	uint16		Symbol[INFLATE_NUM_LITLEN];
+} inflateHuffman;
+
+struct inflateDecoder
+{
+	const uint8 *	In;
+	uint32			InLen, InPos;
+	uint32			BitBuf;
+	int32			BitCount;
+	uint32			Overrun;			// Zero bytes fed in past the end of In
+
+	uint8 *			Out;
+	uint32			OutLen, OutPos;
+
+	jeBoolean		Done;
+	jeBoolean		Failed;
+
+	inflateHuffman	Lit, Dist;
+};
+
+static const uint16 LenBase[29] =	{	3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,
+										35,43,51,59,67,83,99,115,131,163,195,227,258 };
+static const uint8	LenExtra[29] =	{	0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,
+										3,3,3,3,4,4,4,4,5,5,5,5,0 };
+static const uint16 DistBase[30] =	{	1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,
+										257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577 };
+static const uint8	DistExtra[30] =	{	0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,
+										7,7,8,8,9,9,10,10,11,11,12,12,13,13 };
+static const uint8	CodeLenOrder[INFLATE_NUM_CODELEN] = { 16,17,18,0,8,7,9,6,10,5,11,4,12,3,13,2,14,1,15 };
+
+// True once the decoder has consumed bits that were never in the input
+#define INFLATE_OVERRUN(S)	((S)->Overrun*8 > (uint32)(S)->BitCount)
+
+/*}{ ******* Bits *******/
+
+static void inflate_Refill(inflateDecoder *S)
+{
+	while (S->BitCount <= 24)
+	{
+		uint32		Byte;
+
+		if (S->InPos < S->InLen)
+			Byte = S->In[S->InPos++];
+		else
+		{
+			Byte = 0;
+			S->Overrun++;
+		}
+
+		S->BitBuf |= Byte << S->BitCount;
+		S->BitCount += 8;
+	}
+}
+
+static uint32 inflate_GetBits(inflateDecoder *S, int32 Num)
+{
+	uint32		Bits;
+
+	assert(Num <= 16);
+
+	inflate_Refill(S);
+
+	Bits = S->BitBuf & ((1UL<<Num)-1);
+	S->BitBuf >>= Num;
+	S->BitCount -= Num;
+
+	return Bits;
+}
+
+/*}{ ******* Huffman *******/
+
+static jeBoolean inflate_BuildHuffman(inflateHuffman *H, const uint8 *Lengths, int32 Num)
+{
+	uint16		Offs[INFLATE_MAX_BITS+2];
+	int32		i, Len, Left, Index;
+	uint32		Code;
+
+	memset(H->Count, 0, sizeof(H->Count));
+	for (i=0; i<Num; i++)
+		H->Count[Lengths[i]]++;
+	H->Count[0] = 0;
+
+	// Over-subscribed sets are corrupt; incomplete ones are legal (single distance codes)
+	Left = 1;
+	for (Len=1; Len<=INFLATE_MAX_BITS; Len++)
+	{
+		Left <<= 1;
+		Left -= H->Count[Len];
+		if (Left < 0)
+			return JE_FALSE;
+	}
+
+	Offs[1] = 0;
+	for (Len=1; Len<INFLATE_MAX_BITS; Len++)
+		Offs[Len+1] = (uint16)(Offs[Len] + H->Count[Len]);
+
+	for (i=0; i<Num; i++)
+	{
+		if (Lengths[i])
+			H->Symbol[Offs[Lengths[i]]++] = (uint16)i;
+	}
+
+	// Codes are assigned in Symbol order; the stream sends them msb first, so the
+	// table is indexed by the bit-reversed code
+	memset(H->Fast, 0, sizeof(H->Fast));
+
+	Code = 0;
+	Index = 0;
+	for (Len=1; Len<=INFLATE_FAST_BITS; Len++)
+	{
+		for (i=0; i<H->Count[Len]; i++, Index++, Code++)
+		{
+			uint32		Rev, Bit, j;
+
+			Rev = 0;
+			for (Bit=0; Bit<(uint32)Len; Bit++)
+				Rev |= ((Code >> Bit) & 1) << (Len-1-Bit);
+
+			for (j=Rev; j<(1<<INFLATE_FAST_BITS); j += (1<<Len))
+				H->Fast[j] = (uint16)(H->Symbol[Index] | (Len<<9));
+		}
+		Code <<= 1;
+	}
+
+	return JE_TRUE;
+}
+
+static int32 inflate_Decode(inflateDecoder *S, const inflateHuffman *H)
+{
+	uint32		Entry;
+	int32		Len, Code, First, Index, Count;
+
+	inflate_Refill(S);
+
+	Entry = H->Fast[S->BitBuf & INFLATE_FAST_MASK];
+	if (Entry)
+	{
+		Len = Entry >> 9;
+		S->BitBuf >>= Len;
+		S->BitCount -= Len;
+		return Entry & 511;
+	}
+
+	// Longer than the table; walk the canonical code a bit at a time
+	Code = First = Index = 0;
+	for (Len=1; Len<=INFLATE_MAX_BITS; Len++)
+	{
+		Code |= S->BitBuf & 1;
+		S->BitBuf >>= 1;
+		S->BitCount--;
+
+		Count = H->Count[Len];
+		if (Code - Count < First)
+			return H->Symbol[Index + (Code - First)];
+
+		Index += Count;
+		First += Count;
+		First <<= 1;
+		Code <<= 1;
+	}
+
+	return -1;
+}
+
+/*}{ ******* Blocks *******/
+
+static jeBoolean inflate_Stored(inflateDecoder *S)
+{
+	uint32		Len, NLen;
+
+	// Skip to the byte boundary
+	inflate_GetBits(S, S->BitCount & 7);
+
+	Len = inflate_GetBits(S, 16);
+	NLen = inflate_GetBits(S, 16);
+	if (Len != (~NLen & 0xffff))
+		return JE_FALSE;
+
+	if (Len > S->OutLen - S->OutPos)
+		return JE_FALSE;
+
+	// Whole bytes still sitting in the bit buffer come first
+	while (Len && S->BitCount >= 8)
+	{
+		S->Out[S->OutPos++] = (uint8)(S->BitBuf & 0xff);
+		S->BitBuf >>= 8;
+		S->BitCount -= 8;
+		Len--;
+	}
+
+	if (INFLATE_OVERRUN(S))
+		return JE_FALSE;
+
+	if (Len)
+	{
+		assert(S->BitCount == 0);
+
+		if (Len > S->InLen - S->InPos)
+			return JE_FALSE;
+
+		memcpy(S->Out + S->OutPos, S->In + S->InPos, Len);
+		S->InPos += Len;
+		S->OutPos += Len;
+	}
+
+	return JE_TRUE;
+}
+
+static jeBoolean inflate_Codes(inflateDecoder *S)
+{
+	for (;;)
+	{
+		int32		Sym;
+		uint32		Len, Dist;
+
+		Sym = inflate_Decode(S, &S->Lit);
+
+		if (INFLATE_OVERRUN(S))
+			return JE_FALSE;
+
+		if (Sym < 256)
+		{
+			if (Sym < 0 || S->OutPos >= S->OutLen)
+				return JE_FALSE;
+
+			S->Out[S->OutPos++] = (uint8)Sym;
+			continue;
+		}
+
+		if (Sym == 256)
+			return JE_TRUE;
+
+		Sym -= 257;
+		if (Sym >= 29)
+			return JE_FALSE;
+
+		Len = LenBase[Sym] + inflate_GetBits(S, LenExtra[Sym]);
+
+		Sym = inflate_Decode(S, &S->Dist);
+		if (Sym < 0 || Sym >= 30)
+			return JE_FALSE;
+
+		Dist = DistBase[Sym] + inflate_GetBits(S, DistExtra[Sym]);
+
+		if (Dist > S->OutPos || Len > S->OutLen - S->OutPos)
+			return JE_FALSE;
+
+		if (Dist >= Len)
+		{
+			memcpy(S->Out + S->OutPos, S->Out + S->OutPos - Dist, Len);
+			S->OutPos += Len;
+		}
+		else
+		{
+			uint8		*Dst = S->Out + S->OutPos;
+			const uint8	*Src = Dst - Dist;
+
+			// Overlapping run; has to go a byte at a time
+			S->OutPos += Len;
+			while (Len--)
+				*Dst++ = *Src++;
+		}
+	}
+}
+
+static jeBoolean inflate_Fixed(inflateDecoder *S)
+{
+	uint8		Lengths[INFLATE_NUM_LITLEN];
+	int32		i;
+
+	for (i=0; i<144; i++)	Lengths[i] = 8;
+	for (; i<256; i++)		Lengths[i] = 9;
+	for (; i<280; i++)		Lengths[i] = 7;
+	for (; i<288; i++)		Lengths[i] = 8;
+
+	if (!inflate_BuildHuffman(&S->Lit, Lengths, INFLATE_NUM_LITLEN))
+		return JE_FALSE;
+
+	for (i=0; i<INFLATE_NUM_DIST; i++)
+		Lengths[i] = 5;
+
+	if (!inflate_BuildHuffman(&S->Dist, Lengths, INFLATE_NUM_DIST))
+		return JE_FALSE;
+
+	return inflate_Codes(S);
+}
+
+static jeBoolean inflate_Dynamic(inflateDecoder *S)
+{
+	uint8		Lengths[INFLATE_NUM_LITLEN+INFLATE_NUM_DIST];
+	int32		NumLit, NumDist, NumCode, i;
+
+	NumLit = inflate_GetBits(S, 5) + 257;
+	NumDist = inflate_GetBits(S, 5) + 1;
+	NumCode = inflate_GetBits(S, 4) + 4;
+
+	if (NumLit > 286 || NumDist > INFLATE_NUM_DIST)
+		return JE_FALSE;
+
+	// Code length code, reusing Lit for it
+	memset(Lengths, 0, INFLATE_NUM_CODELEN);
+	for (i=0; i<NumCode; i++)
+		Lengths[CodeLenOrder[i]] = (uint8)inflate_GetBits(S, 3);
+
+	if (!inflate_BuildHuffman(&S->Lit, Lengths, INFLATE_NUM_CODELEN))
+		return JE_FALSE;
+
+	i = 0;
+	while (i < NumLit + NumDist)
+	{
+		int32		Sym, Repeat;
+		uint8		Value;
+
+		Sym = inflate_Decode(S, &S->Lit);
+		if (Sym < 0 || INFLATE_OVERRUN(S))
+			return JE_FALSE;
+
+		if (Sym < 16)
+		{
+			Lengths[i++] = (uint8)Sym;
+			continue;
+		}
+
+		if (Sym == 16)
+		{
+			if (i == 0)
+				return JE_FALSE;
+			Value = Lengths[i-1];
+			Repeat = 3 + inflate_GetBits(S, 2);
+		}
+		else if (Sym == 17)
+		{
+			Value = 0;
+			Repeat = 3 + inflate_GetBits(S, 3);
+		}
+		else
+		{
+			Value = 0;
+			Repeat = 11 + inflate_GetBits(S, 7);
+		}
+
+		if (i + Repeat > NumLit + NumDist)
+			return JE_FALSE;
+
+		while (Repeat--)
+			Lengths[i++] = Value;
+	}
+
+	// A block with no end code can't terminate
+	if (Lengths[256] == 0)
+		return JE_FALSE;
+
+	if (!inflate_BuildHuffman(&S->Lit, Lengths, NumLit))
+		return JE_FALSE;
+
+	if (!inflate_BuildHuffman(&S->Dist, Lengths + NumLit, NumDist))
+		return JE_FALSE;
+
+	return inflate_Codes(S);
+}
+
+static jeBoolean inflate_Block(inflateDecoder *S)
+{
+	uint32		Final, Type;
+	jeBoolean	Ok;
+
+	Final = inflate_GetBits(S, 1);
+	Type = inflate_GetBits(S, 2);
+
+	switch (Type)
+	{
+	case 0:		Ok = inflate_Stored(S);		break;
+	case 1:		Ok = inflate_Fixed(S);		break;
+	case 2:		Ok = inflate_Dynamic(S);	break;
+	default:	Ok = JE_FALSE;				break;
+	}
+
+	if (!Ok || INFLATE_OVERRUN(S))
+		return JE_FALSE;
+
+	if (Final)
+		S->Done = JE_TRUE;
+
+	return JE_TRUE;
+}
+
+/*}{ ******* API *******/
+
+inflateDecoder * inflateDecoder_Create(const uint8 *compArray,uint32 compLen,uint8 *rawArray,uint32 rawLen)
+{
+	inflateDecoder	*Stream;
+
+	assert(compArray || !compLen);
+	assert(rawArray || !rawLen);
+
+	Stream = (inflateDecoder *)jeRam_AllocateClear(sizeof(*Stream));
+	if (!Stream)
+		return NULL;
+
+	Stream->In = compArray;
+	Stream->InLen = compLen;
+	Stream->Out = rawArray;
+	Stream->OutLen = rawLen;
+
+	return Stream;
+}
+
+jeBoolean inflateDecoder_Extend(inflateDecoder *Stream,uint32 WantLen,uint32 *pCurAvailable)
+{
+	assert(Stream);
+
+	while (!Stream->Done && !Stream->Failed && Stream->OutPos < WantLen)
+	{
+		if (!inflate_Block(Stream))
+			Stream->Failed = JE_TRUE;
+	}
+
+	if (pCurAvailable)
+		*pCurAvailable = Stream->OutPos;
+
+	return Stream->Failed ? JE_FALSE : JE_TRUE;
+}
+
+jeBoolean inflateDecoder_IsDone(const inflateDecoder *Stream)
+{
+	assert(Stream);
+	return Stream->Done;
+}
+
+void inflateDecoder_Destroy(inflateDecoder **pStream)
+{
+	assert(pStream);
+
+	if (*pStream)
+	{
+		jeRam_Free(*pStream);
+		*pStream = NULL;
+	}
+}
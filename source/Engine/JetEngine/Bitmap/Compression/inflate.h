@@ -0,0 +1,38 @@
+/****************************************************************************************/
+/*  INFLATE.H                                                                           */
+/*                                                                                      */
+/*  Author: Styx3D Modernization                                                        */
+/*  Description: Raw deflate (RFC 1951) decoder, for zip/pk3 archives                   */
+/*                                                                                      */
+/*  The contents of this file are subject to the 0BSD License.                          */
+/*  See LICENSE file in the project root for full license information.                  */
+/*                                                                                      */
+/****************************************************************************************/
+#ifndef JE_INFLATE_H
+#define JE_INFLATE_H
+
+#include "BaseType.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct inflateDecoder inflateDecoder;
+
+//	Like lzaDecoder, the whole output array is supplied up front and the stream
+//	decodes into it in place, so back references never need a separate window.
+//	compArray must stay valid until the decoder is destroyed.
+extern inflateDecoder *	inflateDecoder_Create(const uint8 *compArray,uint32 compLen,uint8 *rawArray,uint32 rawLen);
+
+//	Decodes whole deflate blocks until at least WantLen bytes of rawArray are
+//	valid (or the stream ends).  Returns JE_FALSE on corrupt data.
+extern jeBoolean		inflateDecoder_Extend(inflateDecoder *Stream,uint32 WantLen,uint32 *pCurAvailable);
+
+extern jeBoolean		inflateDecoder_IsDone(const inflateDecoder *Stream);
+extern void				inflateDecoder_Destroy(inflateDecoder **pStream);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -34,6 +34,7 @@
 #include	"Bitmap._h"
 #include	"Bitmap.__h"
 #include	"bitmap_blitdata.h"
+#include	"bitmap_convert.h"
 
 #include	"VFile.h"
 #include	"Errorlog.h"
@@ -415,6 +416,31 @@ uint32 ColorKey,Pixel;
 		jeErrorLog_AddString(-1,"Bitmap_BlitData : invalid format", NULL);
 		return JE_FALSE;
 	}
+	else if ( jeBitmap_Convert_HasKernel(SrcFormat,DstFormat) )
+	{
+	jeBitmap_ConvertKeys Keys;
+
+		// the common pairs have SIMD kernels that do the same color key cases as below
+
+		if ( SrcOps->AMask && ! (DstOps->AMask) && DstInfo->HasColorKey )
+		{
+			Keys.SrcHasKey = JE_FALSE;
+			Keys.SrcKey = 0;
+			Keys.AlphaToKey = ALPHA_TO_TRANSPARENCY_THRESHOLD;
+		}
+		else
+		{
+			Keys.SrcHasKey = SrcInfo->HasColorKey;
+			Keys.SrcKey = SrcInfo->ColorKey;
+			Keys.AlphaToKey = 0;
+		}
+		Keys.DstHasKey = DstInfo->HasColorKey;
+		Keys.DstKey = DstInfo->ColorKey;
+
+	return jeBitmap_Convert_Rows(	SrcFormat,SrcData,SrcInfo->Stride * SrcPelBytes,
+									DstFormat,DstData,DstInfo->Stride * DstPelBytes,
+									SizeX,SizeY,&Keys);
+	}
 	else if ( SrcOps->AMask && ! (DstOps->AMask) && DstInfo->HasColorKey )
 	{
 		ColorKey = DstInfo->ColorKey;
@@ -1324,101 +1350,126 @@ jePixelFormat Format;
 }
 /*}{*********************************************************************/
 
-jeBoolean BlitData_DePalettize(void)
+// Builds the Pal -> DstInfo->Format lookup that BlitData_DePalettize writes through.
+// Takes everything as arguments (the names shadow the statics on purpose), so the
+// table can be made up front and the lookup done without holding Bitmap_BlitData_Lock.
+
+jeBitmap_Palette * jeBitmap_BlitData_DePalettizeTable(const jeBitmap_Info * SrcInfo,const jeBitmap_Palette * SrcPal,
+													const jeBitmap_Info * DstInfo)
 {
-	// pal -> unpal : easy
-	if ( SrcFormat == JE_PIXELFORMAT_8BIT )
-	{
-	uint8 * SrcPtr;
-	jeBitmap_Palette * DstPal;
-	int x,y,pal;
-	const jePixelFormat_Operations *SrcOps,*DstOps;
+jeBitmap_Palette * DstPal;
+jePixelFormat DstFormat;
+const jePixelFormat_Operations *SrcOps,*DstOps;
 
-		x = y = pal = 0; //touch 'em
+	assert( SrcInfo && SrcPal && DstInfo );
 
-		SrcOps = jePixelFormat_GetOperations(SrcPal->Format);
-		DstOps = jePixelFormat_GetOperations(DstFormat);
-		if ( ! SrcOps || ! DstOps )
-		{
-			return JE_FALSE;
-		}
+	DstFormat = DstInfo->Format;
 
-		// NO special cases
-		// just convert the Palette to the desired format, then do raw writes!
+	SrcOps = jePixelFormat_GetOperations(SrcPal->Format);
+	DstOps = jePixelFormat_GetOperations(DstFormat);
+	if ( ! SrcOps || ! DstOps )
+	{
+		return NULL;
+	}
 
-		DstPal = jeBitmap_Palette_Create(DstFormat,256);
-		if ( ! DstPal )
-		{
-			jeErrorLog_AddString(-1,"Bitmap_BlitData : Palette_Create failed", NULL);	
-			return JE_FALSE;
-		}
+	// NO special cases
+	// just convert the Palette to the desired format, then do raw writes!
 
-		// we do all alpha & colorkey by manipulating the DstPal lookup table !
+	DstPal = jeBitmap_Palette_Create(DstFormat,256);
+	if ( ! DstPal )
+	{
+		jeErrorLog_AddString(-1,"Bitmap_BlitData : Palette_Create failed", NULL);	
+		return NULL;
+	}
 
-		//{} all these _jeBitmap_Palette functions need failure checking
+	// we do all alpha & colorkey by manipulating the DstPal lookup table !
 
-		if ( ! jeBitmap_Palette_Copy(SrcPal,DstPal) )
+	//{} all these _jeBitmap_Palette functions need failure checking
+
+	if ( ! jeBitmap_Palette_Copy(SrcPal,DstPal) )
+	{
+		jeErrorLog_AddString(-1,"Bitmap_BlitData : Palette_Copy failed", NULL);
+		jeBitmap_Palette_Destroy(&DstPal);
+		return NULL;
+	}
+
+	if ( SrcInfo->HasColorKey )
+	{
+		if ( ! jeBitmap_Palette_SetEntryColor(DstPal,SrcInfo->ColorKey,0,0,0,0) )
 		{
-			jeErrorLog_AddString(-1,"Bitmap_BlitData : Palette_Copy failed", NULL);
 			jeBitmap_Palette_Destroy(&DstPal);
-			return JE_FALSE;
+			return NULL;
 		}
+	}
 
-		if ( SrcInfo->HasColorKey )
+	if ( DstInfo->HasColorKey ) // everything in Jet3D has colorkey!
+	{
+	int pal;
+	uint32 Pixel;
+		for(pal=0;pal<DstPal->Size;pal++)
 		{
-			if ( ! jeBitmap_Palette_SetEntryColor(DstPal,SrcInfo->ColorKey,0,0,0,0) )
+			//{} all this GetEntry/SetEntry is awfully slow
+			jeBitmap_Palette_GetEntry(DstPal,pal,&Pixel);
+			if ( Pixel == DstInfo->ColorKey )
 			{
-				jeBitmap_Palette_Destroy(&DstPal);
-				return JE_FALSE;
+				jeBitmap_Palette_SetEntry(DstPal,pal,Pixel^1);
 			}
 		}
+		
+	}
 
-		if ( DstInfo->HasColorKey ) // everything in Jet3D has colorkey!
+	if ( SrcInfo->HasColorKey && DstInfo->HasColorKey )
+	{
+		if ( ! jeBitmap_Palette_SetEntry(DstPal,SrcInfo->ColorKey,DstInfo->ColorKey) )
 		{
-		int pal;
-		uint32 Pixel;
-			for(pal=0;pal<DstPal->Size;pal++)
-			{
-				//{} all this GetEntry/SetEntry is awfully slow
-				jeBitmap_Palette_GetEntry(DstPal,pal,&Pixel);
-				if ( Pixel == DstInfo->ColorKey )
-				{
-					jeBitmap_Palette_SetEntry(DstPal,pal,Pixel^1);
-				}
-			}
-			
+			jeBitmap_Palette_Destroy(&DstPal);
+			return NULL;
 		}
+	}
+
+	if ( SrcOps->AMask && ! DstOps->AMask && DstInfo->HasColorKey )
+	{
+	int pal,R,G,B,A;
+	uint32 Pixel;
+
+		// if Src format has alpha & Dst format doesn't, turn it into color key
 
-		if ( SrcInfo->HasColorKey && DstInfo->HasColorKey )
+		for(pal=0;pal<DstPal->Size;pal++)
 		{
-			if ( ! jeBitmap_Palette_SetEntry(DstPal,SrcInfo->ColorKey,DstInfo->ColorKey) )
+			jeBitmap_Palette_GetEntry(SrcPal,pal,&Pixel);
+			if ( SrcInfo->HasColorKey && Pixel == SrcInfo->ColorKey )
 			{
-				jeBitmap_Palette_Destroy(&DstPal);
-				return JE_FALSE;
+				A = 0;
 			}
+			else
+			{
+				jePixelFormat_DecomposePixel(SrcPal->Format,Pixel,&R,&G,&B,&A);
+			}
+			if ( A < ALPHA_TO_TRANSPARENCY_THRESHOLD )
+				jeBitmap_Palette_SetEntry(DstPal,pal,DstInfo->ColorKey);
 		}
+	}
 
-		if ( SrcOps->AMask && ! DstOps->AMask && DstInfo->HasColorKey )
-		{
-		int pal,R,G,B,A;
-		uint32 Pixel;
+return DstPal;
+}
 
-			// if Src format has alpha & Dst format doesn't, turn it into color key
+/*}{*********************************************************************/
 
-			for(pal=0;pal<DstPal->Size;pal++)
-			{
-				jeBitmap_Palette_GetEntry(SrcPal,pal,&Pixel);
-				if ( SrcInfo->HasColorKey && Pixel == SrcInfo->ColorKey )
-				{
-					A = 0;
-				}
-				else
-				{
-					jePixelFormat_DecomposePixel(SrcPal->Format,Pixel,&R,&G,&B,&A);
-				}
-				if ( A < ALPHA_TO_TRANSPARENCY_THRESHOLD )
-					jeBitmap_Palette_SetEntry(DstPal,pal,DstInfo->ColorKey);
-			}
+jeBoolean BlitData_DePalettize(void)
+{
+	// pal -> unpal : easy
+	if ( SrcFormat == JE_PIXELFORMAT_8BIT )
+	{
+	uint8 * SrcPtr;
+	jeBitmap_Palette * DstPal;
+	int x,y,pal;
+
+		x = y = pal = 0; //touch 'em
+
+		DstPal = jeBitmap_BlitData_DePalettizeTable(SrcInfo,SrcPal,DstInfo);
+		if ( ! DstPal )
+		{
+			return JE_FALSE;
 		}
 
 		SrcPtr = (uint8 *)SrcData;
@@ -1754,58 +1805,9 @@ jeBoolean BlitData_DePalettize(void)
 			}
 			case 4:
 			{
-			uint32 *DstPtr,*PalData;
-				PalData = (uint32 *)DstPal->Data;
-				DstPtr  = (uint32 *)DstData;
-				for(y=SizeY;y--;)
-				{
-					#ifdef DONT_USE_ASM
-
-					for(x=SizeX;x != 0; x--)
-					{
-						pal = *SrcPtr++;
-						*DstPtr++ = PalData[pal];
-					}
-
-					#else
-
-					assert( (((uint32)PalData)&3) == 0);
-					assert( (((uint32)DstPtr)&3) == 0);
-
-					__asm
-					{
-						push ebp
-
-						mov ecx,SizeX
-						mov esi,SrcPtr
-						mov edi,DstPtr
-						mov ebp,PalData
-
-						xor eax,eax
-						
-					moredata4:
-
-						mov al, BYTE PTR [esi]
-						mov edx, DWORD PTR [ebp + eax*4]
-						mov DWORD PTR [edi], edx
-
-						inc esi
-						add edi,4
-
-						dec ecx
-						jnz moredata4
-
-						pop ebp
-					}
-
-					SrcPtr += SizeX;
-					DstPtr += SizeX;
-
-					#endif
-
-					SrcPtr += SrcXtra;
-					DstPtr += DstXtra;
-				}
+				// the table lookup has an AVX2 gather path, see bitmap_convert.c
+				jeBitmap_Convert_Lookup32(	SrcPtr,SrcInfo->Stride,(const uint32 *)DstPal->Data,
+											(uint32 *)DstData,DstInfo->Stride * 4,SizeX,SizeY);
 				break;
 			}
 		}
@@ -32,4 +32,9 @@ extern jeBoolean jeBitmap_BlitData(
 								int SizeX,
 								int SizeY);
 
+	// the Pal -> Dst lookup table of BlitData_DePalettize; does not take the BlitData lock
+extern jeBitmap_Palette * jeBitmap_BlitData_DePalettizeTable(
+								const jeBitmap_Info * SrcInfo,const jeBitmap_Palette * SrcPal,
+								const jeBitmap_Info * DstInfo);
+
 #endif //BITMAP_BLITDATA_H
@@ -0,0 +1,621 @@
+/****************************************************************************************/
+/*  BITMAP_CONVERT.C                                                                    */
+/*                                                                                      */
+/*  Author: Styx3D Modernization                                                        */
+/*  Description: Pixel format conversion kernels for BlitData, with SSE2/AVX2 paths     */
+/*                                                                                      */
+/*  Every kernel works on the raw Src pixel (R<<16|G<<8|B for 24 bit) so the color key  */
+/*  compares stay exact, and packs it with the same shifts as the PixelFormat composers.*/
+/*  The SIMD paths do 4 (SSE2) or 8 (AVX2) pixels per step and finish rows in scalar.   */
+/*                                                                                      */
+/*  The contents of this file are subject to the 0BSD License.                          */
+/*  See LICENSE file in the project root for full license information.                  */
+/*                                                                                      */
+/****************************************************************************************/
+#include <assert.h>
+
+#include "bitmap_convert.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define JE_CONVERT_X86
+#endif
+
+#ifdef JE_CONVERT_X86
+	#include <immintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h>
+		#define JE_CONVERT_TARGET(Isa)
+	#else
+		#define JE_CONVERT_TARGET(Isa)		__attribute__((target(Isa)))
+	#endif
+#endif
+
+typedef enum
+{
+	JE_CONVERT_PACK_32,
+	JE_CONVERT_PACK_565,
+	JE_CONVERT_PACK_4444,
+	JE_CONVERT_PACK_1555
+} jeBitmap_ConvertPack;
+
+// Per call constants, with the keys turned into masks so the SIMD paths can select
+typedef struct jeBitmap_ConvertRow
+{
+	jeBitmap_ConvertPack	Pack;
+	uint32					SrcOr;			// 0xFF000000 when Src has no alpha but Dst does
+	jeBoolean				Fix;			// any of the key fixups below are on
+	uint32					SrcKeyMask, SrcKey, SrcRepl;
+	uint32					DstKeyMask, DstKey;
+	uint32					AlphaToKey;
+} jeBitmap_ConvertRow;
+
+typedef void (JETCF *jeBitmap_ConvertRowFunc)(const uint8 *Src, void *Dst, int32 Width, const jeBitmap_ConvertRow *Row);
+typedef void (JETCF *jeBitmap_ConvertLookupFunc)(const uint8 *Src, const uint32 *Table, uint32 *Dst, int32 Width);
+
+typedef struct jeBitmap_ConvertFuncs
+{
+	jeBitmap_ConvertRowFunc		Row24;		// 24 -> 32
+	jeBitmap_ConvertRowFunc		Row32;		// 32 -> 16
+	jeBitmap_ConvertLookupFunc	Lookup32;
+} jeBitmap_ConvertFuncs;
+
+//=====================================================================================
+//	Scalar, the reference.  Same results as BlitData_Raw with the PixelFormat ops.
+//=====================================================================================
+static uint32 jeBitmap_Convert_PackPixel(uint32 q, jeBitmap_ConvertPack Pack)
+{
+	switch (Pack)
+	{
+		case JE_CONVERT_PACK_565:
+			return ((q>>8)&0xF800) | ((q>>5)&0x7E0) | ((q>>3)&0x1F);
+		case JE_CONVERT_PACK_4444:
+			return ((q>>16)&0xF000) | ((q>>12)&0xF00) | ((q>>8)&0xF0) | ((q>>4)&0xF);
+		case JE_CONVERT_PACK_1555:
+			return ((q>>16)&0x8000) | ((q>>9)&0x7C00) | ((q>>6)&0x3E0) | ((q>>3)&0x1F);
+		default:
+			return q;
+	}
+}
+
+static uint32 jeBitmap_Convert_FixPixel(uint32 p, uint32 Out, const jeBitmap_ConvertRow *Row)
+{
+	if (Row->DstKeyMask && Out == Row->DstKey)
+		Out ^= 1;
+	if ((p>>24) < Row->AlphaToKey)
+		Out = Row->DstKey;
+	if (Row->SrcKeyMask && p == Row->SrcKey)
+		Out = Row->SrcRepl;
+
+	return Out;
+}
+
+static void JETCF jeBitmap_Convert_Row24Scalar(const uint8 *Src, void *Dst, int32 Width, const jeBitmap_ConvertRow *Row)
+{
+	uint32		*D = (uint32 *)Dst;
+	uint32		p, Out;
+	int32		x;
+
+	for (x=0; x<Width; x++, Src += 3)
+	{
+		p = ((uint32)Src[0]<<16) | ((uint32)Src[1]<<8) | (uint32)Src[2];
+		Out = p | Row->SrcOr;
+		if (Row->Fix)
+			Out = jeBitmap_Convert_FixPixel(p, Out, Row);
+		D[x] = Out;
+	}
+}
+
+static void JETCF jeBitmap_Convert_Row32Scalar(const uint8 *Src, void *Dst, int32 Width, const jeBitmap_ConvertRow *Row)
+{
+	const uint32	*S = (const uint32 *)Src;
+	uint16			*D = (uint16 *)Dst;
+	uint32			p, Out;
+	int32			x;
+
+	for (x=0; x<Width; x++)
+	{
+		p = S[x];
+		Out = jeBitmap_Convert_PackPixel(p | Row->SrcOr, Row->Pack);
+		if (Row->Fix)
+			Out = jeBitmap_Convert_FixPixel(p, Out, Row);
+		D[x] = (uint16)Out;
+	}
+}
+
+static void JETCF jeBitmap_Convert_Lookup32Scalar(const uint8 *Src, const uint32 *Table, uint32 *Dst, int32 Width)
+{
+	int32		x;
+
+	for (x=0; x<Width; x++)
+		Dst[x] = Table[Src[x]];
+}
+
+#ifdef JE_CONVERT_X86
+
+//=====================================================================================
+//	SSE2
+//=====================================================================================
+static void JETCF jeBitmap_Convert_Lookup32SSE2(const uint8 *Src, const uint32 *Table, uint32 *Dst, int32 Width)
+{
+	int32		x;
+
+	// No gather before AVX2, so this is just the scalar loop unrolled
+	for (x=0; x+4 <= Width; x+=4)
+	{
+		uint32	a = Table[Src[x]], b = Table[Src[x+1]], c = Table[Src[x+2]], d = Table[Src[x+3]];
+
+		Dst[x] = a;
+		Dst[x+1] = b;
+		Dst[x+2] = c;
+		Dst[x+3] = d;
+	}
+
+	jeBitmap_Convert_Lookup32Scalar(Src + x, Table, Dst + x, Width - x);
+}
+
+JE_CONVERT_TARGET("sse2")
+static __m128i jeBitmap_Convert_Pack4(__m128i q, jeBitmap_ConvertPack Pack)
+{
+	switch (Pack)
+	{
+		case JE_CONVERT_PACK_565:
+			return _mm_or_si128(_mm_or_si128(
+						_mm_and_si128(_mm_srli_epi32(q, 8), _mm_set1_epi32(0xF800)),
+						_mm_and_si128(_mm_srli_epi32(q, 5), _mm_set1_epi32(0x7E0))),
+						_mm_and_si128(_mm_srli_epi32(q, 3), _mm_set1_epi32(0x1F)));
+		case JE_CONVERT_PACK_4444:
+			return _mm_or_si128(_mm_or_si128(
+						_mm_and_si128(_mm_srli_epi32(q, 16), _mm_set1_epi32(0xF000)),
+						_mm_and_si128(_mm_srli_epi32(q, 12), _mm_set1_epi32(0xF00))),
+					_mm_or_si128(
+						_mm_and_si128(_mm_srli_epi32(q, 8), _mm_set1_epi32(0xF0)),
+						_mm_and_si128(_mm_srli_epi32(q, 4), _mm_set1_epi32(0xF))));
+		case JE_CONVERT_PACK_1555:
+			return _mm_or_si128(_mm_or_si128(
+						_mm_and_si128(_mm_srli_epi32(q, 16), _mm_set1_epi32(0x8000)),
+						_mm_and_si128(_mm_srli_epi32(q, 9), _mm_set1_epi32(0x7C00))),
+					_mm_or_si128(
+						_mm_and_si128(_mm_srli_epi32(q, 6), _mm_set1_epi32(0x3E0)),
+						_mm_and_si128(_mm_srli_epi32(q, 3), _mm_set1_epi32(0x1F))));
+		default:
+			return q;
+	}
+}
+
+// jeBitmap_Convert_FixPixel on 4 lanes
+JE_CONVERT_TARGET("sse2")
+static __m128i jeBitmap_Convert_Fix4(__m128i p, __m128i Out, const jeBitmap_ConvertRow *Row)
+{
+	__m128i		DstKey = _mm_set1_epi32((int)Row->DstKey);
+	__m128i		m;
+
+	m = _mm_and_si128(_mm_cmpeq_epi32(Out, DstKey), _mm_set1_epi32((int)Row->DstKeyMask));
+	Out = _mm_xor_si128(Out, _mm_and_si128(m, _mm_set1_epi32(1)));
+
+	m = _mm_cmplt_epi32(_mm_srli_epi32(p, 24), _mm_set1_epi32((int)Row->AlphaToKey));
+	Out = _mm_or_si128(_mm_andnot_si128(m, Out), _mm_and_si128(m, DstKey));
+
+	m = _mm_and_si128(_mm_cmpeq_epi32(p, _mm_set1_epi32((int)Row->SrcKey)), _mm_set1_epi32((int)Row->SrcKeyMask));
+	Out = _mm_or_si128(_mm_andnot_si128(m, Out), _mm_and_si128(m, _mm_set1_epi32((int)Row->SrcRepl)));
+
+	return Out;
+}
+
+JE_CONVERT_TARGET("sse2")
+static void JETCF jeBitmap_Convert_Row24SSE2(const uint8 *Src, void *Dst, int32 Width, const jeBitmap_ConvertRow *Row)
+{
+	uint32		*D = (uint32 *)Dst;
+	__m128i		SrcOr = _mm_set1_epi32((int)Row->SrcOr);
+	__m128i		ByteMask = _mm_set1_epi32(0xFF);
+	__m128i		v, p, Out;
+	int32		x;
+
+	// The 16 byte load reads 4 bytes past the 4 pixels, so stop 2 short of the end
+	for (x=0; x+6 <= Width; x+=4)
+	{
+		v = _mm_loadu_si128((const __m128i *)(Src + 3*x));
+
+		// No byte shuffle in SSE2 : line the 4 pixels up with byte shifts
+		p = _mm_unpacklo_epi64(	_mm_unpacklo_epi32(v, _mm_srli_si128(v, 3)),
+								_mm_unpacklo_epi32(_mm_srli_si128(v, 6), _mm_srli_si128(v, 9)));
+
+		// bytes R,G,B -> R<<16|G<<8|B
+		p = _mm_or_si128(_mm_or_si128(
+				_mm_slli_epi32(_mm_and_si128(p, ByteMask), 16),
+				_mm_and_si128(p, _mm_set1_epi32(0xFF00))),
+				_mm_and_si128(_mm_srli_epi32(p, 16), ByteMask));
+
+		Out = _mm_or_si128(p, SrcOr);
+		if (Row->Fix)
+			Out = jeBitmap_Convert_Fix4(p, Out, Row);
+
+		_mm_storeu_si128((__m128i *)(D + x), Out);
+	}
+
+	jeBitmap_Convert_Row24Scalar(Src + 3*x, D + x, Width - x, Row);
+}
+
+JE_CONVERT_TARGET("sse2")
+static void JETCF jeBitmap_Convert_Row32SSE2(const uint8 *Src, void *Dst, int32 Width, const jeBitmap_ConvertRow *Row)
+{
+	const uint32	*S = (const uint32 *)Src;
+	uint16			*D = (uint16 *)Dst;
+	__m128i			SrcOr = _mm_set1_epi32((int)Row->SrcOr);
+	__m128i			p0, p1, Out0, Out1;
+	int32			x;
+
+	for (x=0; x+8 <= Width; x+=8)
+	{
+		p0 = _mm_loadu_si128((const __m128i *)(S + x));
+		p1 = _mm_loadu_si128((const __m128i *)(S + x + 4));
+
+		Out0 = jeBitmap_Convert_Pack4(_mm_or_si128(p0, SrcOr), Row->Pack);
+		Out1 = jeBitmap_Convert_Pack4(_mm_or_si128(p1, SrcOr), Row->Pack);
+		if (Row->Fix)
+		{
+			Out0 = jeBitmap_Convert_Fix4(p0, Out0, Row);
+			Out1 = jeBitmap_Convert_Fix4(p1, Out1, Row);
+		}
+
+		// Sign extend the low halves so the saturating pack keeps them as they are
+		Out0 = _mm_srai_epi32(_mm_slli_epi32(Out0, 16), 16);
+		Out1 = _mm_srai_epi32(_mm_slli_epi32(Out1, 16), 16);
+
+		_mm_storeu_si128((__m128i *)(D + x), _mm_packs_epi32(Out0, Out1));
+	}
+
+	jeBitmap_Convert_Row32Scalar((const uint8 *)(S + x), D + x, Width - x, Row);
+}
+
+//=====================================================================================
+//	AVX2
+//=====================================================================================
+JE_CONVERT_TARGET("avx2")
+static __m256i jeBitmap_Convert_Pack8(__m256i q, jeBitmap_ConvertPack Pack)
+{
+	switch (Pack)
+	{
+		case JE_CONVERT_PACK_565:
+			return _mm256_or_si256(_mm256_or_si256(
+						_mm256_and_si256(_mm256_srli_epi32(q, 8), _mm256_set1_epi32(0xF800)),
+						_mm256_and_si256(_mm256_srli_epi32(q, 5), _mm256_set1_epi32(0x7E0))),
+						_mm256_and_si256(_mm256_srli_epi32(q, 3), _mm256_set1_epi32(0x1F)));
+		case JE_CONVERT_PACK_4444:
+			return _mm256_or_si256(_mm256_or_si256(
+						_mm256_and_si256(_mm256_srli_epi32(q, 16), _mm256_set1_epi32(0xF000)),
+						_mm256_and_si256(_mm256_srli_epi32(q, 12), _mm256_set1_epi32(0xF00))),
+					_mm256_or_si256(
+						_mm256_and_si256(_mm256_srli_epi32(q, 8), _mm256_set1_epi32(0xF0)),
+						_mm256_and_si256(_mm256_srli_epi32(q, 4), _mm256_set1_epi32(0xF))));
+		case JE_CONVERT_PACK_1555:
+			return _mm256_or_si256(_mm256_or_si256(
+						_mm256_and_si256(_mm256_srli_epi32(q, 16), _mm256_set1_epi32(0x8000)),
+						_mm256_and_si256(_mm256_srli_epi32(q, 9), _mm256_set1_epi32(0x7C00))),
+					_mm256_or_si256(
+						_mm256_and_si256(_mm256_srli_epi32(q, 6), _mm256_set1_epi32(0x3E0)),
+						_mm256_and_si256(_mm256_srli_epi32(q, 3), _mm256_set1_epi32(0x1F))));
+		default:
+			return q;
+	}
+}
+
+JE_CONVERT_TARGET("avx2")
+static __m256i jeBitmap_Convert_Fix8(__m256i p, __m256i Out, const jeBitmap_ConvertRow *Row)
+{
+	__m256i		DstKey = _mm256_set1_epi32((int)Row->DstKey);
+	__m256i		m;
+
+	m = _mm256_and_si256(_mm256_cmpeq_epi32(Out, DstKey), _mm256_set1_epi32((int)Row->DstKeyMask));
+	Out = _mm256_xor_si256(Out, _mm256_and_si256(m, _mm256_set1_epi32(1)));
+
+	m = _mm256_cmpgt_epi32(_mm256_set1_epi32((int)Row->AlphaToKey), _mm256_srli_epi32(p, 24));
+	Out = _mm256_blendv_epi8(Out, DstKey, m);
+
+	m = _mm256_and_si256(_mm256_cmpeq_epi32(p, _mm256_set1_epi32((int)Row->SrcKey)), _mm256_set1_epi32((int)Row->SrcKeyMask));
+	Out = _mm256_blendv_epi8(Out, _mm256_set1_epi32((int)Row->SrcRepl), m);
+
+	return Out;
+}
+
+JE_CONVERT_TARGET("avx2")
+static void JETCF jeBitmap_Convert_Row24AVX2(const uint8 *Src, void *Dst, int32 Width, const jeBitmap_ConvertRow *Row)
+{
+	uint32		*D = (uint32 *)Dst;
+	__m256i		SrcOr = _mm256_set1_epi32((int)Row->SrcOr);
+	// R,G,B of 4 pixels per lane -> B,G,R,0
+	__m256i		Shuffle = _mm256_setr_epi8(	2,1,0,-128, 5,4,3,-128, 8,7,6,-128, 11,10,9,-128,
+											2,1,0,-128, 5,4,3,-128, 8,7,6,-128, 11,10,9,-128);
+	__m256i		p, Out;
+	int32		x;
+
+	// The high lane loads 16 bytes from pixel x+4, so stop 2 short of the end
+	for (x=0; x+10 <= Width; x+=8)
+	{
+		p = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(Src + 3*x))),
+									_mm_loadu_si128((const __m128i *)(Src + 3*x + 12)), 1);
+		p = _mm256_shuffle_epi8(p, Shuffle);
+
+		Out = _mm256_or_si256(p, SrcOr);
+		if (Row->Fix)
+			Out = jeBitmap_Convert_Fix8(p, Out, Row);
+
+		_mm256_storeu_si256((__m256i *)(D + x), Out);
+	}
+
+	jeBitmap_Convert_Row24SSE2(Src + 3*x, D + x, Width - x, Row);
+}
+
+JE_CONVERT_TARGET("avx2")
+static void JETCF jeBitmap_Convert_Row32AVX2(const uint8 *Src, void *Dst, int32 Width, const jeBitmap_ConvertRow *Row)
+{
+	const uint32	*S = (const uint32 *)Src;
+	uint16			*D = (uint16 *)Dst;
+	__m256i			SrcOr = _mm256_set1_epi32((int)Row->SrcOr);
+	__m256i			p0, p1, Out0, Out1;
+	int32			x;
+
+	for (x=0; x+16 <= Width; x+=16)
+	{
+		p0 = _mm256_loadu_si256((const __m256i *)(S + x));
+		p1 = _mm256_loadu_si256((const __m256i *)(S + x + 8));
+
+		Out0 = jeBitmap_Convert_Pack8(_mm256_or_si256(p0, SrcOr), Row->Pack);
+		Out1 = jeBitmap_Convert_Pack8(_mm256_or_si256(p1, SrcOr), Row->Pack);
+		if (Row->Fix)
+		{
+			Out0 = jeBitmap_Convert_Fix8(p0, Out0, Row);
+			Out1 = jeBitmap_Convert_Fix8(p1, Out1, Row);
+		}
+
+		Out0 = _mm256_srai_epi32(_mm256_slli_epi32(Out0, 16), 16);
+		Out1 = _mm256_srai_epi32(_mm256_slli_epi32(Out1, 16), 16);
+
+		// The pack works per 128 bit lane, put the quarters back in order
+		_mm256_storeu_si256((__m256i *)(D + x), _mm256_permute4x64_epi64(_mm256_packs_epi32(Out0, Out1), 0xD8));
+	}
+
+	jeBitmap_Convert_Row32SSE2((const uint8 *)(S + x), D + x, Width - x, Row);
+}
+
+JE_CONVERT_TARGET("avx2")
+static void JETCF jeBitmap_Convert_Lookup32AVX2(const uint8 *Src, const uint32 *Table, uint32 *Dst, int32 Width)
+{
+	__m256i		Index;
+	int32		x;
+
+	for (x=0; x+8 <= Width; x+=8)
+	{
+		Index = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(Src + x)));
+		_mm256_storeu_si256((__m256i *)(Dst + x), _mm256_i32gather_epi32((const int *)Table, Index, 4));
+	}
+
+	jeBitmap_Convert_Lookup32Scalar(Src + x, Table, Dst + x, Width - x);
+}
+
+#endif // JE_CONVERT_X86
+
+//=====================================================================================
+//	Dispatch
+//=====================================================================================
+static const jeBitmap_ConvertFuncs	g_ConvertFuncs[JE_BITMAP_CONVERT_PATH_COUNT] =
+{
+	{ jeBitmap_Convert_Row24Scalar,	jeBitmap_Convert_Row32Scalar,	jeBitmap_Convert_Lookup32Scalar },
+#ifdef JE_CONVERT_X86
+	{ jeBitmap_Convert_Row24SSE2,	jeBitmap_Convert_Row32SSE2,		jeBitmap_Convert_Lookup32SSE2 },
+	{ jeBitmap_Convert_Row24AVX2,	jeBitmap_Convert_Row32AVX2,		jeBitmap_Convert_Lookup32AVX2 },
+#else
+	{ NULL, NULL, NULL },
+	{ NULL, NULL, NULL },
+#endif
+};
+
+static const char					*g_ConvertPathNames[JE_BITMAP_CONVERT_PATH_COUNT] = { "scalar", "sse2", "avx2" };
+
+static const jeBitmap_ConvertFuncs	*g_Convert = NULL;
+static jeBitmap_ConvertPath			g_ConvertPath = JE_BITMAP_CONVERT_PATH_SCALAR;
+
+static jeBoolean jeBitmap_Convert_Supported(jeBitmap_ConvertPath Path)
+{
+	if (Path == JE_BITMAP_CONVERT_PATH_SCALAR)
+		return JE_TRUE;
+
+#ifdef JE_CONVERT_X86
+	#ifdef _MSC_VER
+	{
+		int		Info[4];
+
+		__cpuid(Info, 0);
+		if (Info[0] < 1)
+			return JE_FALSE;
+
+		__cpuid(Info, 1);
+
+		if (Path == JE_BITMAP_CONVERT_PATH_SSE2)
+			return (Info[3] & (1<<26)) ? JE_TRUE : JE_FALSE;
+
+		// AVX2 needs the os to save the ymm registers too
+		if (!(Info[2] & (1<<27)) || !(Info[2] & (1<<28)))
+			return JE_FALSE;
+		if ((_xgetbv(0) & 6) != 6)
+			return JE_FALSE;
+
+		__cpuid(Info, 0);
+		if (Info[0] < 7)
+			return JE_FALSE;
+
+		__cpuidex(Info, 7, 0);
+		return (Info[1] & (1<<5)) ? JE_TRUE : JE_FALSE;
+	}
+	#else
+		__builtin_cpu_init();
+
+		if (Path == JE_BITMAP_CONVERT_PATH_SSE2)
+			return __builtin_cpu_supports("sse2") ? JE_TRUE : JE_FALSE;
+
+		return __builtin_cpu_supports("avx2") ? JE_TRUE : JE_FALSE;
+	#endif
+#else
+	return JE_FALSE;
+#endif
+}
+
+static const jeBitmap_ConvertFuncs *jeBitmap_Convert_GetFuncs(void)
+{
+	if (!g_Convert)
+	{
+		if (jeBitmap_Convert_Supported(JE_BITMAP_CONVERT_PATH_AVX2))
+			g_ConvertPath = JE_BITMAP_CONVERT_PATH_AVX2;
+		else if (jeBitmap_Convert_Supported(JE_BITMAP_CONVERT_PATH_SSE2))
+			g_ConvertPath = JE_BITMAP_CONVERT_PATH_SSE2;
+		else
+			g_ConvertPath = JE_BITMAP_CONVERT_PATH_SCALAR;
+
+		g_Convert = &g_ConvertFuncs[g_ConvertPath];
+	}
+
+	return g_Convert;
+}
+
+//=====================================================================================
+//	jeBitmap_Convert_GetPath
+//=====================================================================================
+jeBitmap_ConvertPath JETCF jeBitmap_Convert_GetPath(void)
+{
+	jeBitmap_Convert_GetFuncs();
+
+	return g_ConvertPath;
+}
+
+//=====================================================================================
+//	jeBitmap_Convert_SetPath
+//=====================================================================================
+jeBoolean JETCF jeBitmap_Convert_SetPath(jeBitmap_ConvertPath Path)
+{
+	if (Path < 0 || Path >= JE_BITMAP_CONVERT_PATH_COUNT)
+		return JE_FALSE;
+
+	if (!jeBitmap_Convert_Supported(Path))
+		return JE_FALSE;
+
+	g_ConvertPath = Path;
+	g_Convert = &g_ConvertFuncs[Path];
+
+	return JE_TRUE;
+}
+
+//=====================================================================================
+//	jeBitmap_Convert_GetPathName
+//=====================================================================================
+const char * JETCF jeBitmap_Convert_GetPathName(jeBitmap_ConvertPath Path)
+{
+	if (Path < 0 || Path >= JE_BITMAP_CONVERT_PATH_COUNT)
+		return "unknown";
+
+	return g_ConvertPathNames[Path];
+}
+
+//=====================================================================================
+//	jeBitmap_Convert_HasKernel
+//=====================================================================================
+jeBoolean JETCF jeBitmap_Convert_HasKernel(jePixelFormat SrcFormat, jePixelFormat DstFormat)
+{
+	switch (SrcFormat)
+	{
+		case JE_PIXELFORMAT_24BIT_RGB:
+			return (DstFormat == JE_PIXELFORMAT_32BIT_XRGB || DstFormat == JE_PIXELFORMAT_32BIT_ARGB) ? JE_TRUE : JE_FALSE;
+
+		case JE_PIXELFORMAT_32BIT_XRGB:
+		case JE_PIXELFORMAT_32BIT_ARGB:
+			return (DstFormat == JE_PIXELFORMAT_16BIT_565_RGB ||
+					DstFormat == JE_PIXELFORMAT_16BIT_4444_ARGB ||
+					DstFormat == JE_PIXELFORMAT_16BIT_1555_ARGB) ? JE_TRUE : JE_FALSE;
+
+		default:
+			return JE_FALSE;
+	}
+}
+
+//=====================================================================================
+//	jeBitmap_Convert_Rows
+//=====================================================================================
+jeBoolean JETCF jeBitmap_Convert_Rows(	jePixelFormat SrcFormat, const void *Src, int32 SrcStride,
+										jePixelFormat DstFormat, void *Dst, int32 DstStride,
+										int32 Width, int32 Height, const jeBitmap_ConvertKeys *Keys)
+{
+	const jeBitmap_ConvertFuncs		*Funcs;
+	jeBitmap_ConvertRowFunc			RowFunc;
+	jeBitmap_ConvertRow				Row;
+	const uint8						*S;
+	uint8							*D;
+
+	assert(Src && Dst);
+
+	if (!jeBitmap_Convert_HasKernel(SrcFormat, DstFormat))
+		return JE_FALSE;
+
+	Funcs = jeBitmap_Convert_GetFuncs();
+
+	switch (DstFormat)
+	{
+		case JE_PIXELFORMAT_16BIT_565_RGB:		Row.Pack = JE_CONVERT_PACK_565;		break;
+		case JE_PIXELFORMAT_16BIT_4444_ARGB:	Row.Pack = JE_CONVERT_PACK_4444;	break;
+		case JE_PIXELFORMAT_16BIT_1555_ARGB:	Row.Pack = JE_CONVERT_PACK_1555;	break;
+		default:								Row.Pack = JE_CONVERT_PACK_32;		break;
+	}
+
+	// Src without alpha reads as opaque, but only a Dst with alpha stores it
+	if (SrcFormat != JE_PIXELFORMAT_32BIT_ARGB && DstFormat != JE_PIXELFORMAT_32BIT_XRGB && DstFormat != JE_PIXELFORMAT_16BIT_565_RGB)
+		Row.SrcOr = 0xFF000000;
+	else
+		Row.SrcOr = 0;
+
+	Row.SrcKeyMask = Row.SrcKey = Row.SrcRepl = 0;
+	Row.DstKeyMask = Row.DstKey = 0;
+	Row.AlphaToKey = 0;
+
+	if (Keys)
+	{
+		Row.SrcKeyMask	= Keys->SrcHasKey ? 0xFFFFFFFF : 0;
+		Row.SrcKey		= Keys->SrcKey;
+		Row.DstKeyMask	= Keys->DstHasKey ? 0xFFFFFFFF : 0;
+		Row.DstKey		= Keys->DstKey;
+		Row.SrcRepl		= Keys->DstHasKey ? Keys->DstKey : 0;
+		Row.AlphaToKey	= Keys->AlphaToKey;
+	}
+
+	Row.Fix = (Row.SrcKeyMask || Row.DstKeyMask || Row.AlphaToKey) ? JE_TRUE : JE_FALSE;
+
+	RowFunc = (SrcFormat == JE_PIXELFORMAT_24BIT_RGB) ? Funcs->Row24 : Funcs->Row32;
+
+	S = (const uint8 *)Src;
+	D = (uint8 *)Dst;
+
+	for (; Height > 0; Height--)
+	{
+		RowFunc(S, D, Width, &Row);
+		S += SrcStride;
+		D += DstStride;
+	}
+
+	return JE_TRUE;
+}
+
+//=====================================================================================
+//	jeBitmap_Convert_Lookup32
+//=====================================================================================
+void JETCF jeBitmap_Convert_Lookup32(const uint8 *Src, int32 SrcStride, const uint32 *Table,
+									uint32 *Dst, int32 DstStride, int32 Width, int32 Height)
+{
+	jeBitmap_ConvertLookupFunc		Lookup;
+
+	assert(Src && Table && Dst);
+
+	Lookup = jeBitmap_Convert_GetFuncs()->Lookup32;
+
+	for (; Height > 0; Height--)
+	{
+		Lookup(Src, Table, Dst, Width);
+		Src += SrcStride;
+		Dst = (uint32 *)((uint8 *)Dst + DstStride);
+	}
+}
@@ -0,0 +1,74 @@
+/****************************************************************************************/
+/*  BITMAP_CONVERT.H                                                                    */
+/*                                                                                      */
+/*  Author: Styx3D Modernization                                                        */
+/*  Description: Pixel format conversion kernels for BlitData, with SSE2/AVX2 paths     */
+/*                                                                                      */
+/*  The contents of this file are subject to the 0BSD License.                          */
+/*  See LICENSE file in the project root for full license information.                  */
+/*                                                                                      */
+/****************************************************************************************/
+#ifndef BITMAP_CONVERT_H
+#define BITMAP_CONVERT_H
+
+#include "BaseType.h"
+#include "pixelformat.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum
+{
+	JE_BITMAP_CONVERT_PATH_SCALAR,
+	JE_BITMAP_CONVERT_PATH_SSE2,
+	JE_BITMAP_CONVERT_PATH_AVX2,
+	JE_BITMAP_CONVERT_PATH_COUNT
+} jeBitmap_ConvertPath;
+
+//--------
+//	The path is picked from the cpu on first use.  SetPath is for benchmarks and
+//	comparisons, and fails if the cpu (or the build) can't run the requested path.
+//--------
+jeBitmap_ConvertPath	JETCF jeBitmap_Convert_GetPath(void);
+jeBoolean				JETCF jeBitmap_Convert_SetPath(jeBitmap_ConvertPath Path);
+const char *			JETCF jeBitmap_Convert_GetPathName(jeBitmap_ConvertPath Path);
+
+//--------
+//	Color keys, handled the way BlitData_Raw does :
+//	 a Src pixel equal to SrcKey is written as DstKey (or 0 if Dst has no key),
+//	 a converted pixel that happens to equal DstKey gets its low bit flipped,
+//	 and if AlphaToKey is non-zero, Src alpha below it is written as DstKey.
+//--------
+typedef struct jeBitmap_ConvertKeys
+{
+	jeBoolean	SrcHasKey;
+	uint32		SrcKey;
+	jeBoolean	DstHasKey;
+	uint32		DstKey;
+	uint32		AlphaToKey;		// 0 or the alpha threshold
+} jeBitmap_ConvertKeys;
+
+//--------
+//	Kernels exist for 24BIT_RGB -> 32BIT_XRGB/32BIT_ARGB and for
+//	32BIT_XRGB/32BIT_ARGB -> 16BIT_565_RGB/16BIT_4444_ARGB/16BIT_1555_ARGB.
+//	Strides are in bytes; Rows returns JE_FALSE for a pair without a kernel.
+//	An XRGB destination gets its X byte written as zero.
+//--------
+jeBoolean	JETCF jeBitmap_Convert_HasKernel(jePixelFormat SrcFormat, jePixelFormat DstFormat);
+jeBoolean	JETCF jeBitmap_Convert_Rows(jePixelFormat SrcFormat, const void *Src, int32 SrcStride,
+										jePixelFormat DstFormat, void *Dst, int32 DstStride,
+										int32 Width, int32 Height, const jeBitmap_ConvertKeys *Keys);
+
+//--------
+//	Dst[x] = Table[Src[x]], the 8 bit palettized -> 32 bit loop of BlitData_DePalettize.
+//	Strides are in bytes.
+//--------
+void		JETCF jeBitmap_Convert_Lookup32(const uint8 *Src, int32 SrcStride, const uint32 *Table,
+											uint32 *Dst, int32 DstStride, int32 Width, int32 Height);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BITMAP_CONVERT_H
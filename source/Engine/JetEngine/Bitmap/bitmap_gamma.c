@@ -210,6 +210,50 @@ fail:
 return JE_FALSE;
 }
 
+jeBoolean jeBitmap_Gamma_ApplyPalette(jeFloat Gamma,jeBitmap_Palette * Pal)
+{
+jeBoolean Ret = JE_TRUE;
+jeBitmap_Info	PalInfo;
+void *	Bits;
+int		Size;
+jePixelFormat Format;
+
+	assert(Pal);
+
+	// same gates as _Apply
+
+	if ( Gamma <= 0.1f )
+		return JE_TRUE;
+
+	if ( fabs(Gamma - 1.0) < 0.1 )
+		return JE_TRUE;
+
+	assert(Bitmap_Gamma_Lock);
+	jeThreadQueue_Semaphore_Lock(Bitmap_Gamma_Lock);
+
+	if ( ComputedGamma_Lut != Gamma )
+	{
+		jeBitmap_Gamma_Compute_Lut(Gamma);
+	}
+
+	if ( ! jeBitmap_Palette_Lock(Pal,&Bits,&Format,&Size) )
+	{
+		jeThreadQueue_Semaphore_UnLock(Bitmap_Gamma_Lock);
+		return JE_FALSE;
+	}
+
+	jeBitmap_Palette_GetInfo(Pal,&PalInfo);
+
+	if ( ! jeBitmap_GammaCorrect_Data(Bits,&PalInfo,JE_FALSE) )
+		Ret = JE_FALSE;
+
+	jeBitmap_Palette_UnLock(Pal);
+
+	jeThreadQueue_Semaphore_UnLock(Bitmap_Gamma_Lock);
+
+return Ret;
+}
+
 /*}{*******************************************************/
 
 jeBoolean jeBitmap_GammaCorrect_Data(void * Bits,jeBitmap_Info * pInfo, jeBoolean Invert)
@@ -28,4 +28,8 @@ Intentional Error : bitmap_blidata only allowed in bitmap internals!
 
 extern jeBoolean jeBitmap_Gamma_Apply(jeBitmap * Bitmap,jeBoolean Invert);
 
+	// gamma corrects a lookup table (eg. from BlitData_DePalettizeTable) the way
+	//	_Apply would correct the driver bits it is used to write
+extern jeBoolean jeBitmap_Gamma_ApplyPalette(jeFloat Gamma,jeBitmap_Palette * Pal);
+
 #endif //BITMAP_GAMMA_H
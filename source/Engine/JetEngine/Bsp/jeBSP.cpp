@@ -21,6 +21,10 @@
 #include <stdio.h>
 #include <assert.h>
 
+#include <atomic>
+#include <unordered_set>
+#include <vector>
+
 #ifdef WIN32
 #include <windows.h>
 #endif
@@ -28,6 +32,11 @@
 #ifdef BUILD_BE
 #define min(a,b) (((a)<(b))?(a):(b))
 #endif
+
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+	#define JE_BSP_SSE2
+	#include <emmintrin.h>
+#endif
  
 // Private dependents
 #include "jeBSP._h"
@@ -38,6 +47,7 @@
 
 #include "math.h"
 #include "Camera._h"
+#include "jeParallel.h"
 
 // Public dependents
 #include "jeBSP.h"
@@ -49,11 +59,52 @@
 	#define JE_BSP_DEBUG_OUTPUT_LEVEL		0
 #endif
 
+// The tree build runs front/back subtrees and splitter scoring on the jeParallel pool.
+// Release only, the debug jeRam keeps its allocation tracking in unlocked lists.
+#ifdef NDEBUG
+	#define JE_BSP_PARALLEL_BUILD
+#endif
+
+#define JE_BSP_PARALLEL_MIN_BRUSHES		64			// Brush lists smaller than this are built by the current task
+#define JE_BSP_PARALLEL_MIN_WORK		(16*256)	// Below this many candidate*brush tests, splitters are scored serially
+
 //--- Local global statics
 static jeBSP_Logic			g_Logic;
 static jeBSP_LogicBalance	g_LogicBalance;		// (0..10), 0 = Less splits, 10 = Balanced tree
 static int32				NumNonVisNodes;
 
+// Shared by all tasks of one parallel jeBSP_BuildBSPTree.  NULL when building serially.
+typedef struct jeBSP_BuildContext
+{
+	jeParallel_Mutex		*Lock;				// Guards BSP->NodeArray, BSP->PlaneArray refs, BSP->DebugInfo and NumNonVisNodes
+} jeBSP_BuildContext;
+
+typedef struct jeBSP_BuildTask
+{
+	jeBSP					*BSP;
+	jeBSPNode				*Node;
+	jeBSP_Brush				**Brushes;
+	jeBSP_BuildContext		*Ctx;
+	jeBoolean				Result;
+} jeBSP_BuildTask;
+
+typedef struct jeBSP_SplitCandidate
+{
+	jeBSP_Side				*Side;
+	jePlaneArray_Index		Index;
+	int32					Value;
+	jeBoolean				Valid;				// JE_FALSE if the plane would produce a tiny volume
+	jeBoolean				NonConvex;
+} jeBSP_SplitCandidate;
+
+typedef struct jeBSP_SplitScoreInfo
+{
+	jeBSP					*BSP;
+	jeBSP_Brush				*Brushes;
+	jeBSPNode				*Node;
+	jeBSP_SplitCandidate	*Candidates;
+} jeBSP_SplitScoreInfo;
+
 // extern data for stats purpose - Krouer
 extern int32 NumMakeFaces;
 extern int32 NumMergedFaces;
@@ -68,11 +119,14 @@ static jeBoolean	jeBSP_BuildBSPTree(	jeBSP *BSPTree,
 										jeBSP_Brush **BrushList, 
 										jeBSP_Logic Logic, 
 										jeBSP_LogicBalance LogicBalance);
-static jeBoolean	jeBSP_BuildBSPTree_r(jeBSP *BSP, jeBSPNode *Node, jeBSP_Brush **Brushes);
+static jeBoolean	jeBSP_BuildBSPTree_r(jeBSP *BSP, jeBSPNode *Node, jeBSP_Brush **Brushes, jeBSP_BuildContext *Ctx);
+static void			jeBSP_BuildBSPTreeTask(void *Context);
 static jePlane_Side jeBSP_TestBrushToPlaneIndex(jeBSP *BSP, jeBSP_Brush *Brush, jePlaneArray_Index Index, int32 *NumSplits, 
 												jeBoolean *HintSplit, int32 *EpsilonBrush);
 
-static jeBSP_Side	*jeBSP_GetSplitter(jeBSP *BSP, jeBSP_Brush *Brushes, jeBSPNode *Node);
+static jeBSP_Side	*jeBSP_GetSplitter(jeBSP *BSP, jeBSP_Brush *Brushes, jeBSPNode *Node, jeBSP_BuildContext *Ctx);
+static jeBSP_Side	*jeBSP_GetSplitterParallel(jeBSP *BSP, jeBSP_Brush *Brushes, jeBSPNode *Node, jeBSP_BuildContext *Ctx);
+static void			jeBSP_ScoreSplitCandidate(int32 i, void *Context);
 static jeBoolean	jeBSP_CheckPlaneAgainstVolume(jeBSP *BSP, jePlaneArray_Index Index, jeBSPNode *Node);
 static jeBoolean	jeBSP_CheckPlaneAgainstParents(jePlaneArray_Index Index, jeBSPNode *Node);
 static jeBoolean	jeBSP_FillLeafsFromEntities(jeBSP *Tree, int32 Fill);
@@ -87,7 +141,7 @@ static void			jeBSP_MarkVisibleTopSides_r(jeBSP *BSP, jeBSPNode *Node);
 //#define COLOR_TO_FIXED(c)	((int32)(((c)*CSCALE)*(1<<LIGHT_FRACT)))
 #define COLOR_TO_FIXED(c)	((int32)((c)*(1<<LIGHT_FRACT)))
 
-static jeBoolean	CombineDLightWithRGBMapFastLightingModel(jeBSP *BSP, int32 *LightData, jeBSPNode_Light *Light, jeBSPNode_DrawFace *Face);
+static jeBoolean	CombineDLightsWithRGBMapFastLightingModel(jeBSP *BSP, int32 *LightData, uint32 LightMask, jeBSPNode_DrawFace *Face);
 static jeBoolean	CombineDLightWithRGBMap(jeBSP *BSP, int32 *LightData, jeBSPNode_Light *Light, jeBSPNode_DrawFace *Face);
 static void			AddLightType1(int32 *LightDest, uint8 *LightData, int32 Size, int32 Intensity);
 static void			AddLightType2(int32 *LightDest, uint8 *LightData, int32 Size, int32 Intensity);
@@ -106,6 +160,7 @@ static void			jeBSP_ResetObjects(jeBSP *BSP);
 static jeBoolean	jeBSP_ResetGeometry(jeBSP *BSP);
 static void			jeBSP_DestroyExternalArrays(jeBSP *BSP);
 static jeBoolean	jeBSP_CreateExternalArrays(jeBSP *BSP, jeFaceInfo_Array *FArray, jeMaterial_Array *MArray, jeChain *LChain, jeChain *DLChain);
+static void			jeBSP_VisContextDestroy(jeBSP_VisContext **Vis);
 
 static jeBoolean	jeBSP_OptimizeDrawFaceVerts(jeBSP *BSP);
 static jeBoolean	jeBSP_CreateVertexBuffer(jeBSP* BSP);
@@ -142,6 +197,11 @@ jeBSP *jeBSP_Create(void)
 	if (!jeBSP_CreateInternalArrays(BSPTree))
 		goto ExitWithError;
 
+	BSPTree->VisLock = jeParallel_MutexCreate();
+
+	if (!BSPTree->VisLock)
+		goto ExitWithError;
+
 	BSPTree->BSPObjectChain = jeChain_Create();
 
 	if (!BSPTree->BSPObjectChain)
@@ -165,6 +225,11 @@ jeBSP *jeBSP_Create(void)
 			if (BSPTree->BSPObjectChain)
 				jeChain_Destroy(&BSPTree->BSPObjectChain);
 
+			if (BSPTree->VisLock)
+				jeParallel_MutexDestroy(&BSPTree->VisLock);
+
+			jeBSP_DestroyInternalArrays(BSPTree);
+
 			jeRam_Free(BSPTree);
 		}
 
@@ -282,14 +347,10 @@ jeBSP *jeBSP_RebuildGeometry(	jeBSP				*BSP,
 		return NULL;
 
 // Krouer: put here the call to the Vertex buffer creation function
-	if (BSP->Driver) 
+	if (BSP->Driver && BSP->HWTransform) 
 	{
-		jeDeviceCaps devcaps;
-		BSP->Driver->GetDeviceCaps(&devcaps);
-		if ((devcaps.SuggestedDefaultRenderFlags & JE_RENDER_FLAG_HWTRANSFORM) == JE_RENDER_FLAG_HWTRANSFORM) {
-			if (!jeBSP_CreateVertexBuffer(BSP)) {
-				return NULL;
-			}
+		if (!jeBSP_CreateVertexBuffer(BSP)) {
+			return NULL;
 		}
 	}
 	return BSP;
@@ -363,6 +424,23 @@ void jeBSP_Destroy(jeBSP **BSPTree)
 		jeChain_Destroy(&(*BSPTree)->BSPObjectChain);
 	}
 
+	// Free the vis contexts (all of them must have been released by now)
+	while ((*BSPTree)->FreeVisContexts)
+	{
+		jeBSP_VisContext	*Vis;
+
+		Vis = (*BSPTree)->FreeVisContexts;
+		(*BSPTree)->FreeVisContexts = Vis->Next;
+
+		jeBSP_VisContextDestroy(&Vis);
+	}
+
+	if ((*BSPTree)->VisLock)
+		jeParallel_MutexDestroy(&(*BSPTree)->VisLock);
+
+	if ((*BSPTree)->LightBake)
+		jeBSPNode_LightBakeDestroy(&(*BSPTree)->LightBake);
+
 	// Free the bsp structure
 	jeRam_Free(*BSPTree);
 
@@ -585,6 +663,16 @@ jeBoolean jeBSP_MakeVisAreas(jeBSP *BSPTree)
 	if (!jeBSPNode_MakeAreas_r(BSPTree->RootNode, BSPTree, BSPTree->AreaChain))
 		return JE_FALSE;
 
+	// Number the areas, so vis contexts can keep their marks in a flat array
+	{
+		jeChain_Link	*Link;
+
+		BSPTree->NumVisAreas = 0;
+
+		for (Link = jeChain_GetFirstLink(BSPTree->AreaChain); Link; Link = jeChain_LinkGetNext(Link))
+			((jeBSPNode_Area*)jeChain_LinkGetLinkData(Link))->VisIndex = BSPTree->NumVisAreas++;
+	}
+
 	// First, count the portals on the areas
 	if (!jeBSPNode_CountAreaVisPortals_r(BSPTree->RootNode))
 		return JE_FALSE;
@@ -640,6 +728,8 @@ jeBoolean jeBSP_DestroyVisAreas(jeBSP *BSP)
 
 	jeChain_Destroy(&BSP->AreaChain);
 
+	BSP->NumVisAreas = 0;
+
 	return JE_TRUE;
 }
 
@@ -750,15 +840,194 @@ jeBoolean jeBSP_HasObject(jeBSP *BSP, jeObject *Object)
 //	Rendering/Vis
 //=======================================================================================
 
+//=======================================================================================
+//	jeBSP_VisIndexAlloc
+//	Never fails, when the free list is empty a new index is handed out
+//=======================================================================================
+int32 jeBSP_VisIndexAlloc(jeBSP_VisIndexPool *Pool)
+{
+	assert(Pool);
+
+	if (Pool->NumFree)
+		return Pool->Free[--Pool->NumFree];
+
+	return Pool->Count++;
+}
+
+//=======================================================================================
+//	jeBSP_VisIndexFree
+//=======================================================================================
+void jeBSP_VisIndexFree(jeBSP_VisIndexPool *Pool, int32 Index)
+{
+	assert(Pool);
+	assert(Index >= 0 && Index < Pool->Count);
+
+	if (Pool->NumFree == Pool->MaxFree)
+	{
+		int32		NewMax, *NewFree;
+
+		NewMax = Pool->MaxFree ? Pool->MaxFree*2 : 128;
+		NewFree = (int32*)jeRam_Realloc(Pool->Free, NewMax*sizeof(int32));
+
+		if (!NewFree)
+			return;		// The index is just never reused
+
+		Pool->Free = NewFree;
+		Pool->MaxFree = NewMax;
+	}
+
+	Pool->Free[Pool->NumFree++] = Index;
+}
+
+//=======================================================================================
+//	jeBSP_VisIndexPoolReset
+//=======================================================================================
+static void jeBSP_VisIndexPoolReset(jeBSP_VisIndexPool *Pool)
+{
+	if (Pool->Free)
+		jeRam_Free(Pool->Free);
+
+	memset(Pool, 0, sizeof(*Pool));
+}
+
+//=======================================================================================
+//	jeBSP_VisContextDestroy
+//=======================================================================================
+static void jeBSP_VisContextDestroy(jeBSP_VisContext **Vis)
+{
+	assert(Vis && *Vis);
+
+	if ((*Vis)->NodeMarks)
+		jeRam_Free((*Vis)->NodeMarks);
+	if ((*Vis)->FaceMarks)
+		jeRam_Free((*Vis)->FaceMarks);
+	if ((*Vis)->AreaMarks)
+		jeRam_Free((*Vis)->AreaMarks);
+
+	jeBSPNode_DrawFaceBatchFree(&(*Vis)->Batch);
+
+	jeRam_Free(*Vis);
+	*Vis = NULL;
+}
+
+//=======================================================================================
+//	jeBSP_VisContextAcquire
+//	Hands out a context from the BSP's free list, or creates one
+//=======================================================================================
+jeBSP_VisContext *jeBSP_VisContextAcquire(jeBSP *BSP)
+{
+	jeBSP_VisContext	*Vis;
+
+	assert(BSP);
+
+	jeParallel_MutexLock(BSP->VisLock);
+
+	Vis = BSP->FreeVisContexts;
+
+	if (Vis)
+		BSP->FreeVisContexts = Vis->Next;
+
+	jeParallel_MutexUnlock(BSP->VisLock);
+
+	if (!Vis)
+	{
+		Vis = JE_RAM_ALLOCATE_STRUCT(jeBSP_VisContext);
+
+		if (!Vis)
+			return NULL;
+
+		ZeroMem(Vis);
+	}
+
+	Vis->Next = NULL;
+
+	return Vis;
+}
+
+//=======================================================================================
+//	jeBSP_VisContextRelease
+//=======================================================================================
+void jeBSP_VisContextRelease(jeBSP *BSP, jeBSP_VisContext **Vis)
+{
+	assert(BSP);
+	assert(Vis && *Vis);
+
+	jeParallel_MutexLock(BSP->VisLock);
+
+	(*Vis)->Next = BSP->FreeVisContexts;
+	BSP->FreeVisContexts = *Vis;
+
+	jeParallel_MutexUnlock(BSP->VisLock);
+
+	*Vis = NULL;
+}
+
+//=======================================================================================
+//	jeBSP_VisContextGrowMarks
+//=======================================================================================
+static jeBoolean jeBSP_VisContextGrowMarks(uint32 **Marks, int32 *Max, int32 Needed)
+{
+	uint32		*NewMarks;
+	int32		NewMax;
+
+	if (Needed <= *Max)
+		return JE_TRUE;
+
+	NewMax = Needed + (Needed>>2) + 16;
+	NewMarks = (uint32*)jeRam_Realloc(*Marks, NewMax*sizeof(uint32));
+
+	if (!NewMarks)
+		return JE_FALSE;
+
+	memset(NewMarks + *Max, 0, (NewMax - *Max)*sizeof(uint32));
+
+	*Marks = NewMarks;
+	*Max = NewMax;
+
+	return JE_TRUE;
+}
+
+//=======================================================================================
+//	jeBSP_VisContextBegin
+//	Starts a new frame on Vis.  Bumping the stamp invalidates every old mark at once.
+//=======================================================================================
+static jeBoolean jeBSP_VisContextBegin(jeBSP *BSP, jeBSP_VisContext *Vis)
+{
+	if (!jeBSP_VisContextGrowMarks(&Vis->NodeMarks, &Vis->MaxNodes, BSP->NodeVisIndices.Count))
+		return JE_FALSE;
+	if (!jeBSP_VisContextGrowMarks(&Vis->FaceMarks, &Vis->MaxFaces, BSP->FaceVisIndices.Count))
+		return JE_FALSE;
+	if (!jeBSP_VisContextGrowMarks(&Vis->AreaMarks, &Vis->MaxAreas, BSP->NumVisAreas))
+		return JE_FALSE;
+
+	Vis->Stamp++;
+
+	if (Vis->Stamp == 0)
+	{
+		// Wrapped, so old marks could match again
+		memset(Vis->NodeMarks, 0, Vis->MaxNodes*sizeof(uint32));
+		memset(Vis->FaceMarks, 0, Vis->MaxFaces*sizeof(uint32));
+		memset(Vis->AreaMarks, 0, Vis->MaxAreas*sizeof(uint32));
+		Vis->Stamp = 1;
+	}
+
+	return JE_TRUE;
+}
+
 //=======================================================================================
 //	jeBSP_VisFrame
 //=======================================================================================
-jeBoolean jeBSP_VisFrame(jeBSP *BSPTree, const jeCamera *Camera, const jeFrustum *ModelSpaceFrustum)
+jeBoolean jeBSP_VisFrame(jeBSP *BSPTree, jeBSP_VisContext *Vis, const jeCamera *Camera, const jeFrustum *ModelSpaceFrustum)
 {
 	jeBSPNode_Area		*Area;
 	jeVec3d				POV;
 
 	assert(BSPTree);
+	assert(Vis);
+
+	// Always start a new frame, so nothing from the last one is left visible
+	if (!jeBSP_VisContextBegin(BSPTree, Vis))
+		return JE_FALSE;
 
 	if (!BSPTree->RootNode)
 		return JE_TRUE;
@@ -783,7 +1052,7 @@ jeBoolean jeBSP_VisFrame(jeBSP *BSPTree, const jeCamera *Camera, const jeFrustum
 
 	assert(BSPTree->AreaChain);
 
-	if (!jeBSPNode_AreaVisFlood_r(Area, &POV, ModelSpaceFrustum, (1<<BSPTree->RenderRecursion), Area))
+	if (!jeBSPNode_AreaVisFlood_r(Area, &POV, ModelSpaceFrustum, Vis, Area))
 	{
 	
 //		return JE_FALSE;
@@ -795,7 +1064,7 @@ jeBoolean jeBSP_VisFrame(jeBSP *BSPTree, const jeCamera *Camera, const jeFrustum
 //=======================================================================================
 //	jeBSP_RenderFrontToBack
 //=======================================================================================
-jeBoolean jeBSP_RenderFrontToBack(jeBSP *Tree, jeCamera *Camera, jeFrustum *CameraSpaceFrustum, jeFrustum *ModelSpaceFrustum, jeXForm3d *ModelToCameraXForm)
+jeBoolean jeBSP_RenderFrontToBack(jeBSP *Tree, jeBSP_VisContext *Vis, jeCamera *Camera, jeFrustum *CameraSpaceFrustum, jeFrustum *ModelSpaceFrustum, jeXForm3d *ModelToCameraXForm)
 {
 	uint32				ClipFlags;
 	jeBSPNode_SceneInfo	SceneInfo;
@@ -803,6 +1072,7 @@ jeBoolean jeBSP_RenderFrontToBack(jeBSP *Tree, jeCamera *Camera, jeFrustum *Came
 
 	assert(Tree);
 	assert(Tree->Engine);
+	assert(Vis);
 	assert(Camera);
 	assert(ModelSpaceFrustum);
 
@@ -831,14 +1101,16 @@ jeBoolean jeBSP_RenderFrontToBack(jeBSP *Tree, jeCamera *Camera, jeFrustum *Came
 
 	SceneInfo.Frustum = ModelSpaceFrustum;
 
-	if (Tree->AreaChain)
-		SceneInfo.RecursionBit = (1<<Tree->RenderRecursion);
-	else
-		SceneInfo.RecursionBit = 0;
+	// Without areas there is no vis, and everything gets drawn
+	SceneInfo.Vis = Tree->AreaChain ? Vis : NULL;
+	SceneInfo.Batch = &Vis->Batch;
 
 
 	jeEngine_GetDefaultRenderFlags(Tree->Engine, &SceneInfo.DefaultRenderFlags);
 
+	// Pick the face path once, instead of asking the driver for every face
+	SceneInfo.HWTransform = Tree->HWTransform;
+
 	// Setup clipflags
 	ClipFlags = (1<<ModelSpaceFrustum->NumPlanes)-1;
 
@@ -848,6 +1120,9 @@ jeBoolean jeBSP_RenderFrontToBack(jeBSP *Tree, jeCamera *Camera, jeFrustum *Came
 
 	jeBSPNode_RenderFrontToBack_r(Tree->RootNode, Tree, &SceneInfo, ClipFlags);
 
+	// Draw the unclipped faces the walk queued up
+	jeBSPNode_DrawFaceFlushBatch(Tree, &SceneInfo);
+
 	assert(Tree->RenderRecursion > 0);
 	Tree->RenderRecursion--;
 
@@ -862,16 +1137,12 @@ jeBoolean jeBSP_RenderFrontToBack(jeBSP *Tree, jeCamera *Camera, jeFrustum *Came
 
 			Area = (jeBSPNode_Area*)jeChain_LinkGetLinkData(Link);
 			
-			if (!(Area->RecursionBits & SceneInfo.RecursionBit))
+			if (!jeBSP_VisAreaIsMarked(Vis, Area))
 				continue;
 
 			// Krouer: I can render the area here
-			{
-				jeDeviceCaps devcaps;
-				Tree->Driver->GetDeviceCaps(&devcaps);
-				if ((devcaps.SuggestedDefaultRenderFlags & JE_RENDER_FLAG_HWTRANSFORM) == JE_RENDER_FLAG_HWTRANSFORM) {
-					jeBSPNode_AreaRenderVertexBuffer(Area, Tree);
-				}
+			if (SceneInfo.HWTransform) {
+				jeBSPNode_AreaRenderVertexBuffer(Area, Tree);
 			}
 
 			// The Area is visible, render all objects inside the area
@@ -896,9 +1167,6 @@ jeBoolean jeBSP_RenderFrontToBack(jeBSP *Tree, jeCamera *Camera, jeFrustum *Came
 						return JE_FALSE;
 				}
 			}
-
-			// Remove the vis recursion bit
-			Area->RecursionBits ^= SceneInfo.RecursionBit;
 		}
 	}
 	else		// Render every object, since there is no areas...
@@ -906,12 +1174,8 @@ jeBoolean jeBSP_RenderFrontToBack(jeBSP *Tree, jeCamera *Camera, jeFrustum *Came
 		jeChain_Link	*Link;
 
 		OutputDebugString("BSP: before render Objects - no AreaChain\n");
-		{
-			jeDeviceCaps devcaps;
-			Tree->Driver->GetDeviceCaps(&devcaps);
-			if ((devcaps.SuggestedDefaultRenderFlags & JE_RENDER_FLAG_HWTRANSFORM) == JE_RENDER_FLAG_HWTRANSFORM) {
-				jeBSP_RenderVertexBuffer(Tree);
-			}
+		if (SceneInfo.HWTransform) {
+			jeBSP_RenderVertexBuffer(Tree);
 		}
 
 		for (Link = jeChain_GetFirstLink(Tree->BSPObjectChain); Link; Link = jeChain_LinkGetNext(Link))
@@ -939,8 +1203,10 @@ jeBoolean jeBSP_RenderFrontToBack(jeBSP *Tree, jeCamera *Camera, jeFrustum *Came
 //=======================================================================================
 jeBoolean jeBSP_RenderAndVis(jeBSP *Tree, jeCamera *Camera, jeFrustum *Frustum)
 {
-	jeFrustum		ModelSpaceFrustum;
-	jeXForm3d		ModelToCameraXForm, CameraToModelXForm;
+	jeFrustum			ModelSpaceFrustum;
+	jeXForm3d			ModelToCameraXForm, CameraToModelXForm;
+	jeBSP_VisContext	*Vis;
+	jeBoolean			Ret;
 
 	Tree->DebugInfo.NumVisibleAreas = 0;
 
@@ -953,17 +1219,33 @@ jeBoolean jeBSP_RenderAndVis(jeBSP *Tree, jeCamera *Camera, jeFrustum *Frustum)
 	if (!jeBSP_UpdateAll(Tree))
 		return JE_FALSE;
 
-	if (!jeBSP_VisFrame(Tree, Camera, &ModelSpaceFrustum))
+	// Each call gets its own marks, so portal/mirror views rendered from inside this one can't disturb them
+	Vis = jeBSP_VisContextAcquire(Tree);
+
+	if (!Vis)
 		return JE_FALSE;
 
+	Ret = JE_FALSE;
+
+	if (!jeBSP_VisFrame(Tree, Vis, Camera, &ModelSpaceFrustum))
+		goto Done;
+
 	if (!UpdateDLights(Tree))
-		return JE_FALSE;
+		goto Done;
 
 	if (!UpdateObjects(Tree))
-		return JE_FALSE;
+		goto Done;
 
 	// Render the models BSP tree
-	if (!jeBSP_RenderFrontToBack(Tree, Camera, Frustum, &ModelSpaceFrustum, &ModelToCameraXForm))
+	if (!jeBSP_RenderFrontToBack(Tree, Vis, Camera, Frustum, &ModelSpaceFrustum, &ModelToCameraXForm))
+		goto Done;
+
+	Ret = JE_TRUE;
+
+	Done:
+	jeBSP_VisContextRelease(Tree, &Vis);
+
+	if (!Ret)
 		return JE_FALSE;
 
 #if 0
@@ -1014,8 +1296,22 @@ jeBoolean jeBSP_RenderAreas(jeBSP *Tree, jeCamera *Camera, jeFrustum *CameraSpac
 			return JE_FALSE;
 	}
 
-	if (! jeBSPNode_AreaRenderFlood_r(Area,Tree, Camera,Frustum, Tree->RenderRecursion ,NULL) )
-		return JE_FALSE;
+	{
+		jeBSP_VisContext	*Vis;
+		jeBoolean			Ret;
+
+		Vis = jeBSP_VisContextAcquire(Tree);
+
+		if (!Vis)
+			return JE_FALSE;
+
+		Ret = jeBSP_VisContextBegin(Tree, Vis) && jeBSPNode_AreaRenderFlood_r(Area,Tree, Camera,Frustum, Vis ,NULL);
+
+		jeBSP_VisContextRelease(Tree, &Vis);
+
+		if (!Ret)
+			return JE_FALSE;
+	}
 #endif
 
 	return JE_TRUE;
@@ -1182,10 +1478,17 @@ jeBoolean jeBSP_UpdateBrushFace(jeBSP *BSP, const jeBrush_Face *Face, jeBoolean
 //=======================================================================================
 jeBoolean jeBSP_PatchLighting(jeBSP *Tree)
 {
+	jeBSPNode_LightBake	*Bake;
+	jeBoolean			Ret;
+
 	if (!Tree->RootNode)
 		return JE_TRUE;
 
-	if (!jeBSPNode_LightPatch_r(Tree->RootNode, Tree, Tree->RootNode))
+	Bake = jeBSPNode_LightBakeBegin(Tree, Tree->RootNode);
+
+	Ret = (jeBSPNode_LightPatch_r(Tree->RootNode, Tree, Tree->RootNode, Bake) && jeBSPNode_LightBakeRun(Bake));
+
+	if (!Ret)
 		return JE_FALSE;
 
 	{
@@ -1210,10 +1513,17 @@ jeBoolean jeBSP_PatchLighting(jeBSP *Tree)
 //=======================================================================================
 jeBoolean jeBSP_RebuildLights(jeBSP *Tree)
 {
+	jeBSPNode_LightBake	*Bake;
+	jeBoolean			Ret;
+
 	if (!Tree->RootNode)
 		return JE_TRUE;
 
-	if (!jeBSPNode_LightUpdate_r(Tree->RootNode, Tree, Tree->RootNode, JE_TRUE))
+	Bake = jeBSPNode_LightBakeBegin(Tree, Tree->RootNode);
+
+	Ret = (jeBSPNode_LightUpdate_r(Tree->RootNode, Tree, Tree->RootNode, JE_TRUE, Bake) && jeBSPNode_LightBakeRun(Bake));
+
+	if (!Ret)
 		return JE_FALSE;
 
 	{
@@ -1238,14 +1548,20 @@ jeBoolean jeBSP_RebuildLights(jeBSP *Tree)
 //=======================================================================================
 jeBoolean jeBSP_RebuildLightsFromPoint(jeBSP *Tree, const jeVec3d *Pos, jeFloat Radius)
 {
-	jeVec3d		NewPos;
+	jeVec3d				NewPos;
+	jeBSPNode_LightBake	*Bake;
+	jeBoolean			Ret;
 
 	if (!Tree->RootNode)
 		return JE_TRUE;
 
 	jeXForm3d_Transform(&Tree->WorldToModelXForm, Pos, &NewPos);
 	
-	if (!jeBSPNode_LightUpdateFromPoint_r(Tree->RootNode, Tree, Tree->RootNode, &NewPos, Radius))
+	Bake = jeBSPNode_LightBakeBegin(Tree, Tree->RootNode);
+
+	Ret = (jeBSPNode_LightUpdateFromPoint_r(Tree->RootNode, Tree, Tree->RootNode, &NewPos, Radius, Bake) && jeBSPNode_LightBakeRun(Bake));
+
+	if (!Ret)
 		return JE_FALSE;
 
 	return JE_TRUE;
@@ -1279,30 +1595,29 @@ jeBoolean jeBSP_UpdateAll(jeBSP *BSP)
 
 		BSP->UpdateFlags &= ~BSP_UPDATE_FACES;
 
-		if (BSP->Driver) 
+		if (BSP->Driver && BSP->HWTransform) 
 		{
-			jeDeviceCaps devcaps;
-			BSP->Driver->GetDeviceCaps(&devcaps);
-			if ((devcaps.SuggestedDefaultRenderFlags & JE_RENDER_FLAG_HWTRANSFORM) == JE_RENDER_FLAG_HWTRANSFORM) {
-				jeBSP_CreateVertexBuffer(BSP);
-			}
+			jeBSP_CreateVertexBuffer(BSP);
 		}
 	}
 
 	if (BSP->UpdateFlags & BSP_UPDATE_LIGHTS)
 	{
-		if (!jeBSPNode_LightUpdate_r(BSP->RootNode, BSP, BSP->RootNode, JE_FALSE))
+		jeBSPNode_LightBake	*Bake;
+		jeBoolean			Ret;
+
+		Bake = jeBSPNode_LightBakeBegin(BSP, BSP->RootNode);
+
+		Ret = (jeBSPNode_LightUpdate_r(BSP->RootNode, BSP, BSP->RootNode, JE_FALSE, Bake) && jeBSPNode_LightBakeRun(Bake));
+
+		if (!Ret)
 			return JE_FALSE;
 
 		BSP->UpdateFlags &= ~BSP_UPDATE_LIGHTS;
 	}
 
-	{
-		jeDeviceCaps devcaps;
-		BSP->Driver->GetDeviceCaps(&devcaps);
-		if ((devcaps.SuggestedDefaultRenderFlags & JE_RENDER_FLAG_HWTRANSFORM) == JE_RENDER_FLAG_HWTRANSFORM && BSP->pVertexBuffer == NULL) {
-			jeBSP_CreateVertexBuffer(BSP);
-		}
+	if (BSP->Driver && BSP->HWTransform && BSP->pVertexBuffer == NULL) {
+		jeBSP_CreateVertexBuffer(BSP);
 	}
 
 #if (JE_BSP_DEBUG_OUTPUT_LEVEL >= 2)
@@ -1797,7 +2112,7 @@ const jeBSP_DebugInfo *jeBSP_GetDebugInfo(const jeBSP *BSPTree)
 static jeBoolean jeBSP_AddBSPBrush_r(jeBSP *BSP, jeBSPNode *Node, jeBSP_Brush **Brush)
 {
 	jeBSP_Brush		*Front, *Back, *Brush2;
-	int32			Splits,  EpsilonBrush;
+	int32			Splits,  EpsilonBrush, NumSplits;
 	int HintSplit;
 
 	assert(Node);
@@ -1866,7 +2181,7 @@ static jeBoolean jeBSP_AddBSPBrush_r(jeBSP *BSP, jeBSPNode *Node, jeBSP_Brush **
 		}
 
 		// Start from this list, and start building the tree from here to form the new leafs
-		if (!jeBSP_BuildBSPTree_r(BSP, Node, Brush))
+		if (!jeBSP_BuildBSPTree_r(BSP, Node, Brush, NULL))
 		{
 			jeErrorLog_AddString(-1, "jeBSP_AddBSPBrush_r:  jeBSPNode_PartitionPortals_r failed.", NULL);
 			return JE_FALSE;
@@ -1894,9 +2209,11 @@ static jeBoolean jeBSP_AddBSPBrush_r(jeBSP *BSP, jeBSPNode *Node, jeBSP_Brush **
 	// Set the brush side, jeBSP_BrushSplitListByNode uses it as a first test
 	Brush2->Side = jeBSP_TestBrushToPlaneIndex(BSP, Brush2, Node->PlaneIndex, &Splits, &HintSplit, &EpsilonBrush);
 
-	if (!jeBSPNode_SplitBrushList(Node, BSP, Brush2, &Front, &Back))
+	if (!jeBSPNode_SplitBrushList(Node, BSP, Brush2, &Front, &Back, &NumSplits))
 		return JE_FALSE;
 
+	BSP->DebugInfo.NumSplits += NumSplits;
+
 	jeBSP_BrushDestroy(Brush);		// Don't need this sucka anymore...
 
 	if (!jeBSP_AddBSPBrush_r(BSP, Node->Children[NODE_FRONT], &Front))
@@ -1997,8 +2314,8 @@ static jeBoolean jeBSP_AddBrushInternally(jeBSP *BSPTree, jeBrush *Brush, uint32
 }
 
 // FIXME: Remove!!!!
-extern int32	NumAirLeafs;
-extern int32	NumSolidLeafs;
+extern std::atomic<int32>	NumAirLeafs;
+extern std::atomic<int32>	NumSolidLeafs;
 
 //=======================================================================================
 //	jeBSP_BuildBSPTree
@@ -2008,11 +2325,13 @@ static jeBoolean jeBSP_BuildBSPTree(jeBSP *BSPTree,
 									jeBSP_Logic Logic, 
 									jeBSP_LogicBalance LogicBalance)
 {
-	jeBSP_Brush	*b;
-	int32		NumNonVisFaces;
-	int32		i;
-	jeFloat		Volume;
-	jeBoolean	Set;
+	jeBSP_Brush			*b;
+	int32				NumNonVisFaces;
+	int32				i;
+	jeFloat				Volume;
+	jeBoolean			Set;
+	jeBSP_BuildContext	Ctx, *pCtx;
+	jeBoolean			Ret;
 
 	assert(BSPTree->RootNode == NULL);
 
@@ -2081,7 +2400,22 @@ static jeBoolean jeBSP_BuildBSPTree(jeBSP *BSPTree,
 	else
 		BSPTree->RootNode->Volume = NULL;
 
-	if (!jeBSP_BuildBSPTree_r(BSPTree, BSPTree->RootNode, BrushList))
+	pCtx = NULL;
+
+#ifdef JE_BSP_PARALLEL_BUILD
+	if (jeParallel_GetNumThreads() > 1)
+	{
+		Ctx.Lock = jeParallel_MutexCreate();
+		pCtx = &Ctx;
+	}
+#endif
+
+	Ret = jeBSP_BuildBSPTree_r(BSPTree, BSPTree->RootNode, BrushList, pCtx);
+
+	if (pCtx)
+		jeParallel_MutexDestroy(&Ctx.Lock);
+
+	if (!Ret)
 		return JE_FALSE;
 
 	Log_Printf("Total Nodes            : %5i\n", BSPTree->DebugInfo.NumNodes);
@@ -2104,22 +2438,43 @@ static jeBoolean jeBSP_BuildBSPTree(jeBSP *BSPTree,
 	return JE_TRUE;
 }
 
+//=======================================================================================
+//	jeBSP_BuildLock / jeBSP_BuildUnlock
+//	Serialize access to the tree wide state while subtrees are built in parallel
+//=======================================================================================
+static void jeBSP_BuildLock(jeBSP_BuildContext *Ctx)
+{
+	if (Ctx)
+		jeParallel_MutexLock(Ctx->Lock);
+}
+
+static void jeBSP_BuildUnlock(jeBSP_BuildContext *Ctx)
+{
+	if (Ctx)
+		jeParallel_MutexUnlock(Ctx->Lock);
+}
+
 //=======================================================================================
 //	jeBSP_BuildBSPTree_r
+//	Ctx is NULL for a serial build.  The parallel build makes exactly the same tree, each
+//	subtree only depends on the brushes handed to it.
 //=======================================================================================
-static jeBoolean jeBSP_BuildBSPTree_r(jeBSP *BSP, jeBSPNode *Node, jeBSP_Brush **Brushes)
+static jeBoolean jeBSP_BuildBSPTree_r(jeBSP *BSP, jeBSPNode *Node, jeBSP_Brush **Brushes, jeBSP_BuildContext *Ctx)
 {
 	jeBSPNode	*NewNode;
 	jeBSP_Side	*BestSide;
-	int32		i;
+	int32		i, NumSplits;
 	jeBSP_Brush	*Children[2];
+	jeBoolean	Ref;
 
 	// find the best plane to use as a splitter
-	BestSide = jeBSP_GetSplitter(BSP, *Brushes, Node);
+	BestSide = jeBSP_GetSplitter(BSP, *Brushes, Node, Ctx);
 	
 	if (!BestSide)
 	{
+		jeBSP_BuildLock(Ctx);
 		BSP->DebugInfo.NumLeafs++;
+		jeBSP_BuildUnlock(Ctx);
 
 		if (!jeBSPNode_InitializeLeaf(Node, BSP, *Brushes))
 			return JE_FALSE;
@@ -2133,19 +2488,25 @@ static jeBoolean jeBSP_BuildBSPTree_r(jeBSP *BSP, jeBSPNode *Node, jeBSP_Brush *
 		return JE_TRUE;
 	}
 
-	BSP->DebugInfo.NumNodes++;
-
 	// This is a splitplane node
 	Node->Side = BestSide;
 	// Nodes are ALWAYS positive facing
 	Node->PlaneIndex = jePlaneArray_IndexGetPositive(BestSide->PlaneIndex);
 
+	jeBSP_BuildLock(Ctx);
+
+	BSP->DebugInfo.NumNodes++;
+
 	// Ref the plane
-	if (!jePlaneArray_RefPlaneByIndex(BSP->PlaneArray, Node->PlaneIndex))
+	Ref = jePlaneArray_RefPlaneByIndex(BSP->PlaneArray, Node->PlaneIndex);
+
+	jeBSP_BuildUnlock(Ctx);
+
+	if (!Ref)
 		return JE_FALSE;
 
 	// Split the brushes on this node
-	if (!jeBSPNode_SplitBrushList(Node, BSP, *Brushes, &Children[0], &Children[1]))
+	if (!jeBSPNode_SplitBrushList(Node, BSP, *Brushes, &Children[0], &Children[1], &NumSplits))
    {
 		return JE_FALSE;
    }
@@ -2156,17 +2517,27 @@ static jeBoolean jeBSP_BuildBSPTree_r(jeBSP *BSP, jeBSPNode *Node, jeBSP_Brush *
    // Set pointer to zero
    Node->Children[0] = NULL;
    Node->Children[1] = NULL;
+
+	jeBSP_BuildLock(Ctx);
+
+	BSP->DebugInfo.NumSplits += NumSplits;
+
 	// Allocate children before recursing
 	for (i=0 ; i<2 ; i++)
 	{
 		NewNode = jeBSPNode_Create(BSP);
 
 		if (!NewNode)
+		{
+			jeBSP_BuildUnlock(Ctx);
 			goto ExitError;
+		}
 
 		NewNode->Parent = Node;				// And a child is born...
 		Node->Children[i] = NewNode;
 	}
+
+	jeBSP_BuildUnlock(Ctx);
 	
 	if (Node->Volume)
 	{
@@ -2182,26 +2553,68 @@ static jeBoolean jeBSP_BuildBSPTree_r(jeBSP *BSP, jeBSPNode *Node, jeBSP_Brush *
 	}
 
 	// Recursively process children
-	for (i=0 ; i<2 ; i++)
+	if (Ctx && jeBSP_BrushCountList(Children[0]) >= JE_BSP_PARALLEL_MIN_BRUSHES && 
+			jeBSP_BrushCountList(Children[1]) >= JE_BSP_PARALLEL_MIN_BRUSHES)
 	{
-      if (!jeBSP_BuildBSPTree_r(BSP, Node->Children[i], &Children[i]))
-      {
+		jeParallel_Group	*Group;
+		jeBSP_BuildTask		FrontTask;
+		jeBoolean			BackResult;
+
+		// Front goes to the pool, back is built on this task
+		FrontTask.BSP = BSP;
+		FrontTask.Node = Node->Children[0];
+		FrontTask.Brushes = &Children[0];
+		FrontTask.Ctx = Ctx;
+		FrontTask.Result = JE_FALSE;
+
+		Group = jeParallel_GroupCreate();
+
+		jeParallel_GroupRun(Group, jeBSP_BuildBSPTreeTask, &FrontTask);
+		BackResult = jeBSP_BuildBSPTree_r(BSP, Node->Children[1], &Children[1], Ctx);
+
+		jeParallel_GroupDestroy(&Group);		// Waits on the front
+
+		if (!FrontTask.Result || !BackResult)
 			goto ExitError;
-      }
+	}
+	else
+	{
+		for (i=0 ; i<2 ; i++)
+		{
+		  if (!jeBSP_BuildBSPTree_r(BSP, Node->Children[i], &Children[i], Ctx))
+		  {
+				goto ExitError;
+		  }
+		}
 	}
 
 	return JE_TRUE;
 
 ExitError:
+	jeBSP_BuildLock(Ctx);
+
 	for (i=0 ; i<2 ; i++)
 	{
       if (Node->Children[i]) {
          jeBSPNode_Destroy_r(&Node->Children[i], BSP);
       }
    }
+
+	jeBSP_BuildUnlock(Ctx);
+
    return JE_FALSE;
 }
 
+//=======================================================================================
+//	jeBSP_BuildBSPTreeTask
+//=======================================================================================
+static void jeBSP_BuildBSPTreeTask(void *Context)
+{
+	jeBSP_BuildTask		*Task = (jeBSP_BuildTask*)Context;
+
+	Task->Result = jeBSP_BuildBSPTree_r(Task->BSP, Task->Node, Task->Brushes, Task->Ctx);
+}
+
 //=======================================================================================
 //	jeBSP_TestBrushToPlaneIndex
 //=======================================================================================
@@ -2375,7 +2788,7 @@ static jeBoolean jeBSP_CheckPlaneAgainstVolume(jeBSP *BSP, jePlaneArray_Index In
 //=======================================================================================
 //	jeBSP_GetSplitter
 //=======================================================================================
-static jeBSP_Side *jeBSP_GetSplitter(jeBSP *BSP, jeBSP_Brush *Brushes, jeBSPNode *Node)
+static jeBSP_Side *jeBSP_GetSplitter(jeBSP *BSP, jeBSP_Brush *Brushes, jeBSPNode *Node, jeBSP_BuildContext *Ctx)
 {
 	int32			Value, BestValue;
 	jeBSP_Brush		*Brush, *Test;
@@ -2391,6 +2804,10 @@ static jeBSP_Side *jeBSP_GetSplitter(jeBSP *BSP, jeBSP_Brush *Brushes, jeBSPNode
 	if (!Brushes)
 		return NULL;
 
+	// Lazy mode takes the first brush with a usable side, so there is nothing to spread out
+	if (Ctx && g_Logic != Logic_Lazy)
+		return jeBSP_GetSplitterParallel(BSP, Brushes, Node, Ctx);
+
 	BestSide	= NULL;
 	BestValue	= -999999;
 	BestSplits	= 0;
@@ -2529,7 +2946,9 @@ static jeBSP_Side *jeBSP_GetSplitter(jeBSP *BSP, jeBSP_Brush *Brushes, jeBSPNode
 			if (Pass > 1)
 			{
 				//BSP->DebugInfo.NumNodes--;
+				jeBSP_BuildLock(Ctx);
 				NumNonVisNodes++;
+				jeBSP_BuildUnlock(Ctx);
 			}
 			
 			if (Pass > 0)						// The node is not visible, or detail, so just mark it detail...
@@ -2549,6 +2968,225 @@ static jeBSP_Side *jeBSP_GetSplitter(jeBSP *BSP, jeBSP_Brush *Brushes, jeBSPNode
 	return BestSide;
 }
 
+//=======================================================================================
+//	jeBSP_ScoreSplitCandidate
+//	The scoring half of jeBSP_GetSplitter for one candidate.  Only reads the brushes, so
+//	all the candidates of a pass can be scored at once.
+//=======================================================================================
+static void jeBSP_ScoreSplitCandidate(int32 i, void *Context)
+{
+	jeBSP_SplitScoreInfo	*Info;
+	jeBSP_SplitCandidate	*Candidate;
+	jeBSP_Brush				*Test;
+	const jePlane			*pPlane;
+	jePlane_Side			s;
+	int32					Front, Back, Facing, Splits, BSplits, EpsilonBrush;
+	int32					Value;
+	jeBoolean				HintSplit;
+
+	Info = (jeBSP_SplitScoreInfo*)Context;
+	Candidate = &Info->Candidates[i];
+
+	Candidate->Valid = JE_FALSE;
+	Candidate->NonConvex = JE_FALSE;
+
+	if (Info->Node->Volume)
+	{
+		assert(g_Logic >= Logic_Smart);
+
+		if (!jeBSP_CheckPlaneAgainstVolume(Info->BSP, Candidate->Index, Info->Node))
+			return;	// Would produce a tiny volume
+	}
+
+	Front = 0;
+	Back = 0;
+	Facing = 0;
+	Splits = 0;
+	EpsilonBrush = 0;
+	HintSplit = JE_FALSE;
+
+	for (Test = Info->Brushes ; Test ; Test=Test->Next)
+	{
+		s = jeBSP_TestBrushToPlaneIndex(Info->BSP, Test, Candidate->Index, &BSplits, &HintSplit, &EpsilonBrush);
+
+		Splits += BSplits;
+
+		if (BSplits && (s&PSIDE_FACING) )
+		{
+			Candidate->NonConvex = JE_TRUE;
+			break;
+		}
+
+		if (s & PSIDE_FACING)
+			Facing++;
+		if (s & PSIDE_FRONT)
+			Front++;
+		if (s & PSIDE_BACK)
+			Back++;
+	}
+
+	// Same estimate as jeBSP_GetSplitter.  Note HintSplit is what the last brush reported.
+	Value = 10*Facing - ((10-g_LogicBalance)*Splits) - (g_LogicBalance*abs(Front-Back));
+
+	pPlane = jePlaneArray_GetPlaneByIndex(Info->BSP->PlaneArray, Candidate->Index);
+
+	if (pPlane->Type < 3)
+		Value+=10;
+
+	Value -= EpsilonBrush*1000;
+
+	if (HintSplit && !(Candidate->Side->Flags & SIDE_HINT) )
+		Value = -999999;
+
+	Candidate->Value = Value;
+	Candidate->Valid = JE_TRUE;
+}
+
+//=======================================================================================
+//	jeBSP_GetSplitterParallel
+//	Picks the same side as jeBSP_GetSplitter.  The serial version skips any side whose
+//	plane was already tested (SIDE_TESTED), so each plane is a candidate once, at its
+//	first side in pass/brush/side order.  The candidates are scored in parallel, then
+//	picked in that order with the same strict compare, so ties resolve the same way.
+//=======================================================================================
+static jeBSP_Side *jeBSP_GetSplitterParallel(jeBSP *BSP, jeBSP_Brush *Brushes, jeBSPNode *Node, jeBSP_BuildContext *Ctx)
+{
+	std::vector<jeBSP_SplitCandidate>		Candidates;
+	std::unordered_set<jePlaneArray_Index>	Tested;
+	jeBSP_SplitScoreInfo					Info;
+	jeBSP_Brush								*Brush, *Test;
+	jeBSP_Side								*Side, *BestSide;
+	jePlaneArray_Index						BestIndex;
+	int32									BestValue, NumBrushes, NumCandidates;
+	int32									i, Pass, NumPasses;
+
+	BestSide	= NULL;
+	BestValue	= -999999;
+	BestIndex	= JE_PLANEARRAY_NULL_INDEX;
+
+	NumBrushes = jeBSP_BrushCountList(Brushes);
+
+	Info.BSP = BSP;
+	Info.Brushes = Brushes;
+	Info.Node = Node;
+
+	NumPasses = 4;
+	for (Pass = 0 ; Pass < NumPasses ; Pass++)
+	{
+		Candidates.clear();
+
+		for (Brush = Brushes ; Brush ; Brush=Brush->Next)
+		{
+		#ifdef USE_DETAIL
+			if ( (Pass & 1) && !(Brush->Original->Contents & JE_BSP_CONTENTS_DETAIL))
+				continue;
+			if ( !(Pass & 1) && (Brush->Original->Contents & JE_BSP_CONTENTS_DETAIL))
+				continue;
+		#endif
+			
+			for (i=0 ; i<Brush->NumSides ; i++)
+			{
+				jeBSP_SplitCandidate	Candidate;
+
+				Side = &Brush->Sides[i];
+				
+				if (!Side->Poly)
+					continue;
+				if (Side->Flags & (SIDE_NODE|SIDE_TESTED|SIDE_SPLIT))
+					continue;
+				if (Side->Flags & SIDE_SKIP)
+					continue;
+				if (!(Side->Flags & SIDE_VISIBLE) && Pass<2)
+					continue;
+
+				Candidate.Side = Side;
+				Candidate.Index = jePlaneArray_IndexGetPositive(Side->PlaneIndex);
+
+				assert(jeBSP_CheckPlaneAgainstParents(Candidate.Index, Node) == JE_TRUE);
+
+				// Only the first side on a plane is tried.  A plane that fails the volume
+				// test fails it for every side, so dropping the repeats is safe too.
+				if (!Tested.insert(Candidate.Index).second)
+					continue;
+
+				Candidates.push_back(Candidate);
+			}
+		}
+
+		NumCandidates = (int32)Candidates.size();
+
+		if (!NumCandidates)
+			continue;
+
+		Info.Candidates = &Candidates[0];
+
+		if (NumCandidates*NumBrushes >= JE_BSP_PARALLEL_MIN_WORK)
+			jeParallel_For(NumCandidates, jeBSP_ScoreSplitCandidate, &Info);
+		else
+		{
+			for (i=0; i<NumCandidates; i++)
+				jeBSP_ScoreSplitCandidate(i, &Info);
+		}
+
+		for (i=0; i<NumCandidates; i++)
+		{
+			if (!Candidates[i].Valid)
+				continue;
+
+			if (Candidates[i].NonConvex)
+			{
+				jeErrorLog_AddString(-1, "jeBSP_GetSplitter:  Brush non-convex.", NULL);
+				return NULL;
+			}
+
+			if (Candidates[i].Value > BestValue)
+			{
+				BestValue = Candidates[i].Value;
+				BestSide = Candidates[i].Side;
+				BestIndex = Candidates[i].Index;
+			}
+		}
+
+		// Bail out now, if we found a good side
+		if (BestSide)
+		{
+			if (Pass > 1)
+			{
+				jeBSP_BuildLock(Ctx);
+				NumNonVisNodes++;
+				jeBSP_BuildUnlock(Ctx);
+			}
+			
+			if (Pass > 0)						// The node is not visible, or detail, so just mark it detail...
+				Node->Flags |= NODE_DETAIL;	
+			
+			break;
+		}
+	}
+
+	// Save off the side test for the winner, jeBSPNode_SplitBrushList uses it
+	if (BestSide)
+	{
+		for (Test = Brushes ; Test ; Test=Test->Next)
+		{
+			int32		BSplits, EpsilonBrush = 0;
+			jeBoolean	HintSplit;
+
+			Test->TestSide = jeBSP_TestBrushToPlaneIndex(BSP, Test, BestIndex, &BSplits, &HintSplit, &EpsilonBrush);
+			Test->Side = Test->TestSide;
+		}
+	}
+
+	// Clear any tested flags the brushes came in with, as jeBSP_GetSplitter does
+	for (Brush = Brushes ; Brush ; Brush=Brush->Next)
+	{
+		for (i=0, Side = Brush->Sides ; i<Brush->NumSides ; i++, Side++)
+			Side->Flags &= ~SIDE_TESTED;
+	}
+
+	return BestSide;
+}
+
 //=====================================================================================
 //	jeBSP_FillLeafsFromEntities
 //=====================================================================================
@@ -2736,23 +3374,28 @@ static void jeBSP_DestroyAllPortals(jeBSP *Tree)
 //=====================================================================================
 
 //=====================================================================================
-//	CombineDLightWithRGBMapFastLightingModel
+//	Fast lighting model
+//	Each light is projected onto the lightmap plane and falls off linearly with an
+//	octagonal 2d distance.  All the lights on a face are summed in one pass over the
+//	lightmap, so each texel is loaded and stored once however many lights touch it.
 //=====================================================================================
-static jeBoolean CombineDLightWithRGBMapFastLightingModel(jeBSP *BSP, int32 *LightData, jeBSPNode_Light *Light, jeBSPNode_DrawFace *Face)
+typedef struct
+{
+	int32		Sx, Sy;				// Projected light position (1:21:10 fixed), relative to the lightmap
+	int32		Radius2;			// Radius left after projecting onto the plane
+	int32		R, G, B;
+} jeBSP_FastDLight;
+
+//=====================================================================================
+//	SetupFastDLight
+//	Returns JE_FALSE if the light can't reach the face's plane
+//=====================================================================================
+static jeBoolean SetupFastDLight(jeBSP *BSP, const jeBSPNode_Light *Light, const jeBSPNode_DrawFace *Face, jeBSP_FastDLight *Fast)
 {
-	jeBoolean			Hit;
 	jeFloat				Radius, Dist;
 	const jePlane		*pPlane;
 	const jeTexVec		*pTexVec;
-	int32				Sx, Sy, x, y, u, v, Val;
-	int32				ColorR, ColorG, ColorB, Radius2, Dist2;
-	int32				FixedX, FixedY, XStep, YStep;
 	jeBSPNode_Lightmap	*Lightmap;
-	
-	assert(LightData);
-	assert(Light);
-	assert(Face);
-	assert(Face->Lightmap);
 
 	Lightmap = Face->Lightmap;
 
@@ -2772,68 +3415,221 @@ static jeBoolean CombineDLightWithRGBMapFastLightingModel(jeBSP *BSP, int32 *Lig
 		return JE_FALSE;
 
 	// Calculate where light is projected onto the 2d-plane
-	Sx = (int32)(jeVec3d_DotProduct(&Light->Pos, &pTexVec->VecU));
-	Sy = (int32)(jeVec3d_DotProduct(&Light->Pos, &pTexVec->VecV));
+	Fast->Sx = (int32)(jeVec3d_DotProduct(&Light->Pos, &pTexVec->VecU));
+	Fast->Sy = (int32)(jeVec3d_DotProduct(&Light->Pos, &pTexVec->VecV));
 
 	// Align with upper-left of lightmap in 2d space
-	Sx -= (int32)(Lightmap->StartU+Face->FixShiftU);
-	Sy -= (int32)(Lightmap->StartV+Face->FixShiftV);
+	Fast->Sx -= (int32)(Lightmap->StartU+Face->FixShiftU);
+	Fast->Sy -= (int32)(Lightmap->StartV+Face->FixShiftV);
 
 	// Scale by the texture scaling (1:21:10 fixed)
-	Sx *= Lightmap->XScale;
-	Sy *= Lightmap->YScale;
+	Fast->Sx *= Lightmap->XScale;
+	Fast->Sy *= Lightmap->YScale;
 
-	Hit = JE_FALSE;
+	Fast->Radius2 = (int32)Radius;
+
+	Fast->R = Light->R;
+	Fast->G = Light->G;
+	Fast->B = Light->B;
+
+	return JE_TRUE;
+}
+
+//=====================================================================================
+//	AddFastDLightTexel
+//=====================================================================================
+static jeBoolean AddFastDLightTexel(const jeBSP_FastDLight *Fast, int32 x, int32 y, int32 *LightData)
+{
+	int32		Dist2, Val;
+
+	if (x<0)
+		x = -x;
+
+	if (x > y)
+		Dist2 = (x + (y>>1));
+	else
+		Dist2 = (y + (x>>1));
 	
-	ColorR = Light->R;
-	ColorG = Light->G;
-	ColorB = Light->B;
+	if (Dist2 >= Fast->Radius2)
+		return JE_FALSE;
+
+	Val = (Fast->Radius2 - Dist2);
+
+	LightData[0] += (int32)(Val * Fast->R);
+	LightData[1] += (int32)(Val * Fast->G);
+	LightData[2] += (int32)(Val * Fast->B);
+
+	return JE_TRUE;
+}
+
+#ifdef JE_BSP_SSE2
+//=====================================================================================
+//	AddFastDLightQuad
+//	Four texels of one row for one light; adds into the three interleaved RGB vectors.
+//	The multiplies use _mm_madd_epi16, so Val and the colors must fit in 16 bits
+//	(checked in CombineDLightsWithRGBMapFastLightingModel).
+//=====================================================================================
+static inline __m128i AddFastDLightQuad(const jeBSP_FastDLight *Fast, __m128i FixedX, __m128i y, __m128i *RGB)
+{
+	__m128i		x, Sign, Greater, Max, Min, Dist2, Lit, Val, Radius2, Color;
+
+	Radius2 = _mm_set1_epi32(Fast->Radius2);
+
+	x = _mm_srai_epi32(FixedX, 10);
+	Sign = _mm_srai_epi32(x, 31);
+	x = _mm_sub_epi32(_mm_xor_si128(x, Sign), Sign);
+
+	Greater = _mm_cmpgt_epi32(x, y);
+	Max = _mm_or_si128(_mm_and_si128(Greater, x), _mm_andnot_si128(Greater, y));
+	Min = _mm_xor_si128(_mm_xor_si128(x, y), Max);
+
+	Dist2 = _mm_add_epi32(Max, _mm_srai_epi32(Min, 1));
+	Lit = _mm_cmplt_epi32(Dist2, Radius2);
+	Val = _mm_and_si128(_mm_sub_epi32(Radius2, Dist2), Lit);
+
+	// Texels 0..3 are laid out R0 G0 B0 R1 | G1 B1 R2 G2 | B2 R3 G3 B3
+	Color = _mm_setr_epi32(Fast->R & 0xFFFF, Fast->G & 0xFFFF, Fast->B & 0xFFFF, Fast->R & 0xFFFF);
+	RGB[0] = _mm_add_epi32(RGB[0], _mm_madd_epi16(_mm_shuffle_epi32(Val, _MM_SHUFFLE(1,0,0,0)), Color));
+
+	Color = _mm_setr_epi32(Fast->G & 0xFFFF, Fast->B & 0xFFFF, Fast->R & 0xFFFF, Fast->G & 0xFFFF);
+	RGB[1] = _mm_add_epi32(RGB[1], _mm_madd_epi16(_mm_shuffle_epi32(Val, _MM_SHUFFLE(2,2,1,1)), Color));
+
+	Color = _mm_setr_epi32(Fast->B & 0xFFFF, Fast->R & 0xFFFF, Fast->G & 0xFFFF, Fast->B & 0xFFFF);
+	RGB[2] = _mm_add_epi32(RGB[2], _mm_madd_epi16(_mm_shuffle_epi32(Val, _MM_SHUFFLE(3,3,3,2)), Color));
+
+	return Lit;
+}
+
+static jeBoolean FitsInt16(int32 Val)
+{
+	return (Val >= -32768 && Val <= 32767);
+}
+#endif
 
-	Radius2 = (int32)Radius;
+//=====================================================================================
+//	CombineDLightsWithRGBMapFastLightingModel
+//	Adds every light in LightMask (bits index BSP->DLights) to the face's lightmap
+//=====================================================================================
+static jeBoolean CombineDLightsWithRGBMapFastLightingModel(jeBSP *BSP, int32 *LightData, uint32 LightMask, jeBSPNode_DrawFace *Face)
+{
+	jeBSP_FastDLight	Fast[MAX_VISIBLE_DLIGHTS];
+	int32				Row[MAX_VISIBLE_DLIGHTS];
+	int32				NumFast, NumRow, i, l, u, v, Width;
+	int32				XStep, YStep;
+	jeBoolean			Hit;
+	jeBSPNode_Lightmap	*Lightmap;
+#ifdef JE_BSP_SSE2
+	jeBoolean			Wide;
+#endif
 	
+	assert(LightData);
+	assert(Face);
+	assert(Face->Lightmap);
+
+	Lightmap = Face->Lightmap;
+
+	NumFast = 0;
+
+	for (i=0; i< BSP->NumDLights; i++)
+	{
+		if (!(LightMask & (1<<i)))
+			continue;
+
+		if (SetupFastDLight(BSP, &BSP->DLights[i], Face, &Fast[NumFast]))
+			NumFast++;
+	}
+
+	if (!NumFast)
+		return JE_FALSE;
+
+	Hit = JE_FALSE;
+
+	Width = Lightmap->Width;
 	XStep = Lightmap->XStep;
 	YStep = Lightmap->YStep;
 
-	FixedY = Sy;
+#ifdef JE_BSP_SSE2
+	Wide = JE_TRUE;
+
+	for (l=0; l< NumFast; l++)
+	{
+		if (Fast[l].Radius2 > 32767 || !FitsInt16(Fast[l].R) || !FitsInt16(Fast[l].G) || !FitsInt16(Fast[l].B))
+			Wide = JE_FALSE;
+	}
+#endif
 
-	for (v=0; v< Lightmap->Height; v++)
+	for (v=0; v< Lightmap->Height; v++, LightData += Width*3)
 	{
-		y = FixedY >> 10;
+		int32		y[MAX_VISIBLE_DLIGHTS];
 
-		if (y < 0)
-			y = -y;
+		// Skip lights that can't reach this row: the distance is never less than y
+		NumRow = 0;
 
-		FixedX = Sx;
-		
-		for (u=0; u< Lightmap->Width; u++)
+		for (l=0; l< NumFast; l++)
 		{
-			x = FixedX >> 10;
+			int32		ly;
 
-			if (x<0)
-				x = -x;
+			ly = (Fast[l].Sy - v*YStep) >> 10;
 
-			if (x > y)
-				Dist2 = (x + (y>>1));
-			else
-				Dist2 = (y + (x>>1));
-			
-			if (Dist2 < Radius2)
+			if (ly < 0)
+				ly = -ly;
+
+			if (ly >= Fast[l].Radius2)
+				continue;
+
+			y[NumRow] = ly;
+			Row[NumRow++] = l;
+		}
+
+		if (!NumRow)
+			continue;
+
+		u = 0;
+
+	#ifdef JE_BSP_SSE2
+		if (Wide)
+		{
+			__m128i		Lit = _mm_setzero_si128();
+
+			for (; u+4 <= Width; u+=4)
 			{
-				Hit = JE_TRUE;
-				
-				Val = (Radius2 - Dist2);
+				__m128i		RGB[3];
+				int32		*pData = LightData + u*3;
+
+				RGB[0] = _mm_loadu_si128((const __m128i *)(pData + 0));
+				RGB[1] = _mm_loadu_si128((const __m128i *)(pData + 4));
+				RGB[2] = _mm_loadu_si128((const __m128i *)(pData + 8));
+
+				for (l=0; l< NumRow; l++)
+				{
+					const jeBSP_FastDLight	*pFast = &Fast[Row[l]];
+					__m128i					FixedX;
+
+					FixedX = _mm_sub_epi32(_mm_set1_epi32(pFast->Sx - u*XStep), _mm_setr_epi32(0, XStep, XStep*2, XStep*3));
+
+					Lit = _mm_or_si128(Lit, AddFastDLightQuad(pFast, FixedX, _mm_set1_epi32(y[l]), RGB));
+				}
 
-				*LightData++ += (int32)(Val * ColorR);
-				*LightData++ += (int32)(Val * ColorG);
-				*LightData++ += (int32)(Val * ColorB);
+				_mm_storeu_si128((__m128i *)(pData + 0), RGB[0]);
+				_mm_storeu_si128((__m128i *)(pData + 4), RGB[1]);
+				_mm_storeu_si128((__m128i *)(pData + 8), RGB[2]);
 			}
-			else
-				LightData+=3;
 
-			FixedX -= XStep;
+			if (_mm_movemask_epi8(Lit))
+				Hit = JE_TRUE;
 		}
+	#endif
+
+		for (; u< Width; u++)
+		{
+			for (l=0; l< NumRow; l++)
+			{
+				const jeBSP_FastDLight	*pFast = &Fast[Row[l]];
 
-		FixedY -= YStep;
+				if (AddFastDLightTexel(pFast, (pFast->Sx - u*XStep) >> 10, y[l], LightData + u*3))
+					Hit = JE_TRUE;
+			}
+		}
 	}
 
 	return Hit;
@@ -2846,7 +3642,6 @@ static jeBoolean CombineDLightWithRGBMap(jeBSP *BSP, int32 *LightData, jeBSPNode
 {
 	int32				i, p, NumPoints;
 	jeVec3d				*Points, *pPoint;	
-	jeVec3d				RGB[MAX_LIGHTMAP_WH*MAX_LIGHTMAP_WH], *pRGB;		// 5k 
 	jeBSPNode_Lightmap	*Lightmap;
 	jePlane				Plane;
 	jeFloat				Dist;
@@ -2883,11 +3678,11 @@ static jeBoolean CombineDLightWithRGBMap(jeBSP *BSP, int32 *LightData, jeBSPNode
 		return JE_FALSE;		// Light is NOT in radius of face
 
 	pPoint = Points;
-	pRGB = RGB;
 
-	for (p=0; p< NumPoints; p++, pPoint++, pRGB++)
+	// Unlit points would add 0, so lit ones go straight into the lightmap data
+	for (p=0; p< NumPoints; p++, pPoint++, LightData+=3)
 	{
-		jeVec3d		Vect;
+		jeVec3d		Vect, RGB;
 		jeFloat		Dist, Angle, Val;
 
 		jeVec3d_Subtract(&Light->Pos, pPoint, &Vect);
@@ -2900,66 +3695,31 @@ static jeBoolean CombineDLightWithRGBMap(jeBSP *BSP, int32 *LightData, jeBSPNode
 			if (DoubleSided)
 				Angle = (jeFloat)fabs(Angle);
 			else 
-				goto Skip;
+				continue;
 		}
 			
 		Val = (Light->Radius - Dist) * Angle;
 
 		if (Val <= 0.0f)
-			goto Skip;	// Light out of radius for this point
+			continue;	// Light out of radius for this point
 
 		if (BSP->RootNode)
 		{
 			if (jeBSPNode_RayIntersects_r(BSP->RootNode, BSP, pPoint, &Light->Pos))
-				goto Skip;	// Ray is in shadow
-		}
-
-		// Add this lights color to the lightmap data
-		jeVec3d_Scale(&Light->Color, Val, pRGB);
-		continue;
-
-		Skip:
-		{
-			jeVec3d_Clear(pRGB);
+				continue;	// Ray is in shadow
 		}
-	}
 
-	pRGB = RGB;
+		// Add this lights color to the lightmap data, clamping to MaxLight
+		jeVec3d_Scale(&Light->Color, Val, &RGB);
 
-	// Put the light into the lightmaps data, scaling, then clamping to MaxLight
-	for (p=0; p< NumPoints; p++, pRGB++)
-	{
-	#if 0
-		jeFloat		Max, Max2;
-
-		// Clamp light to a min of 1.0f, and find max
-		Max = 0.0f;
 		for (i=0; i<3; i++)
 		{
-			jeFloat		Val;
-
-			Val = jeVec3d_GetElement(pRGB, i);
-			if (Val < 1.0f)
-				jeVec3d_SetElement(pRGB, i, 1.0f);
-			if (Val > Max)
-				Max = Val;
-		}
-
-		Max2 = min(Max, MaxLight);
+			jeFloat	Comp;
 			
-		// Copy work RGB into real lightmap, clamping to MaxLight
-		for (i=0; i<3; i++)
-			*LightData++ += (uint32)(jeVec3d_GetElement(pRGB, i)*Max2/Max)<<LIGHT_FRACT;
-	#else	
-		for (i=0; i<3; i++, LightData++)
-		{
-			jeFloat	Val;
-			
-			Val = min(jeVec3d_GetElement(pRGB, i), MaxLight);
+			Comp = min(jeVec3d_GetElement(&RGB, i), MaxLight);
 
-			(*LightData) += (uint32)(Val*(1<<LIGHT_FRACT));
+			LightData[i] += (uint32)(Comp*(1<<LIGHT_FRACT));
 		}
-	#endif
 	}
 
 	return JE_TRUE;
@@ -3059,6 +3819,8 @@ static void JETCC jeBSP_SetupLightmap(jeRDriver_LMapCBInfo *Info, void *LMapCBCo
 	// Merge in the dynamic lights
 	if (pFace->DLightVisFrame == BSP->DLightVisFrame)			// Face has some dlights
 	{
+		uint32		FastLights = 0;
+
 		for (i=0; i< BSP->NumDLights; i++)
 		{
 			jeBSPNode_Light		*Light;
@@ -3069,16 +3831,19 @@ static void JETCC jeBSP_SetupLightmap(jeRDriver_LMapCBInfo *Info, void *LMapCBCo
 			Light = &BSP->DLights[i];
 
 			if (Light->Flags & JE_LIGHT_FLAG_FAST_LIGHTING_MODEL)
-			{
-				if (CombineDLightWithRGBMapFastLightingModel(BSP, TempRGB32, Light, pFace))
-					Info->Dynamic = JE_TRUE;
-			}
+				FastLights |= (1<<i);		// Done together below
 			else 
 			{
 				if (CombineDLightWithRGBMap(BSP, TempRGB32, Light, pFace))
 					Info->Dynamic = JE_TRUE;
 			}
 		}
+
+		if (FastLights)
+		{
+			if (CombineDLightsWithRGBMapFastLightingModel(BSP, TempRGB32, FastLights, pFace))
+				Info->Dynamic = JE_TRUE;
+		}
 	}
 
 	// Clamp and Copy 32-bit data over to 8-bit data
@@ -3246,6 +4011,7 @@ static jeBoolean JETCC ShutdownDriverCB(DRV_Driver *Driver, void *Context)
 	}
 
 	Tree->Driver = NULL;
+	Tree->HWTransform = JE_FALSE;
 
 	return JE_TRUE;
 }
@@ -3265,6 +4031,14 @@ static jeBoolean JETCC StartupDriverCB(DRV_Driver *Driver, void *Context)
 
 	Tree->Driver = Driver;		// This is the current render driver (used to manage lightmaps, rendering, etc)
 
+	// Caps only change with the driver, so cache what the render paths need
+	{
+		jeDeviceCaps	DevCaps;
+
+		Driver->GetDeviceCaps(&DevCaps);
+		Tree->HWTransform = (DevCaps.SuggestedDefaultRenderFlags & JE_RENDER_FLAG_HWTRANSFORM) ? JE_TRUE : JE_FALSE;
+	}
+
 	return JE_TRUE;
 }
 
@@ -3427,6 +4201,10 @@ static void jeBSP_DestroyInternalArrays(jeBSP *BSP)
 
 	if (BSP->VertArray)
 		jeVertArray_Destroy(&BSP->VertArray);
+
+	// Every node and face is gone, so their vis indices can start over
+	jeBSP_VisIndexPoolReset(&BSP->NodeVisIndices);
+	jeBSP_VisIndexPoolReset(&BSP->FaceVisIndices);
 }
 
 //=====================================================================================
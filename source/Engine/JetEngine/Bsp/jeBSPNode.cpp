@@ -21,6 +21,8 @@
 #include <assert.h>
 #include <math.h>
 
+#include <atomic>
+
 #include "Dcommon.h"
 #include "jeBSP._h"
 #include "jeBSP.h"
@@ -107,6 +109,7 @@ jeBSPNode *jeBSPNode_Create(jeBSP *BSP)
 	ZeroMem(Node);
 
 	Node->PlaneIndex = JE_PLANEARRAY_NULL_INDEX;
+	Node->VisIndex = jeBSP_VisIndexAlloc(&BSP->NodeVisIndices);
 
 	return Node;
 }
@@ -152,6 +155,8 @@ void jeBSPNode_Destroy_r(jeBSPNode **Node, jeBSP *BSP)
 	// Free all the faces
 	jeBSPNode_DestroyBSPFaces(Node2, BSP, JE_FALSE);
 
+	jeBSP_VisIndexFree(&BSP->NodeVisIndices, Node2->VisIndex);
+
 #ifdef NODE_USE_JE_RAM
 	jeRam_Free(*Node);
 #else
@@ -1028,8 +1033,8 @@ jeBoolean jeBSPNode_BuildContents(jeBSPNode *Node, jeBSP *BSP)
 	return JE_TRUE;
 }
 
-int32	NumAirLeafs = 0;
-int32	NumSolidLeafs = 0;
+std::atomic<int32>	NumAirLeafs(0);			// Leafs are initialized from several tasks during a parallel build
+std::atomic<int32>	NumSolidLeafs(0);
 
 //=======================================================================================
 //	jeBSPNode_InitializeLeaf
@@ -1782,43 +1787,6 @@ jeBoolean jeBSPNode_UpdateLeafSides_r(jeBSPNode *Node, jeBSP *BSP)
 	return JE_TRUE;
 }
 
-//=======================================================================================
-//	jeBSPNode_RemoveRecursionBit_r
-//=======================================================================================
-static void jeBSPNode_RemoveRecursionBit_r(jeBSPNode *Node, uint32 RecursionBit)
-{
-	int32		i;
-
-	// Check recursion bit
-	if (!(Node->RecursionBits & RecursionBit))
-		return;
-
-	g_WorldDebugInfo.NumNodes++;
-
-	// Remove the recursion bit
-	Node->RecursionBits ^= RecursionBit;
-
-	if (Node->Leaf)		// At leaf, start recursing back up stack
-	{
-		g_WorldDebugInfo.NumLeaves++;
-		return;
-	}
-
-	// Render polys on node
-	for (i=0; i< Node->NumDrawFaces; i++)
-	{
-		jeBSPNode_DrawFace	*DFace;
-
-		DFace = Node->DrawFaces[i];
-
-		// Remove recursion bit from face
-		DFace->RecursionBits ^= RecursionBit;
-	}
-
-	jeBSPNode_RemoveRecursionBit_r(Node->Children[NODE_FRONT], RecursionBit);
-	jeBSPNode_RemoveRecursionBit_r(Node->Children[NODE_BACK], RecursionBit);
-}
-
 //=======================================================================================
 //	jeBSPNode_RenderFrontToBack_r
 //		Traverses down the side the camera is on to the opposite side the camera is on
@@ -1831,17 +1799,9 @@ void jeBSPNode_RenderFrontToBack_r(jeBSPNode *Node, jeBSP *BSP, jeBSPNode_SceneI
 
 	assert(jeBSPNode_IsValid(Node) == JE_TRUE);
 
-	// Check recursion bit
-	if (SceneInfo->RecursionBit)
-	{
-		if (!(Node->RecursionBits & SceneInfo->RecursionBit))
-		{
-			return;
-		}
-	}
-
-	// Remove the recursion bit
-	Node->RecursionBits ^= SceneInfo->RecursionBit;
+	// Skip nodes this view can't see.  The marks are only read here, so views can render in parallel.
+	if (SceneInfo->Vis && !jeBSP_VisNodeIsMarked(SceneInfo->Vis, Node))
+		return;
 
 	g_WorldDebugInfo.NumNodes++;
 
@@ -1881,14 +1841,7 @@ void jeBSPNode_RenderFrontToBack_r(jeBSPNode *Node, jeBSP *BSP, jeBSPNode_SceneI
 
 			if (Dist2 <= 0)
 			{
-				// We have no more visible nodes from this POV, 
-				//	so just traverse to leafs to remove the recursion bit
-				if (SceneInfo->RecursionBit)
-				{
-					jeBSPNode_RemoveRecursionBit_r(Node->Children[NODE_FRONT], SceneInfo->RecursionBit);
-					jeBSPNode_RemoveRecursionBit_r(Node->Children[NODE_BACK], SceneInfo->RecursionBit);
-				}
-
+				// We have no more visible nodes from this POV
 				return;
 			}
 
@@ -1919,23 +1872,25 @@ void jeBSPNode_RenderFrontToBack_r(jeBSPNode *Node, jeBSP *BSP, jeBSPNode_SceneI
 	// Render polys on node
 	for (i=0; i< Node->NumDrawFaces; i++)
 	{
-		jeDeviceCaps devcaps;
 		jeBSPNode_DrawFace	*DFace;
 
 		DFace = Node->DrawFaces[i];
 
-		if (!(DFace->RecursionBits & SceneInfo->RecursionBit) && SceneInfo->RecursionBit)
+		if (SceneInfo->Vis && !jeBSP_VisFaceIsMarked(SceneInfo->Vis, DFace))
 			continue;
 
-		// Remove recursion bit from face
-		DFace->RecursionBits ^= SceneInfo->RecursionBit;
-
 		if (DFace->NodeSide != Side)
 			continue;		// Backfaced from node dir
 
-		BSP->Driver->GetDeviceCaps(&devcaps);
-		if ((devcaps.SuggestedDefaultRenderFlags & JE_RENDER_FLAG_HWTRANSFORM) == 0) {
-			jeBSPNode_DrawFaceRender(DFace, BSP, SceneInfo, ClipFlags);
+		if (!SceneInfo->HWTransform) {
+			if (!jeBSPNode_DrawFaceQueue(DFace, BSP, SceneInfo, ClipFlags))
+			{
+				// Portals draw another view, so what's queued so far goes out first, like before
+				if (DFace->PortalObject)
+					jeBSPNode_DrawFaceFlushBatch(BSP, SceneInfo);
+
+				jeBSPNode_DrawFaceRender(DFace, BSP, SceneInfo, ClipFlags);
+			}
 		} else {
 			jeBSPNode_DrawFaceRenderPortal(DFace, BSP, SceneInfo, ClipFlags);
 		}
@@ -2082,7 +2037,7 @@ void jeBSPNode_RebuildFaces_r(jeBSPNode *Node, jeBSP *BSP)
 //=======================================================================================
 //	jeBSPNode_SplitBrushList
 //=======================================================================================
-jeBoolean jeBSPNode_SplitBrushList(jeBSPNode *Node, jeBSP *BSP, jeBSP_Brush *Brushes, jeBSP_Brush **Front, jeBSP_Brush **Back)
+jeBoolean jeBSPNode_SplitBrushList(jeBSPNode *Node, jeBSP *BSP, jeBSP_Brush *Brushes, jeBSP_Brush **Front, jeBSP_Brush **Back, int32 *NumSplits)
 {
 	jeBSP_Brush			*Brush, *NewBrush, *NewBrush2, *Next;
 	jeBSP_Side			*Side;
@@ -2090,6 +2045,7 @@ jeBoolean jeBSPNode_SplitBrushList(jeBSPNode *Node, jeBSP *BSP, jeBSP_Brush *Bru
 	int32				i;
 	
 	*Front = *Back = NULL;
+	*NumSplits = 0;
 
 	for (Brush = Brushes ; Brush ; Brush = Next)
 	{
@@ -2114,7 +2070,7 @@ jeBoolean jeBSPNode_SplitBrushList(jeBSPNode *Node, jeBSP *BSP, jeBSP_Brush *Bru
 				*Back = NewBrush2;
 			}
 
-			BSP->DebugInfo.NumSplits++;
+			(*NumSplits)++;
 
 			continue;
 		}
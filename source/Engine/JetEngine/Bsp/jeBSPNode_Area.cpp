@@ -157,7 +157,7 @@ void jeBSPNode_AreaDestroy(jeBSPNode_Area **pArea)
 //=======================================================================================
 //	jeBSPNode_AreaVisFlood
 //=======================================================================================
-jeBoolean jeBSPNode_AreaVisFlood_r(jeBSPNode_Area *Area, const jeVec3d *Pos, const jeFrustum *Frustum, uint32 RecursionBit, jeBSPNode_Area *FromArea)
+jeBoolean jeBSPNode_AreaVisFlood_r(jeBSPNode_Area *Area, const jeVec3d *Pos, const jeFrustum *Frustum, jeBSP_VisContext *Vis, jeBSPNode_Area *FromArea)
 {
 	jeBSPNode_AreaPortal	*pPortal;
 	int32					i;
@@ -166,14 +166,14 @@ jeBoolean jeBSPNode_AreaVisFlood_r(jeBSPNode_Area *Area, const jeVec3d *Pos, con
 	jeVec3d					Work2[MAX_PORTAL_VERTS];
 	jeBSPNode_AreaLeaf		*AreaLeaf;
 
-	if (!(Area->RecursionBits & RecursionBit))
+	if (!jeBSP_VisAreaIsMarked(Vis, Area))
 	{
-		// Mark all leafs in the area to the current RecursionBit
+		// Mark all leafs in the area as visible to this view
 		AreaLeaf = NULL;
 		while (AreaLeaf = (jeBSPNode_AreaLeaf*)jeArray_GetNextElement(Area->LeafArray, AreaLeaf))
 		{
 			// Mark the leaf as visible
-			jeBSPNode_LeafSetRecursionBit(AreaLeaf->Leaf, RecursionBit);
+			jeBSPNode_LeafMarkVisible(AreaLeaf->Leaf, Vis);
 		}
 
 		g_WorldDebugInfo.NumVisibleAreas++;	
@@ -197,8 +197,8 @@ jeBoolean jeBSPNode_AreaVisFlood_r(jeBSPNode_Area *Area, const jeVec3d *Pos, con
 		}
 	#endif
 
-		// Mark this area with the current RecursionBit
-		Area->RecursionBits |= RecursionBit;
+		// Mark this area as visible to this view
+		jeBSP_VisAreaSetMark(Vis, Area, JE_TRUE);
 	}
 
 	// Setup some of the clip info that won't change
@@ -240,7 +240,7 @@ jeBoolean jeBSPNode_AreaVisFlood_r(jeBSPNode_Area *Area, const jeVec3d *Pos, con
 		jeFrustum_SetFromVerts(&NewFrustum, Pos, ClipInfo.DstVerts, ClipInfo.NumDstVerts);
 
 		// Flow through the portals target (the area on the other side of the portal)
-		if (!jeBSPNode_AreaVisFlood_r(OtherArea, Pos, &NewFrustum, RecursionBit, Area))
+		if (!jeBSPNode_AreaVisFlood_r(OtherArea, Pos, &NewFrustum, Vis, Area))
 			return JE_FALSE;
 	}
 
@@ -389,7 +389,7 @@ jeBoolean jeBSPNode_AreaMakeDrawFaces(jeBSPNode_Area *Area)
 //=======================================================================================
 //	jeBSPNode_AreaVisFlood
 //=======================================================================================
-jeBoolean jeBSPNode_AreaRenderFlood_r(jeBSPNode_Area *Area, jeBSP *BSP, const jeCamera *Camera, const jeFrustum *Frustum, uint32 RecursionBit, jeBSPNode_Area *FromArea)
+jeBoolean jeBSPNode_AreaRenderFlood_r(jeBSPNode_Area *Area, jeBSP *BSP, const jeCamera *Camera, const jeFrustum *Frustum, jeBSP_VisContext *Vis, jeBSPNode_Area *FromArea)
 {
 	jeBSPNode_AreaPortal	*pPortal;
 	int32					i;
@@ -401,16 +401,18 @@ jeBoolean jeBSPNode_AreaRenderFlood_r(jeBSPNode_Area *Area, jeBSP *BSP, const je
 
 	assert(0);		// This stuff is not ready for prime time...
 
-	if (!(Area->RecursionBits & RecursionBit))
+	if (!jeBSP_VisAreaIsMarked(Vis, Area))
 		g_WorldDebugInfo.NumVisibleAreas++;	
 
-	// Mark this area with the current RecursionBit
-	Area->RecursionBits |= RecursionBit;
+	// Mark this area as visible to this view
+	jeBSP_VisAreaSetMark(Vis, Area, JE_TRUE);
 
 	// Render it !
 	SceneInfo.Camera = (jeCamera*)Camera;
 	SceneInfo.Frustum = (jeFrustum*)Frustum;
-	SceneInfo.RecursionBit = RecursionBit;
+	SceneInfo.Vis = Vis;
+	SceneInfo.HWTransform = BSP->HWTransform;
+	SceneInfo.Batch = NULL;
 
 	//@@ set up area clip flags!
 	ClipFlags = (1UL<<Frustum->NumPlanes)-1;
@@ -443,7 +445,7 @@ jeBoolean jeBSPNode_AreaRenderFlood_r(jeBSPNode_Area *Area, jeBSP *BSP, const je
 			VO = (jeVisObject *)List_NodeData(Node);
 			assert(VO);
 
-			jeVisObject_Render(VO, Frustum, RecursionBit);
+			jeVisObject_Render(VO, Frustum, BSP->RenderRecursion);
 		}
 	}
 
@@ -486,7 +488,7 @@ jeBoolean jeBSPNode_AreaRenderFlood_r(jeBSPNode_Area *Area, jeBSP *BSP, const je
 		jeFrustum_SetFromVerts(&NewFrustum, jeCamera_GetPov(Camera), ClipInfo.DstVerts, ClipInfo.NumDstVerts);
 
 		// Flow through the portals target (the area on the other side of the portal)
-		if (!jeBSPNode_AreaRenderFlood_r(OtherArea, BSP, Camera, &NewFrustum, RecursionBit, Area))
+		if (!jeBSPNode_AreaRenderFlood_r(OtherArea, BSP, Camera, &NewFrustum, Vis, Area))
 			return JE_FALSE;
 	}
 
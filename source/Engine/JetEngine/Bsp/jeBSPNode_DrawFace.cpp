@@ -19,6 +19,8 @@
 /*                                                                                      */
 /****************************************************************************************/
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
 #include "jeBSP._h"
@@ -55,6 +57,7 @@ jeBSPNode_DrawFace *jeBSPNode_DrawFaceCreate(jeBSP *BSP)
 	Face->TexVecIndex = JE_TEXVEC_ARRAY_NULL_INDEX;
 
 	Face->BSP = BSP;
+	Face->VisIndex = jeBSP_VisIndexAlloc(&BSP->FaceVisIndices);
 
 	return Face;
 }
@@ -111,6 +114,8 @@ void jeBSPNode_DrawFaceDestroy(jeBSPNode_DrawFace **Face, jeBSP *BSP)
 	//	jeBSPNode_LightmapDestroy(&DFace->Lightmap, BSP);
 	// END - Hardware T&L - paradoxnj 4/7/2005
 
+	jeBSP_VisIndexFree(&BSP->FaceVisIndices, DFace->VisIndex);
+
 #ifdef DRAWFACE_USE_JE_RAM
 	jeRam_Free(*Face);
 #else
@@ -473,16 +478,18 @@ void jeBSPNode_DrawFaceRender(const jeBSPNode_DrawFace *Face, jeBSP *BSP, jeBSPN
 
 	if (!(pFaceInfo->Flags & FACEINFO_RENDER_PORTAL_ONLY))
 	{
+		jeTexture	*THandle;
+
 		g_WorldDebugInfo.NumRenderedPolys++;
-	
-		if (pBitmap)
+
+		// A bitmap still waiting on the engine's attach budget has no THandle yet; the face
+		// goes out gouraud until it does
+		THandle = pBitmap ? jeBitmap_GetTHandle(pBitmap) : NULL;
+
+		if (THandle)
 		{
-			jeTexture	*THandle;
 			jeRDriver_Layer		Layers[2];
 	
-			THandle = jeBitmap_GetTHandle(pBitmap);
-			assert(THandle);
-	
 			Layers[0].THandle = THandle;
 			Layers[0].Rop = Rop_Multiply;
 			Layers[0].ShiftU = pFaceInfo->ShiftU;
@@ -536,6 +543,298 @@ void jeBSPNode_DrawFaceRender(const jeBSPNode_DrawFace *Face, jeBSP *BSP, jeBSPN
 		BSP->DrawFaceCB(TLVerts, ClipInfo.NumDstVerts, BSP->DrawFaceCBContext);
 }
 
+//=======================================================================================
+//	Face batching
+//	Faces that sit completely inside the frustum need no clipping, so instead of being
+//	drawn one at a time during the walk, they are queued on the view's batch.  The flush
+//	groups them by material, pulls each group's verts into one array, transforms and
+//	projects that array in one pass, and hands the group to the driver as one batch.
+//	Faces that need clipping, portals, see-through faces and faces with a DrawFaceCB
+//	still go through jeBSPNode_DrawFaceRender.
+//=======================================================================================
+
+//=======================================================================================
+//	jeBSPNode_DrawFaceQueue
+//	Returns JE_FALSE if the face can't be batched, and must be drawn now
+//=======================================================================================
+jeBoolean jeBSPNode_DrawFaceQueue(const jeBSPNode_DrawFace *Face, jeBSP *BSP, jeBSPNode_SceneInfo *SceneInfo, uint32 ClipFlags)
+{
+	jeBSP_FaceBatch			*Batch;
+	jeBSP_FaceBatchItem		*Item;
+	const jeFaceInfo		*pFaceInfo;
+
+	assert(Face);
+	assert(BSP);
+	assert(SceneInfo);
+
+	Batch = SceneInfo->Batch;
+
+	if (!Batch || ClipFlags)
+		return JE_FALSE;
+
+	if (Face->PortalObject)
+		return JE_FALSE;
+
+	if ((Face->TopSideFlags & TOPSIDE_CALL_CB) && BSP->DrawFaceCB)
+		return JE_FALSE;
+
+	if (Face->Poly->NumVerts+4 >= MAX_TEMP_VERTS)
+		return JE_FALSE;
+
+	pFaceInfo = jeFaceInfo_ArrayGetFaceInfoByIndex(BSP->FaceInfoArray, Face->FaceInfoIndex);
+
+	// See-through faces keep their draw order, and portal only faces draw nothing
+	if (pFaceInfo->Flags & (FACEINFO_TRANSPARENT | FACEINFO_RENDER_PORTAL_ONLY))
+		return JE_FALSE;
+
+	if (Batch->NumItems == Batch->MaxItems)
+	{
+		jeBSP_FaceBatchItem		*NewItems;
+		int32					NewMax;
+
+		NewMax = Batch->MaxItems ? Batch->MaxItems*2 : 256;
+		NewItems = (jeBSP_FaceBatchItem*)jeRam_Realloc(Batch->Items, NewMax*sizeof(jeBSP_FaceBatchItem));
+
+		if (!NewItems)
+			return JE_FALSE;
+
+		Batch->Items = NewItems;
+		Batch->MaxItems = NewMax;
+	}
+
+	Item = &Batch->Items[Batch->NumItems];
+
+	Item->Material = (int32)pFaceInfo->MaterialIndex;
+	Item->Order = Batch->NumItems;
+	Item->Face = Face;
+	Item->FaceInfo = pFaceInfo;
+
+	Batch->NumItems++;
+
+	return JE_TRUE;
+}
+
+//=======================================================================================
+//	jeBSPNode_DrawFaceCompareItems
+//=======================================================================================
+static int jeBSPNode_DrawFaceCompareItems(const void *a, const void *b)
+{
+	const jeBSP_FaceBatchItem	*Item1 = (const jeBSP_FaceBatchItem*)a;
+	const jeBSP_FaceBatchItem	*Item2 = (const jeBSP_FaceBatchItem*)b;
+
+	if (Item1->Material != Item2->Material)
+		return (Item1->Material < Item2->Material) ? -1 : 1;
+
+	return (Item1->Order < Item2->Order) ? -1 : (Item1->Order > Item2->Order);
+}
+
+//=======================================================================================
+//	jeBSPNode_DrawFaceBatchReserve
+//=======================================================================================
+static jeBoolean jeBSPNode_DrawFaceBatchReserve(jeBSP_FaceBatch *Batch, int32 NumVerts)
+{
+	jeLVertex		*NewLVerts;
+	jeTLVertex		*NewTLVerts;
+	int32			NewMax;
+
+	if (NumVerts <= Batch->MaxVerts)
+		return JE_TRUE;
+
+	NewMax = NumVerts + (NumVerts>>1) + 64;
+
+	NewLVerts = (jeLVertex*)jeRam_Realloc(Batch->LVerts, NewMax*sizeof(jeLVertex));
+
+	if (!NewLVerts)
+		return JE_FALSE;
+
+	Batch->LVerts = NewLVerts;
+
+	NewTLVerts = (jeTLVertex*)jeRam_Realloc(Batch->TLVerts, NewMax*sizeof(jeTLVertex));
+
+	if (!NewTLVerts)
+		return JE_FALSE;
+
+	Batch->TLVerts = NewTLVerts;
+	Batch->MaxVerts = NewMax;
+
+	return JE_TRUE;
+}
+
+//=======================================================================================
+//	jeBSPNode_DrawFaceRenderGroup
+//	Draws Items[0..NumItems-1], which all use the same material
+//=======================================================================================
+static void jeBSPNode_DrawFaceRenderGroup(const jeBSP_FaceBatchItem *Items, int32 NumItems, jeBSP *BSP, jeBSPNode_SceneInfo *SceneInfo)
+{
+	jeBSP_FaceBatch		*Batch;
+	const jeMaterial	*pMaterial;
+	const jeBitmap		*pBitmap;
+	jeTexture			*THandle;
+	jeLVertex			*pLVert;
+	jeTLVertex			*pTLVert;
+	uint32				Flags;
+	int32				i, v, NumVerts;
+#ifndef _USE_BITMAPS
+	const jeMaterialSpec*		pMatSpec;
+#endif
+
+	Batch = SceneInfo->Batch;
+
+	NumVerts = 0;
+
+	for (i=0; i< NumItems; i++)
+		NumVerts += Items[i].Face->Poly->NumVerts;
+
+	if (!jeBSPNode_DrawFaceBatchReserve(Batch, NumVerts))
+	{
+		// Out of memory, just draw them one by one
+		for (i=0; i< NumItems; i++)
+			jeBSPNode_DrawFaceRender(Items[i].Face, BSP, SceneInfo, 0);
+
+		return;
+	}
+
+	g_WorldDebugInfo.NumTransformedPolys += NumItems;
+
+	pMaterial = jeMaterial_ArrayGetMaterialByIndex(BSP->MaterialArray, Items[0].FaceInfo->MaterialIndex);
+#ifdef _USE_BITMAPS
+	pBitmap = jeMaterial_GetBitmap(pMaterial);
+#else
+	pMatSpec = jeMaterial_GetMaterialSpec(pMaterial);
+	if (pMatSpec == NULL) return;
+	pBitmap = jeMaterialSpec_GetLayerBitmap(pMatSpec, 0);
+#endif
+
+	// Gather the verts of all the faces into one array
+	pLVert = Batch->LVerts;
+
+	for (i=0; i< NumItems; i++)
+	{
+		const jeBSPNode_DrawFace	*Face = Items[i].Face;
+		const jeTexVert				*pTVert;
+
+		jeVertArray_GatherVerts(BSP->VertArray, Face->Poly->Verts, Face->Poly->NumVerts, (jeVec3d*)pLVert, sizeof(jeLVertex));
+
+		for (pTVert = Face->TVerts, v=0; v< Face->Poly->NumVerts; v++, pTVert++, pLVert++)
+		{
+			pLVert->u = pTVert->u;
+			pLVert->v = pTVert->v;
+			pLVert->r = pLVert->g = pLVert->b = 255.0f;
+			pLVert->a = 255.0f;
+		}
+	}
+
+	// Model to camera space, and project, all in one go
+	jeCamera_XFormProjectAndClampLArray(SceneInfo->Camera, &SceneInfo->ModelToCameraXForm, Batch->LVerts, Batch->TLVerts, NumVerts);
+
+	// Only non transparent polys get here.  They don't use spans like jeBSPNode_DrawFaceRender
+	// does: groups are drawn by material after the clipped faces, not front to back, so the
+	// span test would throw away nearer faces.  The zbuffer sorts them out instead.
+	Flags = SceneInfo->DefaultRenderFlags & ~(JE_RENDER_FLAG_SWRITE | JE_RENDER_FLAG_STEST);
+
+	if (h_LeftHanded)		// Big hack-a-rama
+		Flags |= JE_RENDER_FLAG_COUNTER_CLOCKWISE;
+
+	THandle = pBitmap ? jeBitmap_GetTHandle(pBitmap) : NULL;	// NULL while its attach is pending
+
+	BSP->Driver->BeginBatch();
+
+	pTLVert = Batch->TLVerts;
+
+	for (i=0; i< NumItems; i++)
+	{
+		const jeBSPNode_DrawFace	*Face = Items[i].Face;
+		const jeFaceInfo			*pFaceInfo = Items[i].FaceInfo;
+
+		g_WorldDebugInfo.NumRenderedPolys++;
+
+		if (THandle)
+		{
+			jeRDriver_Layer		Layers[2];
+
+			Layers[0].THandle = THandle;
+			Layers[0].Rop = Rop_Multiply;
+			Layers[0].ShiftU = pFaceInfo->ShiftU;
+			Layers[0].ShiftV = pFaceInfo->ShiftV;
+			Layers[0].ScaleU = pFaceInfo->DrawScaleU/pFaceInfo->LMapScaleU;
+			Layers[0].ScaleV = pFaceInfo->DrawScaleV/pFaceInfo->LMapScaleV;
+
+			if (Face->Lightmap && BSP->RenderMode == RenderMode_TexturedAndLit)
+			{
+				assert(Face->Lightmap->THandle);
+
+				Layers[1].THandle = Face->Lightmap->THandle;
+				Layers[1].Rop = Rop_None;
+				Layers[1].ShiftU = Face->Lightmap->StartU;
+				Layers[1].ShiftV = Face->Lightmap->StartV;
+				Layers[1].ScaleU = 16.0f;
+				Layers[1].ScaleV = 16.0f;
+
+				BSP->Driver->RenderWorldPoly(pTLVert, Face->Poly->NumVerts, Layers, 2, (void*)Face, Flags);
+			}
+			else
+				BSP->Driver->RenderWorldPoly(pTLVert, Face->Poly->NumVerts, Layers, 1, NULL, Flags);
+		}
+		else
+			BSP->Driver->RenderGouraudPoly(pTLVert, Face->Poly->NumVerts, Flags);
+
+		pTLVert += Face->Poly->NumVerts;
+	}
+
+	BSP->Driver->EndBatch();
+}
+
+//=======================================================================================
+//	jeBSPNode_DrawFaceFlushBatch
+//	Draws everything jeBSPNode_DrawFaceQueue queued, one driver batch per material
+//=======================================================================================
+void jeBSPNode_DrawFaceFlushBatch(jeBSP *BSP, jeBSPNode_SceneInfo *SceneInfo)
+{
+	jeBSP_FaceBatch		*Batch;
+	int32				Start, End;
+
+	assert(BSP);
+	assert(SceneInfo);
+
+	Batch = SceneInfo->Batch;
+
+	if (!Batch || !Batch->NumItems)
+		return;
+
+	if (Batch->NumItems > 1)
+		qsort(Batch->Items, Batch->NumItems, sizeof(jeBSP_FaceBatchItem), jeBSPNode_DrawFaceCompareItems);
+
+	for (Start = 0; Start < Batch->NumItems; Start = End)
+	{
+		for (End = Start+1; End < Batch->NumItems; End++)
+		{
+			if (Batch->Items[End].Material != Batch->Items[Start].Material)
+				break;
+		}
+
+		jeBSPNode_DrawFaceRenderGroup(&Batch->Items[Start], End-Start, BSP, SceneInfo);
+	}
+
+	Batch->NumItems = 0;
+}
+
+//=======================================================================================
+//	jeBSPNode_DrawFaceBatchFree
+//=======================================================================================
+void jeBSPNode_DrawFaceBatchFree(jeBSP_FaceBatch *Batch)
+{
+	assert(Batch);
+
+	if (Batch->Items)
+		jeRam_Free(Batch->Items);
+	if (Batch->LVerts)
+		jeRam_Free(Batch->LVerts);
+	if (Batch->TLVerts)
+		jeRam_Free(Batch->TLVerts);
+
+	memset(Batch, 0, sizeof(*Batch));
+}
+
 
 void jeBSPNode_DrawFaceRenderPortal(const jeBSPNode_DrawFace *Face, jeBSP *BSP, jeBSPNode_SceneInfo *SceneInfo, uint32 ClipFlags)
 {
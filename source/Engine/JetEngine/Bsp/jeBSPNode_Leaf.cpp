@@ -615,41 +615,43 @@ void jeBSPNode_LeafDestroyDrawFaceList(jeBSPNode_Leaf *Leaf, jeBSP *BSP)
 }
 
 //=======================================================================================
-//	jeBSPNode_BubbleRecursionBit
+//	jeBSPNode_BubbleVisMark
 //=======================================================================================
-void jeBSPNode_BubbleRecursionBit(jeBSPNode *Node, uint32 RecursionBit)
+static void jeBSPNode_BubbleVisMark(jeBSPNode *Node, jeBSP_VisContext *Vis)
 {
 	assert(jeBSPNode_IsValid(Node));
 
-	while (Node)
+	// A marked node always has marked parents, so we can stop at the first one
+	while (Node && !jeBSP_VisNodeIsMarked(Vis, Node))
 	{
-		Node->RecursionBits |= RecursionBit;
+		jeBSP_VisNodeSetMark(Vis, Node, JE_TRUE);
 		Node = Node->Parent;
 	}
 }
 
 //=======================================================================================
-//	jeBSPNode_LeafSetRecursionBit
+//	jeBSPNode_LeafMarkVisible
 //=======================================================================================
-void jeBSPNode_LeafSetRecursionBit(jeBSPNode_Leaf *Leaf, uint32 RecursionBit)
+void jeBSPNode_LeafMarkVisible(jeBSPNode_Leaf *Leaf, jeBSP_VisContext *Vis)
 {
 	int32		i;
 
 	assert(Leaf);
+	assert(Vis);
 
-	if (Leaf->Node->RecursionBits & RecursionBit)
+	if (jeBSP_VisNodeIsMarked(Vis, Leaf->Node))
 		return;		// Don't bother messing with it again...
 
-	Leaf->Node->RecursionBits |= RecursionBit;
+	jeBSP_VisNodeSetMark(Vis, Leaf->Node, JE_TRUE);
 
 	// Set all faces on the leaf as visible...
 	for (i=0; i< Leaf->NumDrawFaces; i++)
 	{
-		Leaf->DrawFaces[i]->RecursionBits |= RecursionBit;
+		jeBSP_VisFaceSetMark(Vis, Leaf->DrawFaces[i], JE_TRUE);
 	}
 
 	// Bubble vis info up to parents
-	jeBSPNode_BubbleRecursionBit(Leaf->Node->Parent, RecursionBit);
+	jeBSPNode_BubbleVisMark(Leaf->Node->Parent, Vis);
 }
 
 //#define LEAF_COLLISION_EPSILON	(0.1f)
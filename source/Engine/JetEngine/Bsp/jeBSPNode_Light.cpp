@@ -21,12 +21,15 @@
 #include <assert.h>
 #include <math.h>
 
+#include <vector>
+
 #include "jeBSP._h"
 
 #include "Errorlog.h"
 #include "Ram.h"
 #include "jeLight.h"
 #include "Bitmap.h"
+#include "jeParallel.h"
 
 #define min(a, b) (((a) < (b)) ? (a) : (b))  
 
@@ -380,14 +383,135 @@ jeBoolean jeBSPNode_LightmapFillPoints(const jeBSPNode_Lightmap *Lightmap, jeBSP
 	return JE_TRUE;
 }
 
+//=======================================================================================
+//	Light bake
+//	The traversals only gather faces (creating lightmaps on the way, the driver is not
+//	thread safe), then jeBSPNode_LightBakeRun fills them on the jeParallel pool.  Each
+//	face is still lit by exactly one thread, with the lights in chain order, so the
+//	result is the same as lighting them one at a time.
+//=======================================================================================
+typedef struct jeBSPNode_BakeLight
+{
+	jeVec3d				Pos;			// Model space
+	jeVec3d				Color;			// Scaled to 0..1
+	jeFloat				Radius;
+	jeFloat				Brightness;
+} jeBSPNode_BakeLight;
+
+typedef struct jeBSPNode_BakeFace
+{
+	jeBSPNode_DrawFace	*DrawFace;
+	jePlane				Plane;			// Already reversed for sided faces
+	jeBoolean			DoubleSided;
+	jeBoolean			Result;
+} jeBSPNode_BakeFace;
+
+struct jeBSPNode_LightBake
+{
+	jeBSP								*BSP;
+	jeBSPNode							*RootNode;
+
+	std::vector<jeBSPNode_BakeLight>	Lights;
+	std::vector<jeBSPNode_BakeFace>		Faces;
+};
+
+//=======================================================================================
+//	jeBSPNode_LightBakeBegin
+//	Transforms the lights of the BSP into model space, once for the whole rebuild.
+//	The bake lives on the BSP so its arrays keep their capacity between updates.
+//=======================================================================================
+jeBSPNode_LightBake *jeBSPNode_LightBakeBegin(jeBSP *BSP, jeBSPNode *RootNode)
+{
+	jeBSPNode_LightBake	*Bake;
+	jeChain_Link		*Link;
+
+	assert(BSP);
+
+	if (!BSP->LightBake)
+		BSP->LightBake = new jeBSPNode_LightBake;
+
+	Bake = BSP->LightBake;
+
+	Bake->BSP = BSP;
+	Bake->RootNode = RootNode;
+	Bake->Lights.clear();
+	Bake->Faces.clear();
+
+	if (!BSP->LightChain)
+		return Bake;		// No lights set yet, faces still get cleared to black
+
+	for (Link = jeChain_GetFirstLink(BSP->LightChain); Link; Link = jeChain_LinkGetNext(Link))
+	{
+		jeLight				*pLight;
+		jeBSPNode_BakeLight	Light;
+		uint32				Flags;
+
+		pLight = (jeLight*)jeChain_LinkGetLinkData(Link);
+
+		jeLight_GetAttributes(pLight, &Light.Pos, &Light.Color, &Light.Radius, &Light.Brightness, &Flags);
+
+		// Transform the light into the bsp
+		jeXForm3d_Transform(&BSP->WorldToModelXForm, &Light.Pos, &Light.Pos);
+
+		if (Light.Color.X > 1.0f || Light.Color.Y > 1.0f || Light.Color.Z > 1.0f)
+			jeVec3d_Scale(&Light.Color, 1.0f/255.0f, &Light.Color);
+
+		Bake->Lights.push_back(Light);
+	}
+
+	return Bake;
+}
+
+//=======================================================================================
+//	jeBSPNode_LightBakeDestroy
+//=======================================================================================
+void jeBSPNode_LightBakeDestroy(jeBSPNode_LightBake **Bake)
+{
+	assert(Bake);
+
+	delete *Bake;
+	*Bake = NULL;
+}
+
+//=======================================================================================
+//	jeBSPNode_LightBakeAddFace
+//	Queues a face for jeBSPNode_LightBakeRun.  The face must already have its lightmap.
+//=======================================================================================
+static jeBoolean jeBSPNode_LightBakeAddFace(jeBSPNode_LightBake *Bake, jeBSPNode_DrawFace *pDrawFace, const jePlane *Plane, jeBoolean DoubleSided)
+{
+	jeBSPNode_Lightmap	*Lightmap;
+	jeBSPNode_BakeFace	Face;
+
+	Lightmap = pDrawFace->Lightmap;
+	assert(Lightmap);
+
+	// If space for the lightdata has not been allocated, allocate it now, while still on one thread
+	if (!Lightmap->RGBData[0])	 
+	{
+		Lightmap->RGBData[0] = JE_RAM_ALLOCATE_ARRAY(uint8, Lightmap->Width*Lightmap->Height*3);
+		if (!Lightmap->RGBData[0])
+			return JE_FALSE;
+	}
+
+	Face.DrawFace = pDrawFace;
+	Face.Plane = *Plane;
+	Face.DoubleSided = DoubleSided;
+	Face.Result = JE_FALSE;
+
+	Bake->Faces.push_back(Face);
+
+	return JE_TRUE;
+}
+
 //=======================================================================================
 //	jeBSPNode_LightmapCalcLight
 //	Fills a lightmap with data from the list of lights supplied.
-//	If lightmap already has light, it is destroyed, and recreated...
+//	If lightmap already has light, it is overwritten...
+//	Touches nothing but the lightmap, so faces can be lit from any thread.
 //=======================================================================================
-jeBoolean jeBSPNode_LightmapCalcLight(jeBSPNode_Lightmap *Lightmap, jeBSP *BSP, const jePlane *Plane, jeBSPNode *RootNode, const jeVec3d *Pos, jeFloat Radius, const jeChain *LightArray, jeBoolean DoubleSided)
+static jeBoolean jeBSPNode_LightmapCalcLight(jeBSPNode_Lightmap *Lightmap, jeBSP *BSP, const jePlane *Plane, jeBSPNode *RootNode, const jeVec3d *Pos, jeFloat Radius, const jeBSPNode_LightBake *Bake, jeBoolean DoubleSided)
 {
-	int32				i, p, NumPoints;
+	int32				i, l, p, NumPoints;
 #ifdef LIGHTMAP_CACHE_POINTS
 	jeVec3d				*Points, *pPoint;		// 5k
 #else
@@ -395,10 +519,10 @@ jeBoolean jeBSPNode_LightmapCalcLight(jeBSPNode_Lightmap *Lightmap, jeBSP *BSP,
 #endif
 	jeVec3d				RGB[MAX_LIGHTMAP_WH*MAX_LIGHTMAP_WH], *pRGB;		// 5k 
 	uint8				*pLData;
-	jeChain_Link		*Link;
 
 	assert(Lightmap);
-	assert(LightArray);
+	assert(Lightmap->RGBData[0]);
+	assert(Bake);
 
 	NumPoints = Lightmap->Width*Lightmap->Height;
 
@@ -415,33 +539,21 @@ jeBoolean jeBSPNode_LightmapCalcLight(jeBSPNode_Lightmap *Lightmap, jeBSP *BSP,
 	memset(RGB, 0, sizeof(jeVec3d)*NumPoints);
 
 	// Go through all the lights
-	for (Link = jeChain_GetFirstLink(LightArray); Link; Link = jeChain_LinkGetNext(Link))
+	for (l=0; l< (int32)Bake->Lights.size(); l++)
 	{
-		jeLight			*pLight;
-		jeVec3d			Color;
-		jeFloat			LRadius, Brightness;
-		jeVec3d			LPos;
-		uint32			Flags;
-
-		pLight = (jeLight*)jeChain_LinkGetLinkData(Link);
+		const jeBSPNode_BakeLight	*pLight;
 
-		jeLight_GetAttributes(pLight, &LPos, &Color, &LRadius, &Brightness, &Flags);
-
-		// Transform the light into the bsp (FIXME:  XForm all lights before they get here!  Maintain a XForm'ed list...)
-		jeXForm3d_Transform(&BSP->WorldToModelXForm, &LPos, &LPos);
+		pLight = &Bake->Lights[l];
 
 		if (!DoubleSided)
 		{
-			if (jePlane_PointDistance(Plane, &LPos) < 0.001f)
+			if (jePlane_PointDistance(Plane, &pLight->Pos) < 0.001f)
 				continue;		// Light behind surface
 		}
 
-		if (jeVec3d_DistanceBetween(Pos, &LPos) > (Radius + LRadius + 1.0f))
+		if (jeVec3d_DistanceBetween(Pos, &pLight->Pos) > (Radius + pLight->Radius + 1.0f))
 			continue;		// Light is NOT in radius of face
 
-		if (Color.X > 1.0f || Color.Y > 1.0f || Color.Z > 1.0f)
-			jeVec3d_Scale(&Color, 1.0f/255.0f, &Color);
-
 		pPoint = Points;
 		pRGB = RGB;
 
@@ -450,7 +562,7 @@ jeBoolean jeBSPNode_LightmapCalcLight(jeBSPNode_Lightmap *Lightmap, jeBSP *BSP,
 			jeVec3d		Vect;
 			jeFloat		Dist, Angle, Val;
 
-			jeVec3d_Subtract(&LPos, pPoint, &Vect);
+			jeVec3d_Subtract(&pLight->Pos, pPoint, &Vect);
 			Dist = jeVec3d_Normalize(&Vect);
 
 			Angle = jeVec3d_DotProduct(&Vect, &Plane->Normal);
@@ -463,27 +575,19 @@ jeBoolean jeBSPNode_LightmapCalcLight(jeBSPNode_Lightmap *Lightmap, jeBSP *BSP,
 					continue;
 			}
 			
-			Val = (LRadius - Dist) * Angle;
+			Val = (pLight->Radius - Dist) * Angle;
 
 			if (Val <= 0.0f)
 				continue;	// Light out of radius for this point
 			
-			if (jeBSPNode_RayIntersects_r(RootNode, BSP, pPoint, &LPos))
+			if (jeBSPNode_RayIntersects_r(RootNode, BSP, pPoint, &pLight->Pos))
 				continue;	// Ray is in shadow
 
 			// Add this lights color to the lightmap data
-			jeVec3d_AddScaled(pRGB, &Color, Val*Brightness, pRGB);
+			jeVec3d_AddScaled(pRGB, &pLight->Color, Val*pLight->Brightness, pRGB);
 		}
 	}
 	
-	// If space for the lightdata has not been allocated, allocate it now
-	if (!Lightmap->RGBData[0])	 
-	{
-		Lightmap->RGBData[0] = JE_RAM_ALLOCATE_ARRAY(uint8, NumPoints*3);
-		if (!Lightmap->RGBData[0])
-			return JE_FALSE;
-	}
-
 	pRGB = RGB;
 	pLData = Lightmap->RGBData[0];
 
@@ -528,10 +632,52 @@ jeBoolean jeBSPNode_LightmapCalcLight(jeBSPNode_Lightmap *Lightmap, jeBSP *BSP,
 	return JE_TRUE;
 }
 
+//=======================================================================================
+//	jeBSPNode_LightBakeRun
+//	Lights every face gathered by the traversals
+//=======================================================================================
+static void jeBSPNode_LightBakeFace(int32 Index, void *Context)
+{
+	jeBSPNode_LightBake	*Bake = (jeBSPNode_LightBake*)Context;
+	jeBSPNode_BakeFace	*Face;
+	jeBSPNode_DrawFace	*pDrawFace;
+
+	Face = &Bake->Faces[Index];
+	pDrawFace = Face->DrawFace;
+
+	Face->Result = jeBSPNode_LightmapCalcLight(	pDrawFace->Lightmap, 
+												Bake->BSP, 
+												&Face->Plane, 
+												Bake->RootNode, 
+												&pDrawFace->Center, 
+												pDrawFace->Radius, 
+												Bake, 
+												Face->DoubleSided);
+}
+
+jeBoolean jeBSPNode_LightBakeRun(jeBSPNode_LightBake *Bake)
+{
+	int32		i;
+
+	assert(Bake);
+
+	jeParallel_For((int32)Bake->Faces.size(), jeBSPNode_LightBakeFace, Bake);
+
+	for (i=0; i< (int32)Bake->Faces.size(); i++)
+	{
+		if (!Bake->Faces[i].Result)
+			return JE_FALSE;
+	}
+
+	Bake->Faces.clear();
+
+	return JE_TRUE;
+}
+
 //=======================================================================================
 //	jeBSPNode_LightUpdate_r
 //=======================================================================================
-jeBoolean jeBSPNode_LightUpdate_r(jeBSPNode *Node, jeBSP *BSP, jeBSPNode *RootNode, jeBoolean UpdateAll)
+jeBoolean jeBSPNode_LightUpdate_r(jeBSPNode *Node, jeBSP *BSP, jeBSPNode *RootNode, jeBoolean UpdateAll, jeBSPNode_LightBake *Bake)
 {
 	assert(Node);
 
@@ -587,19 +733,13 @@ jeBoolean jeBSPNode_LightUpdate_r(jeBSPNode *Node, jeBSP *BSP, jeBSPNode *RootNo
 					return JE_FALSE;
 			}
 
-			// Fill the lightmap in with the data
+			// Queue the lightmap to be filled in with the data
 			if (pDrawFace->Contents & JE_BSP_CONTENTS_EMPTY)
 				DoubleSided = JE_TRUE;
 			else
 				DoubleSided = JE_FALSE;
 
-			if (!jeBSPNode_LightmapCalcLight(	pDrawFace->Lightmap, 
-												BSP, 
-												&Plane, RootNode, 
-												&pDrawFace->Center, 
-												pDrawFace->Radius, 
-												BSP->LightChain, 
-												DoubleSided))
+			if (!jeBSPNode_LightBakeAddFace(Bake, pDrawFace, &Plane, DoubleSided))
 				return JE_FALSE;
 
 		}
@@ -607,9 +747,9 @@ jeBoolean jeBSPNode_LightUpdate_r(jeBSPNode *Node, jeBSP *BSP, jeBSPNode *RootNo
 		Node->Flags &= ~NODE_UPDATELIGHTS;
 	}
 
-	if (!jeBSPNode_LightUpdate_r(Node->Children[NODE_FRONT], BSP, RootNode, UpdateAll))
+	if (!jeBSPNode_LightUpdate_r(Node->Children[NODE_FRONT], BSP, RootNode, UpdateAll, Bake))
 		return JE_FALSE;
-	if (!jeBSPNode_LightUpdate_r(Node->Children[NODE_BACK], BSP, RootNode, UpdateAll))
+	if (!jeBSPNode_LightUpdate_r(Node->Children[NODE_BACK], BSP, RootNode, UpdateAll, Bake))
 		return JE_FALSE;
 
 	return JE_TRUE;
@@ -619,7 +759,7 @@ jeBoolean jeBSPNode_LightUpdate_r(jeBSPNode *Node, jeBSP *BSP, jeBSPNode *RootNo
 //	jeBSPNode_LightPatch_r
 //	Lights all faces withought lightmaps...
 //=======================================================================================
-jeBoolean jeBSPNode_LightPatch_r(jeBSPNode *Node, jeBSP *BSP, jeBSPNode *RootNode)
+jeBoolean jeBSPNode_LightPatch_r(jeBSPNode *Node, jeBSP *BSP, jeBSPNode *RootNode, jeBSPNode_LightBake *Bake)
 {
 	assert(Node);
 
@@ -682,20 +822,13 @@ jeBoolean jeBSPNode_LightPatch_r(jeBSPNode *Node, jeBSP *BSP, jeBSPNode *RootNod
 					return JE_FALSE;
 			}
 
-			// Fill the lightmap in with the data
+			// Queue the lightmap to be filled in with the data
 			if (pDrawFace->Contents & JE_BSP_CONTENTS_EMPTY)
 				DoubleSided = JE_TRUE;
 			else
 				DoubleSided = JE_FALSE;
 
-			if (!jeBSPNode_LightmapCalcLight(	pDrawFace->Lightmap, 
-												BSP, 
-												&Plane, 
-												RootNode, 
-												&pDrawFace->Center, 
-												pDrawFace->Radius, 
-												BSP->LightChain,
-												DoubleSided))
+			if (!jeBSPNode_LightBakeAddFace(Bake, pDrawFace, &Plane, DoubleSided))
 				return JE_FALSE;
 
 		}
@@ -703,9 +836,9 @@ jeBoolean jeBSPNode_LightPatch_r(jeBSPNode *Node, jeBSP *BSP, jeBSPNode *RootNod
 		Node->Flags &= ~NODE_UPDATELIGHTS;
 	}
 
-	if (!jeBSPNode_LightPatch_r(Node->Children[NODE_FRONT], BSP, RootNode))
+	if (!jeBSPNode_LightPatch_r(Node->Children[NODE_FRONT], BSP, RootNode, Bake))
 		return JE_FALSE;
-	if (!jeBSPNode_LightPatch_r(Node->Children[NODE_BACK], BSP, RootNode))
+	if (!jeBSPNode_LightPatch_r(Node->Children[NODE_BACK], BSP, RootNode, Bake))
 		return JE_FALSE;
 
 	return JE_TRUE;
@@ -714,7 +847,7 @@ jeBoolean jeBSPNode_LightPatch_r(jeBSPNode *Node, jeBSP *BSP, jeBSPNode *RootNod
 //=======================================================================================
 //	jeBSPNode_LightUpdateFromPoint_r
 //=======================================================================================
-jeBoolean jeBSPNode_LightUpdateFromPoint_r(jeBSPNode *Node, jeBSP *BSP, jeBSPNode *RootNode, const jeVec3d *Pos, jeFloat Radius)
+jeBoolean jeBSPNode_LightUpdateFromPoint_r(jeBSPNode *Node, jeBSP *BSP, jeBSPNode *RootNode, const jeVec3d *Pos, jeFloat Radius, jeBSPNode_LightBake *Bake)
 {
 	jeFloat			Dist;
 	int32			i;
@@ -733,9 +866,9 @@ jeBoolean jeBSPNode_LightUpdateFromPoint_r(jeBSPNode *Node, jeBSP *BSP, jeBSPNod
 	Dist = jePlane_PointDistanceFast(pPlane, Pos);
 
 	if (Dist > Radius)		// Front side
-		return jeBSPNode_LightUpdateFromPoint_r(Node->Children[NODE_FRONT], BSP, RootNode, Pos, Radius);
+		return jeBSPNode_LightUpdateFromPoint_r(Node->Children[NODE_FRONT], BSP, RootNode, Pos, Radius, Bake);
 	if (Dist < -Radius)		// Back side
-		return jeBSPNode_LightUpdateFromPoint_r(Node->Children[NODE_BACK], BSP, RootNode, Pos, Radius);
+		return jeBSPNode_LightUpdateFromPoint_r(Node->Children[NODE_BACK], BSP, RootNode, Pos, Radius, Bake);
 	
 	// Both sides (On node)
 	for (i=0; i< Node->NumDrawFaces; i++)
@@ -783,27 +916,21 @@ jeBoolean jeBSPNode_LightUpdateFromPoint_r(jeBSPNode *Node, jeBSP *BSP, jeBSPNod
 				return JE_FALSE;
 		}
 
-		// Fill the lightmap in with the data
+		// Queue the lightmap to be filled in with the data
 		if (pDrawFace->Contents & JE_BSP_CONTENTS_EMPTY)
 			DoubleSided = JE_TRUE;
 		else
 			DoubleSided = JE_FALSE;
 
-		if (!jeBSPNode_LightmapCalcLight(	pDrawFace->Lightmap, 
-											BSP,
-											&Plane, RootNode, 
-											&pDrawFace->Center, 
-											pDrawFace->Radius, 
-											BSP->LightChain,
-											DoubleSided))
+		if (!jeBSPNode_LightBakeAddFace(Bake, pDrawFace, &Plane, DoubleSided))
 			return JE_FALSE;
 	}
 	
 	Node->Flags &= ~NODE_UPDATELIGHTS;
 
-	if (!jeBSPNode_LightUpdateFromPoint_r(Node->Children[NODE_FRONT], BSP, RootNode, Pos, Radius))
+	if (!jeBSPNode_LightUpdateFromPoint_r(Node->Children[NODE_FRONT], BSP, RootNode, Pos, Radius, Bake))
 		return JE_FALSE;
-	if (!jeBSPNode_LightUpdateFromPoint_r(Node->Children[NODE_BACK], BSP, RootNode, Pos, Radius))
+	if (!jeBSPNode_LightUpdateFromPoint_r(Node->Children[NODE_BACK], BSP, RootNode, Pos, Radius, Bake))
 		return JE_FALSE;
 
 	return JE_TRUE;
@@ -22,6 +22,8 @@
 #include <stdio.h>
 #include <memory.h>		// memset
 
+#include <atomic>
+
 // Private dependents
 #include "jeBSP._h"
 #include "Errorlog.h"
@@ -34,8 +36,9 @@
 
 #define BRUSH_SIZE(s) ((sizeof(jeBSP_Brush)-sizeof(jeBSP_Side[JE_BSP_BRUSH_DEFAULT_SIDES]))+(sizeof(jeBSP_Side)*(s)));
 
-static int32	g_ActiveBrushes = 0;
-static int32	g_PeekBrushes = 0;
+// Atomic, brushes are created and freed from several tasks during a parallel tree build
+static std::atomic<int32>	g_ActiveBrushes(0);
+static std::atomic<int32>	g_PeekBrushes(0);
 
 //=======================================================================================
 //	jeBSP_BrushCreate
@@ -65,10 +68,13 @@ jeBSP_Brush *jeBSP_BrushCreate(int32 NumSides)
 	for (i=0; i<NumSides; i++)
 		Brush->Sides[i].PlaneIndex = JE_PLANEARRAY_NULL_INDEX;
 
-	g_ActiveBrushes++;
+	{
+		int32	Active = ++g_ActiveBrushes;
+		int32	Peek = g_PeekBrushes;
 
-	if (g_ActiveBrushes > g_PeekBrushes)
-		g_PeekBrushes = g_ActiveBrushes;
+		while (Active > Peek && !g_PeekBrushes.compare_exchange_weak(Peek, Active))
+			;
+	}
 
 	return Brush;
 }
@@ -37,6 +37,11 @@
 
 #define CAMERA_MINIMUM_PROJECTION_DISTANCE (0.010f)
 
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+	#define JE_CAMERA_SSE
+	#include <xmmintrin.h>
+#endif
+
 //=====================================================================================
 //	jeCamera_Create
 //=====================================================================================
@@ -1052,6 +1057,92 @@ JETAPI void JETCC jeCamera_TransformAndProjectAndClampLArray(	const jeCamera		*C
 	}
 }
 
+//========================================================================================
+//	jeCamera_XFormProjectAndClampLArray
+//	Gives the same results as transforming each point with jeXForm3d_Transform, and then
+//	calling jeCamera_ProjectAndClampL on it (the math is done in the same order)
+//========================================================================================
+JETAPI void JETCC jeCamera_XFormProjectAndClampLArray(	const jeCamera		*Camera, 
+														const jeXForm3d		*M,
+														const jeLVertex		*Src, 
+														jeTLVertex			*Dst,
+														int32				Count)
+{
+	int32		i;
+
+	assert( Camera );
+	assert( M );
+	assert( Src );
+	assert( Dst );
+
+	i = 0;
+
+#ifdef JE_CAMERA_SSE
+	{
+		__m128	AX = _mm_set1_ps(M->AX), AY = _mm_set1_ps(M->AY), AZ = _mm_set1_ps(M->AZ), TX = _mm_set1_ps(M->Translation.X);
+		__m128	BX = _mm_set1_ps(M->BX), BY = _mm_set1_ps(M->BY), BZ = _mm_set1_ps(M->BZ), TY = _mm_set1_ps(M->Translation.Y);
+		__m128	CX = _mm_set1_ps(M->CX), CY = _mm_set1_ps(M->CY), CZ = _mm_set1_ps(M->CZ), TZ = _mm_set1_ps(M->Translation.Z);
+		__m128	MinZ = _mm_set1_ps(CAMERA_MINIMUM_PROJECTION_DISTANCE);
+		__m128	Scale = _mm_set1_ps(Camera->Scale);
+		__m128	ZScale = _mm_set1_ps(Camera->ZScale);
+		__m128	XCenter = _mm_set1_ps(Camera->XCenter), YCenter = _mm_set1_ps(Camera->YCenter);
+		__m128	Left = _mm_set1_ps(Camera->Left), Right = _mm_set1_ps(Camera->Right);
+		__m128	Top = _mm_set1_ps(Camera->Top), Bottom = _mm_set1_ps(Camera->Bottom);
+
+		for ( ; i+4 <= Count; i+=4)
+		{
+			__m128	X, Y, Z, W, CamX, CamY, ScaleOverZ;
+			int32	k;
+
+			// X,Y,Z,pad of 4 verts, turned into X's, Y's and Z's
+			X = _mm_loadu_ps(&Src[i+0].X);
+			Y = _mm_loadu_ps(&Src[i+1].X);
+			Z = _mm_loadu_ps(&Src[i+2].X);
+			W = _mm_loadu_ps(&Src[i+3].X);
+			_MM_TRANSPOSE4_PS(X, Y, Z, W);
+
+			CamX = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(X, AX), _mm_mul_ps(Y, AY)), _mm_mul_ps(Z, AZ)), TX);
+			CamY = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(X, BX), _mm_mul_ps(Y, BY)), _mm_mul_ps(Z, BZ)), TY);
+			Z    = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(X, CX), _mm_mul_ps(Y, CY)), _mm_mul_ps(Z, CZ)), TZ);
+
+			Z = _mm_max_ps(_mm_sub_ps(_mm_setzero_ps(), Z), MinZ);
+			ScaleOverZ = _mm_div_ps(Scale, Z);
+
+			X = _mm_add_ps(_mm_mul_ps(CamX, ScaleOverZ), XCenter);
+			X = _mm_min_ps(_mm_max_ps(X, Left), Right);
+
+			Y = _mm_sub_ps(YCenter, _mm_mul_ps(CamY, ScaleOverZ));
+			Y = _mm_min_ps(_mm_max_ps(Y, Top), Bottom);
+
+			Z = _mm_mul_ps(Z, ZScale);
+			W = _mm_setzero_ps();
+
+			_MM_TRANSPOSE4_PS(X, Y, Z, W);
+			_mm_storeu_ps(&Dst[i+0].x, X);
+			_mm_storeu_ps(&Dst[i+1].x, Y);
+			_mm_storeu_ps(&Dst[i+2].x, Z);
+			_mm_storeu_ps(&Dst[i+3].x, W);
+
+			for (k=0; k<4; k++)
+			{
+				_mm_storeu_ps(&Dst[i+k].r, _mm_loadu_ps(&Src[i+k].r));
+				Dst[i+k].u = Src[i+k].u;
+				Dst[i+k].v = Src[i+k].v;
+			}
+		}
+	}
+#endif
+
+	for ( ; i<Count; i++)
+	{
+		jeLVertex	CamVert;
+
+		CamVert = Src[i];
+		jeXForm3d_Transform(M, (const jeVec3d*)&Src[i], (jeVec3d*)&CamVert);
+		jeCamera_ProjectAndClampL(Camera, &CamVert, &Dst[i]);
+	}
+}
+
 //============================================================================================
 //	jeCamera_TransformAndProject
 //============================================================================================
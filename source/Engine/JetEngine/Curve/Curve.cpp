@@ -19,6 +19,8 @@
 /*                                                                                      */
 /****************************************************************************************/
 #include <assert.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "Curve.h"
 #include "jeTypes.h"
@@ -29,82 +31,449 @@
 
 int LevelToWidth[] = {3, 5, 9, 17, 33, 65, 129};
 
+#define JE_CURVE_NUM_LEVELS		(JE_CURVE_MAX_LEVEL+1)
 
-JETAPI void QuadraticBezierSubdivide( jeVec3d G[], int level) {
-	// Calculate subdivided indexes
-	int width = LevelToWidth[level] - 1;
-	int mid = width >> 1;
-	int a = width >> 2;
-	int b = mid + a;
-	// Do not subdivide any more, however, move middle control point to be
-	// a point on the curve
-	if(level == 0) {
-		jeVec3d a;
-		jeVec3d b;
-		a.X = (G[0].X + G[1].X)*0.5f;
-		a.Y = (G[0].Y + G[1].Y)*0.5f;
-		a.Z = (G[0].Z + G[1].Z) * 0.5f;
-		
-		b.X = (G[1].X + G[2].X)*0.5f;
-		b.Y = (G[1].Y + G[2].Y)*0.5f;
-		b.Z = (G[1].Z + G[2].Z) * 0.5f;
-		G[1].X = (a.X+b.X)*0.5f;
-		G[1].Y = (a.Y+b.Y)*0.5f;
-		G[1].Z = (a.Z+b.Z)*0.5f;
+// Evaluates the quadratic P0,P1,P2 at count evenly spaced points by forward differencing.
+// out may overlap the control points.
+static void EvaluateQuadratic(const jeVec3d *P0, const jeVec3d *P1, const jeVec3d *P2, int count, jeVec3d *out) {
+	// B(t) = P0 + B*t + A*t^2
+	jeVec3d A, B, F, D1, D2, Last;
+	jeFloat h = 1.0f / (count - 1);
+	int i;
 
-		return;
+	A.X = P0->X - 2.0f*P1->X + P2->X;
+	A.Y = P0->Y - 2.0f*P1->Y + P2->Y;
+	A.Z = P0->Z - 2.0f*P1->Z + P2->Z;
+	B.X = 2.0f*(P1->X - P0->X);
+	B.Y = 2.0f*(P1->Y - P0->Y);
+	B.Z = 2.0f*(P1->Z - P0->Z);
+
+	F = *P0;
+	Last = *P2;
+
+	D1.X = B.X*h + A.X*h*h;
+	D1.Y = B.Y*h + A.Y*h*h;
+	D1.Z = B.Z*h + A.Z*h*h;
+	D2.X = 2.0f*A.X*h*h;
+	D2.Y = 2.0f*A.Y*h*h;
+	D2.Z = 2.0f*A.Z*h*h;
+
+	for(i = 0; i < count-1; i++) {
+		out[i] = F;
+		F.X += D1.X;
+		F.Y += D1.Y;
+		F.Z += D1.Z;
+		D1.X += D2.X;
+		D1.Y += D2.Y;
+		D1.Z += D2.Z;
 	}
 
-	// Enter subdivided control points into the geometry vector
-	G[a].X = (G[0].X + G[mid].X) * 0.5f;
-	G[a].Y = (G[0].Y + G[mid].Y) * 0.5f;
-	G[a].Z = (G[0].Z + G[mid].Z) * 0.5f;
-	G[b].X = (G[mid].X + G[width].X) * 0.5f;
-	G[b].Y = (G[mid].Y + G[width].Y) * 0.5f;
-	G[b].Z = (G[mid].Z + G[width].Z) * 0.5f;
-	G[mid].X = (G[a].X + G[b].X) * 0.5f;
-	G[mid].Y = (G[a].Y + G[b].Y) * 0.5f;
-	G[mid].Z = (G[a].Z + G[b].Z) * 0.5f;
-
-	// Call recursively for left and right halves
-	QuadraticBezierSubdivide(G, --level);
-	QuadraticBezierSubdivide(&G[mid], level);
+	// End exactly on the last control point, so patches sharing an edge meet
+	out[count-1] = Last;
 }
-JETAPI jeVec3d* QuadraticBezierPatchSubdivide(jeVec3d G[3][3], int level) {
-	// Calculate some indexes
+
+// The control points of a curve are at 0, the middle and the end of G; on return
+// G holds LevelToWidth[level] points on the curve.
+JETAPI void QuadraticBezierSubdivide( jeVec3d G[], int level) {
 	int width = LevelToWidth[level];
-	int mid = width >> 1;
-	int total = width * width;
-	int i,j;
-	// Allocate space for the points on the surface and the interpolation of the
-	// control points
-	jeVec3d* p;
-	jeVec3d* index;
-	
-	p = (jeVec3d *)malloc(sizeof(jeVec3d)*total+3*width);
-
-	// Interpolate the control points using the geometry matrix
-	for( i = 0; i <3; i++) {
-		// Distribute the control points into the space to interpolate into
-		p[total] = G[i][0];
-		p[total+mid] = G[i][1];
-		p[total+width-1] = G[i][2];
-		QuadraticBezierSubdivide(&p[total], level);
-
-		index= p+i*mid;
-		for(j = 0; j < width; j++) {
-			*index = p[total + j];
-			index += width;
-		}
-		total += width;
 
-	}	
+	EvaluateQuadratic(&G[0], &G[width >> 1], &G[width-1], width, G);
+}
+
+// Fills p with the width*width grid of points on the patch.  Each row of G is
+// evaluated first, then each row of the grid from those.
+static void TessellatePatch(const jeVec3d G[3][3], int level, jeVec3d *p) {
+	jeVec3d C[3][129];
+	int width = LevelToWidth[level];
+	int i;
+
+	assert(width <= 129);
+
+	for(i = 0; i < 3; i++)
+		EvaluateQuadratic(&G[i][0], &G[i][1], &G[i][2], width, C[i]);
 
-// Interpolate all of the remaining points
 	for(i = 0; i < width; i++) {
-		QuadraticBezierSubdivide(&p[i * width], level);
+		jeVec3d P[3];
+
+		P[0] = C[0][i];
+		P[1] = C[1][i];
+		P[2] = C[2][i];
+		EvaluateQuadratic(&P[0], &P[1], &P[2], width, p + i * width);
 	}
+}
+
+JETAPI jeVec3d* QuadraticBezierPatchSubdivide(jeVec3d G[3][3], int level) {
+	int width = LevelToWidth[level];
+	jeVec3d* p;
+
+	p = (jeVec3d *)malloc(sizeof(jeVec3d)*width*width);
+
+	if(!p)
+		return NULL;
+
+	TessellatePatch(G, level, p);
 
 	// Return the points. Must be freed by the caller!
 	return p;
-}
\ No newline at end of file
+}
+
+JETAPI int jeCurve_LevelWidth(int level) {
+	assert(level >= 0 && level <= JE_CURVE_MAX_LEVEL);
+
+	return LevelToWidth[level];
+}
+
+static jeFloat SecondDifference(const jeVec3d *P0, const jeVec3d *P1, const jeVec3d *P2) {
+	jeVec3d D;
+
+	D.X = P0->X - 2.0f*P1->X + P2->X;
+	D.Y = P0->Y - 2.0f*P1->Y + P2->Y;
+	D.Z = P0->Z - 2.0f*P1->Z + P2->Z;
+
+	return jeVec3d_Length(&D);
+}
+
+JETAPI int jeCurve_SelectLevel(const jeVec3d G[3][3], const jeVec3d *Eye, jeFloat PixelsPerUnit, jeFloat MaxPixelError) {
+	jeVec3d Center;
+	jeFloat Du, Dv, Radius, Dist, Allowed;
+	int i, j, level;
+
+	assert(Eye);
+	assert(PixelsPerUnit > 0.0f);
+
+	// The second derivative along either parameter is 2*D for some D in the hull of
+	// that direction's second differences, and a flat segment of parameter length h
+	// strays at most |f''|*h*h/8 from a curve.
+	Du = Dv = 0.0f;
+
+	for(i = 0; i < 3; i++) {
+		jeFloat D;
+
+		D = SecondDifference(&G[i][0], &G[i][1], &G[i][2]);
+		if(D > Du)
+			Du = D;
+
+		D = SecondDifference(&G[0][i], &G[1][i], &G[2][i]);
+		if(D > Dv)
+			Dv = D;
+	}
+
+	// Nearest the patch can be, from the control points' bounding sphere
+	jeVec3d_Clear(&Center);
+
+	for(i = 0; i < 3; i++)
+		for(j = 0; j < 3; j++)
+			jeVec3d_Add(&Center, &G[i][j], &Center);
+
+	jeVec3d_Scale(&Center, 1.0f/9.0f, &Center);
+
+	Radius = 0.0f;
+
+	for(i = 0; i < 3; i++) {
+		for(j = 0; j < 3; j++) {
+			jeFloat D = jeVec3d_DistanceBetween(&Center, &G[i][j]);
+
+			if(D > Radius)
+				Radius = D;
+		}
+	}
+
+	Dist = jeVec3d_DistanceBetween(Eye, &Center) - Radius;
+
+	if(Dist <= JE_EPSILON)
+		return JE_CURVE_MAX_LEVEL;
+
+	Allowed = MaxPixelError * Dist / PixelsPerUnit;
+
+	for(level = 0; level < JE_CURVE_MAX_LEVEL; level++) {
+		jeFloat h = 1.0f / (LevelToWidth[level] - 1);
+
+		if((Du + Dv) * 0.25f * h * h <= Allowed)
+			break;
+	}
+
+	return level;
+}
+
+//=====================================================================================
+//	Patch cache
+//=====================================================================================
+typedef struct
+{
+	uint32		PatchID;
+	int			Level;			// -1 when the entry holds nothing
+	jeVec3d		G[3][3];
+	jeVec3d		*Points;
+	int32		MaxPoints;
+	int32		HashNext;
+	int32		Prev, Next;		// LRU order, most recent first
+} jeCurve_CacheEntry;
+
+struct jeCurve_PatchCache
+{
+	jeCurve_CacheEntry	*Entries;
+	int32				NumEntries, MaxEntries;
+	int32				*Hash;
+	uint32				HashMask;
+	int32				Head, Tail;
+	uint16				*Indices[JE_CURVE_NUM_LEVELS];
+	int32				NumIndices[JE_CURVE_NUM_LEVELS];
+};
+
+static uint32 PatchCache_Hash(const jeCurve_PatchCache *Cache, uint32 PatchID, int level) {
+	uint32 h = (PatchID * JE_CURVE_NUM_LEVELS + level) * 2654435761u;
+
+	return (h ^ (h >> 16)) & Cache->HashMask;
+}
+
+static void PatchCache_Unlink(jeCurve_PatchCache *Cache, int32 e) {
+	jeCurve_CacheEntry *Entry = &Cache->Entries[e];
+
+	if(Entry->Prev >= 0)
+		Cache->Entries[Entry->Prev].Next = Entry->Next;
+	else
+		Cache->Head = Entry->Next;
+
+	if(Entry->Next >= 0)
+		Cache->Entries[Entry->Next].Prev = Entry->Prev;
+	else
+		Cache->Tail = Entry->Prev;
+}
+
+static void PatchCache_PushFront(jeCurve_PatchCache *Cache, int32 e) {
+	jeCurve_CacheEntry *Entry = &Cache->Entries[e];
+
+	Entry->Prev = -1;
+	Entry->Next = Cache->Head;
+
+	if(Cache->Head >= 0)
+		Cache->Entries[Cache->Head].Prev = e;
+	else
+		Cache->Tail = e;
+
+	Cache->Head = e;
+}
+
+static void PatchCache_PushBack(jeCurve_PatchCache *Cache, int32 e) {
+	jeCurve_CacheEntry *Entry = &Cache->Entries[e];
+
+	Entry->Next = -1;
+	Entry->Prev = Cache->Tail;
+
+	if(Cache->Tail >= 0)
+		Cache->Entries[Cache->Tail].Next = e;
+	else
+		Cache->Head = e;
+
+	Cache->Tail = e;
+}
+
+static int32 PatchCache_Find(const jeCurve_PatchCache *Cache, uint32 PatchID, int level) {
+	int32 e;
+
+	for(e = Cache->Hash[PatchCache_Hash(Cache, PatchID, level)]; e >= 0; e = Cache->Entries[e].HashNext) {
+		if(Cache->Entries[e].PatchID == PatchID && Cache->Entries[e].Level == level)
+			return e;
+	}
+
+	return -1;
+}
+
+// Takes the entry out of the hash and marks it empty; it keeps its place in the LRU list
+static void PatchCache_Empty(jeCurve_PatchCache *Cache, int32 e) {
+	jeCurve_CacheEntry *Entry = &Cache->Entries[e];
+	int32 *Link;
+
+	if(Entry->Level < 0)
+		return;
+
+	for(Link = &Cache->Hash[PatchCache_Hash(Cache, Entry->PatchID, Entry->Level)]; *Link != e; Link = &Cache->Entries[*Link].HashNext)
+		assert(*Link >= 0);
+
+	*Link = Entry->HashNext;
+	Entry->Level = -1;
+}
+
+static jeBoolean PatchCache_BuildIndices(jeCurve_PatchCache *Cache, int level) {
+	int width = LevelToWidth[level];
+	uint16 *Index;
+	int r, c;
+
+	Cache->NumIndices[level] = (width-1) * (width-1) * 6;
+	Cache->Indices[level] = (uint16 *)jeRam_Allocate(Cache->NumIndices[level] * sizeof(uint16));
+
+	if(!Cache->Indices[level])
+		return JE_FALSE;
+
+	Index = Cache->Indices[level];
+
+	for(r = 0; r < width-1; r++) {
+		for(c = 0; c < width-1; c++) {
+			uint16 v = (uint16)(r * width + c);
+
+			*Index++ = v;
+			*Index++ = (uint16)(v + width);
+			*Index++ = (uint16)(v + 1);
+
+			*Index++ = (uint16)(v + 1);
+			*Index++ = (uint16)(v + width);
+			*Index++ = (uint16)(v + width + 1);
+		}
+	}
+
+	return JE_TRUE;
+}
+
+JETAPI jeCurve_PatchCache* jeCurve_PatchCacheCreate(int32 MaxEntries) {
+	jeCurve_PatchCache *Cache;
+	int32 HashSize;
+	int32 i;
+
+	assert(MaxEntries > 0);
+
+	Cache = JE_RAM_ALLOCATE_STRUCT_CLEAR(jeCurve_PatchCache);
+
+	if(!Cache)
+		return NULL;
+
+	for(HashSize = 16; HashSize < MaxEntries*2; HashSize <<= 1)
+		;
+
+	Cache->Entries = (jeCurve_CacheEntry *)jeRam_AllocateClear(MaxEntries * sizeof(jeCurve_CacheEntry));
+	Cache->Hash = (int32 *)jeRam_Allocate(HashSize * sizeof(int32));
+
+	if(!Cache->Entries || !Cache->Hash) {
+		jeCurve_PatchCacheDestroy(&Cache);
+		return NULL;
+	}
+
+	for(i = 0; i < HashSize; i++)
+		Cache->Hash[i] = -1;
+
+	Cache->HashMask = HashSize - 1;
+	Cache->MaxEntries = MaxEntries;
+	Cache->Head = Cache->Tail = -1;
+
+	return Cache;
+}
+
+JETAPI void jeCurve_PatchCacheDestroy(jeCurve_PatchCache **pCache) {
+	jeCurve_PatchCache *Cache;
+	int32 i;
+
+	assert(pCache && *pCache);
+
+	Cache = *pCache;
+
+	if(Cache->Entries) {
+		for(i = 0; i < Cache->NumEntries; i++) {
+			if(Cache->Entries[i].Points)
+				jeRam_Free(Cache->Entries[i].Points);
+		}
+
+		jeRam_Free(Cache->Entries);
+	}
+
+	if(Cache->Hash)
+		jeRam_Free(Cache->Hash);
+
+	for(i = 0; i < JE_CURVE_NUM_LEVELS; i++) {
+		if(Cache->Indices[i])
+			jeRam_Free(Cache->Indices[i]);
+	}
+
+	jeRam_Free(*pCache);
+}
+
+JETAPI jeBoolean jeCurve_PatchCacheGet(jeCurve_PatchCache *Cache, uint32 PatchID, const jeVec3d G[3][3], int level, jeCurve_Tessellation *Tess) {
+	jeCurve_CacheEntry *Entry;
+	int width;
+	int32 e;
+
+	assert(Cache);
+	assert(Tess);
+	assert(level >= 0 && level <= JE_CURVE_MAX_LEVEL);
+
+	width = LevelToWidth[level];
+
+	if(!Cache->Indices[level] && !PatchCache_BuildIndices(Cache, level))
+		return JE_FALSE;
+
+	e = PatchCache_Find(Cache, PatchID, level);
+
+	if(e >= 0) {
+		Entry = &Cache->Entries[e];
+
+		if(memcmp(Entry->G, G, sizeof(Entry->G)) != 0) {
+			memcpy(Entry->G, G, sizeof(Entry->G));
+			TessellatePatch(G, level, Entry->Points);
+		}
+
+		PatchCache_Unlink(Cache, e);
+	}
+	else {
+		uint32 h;
+
+		if(Cache->NumEntries < Cache->MaxEntries) {
+			e = Cache->NumEntries++;
+			Cache->Entries[e].Level = -1;
+		}
+		else {
+			e = Cache->Tail;
+			PatchCache_Empty(Cache, e);
+			PatchCache_Unlink(Cache, e);
+		}
+
+		Entry = &Cache->Entries[e];
+
+		// Buffers are reused, and only grow
+		if(Entry->MaxPoints < width*width) {
+			jeVec3d *Points = (jeVec3d *)jeRam_Realloc(Entry->Points, width*width*sizeof(jeVec3d));
+
+			if(!Points) {
+				PatchCache_PushBack(Cache, e);
+				return JE_FALSE;
+			}
+
+			Entry->Points = Points;
+			Entry->MaxPoints = width*width;
+		}
+
+		Entry->PatchID = PatchID;
+		Entry->Level = level;
+		memcpy(Entry->G, G, sizeof(Entry->G));
+
+		h = PatchCache_Hash(Cache, PatchID, level);
+		Entry->HashNext = Cache->Hash[h];
+		Cache->Hash[h] = e;
+
+		TessellatePatch(G, level, Entry->Points);
+	}
+
+	PatchCache_PushFront(Cache, e);
+
+	Tess->Points = Entry->Points;
+	Tess->Width = width;
+	Tess->Indices = Cache->Indices[level];
+	Tess->NumIndices = Cache->NumIndices[level];
+
+	return JE_TRUE;
+}
+
+JETAPI void jeCurve_PatchCacheRemove(jeCurve_PatchCache *Cache, uint32 PatchID) {
+	int level;
+
+	assert(Cache);
+
+	for(level = 0; level <= JE_CURVE_MAX_LEVEL; level++) {
+		int32 e = PatchCache_Find(Cache, PatchID, level);
+
+		if(e < 0)
+			continue;
+
+		// Empty entries are the first to be reused
+		PatchCache_Empty(Cache, e);
+		PatchCache_Unlink(Cache, e);
+		PatchCache_PushBack(Cache, e);
+	}
+}
@@ -28,12 +28,43 @@
 extern "C" {
 #endif
 
-
-
+#define JE_CURVE_MAX_LEVEL		6		// Level L gives a (2^(L+1)+1) square grid
 
 JETAPI jeVec3d* QuadraticBezierPatchSubdivide(jeVec3d G[3][3], int level);
 JETAPI void QuadraticBezierSubdivide( jeVec3d G[], int level);
 
+// Grid width for a level
+JETAPI int jeCurve_LevelWidth(int level);
+
+// Lowest level whose flat triangles stay within MaxPixelError pixels of the patch
+// as seen from Eye.  PixelsPerUnit is the projection scale, i.e. the screen size in
+// pixels of one unit at distance 1: (ScreenWidth/2) / tan(Fov/2).
+// Neighbouring patches at different levels do not stitch; use one level per
+// surface where cracks would show.
+JETAPI int jeCurve_SelectLevel(const jeVec3d G[3][3], const jeVec3d *Eye, jeFloat PixelsPerUnit, jeFloat MaxPixelError);
+
+//	Tessellated patches are kept per (PatchID, level) in a cache of MaxEntries
+//	patches, and the least recently used one is dropped when it is full.  An entry
+//	is only rebuilt when its control points change.  The index list is a 16 bit
+//	triangle list into Points, shared by every patch of the same level.
+typedef struct jeCurve_PatchCache	jeCurve_PatchCache;
+
+typedef struct
+{
+	const jeVec3d	*Points;		// Width*Width, row major
+	int32			Width;
+	const uint16	*Indices;
+	int32			NumIndices;
+} jeCurve_Tessellation;
+
+JETAPI jeCurve_PatchCache* jeCurve_PatchCacheCreate(int32 MaxEntries);
+JETAPI void jeCurve_PatchCacheDestroy(jeCurve_PatchCache **Cache);
+
+// The pointers in Tess stay valid until the next call on the cache
+JETAPI jeBoolean jeCurve_PatchCacheGet(jeCurve_PatchCache *Cache, uint32 PatchID, const jeVec3d G[3][3], int level, jeCurve_Tessellation *Tess);
+// Drops every level cached for PatchID
+JETAPI void jeCurve_PatchCacheRemove(jeCurve_PatchCache *Cache, uint32 PatchID);
+
 
 
 #ifdef __cplusplus
@@ -21,7 +21,12 @@
 //
 //	A poor mans sound pool.
 //
+//	Sounds are found by name through a hash index and shared by reference count.
+//	SPool_Find and SPool_Get only read the pool; adding and releasing must not overlap
+//	with anything else.
+//
 #include <string.h>
+#include <ctype.h>
 #include <assert.h>
 #include "Jet.h"
 #include "Ram.h"
@@ -29,6 +34,14 @@
 #include "SPool.h"
 
 
+////////////////////////////////////////////////////////////////////////////////////////
+//	Hash index slot values, other values are DefList index + 1
+////////////////////////////////////////////////////////////////////////////////////////
+#define SPOOL_SLOT_EMPTY	0
+#define SPOOL_SLOT_DELETED	-1
+#define SPOOL_MIN_SLOTS		32
+
+
 ////////////////////////////////////////////////////////////////////////////////////////
 //	Sound pool struct.
 ////////////////////////////////////////////////////////////////////////////////////////
@@ -36,6 +49,9 @@ typedef struct SoundPool
 {
 	jeSound_System	*SoundSystem;
 	IndexList		*DefList;
+	int				*Slots;		// open addressed hash index
+	int				SlotCount;	// power of 2
+	int				SlotsUsed;	// live and deleted slots
 
 } SoundPool;
 
@@ -46,12 +62,165 @@ typedef struct SoundPool
 typedef struct
 {
 	char		*Name;
+	uint32		Hash;
+	int			RefCount;
 	jeSound_Def	*SoundDef;
 
 } SoundInfo;
 
 
 
+////////////////////////////////////////////////////////////////////////////////////////
+//
+//	SPool_HashName()
+//
+//	FNV-1a over the case folded name.
+//
+////////////////////////////////////////////////////////////////////////////////////////
+static uint32 SPool_HashName(
+	const char	*Name )	// name to hash
+{
+	uint32	Hash = 2166136261u;
+
+	while ( *Name != '\0' )
+	{
+		Hash ^= (uint32)tolower( (unsigned char)*Name );
+		Hash *= 16777619u;
+		Name++;
+	}
+
+	return Hash;
+
+} // SPool_HashName()
+
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+//
+//	SPool_HashPlace()
+//
+//	Put a sound into the first free slot of its probe sequence.
+//
+////////////////////////////////////////////////////////////////////////////////////////
+static void SPool_HashPlace(
+	int			*Slots,		// slot array
+	int			SlotCount,	// slot count, power of 2
+	uint32		Hash,		// name hash
+	int			Num )		// sound number
+{
+	int	Index;
+
+	Index = Hash & ( SlotCount - 1 );
+	while ( Slots[Index] > SPOOL_SLOT_EMPTY )
+	{
+		Index = ( Index + 1 ) & ( SlotCount - 1 );
+	}
+	Slots[Index] = Num + 1;
+
+} // SPool_HashPlace()
+
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+//
+//	SPool_HashRebuild()
+//
+//	Rebuild the index with room for at least MinCount sounds, dropping deleted slots.
+//
+////////////////////////////////////////////////////////////////////////////////////////
+static jeBoolean SPool_HashRebuild(
+	SoundPool	*SPool,		// pool to rebuild
+	int			MinCount )	// sounds it must hold
+{
+
+	// locals
+	int			*NewSlots;
+	int			NewCount;
+	int			Count;
+	int			i;
+	SoundInfo	*SInfo;
+
+	// keep the load factor at or under 1/2
+	NewCount = SPOOL_MIN_SLOTS;
+	while ( NewCount < MinCount * 2 )
+	{
+		NewCount <<= 1;
+	}
+
+	NewSlots = jeRam_AllocateClear( NewCount * sizeof( *NewSlots ) );
+	if ( NewSlots == NULL )
+	{
+		return JE_FALSE;
+	}
+
+	SPool->SlotsUsed = 0;
+	Count = IndexList_GetListSize( SPool->DefList );
+	for ( i = 0; i < Count; i++ )
+	{
+		SInfo = IndexList_GetElement( SPool->DefList, i );
+		if ( SInfo != NULL )
+		{
+			SPool_HashPlace( NewSlots, NewCount, SInfo->Hash, i );
+			SPool->SlotsUsed++;
+		}
+	}
+
+	if ( SPool->Slots != NULL )
+	{
+		jeRam_Free( SPool->Slots );
+	}
+	SPool->Slots = NewSlots;
+	SPool->SlotCount = NewCount;
+
+	return JE_TRUE;
+
+} // SPool_HashRebuild()
+
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+//
+//	SPool_FreeSound()
+//
+//	Free a sound def and take it out of the pool.
+//
+////////////////////////////////////////////////////////////////////////////////////////
+static void SPool_FreeSound(
+	SoundPool	*SPool,	// pool it's in
+	int			Num )	// sound number
+{
+
+	// locals
+	SoundInfo	*SInfo;
+	int			Index;
+
+	SInfo = IndexList_GetElement( SPool->DefList, Num );
+	assert( SInfo != NULL );
+
+	// take it out of the index
+	Index = SInfo->Hash & ( SPool->SlotCount - 1 );
+	while ( SPool->Slots[Index] != Num + 1 )
+	{
+		assert( SPool->Slots[Index] != SPOOL_SLOT_EMPTY );
+		Index = ( Index + 1 ) & ( SPool->SlotCount - 1 );
+	}
+	SPool->Slots[Index] = SPOOL_SLOT_DELETED;
+
+	// remove this element
+	IndexList_DeleteElement( SPool->DefList, Num );
+
+	// free the sound
+	jeSound_FreeSoundDef( SPool->SoundSystem, SInfo->SoundDef );
+
+	// free the struct
+	assert( SInfo->Name != NULL );
+	jeRam_Free( SInfo->Name );
+	jeRam_Free( SInfo );
+
+} // SPool_FreeSound()
+
+
+
 ////////////////////////////////////////////////////////////////////////////////////////
 //
 //	SPool_Create()
@@ -85,6 +254,13 @@ SoundPool * SPool_Create(
 		return NULL;
 	}
 
+	// create the name index
+	if ( SPool_HashRebuild( SPool, 0 ) == JE_FALSE )
+	{
+		SPool_Destroy( &SPool );
+		return NULL;
+	}
+
 	// all done
 	SPool->SoundSystem = SoundSystem;
 	return SPool;
@@ -120,42 +296,33 @@ void SPool_Destroy(
 	{
 
 		// locals
-		int			Count;
-		SoundInfo	*SInfo;
+		int	Count;
 
-		// free each one
+		// free each one, whatever its reference count
 		Count = IndexList_GetListSize( DeadSPool->DefList );
 		for ( i = 0; i < Count; i++ )
 		{
-
-			// skip this slot if its empty
-			SInfo = IndexList_GetElement( DeadSPool->DefList, i );
-			if ( SInfo == NULL )
+			if ( IndexList_GetElement( DeadSPool->DefList, i ) != NULL )
 			{
-				continue;
+				SPool_FreeSound( DeadSPool, i );
 			}
-
-			// remove this element
-			IndexList_DeleteElement( DeadSPool->DefList, i );
-
-			// free the sound
-			jeSound_FreeSoundDef( DeadSPool->SoundSystem, SInfo->SoundDef );
-
-			// free the struct
-			assert( SInfo->Name != NULL );
-			jeRam_Free( SInfo->Name );
-			jeRam_Free( SInfo );
 		}
 
 		// free the sound def list
 		IndexList_Destroy( &( DeadSPool->DefList ) );
 	}
 
+	// free the name index
+	if ( DeadSPool->Slots != NULL )
+	{
+		jeRam_Free( DeadSPool->Slots );
+	}
+
 	// free the sound pool
 	jeRam_Free( DeadSPool );
 
 	// zap pointer
-	SPool = NULL;
+	*SPool = NULL;
 
 } // SPool_Destroy()
 
@@ -190,11 +357,55 @@ jeSound_Def * SPool_Get(
 
 
 
+////////////////////////////////////////////////////////////////////////////////////////
+//
+//	SPool_Find()
+//
+//	Find a sound by name, without adding a reference.
+//
+////////////////////////////////////////////////////////////////////////////////////////
+int SPool_Find(
+	SoundPool	*SPool,	// sound pool to search
+	const char	*Name )	// sound name
+{
+
+	// locals
+	uint32		Hash;
+	int			Index;
+	SoundInfo	*SInfo;
+
+	// ensure valid data
+	assert( SPool != NULL );
+	assert( Name != NULL );
+
+	// probe until an empty slot
+	Hash = SPool_HashName( Name );
+	Index = Hash & ( SPool->SlotCount - 1 );
+	while ( SPool->Slots[Index] != SPOOL_SLOT_EMPTY )
+	{
+		if ( SPool->Slots[Index] > SPOOL_SLOT_EMPTY )
+		{
+			SInfo = IndexList_GetElement( SPool->DefList, SPool->Slots[Index] - 1 );
+			assert( SInfo != NULL );
+			if ( ( SInfo->Hash == Hash ) && ( stricmp( Name, SInfo->Name ) == 0 ) )
+			{
+				return SPool->Slots[Index] - 1;
+			}
+		}
+		Index = ( Index + 1 ) & ( SPool->SlotCount - 1 );
+	}
+
+	return -1;
+
+} // SPool_Find()
+
+
+
 ////////////////////////////////////////////////////////////////////////////////////////
 //
 //	SPool_Add()
 //
-//	Add a sound to the sound pool.
+//	Add a sound to the sound pool, or add a reference to it if it's already there.
 //
 ////////////////////////////////////////////////////////////////////////////////////////
 int SPool_Add(
@@ -218,32 +429,30 @@ int SPool_Add(
 	assert( Length > 0 );
 
 	// check if the sound already exists
+	Slot = SPool_Find( SPool, Name );
+	if ( Slot != -1 )
 	{
+		SInfo = IndexList_GetElement( SPool->DefList, Slot );
+		SInfo->RefCount++;
+		return Slot;
+	}
 
-		// locals
-		int	ListSize;
-		int	i;
-
-		// check all currently loaded sound defs
-		ListSize = IndexList_GetListSize( SPool->DefList );
-		for ( i = 0; i < ListSize; i++ )
+	// make sure the index has room, so adding can't fail once the sound exists
+	if ( ( SPool->SlotsUsed + 1 ) * 2 > SPool->SlotCount )
+	{
+		if ( SPool_HashRebuild( SPool, IndexList_GetListSize( SPool->DefList ) + 1 ) == JE_FALSE )
 		{
-			
-			// skip this slot if its empty
-			SInfo = IndexList_GetElement( SPool->DefList, i );
-			if ( SInfo == NULL )
-			{
-				continue;
-			}
-
-			// if its a match then just return the id
-			if ( strnicmp( Name, SInfo->Name, Length ) == 0 )
-			{
-				return i;
-			}
+			return -1;
 		}
 	}
 
+	// get an empty slot in the list
+	Slot = IndexList_GetEmptySlot( SPool->DefList );
+	if ( Slot == -1 )
+	{
+		return -1;
+	}
+
 	// allocate sound info struct
 	SInfo = jeRam_AllocateClear( sizeof( *SInfo ) );
 	if ( SInfo == NULL )
@@ -259,13 +468,8 @@ int SPool_Add(
 		return -1;
 	}
 	strcpy( SInfo->Name, Name );
-
-	// get an empty slot in the list
-	Slot = IndexList_GetEmptySlot( SPool->DefList );
-	if ( Slot == -1 )
-	{
-		return -1;
-	}
+	SInfo->Hash = SPool_HashName( Name );
+	SInfo->RefCount = 1;
 
 	// open the file
 	if ( File == NULL )
@@ -278,6 +482,8 @@ int SPool_Add(
 	}
 	if ( SndFile == NULL )
 	{
+		jeRam_Free( SInfo->Name );
+		jeRam_Free( SInfo );
 		return -1;
 	}
 
@@ -286,13 +492,51 @@ int SPool_Add(
 	jeVFile_Close( SndFile );
 	if ( SInfo->SoundDef == NULL )
 	{
+		jeRam_Free( SInfo->Name );
+		jeRam_Free( SInfo );
 		return -1;
 	}
 
-	// add the sound to the list
+	// add the sound to the list and the index
 	IndexList_AddElement( SPool->DefList, Slot, SInfo );
+	SPool_HashPlace( SPool->Slots, SPool->SlotCount, SInfo->Hash, Slot );
+	SPool->SlotsUsed++;
 
 	// return the index
 	return Slot;
 
 } // SPool_Add()
+
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+//
+//	SPool_Release()
+//
+//	Drop a reference taken by SPool_Add, freeing the sound with the last one.
+//
+////////////////////////////////////////////////////////////////////////////////////////
+void SPool_Release(
+	SoundPool	*SPool,	// sound pool it's in
+	int			Num )	// sound number
+{
+
+	// locals
+	SoundInfo	*SInfo;
+
+	// ensure valid data
+	assert( SPool != NULL );
+	assert( Num >= 0 );
+	assert( Num < IndexList_GetListSize( SPool->DefList ) );
+
+	SInfo = IndexList_GetElement( SPool->DefList, Num );
+	assert( SInfo != NULL );
+	assert( SInfo->RefCount > 0 );
+
+	SInfo->RefCount--;
+	if ( SInfo->RefCount == 0 )
+	{
+		SPool_FreeSound( SPool, Num );
+	}
+
+} // SPool_Release()
@@ -57,7 +57,14 @@ jeSound_Def * SPool_Get(
 	SoundPool	*SPool,	// sound pool to retrieve it from
 	int			Num );	// sound that we want
 
-//	Add a sound to the sound pool.
+//	Find a sound by name, without adding a reference.  Returns -1 if it isn't there.
+//
+////////////////////////////////////////////////////////////////////////////////////////
+int SPool_Find(
+	SoundPool	*SPool,	// sound pool to search
+	const char	*Name );	// sound name
+
+//	Add a sound to the sound pool, or add a reference to it if it's already there.
 //
 ////////////////////////////////////////////////////////////////////////////////////////
 int SPool_Add(
@@ -65,6 +72,13 @@ int SPool_Add(
 	jeVFile		*File,		// file system to use
 	char		*Name );	// sound name
 
+//	Drop a reference taken by SPool_Add, freeing the sound with the last one.
+//
+////////////////////////////////////////////////////////////////////////////////////////
+void SPool_Release(
+	SoundPool	*SPool,	// sound pool it's in
+	int			Num );	// sound number
+
 
 #ifdef __cplusplus
 	}
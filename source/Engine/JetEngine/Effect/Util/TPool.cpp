@@ -21,7 +21,12 @@
 //
 //	A poor mans texture pool.
 //
+//	Textures are found by name through a hash index and shared by reference count.
+//	TPool_Find and TPool_Get only read the pool, so any number of threads may call
+//	them at once; adding and releasing must not overlap with anything else.
+//
 #include <string.h>
+#include <ctype.h>
 #include <assert.h>
 #include "Jet.h"
 #include "BitmapUtil.h"
@@ -30,6 +35,14 @@
 #include "TPool.h"
 
 
+////////////////////////////////////////////////////////////////////////////////////////
+//	Hash index slot values, other values are BmpList index + 1
+////////////////////////////////////////////////////////////////////////////////////////
+#define TPOOL_SLOT_EMPTY	0
+#define TPOOL_SLOT_DELETED	-1
+#define TPOOL_MIN_SLOTS		32
+
+
 ////////////////////////////////////////////////////////////////////////////////////////
 //	Texture pool struct.
 ////////////////////////////////////////////////////////////////////////////////////////
@@ -37,6 +50,9 @@ typedef struct TexturePool
 {
 	IndexList	*BmpList;
 	jeWorld		*World;
+	int			*Slots;		// open addressed hash index
+	int			SlotCount;	// power of 2
+	int			SlotsUsed;	// live and deleted slots
 
 } TexturePool;
 
@@ -47,12 +63,170 @@ typedef struct TexturePool
 typedef struct
 {
 	char		*Name;
+	uint32		Hash;
+	int			RefCount;
 	jeBitmap	*Bmp;
+	jeWorld		*World;		// world the bitmap is attached to, NULL if none
 
 } TextureInfo;
 
 
 
+////////////////////////////////////////////////////////////////////////////////////////
+//
+//	TPool_HashName()
+//
+//	FNV-1a over the case folded name.
+//
+////////////////////////////////////////////////////////////////////////////////////////
+static uint32 TPool_HashName(
+	const char	*Name )	// name to hash
+{
+	uint32	Hash = 2166136261u;
+
+	while ( *Name != '\0' )
+	{
+		Hash ^= (uint32)tolower( (unsigned char)*Name );
+		Hash *= 16777619u;
+		Name++;
+	}
+
+	return Hash;
+
+} // TPool_HashName()
+
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+//
+//	TPool_HashPlace()
+//
+//	Put a texture into the first free slot of its probe sequence.
+//
+////////////////////////////////////////////////////////////////////////////////////////
+static void TPool_HashPlace(
+	int			*Slots,		// slot array
+	int			SlotCount,	// slot count, power of 2
+	uint32		Hash,		// name hash
+	int			Num )		// texture number
+{
+	int	Index;
+
+	Index = Hash & ( SlotCount - 1 );
+	while ( Slots[Index] > TPOOL_SLOT_EMPTY )
+	{
+		Index = ( Index + 1 ) & ( SlotCount - 1 );
+	}
+	Slots[Index] = Num + 1;
+
+} // TPool_HashPlace()
+
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+//
+//	TPool_HashRebuild()
+//
+//	Rebuild the index with room for at least MinCount textures, dropping deleted slots.
+//
+////////////////////////////////////////////////////////////////////////////////////////
+static jeBoolean TPool_HashRebuild(
+	TexturePool	*TPool,		// pool to rebuild
+	int			MinCount )	// textures it must hold
+{
+
+	// locals
+	int			*NewSlots;
+	int			NewCount;
+	int			Count;
+	int			i;
+	TextureInfo	*TInfo;
+
+	// keep the load factor at or under 1/2
+	NewCount = TPOOL_MIN_SLOTS;
+	while ( NewCount < MinCount * 2 )
+	{
+		NewCount <<= 1;
+	}
+
+	NewSlots = jeRam_AllocateClear( NewCount * sizeof( *NewSlots ) );
+	if ( NewSlots == NULL )
+	{
+		return JE_FALSE;
+	}
+
+	TPool->SlotsUsed = 0;
+	Count = IndexList_GetListSize( TPool->BmpList );
+	for ( i = 0; i < Count; i++ )
+	{
+		TInfo = IndexList_GetElement( TPool->BmpList, i );
+		if ( TInfo != NULL )
+		{
+			TPool_HashPlace( NewSlots, NewCount, TInfo->Hash, i );
+			TPool->SlotsUsed++;
+		}
+	}
+
+	if ( TPool->Slots != NULL )
+	{
+		jeRam_Free( TPool->Slots );
+	}
+	TPool->Slots = NewSlots;
+	TPool->SlotCount = NewCount;
+
+	return JE_TRUE;
+
+} // TPool_HashRebuild()
+
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+//
+//	TPool_FreeTexture()
+//
+//	Detach and destroy a texture and take it out of the pool.
+//
+////////////////////////////////////////////////////////////////////////////////////////
+static void TPool_FreeTexture(
+	TexturePool	*TPool,	// pool it's in
+	int			Num )	// texture number
+{
+
+	// locals
+	TextureInfo	*TInfo;
+	int			Index;
+
+	TInfo = IndexList_GetElement( TPool->BmpList, Num );
+	assert( TInfo != NULL );
+
+	// take it out of the index
+	Index = TInfo->Hash & ( TPool->SlotCount - 1 );
+	while ( TPool->Slots[Index] != Num + 1 )
+	{
+		assert( TPool->Slots[Index] != TPOOL_SLOT_EMPTY );
+		Index = ( Index + 1 ) & ( TPool->SlotCount - 1 );
+	}
+	TPool->Slots[Index] = TPOOL_SLOT_DELETED;
+
+	// remove this element
+	IndexList_DeleteElement( TPool->BmpList, Num );
+
+	// free the texture
+	if ( TInfo->World != NULL )
+	{
+		jeWorld_RemoveBitmap( TInfo->World, TInfo->Bmp );
+	}
+	jeBitmap_Destroy( &( TInfo->Bmp ) );
+
+	// free the struct
+	assert( TInfo->Name != NULL );
+	jeRam_Free( TInfo->Name );
+	jeRam_Free( TInfo );
+
+} // TPool_FreeTexture()
+
+
+
 ////////////////////////////////////////////////////////////////////////////////////////
 //
 //	TPool_Create()
@@ -85,6 +259,13 @@ TexturePool * TPool_Create(
 		return NULL;
 	}
 
+	// create the name index
+	if ( TPool_HashRebuild( TPool, 0 ) == JE_FALSE )
+	{
+		TPool_Destroy( &TPool );
+		return NULL;
+	}
+
 	// all done
 	TPool->World = World;
 	return TPool;
@@ -120,43 +301,33 @@ void TPool_Destroy(
 	{
 
 		// locals
-		int			Count;
-		TextureInfo	*TInfo;
+		int	Count;
 
-		// free each one
+		// free each one, whatever its reference count
 		Count = IndexList_GetListSize( DeadTPool->BmpList );
 		for ( i = 0; i < Count; i++ )
 		{
-
-			// skip this slot if its empty
-			TInfo = IndexList_GetElement( DeadTPool->BmpList, i );
-			if ( TInfo == NULL )
+			if ( IndexList_GetElement( DeadTPool->BmpList, i ) != NULL )
 			{
-				continue;
+				TPool_FreeTexture( DeadTPool, i );
 			}
-
-			// remove this element
-			IndexList_DeleteElement( DeadTPool->BmpList, i );
-
-			// free the texture
-			jeWorld_RemoveBitmap( DeadTPool->World, TInfo->Bmp );
-			jeBitmap_Destroy( &( TInfo->Bmp ) );
-
-			// free the struct
-			assert( TInfo->Name != NULL );
-			jeRam_Free( TInfo->Name );
-			jeRam_Free( TInfo );
 		}
 
 		// free the bitmap list
-		jeRam_Free( DeadTPool->BmpList );
+		IndexList_Destroy( &( DeadTPool->BmpList ) );
+	}
+
+	// free the name index
+	if ( DeadTPool->Slots != NULL )
+	{
+		jeRam_Free( DeadTPool->Slots );
 	}
 
 	// free the texture pool
 	jeRam_Free( DeadTPool );
 
 	// zap pointer
-	TPool = NULL;
+	*TPool = NULL;
 
 } // TPool_Destroy()
 
@@ -191,6 +362,50 @@ jeBitmap * TPool_Get(
 
 
 
+////////////////////////////////////////////////////////////////////////////////////////
+//
+//	TPool_Find()
+//
+//	Find a texture by name, without adding a reference.
+//
+////////////////////////////////////////////////////////////////////////////////////////
+int TPool_Find(
+	TexturePool	*TPool,	// texture pool to search
+	const char	*Name )	// texture name
+{
+
+	// locals
+	uint32		Hash;
+	int			Index;
+	TextureInfo	*TInfo;
+
+	// ensure valid data
+	assert( TPool != NULL );
+	assert( Name != NULL );
+
+	// probe until an empty slot
+	Hash = TPool_HashName( Name );
+	Index = Hash & ( TPool->SlotCount - 1 );
+	while ( TPool->Slots[Index] != TPOOL_SLOT_EMPTY )
+	{
+		if ( TPool->Slots[Index] > TPOOL_SLOT_EMPTY )
+		{
+			TInfo = IndexList_GetElement( TPool->BmpList, TPool->Slots[Index] - 1 );
+			assert( TInfo != NULL );
+			if ( ( TInfo->Hash == Hash ) && ( stricmp( Name, TInfo->Name ) == 0 ) )
+			{
+				return TPool->Slots[Index] - 1;
+			}
+		}
+		Index = ( Index + 1 ) & ( TPool->SlotCount - 1 );
+	}
+
+	return -1;
+
+} // TPool_Find()
+
+
+
 ////////////////////////////////////////////////////////////////////////////////////////
 //
 //	TPool_ChangeWorld()
@@ -205,7 +420,6 @@ void TPool_ChangeWorld(
 
 	// locals
 	int			i;
-	jeBoolean	Result;
 	int			Count;
 	TextureInfo	*TInfo;
 
@@ -213,25 +427,25 @@ void TPool_ChangeWorld(
 	assert( TPool != NULL );
 	assert( World != NULL );
 
-	// remove each bitmap from current world and insert it into new one
+	// move only the bitmaps that aren't in the new world yet
 	Count = IndexList_GetListSize( TPool->BmpList );
 	for ( i = 0; i < Count; i++ )
 	{
 
-		// skip this slot if its empty
+		// skip this slot if its empty or already attached
 		TInfo = IndexList_GetElement( TPool->BmpList, i );
-		if ( TInfo == NULL )
+		if ( ( TInfo == NULL ) || ( TInfo->World == World ) )
 		{
 			continue;
 		}
 
 		// remove it and reinsert it into new world
-		Result = jeWorld_RemoveBitmap( TPool->World, TInfo->Bmp );
-		assert( Result == JE_TRUE );
-		// this was a bug: FM
-		//Result = jeWorld_AddBitmap( TPool->World, TInfo->Bmp );
-		Result = jeWorld_AddBitmap( World, TInfo->Bmp );
-		assert( Result == JE_TRUE );
+		if ( TInfo->World != NULL )
+		{
+			jeWorld_RemoveBitmap( TInfo->World, TInfo->Bmp );
+		}
+		TInfo->World = ( jeWorld_AddBitmap( World, TInfo->Bmp ) == JE_TRUE ) ? World : NULL;
+		assert( TInfo->World != NULL );
 	}
 
 	// save new world pointer
@@ -245,7 +459,7 @@ void TPool_ChangeWorld(
 //
 //	TPool_Add()
 //
-//	Add a texture to the texture pool.
+//	Add a texture to the texture pool, or add a reference to it if it's already there.
 //
 ////////////////////////////////////////////////////////////////////////////////////////
 int TPool_Add(
@@ -269,29 +483,20 @@ int TPool_Add(
 	assert( Length > 0 );
 
 	// check if the texture already exists
+	Slot = TPool_Find( TPool, Name );
+	if ( Slot != -1 )
 	{
+		TInfo = IndexList_GetElement( TPool->BmpList, Slot );
+		TInfo->RefCount++;
+		return Slot;
+	}
 
-		// locals
-		int	ListSize;
-		int	i;
-
-		// check all currently loaded textures
-		ListSize = IndexList_GetListSize( TPool->BmpList );
-		for ( i = 0; i < ListSize; i++ )
+	// make sure the index has room, so adding can't fail once the texture exists
+	if ( ( TPool->SlotsUsed + 1 ) * 2 > TPool->SlotCount )
+	{
+		if ( TPool_HashRebuild( TPool, IndexList_GetListSize( TPool->BmpList ) + 1 ) == JE_FALSE )
 		{
-			
-			// skip this slot if its empty
-			TInfo = IndexList_GetElement( TPool->BmpList, i );
-			if ( TInfo == NULL )
-			{
-				continue;
-			}
-
-			// if its a match then just return the id
-			if ( strnicmp( Name, TInfo->Name, Length ) == 0 )
-			{
-				return i;
-			}
+			return -1;
 		}
 	}
 
@@ -317,6 +522,8 @@ int TPool_Add(
 		return -1;
 	}
 	strcpy( TInfo->Name, Name );
+	TInfo->Hash = TPool_HashName( Name );
+	TInfo->RefCount = 1;
 
 	// create the texture
 	TInfo->Bmp = BitmapUtil_CreateFromFileName( File, Name, AlphaName, JE_FALSE, JE_FALSE );
@@ -326,12 +533,51 @@ int TPool_Add(
 		jeRam_Free( TInfo );
 		return -1;
 	}
-	jeWorld_AddBitmap( TPool->World, TInfo->Bmp );
+	if ( jeWorld_AddBitmap( TPool->World, TInfo->Bmp ) == JE_TRUE )
+	{
+		TInfo->World = TPool->World;
+	}
 
-	// add texture to the list
+	// add texture to the list and the index
 	IndexList_AddElement( TPool->BmpList, Slot, TInfo );
+	TPool_HashPlace( TPool->Slots, TPool->SlotCount, TInfo->Hash, Slot );
+	TPool->SlotsUsed++;
 
 	// return the index
 	return Slot;
 
 } // TPool_Add()
+
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+//
+//	TPool_Release()
+//
+//	Drop a reference taken by TPool_Add, freeing the texture with the last one.
+//
+////////////////////////////////////////////////////////////////////////////////////////
+void TPool_Release(
+	TexturePool	*TPool,	// texture pool it's in
+	int			Num )	// texture number
+{
+
+	// locals
+	TextureInfo	*TInfo;
+
+	// ensure valid data
+	assert( TPool != NULL );
+	assert( Num >= 0 );
+	assert( Num < IndexList_GetListSize( TPool->BmpList ) );
+
+	TInfo = IndexList_GetElement( TPool->BmpList, Num );
+	assert( TInfo != NULL );
+	assert( TInfo->RefCount > 0 );
+
+	TInfo->RefCount--;
+	if ( TInfo->RefCount == 0 )
+	{
+		TPool_FreeTexture( TPool, Num );
+	}
+
+} // TPool_Release()
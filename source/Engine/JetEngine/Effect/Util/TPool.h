@@ -57,6 +57,13 @@ jeBitmap * TPool_Get(
 	TexturePool	*TPool,	// texture pool to retrieve it from
 	int			Num );	// texture that we want
 
+//	Find a texture by name, without adding a reference.  Returns -1 if it isn't there.
+//
+////////////////////////////////////////////////////////////////////////////////////////
+int TPool_Find(
+	TexturePool	*TPool,	// texture pool to search
+	const char	*Name );	// texture name
+
 //	Change the world that the textures are tied to.
 //
 ////////////////////////////////////////////////////////////////////////////////////////
@@ -64,7 +71,7 @@ void TPool_ChangeWorld(
 	TexturePool	*TPool,		// texture pool whose world will change
 	jeWorld		*World );	// the new world
 
-//	Add a texture to the texture pool.
+//	Add a texture to the texture pool, or add a reference to it if it's already there.
 //
 ////////////////////////////////////////////////////////////////////////////////////////
 int TPool_Add(
@@ -73,6 +80,13 @@ int TPool_Add(
 	char		*Name,			// texture name
 	char		*AlphaName );	// name of alpha
 
+//	Drop a reference taken by TPool_Add, freeing the texture with the last one.
+//
+////////////////////////////////////////////////////////////////////////////////////////
+void TPool_Release(
+	TexturePool	*TPool,	// texture pool it's in
+	int			Num );	// texture number
+
 
 #ifdef __cplusplus
 	}
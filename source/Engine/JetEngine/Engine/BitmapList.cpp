@@ -38,12 +38,19 @@
 #include "MemPool.h"
 #include "Errorlog.h"
 #include "Ram.h"
+#include "jeParallel.h"
 //#include "tsc.h"
 
 struct BitmapList
 {
 	Hash * HashPtr; // CJP : Modified to not be Hash* Hash
 	int Members,Adds;
+
+	// Members AttachAll still has to attach to Driver, oldest first
+	jeBitmap ** Pending;
+	int NumPending,MaxPending;
+	DRV_Driver * Driver;
+	int AttachBudget;		// most bitmaps attached per AttachAll; 0 = no limit
 #ifdef _DEBUG
 	BitmapList * MySelf;
 #endif
@@ -52,6 +59,65 @@ struct BitmapList
 
 jeBoolean BitmapList_IsValid(BitmapList *pList);
 
+//================================================================================
+//	Pending list
+//================================================================================
+static jeBoolean BitmapList_Queue(BitmapList *pList, jeBitmap *Bmp)
+{
+	if ( pList->NumPending == pList->MaxPending )
+	{
+	jeBitmap ** NewPending;
+	int NewMax;
+
+		NewMax = pList->MaxPending ? pList->MaxPending * 2 : 64;
+		NewPending = (jeBitmap **)jeRam_Realloc(pList->Pending, sizeof(jeBitmap *) * NewMax);
+		if ( ! NewPending )
+			return JE_FALSE;
+		pList->Pending = NewPending;
+		pList->MaxPending = NewMax;
+	}
+
+	pList->Pending[pList->NumPending ++] = Bmp;
+
+	return JE_TRUE;
+}
+
+static void BitmapList_Unqueue(BitmapList *pList, jeBitmap *Bmp)
+{
+int i;
+
+	for(i=0;i<pList->NumPending;i++)
+	{
+		if ( pList->Pending[i] == Bmp )
+		{
+			pList->NumPending --;
+			memmove(pList->Pending + i, pList->Pending + i + 1, sizeof(jeBitmap *) * (pList->NumPending - i));
+			return;
+		}
+	}
+}
+
+static jeBoolean BitmapList_QueueAll(BitmapList *pList)
+{
+HashNode *pNode;
+
+	pList->NumPending = 0;
+
+	pNode = NULL;
+	while( (pNode = Hash_WalkNext(pList->HashPtr,pNode)) != NULL )
+	{
+		if ( ! BitmapList_Queue(pList, (jeBitmap *)HashNode_Key(pNode)) )
+			return JE_FALSE;
+	}
+
+	return JE_TRUE;
+}
+
+static void BitmapList_ConvertJob(int32 Index, void *Context)
+{
+	jeBitmap_AttachToDriver_Convert((jeBitmap_AttachJob *)Context + Index);
+}
+
 //================================================================================
 //	BitmapList_Create
 //================================================================================
@@ -117,6 +183,9 @@ jeBoolean	Ret = JE_TRUE;
 		Hash_Destroy(pList->HashPtr);
 	}
 
+	if ( pList->Pending )
+		jeRam_Free(pList->Pending);
+
 	jeRam_Free(pList);
 
 	return Ret;
@@ -157,44 +226,116 @@ return JE_TRUE;
 
 //================================================================================
 //	BitmapList_AttachAll
+//	Attaches the pending members in three passes : set up each one, convert all of
+//	their bits at once on the jeParallel pool, then hand them to the driver in one batch.
 //================================================================================
 jeBoolean BitmapList_AttachAll(BitmapList *pList, DRV_Driver *Driver, jeFloat Gamma)
 {
-HashNode *pNode;
-int MembersAttached;
+jeBitmap_AttachJob *Jobs;
+jeBoolean Ret;
+int i,Count,Begun,Kept;
 
 	assert(BitmapList_IsValid(pList));
 
 	//pushTSC();
 
-	pNode = NULL;
-	MembersAttached = 0;
-	while( (pNode = Hash_WalkNext(pList->HashPtr,pNode)) != NULL )
+	if ( Driver != pList->Driver )
+	{
+		// new driver or new mode : everyone has to be attached again
+		if ( ! BitmapList_QueueAll(pList) )
+		{
+			jeErrorLog_AddString(-1,"BitmapList_AttachAll : out of memory", NULL);
+			return JE_FALSE;
+		}
+		pList->Driver = Driver;
+	}
+
+	if ( pList->NumPending == 0 )
+		return JE_TRUE;
+
+	Count = pList->NumPending;
+	if ( pList->AttachBudget > 0 && Count > pList->AttachBudget )
+		Count = pList->AttachBudget;
+
+	Jobs = (jeBitmap_AttachJob *)jeRam_AllocateClear(sizeof(jeBitmap_AttachJob) * Count);
+	if ( ! Jobs )
+	{
+		jeErrorLog_AddString(-1,"BitmapList_AttachAll : out of memory", NULL);
+		return JE_FALSE;
+	}
+
+	Ret = JE_TRUE;
+
+	for(Begun=0;Begun<Count;Begun++)
 	{
 	jeBitmap *Bmp;
 
-		Bmp = (jeBitmap *)HashNode_Key(pNode);
+		Bmp = pList->Pending[Begun];
 
 		if (!jeBitmap_SetGammaCorrection_DontChange(Bmp, Gamma) )
 		{
 			jeErrorLog_AddString(-1,"BitmapList_AttachAll : SetGamma failed", NULL);
-			return JE_FALSE;
+			Ret = JE_FALSE;
+			break;
 		}
 
-		if (!jeBitmap_AttachToDriver(Bmp, Driver, 0) )
+		if (!jeBitmap_AttachToDriver_Begin(Bmp, Driver, 0, &Jobs[Begun]) )
 		{
 			jeErrorLog_AddString(-1,"BitmapList_AttachAll : AttachToDriver failed", NULL);
-			return JE_FALSE;
+			Ret = JE_FALSE;
+			break;
 		}
+	}
+
+	jeParallel_For(Begun, BitmapList_ConvertJob, Jobs);
+
+	if ( ! jeBitmap_AttachToDriver_Upload(Driver, Jobs, Begun) )
+	{
+		jeErrorLog_AddString(-1,"BitmapList_AttachAll : Upload failed", NULL);
+		Ret = JE_FALSE;
+	}
 
-		MembersAttached ++;
+	// the ones that failed stay pending, so they're tried again next time like before
+	Kept = 0;
+	for(i=0;i<Begun;i++)
+	{
+		if ( ! jeBitmap_AttachToDriver_End(&Jobs[i]) )
+		{
+			jeErrorLog_AddString(-1,"BitmapList_AttachAll : AttachToDriver failed", NULL);
+			Ret = JE_FALSE;
+			pList->Pending[Kept++] = pList->Pending[i];
+		}
 	}
 
+	jeRam_Free(Jobs);
+
+	memmove(pList->Pending + Kept, pList->Pending + Begun, sizeof(jeBitmap *) * (pList->NumPending - Begun));
+	pList->NumPending -= Begun - Kept;
+
 	//showPopTSC("BitmapList_AttachAll");
 
-	assert( MembersAttached == pList->Members );
+	return Ret;
+}
 
-	return JE_TRUE;
+//================================================================================
+//	BitmapList_SetAttachBudget
+//================================================================================
+void BitmapList_SetAttachBudget(BitmapList *pList, int Budget)
+{
+	assert(BitmapList_IsValid(pList));
+	assert(Budget >= 0);
+
+	pList->AttachBudget = Budget;
+}
+
+//================================================================================
+//	BitmapList_CountPending
+//================================================================================
+int BitmapList_CountPending(BitmapList *pList)
+{
+	assert(BitmapList_IsValid(pList));
+
+	return pList->NumPending;
 }
 
 //================================================================================
@@ -222,6 +363,9 @@ int MembersAttached;
 
 	MembersAttached = 0;
 
+	// the next AttachAll starts over
+	pList->Driver = NULL;
+
 	return Ret;
 }
 
@@ -314,6 +458,11 @@ uint32 TimesAdded;
 	{
 		pList->Members ++;
 		Hash_Add(pList->HashPtr,(uint32)Bitmap,1);
+		if ( ! BitmapList_Queue(pList, Bitmap) )
+		{
+			// AttachAll won't see it until the driver changes
+			jeErrorLog_AddString(-1,"BitmapList_Add : out of memory", NULL);
+		}
 		return JE_TRUE;
 	}
 }
@@ -340,6 +489,8 @@ uint32 Key;
 
 	if ( TimesAdded <= 0 )
 	{
+		BitmapList_Unqueue(pList, Bitmap);
+
 		if ( ! jeBitmap_DetachDriver(Bitmap, JE_TRUE) )
 		{
 			jeErrorLog_AddString(-1, "BitmapList_Remove:  jeBitmap_DetachDriver failed.", NULL);
@@ -371,6 +522,9 @@ jeBoolean BitmapList_IsValid(BitmapList *pList)
 	if ( pList->Adds < pList->Members )
 		return JE_FALSE;
 
+	if ( pList->NumPending > pList->Members )
+		return JE_FALSE;
+
 #ifdef _DEBUG
 	if ( pList->MySelf != pList )
 		return JE_FALSE;
@@ -39,6 +39,12 @@ jeBoolean BitmapList_SetGamma(BitmapList *pList, jeFloat Gamma);
 jeBoolean BitmapList_AttachAll(BitmapList *pList, DRV_Driver *Drivera, jeFloat Gamma);
 jeBoolean BitmapList_DetachAll(BitmapList *pList);
 
+	// AttachAll only attaches members that are new or were dropped by a driver change,
+	//	and at most Budget of them per call (0, the default, means all of them).
+	//	The rest stay pending, without a THandle, until a later AttachAll.
+void BitmapList_SetAttachBudget(BitmapList *pList, int Budget);
+int  BitmapList_CountPending(BitmapList *pList);
+
 	// _Add & _Remove do NOT return Ok/NOk	
 jeBoolean BitmapList_Add(BitmapList *pList, jeBitmap *Bitmap);	// returns Was It New ?
 jeBoolean BitmapList_Remove(BitmapList *pList,jeBitmap *Bitmap);// returns Was It Removed ?
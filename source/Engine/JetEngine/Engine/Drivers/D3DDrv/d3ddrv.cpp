@@ -369,7 +369,9 @@ DRV_Driver D3DDRV =
 	NULL,
 	NULL,
 
-	D3DMain_SetRenderState
+	D3DMain_SetRenderState,
+
+	NULL		// THandle_UploadBatch
 };
 
 static BOOL DriverHook(DRV_Driver **Driver)
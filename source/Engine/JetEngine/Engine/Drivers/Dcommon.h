@@ -97,10 +97,10 @@ typedef struct tagRECT
 #endif
 
 #define DRV_VERSION_MAJOR		200			// Jet 2.0
-#define DRV_VERSION_MINOR		4			// version 3 has specular rgb in the verts ; 4 has bigger debug info
+#define DRV_VERSION_MINOR		5			// version 3 has specular rgb in the verts ; 4 has bigger debug info ; 5 has THandle_UploadBatch
 #define DRV_VMAJS				"200"
-#define DRV_VMINS				"4" 
-#define DRV_VMAJS_PLUS_DRV_VMINS	"200.4"
+#define DRV_VMINS				"5" 
+#define DRV_VMAJS_PLUS_DRV_VMINS	"200.5"
 
 
 #ifndef US_TYPEDEFS
@@ -432,6 +432,24 @@ typedef jeTexture *DRIVERCC GET_ALPHA(jeTexture *THandle);
 typedef jeBoolean DRIVERCC THANDLE_GET_INFO(jeTexture *THandle, int32 MipLevel, jeTexture_Info *Info);
 // END - jeTexture implementation - paradoxnj 5/12/2005
 
+// BEGIN - Batched texture upload
+// One mip worth of bits already in the THandle's pixel format.  Stride is in bytes
+// and may differ from what THandle_Lock would hand out; only RowBytes of each row are used.
+typedef struct
+{
+	jeTexture			*THandle;
+	int32				MipLevel;
+	const void			*Bits;
+	int32				Stride;
+	int32				RowBytes;
+	int32				Height;
+} DRV_TextureUpload;
+
+// Writes every upload before returning.  May be NULL, in which case the engine
+// falls back to THandle_Lock / THandle_UnLock per mip.
+typedef jeBoolean DRIVERCC UPLOAD_TEXTURES(const DRV_TextureUpload *Uploads, int32 NumUploads);
+// END - Batched texture upload
+
 // Scene management functions
 typedef jeBoolean DRIVERCC BEGIN_SCENE(jeBoolean Clear, jeBoolean ClearZ, RECT *WorldRect, jeBoolean Wireframe);
 typedef jeBoolean DRIVERCC END_SCENE(void);
@@ -583,6 +601,10 @@ typedef struct
 	// BEGIN - Render state access - paradoxnj 12/25/2005
 	SET_RENDER_STATE	*SetRenderState;
 	// END - Render state access - paradoxnj 12/25/2005
+
+	// BEGIN - Batched texture upload
+	UPLOAD_TEXTURES		*THandle_UploadBatch;
+	// END - Batched texture upload
 } DRV_Driver;
 
 enum jeRenderState
@@ -936,7 +936,9 @@ JETAPI jeBoolean JETCC jeEngine_AddBitmap(jeEngine *Engine, jeBitmap *Bitmap, je
 	// Add bitmap to the list of bitmaps attached to the engine
 	if ( BitmapList_Add(Engine->AttachedBitmaps, (jeBitmap *)Bitmap) )
 	{
-		if ( Engine->DriverInfo.RDriver )
+		// with a budget, 3d bitmaps are left to the batched attach in BeginFrame
+		//	(2d ones get drawn without checking for a THandle)
+		if ( Engine->DriverInfo.RDriver && (Type == JE_ENGINE_BITMAP_TYPE_2D || Engine->BitmapAttachBudget == 0) )
 		{
 			if ( ! jeBitmap_AttachToDriver(Bitmap,Engine->DriverInfo.RDriver,0) )
 			{
@@ -949,6 +951,34 @@ JETAPI jeBoolean JETCC jeEngine_AddBitmap(jeEngine *Engine, jeBitmap *Bitmap, je
 	return JE_TRUE;
 }
 
+//================================================================================
+//	jeEngine_SetBitmapAttachBudget
+//================================================================================
+JETAPI jeBoolean JETCC jeEngine_SetBitmapAttachBudget(jeEngine *Engine, int32 PerFrame)
+{
+	assert( jeEngine_IsValid(Engine) );
+	assert(Engine->AttachedBitmaps);
+
+	if ( PerFrame < 0 )
+		return JE_FALSE;
+
+	Engine->BitmapAttachBudget = PerFrame;
+	BitmapList_SetAttachBudget(Engine->AttachedBitmaps, PerFrame);
+
+	return JE_TRUE;
+}
+
+//================================================================================
+//	jeEngine_GetBitmapsPending
+//================================================================================
+JETAPI int32 JETCC jeEngine_GetBitmapsPending(const jeEngine *Engine)
+{
+	assert( jeEngine_IsValid(Engine) );
+	assert(Engine->AttachedBitmaps);
+
+	return BitmapList_CountPending(Engine->AttachedBitmaps);
+}
+
 //================================================================================
 //	jeEngine_RemoveBitmap
 //================================================================================
@@ -1002,13 +1032,16 @@ JETAPI void JETCC jeEngine_RenderPoly(const jeEngine *Engine,
 			if (bmp == nullptr) return;
 			TH = jeBitmap_GetTHandle(bmp);
 		}
-		assert(TH);
-
-		Layer.THandle = TH;
 
 		Flags |= Engine->DefaultRenderFlags;
 
-		Ret = Engine->DriverInfo.RDriver->RenderMiscTexturePoly((jeTLVertex *)Points, NumPoints, &Layer, 1, Flags);
+		if (TH)
+		{
+			Layer.THandle = TH;
+			Ret = Engine->DriverInfo.RDriver->RenderMiscTexturePoly((jeTLVertex *)Points, NumPoints, &Layer, 1, Flags);
+		}
+		else	// bitmap not attached yet (see jeEngine_SetBitmapAttachBudget)
+			Ret = Engine->DriverInfo.RDriver->RenderGouraudPoly((jeTLVertex *)Points, NumPoints, Flags);
 	}
 	else
 	{
@@ -1025,6 +1058,7 @@ JETAPI void JETCC jeEngine_RenderPolyArray(const jeEngine *Engine, const jeTLVer
 	int				pn{};
 	DRV_Driver* Driver{};
 	jeRDriver_Layer Layer{};
+	jeTexture* TH{};
 
 
 	assert(jeEngine_IsValid(Engine));
@@ -1036,14 +1070,19 @@ JETAPI void JETCC jeEngine_RenderPolyArray(const jeEngine *Engine, const jeTLVer
 
 	if ( Texture )
 	{
-		jeTexture* TH{};
-	
 		TH = jeMaterialSpec_GetLayerTexture(Texture, 0);
-		assert(TH);
-
-		Layer.THandle = TH;
+		if (TH==nullptr) {
+			jeBitmap* bmp = jeMaterialSpec_GetLayerBitmap(Texture, 0);
+			if (bmp == nullptr) return;
+			TH = jeBitmap_GetTHandle(bmp);	// NULL until attached (see jeEngine_SetBitmapAttachBudget)
+		}
 
 		Flags |= Engine->DefaultRenderFlags;
+	}
+
+	if ( TH )
+	{
+		Layer.THandle = TH;
 
 		for(pn=0;pn<NumPolys;pn++)
 		{
@@ -1503,6 +1542,7 @@ JETAPI jeBoolean JETCC jeEngine_ShutdownDriver(jeEngine *Engine)
 
 	DrvInfo->RDriver = nullptr;
 	DrvInfo->DriverHandle = (int32)NULL;
+	memset(&DrvInfo->DeviceCaps, 0, sizeof(DrvInfo->DeviceCaps));
 
 	return JE_TRUE;
 }
@@ -1844,6 +1884,9 @@ static jeBoolean Engine_InitDriver(	jeEngine		*Engine,
 
 	Engine->hWnd = hWnd;		// Store the new hWnd
 
+	// The caps only change with the driver or mode, so don't ask the driver every time they are needed
+	RDriver->GetDeviceCaps(&DrvInfo->DeviceCaps);
+
 #if (DEBUG_OUTPUT_LEVEL >= 1)
 	OutputDebugString("BEGIN StartupDriverCB\n");
 #endif
@@ -1872,6 +1915,7 @@ static jeBoolean Engine_InitDriver(	jeEngine		*Engine,
 	Failure:
 	#pragma message("need better clean up on failure (restore previous mode)")
 	DrvInfo->RDriver = nullptr;
+	memset(&DrvInfo->DeviceCaps, 0, sizeof(DrvInfo->DeviceCaps));
 	return JE_FALSE;
 }
 
@@ -2405,7 +2449,7 @@ JETAPI jeBoolean JETCC jeEngine_GetDeviceCaps(jeEngine *pEngine, jeDeviceCaps *D
 	DeviceCaps->SuggestedDefaultRenderFlags = JE_RENDER_FLAG_BILINEAR_FILTER;
 	DeviceCaps->CanChangeRenderFlags = 0xFFFFFFFF;
 #else
-	pEngine->DriverInfo.RDriver->GetDeviceCaps(DeviceCaps);
+	*DeviceCaps = pEngine->DriverInfo.DeviceCaps;
 #endif
 
 	return JE_TRUE;
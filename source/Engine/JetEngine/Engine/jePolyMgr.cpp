@@ -36,6 +36,10 @@
 
 #define JE_POLYMGR_MAX_REFCOUNTS			(0xffffffff>>1)
 
+// NOTE - Nothing creates a jePolyMgr today (the jeBrush/jeWorld uses are commented out), and
+//	USE_BATCHING is never defined.  A growable arena with a depth/state radix sort is deferred
+//	until something draws through here AND the driver has a multi-poly entry point; the
+//	driver only takes one poly per Render*Poly call, so runs can't be issued as one call yet.
 #define JE_POLYMGR_MAX_BATCHED_POLYS			256		// Max polys before an auto-flush is performed
 #define JE_POLYMGR_MAX_BATCHED_VERTS			256		// Max verts before an auto-flush is performed
 
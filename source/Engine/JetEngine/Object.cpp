@@ -22,6 +22,7 @@
 #include <string.h>
 #include <assert.h>
 #include "Object.h"
+#include "jeWorld.h"
 #include "Errorlog.h"
 #include "Ram.h"
 #include "crc32.h"
@@ -44,6 +45,21 @@ __inline void ObjectError(const char* str, const jeObject* Obz)
 	jeErrorLog_AddString(-1, msg, (((Obz) != nullptr) ? (((jeObject *)(Obz))->Name) : "Unknown"));
 }
 
+// Tells the world indexing Object (or one of its ancestors) that its extents may have changed
+static void jeObject_UpdateWorld(const jeObject *Object)
+{
+	const jeObject	*Ancestor;
+
+	for (Ancestor = Object; Ancestor; Ancestor = Ancestor->Parent)
+	{
+		if (Ancestor->CollisionWorld)
+		{
+			jeWorld_UpdateObject(Ancestor->CollisionWorld, Object);
+			return;
+		}
+	}
+}
+
 
 /*}{********************** Manager Functions ******************/
 
@@ -577,7 +593,13 @@ JETAPI jeBoolean	JETCC jeObject_SetProperty(jeObject *Object, int32 FieldID, PRO
 	if (!Object->Methods->SetProperty)
 		return JE_FALSE;
 
-	return Object->Methods->SetProperty(Object->Instance, FieldID, DataType, pData );
+	if (!Object->Methods->SetProperty(Object->Instance, FieldID, DataType, pData ))
+		return JE_FALSE;
+
+	// Properties can move or resize the object
+	jeObject_UpdateWorld(Object);
+
+	return JE_TRUE;
 }
 
 //====================================================================================================
@@ -1062,7 +1084,12 @@ JETAPI jeBoolean	JETCC jeObject_SetXForm	(jeObject * Object,const jeXForm3d *XF)
 	if (!Object->Methods->SetXForm)
 		return JE_FALSE;
 
-	return Object->Methods->SetXForm(Object->Instance, XF);
+	if (!Object->Methods->SetXForm(Object->Instance, XF))
+		return JE_FALSE;
+
+	jeObject_UpdateWorld(Object);
+
+	return JE_TRUE;
 }
 
 //====================================================================================================
@@ -1160,6 +1187,7 @@ JETAPI jeBoolean	JETCC jeObject_AddChild	(jeObject * Object, jeObject * Child)
 	*/
 
 //by trilobite
+	jeBoolean	Result;
 
 	assert(Object && Object->Instance && Object->Methods);
 
@@ -1169,7 +1197,10 @@ JETAPI jeBoolean	JETCC jeObject_AddChild	(jeObject * Object, jeObject * Child)
 		return JE_FALSE;
 	
 	if (!Object->Methods->AddChild)
+	{
+		jeObject_UpdateWorld(Object);
 		return JE_TRUE;
+	}
 
 	//if (Object->Methods->Type != JE_OBJECT_TYPE_MODEL || Child->Methods->Type != JE_OBJECT_TYPE_ACTOR)
 	//{
@@ -1182,9 +1213,12 @@ JETAPI jeBoolean	JETCC jeObject_AddChild	(jeObject * Object, jeObject * Child)
 	//}
 	Child->Parent = Object;
 	//jeObject_CreateRef(Child);
-	return Object->Methods->AddChild(Object->Instance,Child);
+	Result = Object->Methods->AddChild(Object->Instance,Child);
 
-	
+	// The child's extents now count towards ours
+	jeObject_UpdateWorld(Object);
+
+	return Result;
 }
 
 //====================================================================================================
@@ -1227,6 +1261,8 @@ JETAPI jeBoolean	JETCC jeObject_RemoveChild(jeObject* Object, jeObject* Child)
 	*/
 
 	
+	jeBoolean	Result;
+
 	assert(Object && Object->Instance && Object->Methods);
 
 	if (!jeChain_FindLink(Object->Children, (void*)Child))
@@ -1236,7 +1272,10 @@ JETAPI jeBoolean	JETCC jeObject_RemoveChild(jeObject* Object, jeObject* Child)
 		return JE_FALSE;
 
 	if (!Object->Methods->RemoveChild )
+	{
+		jeObject_UpdateWorld(Object);
 		return JE_TRUE;
+	}
 	if( Object->pWorld )
 		jeObject_DettachWorld( Child, Object->pWorld );
 	if( Object->pEngine )
@@ -1245,9 +1284,11 @@ JETAPI jeBoolean	JETCC jeObject_RemoveChild(jeObject* Object, jeObject* Child)
 		jeObject_DettachSoundSystem( Child, Object->pSoundSystem );
 	Child->Parent = nullptr;
 
-	return Object->Methods->RemoveChild(Object->Instance,Child);
+	Result = Object->Methods->RemoveChild(Object->Instance,Child);
 
-	
+	jeObject_UpdateWorld(Object);
+
+	return Result;
 }
 
 //====================================================================================================
@@ -25,36 +25,55 @@
 #include "jeParticle.h"
 #include "jeVersion.h"
 
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+	#define JE_PARTICLE_SSE
+	#include <xmmintrin.h>
+#endif
+
 
 ////////////////////////////////////////////////////////////////////////////////////////
-//	Particle attricute flags
+//	Particle batch sizes
 ////////////////////////////////////////////////////////////////////////////////////////
-#define	PARTICLE_HASVELOCITY	( 1 << 1 )
-#define PARTICLE_HASGRAVITY		( 1 << 2 )
+#define PARTICLE_START_COUNT	64
 
 
 ////////////////////////////////////////////////////////////////////////////////////////
-//	jeParticle struct
+//	Particle batch struct
+//
+//	All particles of a system that were added to the same world live in one batch,
+//	stored one array per attribute so a frame can integrate them four at a time.
+//	The whole batch is one sprite array user poly in the world that points at Verts,
+//	Materials and Scales (each sprite is still its own driver poly).  Dead particles are
+//	replaced by the last one.
 ////////////////////////////////////////////////////////////////////////////////////////
-typedef struct jeParticle
+typedef struct jeParticle_Batch
 {
-	jeLVertex		ptclVertex;
-	jeMaterialSpec	*ptclMaterial;
-	jeUserPoly		*ptclPoly;
-	unsigned		ptclFlags;
-	jeParticle		*ptclNext;
-	jeParticle		*ptclPrev;
-	float			Scale;
-	jeVec3d			Gravity;
-	float			Alpha;
-	jeVec3d			CurrentAnchorPoint;
-	const jeVec3d	*AnchorPoint;
-	float			ptclTime;
-	float			ptclTotalTime;
-	jeVec3d			ptclVelocity;
-	jeWorld			*World;
-
-} jeParticle;
+	jeWorld					*World;			// world the particles were added to, NULL if the batch is unused
+	jeUserPoly				*Poly;			// sprite array that draws the batch
+	int						Count;
+	int						Max;
+
+	// integrated every frame
+	float					*PosX, *PosY, *PosZ;
+	float					*VelX, *VelY, *VelZ;
+	float					*GravX, *GravY, *GravZ;
+	float					*VelGain;		// 1 if the particle was given a velocity, else gravity never builds up speed
+	float					*Time;
+	float					*TotalTime;
+	float					*Alpha;			// alpha the particle was created with
+	float					*CurAlpha;
+
+	// handed to the sprite array
+	jeLVertex				*Verts;
+	const jeMaterialSpec	**Materials;
+	jeFloat					*Scales;
+
+	// anchor points
+	const jeVec3d			**AnchorPoint;
+	jeVec3d					*CurrentAnchorPoint;
+	int						NumAnchored;
+
+} jeParticle_Batch;
 
 
 ////////////////////////////////////////////////////////////////////////////////////////
@@ -62,7 +81,8 @@ typedef struct jeParticle
 ////////////////////////////////////////////////////////////////////////////////////////
 typedef	struct jeParticle_System
 {
-	jeParticle	*psParticles;
+	jeParticle_Batch	*psBatches;
+	int					psNumBatches;
 
 } jeParticle_System;
 
@@ -105,96 +125,443 @@ JETAPI jeParticle_System * JETCC jeParticle_SystemCreate(
 
 ////////////////////////////////////////////////////////////////////////////////////////
 //
-//	jeParticle_Destroy()
+//	jeParticle_BatchGrow()
+//
+//	Double the size of every array in a batch.
+//
+////////////////////////////////////////////////////////////////////////////////////////
+static jeBoolean jeParticle_BatchGrow(
+	jeParticle_Batch	*Batch )	// batch to grow
+{
+
+	// locals
+	int	NewMax;
+
+	// arrays that were already grown stay grown if a later one fails, Max only
+	// changes once they all have room
+	NewMax = ( Batch->Max > 0 ) ? Batch->Max * 2 : PARTICLE_START_COUNT;
+
+	#define PARTICLE_GROW( Field, Type )														\
+	{																							\
+		Type	*NewArray = (Type *)jeRam_Realloc( Batch->Field, NewMax * sizeof( Type ) );		\
+		if ( NewArray == NULL )																	\
+		{																						\
+			return JE_FALSE;																	\
+		}																						\
+		Batch->Field = NewArray;																\
+	}
+
+	PARTICLE_GROW( PosX, float );
+	PARTICLE_GROW( PosY, float );
+	PARTICLE_GROW( PosZ, float );
+	PARTICLE_GROW( VelX, float );
+	PARTICLE_GROW( VelY, float );
+	PARTICLE_GROW( VelZ, float );
+	PARTICLE_GROW( GravX, float );
+	PARTICLE_GROW( GravY, float );
+	PARTICLE_GROW( GravZ, float );
+	PARTICLE_GROW( VelGain, float );
+	PARTICLE_GROW( Time, float );
+	PARTICLE_GROW( TotalTime, float );
+	PARTICLE_GROW( Alpha, float );
+	PARTICLE_GROW( CurAlpha, float );
+	PARTICLE_GROW( Verts, jeLVertex );
+	PARTICLE_GROW( Materials, const jeMaterialSpec * );
+	PARTICLE_GROW( Scales, jeFloat );
+	PARTICLE_GROW( AnchorPoint, const jeVec3d * );
+	PARTICLE_GROW( CurrentAnchorPoint, jeVec3d );
+
+	#undef PARTICLE_GROW
+
+	Batch->Max = NewMax;
+
+	// all done
+	return JE_TRUE;
+
+} // jeParticle_BatchGrow()
+
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+//
+//	jeParticle_BatchRelease()
 //
-//	Destroy a particle.
+//	Destroy all particles in a batch and detach it from its world.  The arrays are
+//	kept so the batch can be reused.
 //
 ////////////////////////////////////////////////////////////////////////////////////////
-static void jeParticle_Destroy(
-	jeParticle	*p )	// particle to destroy
+static void jeParticle_BatchRelease(
+	jeParticle_Batch	*Batch )	// batch to release
 {
 
 	// destroy the poly
-	if ( p->ptclPoly != NULL )
+	if ( Batch->Poly != NULL )
 	{
-		jeWorld_RemoveUserPoly( p->World, p->ptclPoly );
-		jeUserPoly_Destroy( &( p->ptclPoly ) );
+		jeWorld_RemoveUserPoly( Batch->World, Batch->Poly );
+		jeUserPoly_Destroy( &( Batch->Poly ) );
+	}
+
+	// reset the batch
+	Batch->World = NULL;
+	Batch->Count = 0;
+	Batch->NumAnchored = 0;
+
+} // jeParticle_BatchRelease()
+
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+//
+//	jeParticle_BatchDestroy()
+//
+//	Release a batch and free its arrays.
+//
+////////////////////////////////////////////////////////////////////////////////////////
+static void jeParticle_BatchDestroy(
+	jeParticle_Batch	*Batch )	// batch to destroy
+{
+
+	// detach it from its world
+	jeParticle_BatchRelease( Batch );
+
+	// free the arrays
+	#define PARTICLE_FREE( Field )		\
+	if ( Batch->Field != NULL )			\
+	{									\
+		jeRam_Free( Batch->Field );		\
 	}
 
-	// free the struct
-	jeRam_Free( p );
+	PARTICLE_FREE( PosX );
+	PARTICLE_FREE( PosY );
+	PARTICLE_FREE( PosZ );
+	PARTICLE_FREE( VelX );
+	PARTICLE_FREE( VelY );
+	PARTICLE_FREE( VelZ );
+	PARTICLE_FREE( GravX );
+	PARTICLE_FREE( GravY );
+	PARTICLE_FREE( GravZ );
+	PARTICLE_FREE( VelGain );
+	PARTICLE_FREE( Time );
+	PARTICLE_FREE( TotalTime );
+	PARTICLE_FREE( Alpha );
+	PARTICLE_FREE( CurAlpha );
+	PARTICLE_FREE( Verts );
+	PARTICLE_FREE( Materials );
+	PARTICLE_FREE( Scales );
+	PARTICLE_FREE( AnchorPoint );
+	PARTICLE_FREE( CurrentAnchorPoint );
 
-} // jeParticle_Destroy()
+	#undef PARTICLE_FREE
+
+	Batch->Max = 0;
+
+} // jeParticle_BatchDestroy()
 
 
 
 ////////////////////////////////////////////////////////////////////////////////////////
 //
-//	jeParticle_Unlink()
+//	jeParticle_GetBatch()
 //
-//	Remove a particle from the list of particles.
+//	Return the batch holding the particles of a world, creating one if needed.
 //
 ////////////////////////////////////////////////////////////////////////////////////////
-static void jeParticle_Unlink(
-	jeParticle_System	*ps,		// particle system in which particle exists
-	jeParticle			*ptcl )		// particle to unlink
+static jeParticle_Batch * jeParticle_GetBatch(
+	jeParticle_System	*ps,		// particle system to look in
+	jeWorld				*World )	// world the particle is for
 {
 
-	// make list adjustments
-	if ( ptcl->ptclPrev )
+	// locals
+	jeParticle_Batch	*Batch = NULL;
+	int					i;
+
+	// use the world's batch if it has one, else remember the first unused one
+	for ( i = 0; i < ps->psNumBatches; i++ )
+	{
+		if ( ps->psBatches[i].World == World )
+		{
+			return &( ps->psBatches[i] );
+		}
+		if ( ( ps->psBatches[i].World == NULL ) && ( Batch == NULL ) )
+		{
+			Batch = &( ps->psBatches[i] );
+		}
+	}
+
+	// add a new batch
+	if ( Batch == NULL )
 	{
-		ptcl->ptclPrev->ptclNext = ptcl->ptclNext;
+
+		// locals
+		jeParticle_Batch	*NewBatches;
+
+		NewBatches = (jeParticle_Batch *)jeRam_Realloc( ps->psBatches, ( ps->psNumBatches + 1 ) * sizeof( *NewBatches ) );
+		if ( NewBatches == NULL )
+		{
+			return NULL;
+		}
+		ps->psBatches = NewBatches;
+		Batch = &( ps->psBatches[ps->psNumBatches++] );
+		memset( Batch, 0, sizeof( *Batch ) );
 	}
-	if ( ptcl->ptclNext )
+
+	// create the poly that draws the batch
+	assert( Batch->Poly == NULL );
+	Batch->Poly = jeUserPoly_CreateSpriteArray( JE_RENDER_FLAG_ALPHA | JE_RENDER_FLAG_NO_ZWRITE );
+	if ( Batch->Poly == NULL )
 	{
-		ptcl->ptclNext->ptclPrev = ptcl->ptclPrev;
+		return NULL;
 	}
-	if ( ps->psParticles == ptcl )
+	if ( jeWorld_AddUserPoly( World, Batch->Poly, JE_FALSE ) == JE_FALSE )
 	{
-		ps->psParticles = ptcl->ptclNext;
+		jeUserPoly_Destroy( &( Batch->Poly ) );
+		return NULL;
 	}
+	Batch->World = World;
 
-} // jeParticle_Unlink()
+	// all done
+	return Batch;
+
+} // jeParticle_GetBatch()
 
 
 
 ////////////////////////////////////////////////////////////////////////////////////////
 //
-//	jeParticle_Create()
+//	jeParticle_BatchRemove()
 //
-//	Create a new particle.
+//	Remove a particle from a batch by moving the last particle into its slot.
 //
 ////////////////////////////////////////////////////////////////////////////////////////
-static jeParticle * jeParticle_Create(
-	jeParticle_System	*ps,		// particle system to create it in
-	jeMaterialSpec		*Texture,	// texture to use
-	const jeLVertex		*Vert )		// vert data
+static void jeParticle_BatchRemove(
+	jeParticle_Batch	*Batch,		// batch in which particle exists
+	int					Index )		// particle to remove
 {
 
 	// locals
-	jeParticle	*ptcl;
+	int	Last;
 
-	// allocate struct
-	ptcl = (jeParticle *)jeRam_AllocateClear( sizeof( *ptcl ) );
-	if ( ptcl == NULL )
+	// ensure valid data
+	assert( Index >= 0 );
+	assert( Index < Batch->Count );
+
+	// forget its anchor point
+	if ( Batch->AnchorPoint[Index] != NULL )
 	{
-		return ptcl;
+		Batch->NumAnchored--;
 	}
 
-	// init struct
-	ptcl->ptclNext = ps->psParticles;
-	ps->psParticles = ptcl;
-	if ( ptcl->ptclNext )
+	// move the last particle down
+	Last = --Batch->Count;
+	if ( Index != Last )
 	{
-		ptcl->ptclNext->ptclPrev = ptcl;
+		Batch->PosX[Index] = Batch->PosX[Last];
+		Batch->PosY[Index] = Batch->PosY[Last];
+		Batch->PosZ[Index] = Batch->PosZ[Last];
+		Batch->VelX[Index] = Batch->VelX[Last];
+		Batch->VelY[Index] = Batch->VelY[Last];
+		Batch->VelZ[Index] = Batch->VelZ[Last];
+		Batch->GravX[Index] = Batch->GravX[Last];
+		Batch->GravY[Index] = Batch->GravY[Last];
+		Batch->GravZ[Index] = Batch->GravZ[Last];
+		Batch->VelGain[Index] = Batch->VelGain[Last];
+		Batch->Time[Index] = Batch->Time[Last];
+		Batch->TotalTime[Index] = Batch->TotalTime[Last];
+		Batch->Alpha[Index] = Batch->Alpha[Last];
+		Batch->CurAlpha[Index] = Batch->CurAlpha[Last];
+		Batch->Verts[Index] = Batch->Verts[Last];
+		Batch->Materials[Index] = Batch->Materials[Last];
+		Batch->Scales[Index] = Batch->Scales[Last];
+		Batch->AnchorPoint[Index] = Batch->AnchorPoint[Last];
+		Batch->CurrentAnchorPoint[Index] = Batch->CurrentAnchorPoint[Last];
 	}
-	ptcl->ptclMaterial = Texture;
-	ptcl->ptclVertex = *Vert;
 
-	// all done
-	return ptcl;
+} // jeParticle_BatchRemove()
+
+
+
+#ifdef JE_PARTICLE_SSE
+////////////////////////////////////////////////////////////////////////////////////////
+//
+//	jeParticle_IntegrateAxis4()
+//
+//	Integrate one axis of four particles.  Same operations, in the same order, as the
+//	scalar loop in jeParticle_BatchIntegrate().
+//
+////////////////////////////////////////////////////////////////////////////////////////
+static inline void jeParticle_IntegrateAxis4(
+	float		*Pos,		// positions
+	float		*Vel,		// velocities
+	const float	*Grav,		// gravity
+	__m128		VelGain,	// 1 or 0 per particle
+	__m128		DeltaTime )	// elapsed seconds in every lane
+{
+
+	// locals
+	__m128	Gravity, Velocity, DeltaPos;
+
+	Gravity = _mm_mul_ps( _mm_loadu_ps( Grav ), DeltaTime );
+	Velocity = _mm_loadu_ps( Vel );
+	DeltaPos = _mm_add_ps( _mm_mul_ps( Velocity, DeltaTime ), Gravity );
+	_mm_storeu_ps( Pos, _mm_add_ps( _mm_loadu_ps( Pos ), DeltaPos ) );
+	_mm_storeu_ps( Vel, _mm_add_ps( Velocity, _mm_mul_ps( Gravity, VelGain ) ) );
+
+} // jeParticle_IntegrateAxis4()
+#endif
+
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+//
+//	jeParticle_BatchIntegrate()
+//
+//	Age every particle in a batch, move it by its velocity and gravity, and work out
+//	its faded alpha.  Particles that are missing a velocity or gravity have zeros in
+//	those arrays, so every particle runs the same math.
+//
+////////////////////////////////////////////////////////////////////////////////////////
+static void jeParticle_BatchIntegrate(
+	jeParticle_Batch	*Batch,			// batch to process
+	float				DeltaTime )		// amount of elaped seconds
+{
+
+	// locals
+	int	i = 0;
+
+#ifdef JE_PARTICLE_SSE
+	{
+
+		// locals
+		__m128	DT = _mm_set1_ps( DeltaTime );
+
+		for ( ; i + 4 <= Batch->Count; i += 4 )
+		{
+
+			// locals
+			__m128	Time, VelGain;
+
+			// adjust particles life remaining
+			Time = _mm_sub_ps( _mm_loadu_ps( Batch->Time + i ), DT );
+			_mm_storeu_ps( Batch->Time + i, Time );
+
+			// apply velocity and gravity
+			VelGain = _mm_loadu_ps( Batch->VelGain + i );
+			jeParticle_IntegrateAxis4( Batch->PosX + i, Batch->VelX + i, Batch->GravX + i, VelGain, DT );
+			jeParticle_IntegrateAxis4( Batch->PosY + i, Batch->VelY + i, Batch->GravY + i, VelGain, DT );
+			jeParticle_IntegrateAxis4( Batch->PosZ + i, Batch->VelZ + i, Batch->GravZ + i, VelGain, DT );
+
+			// adjust particle alpha
+			_mm_storeu_ps( Batch->CurAlpha + i, _mm_mul_ps( _mm_loadu_ps( Batch->Alpha + i ), _mm_div_ps( Time, _mm_loadu_ps( Batch->TotalTime + i ) ) ) );
+		}
+	}
+#endif
+
+	// whatever is left over
+	for ( ; i < Batch->Count; i++ )
+	{
+
+		// locals
+		float	GravityX, GravityY, GravityZ;
+
+		// adjust particles life remaining
+		Batch->Time[i] -= DeltaTime;
+
+		// apply velocity and gravity
+		GravityX = Batch->GravX[i] * DeltaTime;
+		GravityY = Batch->GravY[i] * DeltaTime;
+		GravityZ = Batch->GravZ[i] * DeltaTime;
+		Batch->PosX[i] = Batch->PosX[i] + ( Batch->VelX[i] * DeltaTime + GravityX );
+		Batch->PosY[i] = Batch->PosY[i] + ( Batch->VelY[i] * DeltaTime + GravityY );
+		Batch->PosZ[i] = Batch->PosZ[i] + ( Batch->VelZ[i] * DeltaTime + GravityZ );
+		Batch->VelX[i] = Batch->VelX[i] + GravityX * Batch->VelGain[i];
+		Batch->VelY[i] = Batch->VelY[i] + GravityY * Batch->VelGain[i];
+		Batch->VelZ[i] = Batch->VelZ[i] + GravityZ * Batch->VelGain[i];
+
+		// adjust particle alpha
+		Batch->CurAlpha[i] = Batch->Alpha[i] * ( Batch->Time[i] / Batch->TotalTime[i] );
+	}
+
+} // jeParticle_BatchIntegrate()
+
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+//
+//	jeParticle_BatchFrame()
+//
+//	Process a frame of one batch.
+//
+////////////////////////////////////////////////////////////////////////////////////////
+static void jeParticle_BatchFrame(
+	jeParticle_Batch	*Batch,			// batch to process
+	float				DeltaTime )		// amount of elaped seconds
+{
+
+	// locals
+	int	i;
+
+	// move all particles
+	jeParticle_BatchIntegrate( Batch, DeltaTime );
+
+	// make particles follow their anchor points
+	if ( Batch->NumAnchored > 0 )
+	{
+		for ( i = 0; i < Batch->Count; i++ )
+		{
+			if ( Batch->AnchorPoint[i] != NULL )
+			{
+
+				// locals
+				const jeVec3d	*AnchorPoint = Batch->AnchorPoint[i];
+				jeVec3d			*CurrentAnchorPoint = &( Batch->CurrentAnchorPoint[i] );
+
+				Batch->PosX[i] += AnchorPoint->X - CurrentAnchorPoint->X;
+				Batch->PosY[i] += AnchorPoint->Y - CurrentAnchorPoint->Y;
+				Batch->PosZ[i] += AnchorPoint->Z - CurrentAnchorPoint->Z;
+				jeVec3d_Copy( AnchorPoint, CurrentAnchorPoint );
+			}
+		}
+	}
 
-} // jeParticle_Create()
+	// destroy dead particles
+	i = 0;
+	while ( i < Batch->Count )
+	{
+		if ( Batch->Time[i] <= 0.0f )
+		{
+			jeParticle_BatchRemove( Batch, i );
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+	// let go of the world once the batch is empty
+	if ( Batch->Count == 0 )
+	{
+		jeParticle_BatchRelease( Batch );
+		return;
+	}
+
+	// update the sprites
+	for ( i = 0; i < Batch->Count; i++ )
+	{
+
+		// locals
+		jeLVertex	*Vert = &( Batch->Verts[i] );
+
+		assert( Batch->TotalTime[i] > 0.0f );
+		Vert->X = Batch->PosX[i];
+		Vert->Y = Batch->PosY[i];
+		Vert->Z = Batch->PosZ[i];
+		Vert->a = Batch->CurAlpha[i];
+		assert( Vert->a >= 0.0f );
+		assert( Vert->a <= 255.0f );
+	}
+	jeUserPoly_UpdateSpriteArray( Batch->Poly, Batch->Verts, Batch->Materials, Batch->Scales, Batch->Count );
+
+} // jeParticle_BatchFrame()
 
 
 
@@ -210,20 +577,16 @@ JETAPI void JETCC jeParticle_SystemDestroy(
 {
 
 	// locals
-	jeParticle	*ptcl;
+	int	i;
 
 	// zap all particles
-	ptcl = ps->psParticles;
-	while ( ptcl != NULL )
+	for ( i = 0; i < ps->psNumBatches; i++ )
 	{
-
-		// locals
-		jeParticle	*temp;
-
-		// destroy this particle
-		temp = ptcl->ptclNext;
-		jeParticle_Destroy( ptcl );
-		ptcl = temp;
+		jeParticle_BatchDestroy( &( ps->psBatches[i] ) );
+	}
+	if ( ps->psBatches != NULL )
+	{
+		jeRam_Free( ps->psBatches );
 	}
 
 	// free particle system
@@ -245,21 +608,12 @@ JETAPI void JETCC jeParticle_SystemRemoveAll(
 {
 
 	// locals
-	jeParticle	*ptcl;
+	int	i;
 
-	// zap all particles
-	ptcl = ps->psParticles;
-	while ( ptcl != NULL )
+	// zap all particles, keeping the arrays for the next ones
+	for ( i = 0; i < ps->psNumBatches; i++ )
 	{
-
-		// locals
-		jeParticle	*temp;
-
-		// kill this particle and go to next one
-		temp = ptcl->ptclNext;
-		jeParticle_Unlink( ps, ptcl );
-		jeParticle_Destroy( ptcl );
-		ptcl = temp;
+		jeParticle_BatchRelease( &( ps->psBatches[i] ) );
 	}
 
 } // jeParticle_SystemRemoveAll()
@@ -278,18 +632,16 @@ JETAPI int JETCC jeParticle_GetCount(
 {
 
 	// locals
-	jeParticle	*ptcl;
-	int			TotalParticleCount = 0;
+	int	TotalParticleCount = 0;
+	int	i;
 
 	// ensure valid data
 	assert( ps != NULL );
 
 	// count up how many particles are active in this particle system
-	ptcl = ps->psParticles;
-	while ( ptcl )
+	for ( i = 0; i < ps->psNumBatches; i++ )
 	{
-		ptcl = ptcl->ptclNext;
-		TotalParticleCount++;
+		TotalParticleCount += ps->psBatches[i].Count;
 	}
 
 	// return the active count
@@ -312,91 +664,15 @@ JETAPI void JETCC jeParticle_SystemFrame(
 {
 
 	// locals
-	jeParticle	*ptcl;
+	int	i;
 
 	// process all particles
-	ptcl = ps->psParticles;
-	while ( ptcl != NULL )
+	for ( i = 0; i < ps->psNumBatches; i++ )
 	{
-
-		// adjust particles life remaining
-		ptcl->ptclTime -= DeltaTime;
-
-		// destroy the particle..
-		if ( ptcl->ptclTime <= 0.0f )
+		if ( ps->psBatches[i].World != NULL )
 		{
-
-			// locals
-			jeParticle	*temp;
-
-			// destroy this particle
-			temp = ptcl->ptclNext;
-			jeParticle_Unlink( ps, ptcl );
-			jeParticle_Destroy( ptcl );
-			ptcl = temp;
-			continue;
+			jeParticle_BatchFrame( &( ps->psBatches[i] ), DeltaTime );
 		}
-		// ...or process it
-		else
-		{
-
-			// locals
-			jeVec3d	DeltaPos = { 0.0f, 0.0f, 0.0f };
-
-			// apply velocity
-			if ( ptcl->ptclFlags & PARTICLE_HASVELOCITY )
-			{
-				jeVec3d_Scale( &( ptcl->ptclVelocity ), DeltaTime, &DeltaPos );
-			}
-
-			// apply gravity
-			if ( ptcl->ptclFlags & PARTICLE_HASGRAVITY )
-			{
-
-				// locals
-				jeVec3d	Gravity;
-
-				// make gravity vector
-				jeVec3d_Scale( &( ptcl->Gravity ), DeltaTime, &Gravity );
-
-				// apply gravity to built in velocity and DeltaPos
-				jeVec3d_Add( &( ptcl->ptclVelocity ), &Gravity, &( ptcl->ptclVelocity ) );
-				jeVec3d_Add( &DeltaPos, &Gravity, &DeltaPos );
-			}
-			
-			// apply DeltaPos to particle position
-			if (	( ptcl->ptclFlags & PARTICLE_HASVELOCITY ) ||
-					( ptcl->ptclFlags & PARTICLE_HASGRAVITY ) )
-			{
-				jeVec3d_Add( (jeVec3d *)&( ptcl->ptclVertex.X ), &DeltaPos, (jeVec3d *)&( ptcl->ptclVertex.X ) );
-			}
-
-			// make the particle follow its anchor point if it has one
-			if ( ptcl->AnchorPoint != NULL )
-			{
-
-				// locals
-				jeVec3d	AnchorDelta;
-
-				jeVec3d_Subtract( ptcl->AnchorPoint, &( ptcl->CurrentAnchorPoint ), &AnchorDelta );
-				jeVec3d_Add( (jeVec3d *)&( ptcl->ptclVertex.X ), &AnchorDelta, (jeVec3d *)&( ptcl->ptclVertex.X ) );
-				jeVec3d_Copy( ptcl->AnchorPoint, &( ptcl->CurrentAnchorPoint ) );
-			}
-
-			// destroy the particle if it is in solid space
-			//undone
-		}
-
-		// adjust particle alpha
-		assert( ptcl->ptclTotalTime > 0.0f );
-		assert( ptcl->ptclPoly != NULL );
-		ptcl->ptclVertex.a = ptcl->Alpha * ( ptcl->ptclTime / ptcl->ptclTotalTime );
-		assert( ptcl->ptclVertex.a >= 0.0f );
-		assert( ptcl->ptclVertex.a <= 255.0f );
-		jeUserPoly_UpdateSprite( ptcl->ptclPoly, &ptcl->ptclVertex, ptcl->ptclMaterial, ptcl->Scale );
-
-		// get next particle
-		ptcl = ptcl->ptclNext;
 	}
 
 } // jeParticle_SystemFrame()
@@ -416,23 +692,29 @@ JETAPI jeBoolean JETCC jeParticle_SystemRemoveAnchorPoint(
 {
 
 	// locals	
-	jeParticle	*ptcl;
 	jeBoolean	AtLeastOneFound = JE_FALSE;
+	int			i, j;
 
 	// ensure valid data
 	assert( ps != NULL );
 	assert( AnchorPoint != NULL );
 
 	// eliminate achnor point from all particles in this particle system
-	ptcl = ps->psParticles;
-	while ( ptcl != NULL )
+	for ( i = 0; i < ps->psNumBatches; i++ )
 	{
-		if ( ptcl->AnchorPoint == AnchorPoint )
+
+		// locals
+		jeParticle_Batch	*Batch = &( ps->psBatches[i] );
+
+		for ( j = 0; ( j < Batch->Count ) && ( Batch->NumAnchored > 0 ); j++ )
 		{
-			ptcl->AnchorPoint = NULL;
-			AtLeastOneFound = JE_TRUE;
+			if ( Batch->AnchorPoint[j] == AnchorPoint )
+			{
+				Batch->AnchorPoint[j] = NULL;
+				Batch->NumAnchored--;
+				AtLeastOneFound = JE_TRUE;
+			}
 		}
-		ptcl = ptcl->ptclNext;
 	}
 
 	// all done
@@ -462,53 +744,82 @@ JETAPI jeBoolean JETCC jeParticle_SystemAddParticle(
 {
 
 	// locals
-	jeParticle	*ptcl;
+	jeParticle_Batch	*Batch;
+	int					i;
+
+	// ensure valid data
+	assert( ps != NULL );
+	assert( World != NULL );
+	assert( Texture != NULL );
+	assert( Vert != NULL );
 
-	// create a new particle
-	ptcl = jeParticle_Create( ps, Texture, Vert );
-	if ( ptcl == NULL )
+	// find the batch for this world, and make room in it
+	Batch = jeParticle_GetBatch( ps, (jeWorld *)World );
+	if ( Batch == NULL )
 	{
 		return JE_FALSE;
 	}
+	if ( ( Batch->Count == Batch->Max ) && ( jeParticle_BatchGrow( Batch ) == JE_FALSE ) )
+	{
+		if ( Batch->Count == 0 )
+		{
+			jeParticle_BatchRelease( Batch );
+		}
+		return JE_FALSE;
+	}
+	i = Batch->Count;
+
+	// setup position and art
+	Batch->Verts[i] = *Vert;
+	Batch->PosX[i] = Vert->X;
+	Batch->PosY[i] = Vert->Y;
+	Batch->PosZ[i] = Vert->Z;
+	Batch->Materials[i] = Texture;
+	Batch->Scales[i] = Scale;
 
 	// setup gravity
 	if ( Gravity != NULL )
 	{
-		jeVec3d_Copy( Gravity, &( ptcl->Gravity ) );
-		ptcl->ptclFlags |= PARTICLE_HASGRAVITY;
+		Batch->GravX[i] = Gravity->X;
+		Batch->GravY[i] = Gravity->Y;
+		Batch->GravZ[i] = Gravity->Z;
+	}
+	else
+	{
+		Batch->GravX[i] = Batch->GravY[i] = Batch->GravZ[i] = 0.0f;
 	}
 
 	// setup velocity
 	if ( Velocity != NULL )
 	{
-		jeVec3d_Copy( Velocity, &( ptcl->ptclVelocity ) );
-		ptcl->ptclFlags |= PARTICLE_HASVELOCITY;
+		Batch->VelX[i] = Velocity->X;
+		Batch->VelY[i] = Velocity->Y;
+		Batch->VelZ[i] = Velocity->Z;
+		Batch->VelGain[i] = 1.0f;
+	}
+	else
+	{
+		Batch->VelX[i] = Batch->VelY[i] = Batch->VelZ[i] = 0.0f;
+		Batch->VelGain[i] = 0.0f;
 	}
 
 	// setup the anchor point
+	Batch->AnchorPoint[i] = AnchorPoint;
 	if ( AnchorPoint != NULL )
 	{
-		jeVec3d_Copy( AnchorPoint, &( ptcl->CurrentAnchorPoint ) );
-		ptcl->AnchorPoint = AnchorPoint;
+		jeVec3d_Copy( AnchorPoint, &( Batch->CurrentAnchorPoint[i] ) );
+		Batch->NumAnchored++;
 	}
 
 	// setup remaining data
-	ptcl->Scale = Scale;
-	ptcl->ptclTime = Time;
-	ptcl->ptclTotalTime = Time;
-	ptcl->Alpha = Vert->a;
-	ptcl->World = (jeWorld *)World;
-
-	// add the poly to the world
-	ptcl->ptclPoly = jeUserPoly_CreateSprite(	&ptcl->ptclVertex,
-												ptcl->ptclMaterial,
-												ptcl->Scale,
-												JE_RENDER_FLAG_ALPHA | JE_RENDER_FLAG_NO_ZWRITE );
-	if ( jeWorld_AddUserPoly( ptcl->World, ptcl->ptclPoly, JE_FALSE ) == JE_FALSE )
-	{
-		jeUserPoly_Destroy( &( ptcl->ptclPoly ) );
-		return JE_FALSE;
-	}
+	Batch->Time[i] = Time;
+	Batch->TotalTime[i] = Time;
+	Batch->Alpha[i] = Vert->a;
+	Batch->CurAlpha[i] = Vert->a;
+	Batch->Count++;
+
+	// the arrays may have moved
+	jeUserPoly_UpdateSpriteArray( Batch->Poly, Batch->Verts, Batch->Materials, Batch->Scales, Batch->Count );
 
 	// all done
 	return JE_TRUE;
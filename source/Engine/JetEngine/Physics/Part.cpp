@@ -25,19 +25,22 @@
 #include "Vec3d.h"
 
 #include "Part.h"
+#include "PhysicsSystem._h"
 
-typedef struct jeParticle
+// A particle in a jePhysicsSystem keeps its state in the system's arrays
+static void jeParticle_GetSystemVec(const float* x, const float* y, const float* z, int32 index, jeVec3d* vec)
 {
-	jeVec3d p, v, a; // pos, vel, acc
-	float mass, oneOverMass;
-
-	jeParticle_Flags flags;
-
-	jeParticle_IntegratorFunc integratorFunc;
-
-	float t; // time particle has been alive
+	vec->X = x[index];
+	vec->Y = y[index];
+	vec->Z = z[index];
+}
 
-}jeParticle;
+static void jeParticle_SetSystemVec(float* x, float* y, float* z, int32 index, const jeVec3d* vec)
+{
+	x[index] = vec->X;
+	y[index] = vec->Y;
+	z[index] = vec->Z;
+}
 
 
 /////////////////////////////////////////////////////////////////////////////////
@@ -67,6 +70,8 @@ jeParticle* jeParticle_Create(float mass, jeVec3d* p, jeVec3d* v, jeParticle_Fla
 
 	part->integratorFunc = integratorFunc;
 
+	part->system = NULL;
+
 	return part;
 }
 
@@ -75,6 +80,9 @@ void jeParticle_Destroy(jeParticle** part)
 	assert(part);
 	assert(*part);
 
+	if ((*part)->system)
+		jePhysicsSystem_RemoveParticle((*part)->system, (*part)->index);
+
 	jeRam_Free(*part);
 	*part = NULL;
 }
@@ -86,6 +94,9 @@ float jeParticle_GetMass(const jeParticle* part)
 {
 	assert(part);
 
+	if (part->system)
+		return part->system->mass[part->index];
+
 	return part->mass;
 }
 
@@ -93,6 +104,9 @@ float jeParticle_GetOneOverMass(const jeParticle* part)
 {
 	assert(part);
 
+	if (part->system)
+		return part->system->oneOverMass[part->index];
+
 	return part->oneOverMass;
 }
 
@@ -101,7 +115,10 @@ jeBoolean jeParticle_GetPos(const jeParticle* part, jeVec3d* pos)
 	assert(part);
 	assert(pos);
 
-	*pos = part->p;
+	if (part->system)
+		jeParticle_GetSystemVec(part->system->px, part->system->py, part->system->pz, part->index, pos);
+	else
+		*pos = part->p;
 
 	return JE_TRUE;
 }
@@ -111,7 +128,10 @@ jeBoolean jeParticle_GetVel(const jeParticle* part, jeVec3d* vel)
 	assert(part);
 	assert(vel);
 
-	*vel = part->v;
+	if (part->system)
+		jeParticle_GetSystemVec(part->system->vx, part->system->vy, part->system->vz, part->index, vel);
+	else
+		*vel = part->v;
 
 	return JE_TRUE;
 }
@@ -121,7 +141,10 @@ jeBoolean jeParticle_GetAcc(const jeParticle* part, jeVec3d* acc)
 	assert(part);
 	assert(acc);
 
-	*acc = part->a;
+	if (part->system)
+		jeParticle_GetSystemVec(part->system->ax, part->system->ay, part->system->az, part->index, acc);
+	else
+		*acc = part->a;
 
 	return JE_TRUE;
 }
@@ -137,6 +160,9 @@ float jeParticle_GetTime(const jeParticle* part)
 {
 	assert(part);
 
+	if (part->system)
+		return part->system->t[part->index];
+
 	return part->t;
 }
 
@@ -158,6 +184,12 @@ jeBoolean jeParticle_SetMass(jeParticle* part, float mass)
 		part->oneOverMass = 0.f;
 	else
 		part->oneOverMass = 1 / mass;
+
+	if (part->system)
+	{
+		part->system->mass[part->index] = part->mass;
+		part->system->oneOverMass[part->index] = part->oneOverMass;
+	}
 	
 	return JE_TRUE;
 }
@@ -167,7 +199,10 @@ jeBoolean jeParticle_SetPos(jeParticle* part, const jeVec3d* pos)
 	assert(part);
 	assert(pos);
 
-	part->p = *pos;
+	if (part->system)
+		jeParticle_SetSystemVec(part->system->px, part->system->py, part->system->pz, part->index, pos);
+	else
+		part->p = *pos;
 
 	return JE_TRUE;
 }
@@ -177,7 +212,10 @@ jeBoolean jeParticle_SetVel(jeParticle* part, const jeVec3d* vel)
 	assert(part);
 	assert(vel);
 
-	part->v = *vel;
+	if (part->system)
+		jeParticle_SetSystemVec(part->system->vx, part->system->vy, part->system->vz, part->index, vel);
+	else
+		part->v = *vel;
 
 	return JE_TRUE;
 }
@@ -188,6 +226,9 @@ jeBoolean jeParticle_SetIntegratorFunc(jeParticle* part, jeParticle_IntegratorFu
 
 	part->integratorFunc = func;
 
+	if (part->system)
+		jePhysicsSystem_UpdateParticle(part->system, part->index);
+
 	return JE_TRUE;
 }
 
@@ -207,7 +248,14 @@ jeBoolean jeParticle_ClearAcc(jeParticle* part)
 {
 	assert(part);
 
-	jeVec3d_Clear(&part->a);
+	if (part->system)
+	{
+		part->system->ax[part->index] = 0.f;
+		part->system->ay[part->index] = 0.f;
+		part->system->az[part->index] = 0.f;
+	}
+	else
+		jeVec3d_Clear(&part->a);
 
 	return JE_TRUE;
 }
@@ -217,6 +265,18 @@ jeBoolean jeParticle_AddForce(jeParticle* part, const jeVec3d* pForce)
 	assert(part);
 	assert(pForce);
 
+	if (part->system)
+	{
+		jePhysicsSystem* pSystem = part->system;
+		int32 i = part->index;
+
+		pSystem->ax[i] += pSystem->oneOverMass[i] * pForce->X;
+		pSystem->ay[i] += pSystem->oneOverMass[i] * pForce->Y;
+		pSystem->az[i] += pSystem->oneOverMass[i] * pForce->Z;
+
+		return JE_TRUE;
+	}
+
 	part->a.X += part->oneOverMass * pForce->X;
 	part->a.Y += part->oneOverMass * pForce->Y;
 	part->a.Z += part->oneOverMass * pForce->Z;
@@ -229,6 +289,15 @@ jeBoolean jeParticle_AddAcc(jeParticle* part, const jeVec3d* pAcc)
 	assert(part);
 	assert(pAcc);
 
+	if (part->system)
+	{
+		part->system->ax[part->index] += pAcc->X;
+		part->system->ay[part->index] += pAcc->Y;
+		part->system->az[part->index] += pAcc->Z;
+
+		return JE_TRUE;
+	}
+
 	part->a.X += pAcc->X;
 	part->a.Y += pAcc->Y;
 	part->a.Z += pAcc->Z;
@@ -241,7 +310,10 @@ jeBoolean jeParticle_UpdateTime(jeParticle* part, float dt)
 	assert(part);
 	assert(dt > JE_EPSILON);
 
-	part->t += dt;
+	if (part->system)
+		part->system->t[part->index] += dt;
+	else
+		part->t += dt;
 
 	return JE_TRUE;
 }
@@ -249,6 +321,26 @@ jeBoolean jeParticle_UpdateTime(jeParticle* part, float dt)
 /////////////////////////////////////////////////////////////////////////////////
 // integrator functions
 
+// Runs an integrator on a copy of a system particle's state
+static jeBoolean jeParticle_IntegrateSystemParticle(jeParticle* part, float dt, jeParticle_IntegratorFunc func)
+{
+	jeParticle state;
+
+	state.system = NULL;
+
+	jeParticle_GetPos(part, &state.p);
+	jeParticle_GetVel(part, &state.v);
+	jeParticle_GetAcc(part, &state.a);
+
+	if (! func(&state, dt))
+		return JE_FALSE;
+
+	jeParticle_SetPos(part, &state.p);
+	jeParticle_SetVel(part, &state.v);
+
+	return JE_TRUE;
+}
+
 jeBoolean jeParticle_IntegratorFunc_EulerStep(jeParticle* part, float dt)
 {
 	jeVec3d dp, dv;
@@ -256,6 +348,9 @@ jeBoolean jeParticle_IntegratorFunc_EulerStep(jeParticle* part, float dt)
 	assert(part);
 	assert(dt > JE_EPSILON);
 
+	if (part->system)
+		return jeParticle_IntegrateSystemParticle(part, dt, jeParticle_IntegratorFunc_EulerStep);
+
 	dv.X = dt * part->a.X;
 	dv.Y = dt * part->a.Y;
 	dv.Z = dt * part->a.Z;
@@ -283,6 +378,12 @@ jeBoolean jeParticle_IntegratorFunc_EulerMidPoint1(jeParticle* part, float dt)
 	assert(part);
 	assert(dt > JE_EPSILON);
 
+	if (part->system)
+		return jeParticle_IntegrateSystemParticle(part, dt, jeParticle_IntegratorFunc_EulerMidPoint1);
+
+	tmpPart.system = NULL;
+	midPart.system = NULL;
+
 	tmpPart.a = part->a;
 	tmpPart.v = part->v;
 	tmpPart.p = part->v;
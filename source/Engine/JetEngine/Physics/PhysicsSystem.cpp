@@ -0,0 +1,556 @@
+/****************************************************************************************/
+/*  PHYSICSSYSTEM.CPP                                                                   */
+/*                                                                                      */
+/*  Author: Styx3D Modernization                                                        */
+/*  Description: Batched particle / spring container                                    */
+/*                                                                                      */
+/*  The contents of this file are subject to the 0BSD License.                          */
+/*  See LICENSE file in the project root for full license information.                  */
+/*                                                                                      */
+/****************************************************************************************/
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+
+#include "BaseType.h"
+#include "Ram.h"
+#include "Vec3d.h"
+#include "jeParallel.h"
+
+#include "PhysicsSystem._h"
+
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+	#define JE_PHYSICS_SSE
+	#include <xmmintrin.h>
+#endif
+
+#define JE_PHYSICS_START_SLOTS			(64)
+#define JE_PHYSICS_PARALLEL_MIN			(4096)		// Smaller passes run on the calling thread
+#define JE_PHYSICS_PARALLEL_GRAIN		(1024)
+
+/////////////////////////////////////////////////////////////////////////////////
+// storage
+
+static jeBoolean jePhysicsSystem_GrowArray(void** pArray, int32 count, int32 size)
+{
+	void* newArray;
+
+	newArray = jeRam_Realloc(*pArray, count * size);
+	if (! newArray) return JE_FALSE;
+
+	*pArray = newArray;
+
+	return JE_TRUE;
+}
+
+#define GROW(a, n)	jePhysicsSystem_GrowArray((void**)&(a), (n), sizeof(*(a)))
+
+static jeBoolean jePhysicsSystem_GrowSlots(jePhysicsSystem* pSystem)
+{
+	int32 newMax;
+
+	newMax = pSystem->maxSlots ? pSystem->maxSlots * 2 : JE_PHYSICS_START_SLOTS;
+
+	// Arrays that did grow before a failure are just bigger than they need to be
+	if (! GROW(pSystem->px, newMax) || ! GROW(pSystem->py, newMax) || ! GROW(pSystem->pz, newMax) ||
+		! GROW(pSystem->vx, newMax) || ! GROW(pSystem->vy, newMax) || ! GROW(pSystem->vz, newMax) ||
+		! GROW(pSystem->ax, newMax) || ! GROW(pSystem->ay, newMax) || ! GROW(pSystem->az, newMax) ||
+		! GROW(pSystem->mass, newMax) || ! GROW(pSystem->oneOverMass, newMax) || ! GROW(pSystem->t, newMax) ||
+		! GROW(pSystem->batched, newMax) || ! GROW(pSystem->nextFree, newMax) || ! GROW(pSystem->particles, newMax))
+		return JE_FALSE;
+
+	pSystem->maxSlots = newMax;
+
+	return JE_TRUE;
+}
+
+static jeBoolean jePhysicsSystem_GrowSprings(jePhysicsSystem* pSystem)
+{
+	int32 newMax;
+
+	newMax = pSystem->maxSprings ? pSystem->maxSprings * 2 : JE_PHYSICS_START_SLOTS;
+
+	if (! GROW(pSystem->s1, newMax) || ! GROW(pSystem->s2, newMax) ||
+		! GROW(pSystem->Ks, newMax) || ! GROW(pSystem->Kd, newMax) || ! GROW(pSystem->r0, newMax) ||
+		! GROW(pSystem->fx, newMax) || ! GROW(pSystem->fy, newMax) || ! GROW(pSystem->fz, newMax) ||
+		! GROW(pSystem->springBatched, newMax) || ! GROW(pSystem->springs, newMax))
+		return JE_FALSE;
+
+	pSystem->maxSprings = newMax;
+
+	return JE_TRUE;
+}
+
+#undef GROW
+
+/////////////////////////////////////////////////////////////////////////////////
+// ctor / dtor
+
+jePhysicsSystem* jePhysicsSystem_Create(void)
+{
+	jePhysicsSystem* pSystem;
+
+	pSystem = JE_RAM_ALLOCATE_STRUCT_CLEAR(jePhysicsSystem);
+	if (! pSystem) return NULL;
+
+	pSystem->freeSlot = -1;
+
+	return pSystem;
+}
+
+void jePhysicsSystem_Destroy(jePhysicsSystem** ppSystem)
+{
+	jePhysicsSystem* pSystem;
+	int32 i;
+
+	assert(ppSystem);
+	assert(*ppSystem);
+
+	pSystem = *ppSystem;
+
+	for (i = 0; i < pSystem->numSprings; i++)
+		jeRam_Free(pSystem->springs[i]);
+
+	for (i = 0; i < pSystem->numSlots; i++)
+	{
+		if (pSystem->particles[i])
+			jeRam_Free(pSystem->particles[i]);
+	}
+
+	if (pSystem->maxSlots)
+	{
+		jeRam_Free(pSystem->px); jeRam_Free(pSystem->py); jeRam_Free(pSystem->pz);
+		jeRam_Free(pSystem->vx); jeRam_Free(pSystem->vy); jeRam_Free(pSystem->vz);
+		jeRam_Free(pSystem->ax); jeRam_Free(pSystem->ay); jeRam_Free(pSystem->az);
+		jeRam_Free(pSystem->mass); jeRam_Free(pSystem->oneOverMass); jeRam_Free(pSystem->t);
+		jeRam_Free(pSystem->batched); jeRam_Free(pSystem->nextFree); jeRam_Free(pSystem->particles);
+	}
+
+	if (pSystem->maxSprings)
+	{
+		jeRam_Free(pSystem->s1); jeRam_Free(pSystem->s2);
+		jeRam_Free(pSystem->Ks); jeRam_Free(pSystem->Kd); jeRam_Free(pSystem->r0);
+		jeRam_Free(pSystem->fx); jeRam_Free(pSystem->fy); jeRam_Free(pSystem->fz);
+		jeRam_Free(pSystem->springBatched); jeRam_Free(pSystem->springs);
+	}
+
+	jeRam_Free(*ppSystem);
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// contents
+
+jeParticle* jePhysicsSystem_AddParticle(jePhysicsSystem* pSystem, float mass, const jeVec3d* p,
+	const jeVec3d* v, jeParticle_Flags flags, jeParticle_IntegratorFunc integratorFunc)
+{
+	jeParticle* part;
+	int32 index;
+
+	assert(pSystem);
+	assert(p);
+	assert(v);
+
+	if (pSystem->freeSlot < 0 && pSystem->numSlots == pSystem->maxSlots)
+	{
+		if (! jePhysicsSystem_GrowSlots(pSystem))
+			return NULL;
+	}
+
+	part = JE_RAM_ALLOCATE_STRUCT_CLEAR(jeParticle);
+	if (! part) return NULL;
+
+	if (pSystem->freeSlot >= 0)
+	{
+		index = pSystem->freeSlot;
+		pSystem->freeSlot = pSystem->nextFree[index];
+	}
+	else
+		index = pSystem->numSlots++;
+
+	part->flags = flags;
+	part->integratorFunc = integratorFunc;
+	part->system = pSystem;
+	part->index = index;
+
+	pSystem->particles[index] = part;
+	pSystem->numParticles++;
+
+	pSystem->px[index] = p->X;
+	pSystem->py[index] = p->Y;
+	pSystem->pz[index] = p->Z;
+	pSystem->vx[index] = v->X;
+	pSystem->vy[index] = v->Y;
+	pSystem->vz[index] = v->Z;
+	pSystem->ax[index] = pSystem->ay[index] = pSystem->az[index] = 0.f;
+	pSystem->t[index] = 0.f;
+
+	jeParticle_SetMass(part, mass);
+	jePhysicsSystem_UpdateParticle(pSystem, index);
+
+	return part;
+}
+
+jeSpring* jePhysicsSystem_AddSpring(jePhysicsSystem* pSystem, float Ks, float Kd, jeParticle* p1,
+	jeParticle* p2, jeSpring_ForceFunc forceFunc)
+{
+	jeSpring* pSpring;
+
+	assert(pSystem);
+	assert(p1 && p1->system == pSystem);
+	assert(p2 && p2->system == pSystem);
+
+	if (pSystem->numSprings == pSystem->maxSprings)
+	{
+		if (! jePhysicsSystem_GrowSprings(pSystem))
+			return NULL;
+	}
+
+	pSpring = jeSpring_Create(Ks, Kd, p1, p2, forceFunc);
+	if (! pSpring) return NULL;
+
+	pSpring->system = pSystem;
+	pSpring->index = pSystem->numSprings++;
+
+	pSystem->springs[pSpring->index] = pSpring;
+
+	jePhysicsSystem_UpdateSpring(pSystem, pSpring->index);
+
+	return pSpring;
+}
+
+int32 jePhysicsSystem_GetParticleCount(const jePhysicsSystem* pSystem)
+{
+	assert(pSystem);
+
+	return pSystem->numParticles;
+}
+
+int32 jePhysicsSystem_GetSpringCount(const jePhysicsSystem* pSystem)
+{
+	assert(pSystem);
+
+	return pSystem->numSprings;
+}
+
+void jePhysicsSystem_RemoveParticle(jePhysicsSystem* pSystem, int32 index)
+{
+#ifndef NDEBUG
+	int32 i;
+#endif
+
+	assert(pSystem);
+	assert(index >= 0 && index < pSystem->numSlots);
+	assert(pSystem->particles[index]);
+
+#ifndef NDEBUG
+	for (i = 0; i < pSystem->numSprings; i++)
+		assert(pSystem->s1[i] != index && pSystem->s2[i] != index);
+#endif
+
+	pSystem->particles[index] = NULL;
+	pSystem->batched[index] = 0;
+	pSystem->nextFree[index] = pSystem->freeSlot;
+	pSystem->freeSlot = index;
+	pSystem->numParticles--;
+}
+
+void jePhysicsSystem_RemoveSpring(jePhysicsSystem* pSystem, int32 index)
+{
+	int32 last;
+
+	assert(pSystem);
+	assert(index >= 0 && index < pSystem->numSprings);
+
+	last = --pSystem->numSprings;
+
+	if (index != last)
+	{
+		pSystem->springs[index] = pSystem->springs[last];
+		pSystem->springs[index]->index = index;
+
+		pSystem->s1[index] = pSystem->s1[last];
+		pSystem->s2[index] = pSystem->s2[last];
+		pSystem->Ks[index] = pSystem->Ks[last];
+		pSystem->Kd[index] = pSystem->Kd[last];
+		pSystem->r0[index] = pSystem->r0[last];
+		pSystem->springBatched[index] = pSystem->springBatched[last];
+	}
+}
+
+void jePhysicsSystem_UpdateParticle(jePhysicsSystem* pSystem, int32 index)
+{
+	jeParticle* part;
+
+	assert(pSystem);
+	assert(index >= 0 && index < pSystem->numSlots);
+
+	part = pSystem->particles[index];
+	assert(part);
+
+	pSystem->batched[index] = (part->integratorFunc == jeParticle_IntegratorFunc_EulerStep) ? 0xFFFFFFFF : 0;
+}
+
+void jePhysicsSystem_UpdateSpring(jePhysicsSystem* pSystem, int32 index)
+{
+	jeSpring* pSpring;
+
+	assert(pSystem);
+	assert(index >= 0 && index < pSystem->numSprings);
+
+	pSpring = pSystem->springs[index];
+	assert(pSpring->p1->system == pSystem);
+	assert(pSpring->p2->system == pSystem);
+
+	pSystem->s1[index] = pSpring->p1->index;
+	pSystem->s2[index] = pSpring->p2->index;
+	pSystem->Ks[index] = pSpring->Ks;
+	pSystem->Kd[index] = pSpring->Kd;
+	pSystem->r0[index] = pSpring->r0;
+	pSystem->springBatched[index] = (pSpring->forceFunc == (jeSpring_ForceFunc)jeSpring_ForceFunc_ComputeDamped) ? 0xFFFFFFFF : 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// batch passes
+
+// Same maths as jeSpring_ForceFunc_ComputeDamped, for springs [start, end)
+static void jePhysicsSystem_SpringForces(int32 start, int32 end, void* context)
+{
+	jePhysicsSystem* pSystem = (jePhysicsSystem*)context;
+	const float *px = pSystem->px, *py = pSystem->py, *pz = pSystem->pz;
+	const float *vx = pSystem->vx, *vy = pSystem->vy, *vz = pSystem->vz;
+	const int32 *s1 = pSystem->s1, *s2 = pSystem->s2;
+	int32 i = start;
+
+#ifdef JE_PHYSICS_SSE
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.f);
+
+	for (; i + 4 <= end; i += 4)
+	{
+		__m128 dx, dy, dz, dvx, dvy, dvz, len, inv, C, Cdot, F;
+		int32 a0 = s1[i], a1 = s1[i + 1], a2 = s1[i + 2], a3 = s1[i + 3];
+		int32 b0 = s2[i], b1 = s2[i + 1], b2 = s2[i + 2], b3 = s2[i + 3];
+
+		dx = _mm_sub_ps(_mm_setr_ps(px[a0], px[a1], px[a2], px[a3]), _mm_setr_ps(px[b0], px[b1], px[b2], px[b3]));
+		dy = _mm_sub_ps(_mm_setr_ps(py[a0], py[a1], py[a2], py[a3]), _mm_setr_ps(py[b0], py[b1], py[b2], py[b3]));
+		dz = _mm_sub_ps(_mm_setr_ps(pz[a0], pz[a1], pz[a2], pz[a3]), _mm_setr_ps(pz[b0], pz[b1], pz[b2], pz[b3]));
+
+		len = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+
+		// A zero length leaves the direction zero, like jeVec3d_Normalize
+		inv = _mm_and_ps(_mm_div_ps(one, len), _mm_cmpneq_ps(len, zero));
+		dx = _mm_mul_ps(dx, inv);
+		dy = _mm_mul_ps(dy, inv);
+		dz = _mm_mul_ps(dz, inv);
+
+		C = _mm_sub_ps(len, _mm_loadu_ps(pSystem->r0 + i));
+
+		dvx = _mm_sub_ps(_mm_setr_ps(vx[a0], vx[a1], vx[a2], vx[a3]), _mm_setr_ps(vx[b0], vx[b1], vx[b2], vx[b3]));
+		dvy = _mm_sub_ps(_mm_setr_ps(vy[a0], vy[a1], vy[a2], vy[a3]), _mm_setr_ps(vy[b0], vy[b1], vy[b2], vy[b3]));
+		dvz = _mm_sub_ps(_mm_setr_ps(vz[a0], vz[a1], vz[a2], vz[a3]), _mm_setr_ps(vz[b0], vz[b1], vz[b2], vz[b3]));
+
+		Cdot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dvx), _mm_mul_ps(dy, dvy)), _mm_mul_ps(dz, dvz));
+
+		F = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(pSystem->Ks + i), C), _mm_mul_ps(_mm_loadu_ps(pSystem->Kd + i), Cdot));
+		F = _mm_sub_ps(zero, F);
+
+		_mm_storeu_ps(pSystem->fx + i, _mm_mul_ps(F, dx));
+		_mm_storeu_ps(pSystem->fy + i, _mm_mul_ps(F, dy));
+		_mm_storeu_ps(pSystem->fz + i, _mm_mul_ps(F, dz));
+	}
+#endif
+
+	for (; i < end; i++)
+	{
+		float dx, dy, dz, len, C, Cdot, F;
+		int32 a = s1[i], b = s2[i];
+
+		dx = px[a] - px[b];
+		dy = py[a] - py[b];
+		dz = pz[a] - pz[b];
+
+		len = (float)sqrt(dx * dx + dy * dy + dz * dz);
+
+		if (len != 0.f)
+		{
+			float inv = 1.f / len;
+
+			dx *= inv;
+			dy *= inv;
+			dz *= inv;
+		}
+
+		C = len - pSystem->r0[i];
+
+		Cdot = dx * (vx[a] - vx[b]) + dy * (vy[a] - vy[b]) + dz * (vz[a] - vz[b]);
+
+		F = -(pSystem->Ks[i] * C + pSystem->Kd[i] * Cdot);
+
+		pSystem->fx[i] = F * dx;
+		pSystem->fy[i] = F * dy;
+		pSystem->fz[i] = F * dz;
+	}
+}
+
+// Same maths as jeParticle_IntegratorFunc_EulerStep, for slots [start, end)
+static void jePhysicsSystem_Integrate(int32 start, int32 end, void* context)
+{
+	jePhysicsSystem* pSystem = (jePhysicsSystem*)context;
+	float *px = pSystem->px, *py = pSystem->py, *pz = pSystem->pz;
+	float *vx = pSystem->vx, *vy = pSystem->vy, *vz = pSystem->vz;
+	const float *ax = pSystem->ax, *ay = pSystem->ay, *az = pSystem->az;
+	const uint32 *batched = pSystem->batched;
+	float dt = pSystem->dt;
+	int32 i = start;
+
+#ifdef JE_PHYSICS_SSE
+	const __m128 dt4 = _mm_set1_ps(dt);
+
+	// Slots that are not batched keep their old values through the mask
+	#define EULER_AXIS(p, v, a)															\
+	{																					\
+		__m128 P = _mm_loadu_ps(p + i), V = _mm_loadu_ps(v + i);						\
+		__m128 dv = _mm_mul_ps(dt4, _mm_loadu_ps(a + i));								\
+		__m128 newP = _mm_add_ps(P, _mm_add_ps(_mm_mul_ps(dt4, V), dv));				\
+		__m128 newV = _mm_add_ps(V, dv);												\
+		_mm_storeu_ps(p + i, _mm_or_ps(_mm_and_ps(mask, newP), _mm_andnot_ps(mask, P)));	\
+		_mm_storeu_ps(v + i, _mm_or_ps(_mm_and_ps(mask, newV), _mm_andnot_ps(mask, V)));	\
+	}
+
+	for (; i + 4 <= end; i += 4)
+	{
+		__m128 mask = _mm_loadu_ps((const float*)(batched + i));
+
+		if (! _mm_movemask_ps(mask))
+			continue;
+
+		EULER_AXIS(px, vx, ax)
+		EULER_AXIS(py, vy, ay)
+		EULER_AXIS(pz, vz, az)
+	}
+
+	#undef EULER_AXIS
+#endif
+
+	for (; i < end; i++)
+	{
+		float dvx, dvy, dvz;
+
+		if (! batched[i])
+			continue;
+
+		dvx = dt * ax[i];
+		dvy = dt * ay[i];
+		dvz = dt * az[i];
+
+		px[i] += dt * vx[i] + dvx;
+		py[i] += dt * vy[i] + dvy;
+		pz[i] += dt * vz[i] + dvz;
+
+		vx[i] += dvx;
+		vy[i] += dvy;
+		vz[i] += dvz;
+	}
+}
+
+static void jePhysicsSystem_Run(jePhysicsSystem* pSystem, int32 count, jeParallel_RangeFunc func)
+{
+	if (pSystem->parallel && count >= JE_PHYSICS_PARALLEL_MIN)
+		jeParallel_ForRange(count, JE_PHYSICS_PARALLEL_GRAIN, func, pSystem);
+	else
+		func(0, count, pSystem);
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// fns
+
+jeBoolean jePhysicsSystem_SetParallel(jePhysicsSystem* pSystem, jeBoolean parallel)
+{
+	assert(pSystem);
+
+	pSystem->parallel = parallel;
+
+	return JE_TRUE;
+}
+
+jeBoolean jePhysicsSystem_AddAcc(jePhysicsSystem* pSystem, const jeVec3d* pAcc)
+{
+	int32 i;
+
+	assert(pSystem);
+	assert(pAcc);
+
+	// Free slots are included; their acceleration is never used
+	for (i = 0; i < pSystem->numSlots; i++)
+	{
+		pSystem->ax[i] += pAcc->X;
+		pSystem->ay[i] += pAcc->Y;
+		pSystem->az[i] += pAcc->Z;
+	}
+
+	return JE_TRUE;
+}
+
+jeBoolean jePhysicsSystem_Step(jePhysicsSystem* pSystem, float dt)
+{
+	int32 i;
+
+	assert(pSystem);
+	assert(dt > JE_EPSILON);
+
+	pSystem->dt = dt;
+
+	// Spring forces.  The forces are computed in parallel, but added to the particles
+	// in spring order so the result doesn't depend on the thread count.
+	if (pSystem->numSprings)
+	{
+		jePhysicsSystem_Run(pSystem, pSystem->numSprings, jePhysicsSystem_SpringForces);
+
+		for (i = 0; i < pSystem->numSprings; i++)
+		{
+			int32 a, b;
+
+			if (! pSystem->springBatched[i])
+				continue;
+
+			a = pSystem->s1[i];
+			b = pSystem->s2[i];
+
+			pSystem->ax[a] += pSystem->oneOverMass[a] * pSystem->fx[i];
+			pSystem->ay[a] += pSystem->oneOverMass[a] * pSystem->fy[i];
+			pSystem->az[a] += pSystem->oneOverMass[a] * pSystem->fz[i];
+
+			pSystem->ax[b] += pSystem->oneOverMass[b] * -pSystem->fx[i];
+			pSystem->ay[b] += pSystem->oneOverMass[b] * -pSystem->fy[i];
+			pSystem->az[b] += pSystem->oneOverMass[b] * -pSystem->fz[i];
+		}
+
+		for (i = 0; i < pSystem->numSprings; i++)
+		{
+			jeSpring* pSpring = pSystem->springs[i];
+
+			if (! pSystem->springBatched[i] && pSpring->forceFunc)
+				pSpring->forceFunc(pSpring, dt);
+		}
+	}
+
+	// Integration
+	jePhysicsSystem_Run(pSystem, pSystem->numSlots, jePhysicsSystem_Integrate);
+
+	for (i = 0; i < pSystem->numSlots; i++)
+	{
+		jeParticle* part = pSystem->particles[i];
+
+		if (part && ! pSystem->batched[i] && part->integratorFunc)
+			part->integratorFunc(part, dt);
+	}
+
+	for (i = 0; i < pSystem->numSlots; i++)
+		pSystem->t[i] += dt;
+
+	memset(pSystem->ax, 0, pSystem->numSlots * sizeof(float));
+	memset(pSystem->ay, 0, pSystem->numSlots * sizeof(float));
+	memset(pSystem->az, 0, pSystem->numSlots * sizeof(float));
+
+	return JE_TRUE;
+}
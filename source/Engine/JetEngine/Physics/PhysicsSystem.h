@@ -0,0 +1,71 @@
+/****************************************************************************************/
+/*  PHYSICSSYSTEM.H                                                                     */
+/*                                                                                      */
+/*  Author: Styx3D Modernization                                                        */
+/*  Description: Batched particle / spring container                                    */
+/*                                                                                      */
+/*  The contents of this file are subject to the 0BSD License.                          */
+/*  See LICENSE file in the project root for full license information.                  */
+/*                                                                                      */
+/****************************************************************************************/
+#ifndef JE_PHYSICSSYSTEM_H
+#define JE_PHYSICSSYSTEM_H
+
+#include "BaseType.h"
+#include "Vec3d.h"
+
+#include "Part.h"
+#include "Spring.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//	A system keeps the state of its particles and springs in flat arrays and steps them
+//	all at once.  Add returns the usual jeParticle / jeSpring handles, so the rest of the
+//	Part.h and Spring.h API keeps working on them, and jeParticle_Destroy / jeSpring_Destroy
+//	remove them from the system.  A particle must outlive the springs attached to it.
+//
+//	Particles using jeParticle_IntegratorFunc_EulerStep and springs using
+//	jeSpring_ForceFunc_ComputeDamped are handled by the batch pass; any other function is
+//	still called once per object through its handle.
+
+typedef struct jePhysicsSystem jePhysicsSystem;
+
+/////////////////////////////////////////////////////////////////////////////////
+// ctor / dtor
+
+jePhysicsSystem* jePhysicsSystem_Create(void);
+// Also destroys every particle and spring still in the system
+void jePhysicsSystem_Destroy(jePhysicsSystem** ppSystem);
+
+/////////////////////////////////////////////////////////////////////////////////
+// contents
+
+jeParticle* jePhysicsSystem_AddParticle(jePhysicsSystem* pSystem, float mass, const jeVec3d* p,
+	const jeVec3d* v, jeParticle_Flags flags, jeParticle_IntegratorFunc integratorFunc);
+// Both particles must belong to pSystem
+jeSpring* jePhysicsSystem_AddSpring(jePhysicsSystem* pSystem, float Ks, float Kd, jeParticle* p1,
+	jeParticle* p2, jeSpring_ForceFunc forceFunc);
+
+int32 jePhysicsSystem_GetParticleCount(const jePhysicsSystem* pSystem);
+int32 jePhysicsSystem_GetSpringCount(const jePhysicsSystem* pSystem);
+
+/////////////////////////////////////////////////////////////////////////////////
+// fns
+
+// Large systems split the batch passes across the jeParallel pool.  Off by default.
+jeBoolean jePhysicsSystem_SetParallel(jePhysicsSystem* pSystem, jeBoolean parallel);
+
+// Adds pAcc to every particle, e.g. gravity
+jeBoolean jePhysicsSystem_AddAcc(jePhysicsSystem* pSystem, const jeVec3d* pAcc);
+
+// Applies the spring forces, integrates every particle with the accelerations
+// accumulated since the last step, advances their time and clears the accelerations
+jeBoolean jePhysicsSystem_Step(jePhysicsSystem* pSystem, float dt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -27,16 +27,7 @@
 
 #include "Part.h"
 #include "Spring.h"
-
-typedef struct jeSpring
-{
-	jeParticle* p1, *p2;
-	float Ks, Kd; // spring and damping constants
-	float r0; // initial length
-
-	jeSpring_ForceFunc forceFunc;
-
-}jeSpring;
+#include "PhysicsSystem._h"
 
 static void jeSpring_ComputeR0(jeSpring* pSpring)
 {
@@ -73,6 +64,7 @@ jeSpring* jeSpring_Create(float Ks, float Kd, jeParticle* p1, jeParticle* p2,
 	pSpring->p1 = p1;
 	pSpring->p2 = p2;
 	pSpring->forceFunc = forceFunc;
+	pSpring->system = NULL;
 
 	jeSpring_ComputeR0(pSpring);
 
@@ -84,6 +76,9 @@ void jeSpring_Destroy(jeSpring** ppSpring)
 	assert(ppSpring);
 	assert(*ppSpring);
 
+	if ((*ppSpring)->system)
+		jePhysicsSystem_RemoveSpring((*ppSpring)->system, (*ppSpring)->index);
+
 	jeRam_Free(*ppSpring);
 	*ppSpring = NULL;
 }
@@ -144,6 +139,9 @@ jeBoolean jeSpring_SetPart1(jeSpring* pSpring, const jeParticle* part1)
 
 	jeSpring_ComputeR0(pSpring);
 
+	if (pSpring->system)
+		jePhysicsSystem_UpdateSpring(pSpring->system, pSpring->index);
+
 	return JE_TRUE;
 }
 
@@ -156,6 +154,9 @@ jeBoolean jeSpring_SetPart2(jeSpring* pSpring, const jeParticle* part2)
 
 	jeSpring_ComputeR0(pSpring);
 
+	if (pSpring->system)
+		jePhysicsSystem_UpdateSpring(pSpring->system, pSpring->index);
+
 	return JE_TRUE;
 }
 
@@ -166,6 +167,9 @@ jeBoolean jeSpring_SetKs(jeSpring* pSpring, float Ks)
 
 	pSpring->Ks = Ks;
 
+	if (pSpring->system)
+		jePhysicsSystem_UpdateSpring(pSpring->system, pSpring->index);
+
 	return JE_TRUE;
 }
 
@@ -176,6 +180,9 @@ jeBoolean jeSpring_SetKd(jeSpring* pSpring, float Kd)
 
 	pSpring->Kd = Kd;
 
+	if (pSpring->system)
+		jePhysicsSystem_UpdateSpring(pSpring->system, pSpring->index);
+
 	return JE_TRUE;
 }
 
@@ -186,6 +193,9 @@ jeBoolean jeSpring_SetForceFunc(jeSpring* pSpring, jeSpring_ForceFunc forceFunc)
 
 	pSpring->forceFunc = forceFunc;
 
+	if (pSpring->system)
+		jePhysicsSystem_UpdateSpring(pSpring->system, pSpring->index);
+
 	return JE_TRUE;
 }
 
@@ -17,13 +17,24 @@
 /*  The Original Code is Jet3D, released December 12, 1999.                             */
 /*  Copyright (C) 1996-1999 Eclipse Entertainment, L.L.C. All Rights Reserved           */
 /*                                                                                      */
+/*  Jobs waiting for a thread sit in one list, high priority at the front.  Job threads */
+/*  are made on demand up to the thread limit and sleep on a condition variable when    */
+/*  the list is empty, so nothing has to call PollJobs for work to start, and           */
+/*  WaitOnJob blocks instead of sleeping in a loop.  These jobs stream files and may    */
+/*  block for seconds, so they get threads of their own rather than going on the        */
+/*  jeParallel workers, which are kept for short compute tasks.                         */
+/*                                                                                      */
 /****************************************************************************************/
-#include	<windows.h>
-
 #include	<assert.h>
 #include	<stdio.h>
 #include	<stdlib.h>
-#include	<process.h>
+#include	<string.h>
+
+#include	<chrono>
+#include	<condition_variable>
+#include	<mutex>
+#include	<new>
+#include	<thread>
 
 #include	"ThreadQueue.h"
 #include	"mempool.h"
@@ -37,467 +48,215 @@
 #include	"ram.h"
 #endif
 
-#define	THREADSTACKSIZE	(0x10000)
-#define	MAX_THREADS		(100)	// this is just the static array size
+#define	MAX_THREADS		(100)
 
 /*}{******** The Types **********/
 
-typedef	enum
-{
-	TS_NOTSTARTED,
-	TS_FREE=0,
-	TS_PENDING,
-	TS_OUGHTTOBERUNNING,
-	TS_RUNNING,
-	TS_DONE,
-}	Thread_State;
-
-//typedef	void (*Thread_Function)(Thread *, void *);
-typedef	void (*Thread_Function)(void *);
-
-typedef	struct	Thread
-{
-	Thread_State		State;
-	HANDLE				ThreadStallingEvent;
-	Thread_Function		Function;
-	void *				Context;
-	jeBoolean			Terminate;
-//	HANDLE				Handle;
-}	Thread;
-
-typedef	struct	ThreadPool
-{
-	Thread				Threads[MAX_THREADS];
-//	int					MaxThreads;
-	int					NumThreads;
-	CRITICAL_SECTION	CS;
-}	ThreadPool;
-
 #define JOB_SIGNATURE 0xFEEDFEED
 
 typedef	struct	jeThreadQueue_Job
 {
-//	HANDLE				ThreadHandle;
 	uint32				Signature;
-	jeThreadQueue_JobStatus	Status;
+	jeThreadQueue_JobStatus	Status;			// Guarded by the queue lock
 	int					RefCount;
-//	jeAsyncStatus		Status;
-//	jeBoolean			Active;
 
 	jeThreadQueue_JobFunction	Function;
 	void *				Context;
 	jeErrorLog *		ErrorLog;
-//	uint32				StackLimit;
 
-	jeThreadQueue_Job *	Next;
+	jeThreadQueue_Job *	Next;				// Links in the pending list, while WAITINGFORTHREAD
 	jeThreadQueue_Job *	Prev;
-	Thread *			Thread;
-
 }	jeThreadQueue_Job;
 
 
 /*}{******** The Statics that represent the active Pool **********/
 
 /*
-		ActiveJobCount is the count of jobs that have threads assigned.
+		Lock guards the pending list, every job's Status and RefCount and the
+		thread counts below.  It is never freed: the job threads still sleep on
+		WorkCV when static destructors run at exit.
 */
-static	int					ActiveJobCount = 0,MaxActiveJobs = MAX_THREADS;
-
-static	ThreadPool *		GlobalThreadPool = NULL;
+typedef	struct	ThreadQueue_Sync
+{
+	std::mutex					Lock;
+	std::condition_variable		WorkCV;			// A job was queued, or a thread slot freed up
+	std::condition_variable		StatusCV;		// Some job changed status
+}	ThreadQueue_Sync;
 
-/*
-		JobList is a circular list of jobs.  Jobs at the front are high
-		priority.  Jobs at the back are low priority.
-*/
-#pragma warning (disable:4152)	// nonstandard extension, function/data pointer conversion in expression
-static	jeThreadQueue_Job 	JobList =
+static	ThreadQueue_Sync *	GetSync(void)
 {
-//	(HANDLE)-1,
-	JOB_SIGNATURE,
-	JE_THREADQUEUE_STATUS_COMPLETED,
-	1,
-	//(void *)0xBEEFFACE,
-	//(void *)0xCAFEDEAD,
-	NULL,
-	NULL,
-	0,
-};
-#pragma warning (default:4152)
+	static	ThreadQueue_Sync *	Sync = new ThreadQueue_Sync;
 
-/*
-		QueueLock is a critical section to guard access to the queue and
-		status information.
-*/
-static	CRITICAL_SECTION	QueueLock;
-//static	jeBoolean			QueueLockFlag;
+	return Sync;
+}
 
 /*
-		TQInitialized is whether we've initialized the system.
+		PendingList is a circular list of the jobs that have no thread yet.
+		Jobs at the front are high priority.  Jobs at the back are low priority.
 */
+static	jeThreadQueue_Job 	PendingList;
 static	jeBoolean			TQInitialized = JE_FALSE;
 
-/*}{******** Functions **********/
-
-static	void	LockQueue(void)
-{
-	EnterCriticalSection(&QueueLock);
-//	QueueLockFlag = JE_TRUE;
-}
+static	int					ActiveJobCount = 0,MaxActiveJobs = MAX_THREADS;
+static	int					NumThreads = 0, NumIdleThreads = 0;
 
-static	void	UnlockQueue(void)
-{
-//	QueueLockFlag = JE_FALSE;
-	LeaveCriticalSection(&QueueLock);
-}
+/*}{******** Functions **********/
 
-static	void __cdecl ThreadFunction(void *Context)
+static	void	InitLockedTQ(void)
 {
-	Thread *	T;
-
-	T = (Thread*)Context;
-
-	for	(;;)
+	if ( TQInitialized == JE_FALSE )
 	{
-		WaitForSingleObject(T->ThreadStallingEvent, INFINITE);
+		PendingList.Signature = JOB_SIGNATURE;
+		PendingList.Status = JE_THREADQUEUE_STATUS_COMPLETED;
+		PendingList.RefCount = 1;
+		PendingList.Next = &PendingList;
+		PendingList.Prev = &PendingList;
 
-		ActiveJobCount ++;
-		T->State = TS_RUNNING;
-
-		(T->Function)(T->Context);
-
-		T->State = TS_DONE;
-		ActiveJobCount --;
+		TQInitialized = JE_TRUE;
 	}
 }
 
-void	Thread_Run(Thread *T, Thread_Function Function, void *Context)
+static	void	UnlinkLockedJob(jeThreadQueue_Job *Job)
 {
-	assert(T->State == TS_PENDING);
-
-	T->Function = Function;
-	T->Context = Context;
-	T->State = TS_OUGHTTOBERUNNING;
-
-	PulseEvent(T->ThreadStallingEvent);
+	Job->Prev->Next = Job->Next;
+	Job->Next->Prev = Job->Prev;
+	Job->Next = Job->Prev = NULL;
 }
 
-jeBoolean ThreadPool_Destroy(ThreadPool *Pool)
+static	void	LinkLockedJob(jeThreadQueue_Job *Job, jeThreadQueue_Priority Priority)
 {
-	int	i;
-
-	assert(Pool);
-
-	for	(i = 0; i < Pool->NumThreads; i++)
+	if	(Priority == JE_THREADQUEUE_PRIORITY_HIGH)
 	{
-		if	(Pool->Threads[i].State != TS_FREE)
-		{
-			jeErrorLog_AddString(-1,"ThreadQueue : cannot free threadpool : threads still running!",NULL);
-			return JE_FALSE;
-		}
-
-		CloseHandle(Pool->Threads[i].ThreadStallingEvent);
+		Job->Next = PendingList.Next;
+		Job->Prev = &PendingList;
+	}
+	else
+	{
+		assert(Priority == JE_THREADQUEUE_PRIORITY_LOW);
+		Job->Next = &PendingList;
+		Job->Prev = PendingList.Prev;
 	}
 
-	DeleteCriticalSection(&Pool->CS);
-	jeRam_Free(Pool);
-
-	return JE_TRUE;
+	Job->Prev->Next = Job;
+	Job->Next->Prev = Job;
 }
 
-jeBoolean InitThread(Thread * T)
+static	jeBoolean	CheckLockedQueue(void)
 {
-	assert(T);
+	jeThreadQueue_Job *	Runner;
+	int					Count;
 
-	memset(T,0,sizeof(*T));
-
-	T->State = TS_FREE;
-	T->ThreadStallingEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
-	if ( T->ThreadStallingEvent == NULL )
-	{
+	if	(PendingList.Status != JE_THREADQUEUE_STATUS_COMPLETED)
 		return JE_FALSE;
-	}
 
-	if ( _beginthread(ThreadFunction, THREADSTACKSIZE, T) == -1 )
+	Count = 0;
+	for	(Runner = PendingList.Next; Runner != &PendingList; Runner = Runner->Next)
 	{
-		CloseHandle(T->ThreadStallingEvent);
-		return JE_FALSE;
+		if	(Runner->Signature != JOB_SIGNATURE ||
+			 Runner->Status != JE_THREADQUEUE_STATUS_WAITINGFORTHREAD ||
+			 Runner->Next->Prev != Runner)
+			return JE_FALSE;
+
+		//  Is there a loop?
+		if	(++Count > 1<<24)
+			return JE_FALSE;
 	}
 
-return JE_TRUE;
+	return JE_TRUE;
 }
 
-ThreadPool *	ThreadPool_Create(void)
+/*
+		RunLockedJob runs a job the caller just took off the pending list.  The lock
+		is dropped while the job function runs.
+*/
+static	void	RunLockedJob(std::unique_lock<std::mutex> &Guard, jeThreadQueue_Job *Job)
 {
-ThreadPool *	Pool;
+	assert(Job->Status == JE_THREADQUEUE_STATUS_WAITINGFORTHREAD);
 
-	Pool = (ThreadPool*)jeRam_AllocateClear(sizeof(*Pool));
-	if	(!Pool)
-		return Pool;
+	UnlinkLockedJob(Job);
 
-	InitializeCriticalSection(&Pool->CS);
+	ActiveJobCount++;
+	Job->Status = JE_THREADQUEUE_STATUS_RUNNING;
+	GetSync()->StatusCV.notify_all();
 
-	Pool->NumThreads = 0;
+	Guard.unlock();
 
-return Pool;
-}
+	(Job->Function)(Job, Job->Context);
+	assert(Job->Signature == JOB_SIGNATURE);
 
-Thread * ThreadPool_GetFreeThread(ThreadPool *Pool)
-{
-	Thread *	Result;
-	int			i;
+	Guard.lock();
 
-	EnterCriticalSection(&Pool->CS);
-	Result = NULL;
-	for	(i = 0; i < Pool->NumThreads; i++)
-	{
-	Thread * T;
-		T = Pool->Threads + i;
-#if 1 // @@
-		if ( T->State == TS_FREE || T->State == TS_DONE )
-#else
-		if ( T->State == TS_FREE )
-#endif
-		{
-			Result = T;
-			Result->State = TS_PENDING;
-			break;
-		}
-		// CB : why do we do this *after* the check?
-		#pragma message("ThreadPool : GetFreethread : CB wierd DONE -> FREE !")
-#if 0 // @@
-		if	(Pool->Threads[i].State == TS_DONE)
-			Pool->Threads[i].State = TS_FREE;
-#endif
-	}
-	if ( ! Result )
-	{
-		// with MaxActiveJobCount, we should never hit this condition,
-		//	but with all the sync-up problems, what the hey?
-		if ( Pool->NumThreads < MAX_THREADS )
-		{
-			Result =&(Pool->Threads[Pool->NumThreads]);
-			if ( InitThread(Result) )
-			{
-				Pool->NumThreads++;
-				Result->State = TS_PENDING;
-			}
-			else
-			{
-				Result = NULL;
-			}
-			Log_Printf("ThreadQueue : extending pool to %d threads\n",Pool->NumThreads);
-		}
-	}
-	LeaveCriticalSection(&Pool->CS);
-
-	return Result;
+	ActiveJobCount--;
+	Job->Status = JE_THREADQUEUE_STATUS_COMPLETED;
+	GetSync()->StatusCV.notify_all();
+	GetSync()->WorkCV.notify_one();
 }
 
-static	jeBoolean	InitTQ(void)
+static	void	ThreadFunction(void)
 {
-	if ( TQInitialized == JE_FALSE )
-	{
-		JobList.Next = &JobList;
-		JobList.Prev = &JobList;
-		InitializeCriticalSection(&QueueLock);
+	std::unique_lock<std::mutex>	Guard(GetSync()->Lock);
 
-		TQInitialized = JE_TRUE;
-	}
-
-	if ( ! 	GlobalThreadPool )
+	for	(;;)
 	{
-		GlobalThreadPool = ThreadPool_Create();
-		if ( ! GlobalThreadPool )
-			return JE_FALSE;
-	}
-
-	return JE_TRUE;
-}
-
-typedef	enum
-{
-	CHECK_FORWARD,
-	CHECK_BACKWARD,
-}	DebugDirection;
+		NumIdleThreads++;
+		GetSync()->WorkCV.wait(Guard, [] { return PendingList.Next != &PendingList && ActiveJobCount < MaxActiveJobs; });
+		NumIdleThreads--;
 
-static	void	PutBreakPointHere(void)
-{
-	OutputDebugString("CheckQueue is about to fail\r\n");
+		RunLockedJob(Guard, PendingList.Next);
+	}
 }
 
-static	jeBoolean	CheckLockedQueue(DebugDirection Direction)
+/*
+		KickLockedQueue makes sure some thread will pick up the front job.  Threads
+		are never joined; they sleep on WorkCV until the process exits, like the
+		jeParallel workers.
+*/
+static	void	KickLockedQueue(void)
 {
-static	jeThreadQueue_Job *	Runner;
-static	jeThreadQueue_Job *	Runner2x;
-
-	/*
-		Some invariants:
-	*/
-	if	(JobList.Status != JE_THREADQUEUE_STATUS_COMPLETED)
-	{
-		PutBreakPointHere();
-		return JE_FALSE;
-	}
-#if 0
-	if	(JobList.ThreadHandle != (HANDLE)-1)
-	{
-		PutBreakPointHere();
-		return JE_FALSE;
-	}
-#endif
-	if	(JobList.Function != (jeThreadQueue_JobFunction)0xBEEFFACE)
-	{
-		PutBreakPointHere();
-		return JE_FALSE;
-	}
-	if	(JobList.Context != (void *)0xCAFEDEAD)
-	{
-		PutBreakPointHere();
-		return JE_FALSE;
-	}
-
-//	if	(JobList.StackLimit != 0)
-//	{
-//		PutBreakPointHere();
-//		return JE_FALSE;
-//	}
-
-	if	(Direction == CHECK_FORWARD)
-	{
-		Runner = JobList.Next;
-		Runner2x = JobList.Next->Next;
-	}
-	else
-	{
-		Runner = JobList.Prev;
-		Runner2x = JobList.Prev->Prev;
-	}
-
-	//  No jobs in the list?
-	if	(JobList.Next == &JobList)
-	{
-		if	(JobList.Prev != &JobList)
-		{
-			PutBreakPointHere();
-			return JE_FALSE;
-		}
-		return JE_TRUE;
-	}
+	if	(PendingList.Next == &PendingList || ActiveJobCount >= MaxActiveJobs)
+		return;
 
-	do
+	if	(NumIdleThreads == 0 && NumThreads < MaxActiveJobs)
 	{
-		if	(Runner->Status < JE_THREADQUEUE_STATUS_WAITINGFORTHREAD ||
-			 Runner->Status > JE_THREADQUEUE_STATUS_COMPLETED)
-		{
-			PutBreakPointHere();
-			return JE_FALSE;
-		}
-
-		//  Is there a loop?
-		if	(Runner == Runner2x)
-		{
-			PutBreakPointHere();
-			return JE_FALSE;
-		}
-
-		if	(Direction == CHECK_FORWARD)
+		try
 		{
-			Runner = Runner->Next;
-			Runner2x = Runner2x->Next->Next;
+			std::thread(ThreadFunction).detach();
+			NumThreads++;
+			Log_Printf("ThreadQueue : extending pool to %d threads\n",NumThreads);
 		}
-		else
+		catch ( ... )
 		{
-			Runner = Runner->Prev;
-			Runner2x = Runner2x->Prev->Prev;
+			// Runs when a thread frees up, or on whoever waits for it
 		}
+	}
 
-	}	while	(Runner != &JobList && Runner2x != &JobList);
-
-	return JE_TRUE;
-}
-
-static	jeBoolean	CheckQueue(DebugDirection Direction)
-{
-	jeBoolean	Result;
-
-	LockQueue();
-	Result = CheckLockedQueue(Direction);
-	UnlockQueue();
-	return Result;
-}
-
-static	void ThreadStart(void *Context)
-{
-	jeThreadQueue_Job *	Job;
-
-	Job = (jeThreadQueue_Job*)Context;
-
-	Job->Status = JE_THREADQUEUE_STATUS_RUNNING;
-	(Job->Function)(Job, Job->Context);
-	assert(Job->Signature == JOB_SIGNATURE);
-	Job->Status = JE_THREADQUEUE_STATUS_COMPLETED;
+	GetSync()->WorkCV.notify_one();
 }
 
 JETAPI	void JETCC jeThreadQueue_Sleep(int Milliseconds)
 {
-	Sleep(Milliseconds);
+	std::this_thread::sleep_for(std::chrono::milliseconds(Milliseconds));
 }
 
 JETAPI	jeThreadQueue_JobStatus	JETCC jeThreadQueue_JobGetStatus(const jeThreadQueue_Job *Job)
 {
-	return Job->Status;
-}
-
-static	void	ActivateJob(jeThreadQueue_Job *Job)
-{
-	Thread *			T;
-
-	T = ThreadPool_GetFreeThread(GlobalThreadPool);
-	if	(!T)
-		return;
+	std::lock_guard<std::mutex>	Guard(GetSync()->Lock);
 
-	Job->Status = JE_THREADQUEUE_STATUS_WAITINGTOBEGIN;
-	Job->Thread = T;
-	Thread_Run(T, ThreadStart, Job);
+	assert(Job);
+	return Job->Status;
 }
 
 JETAPI	void JETCC jeThreadQueue_PollJobs(void)
 {
-	jeThreadQueue_Job *	Jobs;
+	// Jobs start on their own now; this only pushes along a queue that was
+	//	stalled by a failed thread creation
+	std::lock_guard<std::mutex>	Guard(GetSync()->Lock);
 
-	if	(InitTQ() == JE_FALSE)
-	{
-#pragma message ("ThreadQueue_PollJobs: Need to be able to propagate err-ors")
-		return;
-	}
-
-	assert(CheckQueue(CHECK_FORWARD ) == JE_TRUE);
-	assert(CheckQueue(CHECK_BACKWARD) == JE_TRUE);
+	InitLockedTQ();
 
-#pragma message ("ThreadQueue_PollJobs: I must not be called from multiple threads!")
+	assert(CheckLockedQueue() == JE_TRUE);
 
-	if ( ActiveJobCount >= MaxActiveJobs )
-		return;
-
-	LockQueue();
-	Jobs = JobList.Next;
-	while	(Jobs != &JobList && (ActiveJobCount < MaxActiveJobs))
-//	while	(Jobs != &JobList)
-	{
-		if	(Jobs->Status == JE_THREADQUEUE_STATUS_WAITINGTOBEGIN)
-		{
-			if	(Jobs->Thread && Jobs->Thread->State == TS_OUGHTTOBERUNNING)
-				PulseEvent(Jobs->Thread->ThreadStallingEvent);
-		}
-
-		if	(Jobs->Status == JE_THREADQUEUE_STATUS_WAITINGFORTHREAD)
-		{
-			ActivateJob(Jobs);
-			break;
-		}
-		Jobs = Jobs->Next;
-	}
-	UnlockQueue();
+	KickLockedQueue();
 }
 
 JETAPI jeThreadQueue_Job *	JETCC jeThreadQueue_JobCreate(
@@ -508,12 +267,6 @@ JETAPI jeThreadQueue_Job *	JETCC jeThreadQueue_JobCreate(
 {
 	jeThreadQueue_Job *	Job;
 
-#pragma message("ThreadQueue_JobCreate : remove StackLimit parameter")
-
-	InitTQ();
-
-#pragma message("ThreadQueue : use MemPool for Jobs (?)")
-
 	Job = (jeThreadQueue_Job*)jeRam_AllocateClear(sizeof(*Job));
 	if	(!Job)
 		return Job;
@@ -522,7 +275,6 @@ JETAPI jeThreadQueue_Job *	JETCC jeThreadQueue_JobCreate(
 	Job->Function	= Function;
 	Job->Context	= Context;
 	Job->ErrorLog	= ErrorLog;
-//	Job->StackLimit	= StackLimit;
 	Job->Status = JE_THREADQUEUE_STATUS_WAITINGFORTHREAD;
 	Job->RefCount = 1;
 
@@ -530,12 +282,11 @@ JETAPI jeThreadQueue_Job *	JETCC jeThreadQueue_JobCreate(
 		New jobs always start out as low priority - they go to the
 		back of the list.
 	*/
-	LockQueue();
-	Job->Next = &JobList;
-	Job->Prev = JobList.Prev;
-	JobList.Prev->Next = Job;
-	JobList.Prev = Job;
-	UnlockQueue();
+	std::lock_guard<std::mutex>	Guard(GetSync()->Lock);
+
+	InitLockedTQ();
+	LinkLockedJob(Job, JE_THREADQUEUE_PRIORITY_LOW);
+	KickLockedQueue();
 
 	return Job;
 }
@@ -543,37 +294,32 @@ JETAPI jeThreadQueue_Job *	JETCC jeThreadQueue_JobCreate(
 JETAPI	void JETCC jeThreadQueue_JobCreateRef(jeThreadQueue_Job *Job)
 {
 	assert(Job);
-	LockQueue();
+
+	std::lock_guard<std::mutex>	Guard(GetSync()->Lock);
+
 	Job->RefCount++;
-	UnlockQueue();
 }
 
 JETAPI	void JETCC jeThreadQueue_JobDestroy(jeThreadQueue_Job **pJob)
 {
 	jeThreadQueue_Job *	Job;
 
-	LockQueue();
-
 	assert(pJob);
-	assert(*pJob != &JobList);
+	assert(*pJob != &PendingList);
 
 	Job = *pJob;
 
-	Job->RefCount--;
-	
-	if	(Job->RefCount)
 	{
-		UnlockQueue();
-		return;
-	}
+		std::lock_guard<std::mutex>	Guard(GetSync()->Lock);
 
-	Job->Prev->Next = Job->Next;
-	Job->Next->Prev = Job->Prev;
+		Job->RefCount--;
 
-	UnlockQueue();
+		if	(Job->RefCount)
+			return;
 
-	assert(Job->Signature == JOB_SIGNATURE);
-	assert(Job->Status == JE_THREADQUEUE_STATUS_COMPLETED);
+		assert(Job->Signature == JOB_SIGNATURE);
+		assert(Job->Status == JE_THREADQUEUE_STATUS_COMPLETED);
+	}
 
 	jeRam_Free(Job);
 
@@ -584,32 +330,30 @@ JETAPI	jeBoolean JETCC jeThreadQueue_JobSetPriority(
 	jeThreadQueue_Job *		Job,
 	jeThreadQueue_Priority	Priority)
 {
+	std::lock_guard<std::mutex>	Guard(GetSync()->Lock);
+
 	if	(Job->Status != JE_THREADQUEUE_STATUS_WAITINGFORTHREAD)
 		return JE_FALSE;
 
-	LockQueue();
+	UnlinkLockedJob(Job);
+	LinkLockedJob(Job, Priority);
 
-	//  Take it out of the list:
-	Job->Next->Prev = Job->Prev;
-	Job->Prev->Next = Job->Next;
+	return JE_TRUE;
+}
 
-	if	(Priority == JE_THREADQUEUE_PRIORITY_HIGH)
-	{
-		JobList.Next->Prev = Job;
-		Job->Next = JobList.Next;
-					JobList.Next = Job;
-		Job->Prev = &JobList;
-	}
-	else
-	{
-		assert(Priority == JE_THREADQUEUE_PRIORITY_LOW);
-		JobList.Prev->Next = Job;
-		Job->Prev = JobList.Prev;
-					JobList.Prev = Job;
-		Job->Next = &JobList;
-	}
+JETAPI	jeBoolean JETCC jeThreadQueue_JobCancel(jeThreadQueue_Job * Job)
+{
+	assert(Job);
+
+	std::lock_guard<std::mutex>	Guard(GetSync()->Lock);
+
+	if	(Job->Status != JE_THREADQUEUE_STATUS_WAITINGFORTHREAD)
+		return JE_FALSE;
 
-	UnlockQueue();
+	UnlinkLockedJob(Job);
+
+	Job->Status = JE_THREADQUEUE_STATUS_COMPLETED;
+	GetSync()->StatusCV.notify_all();
 
 	return JE_TRUE;
 }
@@ -620,45 +364,40 @@ JETAPI	jeThreadQueue_Priority JETCC jeThreadQueue_JobGetPriority(
 	int					i;
 	jeThreadQueue_Job *	Jobs;
 
-	LockQueue();
+	std::lock_guard<std::mutex>	Guard(GetSync()->Lock);
 
-	Jobs = JobList.Next;
-	i = 0;
-	while	(Jobs != &JobList)
+	// Anything that has a thread has been treated as high priority
+	if	(Job->Status != JE_THREADQUEUE_STATUS_WAITINGFORTHREAD)
+		return JE_THREADQUEUE_PRIORITY_HIGH;
+
+	Jobs = PendingList.Next;
+	for	(i = 0; Jobs != &PendingList && i < MaxActiveJobs; i++, Jobs = Jobs->Next)
 	{
 		if	(Jobs == Job)
-		{
-			UnlockQueue();
 			return JE_THREADQUEUE_PRIORITY_HIGH;
-		}
-		i++;
-		Jobs = Jobs->Next;
-#if 1
-		if	(i >= MaxActiveJobs)
-		{
-			UnlockQueue();
-			return JE_THREADQUEUE_PRIORITY_LOW;
-		}
-#endif
 	}
 
-
-	assert(!"Should never get here");
 	return JE_THREADQUEUE_PRIORITY_LOW;
 }
 
 JETAPI	jeBoolean JETCC jeThreadQueue_SetThreadLimit(int MaxThreads)
 {
-	if ( MaxThreads >= MAX_THREADS )
+	if ( MaxThreads >= MAX_THREADS || MaxThreads < 1 )
 		return JE_FALSE;
+
+	std::lock_guard<std::mutex>	Guard(GetSync()->Lock);
+
+	InitLockedTQ();
+
 	MaxActiveJobs = MaxThreads;
+	KickLockedQueue();
+
 	return JE_TRUE;
 }
 
 JETAPI	int JETCC jeThreadQueue_GetThreadLimit(void)
 {
 	return MaxActiveJobs;
-//	return MAX_THREADS;
 }
 
 #ifndef NDEBUG
@@ -666,28 +405,22 @@ JETAPI	void JETCC jeThreadQueue_DumpQueue(void)
 {
 	jeThreadQueue_Job *	Jobs;
 
+	std::lock_guard<std::mutex>	Guard(GetSync()->Lock);
+
+	InitLockedTQ();
+
 	printf("ThreadQueue: Dump of threads\n");
 	printf("------------------------------\n");
+	printf("%d running on %d threads\n", ActiveJobCount, NumThreads);
 
-	Jobs = JobList.Next;
-	while	(Jobs != &JobList)
-	{
-		if	(Jobs->Status == JE_THREADQUEUE_STATUS_WAITINGFORTHREAD)
-			printf("<%08x> Waiting\n", Jobs);
-		if	(Jobs->Status == JE_THREADQUEUE_STATUS_RUNNING)
-			printf("<%08x> Running\n", Jobs);
-		if	(Jobs->Status == JE_THREADQUEUE_STATUS_COMPLETED)
-			printf("<%08x> Completed\n", Jobs);
-		Jobs = Jobs->Next;
-	}
+	for	(Jobs = PendingList.Next; Jobs != &PendingList; Jobs = Jobs->Next)
+		printf("<%p> Waiting\n", (void *)Jobs);
 }
 #endif
 
 JETAPI jeBoolean JETCC jeThreadQueue_WaitOnJob(jeThreadQueue_Job * Job,
 											jeThreadQueue_JobStatus WaitForStatus)
 {
-jeThreadQueue_JobStatus Status;
-
 	assert( Job );
 
 	if ( WaitForStatus != JE_THREADQUEUE_STATUS_RUNNING &&
@@ -696,36 +429,30 @@ jeThreadQueue_JobStatus Status;
 
 	ThreadLog_Printf("WaitOnJob\n");
 
-	Status = jeThreadQueue_JobGetStatus(Job);
-
-	if ( Status < WaitForStatus )
-	{
-	int Waits1=0,Waits2=0;
-
-		jeThreadQueue_JobSetPriority(Job,JE_THREADQUEUE_PRIORITY_HIGH);
-
-		while ( Status < JE_THREADQUEUE_STATUS_RUNNING )
-		{
-			Waits1++;
-			assert( Waits1 < 999999 );
+	std::unique_lock<std::mutex>	Guard(GetSync()->Lock);
 
-			#pragma message("ThreadQueue_WaitOnJob : create emergency threads if all running threads are waiting on non-running threads")
+	if ( Job->Status >= WaitForStatus )
+		return JE_TRUE;
 
-			jeThreadQueue_PollJobs();
-			jeThreadQueue_Sleep(1);
-			Status = jeThreadQueue_JobGetStatus(Job);
-		}
-		
-		while ( Status < WaitForStatus )
+	if ( Job->Status == JE_THREADQUEUE_STATUS_WAITINGFORTHREAD )
+	{
+		if ( WaitForStatus == JE_THREADQUEUE_STATUS_COMPLETED )
 		{
-			Waits2++;
-			assert( Waits2 < 999999 );
-			jeThreadQueue_Sleep(1);
-			Status = jeThreadQueue_JobGetStatus(Job);
+			// We'd only sleep until it's done, so do it here and save a thread
+			RunLockedJob(Guard, Job);
+			return JE_TRUE;
 		}
+
+		// Callers wait for RUNNING to get the job going in the background,
+		//	so it has to go to a job thread
+		UnlinkLockedJob(Job);
+		LinkLockedJob(Job, JE_THREADQUEUE_PRIORITY_HIGH);
+		KickLockedQueue();
 	}
 
-return JE_TRUE;
+	GetSync()->StatusCV.wait(Guard, [Job, WaitForStatus] { return Job->Status >= WaitForStatus; });
+
+	return JE_TRUE;
 }
 
 /* }{ **** jeThreadQueue Semaphore ******/
@@ -734,12 +461,13 @@ return JE_TRUE;
 
 struct jeThreadQueue_Semaphore
 {
-	uint32				Signature1;
-	uint32				LockCount;
-	CRITICAL_SECTION	CS;
-	uint32				Signature2;
+	uint32					Signature1;
+	uint32					LockCount;
+	std::recursive_mutex	CS;
+	uint32					Signature2;
 };
 
+static std::mutex SemaphorePoolLock;		// Guards SemaphorePool and Semaphores
 static MemPool * SemaphorePool = NULL;
 static int Semaphores = 0;	// @@ check to see if we have leaks!
 
@@ -747,46 +475,43 @@ JETAPI jeThreadQueue_Semaphore * JETCC
 	jeThreadQueue_Semaphore_Create(void)
 {
 jeThreadQueue_Semaphore * S;
+void * Hunk;
 
-	assert( Semaphores >= 0 );
-	if ( ! Semaphores )
 	{
-		assert( SemaphorePool == NULL );
-		SemaphorePool = MemPool_Create(sizeof(jeThreadQueue_Semaphore),64,64);
-		if ( ! SemaphorePool )
+		std::lock_guard<std::mutex>	Guard(SemaphorePoolLock);
+
+		assert( Semaphores >= 0 );
+		if ( ! Semaphores )
+		{
+			assert( SemaphorePool == NULL );
+			SemaphorePool = MemPool_Create(sizeof(jeThreadQueue_Semaphore),64,64);
+			if ( ! SemaphorePool )
+				return NULL;
+		}
+
+		Hunk = MemPool_GetHunk(SemaphorePool);
+		if ( ! Hunk )
 			return NULL;
+
+		Semaphores++;
 	}
 
-	S = (jeThreadQueue_Semaphore*)MemPool_GetHunk(SemaphorePool);
-	if ( ! S )
-		return NULL;
+	S = new (Hunk) jeThreadQueue_Semaphore;
 	#ifndef NDEBUG
 	S->Signature1 = SEMAPHORE_SIGNATURE;
 	S->Signature2 = SEMAPHORE_SIGNATURE;
 	#endif
-	Semaphores++;
 	S->LockCount = 0;
-	InitializeCriticalSection(&(S->CS));
 return S;
 }
 
 JETAPI void JETCC jeThreadQueue_Semaphore_Lock(jeThreadQueue_Semaphore * S)
 {
-	/* if ( S->LockCount )
-	{
-		// we're about to stall! try to prevent catastrophes!
-		//	this is pointless; if our semaphore is locked, it must be locked by
-		//		a running job
-		// there's another problem : the same thread can lcok a semaphore many times!
-		jeThreadQueue_PollJobs();
-		jeThreadQueue_Sleep(1);
-	} */
 	assert( S );
 	assert( S->Signature1 == SEMAPHORE_SIGNATURE &&
 			S->Signature2 == SEMAPHORE_SIGNATURE );
-	EnterCriticalSection(&(S->CS));
+	S->CS.lock();
 	
-	//assert( ! S->LockCount == 0 || ActiveJobCount > 0 ); // no good, see note above
 	S->LockCount ++;
 }
 
@@ -797,7 +522,7 @@ JETAPI void JETCC jeThreadQueue_Semaphore_UnLock(jeThreadQueue_Semaphore * S)
 			S->Signature2 == SEMAPHORE_SIGNATURE );
 	assert(S->LockCount > 0);
 	S->LockCount --;
-	LeaveCriticalSection(&(S->CS));
+	S->CS.unlock();
 }
 
 JETAPI void JETCC jeThreadQueue_Semaphore_Destroy(jeThreadQueue_Semaphore ** pS)
@@ -811,8 +536,10 @@ JETAPI void JETCC jeThreadQueue_Semaphore_Destroy(jeThreadQueue_Semaphore ** pS)
 				S->Signature2 == SEMAPHORE_SIGNATURE );
 		assert( S->LockCount == 0 );
 
-		DeleteCriticalSection(&(S->CS));
-		
+		S->~jeThreadQueue_Semaphore();
+
+		std::lock_guard<std::mutex>	Guard(SemaphorePoolLock);
+
 		MemPool_FreeHunk(SemaphorePool,S);
 		assert( Semaphores > 0 );
 		Semaphores--;
@@ -828,8 +555,10 @@ JETAPI void JETCC jeThreadQueue_Semaphore_Destroy(jeThreadQueue_Semaphore ** pS)
 #ifndef NDEBUG
 JETAPI void JETCC jeThreadQueue_GetDebugInfo(int * pActiveJobCount,int *pSemaphoreCount, int * pNumThreads)
 {
+	std::lock_guard<std::mutex>	Guard(GetSync()->Lock);
+
 	if ( pActiveJobCount ) *pActiveJobCount = ActiveJobCount;
 	if ( pSemaphoreCount ) *pSemaphoreCount = Semaphores;
-	if ( pNumThreads ) *pNumThreads = GlobalThreadPool->NumThreads;
+	if ( pNumThreads ) *pNumThreads = NumThreads;
 }
 #endif
@@ -55,8 +55,8 @@ JETAPI	jeThreadQueue_Job *	JETCC jeThreadQueue_JobCreate(
 	void *		Context,
 	jeErrorLog *ErrorLog,
 	uint32		StackLimit); // <> remove the StackLimit
-				// note that when you call this, the job does not actually
-				// start until someone calls a PollJos.
+				// the job starts as soon as a job thread is free; there is
+				// no need to call PollJobs.
 
 JETAPI	void JETCC jeThreadQueue_JobCreateRef(jeThreadQueue_Job *Job);
 JETAPI	void JETCC jeThreadQueue_JobDestroy(jeThreadQueue_Job **Job);
@@ -74,6 +74,10 @@ JETAPI	jeThreadQueue_Priority JETCC jeThreadQueue_JobGetPriority(jeThreadQueue_J
 				// this does *not* return the result of SetPriority , but instead it
 				//	returns the actual realized priority due to location in the queue
 
+JETAPI	jeBoolean JETCC jeThreadQueue_JobCancel(jeThreadQueue_Job * Job);
+				// takes a job that has no thread yet off the queue and marks it
+				//	COMPLETED without running it; false if it already started
+
 JETAPI	jeBoolean	JETCC jeThreadQueue_SetThreadLimit(int MaxThreads);
 JETAPI	int			JETCC jeThreadQueue_GetThreadLimit(void);
 
@@ -81,14 +85,15 @@ JETAPI	void JETCC jeThreadQueue_Sleep(int Milliseconds);
 				// don't use the Windows Sleep() use this
 
 JETAPI	void JETCC jeThreadQueue_PollJobs(void);
-				// warning : do NOT call this unless you are the master of the threads!
-				//	calling this function too often will under-represent high priority threads!
-				//	try to use WaitOnJob instead!
+				// only needed to retry after a job thread could not be created;
+				//	use WaitOnJob to wait for a job
 
 JETAPI jeBoolean JETCC jeThreadQueue_WaitOnJob(jeThreadQueue_Job * Job,
 											jeThreadQueue_JobStatus WaitForStatus);
 				//can wait for JE_THREADQUEUE_STATUS_RUNNING or JE_THREADQUEUE_STATUS_COMPLETED
 				// waits for Status *or higher* !
+				// blocks without polling; waiting for COMPLETED on a job that has no
+				//	thread yet runs it on the caller
 
 // ----- use these Semaphores to lock data that ThreadQueue_Jobs may peek at.
 
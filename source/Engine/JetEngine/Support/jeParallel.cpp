@@ -0,0 +1,712 @@
+/****************************************************************************************/
+/*  JEPARALLEL.CPP                                                                      */
+/*                                                                                      */
+/*  Author: Styx3D Modernization                                                        */
+/*  Description: Portable fork/join task pool for tools-time and load-time work         */
+/*                                                                                      */
+/*  Work stealing: every worker owns a deque it pushes and pops at the bottom, idle     */
+/*  threads steal from the top of the others.  Tasks queued from threads outside the    */
+/*  pool go through one small locked inbox.  Threads blocked in jeParallel_GroupWait    */
+/*  take part in the same search, which is what lets tasks fork and join recursively    */
+/*  without running out of workers.  Nobody polls: idle threads sleep on a condition    */
+/*  variable and are woken by new work or by a group draining.                          */
+/*                                                                                      */
+/*  The contents of this file are subject to the 0BSD License.                          */
+/*  See LICENSE file in the project root for full license information.                  */
+/*                                                                                      */
+/****************************************************************************************/
+#include <assert.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "jeParallel.h"
+
+#define JE_PARALLEL_MAX_THREADS		64
+#define JE_PARALLEL_FOR_SPLIT		4			// Chunks per thread, to even out uneven items
+#define JE_PARALLEL_DEQUE_START		256			// Starting capacity of a worker deque, power of 2
+#define JE_PARALLEL_STEAL_SPINS		64			// Failed searches before a thread goes to sleep
+
+typedef struct jeParallel_Task
+{
+	jeParallel_TaskFunc		Func;
+	void					*Context;
+	jeParallel_Group		*Group;
+	jeParallel_Task			*NextDeferred;		// Link in the After group's deferred list
+} jeParallel_Task;
+
+struct jeParallel_Group
+{
+	std::atomic<int32>		Pending;			// Queued, deferred and running tasks
+	std::mutex				Lock;				// Guards Deferred and the last decrement of Pending
+	jeParallel_Task			*Deferred;			// Tasks waiting on this group to drain
+};
+
+struct jeParallel_Mutex
+{
+	std::mutex				Lock;
+};
+
+//=====================================================================================
+//	jeParallel_Deque
+//	Chase-Lev deque.  Only the owner calls Push/Pop, anyone may Steal.  Arrays that are
+//	outgrown are kept until the pool dies, since a thief may still be reading one.
+//=====================================================================================
+typedef struct jeParallel_DequeArray
+{
+	int64_t									Mask;
+	std::vector<std::atomic<jeParallel_Task*>>	Slots;
+
+	jeParallel_DequeArray(int64_t Size) : Mask(Size-1), Slots((size_t)Size) {}
+
+	jeParallel_Task *Get(int64_t i) const { return Slots[(size_t)(i & Mask)].load(std::memory_order_relaxed); }
+	void Put(int64_t i, jeParallel_Task *Task) { Slots[(size_t)(i & Mask)].store(Task, std::memory_order_relaxed); }
+} jeParallel_DequeArray;
+
+#define JE_PARALLEL_STEAL_ABORT		((jeParallel_Task*)(intptr_t)-1)		// Lost a race, try again
+
+typedef struct jeParallel_Deque
+{
+	std::atomic<int64_t>					Top;
+	std::atomic<int64_t>					Bottom;
+	std::atomic<jeParallel_DequeArray*>		Array;
+	std::vector<jeParallel_DequeArray*>		Retired;
+} jeParallel_Deque;
+
+static void jeParallel_DequeInit(jeParallel_Deque *Deque)
+{
+	Deque->Top.store(0, std::memory_order_relaxed);
+	Deque->Bottom.store(0, std::memory_order_relaxed);
+	Deque->Array.store(new jeParallel_DequeArray(JE_PARALLEL_DEQUE_START), std::memory_order_relaxed);
+}
+
+static void jeParallel_DequePush(jeParallel_Deque *Deque, jeParallel_Task *Task)
+{
+	jeParallel_DequeArray	*Array;
+	int64_t					Bottom, Top;
+
+	Bottom = Deque->Bottom.load(std::memory_order_relaxed);
+	Top = Deque->Top.load(std::memory_order_acquire);
+	Array = Deque->Array.load(std::memory_order_relaxed);
+
+	if (Bottom - Top > Array->Mask)
+	{
+		jeParallel_DequeArray	*NewArray;
+		int64_t					i;
+
+		NewArray = new jeParallel_DequeArray((Array->Mask+1)*2);
+
+		for (i = Top; i < Bottom; i++)
+			NewArray->Put(i, Array->Get(i));
+
+		Deque->Retired.push_back(Array);
+		Deque->Array.store(NewArray, std::memory_order_release);
+		Array = NewArray;
+	}
+
+	Array->Put(Bottom, Task);
+	Deque->Bottom.store(Bottom+1, std::memory_order_release);		// Publishes the task to thieves
+}
+
+static jeParallel_Task *jeParallel_DequePop(jeParallel_Deque *Deque)
+{
+	jeParallel_DequeArray	*Array;
+	jeParallel_Task			*Task;
+	int64_t					Bottom, Top;
+
+	Bottom = Deque->Bottom.load(std::memory_order_relaxed) - 1;
+	Array = Deque->Array.load(std::memory_order_relaxed);
+	Deque->Bottom.store(Bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	Top = Deque->Top.load(std::memory_order_relaxed);
+
+	if (Top > Bottom)
+	{
+		// Empty
+		Deque->Bottom.store(Bottom+1, std::memory_order_relaxed);
+		return NULL;
+	}
+
+	Task = Array->Get(Bottom);
+
+	if (Top == Bottom)
+	{
+		// Last one, race the thieves for it
+		if (!Deque->Top.compare_exchange_strong(Top, Top+1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			Task = NULL;
+
+		Deque->Bottom.store(Bottom+1, std::memory_order_relaxed);
+	}
+
+	return Task;
+}
+
+static jeParallel_Task *jeParallel_DequeSteal(jeParallel_Deque *Deque)
+{
+	jeParallel_DequeArray	*Array;
+	jeParallel_Task			*Task;
+	int64_t					Bottom, Top;
+
+	Top = Deque->Top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	Bottom = Deque->Bottom.load(std::memory_order_acquire);
+
+	if (Top >= Bottom)
+		return NULL;
+
+	Array = Deque->Array.load(std::memory_order_acquire);
+	Task = Array->Get(Top);
+
+	if (!Deque->Top.compare_exchange_strong(Top, Top+1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		return JE_PARALLEL_STEAL_ABORT;
+
+	return Task;
+}
+
+//=====================================================================================
+//	Pool
+//=====================================================================================
+typedef struct jeParallel_Pool
+{
+	int32							NumThreads;		// Including the caller of Wait
+	jeParallel_Deque				Deques[JE_PARALLEL_MAX_THREADS];		// [0] is unused, the callers have none
+
+	std::mutex						InboxLock;		// Tasks queued from outside the pool
+	std::deque<jeParallel_Task*>	Inbox;
+	std::atomic<int32>				InboxCount;
+
+	std::mutex						SleepLock;
+	std::condition_variable			SleepCV;
+	std::atomic<uint32>				Epoch;			// Bumped whenever there is news for sleepers
+	std::atomic<int32>				NumSleeping;
+} jeParallel_Pool;
+
+static int32				g_RequestedThreads = 0;
+static jeBoolean			g_Started = JE_FALSE;
+
+static thread_local int32	g_WorkerIndex = 0;		// 0 for threads the pool did not create
+static thread_local uint32	g_StealSeed = 0;
+
+static void jeParallel_Signal(jeParallel_Pool *Pool, jeBoolean All)
+{
+	Pool->Epoch.fetch_add(1, std::memory_order_seq_cst);
+
+	if (Pool->NumSleeping.load(std::memory_order_seq_cst) == 0)
+		return;
+
+	{
+		// Taking the lock orders this against a sleeper between its check and its wait
+		std::lock_guard<std::mutex>		Guard(Pool->SleepLock);
+	}
+
+	if (All)
+		Pool->SleepCV.notify_all();
+	else
+		Pool->SleepCV.notify_one();
+}
+
+static void jeParallel_Submit(jeParallel_Pool *Pool, jeParallel_Task *Task)
+{
+	if (g_WorkerIndex)
+		jeParallel_DequePush(&Pool->Deques[g_WorkerIndex], Task);
+	else
+	{
+		std::lock_guard<std::mutex>		Guard(Pool->InboxLock);
+
+		Pool->Inbox.push_back(Task);
+		Pool->InboxCount.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	jeParallel_Signal(Pool, JE_FALSE);
+}
+
+//=====================================================================================
+//	jeParallel_FindTask
+//	Own deque first (newest, so a waiting task tends to pick up its own children), then
+//	the inbox, then the other workers starting at a random one.  *Retry is set when a
+//	steal lost a race, so the caller should not go to sleep yet.
+//=====================================================================================
+static jeParallel_Task *jeParallel_FindTask(jeParallel_Pool *Pool, jeBoolean *Retry)
+{
+	jeParallel_Task		*Task;
+	int32				i, Start;
+
+	*Retry = JE_FALSE;
+
+	if (g_WorkerIndex)
+	{
+		Task = jeParallel_DequePop(&Pool->Deques[g_WorkerIndex]);
+
+		if (Task)
+			return Task;
+	}
+
+	if (Pool->InboxCount.load(std::memory_order_relaxed) > 0)
+	{
+		std::lock_guard<std::mutex>		Guard(Pool->InboxLock);
+
+		if (!Pool->Inbox.empty())
+		{
+			Task = Pool->Inbox.front();
+			Pool->Inbox.pop_front();
+			Pool->InboxCount.fetch_sub(1, std::memory_order_relaxed);
+			return Task;
+		}
+	}
+
+	if (Pool->NumThreads <= 1)
+		return NULL;
+
+	if (!g_StealSeed)
+		g_StealSeed = (uint32)(uintptr_t)&g_StealSeed | 1;
+
+	g_StealSeed ^= g_StealSeed << 13;
+	g_StealSeed ^= g_StealSeed >> 17;
+	g_StealSeed ^= g_StealSeed << 5;
+
+	Start = (int32)(g_StealSeed % (uint32)(Pool->NumThreads-1));
+
+	for (i = 0; i < Pool->NumThreads-1; i++)
+	{
+		int32	Victim = 1 + (Start + i) % (Pool->NumThreads-1);
+
+		if (Victim == g_WorkerIndex)
+			continue;
+
+		Task = jeParallel_DequeSteal(&Pool->Deques[Victim]);
+
+		if (Task == JE_PARALLEL_STEAL_ABORT)
+		{
+			*Retry = JE_TRUE;
+			continue;
+		}
+
+		if (Task)
+			return Task;
+	}
+
+	return NULL;
+}
+
+static void jeParallel_GroupFinishTask(jeParallel_Pool *Pool, jeParallel_Group *Group)
+{
+	jeParallel_Task		*Deferred = NULL;
+	jeBoolean			Drained = JE_FALSE;
+
+	{
+		// Held across the decrement, so Wait can't return (and the group can't be
+		//	destroyed) while we are still looking at it
+		std::lock_guard<std::mutex>		Guard(Group->Lock);
+
+		assert(Group->Pending.load() > 0);
+
+		if (Group->Pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			Drained = JE_TRUE;
+			Deferred = Group->Deferred;
+			Group->Deferred = NULL;
+		}
+	}
+
+	while (Deferred)
+	{
+		jeParallel_Task		*Next = Deferred->NextDeferred;
+
+		Deferred->NextDeferred = NULL;
+		jeParallel_Submit(Pool, Deferred);
+		Deferred = Next;
+	}
+
+	// Whoever waits on the group may be asleep
+	if (Drained)
+		jeParallel_Signal(Pool, JE_TRUE);
+}
+
+static void jeParallel_Execute(jeParallel_Pool *Pool, jeParallel_Task *Task)
+{
+	jeParallel_Group	*Group = Task->Group;
+
+	Task->Func(Task->Context);
+
+	delete Task;
+
+	jeParallel_GroupFinishTask(Pool, Group);
+}
+
+//=====================================================================================
+//	jeParallel_RunUntil
+//	Executes tasks until Done(Context) holds, sleeping when there is nothing to take.
+//	Workers pass a Done that never holds.
+//=====================================================================================
+template <typename DoneFunc>
+static void jeParallel_RunUntil(jeParallel_Pool *Pool, DoneFunc Done)
+{
+	int32		Spins = 0;
+
+	while (!Done())
+	{
+		jeParallel_Task		*Task;
+		jeBoolean			Retry;
+		uint32				Epoch;
+
+		Epoch = Pool->Epoch.load(std::memory_order_seq_cst);
+
+		Task = jeParallel_FindTask(Pool, &Retry);
+
+		if (Task)
+		{
+			jeParallel_Execute(Pool, Task);
+			Spins = 0;
+			continue;
+		}
+
+		if (Retry || ++Spins < JE_PARALLEL_STEAL_SPINS)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		Pool->NumSleeping.fetch_add(1, std::memory_order_seq_cst);
+
+		{
+			std::unique_lock<std::mutex>	Guard(Pool->SleepLock);
+
+			Pool->SleepCV.wait(Guard, [Pool, Epoch, &Done] { return Pool->Epoch.load(std::memory_order_seq_cst) != Epoch || Done(); });
+		}
+
+		Pool->NumSleeping.fetch_sub(1, std::memory_order_seq_cst);
+		Spins = 0;
+	}
+}
+
+static void jeParallel_WorkerThread(jeParallel_Pool *Pool, int32 Index)
+{
+	g_WorkerIndex = Index;
+
+	jeParallel_RunUntil(Pool, [] { return false; });
+}
+
+static jeParallel_Pool *jeParallel_CreatePool(void)
+{
+	jeParallel_Pool		*Pool;
+	int32				i;
+
+	Pool = new jeParallel_Pool;
+
+	Pool->NumThreads = g_RequestedThreads;
+
+	if (Pool->NumThreads <= 0)
+		Pool->NumThreads = (int32)std::thread::hardware_concurrency();
+
+	Pool->NumThreads = std::max<int32>(1, std::min<int32>(Pool->NumThreads, JE_PARALLEL_MAX_THREADS));
+
+	Pool->InboxCount.store(0);
+	Pool->Epoch.store(0);
+	Pool->NumSleeping.store(0);
+
+	for (i = 1; i < Pool->NumThreads; i++)
+		jeParallel_DequeInit(&Pool->Deques[i]);
+
+	// The workers are never joined, they sleep on SleepCV until the process exits.  Joining
+	// from a static destructor deadlocks when the engine is unloaded as a dll.
+	for (i = 1; i < Pool->NumThreads; i++)
+		std::thread(jeParallel_WorkerThread, Pool, i).detach();
+
+	g_Started = JE_TRUE;
+
+	return Pool;
+}
+
+static jeParallel_Pool *jeParallel_GetPool(void)
+{
+	static jeParallel_Pool	*Pool = jeParallel_CreatePool();
+
+	return Pool;
+}
+
+//=====================================================================================
+//	jeParallel_SetNumThreads
+//=====================================================================================
+jeBoolean jeParallel_SetNumThreads(int32 NumThreads)
+{
+	if (g_Started)
+		return JE_FALSE;
+
+	g_RequestedThreads = NumThreads;
+
+	return JE_TRUE;
+}
+
+//=====================================================================================
+//	jeParallel_GetNumThreads
+//=====================================================================================
+int32 jeParallel_GetNumThreads(void)
+{
+	return jeParallel_GetPool()->NumThreads;
+}
+
+//=====================================================================================
+//	jeParallel_GroupCreate
+//=====================================================================================
+jeParallel_Group *jeParallel_GroupCreate(void)
+{
+	jeParallel_Group	*Group;
+
+	Group = new jeParallel_Group;
+	Group->Pending.store(0);
+	Group->Deferred = NULL;
+
+	return Group;
+}
+
+//=====================================================================================
+//	jeParallel_GroupDestroy
+//=====================================================================================
+void jeParallel_GroupDestroy(jeParallel_Group **Group)
+{
+	assert(Group);
+
+	if (!*Group)
+		return;
+
+	jeParallel_GroupWait(*Group);
+
+	delete *Group;
+	*Group = NULL;
+}
+
+//=====================================================================================
+//	jeParallel_GroupRun
+//=====================================================================================
+void jeParallel_GroupRun(jeParallel_Group *Group, jeParallel_TaskFunc Func, void *Context)
+{
+	jeParallel_Pool		*Pool;
+	jeParallel_Task		*Task;
+
+	assert(Group && Func);
+
+	Pool = jeParallel_GetPool();
+
+	if (Pool->NumThreads <= 1)
+	{
+		Func(Context);
+		return;
+	}
+
+	Task = new jeParallel_Task;
+	Task->Func = Func;
+	Task->Context = Context;
+	Task->Group = Group;
+	Task->NextDeferred = NULL;
+
+	Group->Pending.fetch_add(1, std::memory_order_relaxed);
+
+	jeParallel_Submit(Pool, Task);
+}
+
+//=====================================================================================
+//	jeParallel_GroupRunAfter
+//=====================================================================================
+void jeParallel_GroupRunAfter(jeParallel_Group *Group, jeParallel_TaskFunc Func, void *Context, jeParallel_Group *After)
+{
+	jeParallel_Pool		*Pool;
+	jeParallel_Task		*Task;
+
+	assert(Group && Func && After);
+
+	Pool = jeParallel_GetPool();
+
+	if (Pool->NumThreads <= 1)
+	{
+		// Everything ran inline, so After has nothing left
+		assert(After->Pending.load() == 0);
+		Func(Context);
+		return;
+	}
+
+	Task = new jeParallel_Task;
+	Task->Func = Func;
+	Task->Context = Context;
+	Task->Group = Group;
+	Task->NextDeferred = NULL;
+
+	Group->Pending.fetch_add(1, std::memory_order_relaxed);
+
+	{
+		std::lock_guard<std::mutex>		Guard(After->Lock);
+
+		if (After->Pending.load(std::memory_order_acquire) > 0)
+		{
+			Task->NextDeferred = After->Deferred;
+			After->Deferred = Task;
+			return;
+		}
+	}
+
+	jeParallel_Submit(Pool, Task);
+}
+
+//=====================================================================================
+//	jeParallel_GroupWait
+//=====================================================================================
+void jeParallel_GroupWait(jeParallel_Group *Group)
+{
+	jeParallel_Pool		*Pool;
+
+	assert(Group);
+
+	Pool = jeParallel_GetPool();
+
+	jeParallel_RunUntil(Pool, [Group] { return Group->Pending.load(std::memory_order_acquire) == 0; });
+
+	{
+		// Wait for the thread that finished the last task to let go of the group
+		std::lock_guard<std::mutex>		Guard(Group->Lock);
+	}
+}
+
+//=====================================================================================
+//	jeParallel_GroupIsDone
+//=====================================================================================
+jeBoolean jeParallel_GroupIsDone(const jeParallel_Group *Group)
+{
+	assert(Group);
+
+	return Group->Pending.load(std::memory_order_acquire) == 0 ? JE_TRUE : JE_FALSE;
+}
+
+//=====================================================================================
+//	jeParallel_ForRange
+//	A few helper tasks and the caller all pull chunks off one counter, so a slow chunk
+//	never holds up the others and late helpers cost next to nothing.
+//=====================================================================================
+typedef struct jeParallel_ForState
+{
+	std::atomic<int32>		Next;
+	int32					Count;
+	int32					Grain;
+	jeParallel_RangeFunc	Func;
+	void					*Context;
+} jeParallel_ForState;
+
+static void jeParallel_ForTask(void *Context)
+{
+	jeParallel_ForState		*State = (jeParallel_ForState*)Context;
+
+	for (;;)
+	{
+		int32	Start = State->Next.fetch_add(State->Grain, std::memory_order_relaxed);
+
+		if (Start >= State->Count)
+			break;
+
+		State->Func(Start, std::min<int32>(Start + State->Grain, State->Count), State->Context);
+	}
+}
+
+void jeParallel_ForRange(int32 Count, int32 Grain, jeParallel_RangeFunc Func, void *Context)
+{
+	jeParallel_ForState		State;
+	jeParallel_Group		Group;
+	int32					NumThreads, NumChunks, NumHelpers, i;
+
+	assert(Func);
+
+	if (Count <= 0)
+		return;
+
+	NumThreads = jeParallel_GetNumThreads();
+
+	if (Grain <= 0)
+		Grain = std::max<int32>(1, Count / (NumThreads*JE_PARALLEL_FOR_SPLIT));
+
+	NumChunks = (Count + Grain - 1) / Grain;
+
+	if (NumThreads <= 1 || NumChunks <= 1)
+	{
+		Func(0, Count, Context);
+		return;
+	}
+
+	State.Next.store(0);
+	State.Count = Count;
+	State.Grain = Grain;
+	State.Func = Func;
+	State.Context = Context;
+
+	Group.Pending.store(0);
+	Group.Deferred = NULL;
+
+	NumHelpers = std::min<int32>(NumThreads, NumChunks) - 1;
+
+	for (i = 0; i < NumHelpers; i++)
+		jeParallel_GroupRun(&Group, jeParallel_ForTask, &State);
+
+	jeParallel_ForTask(&State);
+
+	jeParallel_GroupWait(&Group);
+}
+
+//=====================================================================================
+//	jeParallel_For
+//=====================================================================================
+typedef struct jeParallel_ForIndexContext
+{
+	jeParallel_ForFunc		Func;
+	void					*Context;
+} jeParallel_ForIndexContext;
+
+static void jeParallel_ForIndexRange(int32 Start, int32 End, void *Context)
+{
+	jeParallel_ForIndexContext	*Index = (jeParallel_ForIndexContext*)Context;
+	int32						i;
+
+	for (i = Start; i < End; i++)
+		Index->Func(i, Index->Context);
+}
+
+void jeParallel_For(int32 Count, jeParallel_ForFunc Func, void *Context)
+{
+	jeParallel_ForIndexContext	Index;
+
+	assert(Func);
+
+	Index.Func = Func;
+	Index.Context = Context;
+
+	jeParallel_ForRange(Count, 0, jeParallel_ForIndexRange, &Index);
+}
+
+//=====================================================================================
+//	Mutex
+//=====================================================================================
+jeParallel_Mutex *jeParallel_MutexCreate(void)
+{
+	return new jeParallel_Mutex;
+}
+
+void jeParallel_MutexDestroy(jeParallel_Mutex **Mutex)
+{
+	assert(Mutex);
+
+	delete *Mutex;
+	*Mutex = NULL;
+}
+
+void jeParallel_MutexLock(jeParallel_Mutex *Mutex)
+{
+	assert(Mutex);
+	Mutex->Lock.lock();
+}
+
+void jeParallel_MutexUnlock(jeParallel_Mutex *Mutex)
+{
+	assert(Mutex);
+	Mutex->Lock.unlock();
+}
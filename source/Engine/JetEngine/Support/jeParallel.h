@@ -0,0 +1,63 @@
+/****************************************************************************************/
+/*  JEPARALLEL.H                                                                        */
+/*                                                                                      */
+/*  Author: Styx3D Modernization                                                        */
+/*  Description: Portable fork/join task pool for tools-time and load-time work         */
+/*                                                                                      */
+/*  The contents of this file are subject to the 0BSD License.                          */
+/*  See LICENSE file in the project root for full license information.                  */
+/*                                                                                      */
+/****************************************************************************************/
+#ifndef JE_PARALLEL_H
+#define JE_PARALLEL_H
+
+#include "BaseType.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct jeParallel_Group		jeParallel_Group;
+typedef struct jeParallel_Mutex		jeParallel_Mutex;
+
+typedef void (*jeParallel_TaskFunc)(void *Context);
+typedef void (*jeParallel_ForFunc)(int32 Index, void *Context);
+typedef void (*jeParallel_RangeFunc)(int32 Start, int32 End, void *Context);
+
+//--------
+//	The pool is started on first use.  NumThreads counts the calling thread, 0 means one
+//	per core and 1 runs every task inline.  Only settable before the pool starts.
+//--------
+jeBoolean			jeParallel_SetNumThreads(int32 NumThreads);
+int32				jeParallel_GetNumThreads(void);
+
+//--------
+//	Groups count their unfinished tasks.  Run queues a task, Wait blocks until every task
+//	run on the group is done.  Waiting threads execute queued tasks, so tasks may fork and
+//	wait on their own groups.  RunAfter holds a task back until After has drained; the
+//	task counts against Group from the moment it is queued.
+//--------
+jeParallel_Group	*jeParallel_GroupCreate(void);
+void				jeParallel_GroupDestroy(jeParallel_Group **Group);		// Waits first
+void				jeParallel_GroupRun(jeParallel_Group *Group, jeParallel_TaskFunc Func, void *Context);
+void				jeParallel_GroupRunAfter(jeParallel_Group *Group, jeParallel_TaskFunc Func, void *Context, jeParallel_Group *After);
+void				jeParallel_GroupWait(jeParallel_Group *Group);
+jeBoolean			jeParallel_GroupIsDone(const jeParallel_Group *Group);
+
+// Calls Func(i, Context) for i in [0, Count), in any order, and returns when all are done
+void				jeParallel_For(int32 Count, jeParallel_ForFunc Func, void *Context);
+
+// Same, but hands out [Start, End) ranges of at most Grain items (0 picks one)
+void				jeParallel_ForRange(int32 Count, int32 Grain, jeParallel_RangeFunc Func, void *Context);
+
+//--------
+jeParallel_Mutex	*jeParallel_MutexCreate(void);
+void				jeParallel_MutexDestroy(jeParallel_Mutex **Mutex);
+void				jeParallel_MutexLock(jeParallel_Mutex *Mutex);
+void				jeParallel_MutexUnlock(jeParallel_Mutex *Mutex);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JE_PARALLEL_H
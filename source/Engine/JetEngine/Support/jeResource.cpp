@@ -24,8 +24,10 @@
 #include <memory.h>
 #include <assert.h>
 #include <string.h>
+#include <ctype.h>
 #include "Ram.h"
 #include "jeChain.h"
+#include "jeParallel.h"
 #include "Util.h"
 #include "jeResource.h"
 #include "Errorlog.h" // Added by Incarnadine
@@ -36,6 +38,20 @@
 #define stricmp strcasecmp
 #endif
 
+////////////////////////////////////////////////////////////////////////////////////////
+//	Name index slot
+////////////////////////////////////////////////////////////////////////////////////////
+typedef struct
+{
+	uint32			Hash;		// hash of the case folded name
+	jeChain_Link	*Link;		// NULL if empty, JE_RESOURCE_SLOT_DELETED if removed
+
+} jeResourceSlot;
+
+#define JE_RESOURCE_SLOT_DELETED	((jeChain_Link *)1)
+#define JE_RESOURCE_MIN_SLOTS		64
+
+
 ////////////////////////////////////////////////////////////////////////////////////////
 //	jeResourceMgr struct
 ////////////////////////////////////////////////////////////////////////////////////////
@@ -45,6 +61,14 @@ typedef struct jeResourceMgr
 	int		RefCount;
 
 	jeEngine* Engine;
+
+	// open addressing index over List, keyed by name
+	jeResourceSlot		*Slots;
+	uint32				SlotCount;		// power of 2
+	uint32				SlotsUsed;		// live and deleted slots
+
+	// only set for managers made by jeResource_MgrCreateThreadSafe()
+	jeParallel_Mutex	*Lock;
 } jeResourceMgr;
 
 
@@ -54,6 +78,7 @@ typedef struct jeResourceMgr
 typedef struct
 {
 	char	*Name;
+	uint32	Hash;
     uint32  Type;
 	void	*Data;
 	int32	RefCount;
@@ -70,6 +95,171 @@ JETAPI jeResourceMgr* JETCC jeResourceMgr_GetSingleton()
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////////
+//
+//	jeResource_Lock() / jeResource_Unlock()
+//
+//	Guard the list and the index of a thread safe manager.  Never held while a
+//	resource is being loaded, since loaders call back into the manager.
+//
+////////////////////////////////////////////////////////////////////////////////////////
+static void jeResource_Lock( jeResourceMgr *ResourceMgr )
+{
+	if ( ResourceMgr->Lock != NULL )
+	{
+		jeParallel_MutexLock( ResourceMgr->Lock );
+	}
+}
+
+static void jeResource_Unlock( jeResourceMgr *ResourceMgr )
+{
+	if ( ResourceMgr->Lock != NULL )
+	{
+		jeParallel_MutexUnlock( ResourceMgr->Lock );
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+//
+//	jeResource_HashName()
+//
+//	FNV-1a over the case folded name, so it agrees with stricmp.
+//
+////////////////////////////////////////////////////////////////////////////////////////
+static uint32 jeResource_HashName(
+	const char	*Name )	// name to hash
+{
+	uint32	Hash = 2166136261u;
+
+	assert( Name != NULL );
+
+	while ( *Name != '\0' )
+	{
+		Hash ^= (uint32)tolower( (unsigned char)*Name );
+		Hash *= 16777619u;
+		Name++;
+	}
+
+	return Hash;
+
+} // jeResource_HashName()
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+//
+//	jeResource_HashPlace()
+//
+//	Put a link into the first free slot of its probe sequence.
+//
+////////////////////////////////////////////////////////////////////////////////////////
+static void jeResource_HashPlace(
+	jeResourceSlot	*Slots,		// slot array
+	uint32			SlotCount,	// slot count, power of 2
+	uint32			Hash,		// name hash
+	jeChain_Link	*Link )		// link to place
+{
+	uint32	Index;
+
+	Index = Hash & ( SlotCount - 1 );
+	while ( Slots[Index].Link != NULL && Slots[Index].Link != JE_RESOURCE_SLOT_DELETED )
+	{
+		Index = ( Index + 1 ) & ( SlotCount - 1 );
+	}
+
+	Slots[Index].Hash = Hash;
+	Slots[Index].Link = Link;
+
+} // jeResource_HashPlace()
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+//
+//	jeResource_HashRebuild()
+//
+//	Rebuild the index with room for at least MinCount resources, which also drops
+//	deleted slots.
+//
+////////////////////////////////////////////////////////////////////////////////////////
+static jeBoolean jeResource_HashRebuild(
+	jeResourceMgr	*ResourceMgr,	// manager to rebuild
+	uint32			MinCount )		// resources it must hold
+{
+	jeResourceSlot	*NewSlots;
+	uint32			NewCount;
+	jeChain_Link	*CurNode;
+
+	// keep the load factor at or under 1/2
+	NewCount = JE_RESOURCE_MIN_SLOTS;
+	while ( NewCount < MinCount * 2 )
+	{
+		NewCount <<= 1;
+	}
+
+	NewSlots = (jeResourceSlot *)jeRam_AllocateClear( NewCount * sizeof( *NewSlots ) );
+	if ( NewSlots == NULL )
+	{
+		return JE_FALSE;
+	}
+
+	CurNode = jeChain_GetFirstLink( ResourceMgr->List );
+	while ( CurNode != NULL )
+	{
+		jeResource	*Resource;
+
+		Resource = (jeResource *)jeChain_LinkGetLinkData( CurNode );
+		assert( Resource != NULL );
+		jeResource_HashPlace( NewSlots, NewCount, Resource->Hash, CurNode );
+
+		CurNode = jeChain_LinkGetNext( CurNode );
+	}
+
+	if ( ResourceMgr->Slots != NULL )
+	{
+		jeRam_Free( ResourceMgr->Slots );
+	}
+	ResourceMgr->Slots = NewSlots;
+	ResourceMgr->SlotCount = NewCount;
+	ResourceMgr->SlotsUsed = jeChain_GetLinkCount( ResourceMgr->List );
+
+	return JE_TRUE;
+
+} // jeResource_HashRebuild()
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+//
+//	jeResource_HashRemove()
+//
+//	Take a link out of the index.
+//
+////////////////////////////////////////////////////////////////////////////////////////
+static void jeResource_HashRemove(
+	jeResourceMgr	*ResourceMgr,	// manager to remove it from
+	jeChain_Link	*Link )			// link to remove
+{
+	jeResource	*Resource;
+	uint32		Index;
+
+	Resource = (jeResource *)jeChain_LinkGetLinkData( Link );
+	assert( Resource != NULL );
+
+	Index = Resource->Hash & ( ResourceMgr->SlotCount - 1 );
+	while ( ResourceMgr->Slots[Index].Link != NULL )
+	{
+		if ( ResourceMgr->Slots[Index].Link == Link )
+		{
+			ResourceMgr->Slots[Index].Link = JE_RESOURCE_SLOT_DELETED;
+			return;
+		}
+		Index = ( Index + 1 ) & ( ResourceMgr->SlotCount - 1 );
+	}
+
+	assert( !"jeResource_HashRemove: link not indexed" );
+
+} // jeResource_HashRemove()
+
+
 ////////////////////////////////////////////////////////////////////////////////////////
 //
 //	jeResource_MgrCreate()
@@ -102,6 +292,13 @@ JETAPI jeResourceMgr * JETCC jeResource_MgrCreate(jeEngine* pEngine)
 	// set ref count
 	ResourceMgr->RefCount = 1;
 
+	// init name index
+	if ( jeResource_HashRebuild( ResourceMgr, 0 ) == JE_FALSE )
+	{
+		jeResource_MgrDestroy( &ResourceMgr );
+		return NULL;
+	}
+
 	ResourceMgr->Engine = pEngine;
 
 	// all done
@@ -109,6 +306,37 @@ JETAPI jeResourceMgr * JETCC jeResource_MgrCreate(jeEngine* pEngine)
 
 } // jeResource_MgrCreate()
 
+
+////////////////////////////////////////////////////////////////////////////////////////
+//
+//	jeResource_MgrCreateThreadSafe()
+//
+//	Create a resource manager that can be used from several threads at once.
+//
+////////////////////////////////////////////////////////////////////////////////////////
+JETAPI jeResourceMgr * JETCC jeResource_MgrCreateThreadSafe(jeEngine* pEngine)
+{
+	// locals
+	jeResourceMgr	*ResourceMgr;
+
+	ResourceMgr = jeResource_MgrCreate( pEngine );
+	if ( ResourceMgr == NULL )
+	{
+		return NULL;
+	}
+
+	ResourceMgr->Lock = jeParallel_MutexCreate();
+	if ( ResourceMgr->Lock == NULL )
+	{
+		jeResource_MgrDestroy( &ResourceMgr );
+		return NULL;
+	}
+
+	// all done
+	return ResourceMgr;
+
+} // jeResource_MgrCreateThreadSafe()
+
 JETAPI jeBoolean JETCC jeResourceMgr_SetEngine(jeResourceMgr *ResourceMgr, jeEngine* pEngine)
 {
 	ResourceMgr->Engine = pEngine;
@@ -129,14 +357,19 @@ JETAPI jeEngine* JETCC jeResourceMgr_GetEngine(const jeResourceMgr *ResourceMgr)
 ////////////////////////////////////////////////////////////////////////////////////////
 JETAPI int32 JETCC jeResource_MgrIncRefcount(jeResourceMgr *ResourceMgr )	// manager whose ref count will be incremented
 {
+	// locals
+	int32	RefCount;
+
 	// ensure valid data
 	assert( ResourceMgr != NULL );
 
 	// increment ref count
-	ResourceMgr->RefCount++;
+	jeResource_Lock( ResourceMgr );
+	RefCount = ++ResourceMgr->RefCount;
+	jeResource_Unlock( ResourceMgr );
 
 	// all done
-	return ResourceMgr->RefCount;
+	return RefCount;
 
 } // jeResource_MgrIncRefcount()
 
@@ -189,13 +422,16 @@ JETAPI void JETCC jeResource_MgrDestroy(
 	ResourceMgr = *DeadResourceMgr;
 
 	// dont destroy it if ref count is not zero
+	jeResource_Lock( ResourceMgr );
 	ResourceMgr->RefCount--;
 	assert( ResourceMgr->RefCount >= 0 );
 	if ( ResourceMgr->RefCount > 0 )
 	{
+		jeResource_Unlock( ResourceMgr );
 		*DeadResourceMgr = NULL;
 		return;
 	}
+	jeResource_Unlock( ResourceMgr );
 
 	// destroy list
 	if ( ResourceMgr->List != NULL )
@@ -234,6 +470,17 @@ JETAPI void JETCC jeResource_MgrDestroy(
 		ResourceMgr->List = NULL;
 	}
 
+	// free name index
+	if ( ResourceMgr->Slots != NULL )
+	{
+		jeRam_Free( ResourceMgr->Slots );
+	}
+
+	if ( ResourceMgr->Lock != NULL )
+	{
+		jeParallel_MutexDestroy( &( ResourceMgr->Lock ) );
+	}
+
 	// free main struct
 	jeRam_Free( ResourceMgr );
 
@@ -250,17 +497,18 @@ JETAPI void JETCC jeResource_MgrDestroy(
 //
 //	jeResource_GetNode()
 //
-//	Get a node by name.
+//	Get a node by name.  A Type of 0 matches any type.  Caller holds the lock.
 //
 ////////////////////////////////////////////////////////////////////////////////////////
 static jeChain_Link * jeResource_GetNode(
 	jeResourceMgr	*ResourceMgr,	// resource list to get it from
     uint32          Type,           // resource type
-	char			*Name )			// resource name
+	const char		*Name )			// resource name
 {
 
 	// locals
-	uint32			Count;
+	uint32			Hash;
+	uint32			Index;
 	jeChain_Link	*CurNode;
 
 	if (g_pSingleResource == NULL) {
@@ -270,57 +518,125 @@ static jeChain_Link * jeResource_GetNode(
 	// ensure valid data
 	assert( ResourceMgr != NULL );
 	assert( ResourceMgr->List != NULL );
+	assert( ResourceMgr->Slots != NULL );
 	assert( Name != NULL );
 
-	// fail if resource list is empty
-	Count = jeChain_GetLinkCount( ResourceMgr->List );
-	if ( Count == 0 )
+	// probe until an empty slot, skipping deleted ones
+	Hash = jeResource_HashName( Name );
+	Index = Hash & ( ResourceMgr->SlotCount - 1 );
+	while ( ( CurNode = ResourceMgr->Slots[Index].Link ) != NULL )
 	{
-		return NULL;
+		if ( CurNode != JE_RESOURCE_SLOT_DELETED && ResourceMgr->Slots[Index].Hash == Hash )
+		{
+			// locals
+			jeResource	*Resource;
+
+			// get data
+			Resource = (jeResource *)jeChain_LinkGetLinkData( CurNode );
+			assert( Resource != NULL );
+
+			// if we have found it then return it
+			if ( ( Type == 0 || Type == Resource->Type ) && stricmp( Name, Resource->Name ) == 0 )
+			{
+				return CurNode;
+			}
+		}
+
+		Index = ( Index + 1 ) & ( ResourceMgr->SlotCount - 1 );
 	}
 
-	CurNode = jeChain_GetFirstLink( ResourceMgr->List );
-    while ( CurNode )
-	{
-		// locals
-		jeResource	*Resource;
-		int			Compare;
+	// if we got to here then it was not found
+	return NULL;
 
-		// get data
-		assert( CurNode != NULL );
-		Resource = (jeResource *)jeChain_LinkGetLinkData( CurNode );
-		assert( Resource != NULL );
+} // jeResource_GetNode()
 
-		// get compare value
-		Compare = stricmp( Name, Resource->Name );
 
-		// if we have found it then return it
-        if ( Compare == 0 && (Type==0 || (Type > 0 && Type == Resource->Type)))
+////////////////////////////////////////////////////////////////////////////////////////
+//
+//	jeResource_GetExact()
+//
+//	Get a node whose type matches exactly, even if Type is 0.  Caller holds the lock.
+//
+////////////////////////////////////////////////////////////////////////////////////////
+static jeChain_Link * jeResource_GetExact(
+	jeResourceMgr	*ResourceMgr,	// resource list to get it from
+	uint32			Type,			// resource type
+	const char		*Name )			// resource name
+{
+	// locals
+	uint32			Hash;
+	uint32			Index;
+	jeChain_Link	*CurNode;
+
+	Hash = jeResource_HashName( Name );
+	Index = Hash & ( ResourceMgr->SlotCount - 1 );
+	while ( ( CurNode = ResourceMgr->Slots[Index].Link ) != NULL )
+	{
+		if ( CurNode != JE_RESOURCE_SLOT_DELETED && ResourceMgr->Slots[Index].Hash == Hash )
 		{
-			return CurNode;
+			jeResource	*Resource;
+
+			Resource = (jeResource *)jeChain_LinkGetLinkData( CurNode );
+			if ( Type == Resource->Type && stricmp( Name, Resource->Name ) == 0 )
+			{
+				return CurNode;
+			}
 		}
 
-        CurNode = jeChain_LinkGetNext( CurNode );
+		Index = ( Index + 1 ) & ( ResourceMgr->SlotCount - 1 );
 	}
 
-	// if we got to here then it was not found
 	return NULL;
 
-} // jeResource_GetNode()
+} // jeResource_GetExact()
 
 
+////////////////////////////////////////////////////////////////////////////////////////
+//
+//	jeResource_RemoveNode()
+//
+//	Unlink and free a resource whose ref count reached zero.  Caller holds the lock.
+//
+////////////////////////////////////////////////////////////////////////////////////////
+static void jeResource_RemoveNode(
+	jeResourceMgr	*ResourceMgr,	// resource list to remove it from
+	jeChain_Link	*CurNode )		// node to remove
+{
+	// locals
+	jeResource	*CurResource;
+
+	CurResource = (jeResource *)jeChain_LinkGetLinkData( CurNode );
+	assert( CurResource != NULL );
+	assert( CurResource->RefCount == 0 );
+
+	jeResource_HashRemove( ResourceMgr, CurNode );
+	jeChain_RemoveLink( ResourceMgr->List, CurNode );
+	jeChain_LinkDestroy( &CurNode );
+
+	// free name
+	if ( CurResource->Name != NULL )
+	{
+		jeRam_Free( CurResource->Name );
+	}
+
+	// free resource struct
+	jeRam_Free( CurResource );
+
+} // jeResource_RemoveNode()
+
 
 ////////////////////////////////////////////////////////////////////////////////////////
 //
-//	jeResource_Add()
+//	jeResource_AddLocked()
 //
-//	Add a new resource.
+//	Add a new resource, or add a reference to the one already there.  Returns the
+//	data that ends up in the manager, or NULL on failure.  Caller holds the lock.
 //
 ////////////////////////////////////////////////////////////////////////////////////////
-JETAPI jeBoolean JETCC jeResource_Add(
+static void * jeResource_AddLocked(
 	jeResourceMgr	*ResourceMgr,	// resource list to add it to
-	char			*Name,			// name
-    uint32          Type,           // type
+	const char		*Name,			// name
+	uint32			Type,			// type
 	void			*Data )			// data
 {
 	// locals
@@ -329,66 +645,97 @@ JETAPI jeBoolean JETCC jeResource_Add(
 	jeResource		*CurResource;
 	jeResource		*NewResource;
 
-	// ensure valid data
-	assert( ResourceMgr != NULL );
-	assert( ResourceMgr->List != NULL );
-	assert( Name != NULL );
-	assert( Data != NULL );
+	// data should not already exist
+	CurNode = jeResource_GetExact( ResourceMgr, Type, Name );
+	if ( CurNode != NULL )
+	{
+		CurResource = (jeResource *)jeChain_LinkGetLinkData( CurNode );
+		assert( CurResource != NULL );
+		CurResource->RefCount++;
+		return CurResource->Data; // resource is present, don't add it a second time
+	}
+
+	// grow the index before it gets over half full
+	if ( ( ResourceMgr->SlotsUsed + 1 ) * 2 > ResourceMgr->SlotCount )
+	{
+		if ( jeResource_HashRebuild( ResourceMgr, jeChain_GetLinkCount( ResourceMgr->List ) + 1 ) == JE_FALSE )
+		{
+			return NULL;
+		}
+	}
 
 	// create new resource struct
 	NewResource = (jeResource *)jeRam_Allocate( sizeof( *NewResource ) );
 	if ( NewResource == NULL )
 	{
-		return JE_FALSE;
+		return NULL;
 	}
 	NewResource->Name = Util_StrDup( Name );
+	NewResource->Hash = jeResource_HashName( Name );
 	NewResource->Data = Data;
 	NewResource->RefCount = 1;
     NewResource->Type = Type;
 	NewResource->OpenDir = JE_FALSE;	// [MLB-ICE]
-
-	// search for correct node
-	CurNode = jeChain_GetFirstLink( ResourceMgr->List );
-	while ( CurNode != NULL )
+	if ( NewResource->Name == NULL )
 	{
-		// get resource
-		CurResource = (jeResource *)jeChain_LinkGetLinkData( CurNode );
-		assert( CurResource != NULL );
-
-		// data should not already exist
-        if (stricmp( Name, CurResource->Name ) == 0 && Type == CurResource->Type) {
-            CurResource->RefCount++;
-            return JE_TRUE; // resource is present, don't add it a second time
-        }
-
-		// if we just passed our spot then break out
-		if ( stricmp( Name, CurResource->Name ) < 0 )
-		{
-			break;
-		}
-
-		// get next node
-		CurNode = jeChain_LinkGetNext( CurNode );
-	}
-
-	// if we reached end of list or if list is empty them just at the new link
-	if ( CurNode == NULL )
-	{
-		return jeChain_AddLinkData( ResourceMgr->List, NewResource );
+		jeRam_Free( NewResource );
+		return NULL;
 	}
 
-	// if we got to here then just prepend this link to the current one
+	// lookups go through the index, so the list order no longer matters; add at the head
 	NewNode = jeChain_LinkCreate( NewResource );
 	if ( NewNode == NULL )
 	{
-		return JE_FALSE;
+		jeRam_Free( NewResource->Name );
+		jeRam_Free( NewResource );
+		return NULL;
 	}
-	if ( jeChain_InsertLinkBefore( ResourceMgr->List, CurNode, NewNode ) == JE_FALSE )
+	if ( jeChain_GetFirstLink( ResourceMgr->List ) == NULL )
 	{
-		jeChain_LinkDestroy( &NewNode );
-		return JE_FALSE;
+		jeChain_AddLink( ResourceMgr->List, NewNode );
 	}
-	return JE_TRUE;
+	else
+	{
+		jeChain_InsertLinkBefore( ResourceMgr->List, jeChain_GetFirstLink( ResourceMgr->List ), NewNode );
+	}
+
+	jeResource_HashPlace( ResourceMgr->Slots, ResourceMgr->SlotCount, NewResource->Hash, NewNode );
+	ResourceMgr->SlotsUsed++;
+
+	return Data;
+
+} // jeResource_AddLocked()
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+//
+//	jeResource_Add()
+//
+//	Add a new resource.
+//
+////////////////////////////////////////////////////////////////////////////////////////
+JETAPI jeBoolean JETCC jeResource_Add(
+	jeResourceMgr	*ResourceMgr,	// resource list to add it to
+	char			*Name,			// name
+    uint32          Type,           // type
+	void			*Data )			// data
+{
+	// locals
+	void	*Result;
+
+	// ensure valid data
+	assert( ResourceMgr != NULL );
+	assert( ResourceMgr->List != NULL );
+	assert( Name != NULL );
+	assert( Data != NULL );
+
+	jeResource_Lock( ResourceMgr );
+	Result = jeResource_AddLocked( ResourceMgr, Name, Type, Data );
+	jeResource_Unlock( ResourceMgr );
+
+	return ( Result != NULL ) ? JE_TRUE : JE_FALSE;
 
 } // jeResource_Add()
 
@@ -409,6 +756,7 @@ JETAPI void * JETCC jeResource_Get(
 	// locals
 	jeChain_Link	*CurNode;
 	jeResource		*CurResource;
+	void			*Data;
 
 	// ensure valid data
 	assert( ResourceMgr != NULL );
@@ -416,9 +764,11 @@ JETAPI void * JETCC jeResource_Get(
 	assert( Name != NULL );
 
 	// fail if node doesn't exist
+	jeResource_Lock( ResourceMgr );
 	CurNode = jeResource_GetNode( ResourceMgr, 0, Name );
 	if ( CurNode == NULL )
 	{
+		jeResource_Unlock( ResourceMgr );
 		return NULL;
 	}
 
@@ -426,7 +776,10 @@ JETAPI void * JETCC jeResource_Get(
 	CurResource = (jeResource *)jeChain_LinkGetLinkData( CurNode );
 	assert( CurResource != NULL );
 	CurResource->RefCount++;
-	return CurResource->Data;
+	Data = CurResource->Data;
+	jeResource_Unlock( ResourceMgr );
+
+	return Data;
 
 } // jeResource_Get()
 
@@ -445,6 +798,7 @@ JETAPI int JETCC jeResource_Delete(
 	// locals
 	jeChain_Link	*CurNode;
 	jeResource		*CurResource;
+	int				RefCount;
 
 	if (g_pSingleResource == NULL) {
 		return -1;
@@ -456,9 +810,11 @@ JETAPI int JETCC jeResource_Delete(
 	assert( Name != NULL );
 
 	// fail if node doesn't exist
+	jeResource_Lock( ResourceMgr );
 	CurNode = jeResource_GetNode( ResourceMgr, 0, Name );
 	if ( CurNode == NULL )
 	{
+		jeResource_Unlock( ResourceMgr );
 		return -1;
 	}
 
@@ -467,30 +823,17 @@ JETAPI int JETCC jeResource_Delete(
 	assert( CurResource != NULL );
 	CurResource->RefCount--;
 	assert( CurResource->RefCount >= 0 );
+	RefCount = CurResource->RefCount;
 
 	// if ref count if zero then remove it from the list
-	if ( CurResource->RefCount == 0 )
+	if ( RefCount == 0 )
 	{
-		jeChain_RemoveLink( ResourceMgr->List, CurNode );
-
-		// [MLB-ICE]
-		// NOTE : THIS WAS NEVER HERE!!!
-
-		// free name
-		if ( CurResource->Name != NULL )
-		{
-			jeRam_Free( CurResource->Name );
-		}
-
-		// free resource struct
-		jeRam_Free( CurResource );
-		// [MLB-ICE] EOB
-
-		return 0;
+		jeResource_RemoveNode( ResourceMgr, CurNode );
 	}
+	jeResource_Unlock( ResourceMgr );
 
 	// return current ref count
-	return CurResource->RefCount;
+	return RefCount;
 
 } // jeResource_Delete()
 
@@ -679,11 +1022,13 @@ static jeBoolean jeResource_SetOpenDir(
 	}
 
 	// fail if node doesn't exist
+	jeResource_Lock( ResourceMgr );
     CurNode = jeResource_GetNode( ResourceMgr, JE_RESOURCE_VFS, NewName );
 	jeRam_Free( NewName );
 
 	if ( CurNode == NULL )
 	{
+		jeResource_Unlock( ResourceMgr );
 		return JE_FALSE;
 	}
 
@@ -691,6 +1036,7 @@ static jeBoolean jeResource_SetOpenDir(
 	CurResource = (jeResource *)jeChain_LinkGetLinkData( CurNode );
 	assert( CurResource != NULL );
 	CurResource->OpenDir=JE_TRUE;
+	jeResource_Unlock( ResourceMgr );
 	return JE_TRUE;
 
 }
@@ -810,6 +1156,170 @@ JETAPI jeResourceMgr* JETCC jeResource_MgrCreateDefault(jeEngine* pEngine)
 #include "Bitmap.h"
 #include "jeMaterial.h"
 
+////////////////////////////////////////////////////////////////////////////////////////
+//
+//	jeResource_FindVFile()
+//
+//	Get a VFile resource without touching its ref count.
+//
+////////////////////////////////////////////////////////////////////////////////////////
+static jeVFile * jeResource_FindVFile(
+	jeResourceMgr	*ResourceMgr,	// resource list to get it from
+	char			*Name,			// name
+	jeBoolean		*OpenDir )		// optional, gets the OpenDir flag
+{
+	// locals
+	char			*NewName;
+	jeChain_Link	*CurNode;
+	jeResource		*CurResource;
+	jeVFile			*Data = NULL;
+
+	NewName = jeResource_CreateVFileName( Name );
+	if ( NewName == NULL )
+	{
+		return NULL;
+	}
+
+	jeResource_Lock( ResourceMgr );
+	CurNode = jeResource_GetNode( ResourceMgr, JE_RESOURCE_VFS, NewName );
+	if ( CurNode != NULL )
+	{
+		CurResource = (jeResource *)jeChain_LinkGetLinkData( CurNode );
+		Data = (jeVFile *)CurResource->Data;
+		if ( OpenDir != NULL )
+		{
+			*OpenDir = CurResource->OpenDir;
+		}
+	}
+	jeResource_Unlock( ResourceMgr );
+
+	jeRam_Free( NewName );
+	return Data;
+
+} // jeResource_FindVFile()
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+//
+//	jeResource_AddDirectory()
+//
+//	Add a directory opened by jeResource_GetResource().  If another thread added one
+//	under the same name first, ours is closed and theirs is returned.
+//
+////////////////////////////////////////////////////////////////////////////////////////
+static jeVFile * jeResource_AddDirectory(
+	jeResourceMgr	*ResourceMgr,	// resource list to add it to
+	char			*Name,			// name
+	jeVFile			*Directory )	// directory just opened
+{
+	// locals
+	char			*NewName;
+	jeChain_Link	*CurNode;
+	jeResource		*CurResource;
+	jeVFile			*Data;
+
+	NewName = jeResource_CreateVFileName( Name );
+	if ( NewName == NULL )
+	{
+		jeVFile_Destroy( &Directory );
+		return NULL;
+	}
+
+	jeResource_Lock( ResourceMgr );
+	CurNode = jeResource_GetExact( ResourceMgr, JE_RESOURCE_VFS, NewName );
+	if ( CurNode != NULL )
+	{
+		CurResource = (jeResource *)jeChain_LinkGetLinkData( CurNode );
+		Data = (jeVFile *)CurResource->Data;
+	}
+	else
+	{
+		Data = (jeVFile *)jeResource_AddLocked( ResourceMgr, NewName, JE_RESOURCE_VFS, Directory );
+		CurNode = jeResource_GetExact( ResourceMgr, JE_RESOURCE_VFS, NewName );
+		if ( CurNode != NULL )
+		{
+			CurResource = (jeResource *)jeChain_LinkGetLinkData( CurNode );
+			CurResource->OpenDir = JE_TRUE;
+		}
+	}
+	jeResource_Unlock( ResourceMgr );
+
+	jeRam_Free( NewName );
+
+	if ( Data != Directory )
+	{
+		jeVFile_Destroy( &Directory );
+	}
+	return Data;
+
+} // jeResource_AddDirectory()
+
+
+// Krouer ;: add usefull function to read resource from disk and create them from here
+// First declare all functions need to create data
+#include "Bitmap.h"
+#include "jeMaterial.h"
+
+////////////////////////////////////////////////////////////////////////////////////////
+//
+//	jeResource_AddDataRef()
+//
+//	Add a reference to the object itself, for the kinds handed out shared.
+//
+////////////////////////////////////////////////////////////////////////////////////////
+static void jeResource_AddDataRef(
+	int32	Type,	// resource kind
+	void	*Data )	// resource data
+{
+	switch (Type) {
+	case JE_RESOURCE_BITMAP:
+        {
+            jeBitmap* pBitmap = (jeBitmap*) Data;
+            jeBitmap_CreateRef(pBitmap);
+        }
+        break;
+	case JE_RESOURCE_MATERIAL:
+        {
+            jeMaterialSpec* pMatSpec = (jeMaterialSpec*) Data;
+            jeMaterialSpec_CreateRef(pMatSpec);
+        }
+        break;
+	case JE_RESOURCE_TEXTURE:
+        break;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+//
+//	jeResource_DestroyData()
+//
+//	Throw away an object jeResource_GetResource() loaded but lost the race to add.
+//
+////////////////////////////////////////////////////////////////////////////////////////
+static void jeResource_DestroyData(
+	jeResourceMgr	*ResourceMgr,	// resource list it was loaded for
+	int32			Type,			// resource kind
+	void			*Data )			// resource data
+{
+	switch (Type) {
+	case JE_RESOURCE_MATERIAL:
+        {
+            jeMaterialSpec* pMatSpec = (jeMaterialSpec*) Data;
+            jeMaterialSpec_Destroy(&pMatSpec);
+        }
+        break;
+	case JE_RESOURCE_TEXTURE:
+        jeEngine_DestroyTexture(ResourceMgr->Engine, (jeTexture*) Data);
+        break;
+	default:
+        {
+            jeBitmap* pBitmap = (jeBitmap*) Data;
+            jeBitmap_Destroy(&pBitmap);
+        }
+        break;
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////
 //
 //	jeResource_GetResource()
@@ -825,6 +1335,7 @@ JETAPI void * JETCC jeResource_GetResource(
 	// locals
 	jeChain_Link	*CurNode;
 	jeResource		*CurResource;
+	void			*Data;
 
 	// ensure valid data
 	assert( ResourceMgr != NULL );
@@ -832,17 +1343,19 @@ JETAPI void * JETCC jeResource_GetResource(
 	assert( Name != NULL );
 
 	// fail if node doesn't exist
+	jeResource_Lock( ResourceMgr );
 	CurNode = jeResource_GetNode( ResourceMgr, Type, Name );
 	if ( CurNode == NULL ) // if failed, new behavior
 	{
-		void* Data;
 		char* Paks;
 		char* ResName;
 		char* CopyName;
-		jeResource* DirRes;
 		jeVFile* Directory;
 		jeVFile* ResFile;
 
+		// nothing is held while loading, the loaders call back in here
+		jeResource_Unlock( ResourceMgr );
+
 		CopyName = Util_StrDup(Name);
 
 		// the resource was not already open
@@ -860,45 +1373,41 @@ JETAPI void * JETCC jeResource_GetResource(
 
 		if (Paks) {
 			// open the first part of the name separate by :
-            CurNode = jeResource_GetNode( ResourceMgr, JE_RESOURCE_VFS, jeResource_CreateVFileName(Paks) );
+			Directory = jeResource_FindVFile( ResourceMgr, Paks, NULL );
 
 			// fail to find the dir/pak resource
-			if (CurNode == NULL) {
+			if (Directory == NULL) {
 				// the resource was not already open
-				// open the first part of the name separate by :
-				CurNode = jeResource_GetNode( ResourceMgr, JE_RESOURCE_VFS, jeResource_CreateVFileName("GlobalMaterials") );
-				DirRes = (jeResource *)jeChain_LinkGetLinkData( CurNode ); 
-
 				// now, we have to add a jeVFile to the ResourceMgr - we add a directory because normally it's already done by the editor or the game
-				Directory = (jeVFile *) jeVFile_OpenNewSystem((jeVFile*) DirRes->Data,
+				Directory = (jeVFile *) jeVFile_OpenNewSystem(jeResource_FindVFile( ResourceMgr, "GlobalMaterials", NULL ),
 							                                  JE_VFILE_TYPE_DOS,
 							                                  Paks,
 							                                  NULL,
 							                                  JE_VFILE_OPEN_READONLY|JE_VFILE_OPEN_DIRECTORY);
 
 				// add it to the resource for the next time
-				jeResource_AddVFile(ResourceMgr, Paks, Directory);
-				jeResource_SetOpenDir( ResourceMgr, Paks);
-			} else {
-				DirRes = (jeResource *)jeChain_LinkGetLinkData( CurNode );
-				Directory = (jeVFile*) DirRes->Data;
+				if (Directory) {
+					Directory = jeResource_AddDirectory( ResourceMgr, Paks, Directory );
+				}
 			}
 		} else {
-			CurNode = jeResource_GetNode( ResourceMgr, JE_RESOURCE_VFS, jeResource_CreateVFileName("GlobalMaterials") );
 			// open the resource container
-			DirRes = (jeResource *)jeChain_LinkGetLinkData( CurNode ); 
-			Directory = (jeVFile*) DirRes->Data;
+			Directory = jeResource_FindVFile( ResourceMgr, "GlobalMaterials", NULL );
 		}
 
 		// get the name of the sub resource
-		if (ResName==NULL) {
+		if (ResName==NULL || Directory==NULL) {
+			jeRam_Free(CopyName);
 			return NULL;
 		}
 
 		// Try to locate already 
+		jeResource_Lock( ResourceMgr );
 		CurNode = jeResource_GetNode( ResourceMgr, Type, ResName );
 		if (CurNode==NULL) {
 			char* ResNameCopy;
+			jeBoolean Shared = JE_FALSE;
+			jeResource_Unlock( ResourceMgr );
 			ResNameCopy = (char*) jeRam_Allocate(strlen(ResName)+10);
 			strcpy(ResNameCopy, ResName);
             Data = NULL;
@@ -930,9 +1439,16 @@ JETAPI void * JETCC jeResource_GetResource(
                     Data = jeMaterialSpec_CreateFromFile(ResFile, ResourceMgr->Engine, ResourceMgr);
 */
                     Data = jeResource_GetResource(ResourceMgr, JE_RESOURCE_MATERIAL, "jet3d");
+                    Shared = JE_TRUE;
                 }
 				break;
 			case JE_RESOURCE_TEXTURE:
+				// Textures are driver objects; a manager without an engine can't make them
+				if (ResourceMgr->Engine == NULL) {
+					jeErrorLog_AddString(-1, "jeResource_GetResource:  a texture needs an engine", ResName);
+					ResFile = NULL;
+					break;
+				}
 				{
 				char* extension = ResNameCopy + strlen(ResName);
 				strcpy(extension, ".png");
@@ -965,13 +1481,29 @@ JETAPI void * JETCC jeResource_GetResource(
 				jeVFile_Close(ResFile);
             }
             if (Data) {
-				jeResource_Add(ResourceMgr, Name, Type, Data);
+				void* Stored;
+
+				jeResource_Lock( ResourceMgr );
+				Stored = jeResource_AddLocked(ResourceMgr, Name, Type, Data);
+				jeResource_Unlock( ResourceMgr );
+
+				// another thread loaded it while we did, use theirs
+				if (Stored != NULL && Stored != Data) {
+					if (Shared) {
+						jeResource_ReleaseResource(ResourceMgr, JE_RESOURCE_MATERIAL, "jet3d");
+					} else {
+						jeResource_DestroyData(ResourceMgr, Type, Data);
+					}
+					jeResource_AddDataRef(Type, Stored);
+					Data = Stored;
+				}
 			}
 			jeRam_Free(ResNameCopy);
 		} else {
-			DirRes = (jeResource *)jeChain_LinkGetLinkData( CurNode );
-			DirRes->RefCount++;
-			Data = DirRes->Data;
+			CurResource = (jeResource *)jeChain_LinkGetLinkData( CurNode );
+			CurResource->RefCount++;
+			Data = CurResource->Data;
+			jeResource_Unlock( ResourceMgr );
 		}
 
 		jeRam_Free(CopyName);
@@ -984,23 +1516,11 @@ JETAPI void * JETCC jeResource_GetResource(
 	CurResource = (jeResource *)jeChain_LinkGetLinkData( CurNode );
 	assert( CurResource != NULL );
 	CurResource->RefCount++;
-	switch (Type) {
-	case JE_RESOURCE_BITMAP:
-        {
-            jeBitmap* pBitmap = (jeBitmap*) CurResource->Data;
-            jeBitmap_CreateRef(pBitmap);
-        }
-        break;
-	case JE_RESOURCE_MATERIAL:
-        {
-            jeMaterialSpec* pMatSpec = (jeMaterialSpec*) CurResource->Data;
-            jeMaterialSpec_CreateRef(pMatSpec);
-        }
-        break;
-	case JE_RESOURCE_TEXTURE:
-        break;
-    }
-	return CurResource->Data;
+	Data = CurResource->Data;
+	jeResource_Unlock( ResourceMgr );
+
+	jeResource_AddDataRef(Type, Data);
+	return Data;
 
 } // jeResource_GetResource()
 
@@ -1008,19 +1528,15 @@ JETAPI void * JETCC jeResource_GetResource(
 JETAPI void JETCC jeResource_ExportResource(jeResourceMgr *ResourceMgr, int32 Type, char *Name, void* Data)
 {
 	// locals
-	jeChain_Link	*CurNode;
-	jeResource		*CurResource;
-	
+	jeBoolean OpenDir = JE_FALSE;
 	jeVFile* Directory;
 
-	CurNode = jeResource_GetNode( ResourceMgr, JE_RESOURCE_VFS, jeResource_CreateVFileName("GlobalMaterials") );
-	CurResource = (jeResource *)jeChain_LinkGetLinkData( CurNode ); 
-	if (CurResource->OpenDir) {
+	Directory = jeResource_FindVFile( ResourceMgr, "GlobalMaterials", &OpenDir );
+	if (Directory && OpenDir) {
 		char* ResNameCopy;
 		jeVFile* ResFile;
 		ResNameCopy = (char*) jeRam_Allocate(strlen(Name)+10);
 		strcpy(ResNameCopy, Name);
-		Directory = (jeVFile*) CurResource->Data;
 		switch (Type) {
 		case JE_RESOURCE_BITMAP:
 			strcat(ResNameCopy, ".bmp");
@@ -1043,6 +1559,7 @@ JETAPI jeBoolean JETCC jeResource_ReleaseResource(jeResourceMgr *ResourceMgr, in
 	// locals
 	jeChain_Link	*CurNode;
 	jeResource		*CurResource;
+	void			*DeadData = NULL;
 
 	// ensure valid data
 	assert( ResourceMgr != NULL );
@@ -1050,6 +1567,7 @@ JETAPI jeBoolean JETCC jeResource_ReleaseResource(jeResourceMgr *ResourceMgr, in
 	assert( Name != NULL );
 
 	// fail if node doesn't exist
+	jeResource_Lock( ResourceMgr );
 	CurNode = jeResource_GetNode( ResourceMgr, Type, Name );
 
 	if (CurNode) {
@@ -1058,28 +1576,21 @@ JETAPI jeBoolean JETCC jeResource_ReleaseResource(jeResourceMgr *ResourceMgr, in
 		CurResource->RefCount--;
 
 		if (CurResource->RefCount == 0) {
-			// Free the texture when fully managed from here
-			if (Type == JE_RESOURCE_TEXTURE && CurResource->Data) {
-				jeEngine_DestroyTexture(ResourceMgr->Engine, (jeTexture*) CurResource->Data);
-				CurResource->Data = NULL;
-			}
+			DeadData = CurResource->Data;
 
 			// Remove the link
-			jeChain_RemoveLink( ResourceMgr->List, CurNode );
-
-			// free name
-			if ( CurResource->Name != NULL )
-			{
-				jeRam_Free( CurResource->Name );
-			}
+			jeResource_RemoveNode( ResourceMgr, CurNode );
+		}
+		jeResource_Unlock( ResourceMgr );
 
-			// free resource struct
-			jeRam_Free( CurResource );
+		// Free the texture when fully managed from here
+		if (Type == JE_RESOURCE_TEXTURE && DeadData) {
+			jeEngine_DestroyTexture(ResourceMgr->Engine, (jeTexture*) DeadData);
 		}
 
 		return JE_TRUE;
 	}
+	jeResource_Unlock( ResourceMgr );
 
 	return JE_FALSE;
 }
-
@@ -200,8 +200,8 @@ JETAPI jeBoolean JETCC jeTClip_SetTexture(const jeMaterialSpec * Material, int32
 
 	if ( Bitmap )
 	{
+		// NULL while the bitmap waits on the attach budget; triangles go out gouraud until then
 		jeTClip_Statics.THandle = jeBitmap_GetTHandle(Bitmap);
-		assert(jeTClip_Statics.THandle);
 	}
 	else
 	{
@@ -1301,8 +1301,7 @@ int i;
 		Textures = (jeBitmap **) QT->Terrain->Textures;
 		if ( Textures[i] )
 		{
-			pTHandles_g[i] = jeBitmap_GetTHandle(Textures[i]);
-			assert(pTHandles_g[i]);
+			pTHandles_g[i] = jeBitmap_GetTHandle(Textures[i]);	// NULL while its attach is pending
 		}
 		else
 		{
@@ -1318,7 +1317,6 @@ int i;
 		sel = T->SelectionTexX + T->SelectionTexY * T->TexDim;
 		
 		pTHandles_g[sel] = jeBitmap_GetTHandle( T->HiliteTexture );
-		assert(pTHandles_g[sel]);
 	}
 
 	// <> could use a manual stack for the renderer
@@ -1464,6 +1462,17 @@ int u,v;
 return (u + v * TexDim_g);
 }
 
+static void Quad_DriverRender(Quad *pQuad,jeLVertex * Verts,int nVerts,uint32 Flags)
+{
+	// a texture still waiting on the engine's attach budget has no THandle yet;
+	//	draw the quad untextured until it has one
+	Layer_g.THandle = pTHandles_g[Quad_TexNum(pQuad)];
+	if ( Layer_g.THandle )
+		pRDriver_g->RenderMiscTexturePoly((jeTLVertex *)Verts,nVerts,&Layer_g,1,Flags);
+	else
+		pRDriver_g->RenderGouraudPoly((jeTLVertex *)Verts,nVerts,Flags);
+}
+
 void Quad_RenderQuad(Quad *pQuad)
 {
 int32 nVerts;
@@ -1515,10 +1524,8 @@ jePlane * pPlane;
 #define QUAD_RENDER_FLAGS	(JE_RENDER_FLAG_COUNTER_CLOCKWISE|JE_RENDER_FLAG_CLAMP_UV)
 
 	TIMER_P(R_Driver);
-	assert(pTHandles_g[Quad_TexNum(pQuad)]);
 	UnitizeVerts(pVerts1,nVerts);
-	Layer_g.THandle = pTHandles_g[Quad_TexNum(pQuad)];
-	pRDriver_g->RenderMiscTexturePoly((jeTLVertex *)pVerts1,nVerts,&Layer_g,1,QUAD_RENDER_FLAGS);
+	Quad_DriverRender(pQuad,pVerts1,nVerts,QUAD_RENDER_FLAGS);
 	TIMER_Q(R_Driver);
 
 RenderNextQuadTri:
@@ -1558,10 +1565,8 @@ RenderNextQuadTri:
 									(jeVec3d *)pVerts1, sizeof(jeLVertex), nVerts);
 
 	TIMER_P(R_Driver);
-	assert(pTHandles_g[Quad_TexNum(pQuad)]);
 	UnitizeVerts(pVerts1,nVerts);
-	Layer_g.THandle = pTHandles_g[Quad_TexNum(pQuad)];
-	pRDriver_g->RenderMiscTexturePoly((jeTLVertex *)pVerts1,nVerts,&Layer_g,1,QUAD_RENDER_FLAGS);
+	Quad_DriverRender(pQuad,pVerts1,nVerts,QUAD_RENDER_FLAGS);
 	TIMER_Q(R_Driver);
 
 	REPORT(RenderedPolys++);
@@ -1612,10 +1617,8 @@ uint32 ClipFlags;
 									(jeVec3d *)pVerts1, sizeof(jeLVertex), nVerts);
 
 	TIMER_P(R_Driver);
-	assert(pTHandles_g[Quad_TexNum(pQuad)]);
 	UnitizeVerts(pVerts1,nVerts);
-	Layer_g.THandle = pTHandles_g[Quad_TexNum(pQuad)];
-	pRDriver_g->RenderMiscTexturePoly((jeTLVertex *)pVerts1,nVerts,&Layer_g,1,QUAD_RENDER_FLAGS);
+	Quad_DriverRender(pQuad,pVerts1,nVerts,QUAD_RENDER_FLAGS);
 	TIMER_Q(R_Driver);
 
 	REPORT(RenderedPolys++);
@@ -1675,10 +1678,8 @@ int NumLVerts;
 									(jeVec3d *)LVerts, sizeof(jeLVertex), NumLVerts);
 
 	TIMER_P(R_Driver);
-	assert(pTHandles_g[Quad_TexNum(pQuad)]);
 	UnitizeVerts(LVerts,NumLVerts);
-	Layer_g.THandle = pTHandles_g[Quad_TexNum(pQuad)];
-	pRDriver_g->RenderMiscTexturePoly((jeTLVertex *)LVerts,NumLVerts,&Layer_g,1,JE_RENDER_FLAG_CLAMP_UV);
+	Quad_DriverRender(pQuad,LVerts,NumLVerts,JE_RENDER_FLAG_CLAMP_UV);
 	TIMER_Q(R_Driver);
 
 	REPORT(RenderedPolys++);	
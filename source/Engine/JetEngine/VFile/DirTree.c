@@ -64,6 +64,18 @@ void FastSplitPath(register char* path, char* drive, char* dir, char* fname, cha
 #define	DIRTREE_LIST_TERMINATED		MAKEFOURCC('D', 'T', '0', '2')	//	0x32305444
 #define DIRTREE_LIST_NOTTERMINATED	MAKEFOURCC('D', 'T', '0', '3')	//	0x33305444
 
+#define	DIRTREE_MIN_HASH_SIZE		8		// Buckets in a directory's child index, power of 2
+
+/*
+	Every directory keeps its children in the Siblings list (which is what gets
+	written to disk and what the finders walk) and also in a hash table keyed on
+	the case-folded name, so lookups don't stricmp their way down the list.
+
+	Lookups only read the tree and use no static scratch space, so any number of
+	threads may look up at once.  Adding or removing entries still needs the
+	caller to keep lookups out.
+*/
+
 typedef struct	DirTree
 {
 	char *				Name;
@@ -76,6 +88,12 @@ typedef struct	DirTree
 	struct DirTree *	Parent;
 	struct DirTree *	Children;
 	struct DirTree *	Siblings;
+
+	uint32				NameHash;		// Of the case-folded Name
+	struct DirTree *	HashNext;		// Next child in the same bucket of Parent->HashTable
+	struct DirTree **	HashTable;		// Children by NameHash, NULL until there are children
+	int					HashSize;
+	int					NumChildren;
 }	DirTree;
 
 typedef struct	DirTree_Finder
@@ -97,6 +115,128 @@ static	char *	DuplicateString(const char *String)
 	return NewString;
 }
 
+static	char	FoldChar(char c)
+{
+	if	(c >= 'A' && c <= 'Z')
+		return (char)(c - 'A' + 'a');
+	return c;
+}
+
+static	uint32	HashName(const char *Name, int Length)
+{
+	uint32	Hash;
+
+	// FNV-1a
+	Hash = 2166136261U;
+	while	(Length--)
+	{
+		Hash ^= (uint8)FoldChar(*Name++);
+		Hash *= 16777619U;
+	}
+
+	return Hash;
+}
+
+static	jeBoolean	NameMatches(const DirTree *Entry, const char *Name, int Length)
+{
+	const char *	EntryName;
+
+	EntryName = Entry->Name;
+	while	(Length--)
+	{
+		if	(FoldChar(*EntryName++) != FoldChar(*Name++))
+			return JE_FALSE;
+	}
+
+	return (*EntryName == '\0') ? JE_TRUE : JE_FALSE;
+}
+
+static	void	HashInsert(DirTree *Tree, DirTree *Child)
+{
+	DirTree **	pBucket;
+
+	// Append, so the chains keep the order of the Siblings list and the first
+	//	of two equal names wins, as it did with the linear search
+	pBucket = &Tree->HashTable[Child->NameHash & (Tree->HashSize - 1)];
+	while	(*pBucket)
+		pBucket = &(*pBucket)->HashNext;
+
+	Child->HashNext = NULL;
+	*pBucket = Child;
+}
+
+static	void	HashRemove(DirTree *Tree, DirTree *Child)
+{
+	DirTree **	pBucket;
+
+	if	(!Tree->HashTable)
+		return;
+
+	pBucket = &Tree->HashTable[Child->NameHash & (Tree->HashSize - 1)];
+	while	(*pBucket)
+	{
+		if	(*pBucket == Child)
+		{
+			*pBucket = Child->HashNext;
+			Child->HashNext = NULL;
+			return;
+		}
+		pBucket = &(*pBucket)->HashNext;
+	}
+}
+
+/*
+	IndexChildren (re)builds the child index of Tree at a size that fits
+	NumChildren.  On failure the old index, if any, is left as it was.
+*/
+static	jeBoolean	IndexChildren(DirTree *Tree, int NumChildren)
+{
+	DirTree **	NewTable;
+	DirTree *	Child;
+	int			NewSize;
+
+	NewSize = DIRTREE_MIN_HASH_SIZE;
+	while	(NewSize < NumChildren)
+		NewSize <<= 1;
+
+	if	(Tree->HashTable && NewSize <= Tree->HashSize)
+		return JE_TRUE;
+
+	NewTable = (DirTree **)jeRam_AllocateClear(NewSize * sizeof(*NewTable));
+	if	(!NewTable)
+		return JE_FALSE;
+
+	if	(Tree->HashTable)
+		jeRam_Free(Tree->HashTable);
+
+	Tree->HashTable = NewTable;
+	Tree->HashSize = NewSize;
+
+	for	(Child = Tree->Children; Child; Child = Child->Siblings)
+		HashInsert(Tree, Child);
+
+	return JE_TRUE;
+}
+
+static	DirTree *	FindChild(const DirTree *Tree, const char *Name, int Length)
+{
+	DirTree *	Child;
+	uint32		Hash;
+
+	if	(!Tree->HashTable)
+		return NULL;
+
+	Hash = HashName(Name, Length);
+
+	for	(Child = Tree->HashTable[Hash & (Tree->HashSize - 1)]; Child; Child = Child->HashNext)
+	{
+		if	(Child->NameHash == Hash && NameMatches(Child, Name, Length) == JE_TRUE)
+			return Child;
+	}
+
+	return NULL;
+}
+
 DirTree *DirTree_Create(void)
 {
 	DirTree *	Tree;
@@ -135,6 +275,9 @@ void	DirTree_Destroy(DirTree *Tree)
 	if ( Tree->Name )
 		jeRam_Free(Tree->Name);
 
+	if ( Tree->HashTable )
+		jeRam_Free(Tree->HashTable);
+
 	if ( Tree->Hints.HintData != NULL)
 		jeRam_Free(Tree->Hints.HintData);
 
@@ -402,6 +545,7 @@ DirTree *	Tree = NULL;
 	}
 
 	Tree->Name[Length] = 0;
+	Tree->NameHash = HashName(Tree->Name, strlen(Tree->Name));
 
 //printf("Reading '%s'\n", Tree->Name);
 
@@ -458,6 +602,23 @@ DirTree *	Tree = NULL;
 	if	(ReadTree(File, &Tree->Children) == JE_FALSE)
 		goto fail;
 
+	if	(Tree->Children)
+	{
+	DirTree *	Child;
+
+		for	(Child = Tree->Children; Child; Child = Child->Siblings)
+		{
+			Child->Parent = Tree;
+			Tree->NumChildren++;
+		}
+
+		if	(IndexChildren(Tree, Tree->NumChildren) == JE_FALSE)
+		{
+			jeErrorLog_AddString(-1,"ReadTree : Ram",Tree->Name);
+			goto fail;
+		}
+	}
+
 //printf("Reading siblings of '%s'\n", Tree->Name);
 	// Read the Siblings
 	if	(ReadTree(File, &Tree->Siblings) == JE_FALSE)
@@ -522,11 +683,14 @@ jeVFile * LZFS;
 	return Res;
 }
 
-static	const char *GetNextDir(const char *Path, char *Buff)
+static	const char *GetNextDir(const char *Path, int *Length)
 {
+	const char *	Start;
+
+	Start = Path;
 	while	(*Path && *Path != '\\')
-		*Buff++ = *Path++;
-	*Buff = '\0';
+		Path++;
+	*Length = (int)(Path - Start);
 
 	if	(*Path == '\\')
 		Path++;
@@ -536,8 +700,9 @@ static	const char *GetNextDir(const char *Path, char *Buff)
 
 DirTree *DirTree_FindExact(const DirTree *Tree, const char *Path)
 {
-	static char	Buff[_MAX_PATH];
-	DirTree *	Siblings;
+	DirTree *		Child;
+	const char *	Name;
+	int				Length;
 
 	assert(Tree);
 	assert(Path);
@@ -548,21 +713,19 @@ DirTree *DirTree_FindExact(const DirTree *Tree, const char *Path)
 	if	(*Path == '\0')
 		return (DirTree *)Tree;
 
-	Path = GetNextDir(Path, Buff);
-
-	Siblings = Tree->Children;
-	while	(Siblings)
+	do
 	{
-		if	(!stricmp(Siblings->Name, Buff))
-		{
-			if	(!*Path)
-				return Siblings;
-			return DirTree_FindExact(Siblings, Path);
-		}
-		Siblings = Siblings->Siblings;
-	}
+		Name = Path;
+		Path = GetNextDir(Path, &Length);
 
-	return NULL;
+		Child = FindChild(Tree, Name, Length);
+		if	(!Child)
+			return NULL;
+
+		Tree = Child;
+	}	while	(*Path);
+
+	return Child;
 }
 
 DirTree *DirTree_FindPartial(
@@ -570,8 +733,9 @@ DirTree *DirTree_FindPartial(
 	const char *	Path,
 	const char **	LeftOvers)
 {
-	static char	Buff[_MAX_PATH];
-	DirTree *	Siblings;
+	DirTree *		Child;
+	const char *	Name;
+	int				Length;
 
 	assert(Tree);
 	assert(Path);
@@ -581,22 +745,17 @@ DirTree *DirTree_FindPartial(
 
 	*LeftOvers = Path;
 
-	if	(*Path == '\0')
-		return (DirTree *)Tree;
+	while	(*Path)
+	{
+		Name = Path;
+		Path = GetNextDir(Path, &Length);
 
-	Path = GetNextDir(Path, Buff);
+		Child = FindChild(Tree, Name, Length);
+		if	(!Child)
+			break;
 
-	Siblings = Tree->Children;
-	while	(Siblings)
-	{
-		if	(!stricmp(Siblings->Name, Buff))
-		{
-			*LeftOvers = Path;
-			if	(!*Path)
-				return Siblings;
-			return DirTree_FindPartial(Siblings, Path, LeftOvers);
-		}
-		Siblings = Siblings->Siblings;
+		*LeftOvers = Path;
+		Tree = Child;
 	}
 
 	return (DirTree *)Tree;
@@ -640,6 +799,16 @@ DirTree * DirTree_AddFile(DirTree *Tree, const char *Path, jeBoolean IsDirectory
 	memset(NewEntry, 0, sizeof(*NewEntry));
 	NewEntry->Name = DuplicateString(Path);
 	if	(!NewEntry->Name)
+	{
+		jeRam_Free(NewEntry);
+		return NULL;
+	}
+
+	NewEntry->NameHash = HashName(NewEntry->Name, strlen(NewEntry->Name));
+	NewEntry->Parent = Tree;
+
+	// Only fails if there is no index yet; a full one just gets longer chains
+	if	(IndexChildren(Tree, Tree->NumChildren + 1) == JE_FALSE && !Tree->HashTable)
 	{
 		jeRam_Free(NewEntry->Name);
 		jeRam_Free(NewEntry);
@@ -648,6 +817,16 @@ DirTree * DirTree_AddFile(DirTree *Tree, const char *Path, jeBoolean IsDirectory
 
 	NewEntry->Siblings = Tree->Children;
 						 Tree->Children = NewEntry;
+	Tree->NumChildren++;
+
+	// New entries go in front of the list, so in front of their chain too
+	{
+	DirTree **	pBucket;
+
+		pBucket = &Tree->HashTable[NewEntry->NameHash & (Tree->HashSize - 1)];
+		NewEntry->HashNext = *pBucket;
+		*pBucket = NewEntry;
+	}
 
 	if	(IsDirectory == JE_TRUE)
 		NewEntry->AttributeFlags |= JE_VFILE_ATTRIB_DIRECTORY;
@@ -681,6 +860,9 @@ jeBoolean DirTree_Remove(DirTree *Tree, DirTree *SubTree)
 	{
 		if	(pSiblings->Siblings == SubTree)
 		{
+			HashRemove(Parent, SubTree);
+			Parent->NumChildren--;
+
 			pSiblings->Siblings = SubTree->Siblings;
 			if	(SubTree == Parent->Children)
 				Parent->Children = SubTree->Siblings;
@@ -805,19 +987,26 @@ jeBoolean DirTree_GetName(const DirTree *Tree, char *Buff, int MaxLen)
 
 jeBoolean DirTree_GetFullName(const DirTree *Tree, char *Buff, int MaxLen)
 {
-	int	Length;
+	int			Length;
+	jeBoolean	Separator;
 
-	Length = strlen(Tree->Name) + 1;
+	// The root's name is empty, so the path doesn't start with a separator
+	Separator = (Tree->Parent && *Tree->Parent->Name && *Tree->Name) ? JE_TRUE : JE_FALSE;
+
+	Length = strlen(Tree->Name) + 1 + Separator;
 	if	(Length > MaxLen)
 		return JE_FALSE;
 
 	*Buff = '\0';
 	if	(Tree->Parent)
 	{
-		if	(DirTree_GetFullName(Tree->Parent, Buff, MaxLen - Length) == JE_FALSE)
+		if	(DirTree_GetFullName(Tree->Parent, Buff, MaxLen - Length + 1) == JE_FALSE)
 			return JE_FALSE;
 	}
 
+	if	(Separator)
+		strcat(Buff, "\\");
+
 	strcat(Buff, Tree->Name);
 
 	return JE_TRUE;
@@ -44,6 +44,8 @@ DirTree *DirTree_FindPartial(
 	const char *	Path,
 	const char **	LeftOvers);
 //DirTree *DirTree_Find(const DirTree *Tree, const char *Path);
+	// Lookups are hashed per directory and may run on several threads at
+	// once, as long as nothing adds or removes entries meanwhile.
 
 jeBoolean DirTree_OpenFile(DirTree * Tree,uint32 OpenFlags);
 
@@ -372,6 +372,25 @@ static	jeBoolean	JETCC FSMemory_Read(void *Handle, void *Buff, uint32 Count)
 	return JE_TRUE;
 }
 
+static	jeBoolean	JETCC FSMemory_ReadAt(void *Handle, long Offset, void *Buff, uint32 Count)
+{
+	const MemoryFile *	File;
+
+	assert(Buff);
+	assert(Count != 0);
+
+	File = (const MemoryFile *)Handle;
+
+	CHECK_HANDLE(File);
+
+	if	(Offset < 0 || Offset > File->Size || Count > (uint32)(File->Size - Offset))
+		return JE_FALSE;
+
+	memcpy(Buff, File->Memory + File->PositionAdjust + Offset, Count);
+
+	return JE_TRUE;
+}
+
 static	jeBoolean	JETCC FSMemory_Write(void *Handle, const void *Buff, int Count)
 {
 	MemoryFile *	File;
@@ -647,6 +666,8 @@ static	jeVFile_SystemAPIs	FSMemory_APIs =
 	FSMemory_HintsSize,
 #endif
 	FSMemory_GetHintsFile,
+
+	FSMemory_ReadAt,
 };
 
 const jeVFile_SystemAPIs * JETCC FSMemory_GetAPIs(void)
@@ -0,0 +1,1346 @@
+/****************************************************************************************/
+/*  FSPOSIX.C                                                                           */
+/*                                                                                      */
+/*  Author: Styx3D Modernization                                                        */
+/*  Description: POSIX disk file system implementation                                  */
+/*                                                                                      */
+/*  Mirrors FSDos: same hints handling, finder rules and directory handles.  Names are  */
+/*  resolved case-insensitively one path component at a time, so content authored on   */
+/*  Windows loads as-is.  Read-only files above FSPOSIX_MMAP_MIN are mapped, and reads  */
+/*  are served straight out of the mapping.                                             */
+/*                                                                                      */
+/*  The contents of this file are subject to the 0BSD License.                          */
+/*  See LICENSE file in the project root for full license information.                  */
+/*                                                                                      */
+/****************************************************************************************/
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE		// FNM_CASEFOLD
+#endif
+
+#include	<sys/types.h>
+#include	<sys/stat.h>
+#include	<sys/mman.h>
+#include	<sys/time.h>
+#include	<dirent.h>
+#include	<errno.h>
+#include	<fcntl.h>
+#include	<fnmatch.h>
+#include	<strings.h>
+#include	<unistd.h>
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<assert.h>
+
+#include	"BaseType.h"
+#include	"Ram.h"
+
+#include	"VFile.h"
+#include	"VFile._h"
+
+#include	"FSPosix.h"
+
+#ifndef O_CLOEXEC
+#define O_CLOEXEC	0
+#endif
+
+#ifndef PATH_MAX
+#define PATH_MAX	4096
+#endif
+
+//	"PF01"
+#define	POSIXFILE_SIGNATURE		0x31304650
+
+//	"PF02"
+#define	POSIXFINDER_SIGNATURE	0x32304650
+
+#define	CHECK_HANDLE(H)	assert(H);assert(H->Signature == POSIXFILE_SIGNATURE);
+#define	CHECK_FINDER(F)	assert(F);assert(F->Signature == POSIXFINDER_SIGNATURE);
+
+// Smaller files are cheaper to read() than to map
+#define	FSPOSIX_MMAP_MIN		(64*1024)
+
+// Seconds between the FILETIME epoch (1601) and the unix epoch, so jeVFile_Time
+// means the same thing it does under FSDos
+#define	FSPOSIX_FILETIME_EPOCH	11644473600ULL
+
+typedef struct	PosixFile
+{
+	unsigned int	Signature;
+	int				Fd;
+	char *			FullPath;
+	const char *	Name;
+	jeBoolean		IsDirectory;
+	unsigned int	OpenFlags;
+	jeBoolean		CanSetHints;
+	jeVFile *		HintsFile;
+	long			TrueFileBase;
+
+	// Read-only files above FSPOSIX_MMAP_MIN; Position replaces the fd offset
+	const uint8 *	Map;
+	long			MapSize;
+	long			Position;
+}	PosixFile;
+
+typedef	struct	PosixFinder
+{
+	unsigned int	Signature;
+	DIR *			Dir;
+	char			DirPath[PATH_MAX];
+	char			Pattern[PATH_MAX];
+	char			Name[256];
+	struct stat		Stat;
+	jeBoolean		HaveEntry;
+}	PosixFinder;
+
+/*}{ ******* Paths *******/
+
+static	jeBoolean	BuildFileName(
+	const PosixFile *	File,
+	const char *		Name,
+	char *				Buff,
+	char **				NamePtr,
+	int 				MaxLen)
+{
+	int		DirLength;
+	int		NameLength;
+	char *	p;
+
+	if ( ! Name || ! Buff )
+		return JE_FALSE;
+
+	if	(File)
+	{
+		if	(File->IsDirectory == JE_FALSE)
+			return JE_FALSE;
+
+		assert(File->FullPath);
+		DirLength = strlen(File->FullPath);
+
+		if	(DirLength > MaxLen)
+			return JE_FALSE;
+
+		memcpy(Buff, File->FullPath, DirLength);
+	}
+	else
+	{
+		DirLength = 0;
+	}
+
+	NameLength = strlen(Name);
+	if ( DirLength + NameLength + 2 > MaxLen )
+		return JE_FALSE;
+
+	if ( DirLength > 0 && Buff[DirLength-1] != '/' )
+	{
+		Buff[DirLength] = '/';
+		DirLength++;
+	}
+	memcpy(Buff + DirLength, Name, NameLength + 1);
+
+	// Content paths are written with DOS separators
+	for	(p = Buff + DirLength; *p; p++)
+	{
+		if	(*p == '\\')
+			*p = '/';
+	}
+
+	// Special case: no directory, no file name.  We meant "."
+	if	(!*Buff)
+	{
+		strcpy(Buff, ".");
+		DirLength = 0;
+	}
+
+	if	(NamePtr)
+		*NamePtr = Buff + DirLength;
+
+	NameLength = strlen(Buff);
+	assert( NameLength > 0 );
+	if ( NameLength > 1 && Buff[NameLength-1] == '/' )
+		Buff[NameLength-1] = 0;
+
+	return JE_TRUE;
+}
+
+//	Fixes up the case of every component of Path that exists on disk under a
+//	different case.  Only the case changes, so this works in place.  Components
+//	that don't exist in any case (a file about to be created) are left alone.
+static	void	ResolvePath(char *Path)
+{
+	struct stat		Info;
+	char *			Component;
+	char *			End;
+	char			Save;
+
+	if	(stat(Path, &Info) == 0)
+		return;
+
+	Component = Path;
+	if	(*Component == '/')
+		Component++;
+
+	while	(*Component)
+	{
+		End = strchr(Component, '/');
+		if	(!End)
+			End = Component + strlen(Component);
+
+		Save = *End;
+		*End = '\0';
+
+		if	(stat(Path, &Info) != 0)
+		{
+			DIR *			Dir;
+			struct dirent *	Entry;
+			jeBoolean		Found;
+			const char *	Parent;
+
+			if	(Component == Path)
+				Parent = ".";
+			else if	(Component == Path + 1)
+				Parent = "/";
+			else
+			{
+				Component[-1] = '\0';
+				Parent = Path;
+			}
+
+			Found = JE_FALSE;
+			Dir = opendir(Parent);
+
+			if	(Component > Path + 1)
+				Component[-1] = '/';
+
+			if	(Dir)
+			{
+				while	((Entry = readdir(Dir)) != NULL)
+				{
+					if	(strcasecmp(Entry->d_name, Component) == 0)
+					{
+						memcpy(Component, Entry->d_name, End - Component);
+						Found = JE_TRUE;
+						break;
+					}
+				}
+				closedir(Dir);
+			}
+
+			if	(Found == JE_FALSE)
+			{
+				*End = Save;
+				return;
+			}
+		}
+
+		*End = Save;
+		if	(!Save)
+			break;
+		Component = End + 1;
+	}
+}
+
+static	void	StatToTime(const struct stat *Info, jeVFile_Time *Time)
+{
+	unsigned long long	FileTime;
+
+	FileTime = ((unsigned long long)Info->st_mtime + FSPOSIX_FILETIME_EPOCH) * 10000000ULL;
+
+	Time->Time1 = (unsigned long)(FileTime & 0xffffffffUL);
+	Time->Time2 = (unsigned long)(FileTime >> 32);
+}
+
+static	void	StatToProperties(const struct stat *Info, jeVFile_Properties *Props)
+{
+	jeVFile_Attributes	Attribs;
+
+	Attribs = 0;
+	if	(S_ISDIR(Info->st_mode))
+		Attribs |= JE_VFILE_ATTRIB_DIRECTORY;
+	if	(!(Info->st_mode & S_IWUSR))
+		Attribs |= JE_VFILE_ATTRIB_READONLY;
+
+	StatToTime(Info, &Props->Time);
+
+	Props->AttributeFlags = Attribs;
+	Props->Size = (long)Info->st_size;
+}
+
+/*}{ ******* Raw I/O *******/
+
+//	These work on absolute file offsets; the APIs below add and remove
+//	TrueFileBase themselves, like FSDos does.
+
+static	long	PosixFile_GetPos(const PosixFile *File)
+{
+	if	(File->Map)
+		return File->Position;
+
+	return (long)lseek(File->Fd, 0, SEEK_CUR);
+}
+
+static	jeBoolean	PosixFile_SetPos(PosixFile *File, long Position)
+{
+	if	(Position < 0)
+		return JE_FALSE;
+
+	if	(File->Map)
+	{
+		File->Position = Position;
+		return JE_TRUE;
+	}
+
+	if	(lseek(File->Fd, (off_t)Position, SEEK_SET) == (off_t)-1)
+		return JE_FALSE;
+
+	return JE_TRUE;
+}
+
+static	long	PosixFile_GetEnd(const PosixFile *File)
+{
+	struct stat		Info;
+
+	if	(File->Map)
+		return File->MapSize;
+
+	if	(fstat(File->Fd, &Info) != 0)
+		return -1;
+
+	return (long)Info.st_size;
+}
+
+static	long	PosixFile_ReadBytes(PosixFile *File, void *Buff, long Count)
+{
+	long	Total;
+
+	if	(File->Map)
+	{
+		if	(File->Position >= File->MapSize)
+			return 0;
+
+		if	(Count > File->MapSize - File->Position)
+			Count = File->MapSize - File->Position;
+
+		memcpy(Buff, File->Map + File->Position, Count);
+		File->Position += Count;
+		return Count;
+	}
+
+	Total = 0;
+	while	(Total < Count)
+	{
+		ssize_t		Got;
+
+		Got = read(File->Fd, (char *)Buff + Total, Count - Total);
+		if	(Got < 0)
+		{
+			if	(errno == EINTR)
+				continue;
+			return Total ? Total : -1;
+		}
+		if	(Got == 0)
+			break;
+
+		Total += (long)Got;
+	}
+
+	return Total;
+}
+
+//	Like PosixFile_ReadBytes, but at an absolute Position and without touching
+//	the fd offset or File->Position, so any number of threads may call it.
+static	long	PosixFile_ReadBytesAt(const PosixFile *File, long Position, void *Buff, long Count)
+{
+	long	Total;
+
+	if	(File->Map)
+	{
+		if	(Position >= File->MapSize)
+			return 0;
+
+		if	(Count > File->MapSize - Position)
+			Count = File->MapSize - Position;
+
+		memcpy(Buff, File->Map + Position, Count);
+		return Count;
+	}
+
+	Total = 0;
+	while	(Total < Count)
+	{
+		ssize_t		Got;
+
+		Got = pread(File->Fd, (char *)Buff + Total, Count - Total, (off_t)Position + Total);
+		if	(Got < 0)
+		{
+			if	(errno == EINTR)
+				continue;
+			return Total ? Total : -1;
+		}
+		if	(Got == 0)
+			break;
+
+		Total += (long)Got;
+	}
+
+	return Total;
+}
+
+static	jeBoolean	PosixFile_WriteBytes(int Fd, const void *Buff, long Count)
+{
+	long	Total;
+
+	Total = 0;
+	while	(Total < Count)
+	{
+		ssize_t		Put;
+
+		Put = write(Fd, (const char *)Buff + Total, Count - Total);
+		if	(Put < 0)
+		{
+			if	(errno == EINTR)
+				continue;
+			return JE_FALSE;
+		}
+
+		Total += (long)Put;
+	}
+
+	return JE_TRUE;
+}
+
+static	void	PosixFile_TryMap(PosixFile *File)
+{
+	struct stat		Info;
+	void *			Map;
+
+	if	(fstat(File->Fd, &Info) != 0 || !S_ISREG(Info.st_mode))
+		return;
+
+	if	(Info.st_size < FSPOSIX_MMAP_MIN || (off_t)(long)Info.st_size != Info.st_size)
+		return;
+
+	Map = mmap(NULL, (size_t)Info.st_size, PROT_READ, MAP_PRIVATE, File->Fd, 0);
+	if	(Map == MAP_FAILED)
+		return;		// Fall back to read()
+
+#ifdef POSIX_MADV_SEQUENTIAL
+	// Worlds and actors are mostly read front to back
+	posix_madvise(Map, (size_t)Info.st_size, POSIX_MADV_SEQUENTIAL);
+#endif
+
+	File->Map = (const uint8 *)Map;
+	File->MapSize = (long)Info.st_size;
+	File->Position = 0;
+}
+
+/*}{ ******* Finder *******/
+
+static	void *	JETCC FSPosix_FinderCreate(
+	jeVFile *		FS,
+	void *			Handle,
+	const char *	FileSpec)
+{
+	PosixFinder *	Finder;
+	PosixFile *		File;
+	char *			NamePtr;
+	char *			Slash;
+	char			Buff[PATH_MAX];
+
+	(void)FS;
+
+	assert(FileSpec != NULL);
+
+	File = (PosixFile *)Handle;
+
+	CHECK_HANDLE(File);
+
+	Finder = (PosixFinder *)jeRam_Allocate(sizeof(*Finder));
+	if	(!Finder)
+		return NULL;
+
+	memset(Finder, 0, sizeof(*Finder));
+
+	if	(BuildFileName(File, FileSpec, Buff, &NamePtr, sizeof(Buff)) == JE_FALSE)
+	{
+		jeRam_Free(Finder);
+		return NULL;
+	}
+
+	// Split into a directory and a wildcard pattern
+	Slash = strrchr(Buff, '/');
+	if	(Slash)
+	{
+		*Slash = '\0';
+		strcpy(Finder->DirPath, Slash == Buff ? "/" : Buff);
+		strcpy(Finder->Pattern, Slash + 1);
+	}
+	else
+	{
+		strcpy(Finder->DirPath, ".");
+		strcpy(Finder->Pattern, Buff);
+	}
+
+	// Win32 "*.*" also matches names without an extension
+	if	(strcmp(Finder->Pattern, "*.*") == 0)
+		strcpy(Finder->Pattern, "*");
+
+	ResolvePath(Finder->DirPath);
+
+	// A missing directory is an empty search, not a failure, as with FindFirstFile
+	Finder->Dir = opendir(Finder->DirPath);
+
+	Finder->Signature = POSIXFINDER_SIGNATURE;
+	return (void *)Finder;
+}
+
+static	jeBoolean	JETCC FSPosix_FinderGetNextFile(void *Handle)
+{
+	PosixFinder *		Finder;
+	struct dirent *		Entry;
+	char				Path[PATH_MAX];
+
+	Finder = (PosixFinder *)Handle;
+
+	CHECK_FINDER(Finder);
+
+	Finder->HaveEntry = JE_FALSE;
+
+	if	(!Finder->Dir)
+		return JE_FALSE;
+
+	while	((Entry = readdir(Finder->Dir)) != NULL)
+	{
+		if	(Entry->d_name[0] == '.')
+			continue;
+
+		if	(fnmatch(Finder->Pattern, Entry->d_name, FNM_CASEFOLD) != 0)
+			continue;
+
+		if	(strlen(Entry->d_name) >= sizeof(Finder->Name))
+			continue;
+
+		if	(snprintf(Path, sizeof(Path), "%s/%s", Finder->DirPath, Entry->d_name) >= (int)sizeof(Path))
+			continue;
+
+		if	(stat(Path, &Finder->Stat) != 0)
+			continue;
+
+		strcpy(Finder->Name, Entry->d_name);
+		Finder->HaveEntry = JE_TRUE;
+		return JE_TRUE;
+	}
+
+	return JE_FALSE;
+}
+
+static	jeBoolean	JETCC FSPosix_FinderGetProperties(void *Handle, jeVFile_Properties *Props)
+{
+	PosixFinder *	Finder;
+	int				Length;
+
+	assert(Props);
+
+	Finder = (PosixFinder *)Handle;
+
+	CHECK_FINDER(Finder);
+
+	if	(Finder->HaveEntry == JE_FALSE)
+		return JE_FALSE;
+
+	StatToProperties(&Finder->Stat, Props);
+
+	Length = strlen(Finder->Name);
+	if	(Length > (int)sizeof(Props->Name) - 1)
+		return JE_FALSE;
+	memcpy(Props->Name, Finder->Name, Length + 1);
+
+	return JE_TRUE;
+}
+
+static	void JETCC FSPosix_FinderDestroy(void *Handle)
+{
+	PosixFinder *	Finder;
+
+	Finder = (PosixFinder *)Handle;
+
+	CHECK_FINDER(Finder);
+
+	if	(Finder->Dir)
+		closedir(Finder->Dir);
+
+	Finder->Signature = 0;
+	jeRam_Free(Finder);
+}
+
+/*}{ ******* Open / Close *******/
+
+static	void *	JETCC FSPosix_Open(
+	jeVFile *		FS,
+	void *			Handle,
+	const char *	Name,
+	void *			Context,
+	unsigned int 	OpenModeFlags)
+{
+	PosixFile *	PosixFS;
+	PosixFile *	NewFile;
+	char		Buff[PATH_MAX];
+	int			Length;
+	char *		NamePtr;
+
+	(void)FS;
+	(void)Context;
+
+	PosixFS = (PosixFile *)Handle;
+
+	if	(PosixFS && PosixFS->IsDirectory != JE_TRUE)
+		return NULL;
+
+	NewFile = (PosixFile *)jeRam_Allocate(sizeof(*NewFile));
+	if	(!NewFile)
+		return NewFile;
+
+	memset(NewFile, 0, sizeof(*NewFile));
+	NewFile->Fd = -1;
+
+	if	(BuildFileName(PosixFS, Name, Buff, &NamePtr, sizeof(Buff)) == JE_FALSE)
+		goto fail;
+
+	ResolvePath(Buff);
+
+	Length = strlen(Buff);
+	NewFile->FullPath = (char *)jeRam_Allocate(Length + 1);
+	if	(!NewFile->FullPath)
+		goto fail;
+
+	NewFile->Name = NewFile->FullPath + (NamePtr - &Buff[0]);
+
+	memcpy(NewFile->FullPath, Buff, Length + 1);
+
+	if	(OpenModeFlags & JE_VFILE_OPEN_DIRECTORY)
+	{
+		struct stat		Info;
+		jeBoolean		IsDirectory;
+
+		assert(!PosixFS || PosixFS->IsDirectory == JE_TRUE);
+
+		IsDirectory = (stat(NewFile->FullPath, &Info) == 0 && S_ISDIR(Info.st_mode)) ? JE_TRUE : JE_FALSE;
+
+		if	(OpenModeFlags & JE_VFILE_OPEN_CREATE)
+		{
+			if	( ! IsDirectory )
+				if	(mkdir(NewFile->FullPath, 0777) != 0)
+					goto fail;
+		}
+		else
+		{
+			if	(IsDirectory != JE_TRUE)
+				goto fail;
+		}
+
+		NewFile->IsDirectory = JE_TRUE;
+	}
+	else
+	{
+		int		Flags = O_RDONLY;
+
+		switch	(OpenModeFlags & (JE_VFILE_OPEN_READONLY |
+								  JE_VFILE_OPEN_UPDATE	 |
+								  JE_VFILE_OPEN_CREATE))
+		{
+		case	JE_VFILE_OPEN_READONLY:
+			Flags = O_RDONLY;
+			break;
+
+		case	JE_VFILE_OPEN_CREATE:
+			Flags = O_RDWR | O_CREAT | O_TRUNC;
+			break;
+
+		case	JE_VFILE_OPEN_UPDATE:
+			Flags = O_RDWR;
+			break;
+
+		default:
+			assert(!"Illegal open mode flags");
+			break;
+		}
+
+		NewFile->Fd = open(NewFile->FullPath, Flags | O_CLOEXEC, 0666);
+		if	(NewFile->Fd < 0)
+			goto fail;
+
+		if	(OpenModeFlags & JE_VFILE_OPEN_READONLY)
+			PosixFile_TryMap(NewFile);
+
+		/*
+			Now we have to go looking in the file to see if it has hint data
+			that we need to encapsulate.
+		*/
+		if	( (OpenModeFlags & (JE_VFILE_OPEN_READONLY | JE_VFILE_OPEN_UPDATE)) &&
+			 !(OpenModeFlags & (JE_VFILE_OPEN_RAW)))
+		{
+			jeVFile_HintsFileHeader	HintsHeader;
+
+			if	(PosixFile_ReadBytes(NewFile, &HintsHeader, sizeof(HintsHeader)) == sizeof(HintsHeader) &&
+				 HintsHeader.Signature == JE_VFILE_HINTSFILEHEADER_SIGNATURE)
+			{
+				/*
+					Same as FSDos: pull the hint data into a memory file, and hide it
+					from the client by offsetting every position by TrueFileBase.
+				*/
+				jeVFile_MemoryContext	MemoryContext;
+
+				MemoryContext.Data = NULL;
+				MemoryContext.DataLength = 0;
+				NewFile->HintsFile = jeVFile_OpenNewSystem(NULL,
+														   JE_VFILE_TYPE_MEMORY,
+														   NULL,
+														   &MemoryContext,
+														   JE_VFILE_OPEN_CREATE);
+				if	(!NewFile->HintsFile)
+					goto fail;
+
+				if	(jeVFile_Seek(NewFile->HintsFile, HintsHeader.HintDataLength, JE_VFILE_SEEKSET) == JE_FALSE)
+					goto fail;
+
+				jeVFile_UpdateContext(NewFile->HintsFile, &MemoryContext, sizeof(MemoryContext));
+				if	(PosixFile_ReadBytes(NewFile, MemoryContext.Data, HintsHeader.HintDataLength) != (long)HintsHeader.HintDataLength)
+					goto fail;
+
+				jeVFile_Seek(NewFile->HintsFile, 0, JE_VFILE_SEEKSET);
+				NewFile->TrueFileBase = PosixFile_GetPos(NewFile);
+			}
+			else
+			{
+				if	(PosixFile_SetPos(NewFile, 0) == JE_FALSE)
+					goto fail;
+				NewFile->CanSetHints = JE_TRUE;
+			}
+		}
+		else
+		{
+			NewFile->CanSetHints = JE_TRUE;
+		}
+	}
+
+	NewFile->OpenFlags = OpenModeFlags;
+	NewFile->Signature = POSIXFILE_SIGNATURE;
+
+	return (void *)NewFile;
+
+fail:
+	if	(NewFile->HintsFile)
+		jeVFile_Close(NewFile->HintsFile);
+	if	(NewFile->Map)
+		munmap((void *)NewFile->Map, (size_t)NewFile->MapSize);
+	if	(NewFile->Fd >= 0)
+		close(NewFile->Fd);
+	if	(NewFile->FullPath)
+		jeRam_Free(NewFile->FullPath);
+	jeRam_Free(NewFile);
+	return NULL;
+}
+
+static	void *	JETCC FSPosix_OpenNewSystem(
+	jeVFile *		FS,
+	const char *	Name,
+	void *			Context,
+	unsigned int 	OpenModeFlags)
+{
+	return FSPosix_Open(FS, NULL, Name, Context, OpenModeFlags);
+}
+
+static	jeBoolean	JETCC FSPosix_UpdateContext(
+	jeVFile *		FS,
+	void *			Handle,
+	void *			Context,
+	int 			ContextSize)
+{
+	(void)FS;
+	(void)Handle;
+	(void)Context;
+	(void)ContextSize;
+
+	return JE_FALSE;
+}
+
+static	jeBoolean	JETCC FSPosix_Close(void *Handle)
+{
+	jeBoolean	Result;
+	PosixFile *	File;
+
+	File = (PosixFile *)Handle;
+
+	CHECK_HANDLE(File);
+
+	Result = JE_TRUE;
+	if	(File->IsDirectory == JE_FALSE)
+	{
+		assert(File->Fd >= 0);
+
+		if	(File->HintsFile && (File->CanSetHints == JE_TRUE))
+		{
+			void *	CopyBuff;
+			long	FileSize;
+
+			/*
+				As in FSDos: slide the whole file down and write the hints
+				header and data in front of it.
+			*/
+			FileSize = PosixFile_GetEnd(File);
+			CopyBuff = FileSize > 0 ? jeRam_Allocate(FileSize) : NULL;
+			if	(CopyBuff)
+			{
+				Result = JE_FALSE;
+				PosixFile_SetPos(File, 0);
+				if	(PosixFile_ReadBytes(File, CopyBuff, FileSize) == FileSize)
+				{
+					jeVFile_MemoryContext	MemoryContext;
+					jeVFile_HintsFileHeader	HintsHeader;
+
+					PosixFile_SetPos(File, 0);
+					jeVFile_UpdateContext(File->HintsFile, &MemoryContext, sizeof(MemoryContext));
+					HintsHeader.Signature = JE_VFILE_HINTSFILEHEADER_SIGNATURE;
+					HintsHeader.HintDataLength = MemoryContext.DataLength;
+
+					if	(PosixFile_WriteBytes(File->Fd, &HintsHeader, sizeof(HintsHeader)) &&
+						 PosixFile_WriteBytes(File->Fd, MemoryContext.Data, MemoryContext.DataLength) &&
+						 PosixFile_WriteBytes(File->Fd, CopyBuff, FileSize))
+					{
+						// That was it, we made it!
+						Result = JE_TRUE;
+					}
+				}
+
+				jeRam_Free(CopyBuff);
+			}
+		}
+
+		if	(File->HintsFile)
+			jeVFile_Close(File->HintsFile);
+
+		if	(File->Map)
+			munmap((void *)File->Map, (size_t)File->MapSize);
+
+		close(File->Fd);
+	}
+
+	assert(File->FullPath);
+	File->Signature = 0;
+
+	jeRam_Free(File->FullPath);
+	jeRam_Free(File);
+
+	return Result;
+}
+
+/*}{ ******* Reading and writing *******/
+
+static	jeBoolean	JETCC FSPosix_GetS(void *Handle, void *Buff, int MaxLen)
+{
+	PosixFile *	File;
+	long		Start;
+	long		BytesRead;
+	char *		p;
+	char *		End;
+
+	assert(Buff);
+	assert(MaxLen != 0);
+
+	File = (PosixFile *)Handle;
+
+	CHECK_HANDLE(File);
+
+	if	(File->IsDirectory == JE_TRUE)
+		return JE_FALSE;
+
+	Start = PosixFile_GetPos(File);
+	BytesRead = PosixFile_ReadBytes(File, Buff, MaxLen - 1);
+	if	(BytesRead <= 0)
+		return JE_FALSE;
+
+	End = (char *)Buff + BytesRead;
+	p = (char *)Buff;
+	while	(p < End)
+	{
+		/*
+		  Same line endings as FSDos_GetS:
+			\r	Character changed to \n, next char set to 0
+			\n	Next char set to 0
+			\r\n	First \r changed to \n.  \n changed to 0.
+		*/
+		if	(*p == '\r')
+		{
+			int Skip = 0;
+
+			*p = '\n';
+			p++;
+			if	(p < End && *p == '\n')
+				Skip = 1;
+			*p = '\0';
+			PosixFile_SetPos(File, Start + (long)((p + Skip) - (char *)Buff));
+			return JE_TRUE;
+		}
+		else if	(*p == '\n')
+		{
+			p++;
+			PosixFile_SetPos(File, Start + (long)(p - (char *)Buff));
+			*p = '\0';
+			return JE_TRUE;
+		}
+		p++;
+	}
+
+	return JE_FALSE;
+}
+
+static	jeBoolean	JETCC FSPosix_Tell(const void *Handle, long *Position)
+{
+	const PosixFile *	File;
+
+	File = (const PosixFile *)Handle;
+
+	CHECK_HANDLE(File);
+
+	if	(File->IsDirectory == JE_TRUE)
+		return JE_FALSE;
+
+	*Position = PosixFile_GetPos(File);
+	if	(*Position == -1L)
+		return JE_FALSE;
+
+	*Position -= File->TrueFileBase;
+
+	return JE_TRUE;
+}
+
+static	jeBoolean	JETCC FSPosix_BytesAvailable(void *Handle, long *Count)
+{
+	PosixFile *	File;
+	long		CurrentPos;
+	long		EndPos;
+
+	File = (PosixFile *)Handle;
+
+	CHECK_HANDLE(File);
+
+	assert(Count);
+
+	if	(File->IsDirectory == JE_TRUE)
+		return JE_FALSE;
+
+	CurrentPos = PosixFile_GetPos(File);
+	EndPos = PosixFile_GetEnd(File);
+	if	(CurrentPos == -1L || EndPos == -1L)
+		return JE_FALSE;
+
+	*Count = EndPos - CurrentPos;
+
+	return JE_TRUE;
+}
+
+static	jeBoolean	JETCC FSPosix_Read(void *Handle, void *Buff, uint32 Count)
+{
+	PosixFile *	File;
+
+	assert(Buff);
+	assert(Count != 0);
+
+	File = (PosixFile *)Handle;
+
+	CHECK_HANDLE(File);
+
+	if	(File->IsDirectory == JE_TRUE)
+		return JE_FALSE;
+
+	if	(PosixFile_ReadBytes(File, Buff, (long)Count) != (long)Count)
+		return JE_FALSE;
+
+	return JE_TRUE;
+}
+
+static	jeBoolean	JETCC FSPosix_ReadAt(void *Handle, long Offset, void *Buff, uint32 Count)
+{
+	PosixFile *	File;
+
+	assert(Buff);
+	assert(Count != 0);
+
+	File = (PosixFile *)Handle;
+
+	CHECK_HANDLE(File);
+
+	if	(File->IsDirectory == JE_TRUE || Offset < 0)
+		return JE_FALSE;
+
+	if	(PosixFile_ReadBytesAt(File, Offset + File->TrueFileBase, Buff, (long)Count) != (long)Count)
+		return JE_FALSE;
+
+	return JE_TRUE;
+}
+
+static	jeBoolean	JETCC FSPosix_Write(void *Handle, const void *Buff, int Count)
+{
+	PosixFile *	File;
+
+	assert(Buff);
+	assert(Count != 0);
+
+	File = (PosixFile *)Handle;
+
+	CHECK_HANDLE(File);
+
+	if	(File->IsDirectory == JE_TRUE || File->Map)
+		return JE_FALSE;
+
+	return PosixFile_WriteBytes(File->Fd, Buff, Count);
+}
+
+static	jeBoolean	JETCC FSPosix_Seek(void *Handle, int Where, jeVFile_Whence Whence)
+{
+	PosixFile *	File;
+	long		Position;
+
+	File = (PosixFile *)Handle;
+
+	CHECK_HANDLE(File);
+
+	if	(File->IsDirectory == JE_TRUE)
+		return JE_FALSE;
+
+	switch	(Whence)
+	{
+	case	JE_VFILE_SEEKCUR:
+		Position = PosixFile_GetPos(File);
+		break;
+
+	case	JE_VFILE_SEEKEND:
+		Position = PosixFile_GetEnd(File);
+		break;
+
+	case	JE_VFILE_SEEKSET:
+		Position = File->TrueFileBase;
+		break;
+
+	default:
+		assert(!"Unknown seek kind");
+		return JE_FALSE;
+	}
+
+	if	(Position == -1L)
+		return JE_FALSE;
+
+	return PosixFile_SetPos(File, Position + Where);
+}
+
+static	jeBoolean	JETCC FSPosix_EOF(const void *Handle)
+{
+	const PosixFile *	File;
+
+	File = (const PosixFile *)Handle;
+
+	CHECK_HANDLE(File);
+
+	if	(File->IsDirectory == JE_TRUE)
+		return JE_FALSE;
+
+	if	(PosixFile_GetPos(File) == PosixFile_GetEnd(File))
+		return JE_TRUE;
+
+	return JE_FALSE;
+}
+
+static	jeBoolean	JETCC FSPosix_Size(const void *Handle, long *Size)
+{
+	const PosixFile *	File;
+
+	File = (const PosixFile *)Handle;
+
+	CHECK_HANDLE(File);
+
+	if	(File->IsDirectory == JE_TRUE)
+		return JE_FALSE;
+
+	*Size = PosixFile_GetEnd(File);
+	if	(*Size == -1L)
+		return JE_FALSE;
+
+	*Size -= File->TrueFileBase;
+
+	return JE_TRUE;
+}
+
+/*}{ ******* Properties *******/
+
+static	jeBoolean	JETCC FSPosix_GetProperties(const void *Handle, jeVFile_Properties *Properties)
+{
+	const PosixFile *	File;
+	struct stat			Info;
+	int					Length;
+
+	assert(Properties);
+
+	File = (const PosixFile *)Handle;
+
+	CHECK_HANDLE(File);
+
+	memset(Properties, 0, sizeof(*Properties));
+
+	if	(File->IsDirectory == JE_TRUE)
+	{
+		Properties->AttributeFlags = JE_VFILE_ATTRIB_DIRECTORY;
+		if	(stat(File->FullPath, &Info) == 0)
+			StatToTime(&Info, &Properties->Time);
+	}
+	else
+	{
+		if	(fstat(File->Fd, &Info) != 0)
+			return JE_FALSE;
+
+		StatToProperties(&Info, Properties);
+	}
+
+	Length = strlen(File->Name) + 1;
+	if	(Length > (int)sizeof(Properties->Name))
+		return JE_FALSE;
+	memcpy(Properties->Name, File->Name, Length);
+
+	return JE_TRUE;
+}
+
+static	jeBoolean	JETCC FSPosix_SetSize(void *Handle, long Size)
+{
+	PosixFile *	File;
+
+	File = (PosixFile *)Handle;
+
+	CHECK_HANDLE(File);
+
+	if	(File->IsDirectory == JE_TRUE || File->Map)
+		return JE_FALSE;
+
+	if	(ftruncate(File->Fd, (off_t)(Size + File->TrueFileBase)) != 0)
+		return JE_FALSE;
+
+	return JE_TRUE;
+}
+
+static	jeBoolean	JETCC FSPosix_SetAttributes(void *Handle, jeVFile_Attributes Attributes)
+{
+	PosixFile *		File;
+	struct stat		Info;
+	mode_t			Mode;
+
+	File = (PosixFile *)Handle;
+
+	CHECK_HANDLE(File);
+
+	if	(File->IsDirectory == JE_TRUE)
+		return JE_FALSE;
+
+	if	(fstat(File->Fd, &Info) != 0)
+		return JE_FALSE;
+
+	Mode = Info.st_mode & 07777;
+	if	(Attributes & JE_VFILE_ATTRIB_READONLY)
+		Mode &= ~(S_IWUSR | S_IWGRP | S_IWOTH);
+	else
+		Mode |= S_IWUSR;
+
+	if	(fchmod(File->Fd, Mode) != 0)
+		return JE_FALSE;
+
+	return JE_TRUE;
+}
+
+static	jeBoolean	JETCC FSPosix_SetTime(void *Handle, const jeVFile_Time *Time)
+{
+	PosixFile *			File;
+	unsigned long long	FileTime;
+	struct timeval		Times[2];
+
+	File = (PosixFile *)Handle;
+
+	CHECK_HANDLE(File);
+
+	FileTime = ((unsigned long long)(Time->Time2 & 0xffffffffUL) << 32) | (Time->Time1 & 0xffffffffUL);
+	if	(FileTime < FSPOSIX_FILETIME_EPOCH * 10000000ULL)
+		return JE_FALSE;
+
+	FileTime -= FSPOSIX_FILETIME_EPOCH * 10000000ULL;
+
+	Times[0].tv_sec  = (time_t)(FileTime / 10000000ULL);
+	Times[0].tv_usec = (suseconds_t)((FileTime % 10000000ULL) / 10ULL);
+	Times[1] = Times[0];
+
+	if	(utimes(File->FullPath, Times) != 0)
+		return JE_FALSE;
+
+	return JE_TRUE;
+}
+
+static	jeVFile *	JETCC FSPosix_GetHintsFile(void *Handle)
+{
+	PosixFile *	File;
+
+	File = (PosixFile *)Handle;
+
+	CHECK_HANDLE(File);
+
+	if	(File->OpenFlags & JE_VFILE_OPEN_RAW)
+		return NULL;
+
+	if	(!File->HintsFile)
+	{
+		jeVFile_MemoryContext	Context;
+
+		// Can't create hints on a readonly file
+		if	(File->OpenFlags & JE_VFILE_OPEN_READONLY)
+			return NULL;
+
+		Context.Data = NULL;
+		Context.DataLength = 0;
+		File->HintsFile = jeVFile_OpenNewSystem(NULL,
+												JE_VFILE_TYPE_MEMORY,
+												NULL,
+												&Context,
+												JE_VFILE_OPEN_CREATE);
+	}
+
+	return File->HintsFile;
+}
+
+/*}{ ******* Directory operations *******/
+
+static	jeBoolean	JETCC FSPosix_FileExists(jeVFile *FS, void *Handle, const char *Name)
+{
+	PosixFile *		File;
+	struct stat		Info;
+	char			Buff[PATH_MAX];
+
+	(void)FS;
+
+	File = (PosixFile *)Handle;
+
+	if	(File && File->IsDirectory == JE_FALSE)
+		return JE_FALSE;
+
+	if	(BuildFileName(File, Name, Buff, NULL, sizeof(Buff)) == JE_FALSE)
+		return JE_FALSE;
+
+	ResolvePath(Buff);
+
+	if	(stat(Buff, &Info) != 0)
+		return JE_FALSE;
+
+	return JE_TRUE;
+}
+
+static	jeBoolean	JETCC FSPosix_Disperse(
+	jeVFile *	FS,
+	void *		Handle,
+	const char *Directory)
+{
+	(void)FS;
+	(void)Handle;
+	(void)Directory;
+
+	return JE_FALSE;
+}
+
+static	jeBoolean	JETCC FSPosix_DeleteFile(jeVFile *FS, void *Handle, const char *Name)
+{
+	PosixFile *	File;
+	char		Buff[PATH_MAX];
+
+	(void)FS;
+
+	File = (PosixFile *)Handle;
+
+	if	(File && File->IsDirectory == JE_FALSE)
+		return JE_FALSE;
+
+	if	(BuildFileName(File, Name, Buff, NULL, sizeof(Buff)) == JE_FALSE)
+		return JE_FALSE;
+
+	ResolvePath(Buff);
+
+	if	(unlink(Buff) != 0)
+		return JE_FALSE;
+
+	return JE_TRUE;
+}
+
+static	jeBoolean	JETCC FSPosix_RenameFile(jeVFile *FS, void *Handle, const char *Name, const char *NewName)
+{
+	PosixFile *	File;
+	char		Old[PATH_MAX];
+	char		New[PATH_MAX];
+
+	(void)FS;
+
+	File = (PosixFile *)Handle;
+
+	if	(File && File->IsDirectory == JE_FALSE)
+		return JE_FALSE;
+
+	if	(BuildFileName(File, Name, Old, NULL, sizeof(Old)) == JE_FALSE)
+		return JE_FALSE;
+
+	if	(BuildFileName(File, NewName, New, NULL, sizeof(New)) == JE_FALSE)
+		return JE_FALSE;
+
+	ResolvePath(Old);
+	ResolvePath(New);
+
+	// MoveFile doesn't replace an existing file, keep it that way
+	if	(access(New, F_OK) == 0)
+		return JE_FALSE;
+
+	if	(rename(Old, New) != 0)
+		return JE_FALSE;
+
+	return JE_TRUE;
+}
+
+static	jeVFile_SystemAPIs	FSPosix_APIs =
+{
+	FSPosix_FinderCreate,
+	FSPosix_FinderGetNextFile,
+	FSPosix_FinderGetProperties,
+	FSPosix_FinderDestroy,
+
+	FSPosix_OpenNewSystem,
+	FSPosix_UpdateContext,
+	FSPosix_Open,
+	FSPosix_DeleteFile,
+	FSPosix_RenameFile,
+	FSPosix_FileExists,
+	FSPosix_Disperse,
+	FSPosix_Close,
+
+	FSPosix_GetS,
+	FSPosix_BytesAvailable,
+	FSPosix_Read,
+	FSPosix_Write,
+	FSPosix_Seek,
+	FSPosix_EOF,
+	FSPosix_Tell,
+	FSPosix_Size,
+
+	FSPosix_GetProperties,
+
+	FSPosix_SetSize,
+	FSPosix_SetAttributes,
+	FSPosix_SetTime,
+
+	FSPosix_GetHintsFile,
+
+	FSPosix_ReadAt,
+};
+
+const jeVFile_SystemAPIs *JETCC FSPosix_GetAPIs(void)
+{
+	return &FSPosix_APIs;
+}
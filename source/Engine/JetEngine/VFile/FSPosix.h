@@ -0,0 +1,17 @@
+/****************************************************************************************/
+/*  FSPOSIX.H                                                                           */
+/*                                                                                      */
+/*  Author: Styx3D Modernization                                                        */
+/*  Description: POSIX disk file system interface                                       */
+/*                                                                                      */
+/*  The contents of this file are subject to the 0BSD License.                          */
+/*  See LICENSE file in the project root for full license information.                  */
+/*                                                                                      */
+/****************************************************************************************/
+#ifndef	FSPOSIX_H
+#define	FSPOSIX_H
+
+// Registered as JE_VFILE_TYPE_DOS on platforms without FSDos/FSBeOS
+const	jeVFile_SystemAPIs *JETCC FSPosix_GetAPIs(void);
+
+#endif
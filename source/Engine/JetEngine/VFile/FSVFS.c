@@ -685,12 +685,6 @@ jeVFile * Hack_VFS_File = NULL;
 static	jeBoolean	JETCC FSVFS_Read(void *Handle, void *Buff, uint32 Count)
 {
 	VFSFile *	File;
-	jeBoolean	Res;
-	long		CurPos;
-#ifndef	NDEBUG
-	int			CurRelPos;
-	uint32 A,B;
-#endif
 
 	assert(Buff);
 	assert(Count != 0);
@@ -719,58 +713,40 @@ static	jeBoolean	JETCC FSVFS_Read(void *Handle, void *Buff, uint32 Count)
 	assert(File->CurrentRelPos >= 0);
 	assert(File->CurrentRelPos <= File->Length);
 
-	jeVFile_Tell(File->RWOps,&CurPos);
-
-#ifdef _DEBUG
-{
-	long	RWOpsPos,AbsPos;
+	if	(ClampOperationSize(File, Count) != Count)
+		return JE_FALSE;
 
-	AbsPos = File->RWOpsStartPos + File->CurrentRelPos;
+	// Our position is purely logical; the RWOps file pointer is never moved, so
+	// files sharing one VFS image don't serialize on seeks.
+	if	(!jeVFile_ReadAt(File->RWOps, File->RWOpsStartPos + File->CurrentRelPos, Buff, Count))
+		return JE_FALSE;
 
-	jeVFile_Seek(File->RWOps, AbsPos, JE_VFILE_SEEKSET);
+	File->CurrentRelPos += Count;
 
-	CurRelPos = File->CurrentRelPos;
-	
-	assert(!File->Directory);
-	assert(File->CurrentRelPos >= 0);
-
-	jeVFile_Tell(File->RWOps, &RWOpsPos);
+	return JE_TRUE;
+}
 
-	assert( AbsPos == RWOpsPos );
+static	jeBoolean	JETCC FSVFS_ReadAt(void *Handle, long Offset, void *Buff, uint32 Count)
+{
+	VFSFile *	File;
 
-	File->CurrentRelPos = RWOpsPos - File->RWOpsStartPos;
-	if	(File->CurrentRelPos > File->Length)
-		File->Length = File->CurrentRelPos;
+	assert(Buff);
+	assert(Count != 0);
 
-	assert(CurRelPos == File->CurrentRelPos);
-}
-#endif
+	File = (VFSFile *)Handle;
 
-	if	(!ForceFilePos(File))
-		return JE_FALSE;
+	CHECK_HANDLE(File);
 
-	if	(ClampOperationSize(File, Count) != Count)
+	if	(File->Directory)
 		return JE_FALSE;
 
-#ifndef	NDEBUG
-	CurRelPos = File->CurrentRelPos;
-#endif
-#ifdef _DEBUG
-	jeVFile_Tell(File->RWOps,&A);
-#endif
-	Res = jeVFile_Read(File->RWOps, Buff, Count);
-#ifdef _DEBUG
-	jeVFile_Tell(File->RWOps,&B);
-#endif
-
-	assert( B == (A + Count) );
-
-	UpdateFilePos(File);
-	assert(File->CurrentRelPos - CurRelPos == (int32)Count);
+	if	(File->DispersedFile)
+		return jeVFile_ReadAt(File->DispersedFile, Offset, Buff, Count);
 
-	jeVFile_Seek(File->RWOps,CurPos,JE_VFILE_SEEKSET);
+	if	(Offset < 0 || Offset > File->Length || Count > (uint32)(File->Length - Offset))
+		return JE_FALSE;
 
-	return Res;
+	return jeVFile_ReadAt(File->RWOps, File->RWOpsStartPos + Offset, Buff, Count);
 }
 
 static	jeBoolean	JETCC FSVFS_Write(void *Handle, const void *Buff, int Count)
@@ -860,6 +836,16 @@ static	jeBoolean	JETCC FSVFS_Seek(void *Handle, int Where, jeVFile_Whence Whence
 	if	(AbsolutePos < File->RWOpsStartPos)
 		return JE_FALSE;
 
+	// Reads are positional, so a read-only file only needs its logical position
+	if	(File->OpenModeFlags & JE_VFILE_OPEN_READONLY)
+	{
+		if	(AbsolutePos - File->RWOpsStartPos > File->Length)
+			return JE_FALSE;
+
+		File->CurrentRelPos = AbsolutePos - File->RWOpsStartPos;
+		return JE_TRUE;
+	}
+
 	Res = jeVFile_Seek(File->RWOps, AbsolutePos, JE_VFILE_SEEKSET);
 
 	UpdateFilePos(File);
@@ -1437,6 +1423,8 @@ static	jeVFile_SystemAPIs	FSVFS_APIs =
 	FSVFS_HintsSize,
 #endif
 	FSVFS_GetHintsFile,
+
+	FSVFS_ReadAt,
 };
 
 const jeVFile_SystemAPIs * JETCC FSVFS_GetAPIs(void)
@@ -0,0 +1,1374 @@
+/****************************************************************************************/
+/*  FSZIP.C                                                                             */
+/*                                                                                      */
+/*  Author: Styx3D Modernization                                                        */
+/*  Description: Read-only zip/pk3 archive file system                                  */
+/*                                                                                      */
+/*  Opened like a VFS, on top of another file:                                          */
+/*                                                                                      */
+/*    jeVFile_OpenNewSystem(DosFile, JE_VFILE_TYPE_ZIP, NULL, NULL,                     */
+/*                          JE_VFILE_OPEN_READONLY | JE_VFILE_OPEN_DIRECTORY);          */
+/*                                                                                      */
+/*  The central directory is read once and indexed by a case-insensitive hash of the   */
+/*  full path, with parent/child links for finders.  Opening an entry is one seek and   */
+/*  one read of its data.  Deflated entries are decoded block by block into a buffer    */
+/*  the size of the file, and a jeParallel task keeps decoding FSZIP_READAHEAD bytes    */
+/*  past the furthest read while the caller works on what it has.                       */
+/*                                                                                      */
+/*  Stored and deflate only; no zip64, encryption or multi-disk archives.               */
+/*                                                                                      */
+/*  The contents of this file are subject to the 0BSD License.                          */
+/*  See LICENSE file in the project root for full license information.                  */
+/*                                                                                      */
+/****************************************************************************************/
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<assert.h>
+
+#include	"BaseType.h"
+#include	"Ram.h"
+#include	"Errorlog.h"
+#include	"jeParallel.h"
+
+#include	"VFile.h"
+#include	"VFile._h"
+
+#include	"FSZip.h"
+#include	"inflate.h"
+
+//	"ZF01"
+#define	ZIPFILE_SIGNATURE		0x3130465A
+
+//	"ZF02"
+#define	ZIPFINDER_SIGNATURE		0x3230465A
+
+#define	CHECK_HANDLE(H)	assert(H);assert(H->Signature == ZIPFILE_SIGNATURE);
+#define	CHECK_FINDER(F)	assert(F);assert(F->Signature == ZIPFINDER_SIGNATURE);
+
+#define	ZIP_EOCD_SIGNATURE		0x06054B50
+#define	ZIP_CENTRAL_SIGNATURE	0x02014B50
+#define	ZIP_LOCAL_SIGNATURE		0x04034B50
+
+#define	ZIP_EOCD_SIZE			22
+#define	ZIP_CENTRAL_SIZE		46
+#define	ZIP_LOCAL_SIZE			30
+#define	ZIP_MAX_COMMENT			0xFFFF
+
+#define	ZIP_METHOD_STORED		0
+#define	ZIP_METHOD_DEFLATE		8
+
+#define	ZIP_FLAG_ENCRYPTED		0x0001
+
+#define	ZIP_ROOT				0			// Entry index of the archive root
+#define	ZIP_NONE				(-1)
+
+#define	FSZIP_MAX_PATH			1024
+#define	FSZIP_READAHEAD			(64*1024)
+
+typedef struct	ZipEntry
+{
+	const char *	Name;					// Full path in the archive, not 0 terminated
+	int32			NameLength;
+	int32			BaseName;				// Offset of the last path component in Name
+	uint32			Hash;
+	int32			NextInBucket;
+
+	int32			Parent;
+	int32			FirstChild;
+	int32			LastChild;
+	int32			NextSibling;
+
+	jeBoolean		IsDirectory;
+	uint16			Method;
+	uint16			Flags;
+	uint16			DosTime;
+	uint16			DosDate;
+	uint32			CompSize;
+	uint32			Size;
+	uint32			LocalOffset;
+}	ZipEntry;
+
+typedef struct	ZipArchive
+{
+	jeVFile *			RWOps;				// The archive file, owned by VFile
+	long				Bias;				// Added to every offset in the central directory
+
+	jeParallel_Mutex *	Lock;				// Guards RefCount and seek+read pairs on RWOps
+	int32				RefCount;
+
+	uint8 *				Central;			// Central directory; entry names point in here
+	ZipEntry *			Entries;
+	int32				EntryCount;
+	int32				EntryCapacity;
+	int32 *				Buckets;
+	uint32				BucketMask;
+}	ZipArchive;
+
+typedef struct	ZipFile
+{
+	unsigned int		Signature;
+	ZipArchive *		Archive;
+	int32				Entry;
+	jeBoolean			IsDirectory;
+
+	uint8 *				Data;				// Size bytes, valid up to Available
+	uint32				Size;
+	uint32				Position;
+	uint32				Available;
+
+	// Deflated entries, until the stream is done.  Decoded, DecodeFailed and the
+	// decoder belong to the read-ahead task while one is queued on ReadAhead; the
+	// reader only looks at them after waiting, and copies Decoded to Available.
+	uint32				Decoded;
+	uint8 *				CompData;
+	inflateDecoder *	Decoder;
+	jeParallel_Group *	ReadAhead;
+	uint32				ReadAheadTo;
+	jeBoolean			DecodeFailed;
+}	ZipFile;
+
+typedef	struct	ZipFinder
+{
+	unsigned int		Signature;
+	ZipArchive *		Archive;
+	int32				Next;
+	int32				Current;
+	char				Pattern[FSZIP_MAX_PATH];
+}	ZipFinder;
+
+/*}{ ******* Names *******/
+
+static	uint32	Zip_Get16(const uint8 *p)
+{
+	return (uint32)p[0] | ((uint32)p[1] << 8);
+}
+
+static	uint32	Zip_Get32(const uint8 *p)
+{
+	return (uint32)p[0] | ((uint32)p[1] << 8) | ((uint32)p[2] << 16) | ((uint32)p[3] << 24);
+}
+
+static	int		Zip_ToLower(int c)
+{
+	return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+static	uint32	Zip_Hash(const char *Name, int32 Length)
+{
+	uint32	Hash;
+	int32	i;
+
+	// FNV-1a over the lower cased name
+	Hash = 2166136261UL;
+	for	(i = 0; i < Length; i++)
+	{
+		Hash ^= (uint32)Zip_ToLower((unsigned char)Name[i]);
+		Hash *= 16777619UL;
+	}
+
+	return Hash;
+}
+
+static	jeBoolean	Zip_NamesEqual(const char *A, const char *B, int32 Length)
+{
+	int32	i;
+
+	for	(i = 0; i < Length; i++)
+	{
+		if	(Zip_ToLower((unsigned char)A[i]) != Zip_ToLower((unsigned char)B[i]))
+			return JE_FALSE;
+	}
+
+	return JE_TRUE;
+}
+
+//	Case-insensitive '*' and '?' match, like DirTree's finder
+static	jeBoolean	Zip_MatchPattern(const char *Name, int32 Length, const char *Pattern)
+{
+	while	(*Pattern)
+	{
+		if	(*Pattern == '*')
+		{
+			int32	i;
+
+			Pattern++;
+			if	(!*Pattern)
+				return JE_TRUE;
+
+			for	(i = 0; i <= Length; i++)
+			{
+				if	(Zip_MatchPattern(Name + i, Length - i, Pattern) == JE_TRUE)
+					return JE_TRUE;
+			}
+			return JE_FALSE;
+		}
+
+		if	(Length == 0)
+			return JE_FALSE;
+
+		if	(*Pattern != '?' && Zip_ToLower((unsigned char)*Pattern) != Zip_ToLower((unsigned char)*Name))
+			return JE_FALSE;
+
+		Pattern++;
+		Name++;
+		Length--;
+	}
+
+	return (Length == 0) ? JE_TRUE : JE_FALSE;
+}
+
+//	Appends the components of Name to Buff, which already holds Length bytes of a
+//	normalized path.  Handles DOS separators, "." and "..".  Returns the new length,
+//	or -1 if it doesn't fit.
+static	int32	Zip_AppendPath(char *Buff, int32 Length, const char *Name, int32 MaxLen)
+{
+	while	(*Name)
+	{
+		const char *	End;
+		int32			SegLength;
+
+		End = Name;
+		while	(*End && *End != '/' && *End != '\\')
+			End++;
+
+		SegLength = (int32)(End - Name);
+
+		if	(SegLength == 0 || (SegLength == 1 && Name[0] == '.'))
+		{
+			// Empty or current directory
+		}
+		else if	(SegLength == 2 && Name[0] == '.' && Name[1] == '.')
+		{
+			while	(Length > 0 && Buff[Length-1] != '/')
+				Length--;
+			if	(Length > 0)
+				Length--;
+		}
+		else
+		{
+			if	(Length + SegLength + 2 > MaxLen)
+				return -1;
+
+			if	(Length > 0)
+				Buff[Length++] = '/';
+			memcpy(Buff + Length, Name, SegLength);
+			Length += SegLength;
+		}
+
+		Name = *End ? End + 1 : End;
+	}
+
+	Buff[Length] = '\0';
+	return Length;
+}
+
+/*}{ ******* The index *******/
+
+static	int32	ZipArchive_Find(const ZipArchive *Archive, const char *Name, int32 Length)
+{
+	uint32	Hash;
+	int32	i;
+
+	Hash = Zip_Hash(Name, Length);
+
+	for	(i = Archive->Buckets[Hash & Archive->BucketMask]; i != ZIP_NONE; i = Archive->Entries[i].NextInBucket)
+	{
+		const ZipEntry *	Entry = &Archive->Entries[i];
+
+		if	(Entry->Hash == Hash &&
+			 Entry->NameLength == Length &&
+			 Zip_NamesEqual(Entry->Name, Name, Length) == JE_TRUE)
+			return i;
+	}
+
+	return ZIP_NONE;
+}
+
+//	Finds Name, adding it and any missing parent directories.  *Added says whether
+//	the returned entry is new.
+static	int32	ZipArchive_FindOrAdd(ZipArchive *Archive, const char *Name, int32 Length, jeBoolean IsDirectory, jeBoolean *Added)
+{
+	ZipEntry *	Entry;
+	int32		Index, Parent, Slash;
+	jeBoolean	ParentAdded;
+
+	*Added = JE_FALSE;
+
+	if	(Length == 0)
+		return ZIP_ROOT;
+
+	Index = ZipArchive_Find(Archive, Name, Length);
+	if	(Index != ZIP_NONE)
+		return Index;
+
+	for	(Slash = Length - 1; Slash >= 0 && Name[Slash] != '/'; Slash--)
+		;
+
+	Parent = ZIP_ROOT;
+	if	(Slash > 0)
+	{
+		Parent = ZipArchive_FindOrAdd(Archive, Name, Slash, JE_TRUE, &ParentAdded);
+		if	(Parent == ZIP_NONE)
+			return ZIP_NONE;
+	}
+
+	// A file can't be the parent of anything
+	if	(Archive->Entries[Parent].IsDirectory == JE_FALSE)
+		return ZIP_NONE;
+
+	if	(Archive->EntryCount == Archive->EntryCapacity)
+	{
+		ZipEntry *	NewEntries;
+		int32		NewCapacity;
+
+		NewCapacity = Archive->EntryCapacity * 2;
+		NewEntries = (ZipEntry *)jeRam_Realloc(Archive->Entries, NewCapacity * sizeof(ZipEntry));
+		if	(!NewEntries)
+			return ZIP_NONE;
+
+		Archive->Entries = NewEntries;
+		Archive->EntryCapacity = NewCapacity;
+	}
+
+	Index = Archive->EntryCount++;
+	Entry = &Archive->Entries[Index];
+	memset(Entry, 0, sizeof(*Entry));
+
+	Entry->Name = Name;
+	Entry->NameLength = Length;
+	Entry->BaseName = Slash + 1;
+	Entry->Hash = Zip_Hash(Name, Length);
+	Entry->IsDirectory = IsDirectory;
+	Entry->Parent = Parent;
+	Entry->FirstChild = ZIP_NONE;
+	Entry->LastChild = ZIP_NONE;
+	Entry->NextSibling = ZIP_NONE;
+
+	Entry->NextInBucket = Archive->Buckets[Entry->Hash & Archive->BucketMask];
+	Archive->Buckets[Entry->Hash & Archive->BucketMask] = Index;
+
+	// Keep children in archive order, so finders list them the way they were packed
+	if	(Archive->Entries[Parent].LastChild == ZIP_NONE)
+		Archive->Entries[Parent].FirstChild = Index;
+	else
+		Archive->Entries[Archive->Entries[Parent].LastChild].NextSibling = Index;
+	Archive->Entries[Parent].LastChild = Index;
+
+	*Added = JE_TRUE;
+	return Index;
+}
+
+static	void	ZipArchive_Destroy(ZipArchive *Archive)
+{
+	if	(Archive->Lock)
+		jeParallel_MutexDestroy(&Archive->Lock);
+	if	(Archive->Central)
+		jeRam_Free(Archive->Central);
+	if	(Archive->Entries)
+		jeRam_Free(Archive->Entries);
+	if	(Archive->Buckets)
+		jeRam_Free(Archive->Buckets);
+	jeRam_Free(Archive);
+}
+
+static	void	ZipArchive_AddRef(ZipArchive *Archive)
+{
+	jeParallel_MutexLock(Archive->Lock);
+	Archive->RefCount++;
+	jeParallel_MutexUnlock(Archive->Lock);
+}
+
+static	void	ZipArchive_Release(ZipArchive *Archive)
+{
+	int32	RefCount;
+
+	jeParallel_MutexLock(Archive->Lock);
+	RefCount = --Archive->RefCount;
+	jeParallel_MutexUnlock(Archive->Lock);
+
+	if	(RefCount == 0)
+		ZipArchive_Destroy(Archive);
+}
+
+//	Offset is relative to the start of the archive's central directory numbering
+static	jeBoolean	ZipArchive_ReadAt(ZipArchive *Archive, long Offset, void *Buff, uint32 Count)
+{
+	jeBoolean	Result;
+
+	if	(Count == 0)
+		return JE_TRUE;
+
+	jeParallel_MutexLock(Archive->Lock);
+	Result = jeVFile_Seek(Archive->RWOps, (int)(Offset + Archive->Bias), JE_VFILE_SEEKSET);
+	if	(Result == JE_TRUE)
+		Result = jeVFile_Read(Archive->RWOps, Buff, Count);
+	jeParallel_MutexUnlock(Archive->Lock);
+
+	return Result;
+}
+
+static	ZipArchive *	ZipArchive_Create(jeVFile *RWOps)
+{
+	ZipArchive *	Archive;
+	uint8 *			Tail;
+	long			StartPos, FileSize, TailLength, EOCDPos, i;
+	uint32			NumEntries, CentralSize, CentralOffset, BucketCount;
+	const uint8 *	p;
+	const uint8 *	End;
+
+	if	(jeVFile_Tell(RWOps, &StartPos) == JE_FALSE || jeVFile_Size(RWOps, &FileSize) == JE_FALSE)
+		return NULL;
+
+	if	(FileSize - StartPos < ZIP_EOCD_SIZE)
+		return NULL;
+
+	// The end of central directory record is somewhere in the last 64k + 22 bytes
+	TailLength = FileSize - StartPos;
+	if	(TailLength > ZIP_MAX_COMMENT + ZIP_EOCD_SIZE)
+		TailLength = ZIP_MAX_COMMENT + ZIP_EOCD_SIZE;
+
+	Tail = (uint8 *)jeRam_Allocate(TailLength);
+	if	(!Tail)
+		return NULL;
+
+	if	(jeVFile_Seek(RWOps, (int)(FileSize - TailLength), JE_VFILE_SEEKSET) == JE_FALSE ||
+		 jeVFile_Read(RWOps, Tail, TailLength) == JE_FALSE)
+	{
+		jeRam_Free(Tail);
+		return NULL;
+	}
+
+	EOCDPos = -1;
+	for	(i = TailLength - ZIP_EOCD_SIZE; i >= 0; i--)
+	{
+		if	(Zip_Get32(Tail + i) == ZIP_EOCD_SIGNATURE &&
+			 i + ZIP_EOCD_SIZE + (long)Zip_Get16(Tail + i + 20) <= TailLength)
+		{
+			EOCDPos = i;
+			break;
+		}
+	}
+
+	if	(EOCDPos < 0)
+	{
+		jeRam_Free(Tail);
+		jeErrorLog_AddString(-1, "FSZip : Not a zip archive", NULL);
+		return NULL;
+	}
+
+	p = Tail + EOCDPos;
+	NumEntries = Zip_Get16(p + 10);
+	CentralSize = Zip_Get32(p + 12);
+	CentralOffset = Zip_Get32(p + 16);
+
+	if	(Zip_Get16(p + 4) != 0 || Zip_Get16(p + 6) != 0 || Zip_Get16(p + 8) != NumEntries)
+	{
+		jeRam_Free(Tail);
+		jeErrorLog_AddString(-1, "FSZip : Multi-disk archives are not supported", NULL);
+		return NULL;
+	}
+
+	if	(NumEntries == 0xFFFF || CentralSize == 0xFFFFFFFF || CentralOffset == 0xFFFFFFFF)
+	{
+		jeRam_Free(Tail);
+		jeErrorLog_AddString(-1, "FSZip : Zip64 archives are not supported", NULL);
+		return NULL;
+	}
+
+	Archive = (ZipArchive *)jeRam_AllocateClear(sizeof(*Archive));
+	if	(!Archive)
+	{
+		jeRam_Free(Tail);
+		return NULL;
+	}
+
+	// Offsets are relative to wherever the archive starts inside RWOps
+	Archive->RWOps = RWOps;
+	Archive->Bias = (FileSize - TailLength + EOCDPos) - ((long)CentralOffset + (long)CentralSize);
+	jeRam_Free(Tail);
+
+	if	(Archive->Bias < StartPos)
+	{
+		jeErrorLog_AddString(-1, "FSZip : Bad central directory", NULL);
+		ZipArchive_Destroy(Archive);
+		return NULL;
+	}
+
+	Archive->Lock = jeParallel_MutexCreate();
+	Archive->RefCount = 1;
+
+	Archive->Central = (uint8 *)jeRam_Allocate(CentralSize + 1);
+	Archive->EntryCapacity = (int32)NumEntries * 2 + 16;
+	Archive->Entries = (ZipEntry *)jeRam_Allocate(Archive->EntryCapacity * sizeof(ZipEntry));
+
+	for	(BucketCount = 64; BucketCount < NumEntries * 2; BucketCount <<= 1)
+		;
+	Archive->BucketMask = BucketCount - 1;
+	Archive->Buckets = (int32 *)jeRam_Allocate(BucketCount * sizeof(int32));
+
+	if	(!Archive->Lock || !Archive->Central || !Archive->Entries || !Archive->Buckets)
+	{
+		ZipArchive_Destroy(Archive);
+		return NULL;
+	}
+
+	for	(i = 0; i < (long)BucketCount; i++)
+		Archive->Buckets[i] = ZIP_NONE;
+
+	// The root
+	memset(&Archive->Entries[ZIP_ROOT], 0, sizeof(ZipEntry));
+	Archive->Entries[ZIP_ROOT].Name = "";
+	Archive->Entries[ZIP_ROOT].IsDirectory = JE_TRUE;
+	Archive->Entries[ZIP_ROOT].Parent = ZIP_NONE;
+	Archive->Entries[ZIP_ROOT].FirstChild = ZIP_NONE;
+	Archive->Entries[ZIP_ROOT].LastChild = ZIP_NONE;
+	Archive->Entries[ZIP_ROOT].NextSibling = ZIP_NONE;
+	Archive->Entries[ZIP_ROOT].NextInBucket = ZIP_NONE;
+	Archive->EntryCount = 1;
+
+	if	(ZipArchive_ReadAt(Archive, CentralOffset, Archive->Central, CentralSize) == JE_FALSE)
+	{
+		ZipArchive_Destroy(Archive);
+		return NULL;
+	}
+
+	p = Archive->Central;
+	End = p + CentralSize;
+	for	(i = 0; i < (long)NumEntries; i++)
+	{
+		char *		Name;
+		int32		NameLength, Index, j;
+		uint32		ExtraLength, CommentLength, RecordLength;
+		jeBoolean	IsDirectory, Added;
+		ZipEntry *	Entry;
+
+		if	(End - p < ZIP_CENTRAL_SIZE || Zip_Get32(p) != ZIP_CENTRAL_SIGNATURE)
+		{
+			jeErrorLog_AddString(-1, "FSZip : Bad central directory", NULL);
+			ZipArchive_Destroy(Archive);
+			return NULL;
+		}
+
+		NameLength = (int32)Zip_Get16(p + 28);
+		ExtraLength = Zip_Get16(p + 30);
+		CommentLength = Zip_Get16(p + 32);
+
+		RecordLength = ZIP_CENTRAL_SIZE + NameLength + ExtraLength + CommentLength;
+		if	((uint32)(End - p) < RecordLength)
+		{
+			jeErrorLog_AddString(-1, "FSZip : Bad central directory", NULL);
+			ZipArchive_Destroy(Archive);
+			return NULL;
+		}
+
+		// Normalize the name in place: '/' separators, no leading "./" or '/'
+		Name = (char *)p + ZIP_CENTRAL_SIZE;
+		for	(j = 0; j < NameLength; j++)
+		{
+			if	(Name[j] == '\\')
+				Name[j] = '/';
+		}
+		while	(NameLength > 0 && Name[0] == '/')
+		{
+			Name++;
+			NameLength--;
+		}
+		while	(NameLength > 1 && Name[0] == '.' && Name[1] == '/')
+		{
+			Name += 2;
+			NameLength -= 2;
+		}
+
+		IsDirectory = JE_FALSE;
+		if	(NameLength > 0 && Name[NameLength-1] == '/')
+		{
+			IsDirectory = JE_TRUE;
+			NameLength--;
+		}
+
+		Index = ZipArchive_FindOrAdd(Archive, Name, NameLength, IsDirectory, &Added);
+
+		// Duplicates keep the first entry, like a search list would
+		if	(Index != ZIP_NONE && Added == JE_TRUE && IsDirectory == JE_FALSE)
+		{
+			Entry = &Archive->Entries[Index];
+			Entry->Flags = (uint16)Zip_Get16(p + 8);
+			Entry->Method = (uint16)Zip_Get16(p + 10);
+			Entry->DosTime = (uint16)Zip_Get16(p + 12);
+			Entry->DosDate = (uint16)Zip_Get16(p + 14);
+			Entry->CompSize = Zip_Get32(p + 20);
+			Entry->Size = Zip_Get32(p + 24);
+			Entry->LocalOffset = Zip_Get32(p + 42);
+		}
+
+		p += RecordLength;
+	}
+
+	return Archive;
+}
+
+static	void	Zip_DosTimeToTime(uint16 DosTime, uint16 DosDate, jeVFile_Time *Time)
+{
+	int32				Year, Month, Day, Era, YearOfEra, DayOfYear;
+	long				Days;
+	unsigned long long	FileTime;
+
+	Year = 1980 + (DosDate >> 9);
+	Month = (DosDate >> 5) & 15;
+	Day = DosDate & 31;
+
+	if	(Month < 1 || Month > 12 || Day < 1)
+	{
+		Time->Time1 = Time->Time2 = 0;
+		return;
+	}
+
+	// Days since 1970-01-01 of a proleptic Gregorian date
+	Year -= (Month <= 2);
+	Era = Year / 400;
+	YearOfEra = Year - Era * 400;
+	DayOfYear = (153 * (Month + (Month > 2 ? -3 : 9)) + 2) / 5 + Day - 1;
+	Days = (long)Era * 146097 + YearOfEra * 365 + YearOfEra / 4 - YearOfEra / 100 + DayOfYear - 719468;
+
+	// Same FILETIME meaning as FSDos; zip times are local, like FAT's
+	FileTime = (unsigned long long)Days * 86400ULL +
+			   (unsigned long long)((DosTime >> 11) * 3600 + ((DosTime >> 5) & 63) * 60 + (DosTime & 31) * 2) +
+			   11644473600ULL;
+	FileTime *= 10000000ULL;
+
+	Time->Time1 = (unsigned long)(FileTime & 0xffffffffUL);
+	Time->Time2 = (unsigned long)(FileTime >> 32);
+}
+
+static	void	Zip_GetProperties(const ZipEntry *Entry, jeVFile_Properties *Properties)
+{
+	int32	Length;
+
+	Properties->AttributeFlags = JE_VFILE_ATTRIB_READONLY;
+	if	(Entry->IsDirectory)
+		Properties->AttributeFlags |= JE_VFILE_ATTRIB_DIRECTORY;
+
+	Properties->Size = (long)Entry->Size;
+	Zip_DosTimeToTime(Entry->DosTime, Entry->DosDate, &Properties->Time);
+
+	Length = Entry->NameLength - Entry->BaseName;
+	if	(Length > (int32)sizeof(Properties->Name) - 1)
+		Length = (int32)sizeof(Properties->Name) - 1;
+	memcpy(Properties->Name, Entry->Name + Entry->BaseName, Length);
+	Properties->Name[Length] = '\0';
+}
+
+/*}{ ******* Decoding *******/
+
+static	void	FSZip_ReadAheadTask(void *Context)
+{
+	ZipFile *	File;
+
+	File = (ZipFile *)Context;
+
+	if	(inflateDecoder_Extend(File->Decoder, File->ReadAheadTo, &File->Decoded) == JE_FALSE)
+		File->DecodeFailed = JE_TRUE;
+}
+
+//	Makes Data valid up to Need, then queues more decoding past it
+static	jeBoolean	FSZip_Decode(ZipFile *File, uint32 Need)
+{
+	assert(Need <= File->Size);
+
+	if	(Need <= File->Available)
+		return JE_TRUE;
+
+	if	(!File->Decoder)
+		return JE_FALSE;
+
+	jeParallel_GroupWait(File->ReadAhead);
+
+	if	(File->DecodeFailed == JE_FALSE && File->Decoded < Need)
+	{
+		if	(inflateDecoder_Extend(File->Decoder, Need, &File->Decoded) == JE_FALSE)
+			File->DecodeFailed = JE_TRUE;
+	}
+
+	if	(File->DecodeFailed == JE_FALSE && inflateDecoder_IsDone(File->Decoder))
+	{
+		// Done with the compressed data
+		if	(File->Decoded != File->Size)
+			File->DecodeFailed = JE_TRUE;
+
+		inflateDecoder_Destroy(&File->Decoder);
+		jeRam_Free(File->CompData);
+		File->CompData = NULL;
+	}
+
+	if	(File->DecodeFailed == JE_TRUE)
+	{
+		jeErrorLog_AddString(-1, "FSZip : Corrupt deflate data", NULL);
+		return JE_FALSE;
+	}
+
+	File->Available = File->Decoded;
+	if	(File->Available < Need)
+		return JE_FALSE;
+
+	if	(File->Decoder)
+	{
+		File->ReadAheadTo = Need + FSZIP_READAHEAD;
+		if	(File->ReadAheadTo > File->Size)
+			File->ReadAheadTo = File->Size;
+
+		if	(File->ReadAheadTo > File->Decoded)
+			jeParallel_GroupRun(File->ReadAhead, FSZip_ReadAheadTask, File);
+	}
+
+	return JE_TRUE;
+}
+
+static	jeBoolean	FSZip_LoadEntry(ZipFile *File, const ZipEntry *Entry)
+{
+	ZipArchive *	Archive;
+	uint8			Local[ZIP_LOCAL_SIZE];
+	long			DataOffset;
+
+	Archive = File->Archive;
+
+	if	(Entry->Flags & ZIP_FLAG_ENCRYPTED)
+	{
+		jeErrorLog_AddString(-1, "FSZip : Encrypted entries are not supported", NULL);
+		return JE_FALSE;
+	}
+
+	if	(Entry->Method != ZIP_METHOD_STORED && Entry->Method != ZIP_METHOD_DEFLATE)
+	{
+		jeErrorLog_AddString(-1, "FSZip : Unsupported compression method", NULL);
+		return JE_FALSE;
+	}
+
+	if	(ZipArchive_ReadAt(Archive, (long)Entry->LocalOffset, Local, sizeof(Local)) == JE_FALSE ||
+		 Zip_Get32(Local) != ZIP_LOCAL_SIGNATURE)
+	{
+		jeErrorLog_AddString(-1, "FSZip : Bad local header", NULL);
+		return JE_FALSE;
+	}
+
+	DataOffset = (long)Entry->LocalOffset + ZIP_LOCAL_SIZE + (long)Zip_Get16(Local + 26) + (long)Zip_Get16(Local + 28);
+
+	File->Size = Entry->Size;
+	if	(File->Size == 0)
+		return JE_TRUE;
+
+	File->Data = (uint8 *)jeRam_Allocate(File->Size);
+	if	(!File->Data)
+		return JE_FALSE;
+
+	if	(Entry->Method == ZIP_METHOD_STORED)
+	{
+		if	(Entry->CompSize != Entry->Size)
+			return JE_FALSE;
+
+		if	(ZipArchive_ReadAt(Archive, DataOffset, File->Data, File->Size) == JE_FALSE)
+			return JE_FALSE;
+
+		File->Available = File->Size;
+		return JE_TRUE;
+	}
+
+	File->CompData = (uint8 *)jeRam_Allocate(Entry->CompSize + 1);
+	if	(!File->CompData)
+		return JE_FALSE;
+
+	if	(ZipArchive_ReadAt(Archive, DataOffset, File->CompData, Entry->CompSize) == JE_FALSE)
+		return JE_FALSE;
+
+	File->Decoder = inflateDecoder_Create(File->CompData, Entry->CompSize, File->Data, File->Size);
+	File->ReadAhead = jeParallel_GroupCreate();
+	if	(!File->Decoder || !File->ReadAhead)
+		return JE_FALSE;
+
+	// Get the first blocks going before anyone asks for them
+	File->ReadAheadTo = (File->Size < FSZIP_READAHEAD) ? File->Size : FSZIP_READAHEAD;
+	jeParallel_GroupRun(File->ReadAhead, FSZip_ReadAheadTask, File);
+
+	return JE_TRUE;
+}
+
+static	void	FSZip_Destroy(ZipFile *File)
+{
+	if	(File->ReadAhead)
+		jeParallel_GroupDestroy(&File->ReadAhead);
+	if	(File->Decoder)
+		inflateDecoder_Destroy(&File->Decoder);
+	if	(File->CompData)
+		jeRam_Free(File->CompData);
+	if	(File->Data)
+		jeRam_Free(File->Data);
+
+	ZipArchive_Release(File->Archive);
+
+	File->Signature = 0;
+	jeRam_Free(File);
+}
+
+/*}{ ******* Finder *******/
+
+#pragma warning (disable:4100)
+static	void *	JETCC FSZip_FinderCreate(
+	jeVFile *		FS,
+	void *			Handle,
+	const char *	FileSpec)
+{
+	ZipFinder *		Finder;
+	ZipFile *		File;
+	const ZipEntry *Dir;
+	char			Buff[FSZIP_MAX_PATH];
+	int32			Length, Slash, DirIndex;
+
+	assert(FileSpec != NULL);
+
+	File = (ZipFile *)Handle;
+
+	CHECK_HANDLE(File);
+
+	if	(File->IsDirectory == JE_FALSE)
+		return NULL;
+
+	Dir = &File->Archive->Entries[File->Entry];
+
+	if	(Dir->NameLength >= (int32)sizeof(Buff))
+		return NULL;
+	memcpy(Buff, Dir->Name, Dir->NameLength);
+
+	Length = Zip_AppendPath(Buff, Dir->NameLength, FileSpec, sizeof(Buff));
+	if	(Length < 0)
+		return NULL;
+
+	Finder = (ZipFinder *)jeRam_AllocateClear(sizeof(*Finder));
+	if	(!Finder)
+		return NULL;
+
+	// Split into a directory and a pattern
+	for	(Slash = Length - 1; Slash >= 0 && Buff[Slash] != '/'; Slash--)
+		;
+
+	strcpy(Finder->Pattern, Buff + Slash + 1);
+
+	// Win32 "*.*" also matches names without an extension
+	if	(strcmp(Finder->Pattern, "*.*") == 0)
+		strcpy(Finder->Pattern, "*");
+
+	DirIndex = (Slash > 0) ? ZipArchive_Find(File->Archive, Buff, Slash) : ZIP_ROOT;
+
+	Finder->Archive = File->Archive;
+	Finder->Current = ZIP_NONE;
+	Finder->Next = ZIP_NONE;
+	if	(DirIndex != ZIP_NONE && File->Archive->Entries[DirIndex].IsDirectory)
+		Finder->Next = File->Archive->Entries[DirIndex].FirstChild;
+
+	ZipArchive_AddRef(File->Archive);
+
+	Finder->Signature = ZIPFINDER_SIGNATURE;
+	return (void *)Finder;
+}
+#pragma warning (default:4100)
+
+static	jeBoolean	JETCC FSZip_FinderGetNextFile(void *Handle)
+{
+	ZipFinder *		Finder;
+
+	Finder = (ZipFinder *)Handle;
+
+	CHECK_FINDER(Finder);
+
+	while	(Finder->Next != ZIP_NONE)
+	{
+		const ZipEntry *	Entry = &Finder->Archive->Entries[Finder->Next];
+
+		Finder->Current = Finder->Next;
+		Finder->Next = Entry->NextSibling;
+
+		if	(Zip_MatchPattern(Entry->Name + Entry->BaseName, Entry->NameLength - Entry->BaseName, Finder->Pattern) == JE_TRUE)
+			return JE_TRUE;
+	}
+
+	Finder->Current = ZIP_NONE;
+	return JE_FALSE;
+}
+
+static	jeBoolean	JETCC FSZip_FinderGetProperties(void *Handle, jeVFile_Properties *Properties)
+{
+	ZipFinder *		Finder;
+
+	assert(Properties);
+
+	Finder = (ZipFinder *)Handle;
+
+	CHECK_FINDER(Finder);
+
+	if	(Finder->Current == ZIP_NONE)
+		return JE_FALSE;
+
+	Zip_GetProperties(&Finder->Archive->Entries[Finder->Current], Properties);
+	return JE_TRUE;
+}
+
+static	void JETCC FSZip_FinderDestroy(void *Handle)
+{
+	ZipFinder *		Finder;
+
+	Finder = (ZipFinder *)Handle;
+
+	CHECK_FINDER(Finder);
+
+	ZipArchive_Release(Finder->Archive);
+
+	Finder->Signature = 0;
+	jeRam_Free(Finder);
+}
+
+/*}{ ******* Open / Close *******/
+
+#pragma warning (disable:4100)
+static	void *	JETCC FSZip_Open(
+	jeVFile *		FS,
+	void *			Handle,
+	const char *	Name,
+	void *			Context,
+	unsigned int 	OpenModeFlags)
+{
+	ZipFile *		Dir;
+	ZipFile *		NewFile;
+	const ZipEntry *Entry;
+	char			Buff[FSZIP_MAX_PATH];
+	int32			Length, Index;
+
+	Dir = (ZipFile *)Handle;
+
+	CHECK_HANDLE(Dir);
+
+	assert(Name);
+
+	if	(Dir->IsDirectory == JE_FALSE)
+		return NULL;
+
+	// Read-only
+	if	(OpenModeFlags & (JE_VFILE_OPEN_UPDATE | JE_VFILE_OPEN_CREATE))
+		return NULL;
+
+	Entry = &Dir->Archive->Entries[Dir->Entry];
+	if	(Entry->NameLength >= (int32)sizeof(Buff))
+		return NULL;
+	memcpy(Buff, Entry->Name, Entry->NameLength);
+
+	Length = Zip_AppendPath(Buff, Entry->NameLength, Name, sizeof(Buff));
+	if	(Length < 0)
+		return NULL;
+
+	Index = ZipArchive_Find(Dir->Archive, Buff, Length);
+	if	(Length == 0)
+		Index = ZIP_ROOT;
+	if	(Index == ZIP_NONE)
+		return NULL;
+
+	Entry = &Dir->Archive->Entries[Index];
+	if	(Entry->IsDirectory != ((OpenModeFlags & JE_VFILE_OPEN_DIRECTORY) ? JE_TRUE : JE_FALSE))
+		return NULL;
+
+	NewFile = (ZipFile *)jeRam_AllocateClear(sizeof(*NewFile));
+	if	(!NewFile)
+		return NULL;
+
+	NewFile->Signature = ZIPFILE_SIGNATURE;
+	NewFile->Archive = Dir->Archive;
+	NewFile->Entry = Index;
+	NewFile->IsDirectory = Entry->IsDirectory;
+
+	ZipArchive_AddRef(NewFile->Archive);
+
+	if	(NewFile->IsDirectory == JE_FALSE && FSZip_LoadEntry(NewFile, Entry) == JE_FALSE)
+	{
+		FSZip_Destroy(NewFile);
+		return NULL;
+	}
+
+	return (void *)NewFile;
+}
+#pragma warning (default:4100)
+
+static	void *	JETCC FSZip_OpenNewSystem(
+	jeVFile *		RWOps,
+	const char *	Name,
+	void *			Context,
+	unsigned int 	OpenModeFlags)
+{
+	ZipFile *		NewFS;
+	ZipArchive *	Archive;
+
+	assert(Name == NULL);
+	assert(Context == NULL);
+
+	if	(!RWOps)
+		return NULL;
+
+	// Archives are read-only directories
+	if	(!(OpenModeFlags & JE_VFILE_OPEN_DIRECTORY) ||
+		 (OpenModeFlags & (JE_VFILE_OPEN_UPDATE | JE_VFILE_OPEN_CREATE)))
+		return NULL;
+
+	Archive = ZipArchive_Create(RWOps);
+	if	(!Archive)
+		return NULL;
+
+	NewFS = (ZipFile *)jeRam_AllocateClear(sizeof(*NewFS));
+	if	(!NewFS)
+	{
+		ZipArchive_Release(Archive);
+		return NULL;
+	}
+
+	// The system handle owns the reference Create made
+	NewFS->Signature = ZIPFILE_SIGNATURE;
+	NewFS->Archive = Archive;
+	NewFS->Entry = ZIP_ROOT;
+	NewFS->IsDirectory = JE_TRUE;
+
+	return (void *)NewFS;
+}
+
+#pragma warning (disable:4100)
+static	jeBoolean	JETCC FSZip_UpdateContext(
+	jeVFile *		FS,
+	void *			Handle,
+	void *			Context,
+	int 			ContextSize)
+{
+	return JE_FALSE;
+}
+#pragma warning (default:4100)
+
+static	jeBoolean	JETCC FSZip_Close(void *Handle)
+{
+	ZipFile *	File;
+
+	File = (ZipFile *)Handle;
+
+	CHECK_HANDLE(File);
+
+	FSZip_Destroy(File);
+
+	return JE_TRUE;
+}
+
+/*}{ ******* Reading *******/
+
+static	jeBoolean	JETCC FSZip_GetS(void *Handle, void *Buff, int MaxLen)
+{
+	ZipFile *	File;
+	uint32		Count, i;
+	char *		p;
+
+	assert(Buff);
+	assert(MaxLen != 0);
+
+	File = (ZipFile *)Handle;
+
+	CHECK_HANDLE(File);
+
+	if	(File->IsDirectory == JE_TRUE || File->Position >= File->Size)
+		return JE_FALSE;
+
+	Count = File->Size - File->Position;
+	if	(Count > (uint32)(MaxLen - 1))
+		Count = (uint32)(MaxLen - 1);
+
+	if	(FSZip_Decode(File, File->Position + Count) == JE_FALSE)
+		return JE_FALSE;
+
+	// Same line endings as FSDos_GetS
+	p = (char *)Buff;
+	for	(i = 0; i < Count; i++)
+	{
+		char	c = (char)File->Data[File->Position + i];
+
+		if	(c == '\r')
+		{
+			p[i] = '\n';
+			p[i+1] = '\0';
+			File->Position += i + 1;
+			if	(i + 1 < Count && File->Data[File->Position] == '\n')
+				File->Position++;
+			return JE_TRUE;
+		}
+
+		p[i] = c;
+		if	(c == '\n')
+		{
+			p[i+1] = '\0';
+			File->Position += i + 1;
+			return JE_TRUE;
+		}
+	}
+
+	// No line end before EOF or MaxLen, still hand back a terminated string
+	p[Count] = '\0';
+
+	return JE_FALSE;
+}
+
+static	jeBoolean	JETCC FSZip_BytesAvailable(void *Handle, long *Count)
+{
+	ZipFile *	File;
+
+	assert(Count);
+
+	File = (ZipFile *)Handle;
+
+	CHECK_HANDLE(File);
+
+	if	(File->IsDirectory == JE_TRUE)
+		return JE_FALSE;
+
+	*Count = (long)(File->Size - File->Position);
+
+	return JE_TRUE;
+}
+
+static	jeBoolean	JETCC FSZip_Read(void *Handle, void *Buff, uint32 Count)
+{
+	ZipFile *	File;
+
+	assert(Buff);
+	assert(Count != 0);
+
+	File = (ZipFile *)Handle;
+
+	CHECK_HANDLE(File);
+
+	if	(File->IsDirectory == JE_TRUE)
+		return JE_FALSE;
+
+	if	(Count > File->Size - File->Position)
+		return JE_FALSE;
+
+	if	(FSZip_Decode(File, File->Position + Count) == JE_FALSE)
+		return JE_FALSE;
+
+	memcpy(Buff, File->Data + File->Position, Count);
+	File->Position += Count;
+
+	return JE_TRUE;
+}
+
+#pragma warning (disable:4100)
+static	jeBoolean	JETCC FSZip_Write(void *Handle, const void *Buff, int Count)
+{
+	return JE_FALSE;
+}
+#pragma warning (default:4100)
+
+static	jeBoolean	JETCC FSZip_Seek(void *Handle, int Where, jeVFile_Whence Whence)
+{
+	ZipFile *	File;
+	long		Position;
+
+	File = (ZipFile *)Handle;
+
+	CHECK_HANDLE(File);
+
+	if	(File->IsDirectory == JE_TRUE)
+		return JE_FALSE;
+
+	switch	(Whence)
+	{
+	case	JE_VFILE_SEEKCUR:
+		Position = (long)File->Position + Where;
+		break;
+
+	case	JE_VFILE_SEEKEND:
+		Position = (long)File->Size + Where;
+		break;
+
+	case	JE_VFILE_SEEKSET:
+		Position = Where;
+		break;
+
+	default:
+		assert(!"Unknown seek kind");
+		return JE_FALSE;
+	}
+
+	if	(Position < 0 || Position > (long)File->Size)
+		return JE_FALSE;
+
+	File->Position = (uint32)Position;
+
+	return JE_TRUE;
+}
+
+static	jeBoolean	JETCC FSZip_EOF(const void *Handle)
+{
+	const ZipFile *	File;
+
+	File = (const ZipFile *)Handle;
+
+	CHECK_HANDLE(File);
+
+	if	(File->IsDirectory == JE_TRUE)
+		return JE_FALSE;
+
+	return (File->Position == File->Size) ? JE_TRUE : JE_FALSE;
+}
+
+static	jeBoolean	JETCC FSZip_Tell(const void *Handle, long *Position)
+{
+	const ZipFile *	File;
+
+	File = (const ZipFile *)Handle;
+
+	CHECK_HANDLE(File);
+
+	if	(File->IsDirectory == JE_TRUE)
+		return JE_FALSE;
+
+	*Position = (long)File->Position;
+
+	return JE_TRUE;
+}
+
+static	jeBoolean	JETCC FSZip_Size(const void *Handle, long *Size)
+{
+	const ZipFile *	File;
+
+	File = (const ZipFile *)Handle;
+
+	CHECK_HANDLE(File);
+
+	if	(File->IsDirectory == JE_TRUE)
+		return JE_FALSE;
+
+	*Size = (long)File->Size;
+
+	return JE_TRUE;
+}
+
+static	jeBoolean	JETCC FSZip_GetProperties(const void *Handle, jeVFile_Properties *Properties)
+{
+	const ZipFile *	File;
+
+	assert(Properties);
+
+	File = (const ZipFile *)Handle;
+
+	CHECK_HANDLE(File);
+
+	memset(Properties, 0, sizeof(*Properties));
+	Zip_GetProperties(&File->Archive->Entries[File->Entry], Properties);
+
+	return JE_TRUE;
+}
+
+/*}{ ******* Read-only stubs *******/
+
+#pragma warning (disable:4100)
+static	jeBoolean	JETCC FSZip_SetSize(void *Handle, long Size)
+{
+	return JE_FALSE;
+}
+
+static	jeBoolean	JETCC FSZip_SetAttributes(void *Handle, jeVFile_Attributes Attributes)
+{
+	return JE_FALSE;
+}
+
+static	jeBoolean	JETCC FSZip_SetTime(void *Handle, const jeVFile_Time *Time)
+{
+	return JE_FALSE;
+}
+
+static	jeVFile *	JETCC FSZip_GetHintsFile(void *Handle)
+{
+	return NULL;
+}
+
+static	jeBoolean	JETCC FSZip_FileExists(jeVFile *FS, void *Handle, const char *Name)
+{
+	ZipFile *		Dir;
+	const ZipEntry *Entry;
+	char			Buff[FSZIP_MAX_PATH];
+	int32			Length;
+
+	Dir = (ZipFile *)Handle;
+
+	CHECK_HANDLE(Dir);
+
+	if	(Dir->IsDirectory == JE_FALSE)
+		return JE_FALSE;
+
+	Entry = &Dir->Archive->Entries[Dir->Entry];
+	if	(Entry->NameLength >= (int32)sizeof(Buff))
+		return JE_FALSE;
+	memcpy(Buff, Entry->Name, Entry->NameLength);
+
+	Length = Zip_AppendPath(Buff, Entry->NameLength, Name, sizeof(Buff));
+	if	(Length <= 0)
+		return (Length == 0) ? JE_TRUE : JE_FALSE;
+
+	return (ZipArchive_Find(Dir->Archive, Buff, Length) != ZIP_NONE) ? JE_TRUE : JE_FALSE;
+}
+
+static	jeBoolean	JETCC FSZip_Disperse(
+	jeVFile *	FS,
+	void *		Handle,
+	const char *Directory)
+{
+	return JE_FALSE;
+}
+
+static	jeBoolean	JETCC FSZip_DeleteFile(jeVFile *FS, void *Handle, const char *Name)
+{
+	return JE_FALSE;
+}
+
+static	jeBoolean	JETCC FSZip_RenameFile(jeVFile *FS, void *Handle, const char *Name, const char *NewName)
+{
+	return JE_FALSE;
+}
+#pragma warning (default:4100)
+
+static	jeVFile_SystemAPIs	FSZip_APIs =
+{
+	FSZip_FinderCreate,
+	FSZip_FinderGetNextFile,
+	FSZip_FinderGetProperties,
+	FSZip_FinderDestroy,
+
+	FSZip_OpenNewSystem,
+	FSZip_UpdateContext,
+	FSZip_Open,
+	FSZip_DeleteFile,
+	FSZip_RenameFile,
+	FSZip_FileExists,
+	FSZip_Disperse,
+	FSZip_Close,
+
+	FSZip_GetS,
+	FSZip_BytesAvailable,
+	FSZip_Read,
+	FSZip_Write,
+	FSZip_Seek,
+	FSZip_EOF,
+	FSZip_Tell,
+	FSZip_Size,
+
+	FSZip_GetProperties,
+
+	FSZip_SetSize,
+	FSZip_SetAttributes,
+	FSZip_SetTime,
+
+	FSZip_GetHintsFile,
+};
+
+const jeVFile_SystemAPIs * JETCC FSZip_GetAPIs(void)
+{
+	return &FSZip_APIs;
+}
@@ -0,0 +1,18 @@
+/****************************************************************************************/
+/*  FSZIP.H                                                                             */
+/*                                                                                      */
+/*  Author: Styx3D Modernization                                                        */
+/*  Description: Read-only zip/pk3 archive file system interface                        */
+/*                                                                                      */
+/*  The contents of this file are subject to the 0BSD License.                          */
+/*  See LICENSE file in the project root for full license information.                  */
+/*                                                                                      */
+/****************************************************************************************/
+#ifndef	FSZIP_H
+#define	FSZIP_H
+
+#include "VFile._h"
+
+const	jeVFile_SystemAPIs * JETCC FSZip_GetAPIs(void);
+
+#endif
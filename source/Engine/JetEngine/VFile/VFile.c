@@ -52,10 +52,17 @@
 #include 	"FSBeos.h"
 #endif
 
+#if !defined(WIN32) && !defined(BUILD_BE)
+#include	<pthread.h>
+#include	"FSPosix.h"
+#define	FSPOSIX
+#endif
+
 #include	"FSMemory.h"
 #include	"FSVFS.h"
 #include	"FSLZ.h"
 #include	"fsfakenet.h"
+#include	"FSZip.h"
 
 #ifndef NO_INET
 #include	"fsinet.h"
@@ -101,6 +108,9 @@ typedef struct	jeVFile_Finder
 #ifdef BUILD_BE
         sem_id                                  CriticalSection;
 #endif // BUILD_BE  
+#ifdef FSPOSIX
+	pthread_mutex_t				CriticalSection;
+#endif // FSPOSIX
 }	jeVFile_Finder;
 
 /*}{ ******* Statics *******/
@@ -135,6 +145,12 @@ static jeBoolean JETCC CheckOpenFlags(unsigned int OpenModeFlags);
 #define DELETE_CRITICALSECTION(a) delete_sem(*a);
 #endif
 
+#ifdef FSPOSIX
+#define LOCK_CRITICALSECTION(a) pthread_mutex_lock(a);
+#define UNLOCK_CRITICALSECTION(a) pthread_mutex_unlock(a);
+#define DELETE_CRITICALSECTION(a) pthread_mutex_destroy(a);
+#endif
+
 /*}{ ******* File System Functions *******/
 
 static	jeBoolean JETCC jeVFile_RegisterFileSystemInternal(const jeVFile_SystemAPIs *APIs, jeVFile_TypeIdentifier *Type)
@@ -176,6 +192,13 @@ static	jeBoolean jeVFile_Enter(void)
 		return JE_FALSE;
 #endif
 
+#ifdef FSPOSIX
+	if	(jeVFile_RegisterFileSystemInternal(FSPosix_GetAPIs(), &Type) == JE_FALSE)
+		return JE_FALSE;
+	if	(Type != JE_VFILE_TYPE_DOS)
+		return JE_FALSE;
+#endif
+
 	if	(jeVFile_RegisterFileSystemInternal(FSMemory_GetAPIs(), &Type) == JE_FALSE)
 		return JE_FALSE;
 	if	(Type != JE_VFILE_TYPE_MEMORY)
@@ -196,14 +219,23 @@ static	jeBoolean jeVFile_Enter(void)
 	if	(Type != JE_VFILE_TYPE_FAKENET)
 		return JE_FALSE;
 
-	// INET must be last
-
 #ifndef NO_INET
 	if	(jeVFile_RegisterFileSystemInternal(FSINet_GetAPIs(), &Type) == JE_FALSE)
 		return JE_FALSE;
-	if	(Type != JE_VFILE_TYPE_INTERNET)
+#else
+	// Keep the slot, so the types registered after INET keep their numbers
+	if	(jeVFile_RegisterFileSystemInternal(NULL, &Type) == JE_FALSE)
 		return JE_FALSE;
 #endif
+	if	(Type != JE_VFILE_TYPE_INTERNET)
+		return JE_FALSE;
+
+	// New types go after INET, in the order of jeVFile_TypeIdentifier
+
+	if	(jeVFile_RegisterFileSystemInternal(FSZip_GetAPIs(), &Type) == JE_FALSE)
+		return JE_FALSE;
+	if	(Type != JE_VFILE_TYPE_ZIP)
+		return JE_FALSE;
 
 	jeVFile_RefCount ++;
 
@@ -222,6 +254,9 @@ static void jeVFile_Leave(void)
 		#ifdef BUILD_BE
 		jeRam_Free(RegisteredAPIs);
 		#endif
+		#ifdef FSPOSIX
+		jeRam_Free((void *)RegisteredAPIs);
+		#endif
 		
 		RegisteredAPIs = NULL;
 	}
@@ -266,11 +301,14 @@ JETAPI jeVFile * JETCC jeVFile_OpenNewSystem(
 	if	((FileSystemType == 0) || (FileSystemType > SystemCount))
 		goto fail;
 
+	if	(! RegisteredAPIs[FileSystemType - 1])
+		goto fail;
+
 	if	(CheckOpenFlags(OpenModeFlags) == JE_FALSE)
 		goto fail;
 
 	// Sugarcoating support for a taste test
-	if	(FS == NULL && FileSystemType == JE_VFILE_TYPE_VIRTUAL)
+	if	(FS == NULL && (FileSystemType == JE_VFILE_TYPE_VIRTUAL || FileSystemType == JE_VFILE_TYPE_ZIP))
 	{
 		assert(Name);
 		FS = jeVFile_OpenNewSystem(NULL,JE_VFILE_TYPE_DOS, Name, NULL,
@@ -837,6 +875,177 @@ JETAPI jeBoolean JETCC jeVFile_Read(jeVFile *File, void *Buff, uint32 Count)
 	return Result;
 }
 
+JETAPI jeBoolean JETCC jeVFile_ReadAt(jeVFile *File, long Offset, void *Buff, uint32 Count)
+{
+	jeBoolean	Result;
+	long		OldPos;
+
+	assert( jeVFile_IsValid(File) );
+
+	if	(Count == 0)
+		return JE_TRUE;
+
+	assert(Buff);
+
+	if	(Offset < 0)
+		return JE_FALSE;
+
+	// Positional systems don't touch shared state, so skip the file lock
+	if	(File->APIs->ReadAt)
+		return File->APIs->ReadAt(File->FSData, Offset, Buff, Count);
+
+	jeVFile_Lock(File);
+	Result = File->APIs->Tell(File->FSData, &OldPos);
+	if	(Result == JE_TRUE)
+		Result = File->APIs->Seek(File->FSData, (int)Offset, JE_VFILE_SEEKSET);
+	if	(Result == JE_TRUE)
+	{
+		Result = File->APIs->Read(File->FSData, Buff, Count);
+		if	(File->APIs->Seek(File->FSData, (int)OldPos, JE_VFILE_SEEKSET) == JE_FALSE)
+			Result = JE_FALSE;
+	}
+	jeVFile_UnLock(File);
+
+	assert( jeVFile_IsValid(File) );
+
+	return Result;
+}
+
+/*}{ ******* Asynchronous Reads *******/
+
+typedef	struct	jeVFile_AsyncRead
+{
+	jeVFile *				File;			// We hold a reference until Wait/Cancel
+	long					Offset;
+	void *					Buff;
+	uint32					Count;
+	jeVFile_AsyncCallback	Callback;
+	void *					Context;
+	jeThreadQueue_Job *		Job;			// NULL if the read was done on the spot
+	jeBoolean				Result;			// Published by the job's completion
+}	jeVFile_AsyncRead;
+
+static	void	jeVFile_AsyncReadFunc(jeThreadQueue_Job *Job, void *Context)
+{
+	jeVFile_AsyncRead *	Read = (jeVFile_AsyncRead *)Context;
+
+	Read->Result = jeVFile_ReadAt(Read->File, Read->Offset, Read->Buff, Read->Count);
+
+	if	(Read->Callback)
+		Read->Callback(Read->File, Read->Buff, Read->Count, Read->Result, Read->Context);
+}
+
+static	void	jeVFile_AsyncReadFree(jeVFile_AsyncRead **pRead)
+{
+	jeVFile_AsyncRead *	Read = *pRead;
+
+	if	(Read->Job)
+		jeThreadQueue_JobDestroy(&(Read->Job));
+
+	jeVFile_Close(Read->File);
+	jeRam_Free(*pRead);
+	*pRead = NULL;
+}
+
+JETAPI jeVFile_AsyncRead * JETCC jeVFile_ReadAsync(jeVFile *File, long Offset, void *Buff, uint32 Count,
+											jeVFile_AsyncPriority Priority,
+											jeVFile_AsyncCallback Callback, void *Context)
+{
+	jeVFile_AsyncRead *	Read;
+
+	assert( jeVFile_IsValid(File) );
+	assert( Buff || Count == 0 );
+
+	Read = JE_RAM_ALLOCATE_STRUCT_CLEAR(jeVFile_AsyncRead);
+	if	(!Read)
+		return NULL;
+
+	Read->File		= File;
+	Read->Offset	= Offset;
+	Read->Buff		= Buff;
+	Read->Count		= Count;
+	Read->Callback	= Callback;
+	Read->Context	= Context;
+
+	jeVFile_CreateRef(File);
+
+	// Memory files have no I/O to overlap; a thread hop would only add latency
+	if	(File->APIs == FSMemory_GetAPIs())
+	{
+		jeVFile_AsyncReadFunc(NULL, Read);
+		return Read;
+	}
+
+	Read->Job = jeThreadQueue_JobCreate(jeVFile_AsyncReadFunc, Read, NULL, 0);
+	if	(!Read->Job)
+	{
+		jeVFile_Close(File);
+		jeRam_Free(Read);
+		return NULL;
+	}
+
+	if	(Priority == JE_VFILE_ASYNC_HIGH)
+		jeThreadQueue_JobSetPriority(Read->Job, JE_THREADQUEUE_PRIORITY_HIGH);
+
+	return Read;
+}
+
+JETAPI jeBoolean JETCC jeVFile_AsyncIsDone(const jeVFile_AsyncRead *Read)
+{
+	assert(Read);
+
+	if	(!Read->Job)
+		return JE_TRUE;
+
+	return jeThreadQueue_JobGetStatus(Read->Job) == JE_THREADQUEUE_STATUS_COMPLETED;
+}
+
+JETAPI jeBoolean JETCC jeVFile_SetAsyncPriority(jeVFile_AsyncRead *Read, jeVFile_AsyncPriority Priority)
+{
+	assert(Read);
+
+	if	(!Read->Job)
+		return JE_FALSE;
+
+	return jeThreadQueue_JobSetPriority(Read->Job,
+			(Priority == JE_VFILE_ASYNC_HIGH) ? JE_THREADQUEUE_PRIORITY_HIGH : JE_THREADQUEUE_PRIORITY_LOW);
+}
+
+JETAPI jeBoolean JETCC jeVFile_WaitAsync(jeVFile_AsyncRead **pRead)
+{
+	jeBoolean	Result;
+
+	assert(pRead && *pRead);
+
+	if	((*pRead)->Job)
+		jeThreadQueue_WaitOnJob((*pRead)->Job, JE_THREADQUEUE_STATUS_COMPLETED);
+
+	Result = (*pRead)->Result;
+
+	jeVFile_AsyncReadFree(pRead);
+
+	return Result;
+}
+
+JETAPI jeBoolean JETCC jeVFile_CancelAsync(jeVFile_AsyncRead **pRead)
+{
+	jeBoolean	Cancelled;
+
+	assert(pRead && *pRead);
+
+	Cancelled = JE_FALSE;
+	if	((*pRead)->Job)
+	{
+		Cancelled = jeThreadQueue_JobCancel((*pRead)->Job);
+		if	(!Cancelled)
+			jeThreadQueue_WaitOnJob((*pRead)->Job, JE_THREADQUEUE_STATUS_COMPLETED);
+	}
+
+	jeVFile_AsyncReadFree(pRead);
+
+	return Cancelled;
+}
+
 JETAPI jeBoolean JETCC jeVFile_Write(jeVFile *File, const void *Buff, int Count)
 {
 	jeBoolean	Result;
@@ -1119,6 +1328,10 @@ JETAPI jeVFile_Finder * JETCC jeVFile_CreateFinder(
         
     #ifdef BUILD_BE
     Finder->CriticalSection = create_sem(1,NULL);
+    #endif
+
+    #ifdef FSPOSIX
+    pthread_mutex_init(&Finder->CriticalSection, NULL);
     #endif
         
 	return Finder;
@@ -0,0 +1,553 @@
+/****************************************************************************************/
+/*  JEAABBTREE.CPP                                                                      */
+/*                                                                                      */
+/*  Author: Styx3D Modernization                                                        */
+/*  Description: Dynamic bounding box tree for broad-phase queries                      */
+/*                                                                                      */
+/*  The contents of this file are subject to the 0BSD License.                          */
+/*  See LICENSE file in the project root for full license information.                  */
+/*                                                                                      */
+/****************************************************************************************/
+#include <assert.h>
+
+#include "jeAABBTree.h"
+#include "Ram.h"
+
+#define JE_AABBTREE_START_NODES		16
+#define JE_AABBTREE_QUERY_STACK		128		// Balanced, so depth stays far below this
+
+#define MIN(aa,bb)   ( ((aa)<(bb))?(aa):(bb) )
+#define MAX(aa,bb)   ( ((aa)>(bb))?(aa):(bb) )
+
+//	Nodes live in one array and refer to each other by index, so growing the array
+//	never leaves a dangling pointer.  Free nodes are chained through Parent.
+typedef struct
+{
+	jeExtBox		Box;			// Fattened box for leaves, union of children otherwise
+	void			*UserData;
+	int32			Parent;			// Next free node when on the free list
+	int32			Child1;
+	int32			Child2;			// JE_AABBTREE_NULL for leaves
+	int32			Height;			// 0 for leaves, -1 when free
+} jeAABBTree_Node;
+
+typedef struct jeAABBTree
+{
+	jeAABBTree_Node	*Nodes;
+	int32			NodeCount;
+	int32			NodeCapacity;
+	int32			FreeList;
+	int32			Root;
+	int32			ProxyCount;
+	jeFloat			Margin;
+} jeAABBTree;
+
+//========================================================================================
+//	Box helpers
+//========================================================================================
+static jeFloat jeAABBTree_Perimeter(const jeExtBox *B)
+{
+	return (B->Max.X - B->Min.X) + (B->Max.Y - B->Min.Y) + (B->Max.Z - B->Min.Z);
+}
+
+static void jeAABBTree_Combine(const jeExtBox *B1, const jeExtBox *B2, jeExtBox *Out)
+{
+	Out->Min.X = MIN(B1->Min.X, B2->Min.X);
+	Out->Min.Y = MIN(B1->Min.Y, B2->Min.Y);
+	Out->Min.Z = MIN(B1->Min.Z, B2->Min.Z);
+	Out->Max.X = MAX(B1->Max.X, B2->Max.X);
+	Out->Max.Y = MAX(B1->Max.Y, B2->Max.Y);
+	Out->Max.Z = MAX(B1->Max.Z, B2->Max.Z);
+}
+
+static jeBoolean jeAABBTree_Contains(const jeExtBox *Outer, const jeExtBox *Inner)
+{
+	return	Outer->Min.X <= Inner->Min.X && Outer->Min.Y <= Inner->Min.Y && Outer->Min.Z <= Inner->Min.Z &&
+			Outer->Max.X >= Inner->Max.X && Outer->Max.Y >= Inner->Max.Y && Outer->Max.Z >= Inner->Max.Z;
+}
+
+static jeBoolean jeAABBTree_Overlaps(const jeExtBox *B1, const jeExtBox *B2)
+{
+	return	B1->Min.X <= B2->Max.X && B1->Max.X >= B2->Min.X &&
+			B1->Min.Y <= B2->Max.Y && B1->Max.Y >= B2->Min.Y &&
+			B1->Min.Z <= B2->Max.Z && B1->Max.Z >= B2->Min.Z;
+}
+
+//========================================================================================
+//	Node pool
+//========================================================================================
+static int32 jeAABBTree_AllocateNode(jeAABBTree *Tree)
+{
+	int32			i;
+	jeAABBTree_Node	*Node;
+
+	if (Tree->FreeList == JE_AABBTREE_NULL)
+	{
+		jeAABBTree_Node	*NewNodes;
+		int32			NewCapacity;
+
+		NewCapacity = Tree->NodeCapacity ? Tree->NodeCapacity * 2 : JE_AABBTREE_START_NODES;
+		NewNodes = (jeAABBTree_Node *)jeRam_Realloc(Tree->Nodes, NewCapacity * sizeof(jeAABBTree_Node));
+
+		if (!NewNodes)
+			return JE_AABBTREE_NULL;
+
+		Tree->Nodes = NewNodes;
+
+		for (i = Tree->NodeCapacity; i < NewCapacity; i++)
+		{
+			Tree->Nodes[i].Parent = (i + 1 < NewCapacity) ? i + 1 : JE_AABBTREE_NULL;
+			Tree->Nodes[i].Height = -1;
+		}
+
+		Tree->FreeList = Tree->NodeCapacity;
+		Tree->NodeCapacity = NewCapacity;
+	}
+
+	i = Tree->FreeList;
+	Node = &Tree->Nodes[i];
+	Tree->FreeList = Node->Parent;
+
+	Node->UserData = NULL;
+	Node->Parent = JE_AABBTREE_NULL;
+	Node->Child1 = JE_AABBTREE_NULL;
+	Node->Child2 = JE_AABBTREE_NULL;
+	Node->Height = 0;
+
+	Tree->NodeCount++;
+
+	return i;
+}
+
+static void jeAABBTree_FreeNode(jeAABBTree *Tree, int32 i)
+{
+	assert(i >= 0 && i < Tree->NodeCapacity);
+	assert(Tree->NodeCount > 0);
+
+	Tree->Nodes[i].Parent = Tree->FreeList;
+	Tree->Nodes[i].Height = -1;
+	Tree->FreeList = i;
+	Tree->NodeCount--;
+}
+
+//========================================================================================
+//	Balancing
+//	If A is imbalanced, rotate the taller child up.  Returns the new subtree root.
+//========================================================================================
+static int32 jeAABBTree_Balance(jeAABBTree *Tree, int32 iA)
+{
+	jeAABBTree_Node	*N = Tree->Nodes;
+	jeAABBTree_Node	*A = &N[iA];
+	int32			iB, iC, Balance;
+
+	if (A->Child2 == JE_AABBTREE_NULL || A->Height < 2)
+		return iA;
+
+	iB = A->Child1;
+	iC = A->Child2;
+	Balance = N[iC].Height - N[iB].Height;
+
+	if (Balance > 1)
+	{
+		// Rotate C up
+		jeAABBTree_Node	*B = &N[iB];
+		jeAABBTree_Node	*C = &N[iC];
+		int32			iF = C->Child1;
+		int32			iG = C->Child2;
+
+		C->Child1 = iA;
+		C->Parent = A->Parent;
+		A->Parent = iC;
+
+		if (C->Parent != JE_AABBTREE_NULL)
+		{
+			if (N[C->Parent].Child1 == iA)
+				N[C->Parent].Child1 = iC;
+			else
+				N[C->Parent].Child2 = iC;
+		}
+		else
+			Tree->Root = iC;
+
+		if (N[iF].Height > N[iG].Height)
+		{
+			C->Child2 = iF;
+			A->Child2 = iG;
+			N[iG].Parent = iA;
+		}
+		else
+		{
+			C->Child2 = iG;
+			A->Child2 = iF;
+			N[iF].Parent = iA;
+		}
+
+		jeAABBTree_Combine(&B->Box, &N[A->Child2].Box, &A->Box);
+		jeAABBTree_Combine(&A->Box, &N[C->Child2].Box, &C->Box);
+		A->Height = 1 + MAX(B->Height, N[A->Child2].Height);
+		C->Height = 1 + MAX(A->Height, N[C->Child2].Height);
+
+		return iC;
+	}
+
+	if (Balance < -1)
+	{
+		// Rotate B up
+		jeAABBTree_Node	*B = &N[iB];
+		jeAABBTree_Node	*C = &N[iC];
+		int32			iD = B->Child1;
+		int32			iE = B->Child2;
+
+		B->Child1 = iA;
+		B->Parent = A->Parent;
+		A->Parent = iB;
+
+		if (B->Parent != JE_AABBTREE_NULL)
+		{
+			if (N[B->Parent].Child1 == iA)
+				N[B->Parent].Child1 = iB;
+			else
+				N[B->Parent].Child2 = iB;
+		}
+		else
+			Tree->Root = iB;
+
+		if (N[iD].Height > N[iE].Height)
+		{
+			B->Child2 = iD;
+			A->Child1 = iE;
+			N[iE].Parent = iA;
+		}
+		else
+		{
+			B->Child2 = iE;
+			A->Child1 = iD;
+			N[iD].Parent = iA;
+		}
+
+		jeAABBTree_Combine(&C->Box, &N[A->Child1].Box, &A->Box);
+		jeAABBTree_Combine(&A->Box, &N[B->Child2].Box, &B->Box);
+		A->Height = 1 + MAX(C->Height, N[A->Child1].Height);
+		B->Height = 1 + MAX(A->Height, N[B->Child2].Height);
+
+		return iB;
+	}
+
+	return iA;
+}
+
+// Walks from i to the root refitting boxes and heights, balancing on the way
+static void jeAABBTree_Refit(jeAABBTree *Tree, int32 i)
+{
+	while (i != JE_AABBTREE_NULL)
+	{
+		jeAABBTree_Node	*Node;
+
+		i = jeAABBTree_Balance(Tree, i);
+		Node = &Tree->Nodes[i];
+
+		jeAABBTree_Combine(&Tree->Nodes[Node->Child1].Box, &Tree->Nodes[Node->Child2].Box, &Node->Box);
+		Node->Height = 1 + MAX(Tree->Nodes[Node->Child1].Height, Tree->Nodes[Node->Child2].Height);
+
+		i = Node->Parent;
+	}
+}
+
+//========================================================================================
+//	Leaf insertion / removal
+//========================================================================================
+static jeBoolean jeAABBTree_InsertLeaf(jeAABBTree *Tree, int32 Leaf)
+{
+	jeExtBox		LeafBox;
+	int32			Sibling, OldParent, NewParent;
+
+	if (Tree->Root == JE_AABBTREE_NULL)
+	{
+		Tree->Root = Leaf;
+		Tree->Nodes[Leaf].Parent = JE_AABBTREE_NULL;
+		return JE_TRUE;
+	}
+
+	// Allocate first: it may move Nodes
+	NewParent = jeAABBTree_AllocateNode(Tree);
+
+	if (NewParent == JE_AABBTREE_NULL)
+		return JE_FALSE;
+
+	LeafBox = Tree->Nodes[Leaf].Box;
+
+	// Descend by the surface area heuristic
+	Sibling = Tree->Root;
+
+	while (Tree->Nodes[Sibling].Child2 != JE_AABBTREE_NULL)
+	{
+		const jeAABBTree_Node	*Node = &Tree->Nodes[Sibling];
+		const jeAABBTree_Node	*C1 = &Tree->Nodes[Node->Child1];
+		const jeAABBTree_Node	*C2 = &Tree->Nodes[Node->Child2];
+		jeExtBox				Combined;
+		jeFloat					Area, Cost, Inherit, Cost1, Cost2;
+
+		Area = jeAABBTree_Perimeter(&Node->Box);
+		jeAABBTree_Combine(&Node->Box, &LeafBox, &Combined);
+
+		// Cost of pairing with this node, and the cost pushed down to either child
+		Cost = 2.0f * jeAABBTree_Perimeter(&Combined);
+		Inherit = 2.0f * (jeAABBTree_Perimeter(&Combined) - Area);
+
+		jeAABBTree_Combine(&C1->Box, &LeafBox, &Combined);
+		Cost1 = jeAABBTree_Perimeter(&Combined) + Inherit;
+		if (C1->Child2 != JE_AABBTREE_NULL)
+			Cost1 -= jeAABBTree_Perimeter(&C1->Box);
+
+		jeAABBTree_Combine(&C2->Box, &LeafBox, &Combined);
+		Cost2 = jeAABBTree_Perimeter(&Combined) + Inherit;
+		if (C2->Child2 != JE_AABBTREE_NULL)
+			Cost2 -= jeAABBTree_Perimeter(&C2->Box);
+
+		if (Cost < Cost1 && Cost < Cost2)
+			break;
+
+		Sibling = (Cost1 < Cost2) ? Node->Child1 : Node->Child2;
+	}
+
+	OldParent = Tree->Nodes[Sibling].Parent;
+
+	Tree->Nodes[NewParent].Parent = OldParent;
+	Tree->Nodes[NewParent].Child1 = Sibling;
+	Tree->Nodes[NewParent].Child2 = Leaf;
+	Tree->Nodes[Sibling].Parent = NewParent;
+	Tree->Nodes[Leaf].Parent = NewParent;
+
+	if (OldParent != JE_AABBTREE_NULL)
+	{
+		if (Tree->Nodes[OldParent].Child1 == Sibling)
+			Tree->Nodes[OldParent].Child1 = NewParent;
+		else
+			Tree->Nodes[OldParent].Child2 = NewParent;
+	}
+	else
+		Tree->Root = NewParent;
+
+	jeAABBTree_Refit(Tree, NewParent);
+
+	return JE_TRUE;
+}
+
+static void jeAABBTree_RemoveLeaf(jeAABBTree *Tree, int32 Leaf)
+{
+	int32		Parent, GrandParent, Sibling;
+
+	if (Leaf == Tree->Root)
+	{
+		Tree->Root = JE_AABBTREE_NULL;
+		return;
+	}
+
+	Parent = Tree->Nodes[Leaf].Parent;
+	GrandParent = Tree->Nodes[Parent].Parent;
+	Sibling = (Tree->Nodes[Parent].Child1 == Leaf) ? Tree->Nodes[Parent].Child2 : Tree->Nodes[Parent].Child1;
+
+	if (GrandParent != JE_AABBTREE_NULL)
+	{
+		if (Tree->Nodes[GrandParent].Child1 == Parent)
+			Tree->Nodes[GrandParent].Child1 = Sibling;
+		else
+			Tree->Nodes[GrandParent].Child2 = Sibling;
+
+		Tree->Nodes[Sibling].Parent = GrandParent;
+		jeAABBTree_FreeNode(Tree, Parent);
+
+		jeAABBTree_Refit(Tree, GrandParent);
+	}
+	else
+	{
+		Tree->Root = Sibling;
+		Tree->Nodes[Sibling].Parent = JE_AABBTREE_NULL;
+		jeAABBTree_FreeNode(Tree, Parent);
+	}
+}
+
+static void jeAABBTree_FattenBox(const jeAABBTree *Tree, const jeExtBox *Box, jeExtBox *Out)
+{
+	Out->Min.X = Box->Min.X - Tree->Margin;
+	Out->Min.Y = Box->Min.Y - Tree->Margin;
+	Out->Min.Z = Box->Min.Z - Tree->Margin;
+	Out->Max.X = Box->Max.X + Tree->Margin;
+	Out->Max.Y = Box->Max.Y + Tree->Margin;
+	Out->Max.Z = Box->Max.Z + Tree->Margin;
+}
+
+//========================================================================================
+//	jeAABBTree_Create
+//========================================================================================
+jeAABBTree *jeAABBTree_Create(jeFloat Margin)
+{
+	jeAABBTree	*Tree;
+
+	assert(Margin >= 0.0f);
+
+	Tree = JE_RAM_ALLOCATE_STRUCT_CLEAR(jeAABBTree);
+
+	if (!Tree)
+		return NULL;
+
+	Tree->FreeList = JE_AABBTREE_NULL;
+	Tree->Root = JE_AABBTREE_NULL;
+	Tree->Margin = Margin;
+
+	return Tree;
+}
+
+//========================================================================================
+//	jeAABBTree_Destroy
+//========================================================================================
+void jeAABBTree_Destroy(jeAABBTree **pTree)
+{
+	jeAABBTree	*Tree;
+
+	assert(pTree);
+
+	Tree = *pTree;
+
+	if (!Tree)
+		return;
+
+	if (Tree->Nodes)
+		jeRam_Free(Tree->Nodes);
+
+	jeRam_Free(Tree);
+	*pTree = NULL;
+}
+
+//========================================================================================
+//	jeAABBTree_CreateProxy
+//========================================================================================
+int32 jeAABBTree_CreateProxy(jeAABBTree *Tree, const jeExtBox *Box, void *UserData)
+{
+	int32		Proxy;
+
+	assert(Tree);
+	assert(Box);
+
+	Proxy = jeAABBTree_AllocateNode(Tree);
+
+	if (Proxy == JE_AABBTREE_NULL)
+		return JE_AABBTREE_NULL;
+
+	jeAABBTree_FattenBox(Tree, Box, &Tree->Nodes[Proxy].Box);
+	Tree->Nodes[Proxy].UserData = UserData;
+
+	if (!jeAABBTree_InsertLeaf(Tree, Proxy))
+	{
+		jeAABBTree_FreeNode(Tree, Proxy);
+		return JE_AABBTREE_NULL;
+	}
+
+	Tree->ProxyCount++;
+
+	return Proxy;
+}
+
+//========================================================================================
+//	jeAABBTree_DestroyProxy
+//========================================================================================
+void jeAABBTree_DestroyProxy(jeAABBTree *Tree, int32 Proxy)
+{
+	assert(Tree);
+	assert(Proxy >= 0 && Proxy < Tree->NodeCapacity);
+	assert(Tree->Nodes[Proxy].Height == 0);
+
+	jeAABBTree_RemoveLeaf(Tree, Proxy);
+	jeAABBTree_FreeNode(Tree, Proxy);
+
+	Tree->ProxyCount--;
+}
+
+//========================================================================================
+//	jeAABBTree_MoveProxy
+//========================================================================================
+jeBoolean jeAABBTree_MoveProxy(jeAABBTree *Tree, int32 Proxy, const jeExtBox *Box)
+{
+	assert(Tree);
+	assert(Box);
+	assert(Proxy >= 0 && Proxy < Tree->NodeCapacity);
+	assert(Tree->Nodes[Proxy].Height == 0);
+
+	if (jeAABBTree_Contains(&Tree->Nodes[Proxy].Box, Box))
+		return JE_TRUE;
+
+	jeAABBTree_RemoveLeaf(Tree, Proxy);
+	jeAABBTree_FattenBox(Tree, Box, &Tree->Nodes[Proxy].Box);
+
+	// Removing the leaf released its parent node, so re-inserting can't run out of memory
+	if (!jeAABBTree_InsertLeaf(Tree, Proxy))
+	{
+		assert(0);
+		return JE_FALSE;
+	}
+
+	return JE_TRUE;
+}
+
+//========================================================================================
+//	jeAABBTree_GetUserData
+//========================================================================================
+void *jeAABBTree_GetUserData(const jeAABBTree *Tree, int32 Proxy)
+{
+	assert(Tree);
+	assert(Proxy >= 0 && Proxy < Tree->NodeCapacity);
+
+	return Tree->Nodes[Proxy].UserData;
+}
+
+//========================================================================================
+//	jeAABBTree_GetProxyCount
+//========================================================================================
+int32 jeAABBTree_GetProxyCount(const jeAABBTree *Tree)
+{
+	assert(Tree);
+
+	return Tree->ProxyCount;
+}
+
+//========================================================================================
+//	jeAABBTree_Query
+//	Walks with a fixed stack buffer rather than any tree state, so concurrent queries
+//	on the same tree are safe.  An AVL-balanced tree deep enough to overflow it would
+//	need more leaves than memory can hold.
+//========================================================================================
+void jeAABBTree_Query(const jeAABBTree *Tree, const jeExtBox *Box, jeAABBTree_QueryCB CB, void *Context)
+{
+	int32		Stack[JE_AABBTREE_QUERY_STACK];
+	int32		Count = 0;
+
+	assert(Tree);
+	assert(Box);
+	assert(CB);
+
+	if (Tree->Root == JE_AABBTREE_NULL)
+		return;
+
+	Stack[Count++] = Tree->Root;
+
+	while (Count > 0)
+	{
+		const jeAABBTree_Node	*Node = &Tree->Nodes[Stack[--Count]];
+
+		if (!jeAABBTree_Overlaps(&Node->Box, Box))
+			continue;
+
+		if (Node->Child2 == JE_AABBTREE_NULL)
+		{
+			if (!CB((int32)(Node - Tree->Nodes), Node->UserData, Context))
+				return;
+
+			continue;
+		}
+
+		assert(Count + 2 <= JE_AABBTREE_QUERY_STACK);
+
+		Stack[Count++] = Node->Child1;
+		Stack[Count++] = Node->Child2;
+	}
+}
@@ -0,0 +1,52 @@
+/****************************************************************************************/
+/*  JEAABBTREE.H                                                                        */
+/*                                                                                      */
+/*  Author: Styx3D Modernization                                                        */
+/*  Description: Dynamic bounding box tree for broad-phase queries                      */
+/*                                                                                      */
+/*  The contents of this file are subject to the 0BSD License.                          */
+/*  See LICENSE file in the project root for full license information.                  */
+/*                                                                                      */
+/****************************************************************************************/
+#ifndef JE_AABBTREE_H
+#define JE_AABBTREE_H
+
+#include "BaseType.h"
+#include "ExtBox.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//	Each proxy is stored as a leaf holding its box grown by Margin on every side.
+//	MoveProxy only touches the tree when the new box leaves that fattened box, so
+//	objects that jitter or move slowly cost nothing to update.  Query may report
+//	proxies whose real box does not touch the query box; callers do the exact test.
+
+typedef struct jeAABBTree		jeAABBTree;
+
+#define JE_AABBTREE_NULL		(-1)
+
+// Return JE_FALSE to stop the query early
+typedef jeBoolean (*jeAABBTree_QueryCB)(int32 Proxy, void *UserData, void *Context);
+
+jeAABBTree	*jeAABBTree_Create(jeFloat Margin);
+void		jeAABBTree_Destroy(jeAABBTree **pTree);
+
+// Returns JE_AABBTREE_NULL when out of memory
+int32		jeAABBTree_CreateProxy(jeAABBTree *Tree, const jeExtBox *Box, void *UserData);
+void		jeAABBTree_DestroyProxy(jeAABBTree *Tree, int32 Proxy);
+// Never needs new nodes; returns JE_FALSE only if the tree is corrupt
+jeBoolean	jeAABBTree_MoveProxy(jeAABBTree *Tree, int32 Proxy, const jeExtBox *Box);
+
+void		*jeAABBTree_GetUserData(const jeAABBTree *Tree, int32 Proxy);
+int32		jeAABBTree_GetProxyCount(const jeAABBTree *Tree);
+
+// Calls CB for every proxy whose fattened box overlaps Box
+void		jeAABBTree_Query(const jeAABBTree *Tree, const jeExtBox *Box, jeAABBTree_QueryCB CB, void *Context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -854,6 +854,13 @@ jeBoolean jeMaterial_ArraySetEngine(jeMaterial_Array *Array, jeEngine *Engine)
 			continue;
 		}
 
+		// Specs read by a background load still need their textures
+		if (!jeMaterialSpec_SetEngine(Material->MatSpec, Engine))
+		{
+			jeErrorLog_AddString(-1, "jeMaterial_ArraySetEngine:  jeMaterialSpec_SetEngine failed.", NULL);
+			return JE_FALSE;
+		}
+
 		pBitmap = jeMaterialSpec_GetLayerBitmap(Material->MatSpec, 0);
 		// nothing to do if spec uses jeTexture
 		if (pBitmap) {
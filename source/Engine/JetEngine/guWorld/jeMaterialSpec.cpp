@@ -70,6 +70,7 @@ JETAPI jeMaterialSpec * JETCC jeMaterialSpec_Create(jeEngine* pEngine, jeResourc
 
 	ZeroMem(MaterialSpec);
 	MaterialSpec->pEngine = pEngine;
+	MaterialSpec->pResMgr = pResourceMgr ? pResourceMgr : jeResourceMgr_GetSingleton();
 
 	MaterialSpec->RefCnt = 1;
 
@@ -99,9 +100,9 @@ JETAPI void JETCC jeMaterialSpec_Destroy(jeMaterialSpec **MaterialSpec)
 			if (pMatSpec->pLayers[idx]) {
 				if (pMatSpec->pLayers[idx]->Kind == JE_RESOURCE_BITMAP) {
 					jeBitmap_Destroy(&pMatSpec->pLayers[idx]->pBitmap);
-					jeResource_Delete(jeResourceMgr_GetSingleton(), pMatSpec->pLayers[idx]->Name);
+					jeResource_Delete(pMatSpec->pResMgr, pMatSpec->pLayers[idx]->Name);
 				} else {
-					jeResource_ReleaseResource(jeResourceMgr_GetSingleton(), pMatSpec->pLayers[idx]->Kind, pMatSpec->pLayers[idx]->Name);
+					jeResource_ReleaseResource(pMatSpec->pResMgr, pMatSpec->pLayers[idx]->Kind, pMatSpec->pLayers[idx]->Name);
 				}
 
 				jeRam_Free(pMatSpec->pLayers[idx]);
@@ -117,6 +118,49 @@ JETAPI void JETCC jeMaterialSpec_Destroy(jeMaterialSpec **MaterialSpec)
 	}
 }
 
+//=======================================================================================
+//	jeMaterialSpec_SetEngine
+//	Finishes the layers of a spec loaded without an engine: creates its textures through
+//	the spec's own resource manager and attaches the bitmaps AddLayerFromFile would have
+//	attached.  Render thread only.
+//=======================================================================================
+JETAPI jeBoolean JETCC jeMaterialSpec_SetEngine(jeMaterialSpec* MatSpec, jeEngine* pEngine)
+{
+	int idx;
+
+	assert(MatSpec);
+	assert(pEngine);
+
+	if (MatSpec->pEngine) {
+		return JE_TRUE;
+	}
+
+	MatSpec->pEngine = pEngine;
+
+	for (idx=0; idx<MatSpec->LayerCounts; idx++) {
+		jeMaterialSpec_Layer* pLayer = MatSpec->pLayers[idx];
+
+		if (!pLayer || !pLayer->Deferred) {
+			continue;
+		}
+
+		pLayer->Deferred = JE_FALSE;
+
+		if (pLayer->Kind == JE_RESOURCE_BITMAP) {
+			if (!jeEngine_AddBitmap(pEngine, pLayer->pBitmap, JE_ENGINE_BITMAP_TYPE_3D)) {
+				return JE_FALSE;
+			}
+		} else {
+			pLayer->pTexture = (jeTexture*) jeResource_GetResource(MatSpec->pResMgr, pLayer->Kind, pLayer->Name);
+			if (!pLayer->pTexture) {
+				return JE_FALSE;
+			}
+		}
+	}
+
+	return JE_TRUE;
+}
+
 #define MAKEFOURCC(ch0, ch1, ch2, ch3)                              \
 		((uint32)(uint8)(ch0) | ((uint32)(uint8)(ch1) << 8) |   \
 		((uint32)(uint8)(ch2) << 16) | ((uint32)(uint8)(ch3) << 24 ))
@@ -144,6 +188,7 @@ JETAPI jeMaterialSpec* JETCC jeMaterialSpec_CreateFromFile(jeVFile *VFile, jeEng
 	ZeroMem(MaterialSpec);
 
 	MaterialSpec->pEngine = pEngine;
+	MaterialSpec->pResMgr = ResMgr ? ResMgr : jeResourceMgr_GetSingleton();
 	MaterialSpec->RefCnt = 1;
 	MaterialSpec->Height = MaterialSpec->Width = 0;
 
@@ -214,7 +259,7 @@ JETAPI jeMaterialSpec* JETCC jeMaterialSpec_CreateFromFile(jeVFile *VFile, jeEng
 		if (!jeVFile_Read(VFile, ShaderName, JE_MATERIAL_MAX_NAME_SIZE)) {
 			goto ExitInError;
 		}
-		MaterialSpec->pShader = (jeShader*) jeResource_GetResource(jeResourceMgr_GetSingleton(), JE_RESOURCE_SHADER, ShaderName);
+		MaterialSpec->pShader = (jeShader*) jeResource_GetResource(MaterialSpec->pResMgr, JE_RESOURCE_SHADER, ShaderName);
 	}
 
 	if (MaterialSpec->Flags&MATSPEC_SIZE_FLAG) {
@@ -224,7 +269,7 @@ JETAPI jeMaterialSpec* JETCC jeMaterialSpec_CreateFromFile(jeVFile *VFile, jeEng
 
 	// Read the layer descriptions
 	for (Version=0; Version<MaterialSpec->LayerCounts; Version++) {
-		jeMaterialSpec_Layer* pLayer = JE_RAM_ALLOCATE_STRUCT(jeMaterialSpec_Layer);
+		jeMaterialSpec_Layer* pLayer = JE_RAM_ALLOCATE_STRUCT_CLEAR(jeMaterialSpec_Layer);
 		jeXForm3d_SetIdentity(&pLayer->XForm);
 
 		// Read the resource type
@@ -247,8 +292,13 @@ JETAPI jeMaterialSpec* JETCC jeMaterialSpec_CreateFromFile(jeVFile *VFile, jeEng
 			goto ExitInError;
 		}
 
-		// Create the texture from the resource manager
-		pLayer->pTexture = (jeTexture*) jeResource_GetResource(jeResourceMgr_GetSingleton(), pLayer->Kind, pLayer->Name);
+		// Create the texture from the resource manager.  Textures live in the driver, so
+		// without an engine (a world loading on another thread) they wait for SetEngine.
+		if (pLayer->Kind != JE_RESOURCE_BITMAP && !pEngine) {
+			pLayer->Deferred = JE_TRUE;
+		} else {
+			pLayer->pTexture = (jeTexture*) jeResource_GetResource(MaterialSpec->pResMgr, pLayer->Kind, pLayer->Name);
+		}
 
 		if (!jeVFile_Read(VFile, &pLayer->XForm, sizeof(pLayer->XForm))) {
 			goto ExitInError;
@@ -281,7 +331,7 @@ JETAPI jeMaterialSpec* JETCC jeMaterialSpec_CreateFromFile(jeVFile *VFile, jeEng
 		}
 	}
 
-	if (MaterialSpec->Height == 0 || MaterialSpec->Width == 0) {
+	if ((MaterialSpec->Height == 0 || MaterialSpec->Width == 0) && !MaterialSpec->pLayers[0]->Deferred) {
 		jeMaterialSpec_Layer* pLayer;
 
 		// calc the with and height from layers
@@ -463,7 +513,11 @@ JETAPI jeBoolean JETCC jeMaterialSpec_AddLayer(jeMaterialSpec* MatSpec, int32 la
 	pLayer->Kind = (uint16) Kind;
 	jeXForm3d_SetIdentity(&pLayer->XForm);
 
-	pLayer->pTexture = (jeTexture*) jeResource_GetResource(jeResourceMgr_GetSingleton(), pLayer->Kind, pLayer->Name);
+	if (pLayer->Kind != JE_RESOURCE_BITMAP && !MatSpec->pEngine) {
+		pLayer->Deferred = JE_TRUE;
+	} else {
+		pLayer->pTexture = (jeTexture*) jeResource_GetResource(MatSpec->pResMgr, pLayer->Kind, pLayer->Name);
+	}
 
 	if (pLayer->Kind == JE_RESOURCE_BITMAP) {
 		jeBitmap_CreateRef((jeBitmap*)pLayer->pTexture);
@@ -472,7 +526,7 @@ JETAPI jeBoolean JETCC jeMaterialSpec_AddLayer(jeMaterialSpec* MatSpec, int32 la
 	pLayer->Type = (uint8) layerType;
 	pLayer->UVMapID = (uint8) layerMapper;
 
-	if (pLayer->pTexture) {
+	if (pLayer->pTexture || pLayer->Deferred) {
 		return JE_TRUE;
 	}
 	return JE_FALSE;
@@ -706,7 +760,7 @@ JETAPI jeBoolean JETCC jeMaterialSpec_SetThumbnail(jeMaterialSpec* MatSpec, jeMa
 
 JETAPI uint32 JETCC jeMaterialSpec_Height(const jeMaterialSpec* MatSpec)
 {
-	if (MatSpec->Height == 0 || MatSpec->Width == 0) {
+	if ((MatSpec->Height == 0 || MatSpec->Width == 0) && !MatSpec->pLayers[0]->Deferred) {
 		jeMaterialSpec_Layer* pLayer;
 
 		// calc the with and height from layers
@@ -728,7 +782,7 @@ JETAPI uint32 JETCC jeMaterialSpec_Height(const jeMaterialSpec* MatSpec)
 
 JETAPI uint32 JETCC jeMaterialSpec_Width(const jeMaterialSpec* MatSpec)
 {
-	if (MatSpec->Height == 0 || MatSpec->Width == 0) {
+	if ((MatSpec->Height == 0 || MatSpec->Width == 0) && !MatSpec->pLayers[0]->Deferred) {
 		jeMaterialSpec_Layer* pLayer;
 
 		// calc the with and height from layers
@@ -756,16 +810,21 @@ JETAPI jeBoolean JETCC jeMaterialSpec_AddLayerFromFile(jeMaterialSpec* MatSpec,
 		return JE_FALSE;
 	}
 
-	MatSpec->pLayers[layerIndex] = JE_RAM_ALLOCATE_STRUCT(jeMaterialSpec_Layer);
+	MatSpec->pLayers[layerIndex] = JE_RAM_ALLOCATE_STRUCT_CLEAR(jeMaterialSpec_Layer);
 	if ((bmp = jeBitmap_CreateFromFile(File)) == NULL) {
-		MatSpec->pLayers[layerIndex]->pTexture = jeTexture_CreateFromFile(MatSpec->pEngine, File);
+		// There is no name to load a texture by later, so this one needs the engine now
+		if (MatSpec->pEngine)
+			MatSpec->pLayers[layerIndex]->pTexture = jeTexture_CreateFromFile(MatSpec->pEngine, File);
 		MatSpec->pLayers[layerIndex]->Kind = JE_RESOURCE_TEXTURE;
 	} else {
 		MatSpec->pLayers[layerIndex]->pTexture = (jeTexture*) bmp;
         jeBitmap_SetColorKey(bmp, UseColorKey, ColorKey, JE_TRUE);
 
         MatSpec->pLayers[layerIndex]->Kind = JE_RESOURCE_BITMAP;
-		jeEngine_AddBitmap(MatSpec->pEngine, bmp, JE_ENGINE_BITMAP_TYPE_3D);
+		if (MatSpec->pEngine)
+			jeEngine_AddBitmap(MatSpec->pEngine, bmp, JE_ENGINE_BITMAP_TYPE_3D);
+		else
+			MatSpec->pLayers[layerIndex]->Deferred = JE_TRUE;
 	}
 	if (MatSpec->pLayers[layerIndex]->pTexture==NULL) {
 		jeRam_Free(MatSpec->pLayers[layerIndex]);
@@ -787,7 +846,7 @@ JETAPI jeBoolean JETCC jeMaterialSpec_AddLayerFromBitmap(jeMaterialSpec* MatSpec
 	}
 
     // Store the bitmap in the Texture slot
-	MatSpec->pLayers[layerIndex] = JE_RAM_ALLOCATE_STRUCT(jeMaterialSpec_Layer);
+	MatSpec->pLayers[layerIndex] = JE_RAM_ALLOCATE_STRUCT_CLEAR(jeMaterialSpec_Layer);
 	MatSpec->pLayers[layerIndex]->pTexture = (jeTexture*) pBitmap;
 	MatSpec->pLayers[layerIndex]->Kind = JE_RESOURCE_BITMAP;
     // if trying to create a Material with a NULL bitmap
@@ -53,6 +53,12 @@ typedef struct jeUserPoly
 	jeLVertex			Verts[4];
 	jeFloat				Scale;				// Scale of sprite
 
+	// Type_SpriteArray, owned by the caller
+	const jeLVertex		*ArrayVerts;
+	const jeMaterialSpec * const *ArrayMaterials;
+	const jeFloat		*ArrayScales;
+	int32				ArrayCount;
+
 	int32				RefCount;
 } jeUserPoly;
 
@@ -62,6 +68,7 @@ typedef struct jeUserPoly
 static jeBoolean RenderQuad(const jeUserPoly *Poly, const jeEngine *Engine, const jeCamera *Camera, const jeFrustum *Frustum);
 static jeBoolean RenderTri(const jeUserPoly *Poly, const jeEngine *Engine, const jeCamera *Camera, const jeFrustum *Frustum);
 static jeBoolean RenderSprite(const jeUserPoly *Poly, const jeEngine *Engine, const jeCamera *Camera, const jeFrustum *Frustum);
+static jeBoolean RenderSpriteArray(const jeUserPoly *Poly, const jeEngine *Engine, const jeCamera *Camera, const jeFrustum *Frustum);
 static jeBoolean RenderLine(const jeUserPoly *Poly, const jeEngine *Engine, const jeCamera *Camera, const jeFrustum *Frustum);
 //========================================================================================
 //	jeUserPoly_CreateTri
@@ -222,6 +229,32 @@ JETAPI jeUserPoly * JETCC jeUserPoly_CreateLine(const jeLVertex *v1, const jeLVe
 	return Line;
 }
 
+//========================================================================================
+//	jeUserPoly_CreateSpriteArray
+//	Create a user poly that draws a caller supplied array of sprites
+//========================================================================================
+JETAPI jeUserPoly * JETCC jeUserPoly_CreateSpriteArray(uint32 Flags)
+{
+	jeUserPoly		*Sprites;
+
+	Sprites = JE_RAM_ALLOCATE_STRUCT(jeUserPoly);
+
+	if (!Sprites)
+		return NULL;
+
+	// Clear the memory
+	ZeroMem(Sprites);
+	
+	Sprites->RefCount = 1;
+
+	// Set the type
+	Sprites->Type = Type_SpriteArray;
+
+	Sprites->Flags = Flags;
+
+	return Sprites;
+}
+
 //========================================================================================
 //	jeUserPoly_IsValid
 //========================================================================================
@@ -356,6 +389,28 @@ JETAPI jeBoolean JETCC jeUserPoly_UpdateLine(jeUserPoly *Poly, const jeLVertex *
 	return JE_TRUE;
 }
 
+//========================================================================================
+//	jeUserPoly_UpdateSpriteArray
+//========================================================================================
+JETAPI jeBoolean JETCC jeUserPoly_UpdateSpriteArray(	jeUserPoly *Poly, 
+													const jeLVertex *Verts, 
+													const jeMaterialSpec * const *Materials, 
+													const jeFloat *Scales, 
+													int32 Count)
+{
+	assert(jeUserPoly_IsValid(Poly) == JE_TRUE);
+	assert(Poly->Type == Type_SpriteArray);
+	assert(Count >= 0);
+	assert(Count == 0 || (Verts && Materials && Scales));
+
+	Poly->ArrayVerts = Verts;
+	Poly->ArrayMaterials = Materials;
+	Poly->ArrayScales = Scales;
+	Poly->ArrayCount = Count;
+
+	return JE_TRUE;
+}
+
 //========================================================================================
 //	jeUserPoly_Render
 //========================================================================================
@@ -378,6 +433,9 @@ JETAPI jeBoolean JETCC jeUserPoly_Render(const jeUserPoly *Poly, const jeEngine
 		case Type_Sprite:
 			return RenderSprite(Poly, Engine, Camera, Frustum);
 
+		case Type_SpriteArray:
+			return RenderSpriteArray(Poly, Engine, Camera, Frustum);
+
 		case Type_Line:
 			return RenderLine(Poly, Engine, Camera, Frustum);
 
@@ -467,9 +525,19 @@ static jeBoolean RenderQuad(const jeUserPoly *Poly, const jeEngine *Engine, cons
 }
 
 //========================================================================================
-//	RenderSprite
+//	RenderSpriteVert
+//	Builds the camera facing quad around Vert and renders it.  CamLeft/CamUp are the
+//	unscaled camera axes.
 //========================================================================================
-static jeBoolean RenderSprite(const jeUserPoly *Poly, const jeEngine *Engine, const jeCamera *Camera, const jeFrustum *Frustum)
+static jeBoolean RenderSpriteVert(	const jeLVertex *Vert, 
+									const jeMaterialSpec *Material, 
+									jeFloat Scale, 
+									uint32 Flags, 
+									const jeVec3d *CamLeft, 
+									const jeVec3d *CamUp, 
+									const jeEngine *Engine, 
+									const jeCamera *Camera, 
+									const jeFrustum *Frustum)
 {
 	jeFrustum_LClipInfo		ClipInfo;
 	jeLVertex				Work1[JE_USERPOLY_MAX_CLIPVERTS], Work2[JE_USERPOLY_MAX_CLIPVERTS];
@@ -477,18 +545,10 @@ static jeBoolean RenderSprite(const jeUserPoly *Poly, const jeEngine *Engine, co
 	jeLVertex				*pVerts;
 	jeVec3d					Up, Left, Start;
 	jeFloat					XScale, YScale, UShift, VShift;
-	const jeXForm3d			*MXForm;
-
-	assert(jeUserPoly_IsValid(Poly) == JE_TRUE);
-	assert(Engine);
-	assert(Camera);
-	assert(Frustum);
-	assert(Poly->Type == Type_Sprite);
-	assert(Frustum->NumPlanes <= JE_USERPOLY_MAX_CLIPPLANES);
 
 	pVerts = Work1;
 
-	pVerts[0] = pVerts[1] = pVerts[2] = pVerts[3] = Poly->Verts[0];
+	pVerts[0] = pVerts[1] = pVerts[2] = pVerts[3] = *Vert;
 
 	UShift = pVerts[0].u;
 	VShift = pVerts[0].v;
@@ -497,16 +557,11 @@ static jeBoolean RenderSprite(const jeUserPoly *Poly, const jeEngine *Engine, co
 	Start.Y = pVerts[0].Y;
 	Start.Z = pVerts[0].Z;
 
-	MXForm = jeCamera_WorldXForm(Camera);
+	XScale = (float)jeMaterialSpec_Width(Material) * Scale;
+	YScale = (float)jeMaterialSpec_Height(Material) * Scale;
 
-	jeXForm3d_GetLeft(MXForm, &Left);
-	jeXForm3d_GetUp(MXForm, &Up);
-
-	XScale = (float)jeMaterialSpec_Width(Poly->Material) * Poly->Scale;
-	YScale = (float)jeMaterialSpec_Height(Poly->Material) * Poly->Scale;
-
-	jeVec3d_Scale(&Left, XScale*0.2f, &Left);
-	jeVec3d_Scale(&Up, YScale*0.2f, &Up);
+	jeVec3d_Scale(CamLeft, XScale*0.2f, &Left);
+	jeVec3d_Scale(CamUp, YScale*0.2f, &Up);
 
 	pVerts->X = Start.X + Left.X + Up.X;
 	pVerts->Y = Start.Y + Left.Y + Up.Y;
@@ -554,7 +609,68 @@ static jeBoolean RenderSprite(const jeUserPoly *Poly, const jeEngine *Engine, co
 	jeCamera_TransformAndProjectAndClampLArray(Camera, ClipInfo.DstVerts, TLVerts, ClipInfo.NumDstVerts);
 
 	// Render it
-	jeEngine_RenderPoly(Engine, TLVerts, ClipInfo.NumDstVerts, Poly->Material, Poly->Flags);
+	jeEngine_RenderPoly(Engine, TLVerts, ClipInfo.NumDstVerts, Material, Flags);
+
+	return JE_TRUE;
+}
+
+//========================================================================================
+//	RenderSprite
+//========================================================================================
+static jeBoolean RenderSprite(const jeUserPoly *Poly, const jeEngine *Engine, const jeCamera *Camera, const jeFrustum *Frustum)
+{
+	jeVec3d					Up, Left;
+	const jeXForm3d			*MXForm;
+
+	assert(jeUserPoly_IsValid(Poly) == JE_TRUE);
+	assert(Engine);
+	assert(Camera);
+	assert(Frustum);
+	assert(Poly->Type == Type_Sprite);
+	assert(Frustum->NumPlanes <= JE_USERPOLY_MAX_CLIPPLANES);
+
+	MXForm = jeCamera_WorldXForm(Camera);
+
+	jeXForm3d_GetLeft(MXForm, &Left);
+	jeXForm3d_GetUp(MXForm, &Up);
+
+	return RenderSpriteVert(&Poly->Verts[0], Poly->Material, Poly->Scale, Poly->Flags, &Left, &Up, Engine, Camera, Frustum);
+}
+
+//========================================================================================
+//	RenderSpriteArray
+//	Same as RenderSprite for each element, with the camera axes fetched once.  Every sprite
+//	is still clipped and handed to jeEngine_RenderPoly on its own: the driver only takes
+//	one poly per RenderMiscTexturePoly call, so the array saves chain walks, not draw calls.
+//========================================================================================
+static jeBoolean RenderSpriteArray(const jeUserPoly *Poly, const jeEngine *Engine, const jeCamera *Camera, const jeFrustum *Frustum)
+{
+	jeVec3d					Up, Left;
+	const jeXForm3d			*MXForm;
+	int32					i;
+
+	assert(jeUserPoly_IsValid(Poly) == JE_TRUE);
+	assert(Engine);
+	assert(Camera);
+	assert(Frustum);
+	assert(Poly->Type == Type_SpriteArray);
+	assert(Frustum->NumPlanes <= JE_USERPOLY_MAX_CLIPPLANES);
+
+	if (Poly->ArrayCount <= 0)
+		return JE_TRUE;
+
+	MXForm = jeCamera_WorldXForm(Camera);
+
+	jeXForm3d_GetLeft(MXForm, &Left);
+	jeXForm3d_GetUp(MXForm, &Up);
+
+	for (i=0; i< Poly->ArrayCount; i++)
+	{
+		assert(Poly->ArrayMaterials[i]);		// For now, you need a bitmap
+
+		if (!RenderSpriteVert(&Poly->ArrayVerts[i], Poly->ArrayMaterials[i], Poly->ArrayScales[i], Poly->Flags, &Left, &Up, Engine, Camera, Frustum))
+			return JE_FALSE;
+	}
 
 	return JE_TRUE;
 }
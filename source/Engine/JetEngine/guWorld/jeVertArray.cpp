@@ -453,6 +453,38 @@ JETAPI const jeVec3d * JETCC jeVertArray_GetVertByIndex(const jeVertArray *VArra
 	return &Vert2->Vert;
 }
 
+//=======================================================================================
+//	jeVertArray_GatherVerts
+//=======================================================================================
+JETAPI void JETCC jeVertArray_GatherVerts(const jeVertArray *VArray, const jeVertArray_Index *Indices, int32 Count, jeVec3d *Dest, int32 DestStride)
+{
+	const jeVertArray_Vert	*Verts;
+	int32					i;
+
+	assert(jeVertArray_IsValid(VArray) == JE_TRUE);
+	assert(Indices);
+	assert(Dest);
+
+	Verts = VArray->Verts;
+
+	for (i=0; i< Count; i++)
+	{
+		const jeVertArray_Vert	*Vert2;
+
+		assert(Indices[i] >= 0 && Indices[i] < VArray->MaxVerts);
+		assert(Indices[i] != JE_VERTARRAY_NULL_INDEX);
+
+		Vert2 = &Verts[Indices[i]];
+		assert(Vert2->RefCount > 0);
+
+		Dest->X = Vert2->Vert.X;
+		Dest->Y = Vert2->Vert.Y;
+		Dest->Z = Vert2->Vert.Z;
+
+		Dest = (jeVec3d*)((uint8*)Dest + DestStride);
+	}
+}
+
 //=======================================================================================
 //	jeVertArray_GetMaxIndex
 //=======================================================================================
@@ -32,6 +32,9 @@
 #include <assert.h>
 #include <string.h>
 #include <stdlib.h> //free
+#include <math.h>
+#include <atomic>
+#include <new>
 
 #include "Dcommon.h"
 #include "Engine.h"
@@ -48,6 +51,8 @@
 #include "jeChain.h"
 #include "jePortal.h"
 #include "Util.h"			// Added by Icestorm [MLB-ICE]
+#include "jeAABBTree.h"
+#include "ThreadQueue.h"
 
 #include "jePtrMgr._h"
 #include "log.h"
@@ -79,6 +84,14 @@ void ProcUtil_Init(void);
 #define ZeroMem(a) memset(a, 0, sizeof(*a))
 #define ZeroMemArray(a, s) memset(a, 0, sizeof(*a)*s)
 
+#define MIN(aa,bb)   ( ((aa)<(bb))?(aa):(bb) )
+#define MAX(aa,bb)   ( ((aa)>(bb))?(aa):(bb) )
+
+#define JU_WORLD_START_COLLISION_ENTRIES	32
+#define JU_WORLD_COLLISION_MARGIN			16.0f	// Fattening of tree boxes, so small moves don't touch the tree
+#define JU_WORLD_COLLISION_QUERY_PAD		2.0f	// Slack for the epsilons objects use in their own collision tests
+#define JU_WORLD_COLLISION_LOCAL_CANDIDATES	128
+
 //========================================================================================
 //	Local static defines
 //========================================================================================
@@ -98,6 +111,37 @@ static jeBoolean jeWorld_ReadArrays(jeWorld *World, jeVFile *VFile, jePtrMgr *Pt
 static jeBoolean ReadLight(jeVFile *VFile, void **LinkData, void *Context, jePtrMgr *PtrMgr);
 static jeBoolean ReadPtrMgrVerification(jeVFile *VFile, const jePtrMgr *PtrMgr);
 
+// Context for ReadObjectTracked while a jeWorld_Loader reads the objects
+typedef struct
+{
+	jeWorld			*World;
+	jeWorld_Loader	*Loader;
+} jeWorld_LoaderReadContext;
+
+static jeWorld *jeWorld_CreateFromFileTracked(jeVFile *VFile, jePtrMgr *PtrMgr, jeResourceMgr *pResourceMgr, jeWorld_Loader *Loader);
+static jeWorld *jeWorld_CreateFromEditorFileTracked(const char* FileName, jePtrMgr *pPtrMgr, jeResourceMgr * pResourceMgr, jeWorld_Loader *Loader);
+static void jeWorld_LoaderTrack(jeWorld_Loader *Loader, jeVFile *VFile);
+static jeBoolean ReadObjectTracked(jeVFile *VFile, void **LinkData, void *Context, jePtrMgr *PtrMgr);
+
+//	Broad-phase collision index.  Every object in World->Objects has an entry.  Objects whose
+//	whole hierarchy is flagged JE_OBJECT_COLLIDE_IN_EXTBOX get a tree proxy around their
+//	GetExtBox; the rest are on the AlwaysCollide list and are tested by every query, exactly as
+//	before.  Queries visit candidates in chain order, so results match the plain loop.
+typedef struct
+{
+	jeObject		*Object;		// NULL when the entry is free
+	uint32			Order;			// Increases along World->Objects
+	int32			Proxy;			// Tree proxy, or JE_AABBTREE_NULL
+	jeBoolean		Always;			// On World->AlwaysCollide
+	int32			NextFree;
+	jeBoolean		CanCollide;		// jeWorld_CanCollide() of the object's type, kept up to date
+} jeWorld_CollisionEntry;
+
+static jeBoolean jeWorld_AddCollisionEntry(jeWorld *World, jeObject *Object);
+static void jeWorld_RemoveCollisionEntry(jeWorld *World, jeObject *Object);
+static void jeWorld_RefreshCollisionEntry(jeWorld *World, int32 Index);
+static void jeWorld_UpdateCollisionMask(jeWorld *World);
+
 
 typedef struct jeWorld
 {
@@ -121,6 +165,14 @@ typedef struct jeWorld
 	jeChain *CollisionObjectTypes; // Incarnadine
 	int32 CollisionLevel; // Incarnadine
 
+	jeAABBTree					*CollisionTree;
+	jeWorld_CollisionEntry		*CollisionEntries;
+	int32						*AlwaysCollide;			// Entries tested by every query, sorted by Order
+	int32						NumAlwaysCollide;
+	int32						MaxCollisionEntries;	// Allocated size of both arrays
+	int32						FreeCollisionEntry;
+	uint32						NextCollisionOrder;
+
 	// paradoxnj - Useless and incomplete
 	//jeChain						*ShaderChain; // Added by CyRiuS (Timothy Roff)
 	//jeChain						*ActorScriptChain; //Added by cyrius (Timothy Roff)
@@ -473,6 +525,13 @@ static jeWorld *jeWorld_CreateBase(jeResourceMgr *ResourceMgr)
 
 	jeWorld_SetCollisionLevel(World,COLLIDE_EXTBOX);	
 
+	World->CollisionTree = jeAABBTree_Create(JU_WORLD_COLLISION_MARGIN);
+
+	if (!World->CollisionTree)
+		goto ExitWithError;
+
+	World->FreeCollisionEntry = -1;
+
 	// paradoxnj - Useless and incomplete
 	// create the shader chain (cyrius)
 	/*World->ShaderChain = jeChain_Create();
@@ -550,6 +609,9 @@ static jeWorld *jeWorld_CreateBase(jeResourceMgr *ResourceMgr)
 			if(World->CollisionObjectTypes)
 				jeChain_Destroy(&World->CollisionObjectTypes);
 
+			if (World->CollisionTree)
+				jeAABBTree_Destroy(&World->CollisionTree);
+
 			// paradoxnj - Useless and incomplete
 			/*if(World->ShaderChain) //(cyrius)
 				jeChain_Destroy(&World->ShaderChain);
@@ -626,6 +688,15 @@ JETAPI jeWorld * JETCC jeWorld_Create(jeResourceMgr *pResourceMgr)
 //	jeWorld_CreateFromFile
 //========================================================================================
 JETAPI jeWorld * JETCC jeWorld_CreateFromFile(jeVFile *VFile, jePtrMgr *PtrMgr, jeResourceMgr *pResourceMgr)
+{
+	return jeWorld_CreateFromFileTracked(VFile, PtrMgr, pResourceMgr, nullptr);
+}
+
+//========================================================================================
+//	jeWorld_CreateFromFileTracked
+//	Loader, when not nullptr, gets progress reports as the file is read
+//========================================================================================
+static jeWorld *jeWorld_CreateFromFileTracked(jeVFile *VFile, jePtrMgr *PtrMgr, jeResourceMgr *pResourceMgr, jeWorld_Loader *Loader)
 {
 	jeWorld* World{};
 
@@ -663,6 +734,8 @@ JETAPI jeWorld * JETCC jeWorld_CreateFromFile(jeVFile *VFile, jePtrMgr *PtrMgr,
 	if (!jeWorld_ReadArrays(World, VFile, PtrMgr))
 		goto ExitWithError;
 
+	jeWorld_LoaderTrack(Loader, VFile);
+
 	// Load the lights off disk
 	World->LightChain = jeChain_CreateFromFile(VFile, ReadLight, nullptr, PtrMgr);
 
@@ -675,12 +748,34 @@ JETAPI jeWorld * JETCC jeWorld_CreateFromFile(jeVFile *VFile, jePtrMgr *PtrMgr,
 	if (!World->OldLights)
 		goto ExitWithError;
 
+	jeWorld_LoaderTrack(Loader, VFile);
+
 	// Load the objects off disk
-	World->Objects = jeChain_CreateFromFile(VFile, ReadObject, World, PtrMgr);
+	if (Loader)
+	{
+		jeWorld_LoaderReadContext	ReadContext;
+
+		ReadContext.World = World;
+		ReadContext.Loader = Loader;
+
+		World->Objects = jeChain_CreateFromFile(VFile, ReadObjectTracked, &ReadContext, PtrMgr);
+	}
+	else
+		World->Objects = jeChain_CreateFromFile(VFile, ReadObject, World, PtrMgr);
 
 	if (!World->Objects)
 		goto ExitWithError;
 
+	{
+		jeChain_Link	*Link;
+
+		for (Link = jeChain_GetFirstLink(World->Objects); Link; Link = jeChain_LinkGetNext(Link))
+		{
+			if (!jeWorld_AddCollisionEntry(World, (jeObject *)jeChain_LinkGetLinkData(Link)))
+				goto ExitWithError;
+		}
+	}
+
 	//if (!ReadPtrMgrVerification(VFile, PtrMgr))
 	//	goto ExitWithError;
 
@@ -829,6 +924,8 @@ JETAPI void JETCC jeWorld_Destroy(jeWorld **pWorld)
 				// jet object pointer
 				Object = (jeObject *)jeChain_LinkGetLinkData( Link );
 
+				jeWorld_RemoveCollisionEntry(World, Object);
+
 				// BEGIN - Proper destruction of objects - paradoxnj 5/9/2005
 				jeObject_RemoveChild(World->Model,Object);
 
@@ -883,6 +980,15 @@ JETAPI void JETCC jeWorld_Destroy(jeWorld **pWorld)
 			jeChain_Destroy( &( World->CollisionObjectTypes ) );
 		}
 
+		if (World->CollisionTree)
+			jeAABBTree_Destroy(&World->CollisionTree);
+
+		if (World->CollisionEntries)
+			jeRam_Free(World->CollisionEntries);
+
+		if (World->AlwaysCollide)
+			jeRam_Free(World->AlwaysCollide);
+
 
 		// paradoxnj - Useless and incomplete
 		// destroy all shaders -- CyRiuS
@@ -1400,6 +1506,300 @@ JETAPI jeBoolean JETCC jeWorld_RemoveUserPoly(jeWorld *World, jeUserPoly *Poly)
 	return JE_TRUE;
 }
 
+//========================================================================================
+//	Collision index
+//========================================================================================
+
+//========================================================================================
+//	jeWorld_IsCollisionBounded
+//	JE_TRUE if Object and all its children promise to collide only inside their ExtBox
+//	(objects without collision methods trivially do)
+//========================================================================================
+static jeBoolean jeWorld_IsCollisionBounded(const jeObject *Object)
+{
+	jeChain_Link	*Link;
+
+	if (!(Object->Methods->Flags & JE_OBJECT_COLLIDE_IN_EXTBOX) && (Object->Methods->Collision || Object->Methods->ChangeBoxCollision))
+		return JE_FALSE;
+
+	if (!Object->Children)
+		return JE_TRUE;
+
+	for (Link = jeChain_GetFirstLink(Object->Children); Link; Link = jeChain_LinkGetNext(Link))
+	{
+		if (!jeWorld_IsCollisionBounded((jeObject *)jeChain_LinkGetLinkData(Link)))
+			return JE_FALSE;
+	}
+
+	return JE_TRUE;
+}
+
+//========================================================================================
+//	jeWorld_GetCollisionBounds
+//	Unions the ExtBox of every object in the hierarchy that can collide.  *HasBounds is
+//	JE_FALSE when none of them can.  Returns JE_FALSE if some box is not available.
+//========================================================================================
+static jeBoolean jeWorld_GetCollisionBounds(const jeObject *Object, jeExtBox *Bounds, jeBoolean *HasBounds)
+{
+	jeChain_Link	*Link;
+
+	if (Object->Methods->Collision || Object->Methods->ChangeBoxCollision)
+	{
+		jeExtBox	Box;
+
+		if (!jeObject_GetExtBox(Object, &Box))
+			return JE_FALSE;
+
+		if (Box.Min.X > Box.Max.X || Box.Min.Y > Box.Max.Y || Box.Min.Z > Box.Max.Z)
+			return JE_FALSE;
+
+		if (*HasBounds)
+			jeExtBox_Union(Bounds, &Box, Bounds);
+		else
+			*Bounds = Box;
+
+		*HasBounds = JE_TRUE;
+	}
+
+	if (!Object->Children)
+		return JE_TRUE;
+
+	for (Link = jeChain_GetFirstLink(Object->Children); Link; Link = jeChain_LinkGetNext(Link))
+	{
+		if (!jeWorld_GetCollisionBounds((jeObject *)jeChain_LinkGetLinkData(Link), Bounds, HasBounds))
+			return JE_FALSE;
+	}
+
+	return JE_TRUE;
+}
+
+//========================================================================================
+//	jeWorld_SetAlwaysCollide
+//	Keeps AlwaysCollide in chain order so queries can merge it with the tree hits.  New
+//	objects have the highest Order, so the common case is an append.
+//========================================================================================
+static void jeWorld_SetAlwaysCollide(jeWorld *World, int32 Index, jeBoolean Always)
+{
+	jeWorld_CollisionEntry	*Entry = &World->CollisionEntries[Index];
+	int32					Lo, Hi;
+
+	if (Entry->Always == Always)
+		return;
+
+	Lo = 0;
+	Hi = World->NumAlwaysCollide;
+
+	while (Lo < Hi)
+	{
+		int32	Mid = (Lo + Hi) / 2;
+
+		if (World->CollisionEntries[World->AlwaysCollide[Mid]].Order < Entry->Order)
+			Lo = Mid + 1;
+		else
+			Hi = Mid;
+	}
+
+	if (Always)
+	{
+		memmove(&World->AlwaysCollide[Lo + 1], &World->AlwaysCollide[Lo], (World->NumAlwaysCollide - Lo) * sizeof(int32));
+		World->AlwaysCollide[Lo] = Index;
+		World->NumAlwaysCollide++;
+	}
+	else
+	{
+		assert(World->AlwaysCollide[Lo] == Index);
+		World->NumAlwaysCollide--;
+		memmove(&World->AlwaysCollide[Lo], &World->AlwaysCollide[Lo + 1], (World->NumAlwaysCollide - Lo) * sizeof(int32));
+	}
+
+	Entry->Always = Always;
+}
+
+//========================================================================================
+//	jeWorld_RefreshCollisionEntry
+//	Moves the entry between the tree and the always list to match the object's current state
+//========================================================================================
+static void jeWorld_RefreshCollisionEntry(jeWorld *World, int32 Index)
+{
+	jeWorld_CollisionEntry	*Entry;
+	jeExtBox				Bounds;
+	jeBoolean				HasBounds = JE_FALSE;
+
+	assert(Index >= 0 && Index < World->MaxCollisionEntries);
+
+	Entry = &World->CollisionEntries[Index];
+	assert(Entry->Object);
+
+	if (!jeWorld_IsCollisionBounded(Entry->Object) || !jeWorld_GetCollisionBounds(Entry->Object, &Bounds, &HasBounds))
+	{
+		if (Entry->Proxy != JE_AABBTREE_NULL)
+		{
+			jeAABBTree_DestroyProxy(World->CollisionTree, Entry->Proxy);
+			Entry->Proxy = JE_AABBTREE_NULL;
+		}
+
+		jeWorld_SetAlwaysCollide(World, Index, JE_TRUE);
+		return;
+	}
+
+	if (!HasBounds)
+	{
+		// Nothing in the hierarchy can collide
+		if (Entry->Proxy != JE_AABBTREE_NULL)
+		{
+			jeAABBTree_DestroyProxy(World->CollisionTree, Entry->Proxy);
+			Entry->Proxy = JE_AABBTREE_NULL;
+		}
+	}
+	else if (Entry->Proxy != JE_AABBTREE_NULL)
+		jeAABBTree_MoveProxy(World->CollisionTree, Entry->Proxy, &Bounds);
+	else
+	{
+		Entry->Proxy = jeAABBTree_CreateProxy(World->CollisionTree, &Bounds, Entry->Object);
+
+		if (Entry->Proxy == JE_AABBTREE_NULL)
+		{
+			// Out of memory: still correct, just not culled
+			jeWorld_SetAlwaysCollide(World, Index, JE_TRUE);
+			return;
+		}
+	}
+
+	jeWorld_SetAlwaysCollide(World, Index, JE_FALSE);
+}
+
+//========================================================================================
+//	jeWorld_AddCollisionEntry
+//	Must be called in the order objects are appended to World->Objects
+//========================================================================================
+static jeBoolean jeWorld_AddCollisionEntry(jeWorld *World, jeObject *Object)
+{
+	jeWorld_CollisionEntry	*Entry;
+	int32					Index;
+
+	assert(World);
+	assert(Object);
+	assert(Object->CollisionWorld == nullptr);
+
+	if (World->FreeCollisionEntry < 0)
+	{
+		jeWorld_CollisionEntry	*NewEntries;
+		int32					*NewAlways;
+		int32					NewMax, i;
+
+		NewMax = World->MaxCollisionEntries ? World->MaxCollisionEntries * 2 : JU_WORLD_START_COLLISION_ENTRIES;
+
+		NewEntries = (jeWorld_CollisionEntry *)jeRam_Realloc(World->CollisionEntries, NewMax * sizeof(jeWorld_CollisionEntry));
+
+		if (!NewEntries)
+			return JE_FALSE;
+
+		World->CollisionEntries = NewEntries;
+
+		NewAlways = (int32 *)jeRam_Realloc(World->AlwaysCollide, NewMax * sizeof(int32));
+
+		if (!NewAlways)
+			return JE_FALSE;
+
+		World->AlwaysCollide = NewAlways;
+
+		for (i = World->MaxCollisionEntries; i < NewMax; i++)
+		{
+			World->CollisionEntries[i].Object = nullptr;
+			World->CollisionEntries[i].NextFree = (i + 1 < NewMax) ? i + 1 : -1;
+		}
+
+		World->FreeCollisionEntry = World->MaxCollisionEntries;
+		World->MaxCollisionEntries = NewMax;
+	}
+
+	Index = World->FreeCollisionEntry;
+	Entry = &World->CollisionEntries[Index];
+	World->FreeCollisionEntry = Entry->NextFree;
+
+	Entry->Object = Object;
+	Entry->Order = World->NextCollisionOrder++;
+	Entry->Proxy = JE_AABBTREE_NULL;
+	Entry->Always = JE_FALSE;
+	Entry->NextFree = -1;
+	Entry->CanCollide = jeWorld_CanCollide(World, jeObject_GetTypeName(Object));
+
+	Object->CollisionWorld = World;
+	Object->CollisionEntry = Index + 1;
+
+	jeWorld_RefreshCollisionEntry(World, Index);
+
+	return JE_TRUE;
+}
+
+//========================================================================================
+//	jeWorld_RemoveCollisionEntry
+//========================================================================================
+static void jeWorld_RemoveCollisionEntry(jeWorld *World, jeObject *Object)
+{
+	jeWorld_CollisionEntry	*Entry;
+	int32					Index;
+
+	if (Object->CollisionWorld != World)
+		return;
+
+	Index = Object->CollisionEntry - 1;
+	Entry = &World->CollisionEntries[Index];
+	assert(Entry->Object == Object);
+
+	if (Entry->Proxy != JE_AABBTREE_NULL)
+		jeAABBTree_DestroyProxy(World->CollisionTree, Entry->Proxy);
+
+	jeWorld_SetAlwaysCollide(World, Index, JE_FALSE);
+
+	Entry->Object = nullptr;
+	Entry->NextFree = World->FreeCollisionEntry;
+	World->FreeCollisionEntry = Index;
+
+	Object->CollisionWorld = nullptr;
+	Object->CollisionEntry = 0;
+}
+
+//========================================================================================
+//	jeWorld_UpdateCollisionMask
+//	Re-evaluates jeWorld_CanCollide once per entry, so queries don't compare type names
+//========================================================================================
+static void jeWorld_UpdateCollisionMask(jeWorld *World)
+{
+	int32		i;
+
+	for (i = 0; i < World->MaxCollisionEntries; i++)
+	{
+		jeWorld_CollisionEntry	*Entry = &World->CollisionEntries[i];
+
+		if (Entry->Object)
+			Entry->CanCollide = jeWorld_CanCollide(World, jeObject_GetTypeName(Entry->Object));
+	}
+}
+
+//========================================================================================
+//	jeWorld_UpdateObject
+//========================================================================================
+JETAPI void JETCC jeWorld_UpdateObject(jeWorld *World, const jeObject *Object)
+{
+	assert(World);
+	assert(Object);
+
+	// Called from object code while the world is being torn down
+	if (!World->CollisionTree)
+		return;
+
+	// A child's extents are part of every ancestor's bounds
+	for ( ; Object; Object = Object->Parent)
+	{
+		if (Object->CollisionWorld == World)
+		{
+			assert(World->CollisionEntries[Object->CollisionEntry - 1].Object == Object);
+			jeWorld_RefreshCollisionEntry(World, Object->CollisionEntry - 1);
+		}
+	}
+}
+
 //========================================================================================
 //	Objects
 //========================================================================================
@@ -1480,6 +1880,9 @@ JETAPI jeBoolean JETCC jeWorld_AddObject(jeWorld *World, jeObject *Object)
 	{
 		return JE_FALSE;
 	}
+
+	if (!jeWorld_AddCollisionEntry(World, Object))
+		goto AO_ERROR;
 	
 	// Ref the object
 	jeObject_CreateRef( Object );		
@@ -1529,6 +1932,8 @@ JETAPI jeBoolean JETCC jeWorld_RemoveObject(jeWorld *World, jeObject *Object)
 	if (!jeChain_RemoveLinkData(World->Objects, Object))
 		return JE_FALSE;
 
+	jeWorld_RemoveCollisionEntry(World, Object);
+
 	if( World->Engine != nullptr )
 		jeObject_DettachEngine(Object, World->Engine);
 
@@ -1589,11 +1994,20 @@ JETAPI jeBoolean JETCC jeWorld_Frame(jeWorld *World, float TimeDelta)
 	for (Link = jeChain_GetFirstLink(World->Objects); Link; Link = jeChain_LinkGetNext(Link))
 	{
 		jeObject* Object{};
+		jeXForm3d	OldXForm, NewXForm;
+		jeBoolean	HadXForm;
 
 		Object = (jeObject*)jeChain_LinkGetLinkData(Link);
 
+		HadXForm = jeObject_GetXForm(Object, &OldXForm);
+
 		if (!jeObject_Frame( Object, TimeDelta ))
 			return JE_FALSE;
+
+		// Objects may have moved themselves.  Anything that changes its extents some other
+		// way calls jeWorld_UpdateObject, which refreshes the entry right away.
+		if (!HadXForm || !jeObject_GetXForm(Object, &NewXForm) || memcmp(&OldXForm, &NewXForm, sizeof(jeXForm3d)) != 0)
+			jeWorld_UpdateObject(World, Object);
 	}
 
 	// paradoxnj - Useless and incomplete
@@ -1622,6 +2036,160 @@ JETAPI jeBoolean JETCC jeWorld_Frame(jeWorld *World, float TimeDelta)
 	return( JE_TRUE );
 }
 
+//========================================================================================
+//	Collision candidates
+//========================================================================================
+typedef struct
+{
+	uint32			Order;
+	jeObject		*Object;
+} jeWorld_CollisionCandidate;
+
+typedef struct
+{
+	const jeWorld				*World;
+	jeWorld_CollisionCandidate	*Candidates;			// Tree hits, sorted by Order
+	int32						NumCandidates;
+	int32						MaxCandidates;
+	int32						NextCandidate;
+	int32						NextAlways;				// Position in World->AlwaysCollide
+	jeBoolean					OutOfMemory;
+	jeWorld_CollisionCandidate	Local[JU_WORLD_COLLISION_LOCAL_CANDIDATES];
+} jeWorld_CollisionCandidates;
+
+static jeBoolean jeWorld_AddCollisionCandidate(jeWorld_CollisionCandidates *List, int32 Index)
+{
+	const jeWorld_CollisionEntry	*Entry = &List->World->CollisionEntries[Index];
+
+	if (!Entry->CanCollide)
+		return JE_TRUE;
+
+	if (List->NumCandidates == List->MaxCandidates)
+	{
+		jeWorld_CollisionCandidate	*NewCandidates;
+
+		NewCandidates = (jeWorld_CollisionCandidate *)jeRam_Allocate(List->MaxCandidates * 2 * sizeof(jeWorld_CollisionCandidate));
+
+		if (!NewCandidates)
+		{
+			List->OutOfMemory = JE_TRUE;
+			return JE_FALSE;
+		}
+
+		memcpy(NewCandidates, List->Candidates, List->NumCandidates * sizeof(jeWorld_CollisionCandidate));
+
+		if (List->Candidates != List->Local)
+			jeRam_Free(List->Candidates);
+
+		List->Candidates = NewCandidates;
+		List->MaxCandidates *= 2;
+	}
+
+	List->Candidates[List->NumCandidates].Order = Entry->Order;
+	List->Candidates[List->NumCandidates].Object = Entry->Object;
+	List->NumCandidates++;
+
+	return JE_TRUE;
+}
+
+static jeBoolean jeWorld_CollisionCandidateCB(int32 Proxy, void *UserData, void *Context)
+{
+	jeWorld_CollisionCandidates	*List = (jeWorld_CollisionCandidates *)Context;
+	const jeObject				*Object = (const jeObject *)UserData;
+
+	return jeWorld_AddCollisionCandidate(List, Object->CollisionEntry - 1);
+}
+
+static int jeWorld_CompareCollisionCandidates(const void *a, const void *b)
+{
+	uint32	Order1 = ((const jeWorld_CollisionCandidate *)a)->Order;
+	uint32	Order2 = ((const jeWorld_CollisionCandidate *)b)->Order;
+
+	return (Order1 < Order2) ? -1 : (Order1 > Order2);
+}
+
+//========================================================================================
+//	jeWorld_GatherCollisionCandidates
+//	Collects the indexed objects a query touching QueryBox could hit.  Returns JE_FALSE if
+//	it ran out of memory; the caller then tests every object.
+//========================================================================================
+static jeBoolean jeWorld_GatherCollisionCandidates(const jeWorld *World, const jeExtBox *QueryBox, jeWorld_CollisionCandidates *List)
+{
+	List->World = World;
+	List->Candidates = List->Local;
+	List->NumCandidates = 0;
+	List->MaxCandidates = JU_WORLD_COLLISION_LOCAL_CANDIDATES;
+	List->NextCandidate = 0;
+	List->NextAlways = 0;
+	List->OutOfMemory = JE_FALSE;
+
+	jeAABBTree_Query(World->CollisionTree, QueryBox, jeWorld_CollisionCandidateCB, List);
+
+	if (List->OutOfMemory)
+		return JE_FALSE;
+
+	if (List->NumCandidates > 1)
+		qsort(List->Candidates, List->NumCandidates, sizeof(jeWorld_CollisionCandidate), jeWorld_CompareCollisionCandidates);
+
+	return JE_TRUE;
+}
+
+static void jeWorld_FreeCollisionCandidates(jeWorld_CollisionCandidates *List)
+{
+	if (List->Candidates != List->Local)
+		jeRam_Free(List->Candidates);
+}
+
+//========================================================================================
+//	jeWorld_GetNextCollisionObject
+//	Merges the tree hits with the always tested objects, so objects come out in
+//	World->Objects order.  If gathering failed, walks the whole chain instead.
+//========================================================================================
+static jeObject *jeWorld_GetNextCollisionObject(const jeWorld *World, jeWorld_CollisionCandidates *List, jeBoolean Gathered, jeChain_Link **pLink)
+{
+	if (Gathered)
+	{
+		for (;;)
+		{
+			const jeWorld_CollisionEntry	*Always = nullptr;
+
+			if (List->NextAlways < World->NumAlwaysCollide)
+				Always = &World->CollisionEntries[World->AlwaysCollide[List->NextAlways]];
+
+			if (List->NextCandidate < List->NumCandidates && (!Always || List->Candidates[List->NextCandidate].Order < Always->Order))
+				return List->Candidates[List->NextCandidate++].Object;
+
+			if (!Always)
+				return nullptr;
+
+			List->NextAlways++;
+
+			if (Always->CanCollide)
+				return Always->Object;
+		}
+	}
+
+	for (*pLink = (*pLink) ? jeChain_LinkGetNext(*pLink) : jeChain_GetFirstLink(World->Objects); *pLink; *pLink = jeChain_LinkGetNext(*pLink))
+	{
+		jeObject	*Object = (jeObject *)jeChain_LinkGetLinkData(*pLink);
+
+		if (World->CollisionEntries[Object->CollisionEntry - 1].CanCollide)
+			return Object;
+	}
+
+	return nullptr;
+}
+
+static void jeWorld_PadCollisionQuery(jeExtBox *QueryBox)
+{
+	QueryBox->Min.X -= JU_WORLD_COLLISION_QUERY_PAD;
+	QueryBox->Min.Y -= JU_WORLD_COLLISION_QUERY_PAD;
+	QueryBox->Min.Z -= JU_WORLD_COLLISION_QUERY_PAD;
+	QueryBox->Max.X += JU_WORLD_COLLISION_QUERY_PAD;
+	QueryBox->Max.Y += JU_WORLD_COLLISION_QUERY_PAD;
+	QueryBox->Max.Z += JU_WORLD_COLLISION_QUERY_PAD;
+}
+
 //========================================================================================
 //	jeWorld_Collision
 //	Returns JE_TRUE if there was a collision, JE_FALSE otherwise
@@ -1632,54 +2200,79 @@ JETAPI jeBoolean JETCC jeWorld_Collision(	const jeWorld *World,
 										const jeVec3d *Back, 
 										jeCollisionInfo *CollisionInfo)
 {
+	jeWorld_CollisionCandidates	List;
 	jeChain_Link	*Link{};
+	jeExtBox		QueryBox;
+	jeBoolean		Gathered;
+	jeObject		*Object;
 	jeFloat			BestDist{};
 	jeBoolean		Hit;
-	
+
 	Hit = JE_FALSE;
 	BestDist = 999999.0f;
 
-	if (CollisionInfo)	// Invalidate the collision info structure	
+	if (CollisionInfo)	// Invalidate the collision info structure
 		memset(CollisionInfo, 0, sizeof(*CollisionInfo));
 
+	// Everything the moving box (or ray) sweeps through
+	QueryBox.Min.X = MIN(Front->X, Back->X);
+	QueryBox.Min.Y = MIN(Front->Y, Back->Y);
+	QueryBox.Min.Z = MIN(Front->Z, Back->Z);
+	QueryBox.Max.X = MAX(Front->X, Back->X);
+	QueryBox.Max.Y = MAX(Front->Y, Back->Y);
+	QueryBox.Max.Z = MAX(Front->Z, Back->Z);
+
+	if (Box)
+	{
+		QueryBox.Min.X += MIN(Box->Min.X, Box->Max.X);
+		QueryBox.Min.Y += MIN(Box->Min.Y, Box->Max.Y);
+		QueryBox.Min.Z += MIN(Box->Min.Z, Box->Max.Z);
+		QueryBox.Max.X += MAX(Box->Min.X, Box->Max.X);
+		QueryBox.Max.Y += MAX(Box->Min.Y, Box->Max.Y);
+		QueryBox.Max.Z += MAX(Box->Min.Z, Box->Max.Z);
+	}
+
+	jeWorld_PadCollisionQuery(&QueryBox);
+
+	Gathered = jeWorld_GatherCollisionCandidates(World, &QueryBox, &List);
+
 	// Call each objects collision function
-	for (Link = jeChain_GetFirstLink(World->Objects); Link; Link = jeChain_LinkGetNext(Link))
+	while ((Object = jeWorld_GetNextCollisionObject(World, &List, Gathered, &Link)) != nullptr)
 	{
-		jeObject		* Object{}, * SubObject{};
+		jeObject		*SubObject{};
 		jeVec3d			Impact{};
 		jePlane			Plane{};
-		const char		*ObjectType{};
-	
-		Object = (jeObject*)jeChain_LinkGetLinkData(Link);
-		ObjectType = jeObject_GetTypeName(Object);
-		if(jeWorld_CanCollide(World,ObjectType))
+
+		// Icestorm: Do we want to know further deatils?
+		if (CollisionInfo)
 		{
-			// Icestorm: Do we want to know further deatils?
-			if (CollisionInfo)
+			if (jeObject_Collision(Object, Box, Front, Back, &Impact, &Plane, &SubObject))
 			{
-				if (jeObject_Collision(Object, Box, Front, Back, &Impact, &Plane, &SubObject))
+				jeFloat		Dist{};
+
+				Dist = jeVec3d_DistanceBetween(Front, &Impact);
+
+				// Record the closest collision point
+				if (Dist < BestDist)
 				{
-					jeFloat		Dist{};
-
-					Dist = jeVec3d_DistanceBetween(Front, &Impact);
-
-					// Record the closest collision point
-					if (Dist < BestDist)
-					{
-						BestDist = Dist; // Added by Incarnadine
-						CollisionInfo->Impact = Impact;
-						CollisionInfo->Plane = Plane;
-						CollisionInfo->Object = SubObject;
-						CollisionInfo->IsValid = JE_TRUE;
-						Hit = JE_TRUE;
-					}
+					BestDist = Dist; // Added by Incarnadine
+					CollisionInfo->Impact = Impact;
+					CollisionInfo->Plane = Plane;
+					CollisionInfo->Object = SubObject;
+					CollisionInfo->IsValid = JE_TRUE;
+					Hit = JE_TRUE;
 				}
-			} else
-				if (jeObject_Collision(Object, Box, Front, Back, nullptr, nullptr, &SubObject))
-					return JE_TRUE;
-		}
+			}
+		} else
+			if (jeObject_Collision(Object, Box, Front, Back, nullptr, nullptr, &SubObject))
+			{
+				Hit = JE_TRUE;
+				break;
+			}
 	}
-	
+
+	jeWorld_FreeCollisionCandidates(&List);
+
 	return Hit;
 }
 
@@ -1694,10 +2287,15 @@ JETAPI jeBoolean JETCC jeWorld_ChangeBoxCollision(	const jeWorld *World,
 												const jeExtBox *BackBox, 
 												jeChangeBoxCollisionInfo *CollisionInfo)
 {
+	jeWorld_CollisionCandidates	List;
 	jeChain_Link	* Link{};
+	jeExtBox		QueryBox;
+	jeVec3d			Reach;
+	jeBoolean		Gathered;
+	jeObject		*Object;
 	jeFloat			BestDist{};
 	jeBoolean		Hit{};
-	
+
 	Hit = JE_FALSE;
 	BestDist = 999999.0f;
 
@@ -1705,43 +2303,58 @@ JETAPI jeBoolean JETCC jeWorld_ChangeBoxCollision(	const jeWorld *World,
 	if (CollisionInfo)	
 		memset(CollisionInfo, 0, sizeof(*CollisionInfo));
 
+	// Objects take the boxes either relative to Pos or recentred on it, so cover both
+	Reach.X = MAX(MAX(fabsf(FrontBox->Min.X), fabsf(FrontBox->Max.X)), MAX(fabsf(BackBox->Min.X), fabsf(BackBox->Max.X)));
+	Reach.Y = MAX(MAX(fabsf(FrontBox->Min.Y), fabsf(FrontBox->Max.Y)), MAX(fabsf(BackBox->Min.Y), fabsf(BackBox->Max.Y)));
+	Reach.Z = MAX(MAX(fabsf(FrontBox->Min.Z), fabsf(FrontBox->Max.Z)), MAX(fabsf(BackBox->Min.Z), fabsf(BackBox->Max.Z)));
+
+	QueryBox.Min.X = Pos->X - Reach.X;
+	QueryBox.Min.Y = Pos->Y - Reach.Y;
+	QueryBox.Min.Z = Pos->Z - Reach.Z;
+	QueryBox.Max.X = Pos->X + Reach.X;
+	QueryBox.Max.Y = Pos->Y + Reach.Y;
+	QueryBox.Max.Z = Pos->Z + Reach.Z;
+
+	jeWorld_PadCollisionQuery(&QueryBox);
+
+	Gathered = jeWorld_GatherCollisionCandidates(World, &QueryBox, &List);
+
 	// Call each objects collision function
-	for (Link = jeChain_GetFirstLink(World->Objects); Link; Link = jeChain_LinkGetNext(Link))
+	while ((Object = jeWorld_GetNextCollisionObject(World, &List, Gathered, &Link)) != nullptr)
 	{
-		jeObject* Object{}, * SubObject{};
+		jeObject		*SubObject{};
 		jeExtBox		ImpactBox{};
 		jePlane			Plane{};
-		const char* ObjectType{};
-	
-		Object = (jeObject*)jeChain_LinkGetLinkData(Link);
-		ObjectType = jeObject_GetTypeName(Object);
-		if(jeWorld_CanCollide(World,ObjectType))
+
+		// Icestorm: Do we want to know further deatils?
+		if (CollisionInfo)
 		{
-			// Icestorm: Do we want to know further deatils?
-			if (CollisionInfo)
+			if (jeObject_ChangeBoxCollision(Object, Pos, FrontBox, BackBox, &ImpactBox, &Plane, &SubObject))
 			{
-				if (jeObject_ChangeBoxCollision(Object, Pos, FrontBox, BackBox, &ImpactBox, &Plane, &SubObject))
-				{
-					jeFloat		Dist{};
+				jeFloat		Dist{};
 
-					Dist = jeVec3d_DistanceBetween(&FrontBox->Min, &ImpactBox.Min);
-				
-					// Record the closest collision point
-					if (Dist < BestDist)
-					{
-						BestDist = Dist;
-						CollisionInfo->ImpactBox = ImpactBox;
-						CollisionInfo->Plane = Plane;
-						CollisionInfo->Object = SubObject;
-						Hit = JE_TRUE;
-					}
+				Dist = jeVec3d_DistanceBetween(&FrontBox->Min, &ImpactBox.Min);
+
+				// Record the closest collision point
+				if (Dist < BestDist)
+				{
+					BestDist = Dist;
+					CollisionInfo->ImpactBox = ImpactBox;
+					CollisionInfo->Plane = Plane;
+					CollisionInfo->Object = SubObject;
+					Hit = JE_TRUE;
 				}
-			} else
-				if (jeObject_ChangeBoxCollision(Object, Pos, FrontBox, BackBox, nullptr, nullptr, &SubObject))
-					return JE_TRUE;
-		}
+			}
+		} else
+			if (jeObject_ChangeBoxCollision(Object, Pos, FrontBox, BackBox, nullptr, nullptr, &SubObject))
+			{
+				Hit = JE_TRUE;
+				break;
+			}
 	}
-	
+
+	jeWorld_FreeCollisionCandidates(&List);
+
 	return Hit;
 }
 
@@ -2342,6 +2955,21 @@ RO_ERROR:
 	return JE_FALSE;
 }
 
+//========================================================================================
+//	ReadObjectTracked
+//========================================================================================
+static jeBoolean ReadObjectTracked(jeVFile *VFile, void **LinkData, void *Context, jePtrMgr *PtrMgr)
+{
+	jeWorld_LoaderReadContext	*ReadContext = (jeWorld_LoaderReadContext*)Context;
+
+	if (!ReadObject(VFile, LinkData, ReadContext->World, PtrMgr))
+		return JE_FALSE;
+
+	jeWorld_LoaderTrack(ReadContext->Loader, VFile);
+
+	return JE_TRUE;
+}
+
 
 
 //========================================================================================
@@ -3020,8 +3648,12 @@ JETAPI jeBoolean	JETCC jeWorld_EnableCollision(jeWorld *World, const char* Type)
 		Data = (char*)jeChain_LinkGetLinkData(Link);
 		if(stricmp(Data,Type) == 0)
 		{
+			jeBoolean	Removed;
+
 			jeRam_Free(Data);
-			return jeChain_RemoveLink(World->CollisionObjectTypes, Link);			
+			Removed = jeChain_RemoveLink(World->CollisionObjectTypes, Link);			
+			jeWorld_UpdateCollisionMask(World);
+			return Removed;
 		}
 	}
 
@@ -3042,6 +3674,8 @@ JETAPI jeBoolean JETCC jeWorld_DisableCollision(jeWorld *World, const char *Type
 	if (!jeChain_AddLinkData(World->CollisionObjectTypes, Util_StrDup(Type)))
 		return JE_FALSE;	
 
+	jeWorld_UpdateCollisionMask(World);
+
 	return JE_TRUE;
 }
 
@@ -3144,6 +3778,11 @@ JETAPI char * JETCC jeWorld_GetNextCollisionExclusion(const jeWorld *World, cons
 // then read in the world.  The second two parameters here CAN be nullptr.  If they are nullptr,
 // they will be created automatically.
 JETAPI jeWorld	* JETCC jeWorld_CreateFromEditorFile(const char* FileName, jePtrMgr *pPtrMgr, jeResourceMgr * pResourceMgr )
+{
+	return jeWorld_CreateFromEditorFileTracked(FileName, pPtrMgr, pResourceMgr, nullptr);
+}
+
+static jeWorld *jeWorld_CreateFromEditorFileTracked(const char* FileName, jePtrMgr *pPtrMgr, jeResourceMgr * pResourceMgr, jeWorld_Loader *Loader)
 {
 	jeWorld* pWorld{};
 	jeVFile* pMapFile{};
@@ -3201,7 +3840,7 @@ JETAPI jeWorld	* JETCC jeWorld_CreateFromEditorFile(const char* FileName, jePtrM
 		return nullptr;
 	}		
 
-	pWorld = jeWorld_CreateFromFile( pWorldFork, pPtrMgr, pResourceMgr );
+	pWorld = jeWorld_CreateFromFileTracked( pWorldFork, pPtrMgr, pResourceMgr, Loader );
 
 	jeVFile_Close( pWorldFork ) ;
 	if( pWorld == nullptr )
@@ -3222,3 +3861,193 @@ JETAPI jeWorld	* JETCC jeWorld_CreateFromEditorFile(const char* FileName, jePtrM
 
 	return pWorld;
 }
+
+//========================================================================================
+//	Background loading
+//========================================================================================
+#define JU_WORLD_LOADER_READ_SHARE	0.9f		// Progress given to reading; Prepare gets the rest
+
+typedef struct jeWorld_Loader
+{
+	char					*FileName;
+	jePtrMgr				*PtrMgr;			// Our refs; either may be nullptr
+	jeResourceMgr			*ResourceMgr;
+	jeWorld_LoaderPrepareCB	Prepare;
+	void					*Context;
+
+	jeThreadQueue_Job		*Job;
+	long					FileSize;			// Only touched by the job
+	std::atomic<float>		Progress;
+	jeWorld					*World;				// Set by the job; read once it has completed
+} jeWorld_Loader;
+
+//========================================================================================
+//	jeWorld_LoaderTrack
+//	Called by the load as it goes; progress follows the position in the world fork
+//========================================================================================
+static void jeWorld_LoaderTrack(jeWorld_Loader *Loader, jeVFile *VFile)
+{
+	long		Pos;
+
+	if (!Loader)
+		return;
+
+	if (Loader->FileSize <= 0 && !jeVFile_Size(VFile, &Loader->FileSize))
+		return;
+
+	if (Loader->FileSize <= 0 || !jeVFile_Tell(VFile, &Pos))
+		return;
+
+	Loader->Progress.store(JU_WORLD_LOADER_READ_SHARE * MIN((jeFloat)Pos / (jeFloat)Loader->FileSize, 1.0f), std::memory_order_relaxed);
+}
+
+static void jeWorld_LoaderFunc(jeThreadQueue_Job *Job, void *Context)
+{
+	jeWorld_Loader	*Loader = (jeWorld_Loader*)Context;
+	jeWorld			*World;
+
+	World = jeWorld_CreateFromEditorFileTracked(Loader->FileName, Loader->PtrMgr, Loader->ResourceMgr, Loader);
+
+	if (World)
+	{
+		Loader->Progress.store(JU_WORLD_LOADER_READ_SHARE, std::memory_order_relaxed);
+
+		if (Loader->Prepare && !Loader->Prepare(World, Loader->Context))
+		{
+			jeErrorLog_AddString(-1, "jeWorld_LoaderFunc:  Prepare failed.", Loader->FileName);
+			jeWorld_Destroy(&World);
+		}
+	}
+
+	Loader->World = World;
+	Loader->Progress.store(1.0f, std::memory_order_relaxed);
+}
+
+static void jeWorld_LoaderFree(jeWorld_Loader *Loader)
+{
+	if (Loader->World)
+		jeWorld_Destroy(&Loader->World);
+
+	if (Loader->Job)
+		jeThreadQueue_JobDestroy(&Loader->Job);
+
+	if (Loader->PtrMgr)
+		jePtrMgr_Destroy(&Loader->PtrMgr);
+
+	if (Loader->ResourceMgr)
+		jeResource_MgrDestroy(&Loader->ResourceMgr);
+
+	if (Loader->FileName)
+		jeRam_Free(Loader->FileName);
+
+	Loader->~jeWorld_Loader();
+	jeRam_Free(Loader);
+}
+
+//========================================================================================
+//	jeWorld_LoaderCreate
+//========================================================================================
+JETAPI jeWorld_Loader * JETCC jeWorld_LoaderCreate(const char *FileName, jePtrMgr *pPtrMgr, jeResourceMgr *pResourceMgr,
+												jeWorld_LoaderPrepareCB Prepare, void *Context)
+{
+	jeWorld_Loader	*Loader;
+	void			*Mem;
+
+	assert(FileName);
+
+	Mem = jeRam_AllocateClear(sizeof(jeWorld_Loader));
+
+	if (!Mem)
+		return nullptr;
+
+	Loader = new (Mem) jeWorld_Loader();
+
+	Loader->FileName = Util_StrDup(FileName);
+
+	if (!Loader->FileName)
+		goto ExitWithError;
+
+	if (pPtrMgr)
+	{
+		if (!jePtrMgr_CreateRef(pPtrMgr))
+			goto ExitWithError;
+
+		Loader->PtrMgr = pPtrMgr;
+	}
+
+	if (pResourceMgr)
+	{
+		jeResource_MgrIncRefcount(pResourceMgr);
+		Loader->ResourceMgr = pResourceMgr;
+	}
+
+	Loader->Prepare = Prepare;
+	Loader->Context = Context;
+
+	Loader->Job = jeThreadQueue_JobCreate(jeWorld_LoaderFunc, Loader, nullptr, 0);
+
+	if (!Loader->Job)
+		goto ExitWithError;
+
+	return Loader;
+
+	ExitWithError:
+	{
+		jeWorld_LoaderFree(Loader);
+		return nullptr;
+	}
+}
+
+//========================================================================================
+//	jeWorld_LoaderPoll
+//========================================================================================
+JETAPI jeWorld_LoaderStatus JETCC jeWorld_LoaderPoll(const jeWorld_Loader *Loader, jeFloat *Progress)
+{
+	assert(Loader);
+
+	if (Progress)
+		*Progress = Loader->Progress.load(std::memory_order_relaxed);
+
+	if (jeThreadQueue_JobGetStatus(Loader->Job) != JE_THREADQUEUE_STATUS_COMPLETED)
+		return JE_WORLD_LOADER_LOADING;
+
+	return Loader->World ? JE_WORLD_LOADER_READY : JE_WORLD_LOADER_FAILED;
+}
+
+//========================================================================================
+//	jeWorld_LoaderFinish
+//========================================================================================
+JETAPI jeWorld * JETCC jeWorld_LoaderFinish(jeWorld_Loader **pLoader)
+{
+	jeWorld		*World;
+
+	assert(pLoader && *pLoader);
+
+	// Runs the load right here if no job thread has picked it up yet
+	jeThreadQueue_WaitOnJob((*pLoader)->Job, JE_THREADQUEUE_STATUS_COMPLETED);
+
+	World = (*pLoader)->World;
+	(*pLoader)->World = nullptr;
+
+	jeWorld_LoaderFree(*pLoader);
+	*pLoader = nullptr;
+
+	return World;
+}
+
+//========================================================================================
+//	jeWorld_LoaderDestroy
+//========================================================================================
+JETAPI void JETCC jeWorld_LoaderDestroy(jeWorld_Loader **pLoader)
+{
+	assert(pLoader);
+
+	if (!*pLoader)
+		return;
+
+	if (!jeThreadQueue_JobCancel((*pLoader)->Job))
+		jeThreadQueue_WaitOnJob((*pLoader)->Job, JE_THREADQUEUE_STATUS_COMPLETED);
+
+	jeWorld_LoaderFree(*pLoader);
+	*pLoader = nullptr;
+}
@@ -27,7 +27,7 @@
 jeObjectDef ObjectDef = {
 	JE_OBJECT_TYPE_UNKNOWN,
 	"AmbObject",
-	0,
+	JE_OBJECT_COLLIDE_IN_EXTBOX,
 	CreateInstance,
 	CreateRef,
 	Destroy,
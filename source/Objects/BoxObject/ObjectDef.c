@@ -56,7 +56,7 @@ int WINAPI DllMain(image_id	hInstance,DWORD		fdwReason, PVOID		pvReserved );
 jeObjectDef ObjectDef = {
 	JE_OBJECT_TYPE_UNKNOWN,
 	"BoxObject",
-	0,
+	JE_OBJECT_COLLIDE_IN_EXTBOX,
 	CreateInstance,
 	CreateRef,
 	Destroy,
@@ -36,7 +36,7 @@ jeObjectDef ObjectDef =
 {
 	JE_OBJECT_TYPE_UNKNOWN,
 	"Corona",
-	0,
+	JE_OBJECT_COLLIDE_IN_EXTBOX,
 	CreateInstance,
 	CreateRef,
 	Destroy,
@@ -57,7 +57,7 @@ int WINAPI DllMain(image_id	hInstance,DWORD		fdwReason, PVOID		pvReserved );
 jeObjectDef ObjectDef = {
 	JE_OBJECT_TYPE_PORTAL,
 	"Portal",
-	0,
+	JE_OBJECT_COLLIDE_IN_EXTBOX,
 	CreateInstance,
 	CreateRef,
 	Destroy,
@@ -61,7 +61,7 @@ jeObjectDef ObjectDef =
 {
 	JE_OBJECT_TYPE_UNKNOWN,
 	"Pulsing Light",
-	0,
+	JE_OBJECT_COLLIDE_IN_EXTBOX,
 	CreateInstance,
 	CreateRef,
 	Destroy,
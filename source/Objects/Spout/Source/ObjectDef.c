@@ -62,7 +62,7 @@ jeObjectDef ObjectDef =
 {
 	JE_OBJECT_TYPE_UNKNOWN,
 	"Spout",
-	0,
+	JE_OBJECT_COLLIDE_IN_EXTBOX,
 	CreateInstance,
 	CreateRef,
 	Destroy,
@@ -0,0 +1,174 @@
+/****************************************************************************************/
+/*  CONVERTBENCH.CPP                                                                    */
+/*                                                                                      */
+/*  Author: Styx3D Modernization                                                        */
+/*  Description: Throughput benchmark for the bitmap pixel format conversion kernels    */
+/*                                                                                      */
+/*  Converts a random image with every kernel pair (with and without color keys) and    */
+/*  the palettized -> 32 bit lookup on every path the cpu supports, and reports         */
+/*  throughput and how many pixels differ from the scalar path.                         */
+/*                                                                                      */
+/*  usage: ConvertBench [width] [height] [iterations]                                   */
+/*                                                                                      */
+/*  The contents of this file are subject to the 0BSD License.                          */
+/*  See LICENSE file in the project root for full license information.                  */
+/*                                                                                      */
+/****************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <vector>
+
+#include "bitmap_convert.h"
+
+typedef struct ConvertBench_Case
+{
+	const char		*Name;
+	jePixelFormat	Src, Dst;		// Src 8BIT is the palette lookup
+	jeBoolean		SrcKey, DstKey;
+	uint32			AlphaToKey;
+} ConvertBench_Case;
+
+static const ConvertBench_Case	g_Cases[] =
+{
+	{ "rgb24 -> xrgb",			JE_PIXELFORMAT_24BIT_RGB,	JE_PIXELFORMAT_32BIT_XRGB,		JE_FALSE,	JE_FALSE,	0 },
+	{ "rgb24 -> argb",			JE_PIXELFORMAT_24BIT_RGB,	JE_PIXELFORMAT_32BIT_ARGB,		JE_FALSE,	JE_FALSE,	0 },
+	{ "rgb24 -> argb keyed",	JE_PIXELFORMAT_24BIT_RGB,	JE_PIXELFORMAT_32BIT_ARGB,		JE_TRUE,	JE_TRUE,	0 },
+	{ "xrgb -> 565",			JE_PIXELFORMAT_32BIT_XRGB,	JE_PIXELFORMAT_16BIT_565_RGB,	JE_FALSE,	JE_FALSE,	0 },
+	{ "argb -> 565",			JE_PIXELFORMAT_32BIT_ARGB,	JE_PIXELFORMAT_16BIT_565_RGB,	JE_FALSE,	JE_FALSE,	0 },
+	{ "argb -> 565 alphakey",	JE_PIXELFORMAT_32BIT_ARGB,	JE_PIXELFORMAT_16BIT_565_RGB,	JE_FALSE,	JE_TRUE,	80 },
+	{ "xrgb -> 4444",			JE_PIXELFORMAT_32BIT_XRGB,	JE_PIXELFORMAT_16BIT_4444_ARGB,	JE_FALSE,	JE_FALSE,	0 },
+	{ "argb -> 4444",			JE_PIXELFORMAT_32BIT_ARGB,	JE_PIXELFORMAT_16BIT_4444_ARGB,	JE_FALSE,	JE_FALSE,	0 },
+	{ "argb -> 4444 srckey",	JE_PIXELFORMAT_32BIT_ARGB,	JE_PIXELFORMAT_16BIT_4444_ARGB,	JE_TRUE,	JE_FALSE,	0 },
+	{ "xrgb -> 1555",			JE_PIXELFORMAT_32BIT_XRGB,	JE_PIXELFORMAT_16BIT_1555_ARGB,	JE_FALSE,	JE_FALSE,	0 },
+	{ "argb -> 1555",			JE_PIXELFORMAT_32BIT_ARGB,	JE_PIXELFORMAT_16BIT_1555_ARGB,	JE_FALSE,	JE_FALSE,	0 },
+	{ "argb -> 1555 keyed",		JE_PIXELFORMAT_32BIT_ARGB,	JE_PIXELFORMAT_16BIT_1555_ARGB,	JE_TRUE,	JE_TRUE,	0 },
+	{ "pal8 -> argb",			JE_PIXELFORMAT_8BIT,		JE_PIXELFORMAT_32BIT_ARGB,		JE_FALSE,	JE_FALSE,	0 },
+};
+
+#define CONVERTBENCH_PAD	3	// pixels of padding per row, so the row tails get exercised
+
+static int ConvertBench_Bytes(jePixelFormat Format)
+{
+	switch (Format)
+	{
+		case JE_PIXELFORMAT_8BIT:		return 1;
+		case JE_PIXELFORMAT_24BIT_RGB:	return 3;
+		case JE_PIXELFORMAT_32BIT_XRGB:
+		case JE_PIXELFORMAT_32BIT_ARGB:	return 4;
+		default:						return 2;
+	}
+}
+
+static void ConvertBench_Run(	const ConvertBench_Case *Case, const std::vector<uint8> &Src, const std::vector<uint32> &Table,
+								std::vector<uint8> &Dst, const jeBitmap_ConvertKeys *Keys, int Width, int Height, int Iterations)
+{
+	int		SrcStride = (Width + CONVERTBENCH_PAD)*ConvertBench_Bytes(Case->Src);
+	int		DstStride = (Width + CONVERTBENCH_PAD)*ConvertBench_Bytes(Case->Dst);
+	int		i;
+
+	for (i=0; i<Iterations; i++)
+	{
+		if (Case->Src == JE_PIXELFORMAT_8BIT)
+			jeBitmap_Convert_Lookup32(&Src[0], SrcStride, &Table[0], (uint32 *)&Dst[0], DstStride, Width, Height);
+		else
+			jeBitmap_Convert_Rows(Case->Src, &Src[0], SrcStride, Case->Dst, &Dst[0], DstStride, Width, Height, Keys);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int						Width = 1021, Height = 1024, Iterations = 50;
+	std::vector<uint8>		Src, Ref, Dst;
+	std::vector<uint32>		Table(256);
+	int						c, i, p, Bytes;
+
+	if (argc > 1)
+		Width = atoi(argv[1]);
+	if (argc > 2)
+		Height = atoi(argv[2]);
+	if (argc > 3)
+		Iterations = atoi(argv[3]);
+
+	if (Width <= 0 || Height <= 0 || Iterations <= 0)
+	{
+		printf("usage: ConvertBench [width] [height] [iterations]\n");
+		return 1;
+	}
+
+	srand(1);
+
+	for (i=0; i<256; i++)
+		Table[i] = ((uint32)rand() << 16) ^ (uint32)rand();
+
+	printf("%d x %d, %d iterations\n", Width, Height, Iterations);
+
+	for (c=0; c<(int)(sizeof(g_Cases)/sizeof(g_Cases[0])); c++)
+	{
+		const ConvertBench_Case		*Case = &g_Cases[c];
+		jeBitmap_ConvertKeys		Keys;
+		int							SrcBytes = ConvertBench_Bytes(Case->Src);
+
+		Src.resize((size_t)(Width + CONVERTBENCH_PAD)*Height*SrcBytes);
+		for (i=0; i<(int)Src.size(); i++)
+			Src[i] = (uint8)rand();
+
+		// Every 7th pixel is the Src key, and the Dst key is a value the kernel can produce
+		memset(&Keys, 0, sizeof(Keys));
+		Keys.SrcHasKey = Case->SrcKey;
+		Keys.DstHasKey = Case->DstKey;
+		Keys.AlphaToKey = Case->AlphaToKey;
+		Keys.DstKey = (ConvertBench_Bytes(Case->Dst) == 2) ? 0x1234 : 0xFF123456;
+		if (Case->SrcKey)
+		{
+			Keys.SrcKey = (SrcBytes == 3) ? (((uint32)Src[0]<<16) | ((uint32)Src[1]<<8) | Src[2]) : *(const uint32 *)&Src[0];
+			for (i=0; i+SrcBytes <= (int)Src.size(); i+=7*SrcBytes)
+				memcpy(&Src[i], &Src[0], SrcBytes);
+		}
+
+		Bytes = (Width + CONVERTBENCH_PAD)*Height*ConvertBench_Bytes(Case->Dst);
+		Ref.assign(Bytes, 0xCD);
+		Dst.resize(Bytes);
+
+		jeBitmap_Convert_SetPath(JE_BITMAP_CONVERT_PATH_SCALAR);
+		ConvertBench_Run(Case, Src, Table, Ref, &Keys, Width, Height, 1);
+
+		printf("%s\n", Case->Name);
+
+		for (p=0; p<JE_BITMAP_CONVERT_PATH_COUNT; p++)
+		{
+			std::chrono::steady_clock::time_point	Start;
+			double									Seconds;
+			int										Mismatches, DstBytes = ConvertBench_Bytes(Case->Dst);
+
+			if (!jeBitmap_Convert_SetPath((jeBitmap_ConvertPath)p))
+			{
+				printf("  %-8s  not supported\n", jeBitmap_Convert_GetPathName((jeBitmap_ConvertPath)p));
+				continue;
+			}
+
+			Dst.assign(Bytes, 0xCD);
+			ConvertBench_Run(Case, Src, Table, Dst, &Keys, Width, Height, 1);	// Warm up
+
+			// Padding is compared too, nothing may write past the row
+			Mismatches = 0;
+			for (i=0; i<Bytes; i+=DstBytes)
+				if (memcmp(&Dst[i], &Ref[i], DstBytes) != 0)
+					Mismatches++;
+
+			Start = std::chrono::steady_clock::now();
+			ConvertBench_Run(Case, Src, Table, Dst, &Keys, Width, Height, Iterations);
+			Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+
+			printf("  %-8s  %8.2f ms  %8.1f Mpix/s  mismatches %d\n",
+				jeBitmap_Convert_GetPathName((jeBitmap_ConvertPath)p),
+				Seconds*1000.0,
+				((double)Width*Height*Iterations)/Seconds/1.0e6,
+				Mismatches);
+		}
+	}
+
+	return 0;
+}
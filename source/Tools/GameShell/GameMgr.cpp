@@ -18,6 +18,7 @@ CGameMgr::CGameMgr()
 	m_pEngine = NULL;
 	m_pCamera = NULL;
 	m_pWorld = NULL;
+	m_pLoader = NULL;
 
 	m_pPtrMgr = NULL;
 	m_pResMgr = NULL;
@@ -74,6 +75,9 @@ void CGameMgr::Shutdown()
 {
 	GLOG("CGameMgr - Shutting down game manager...");
 
+	if (m_pLoader)
+		jeWorld_LoaderDestroy(&m_pLoader);
+
 	if (m_pWorld)
 		jeWorld_Destroy(&m_pWorld);
 
@@ -190,32 +194,81 @@ jeBoolean CGameMgr::SetDriverMode(int32 w, int32 h, int32 b)
 	if (!m_pPtrMgr)
 		return JE_FALSE;
 
-	m_pResMgr = jeResource_MgrCreateDefault(m_pEngine);
+	// Worlds load on a loader thread, so the manager is thread safe and has no engine:
+	// nothing it loads touches the driver.  PublishWorld lends it the engine.
+	m_pResMgr = jeResource_MgrCreateThreadSafe(NULL);
 	if (!m_pResMgr)
 		return JE_FALSE;
 
+	// Same directories as jeResource_MgrCreateDefault
+	jeResource_OpenDirectory(m_pResMgr, "Sounds", "Sounds");
+	jeResource_OpenDirectory(m_pResMgr, "GlobalMaterials", "GlobalMaterials");
+	jeResource_OpenDirectory(m_pResMgr, "Actors", "Actors");
+	jeResource_OpenDirectory(m_pResMgr, "Shaders", "Shaders");
+
 	m_LastTime = timeGetTime();
 
 	return JE_TRUE;
 }
 
-jeBoolean CGameMgr::LoadWorld(const char *filename)
+// Runs on the loader's thread, before the world has an engine
+jeBoolean JETCC CGameMgr::PrepareWorld(jeWorld *World, void *Context)
 {
-	jeVFile						*File = NULL;
+	jeWorld_RebuildBSP(World, BSP_OPTIONS_CSG_BRUSHES, Logic_Smart, 5);
+	jeWorld_RebuildLights(World);
 
+	return JE_TRUE;
+}
+
+// Starts the load; the current world keeps running until Frame() publishes the new one
+jeBoolean CGameMgr::LoadWorld(const char *filename)
+{
 	if (!m_pPtrMgr || !m_pResMgr)
 		return JE_FALSE;
 
-	m_pWorld = jeWorld_CreateFromEditorFile(filename, m_pPtrMgr, m_pResMgr);
-	if (!m_pWorld)
+	if (m_pLoader)
+		jeWorld_LoaderDestroy(&m_pLoader);
+
+	m_pLoader = jeWorld_LoaderCreate(filename, m_pPtrMgr, m_pResMgr, PrepareWorld, this);
+	if (!m_pLoader)
 		return JE_FALSE;
 
-	jeWorld_SetEngine(m_pWorld, m_pEngine);
+	return JE_TRUE;
+}
 
-	jeWorld_RebuildBSP(m_pWorld, BSP_OPTIONS_CSG_BRUSHES, Logic_Smart, 5);
-	jeWorld_RebuildLights(m_pWorld);
+// Called between frames; swaps in the loaded world once it is ready
+void CGameMgr::PublishWorld()
+{
+	jeWorld						*world;
+	jeBoolean					attached;
 
-	return JE_TRUE;
+	if (jeWorld_LoaderPoll(m_pLoader, NULL) == JE_WORLD_LOADER_LOADING)
+		return;
+
+	world = jeWorld_LoaderFinish(&m_pLoader);
+	if (!world)
+	{
+		GLOG("CGameMgr - Could not load world!!");
+		return;
+	}
+
+	// The load left texture creation and bitmap attachment for this thread.  The loader
+	// is done with m_pResMgr, so it can have the engine while SetEngine creates them.
+	jeResourceMgr_SetEngine(m_pResMgr, m_pEngine);
+	attached = jeWorld_SetEngine(world, m_pEngine);
+	jeResourceMgr_SetEngine(m_pResMgr, NULL);
+
+	if (!attached)
+	{
+		GLOG("CGameMgr - Could not attach the engine to the world!!");
+		jeWorld_Destroy(&world);
+		return;
+	}
+
+	if (m_pWorld)
+		jeWorld_Destroy(&m_pWorld);
+
+	m_pWorld = world;
 }
 
 jeBoolean CGameMgr::Frame()
@@ -225,6 +278,9 @@ jeBoolean CGameMgr::Frame()
 
 	assert(m_pEngine != NULL);
 
+	if (m_pLoader)
+		PublishWorld();
+
 	currTime = timeGetTime();
 	deltaTime = ((float)(currTime - m_LastTime)) * 0.001f;
 
@@ -31,6 +31,7 @@ public:
 	int32							m_Width, m_Height, m_BPP;
 
 	jeWorld							*m_pWorld;
+	jeWorld_Loader					*m_pLoader;			// World being loaded in the background
 
 	jeCamera						*m_pCamera;
 	jeXForm3d						m_CameraXForm;
@@ -47,6 +48,8 @@ public:
 	jeBoolean						SetDriverMode(int32 w, int32 h, int32 b);
 
 	jeBoolean						LoadWorld(const char *filename);
+	void							PublishWorld();
+	static jeBoolean JETCC			PrepareWorld(jeWorld *World, void *Context);
 
 	jeBoolean						Frame();
 
@@ -0,0 +1,175 @@
+/****************************************************************************************/
+/*  SKINBENCH.CPP                                                                       */
+/*                                                                                      */
+/*  Author: Styx3D Modernization                                                        */
+/*  Description: Microbenchmark for the jeBodySkin skinning paths                       */
+/*                                                                                      */
+/*  Skins a synthetic body laid out like jeBody_XSkinVertex/jeBodyInst_SkinVertex with  */
+/*  every path the cpu supports, and reports throughput and the largest difference      */
+/*  from the scalar path.                                                               */
+/*                                                                                      */
+/*  usage: SkinBench [vertices] [bones] [actors]                                        */
+/*                                                                                      */
+/*  The contents of this file are subject to the 0BSD License.                          */
+/*  See LICENSE file in the project root for full license information.                  */
+/*                                                                                      */
+/****************************************************************************************/
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <vector>
+
+#include "BodySkin.h"
+
+// Same sizes and field order as the engine's skin vertex structs
+typedef struct SkinBench_SrcVertex
+{
+	jeVec3d		XPoint;
+	jeFloat		XU, XV;
+	int8		LevelOfDetailMask;
+	int16		BoneIndex;
+	int16		nBlends;
+	int16		bdaOffset;
+} SkinBench_SrcVertex;
+
+typedef struct SkinBench_DstVertex
+{
+	jeVec3d		SVPoint;
+	jeVec3d		SVW;
+	jeFloat		SVU, SVV;
+	int			ReferenceBoneIndex;
+} SkinBench_DstVertex;
+
+static jeFloat SkinBench_Rand(void)
+{
+	return (jeFloat)rand() / (jeFloat)RAND_MAX * 2.0f - 1.0f;
+}
+
+static void SkinBench_MakeBone(jeXForm3d *M, int Bone)
+{
+	jeFloat		a = 0.37f*(jeFloat)Bone, b = 0.11f*(jeFloat)Bone;
+	jeFloat		ca = (jeFloat)cos(a), sa = (jeFloat)sin(a), cb = (jeFloat)cos(b), sb = (jeFloat)sin(b);
+
+	// Rotation about Y then X, plus a translation
+	M->AX = ca;			M->AY = 0.0f;	M->AZ = sa;
+	M->BX = sb*sa;		M->BY = cb;		M->BZ = -sb*ca;
+	M->CX = -cb*sa;		M->CY = sb;		M->CZ = cb*ca;
+	M->Flags = 0;
+	M->BPad = M->CPad = 0.0f;
+
+	M->Translation.X = 10.0f*SkinBench_Rand();
+	M->Translation.Y = 10.0f*SkinBench_Rand();
+	M->Translation.Z = 10.0f*SkinBench_Rand();
+}
+
+// Skins every actor once, one batch per bone run, like jeBodyInst_GetGeometry
+static void SkinBench_Skin(	const std::vector<jeXForm3d> &Bones,
+							const std::vector<SkinBench_SrcVertex> &Src,
+							std::vector<SkinBench_DstVertex> &Dst,
+							int Actors)
+{
+	int		a, i, Run;
+
+	for (a=0; a<Actors; a++)
+	{
+		for (i=0; i<(int)Src.size(); i+=Run)
+		{
+			for (Run=1; i+Run < (int)Src.size() && Src[i+Run].BoneIndex == Src[i].BoneIndex; Run++)
+				;
+
+			jeBodySkin_TransformArray(	&Bones[Src[i].BoneIndex],
+										&Src[i].XPoint, sizeof(SkinBench_SrcVertex),
+										&Dst[i].SVPoint, sizeof(SkinBench_DstVertex),
+										Run);
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int									NumVerts = 4000, NumBones = 40, NumActors = 500;
+	std::vector<jeXForm3d>				Bones;
+	std::vector<SkinBench_SrcVertex>	Src;
+	std::vector<SkinBench_DstVertex>	Ref, Dst;
+	int									i, p;
+
+	if (argc > 1)
+		NumVerts = atoi(argv[1]);
+	if (argc > 2)
+		NumBones = atoi(argv[2]);
+	if (argc > 3)
+		NumActors = atoi(argv[3]);
+
+	if (NumVerts <= 0 || NumBones <= 0 || NumActors <= 0)
+	{
+		printf("usage: SkinBench [vertices] [bones] [actors]\n");
+		return 1;
+	}
+
+	srand(1);
+
+	Bones.resize(NumBones);
+	for (i=0; i<NumBones; i++)
+		SkinBench_MakeBone(&Bones[i], i);
+
+	// Sorted by bone, like the actor compiler leaves them
+	Src.resize(NumVerts);
+	for (i=0; i<NumVerts; i++)
+	{
+		SkinBench_SrcVertex		*S = &Src[i];
+
+		S->XPoint.X = 5.0f*SkinBench_Rand();
+		S->XPoint.Y = 5.0f*SkinBench_Rand();
+		S->XPoint.Z = 5.0f*SkinBench_Rand();
+		S->XU = S->XV = 0.0f;
+		S->LevelOfDetailMask = 1;
+		S->BoneIndex = (int16)(((int64_t)i*NumBones)/NumVerts);
+		S->nBlends = 0;
+		S->bdaOffset = 0;
+	}
+
+	Ref.resize(NumVerts);
+	Dst.resize(NumVerts);
+
+	jeBodySkin_SetPath(JE_BODYSKIN_PATH_SCALAR);
+	SkinBench_Skin(Bones, Src, Ref, 1);
+
+	printf("%d vertices, %d bones, %d actors\n", NumVerts, NumBones, NumActors);
+
+	for (p=0; p<JE_BODYSKIN_PATH_COUNT; p++)
+	{
+		std::chrono::steady_clock::time_point	Start;
+		double									Seconds;
+		jeFloat									MaxErr;
+
+		if (!jeBodySkin_SetPath((jeBodySkin_Path)p))
+		{
+			printf("%-8s  not supported\n", jeBodySkin_GetPathName((jeBodySkin_Path)p));
+			continue;
+		}
+
+		SkinBench_Skin(Bones, Src, Dst, 1);		// Warm up
+
+		MaxErr = 0.0f;
+		for (i=0; i<NumVerts; i++)
+		{
+			MaxErr = fmaxf(MaxErr, fabsf(Dst[i].SVPoint.X - Ref[i].SVPoint.X));
+			MaxErr = fmaxf(MaxErr, fabsf(Dst[i].SVPoint.Y - Ref[i].SVPoint.Y));
+			MaxErr = fmaxf(MaxErr, fabsf(Dst[i].SVPoint.Z - Ref[i].SVPoint.Z));
+		}
+
+		Start = std::chrono::steady_clock::now();
+		SkinBench_Skin(Bones, Src, Dst, NumActors);
+		Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+
+		printf("%-8s  %8.2f ms  %8.1f Mverts/s  max err %g\n",
+			jeBodySkin_GetPathName((jeBodySkin_Path)p),
+			Seconds*1000.0,
+			((double)NumVerts*NumActors)/Seconds/1.0e6,
+			(double)MaxErr);
+	}
+
+	return 0;
+}